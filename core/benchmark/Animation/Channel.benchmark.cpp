@@ -0,0 +1,178 @@
+#include "Animation/Animation.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Benchmark.hpp"
+
+#include <cmath>
+#include <crimild/math/Quaternion.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace {
+
+   /**
+      \brief Finds keys with a linear scan from the first one, like channels used to do
+    */
+   template< typename T >
+   class LinearScanChannel : public Channel {
+      CRIMILD_IMPLEMENT_RTTI( crimild::benchmark::LinearScanChannel )
+
+   public:
+      LinearScanChannel( std::string name, const Array< Real32 > &times, const Array< T > &keys )
+         : Channel( name ),
+           _times( times ),
+           _keys( keys )
+      {
+      }
+
+      virtual Real32 getDuration( void ) const override { return _times.last(); }
+
+      virtual void evaluate( Real32 t, Animation *animation, Size & ) override
+      {
+         T result;
+         if ( t <= _times.first() ) {
+            result = _keys.first();
+         } else if ( t >= _times.last() ) {
+            result = _keys.last();
+         } else {
+            Size index = 0;
+            for ( ; index < _times.size() - 1; index++ ) {
+               if ( t < _times[ index + 1 ] ) {
+                  break;
+               }
+            }
+            const auto u = ( t - _times[ index ] ) / ( _times[ index + 1 ] - _times[ index ] );
+            interpolate( _keys[ index ], _keys[ index + 1 ], u, result );
+         }
+         animation->setValue( getName(), result );
+      }
+
+      virtual void evaluate( Real32, Pose &, const Pose::Target &, Size & ) override { }
+
+      virtual void resample( Real32 ) override { }
+
+   private:
+      static void interpolate( const Vector3f &start, const Vector3f &end, Real32 t, Vector3f &result )
+      {
+         Interpolation::linear( start, end, t, result );
+      }
+
+      static void interpolate( const Quaternion &start, const Quaternion &end, Real32 t, Quaternion &result )
+      {
+         result = slerp( start, end, t );
+      }
+
+   private:
+      Array< Real32 > _times;
+      Array< T > _keys;
+   };
+
+   /**
+      \brief Builds a clip with a translation and rotation channel per joint. Keys are not uniformly spaced.
+    */
+   template< template< typename > class TranslationChannel, template< typename > class RotationChannel >
+   SharedPointer< Clip > buildClip( long joints, long keys )
+   {
+      std::mt19937 rnd( 1234 );
+      std::uniform_real_distribution< Real32 > step( 0.5f, 1.5f );
+      std::uniform_real_distribution< Real32 > value( -1.0f, 1.0f );
+
+      auto clip = crimild::alloc< Clip >( "clip" );
+      for ( long j = 0; j < joints; ++j ) {
+         Array< Real32 > times;
+         Array< Vector3f > translations;
+         Array< Quaternion > rotations;
+         Real32 t = 0;
+         for ( long k = 0; k < keys; ++k ) {
+            times.add( t );
+            translations.add( Vector3f { value( rnd ), value( rnd ), value( rnd ) } );
+            rotations.add( normalize( Quaternion { value( rnd ), value( rnd ), value( rnd ), 1.0f } ) );
+            t += step( rnd );
+         }
+         const auto name = "joint_" + std::to_string( j );
+         clip->addChannel( crimild::alloc< TranslationChannel< Vector3f > >( name + ".translation", times, translations ) );
+         clip->addChannel( crimild::alloc< RotationChannel< Quaternion > >( name + ".rotation", times, rotations ) );
+      }
+      return clip;
+   }
+
+   template< typename T >
+   using Impl = ChannelImpl< T >;
+
+   /**
+      \brief Plays the clip in many instances at once, each one starting at a different time
+    */
+   double play( const SharedPointer< Clip > &clip, long instances, long frames, int repetitions, Real32 step, bool useCursors )
+   {
+      std::vector< std::unique_ptr< Animation > > animations;
+      for ( long i = 0; i < instances; ++i ) {
+         animations.push_back( std::make_unique< Animation >( clip ) );
+      }
+
+      const auto duration = clip->getDuration();
+
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            for ( long frame = 0; frame < frames; ++frame ) {
+               for ( long i = 0; i < instances; ++i ) {
+                  const auto t = std::fmod( duration * Real32( i ) / Real32( instances ) + step * Real32( frame ), duration );
+                  if ( !useCursors ) {
+                     // Reset cursors, so every evaluation needs a search
+                     auto &cursors = animations[ i ]->getChannelCursors();
+                     for ( Size c = 0; c < cursors.size(); ++c ) {
+                        cursors[ c ] = 0;
+                     }
+                  }
+                  clip->evaluate( t, animations[ i ].get() );
+               }
+            }
+         }
+      );
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto joints = benchmark::getArg( argc, argv, "joints", 100 );
+   const auto keys = benchmark::getArg( argc, argv, "keys", 10000 );
+   const auto instances = benchmark::getArg( argc, argv, "instances", 100 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 30 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   // About half a key per frame
+   const auto step = 0.5f;
+
+   auto linearClip = buildClip< LinearScanChannel, LinearScanChannel >( joints, keys );
+   auto clip = buildClip< Impl, Impl >( joints, keys );
+   auto uniformClip = buildClip< Impl, Impl >( joints, keys );
+   uniformClip->resample( 1 );
+
+   benchmark::printHeader( "Animation Channel" );
+   std::printf( "%ld joints, %ld keys, %ld instances, %ld frames\n", joints, keys, instances, frames );
+
+   const auto evaluations = double( instances * frames * joints * 2 );
+
+   const auto linear = play( linearClip, instances, frames, repetitions, step, false );
+   const auto binarySearch = play( clip, instances, frames, repetitions, step, false );
+   const auto cursor = play( clip, instances, frames, repetitions, step, true );
+   const auto uniform = play( uniformClip, instances, frames, repetitions, step, false );
+
+   benchmark::report( "linear scan", linear, evaluations, "channels" );
+   benchmark::report( "binary search", binarySearch, evaluations, "channels" );
+   benchmark::report( "cursor", cursor, evaluations, "channels" );
+   benchmark::report( "uniform keys", uniform, evaluations, "channels" );
+   benchmark::reportSpeedup( "binary search", linear, binarySearch );
+   benchmark::reportSpeedup( "cursor", linear, cursor );
+   benchmark::reportSpeedup( "uniform keys", linear, uniform );
+
+   return 0;
+}
@@ -0,0 +1,173 @@
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Animation/CompressedChannel.hpp"
+#include "Animation/Pose.hpp"
+#include "Benchmark.hpp"
+
+#include <cmath>
+#include <crimild/math/Quaternion.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace {
+
+   /**
+      \brief Builds a clip sampled at 30 fps with translation, rotation and scale channels per joint
+
+      Joints move along smooth curves with different frequencies. Scales never change,
+      which is usually the case for skeletal animations.
+    */
+   SharedPointer< Clip > buildClip( long joints, Real32 duration )
+   {
+      std::mt19937 rnd( 1234 );
+      std::uniform_real_distribution< Real32 > frequency( 0.1f, 2.0f );
+      std::uniform_real_distribution< Real32 > amplitude( 0.0f, 1.0f );
+
+      const auto count = long( duration * 30.0f ) + 1;
+
+      auto clip = crimild::alloc< Clip >( "clip" );
+      for ( long j = 0; j < joints; ++j ) {
+         const auto f = frequency( rnd );
+         const auto a = amplitude( rnd );
+
+         Array< Real32 > times;
+         Array< Vector3f > translations;
+         Array< Quaternion > rotations;
+         Array< Vector3f > scales;
+         for ( long k = 0; k < count; ++k ) {
+            const auto t = Real32( k ) / 30.0f;
+            times.add( t );
+            translations.add( Vector3f { a * std::sin( f * t ), 1.0f, a * std::cos( 2.0f * f * t ) } );
+            const auto angle = 0.5f * std::sin( f * t );
+            rotations.add( Quaternion { std::sin( angle ), 0, 0, std::cos( angle ) } );
+            scales.add( Vector3f { 1, 1, 1 } );
+         }
+
+         const auto name = "joint_" + std::to_string( j );
+         clip->addChannel( crimild::alloc< Vector3fChannel >( name + "[p]", times, translations ) );
+         clip->addChannel( crimild::alloc< QuaternionChannel >( name + "[r]", times, rotations ) );
+         clip->addChannel( crimild::alloc< Vector3fChannel >( name + "[s]", times, scales ) );
+      }
+      return clip;
+   }
+
+   std::vector< Pose::Target > buildTargets( const SharedPointer< Clip > &clip )
+   {
+      std::vector< Pose::Target > targets;
+      auto &channels = clip->getChannels();
+      for ( Size i = 0; i < channels.size(); ++i ) {
+         std::string jointName;
+         Pose::Target target;
+         target.joint = UInt32( i / 3 );
+         target.property = Pose::Target::parse( channels[ i ]->getName(), jointName );
+         targets.push_back( target );
+      }
+      return targets;
+   }
+
+   /**
+      \brief Evaluates the clip into a pose for many instances, each one starting at a different time
+    */
+   double play( const SharedPointer< Clip > &clip, long joints, long instances, long frames, int repetitions )
+   {
+      auto &channels = clip->getChannels();
+      const auto targets = buildTargets( clip );
+      std::vector< Size > cursors( instances * channels.size(), 0 );
+      Pose pose;
+      pose.reset( joints );
+
+      const auto duration = clip->getDuration();
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            for ( long frame = 0; frame < frames; ++frame ) {
+               for ( long i = 0; i < instances; ++i ) {
+                  const auto t = std::fmod( duration * Real32( i ) / Real32( instances ) + Real32( frame ) / 60.0f, duration );
+                  auto cursor = cursors.data() + i * channels.size();
+                  for ( Size c = 0; c < channels.size(); ++c ) {
+                     channels[ c ]->evaluate( t, pose, targets[ c ], cursor[ c ] );
+                  }
+               }
+            }
+         }
+      );
+   }
+
+   /**
+      \brief Maximum error between both clips, sampling at a higher rate than keys
+    */
+   void measureError( const SharedPointer< Clip > &original, const SharedPointer< Clip > &compressed, long joints, Real32 &maxTranslation, Real32 &maxRotation )
+   {
+      auto &a = original->getChannels();
+      auto &b = compressed->getChannels();
+      const auto targets = buildTargets( original );
+
+      Pose expected;
+      expected.reset( joints );
+      Pose actual;
+      actual.reset( joints );
+
+      maxTranslation = 0;
+      maxRotation = 0;
+      std::vector< Size > cursors( 2 * a.size(), 0 );
+      for ( Real32 t = 0; t < original->getDuration(); t += 1.0f / 120.0f ) {
+         for ( Size c = 0; c < a.size(); ++c ) {
+            a[ c ]->evaluate( t, expected, targets[ c ], cursors[ 2 * c ] );
+            b[ c ]->evaluate( t, actual, targets[ c ], cursors[ 2 * c + 1 ] );
+         }
+         for ( long j = 0; j < joints; ++j ) {
+            maxTranslation = std::max( maxTranslation, compression::error( expected.getTranslation( j ), actual.getTranslation( j ) ) );
+            maxTranslation = std::max( maxTranslation, compression::error( expected.getScale( j ), actual.getScale( j ) ) );
+            maxRotation = std::max( maxRotation, compression::error( expected.getRotation( j ), actual.getRotation( j ) ) );
+         }
+      }
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto joints = benchmark::getArg( argc, argv, "joints", 60 );
+   const auto duration = Real32( benchmark::getArg( argc, argv, "duration", 60 ) );
+   const auto instances = benchmark::getArg( argc, argv, "instances", 200 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 30 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   auto clip = buildClip( joints, duration );
+   auto compressedClip = buildClip( joints, duration );
+
+   CompressionSettings settings;
+   const auto stats = compressedClip->compress( settings );
+
+   benchmark::printHeader( "Animation Compression" );
+   std::printf( "%ld joints, %.0f seconds at 30 fps, %ld instances, %ld frames\n", joints, duration, instances, frames );
+   std::printf( "  channels: %zu (%zu constant)\n", stats.channels, stats.constantChannels );
+   std::printf( "  keys: %zu -> %zu\n", stats.originalKeys, stats.compressedKeys );
+   std::printf(
+      "  bytes: %zu -> %zu (%zu saved, %.1fx smaller)\n",
+      stats.originalBytes,
+      stats.compressedBytes,
+      stats.getSavedBytes(),
+      stats.getRatio()
+   );
+
+   Real32 maxTranslation = 0;
+   Real32 maxRotation = 0;
+   measureError( clip, compressedClip, joints, maxTranslation, maxRotation );
+   std::printf( "  max error: %g units (tolerance %g), %g radians (tolerance %g)\n", maxTranslation, settings.tolerance, maxRotation, settings.angularTolerance );
+
+   const auto evaluations = double( instances * frames * joints * 3 );
+   const auto uncompressed = play( clip, joints, instances, frames, repetitions );
+   const auto compressed = play( compressedClip, joints, instances, frames, repetitions );
+
+   benchmark::report( "uncompressed", uncompressed, evaluations, "channels" );
+   benchmark::report( "compressed", compressed, evaluations, "channels" );
+   benchmark::reportSpeedup( "compressed", uncompressed, compressed );
+
+   return 0;
+}
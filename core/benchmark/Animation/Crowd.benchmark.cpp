@@ -0,0 +1,203 @@
+#include "Animation/Animation.hpp"
+#include "Animation/AnimationStage.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Animation/Skeleton.hpp"
+#include "Animation/Skinning.hpp"
+#include "Benchmark.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Rendering/VertexBuffer.hpp"
+#include "SceneGraph/Group.hpp"
+
+#include <crimild/math/Quaternion.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace {
+
+   std::string getJointName( long j )
+   {
+      return "joint_" + std::to_string( j );
+   }
+
+   /**
+      \brief Builds a clip with a translation and rotation channel per joint
+    */
+   SharedPointer< Clip > buildClip( long joints, long keys )
+   {
+      std::mt19937 rnd( 1234 );
+      std::uniform_real_distribution< Real32 > value( -1.0f, 1.0f );
+
+      auto clip = crimild::alloc< Clip >( "clip" );
+      for ( long j = 0; j < joints; ++j ) {
+         Array< Real32 > times;
+         Array< Vector3f > translations;
+         Array< Quaternion > rotations;
+         for ( long k = 0; k < keys; ++k ) {
+            times.add( Real32( k ) );
+            translations.add( Vector3f { value( rnd ), value( rnd ), value( rnd ) } );
+            rotations.add( normalize( Quaternion { value( rnd ), value( rnd ), value( rnd ), 1.0f } ) );
+         }
+         clip->addChannel( crimild::alloc< Vector3fChannel >( getJointName( j ) + "[p]", times, translations ) );
+         clip->addChannel( crimild::alloc< QuaternionChannel >( getJointName( j ) + "[r]", times, rotations ) );
+      }
+      return clip;
+   }
+
+   /**
+      \brief Builds vertices influenced by four random joints each
+    */
+   SharedPointer< VertexBuffer > buildVertices( long joints, long vertices )
+   {
+      std::mt19937 rnd( 4321 );
+      std::uniform_real_distribution< Real32 > value( -1.0f, 1.0f );
+      std::uniform_int_distribution< long > joint( 0, joints - 1 );
+
+      auto layout = VertexLayout()
+                       .withAttribute< Vector3f >( VertexAttribute::Name::POSITION )
+                       .withAttribute< Vector3f >( VertexAttribute::Name::NORMAL )
+                       .withAttribute< Vector4f >( VertexAttribute::Name::BLEND_INDICES )
+                       .withAttribute< Vector4f >( VertexAttribute::Name::BLEND_WEIGHT );
+      auto ret = crimild::alloc< VertexBuffer >( layout, vertices );
+      auto positions = ret->get( VertexAttribute::Name::POSITION );
+      auto normals = ret->get( VertexAttribute::Name::NORMAL );
+      auto indices = ret->get( VertexAttribute::Name::BLEND_INDICES );
+      auto weights = ret->get( VertexAttribute::Name::BLEND_WEIGHT );
+      for ( long i = 0; i < vertices; ++i ) {
+         positions->set( i, Vector3f { value( rnd ), value( rnd ), value( rnd ) } );
+         normals->set( i, normalize( Vector3f { value( rnd ), value( rnd ), value( rnd ) } ) );
+         indices->set( i, Vector4f { Real32( joint( rnd ) ), Real32( joint( rnd ) ), Real32( joint( rnd ) ), Real32( joint( rnd ) ) } );
+         weights->set( i, Vector4f { 0.4f, 0.3f, 0.2f, 0.1f } );
+      }
+      return ret;
+   }
+
+   struct Crowd {
+      SharedPointer< Group > scene;
+      std::vector< Skeleton * > skeletons;
+   };
+
+   /**
+      \brief Builds characters with joints arranged as binary trees
+    */
+   Crowd buildCrowd( long characters, long joints, const SharedPointer< Clip > &clip, const SharedPointer< VertexBuffer > &vertices )
+   {
+      Crowd crowd;
+      crowd.scene = crimild::alloc< Group >();
+      for ( long c = 0; c < characters; ++c ) {
+         auto root = crimild::alloc< Group >();
+         auto skeleton = root->attachComponent< Skeleton >();
+
+         std::vector< SharedPointer< Group > > nodes;
+         for ( long j = 0; j < joints; ++j ) {
+            auto node = crimild::alloc< Group >();
+            auto joint = node->attachComponent< Joint >( getJointName( j ), UInt32( j ) );
+            skeleton->getJoints().insert( getJointName( j ), crimild::retain( joint ) );
+            if ( j == 0 ) {
+               root->attachNode( node );
+            } else {
+               nodes[ ( j - 1 ) / 2 ]->attachNode( node );
+            }
+            nodes.push_back( node );
+         }
+
+         auto animation = crimild::alloc< Animation >( clip, Real32( c % 10 ) );
+         animation->bind( skeleton );
+         skeleton->setAnimation( animation );
+         skeleton->attachSkin( crimild::alloc< SkinnedVertices >( crimild::get_ptr( vertices ) ) );
+
+         crowd.scene->attachNode( root );
+         crowd.skeletons.push_back( skeleton );
+      }
+      return crowd;
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto characters = benchmark::getArg( argc, argv, "characters", 256 );
+   const auto joints = benchmark::getArg( argc, argv, "joints", 64 );
+   const auto vertices = benchmark::getArg( argc, argv, "vertices", 2000 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 30 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   auto clip = buildClip( joints, 100 );
+   auto crowd = buildCrowd( characters, joints, clip, buildVertices( joints, vertices ) );
+   auto scene = crimild::get_ptr( crowd.scene );
+
+   benchmark::printHeader( "Animation Crowd" );
+   std::printf( "%ld characters, %ld joints, %ld vertices, %ld frames\n", characters, joints, vertices, frames );
+
+   const Clock step( 1.0 / 60.0 );
+
+   // One character at a time, updating joint nodes as Skeleton::animate does
+   const auto serial = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            for ( auto skeleton : crowd.skeletons ) {
+               auto animation = skeleton->getAnimation();
+               animation->update( step );
+               skeleton->animate( animation );
+               skeleton->skin();
+            }
+         }
+      }
+   );
+
+   AnimationStage stage;
+
+   const auto stageSerial = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            stage.update( scene, step );
+         }
+      }
+   );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+
+   const auto parallel = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            tasks.beginFrame();
+            stage.update( scene, step );
+         }
+      }
+   );
+
+   stage.setUpdateJointNodes( false );
+   const auto parallelPalettesOnly = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            tasks.beginFrame();
+            stage.update( scene, step );
+         }
+      }
+   );
+
+   tasks.stop();
+
+   const auto workerCount = std::to_string( tasks.getNumWorkers() );
+   benchmark::report( "serial, per character", serial / frames, 1.0, "frames" );
+   benchmark::report( "animation stage, no workers", stageSerial / frames, 1.0, "frames" );
+   benchmark::report( "animation stage, " + workerCount + " workers", parallel / frames, 1.0, "frames" );
+   benchmark::report( "animation stage, " + workerCount + " workers, no joint nodes", parallelPalettesOnly / frames, 1.0, "frames" );
+   benchmark::reportSpeedup( "animation stage", serial, parallel );
+   benchmark::reportSpeedup( "animation stage, no joint nodes", serial, parallelPalettesOnly );
+
+   return 0;
+}
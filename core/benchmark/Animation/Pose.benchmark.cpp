@@ -0,0 +1,124 @@
+#include "Animation/Animation.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Animation/Skeleton.hpp"
+#include "Benchmark.hpp"
+#include "SceneGraph/Group.hpp"
+
+#include <crimild/math/Quaternion.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace {
+
+   struct Character {
+      SharedPointer< Group > root;
+      Skeleton *skeleton = nullptr;
+   };
+
+   Character buildCharacter( long joints )
+   {
+      Character character;
+      character.root = crimild::alloc< Group >();
+      character.skeleton = character.root->attachComponent< Skeleton >();
+      for ( long j = 0; j < joints; ++j ) {
+         auto node = crimild::alloc< Group >();
+         const auto name = "joint_" + std::to_string( j );
+         auto joint = node->attachComponent< Joint >( name, UInt32( j ) );
+         character.skeleton->getJoints().insert( name, crimild::retain( joint ) );
+         character.root->attachNode( node );
+      }
+      return character;
+   }
+
+   /**
+      \brief Builds a clip with a translation and rotation channel per joint, using uniformly spaced keys
+    */
+   SharedPointer< Clip > buildClip( long joints, long keys, unsigned seed )
+   {
+      std::mt19937 rnd( seed );
+      std::uniform_real_distribution< Real32 > value( -1.0f, 1.0f );
+
+      auto clip = crimild::alloc< Clip >( "clip" );
+      for ( long j = 0; j < joints; ++j ) {
+         Array< Real32 > times;
+         Array< Vector3f > translations;
+         Array< Quaternion > rotations;
+         for ( long k = 0; k < keys; ++k ) {
+            times.add( Real32( k ) );
+            translations.add( Vector3f { value( rnd ), value( rnd ), value( rnd ) } );
+            rotations.add( normalize( Quaternion { value( rnd ), value( rnd ), value( rnd ), 1.0f } ) );
+         }
+         const auto name = "joint_" + std::to_string( j );
+         clip->addChannel( crimild::alloc< Vector3fChannel >( name + "[p]", times, translations ) );
+         clip->addChannel( crimild::alloc< QuaternionChannel >( name + "[r]", times, rotations ) );
+      }
+      return clip;
+   }
+
+   /**
+      \brief Blends two clips and adds a third one on top, like a character moving while breathing
+    */
+   double play( const std::vector< SharedPointer< Clip > > &clips, Character &character, long frames, int repetitions, bool bind )
+   {
+      auto walk = crimild::alloc< Animation >( clips[ 0 ] );
+      auto run = crimild::alloc< Animation >( clips[ 1 ] );
+      auto breathe = crimild::alloc< Animation >( clips[ 2 ] );
+      if ( bind ) {
+         walk->bind( character.skeleton );
+         run->bind( character.skeleton );
+         breathe->bind( character.skeleton );
+      }
+
+      const Clock step( 1.0 / 60.0 );
+
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            for ( long frame = 0; frame < frames; ++frame ) {
+               walk->update( step );
+               run->update( step );
+               breathe->update( step );
+               walk->lerp( run, 0.5f, false )->add( breathe, 0.25f );
+               if ( bind ) {
+                  character.skeleton->animate( walk );
+               }
+            }
+         }
+      );
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto joints = benchmark::getArg( argc, argv, "joints", 100 );
+   const auto keys = benchmark::getArg( argc, argv, "keys", 100 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 1000 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   auto character = buildCharacter( joints );
+   std::vector< SharedPointer< Clip > > clips {
+      buildClip( joints, keys, 1 ),
+      buildClip( joints, keys, 2 ),
+      buildClip( joints, keys, 3 ),
+   };
+
+   benchmark::printHeader( "Animation Pose" );
+   std::printf( "%ld joints, %ld keys, %ld frames\n", joints, keys, frames );
+
+   const auto accumulators = play( clips, character, frames, repetitions, false );
+   const auto pose = play( clips, character, frames, repetitions, true );
+
+   benchmark::report( "accumulators (by name)", accumulators / frames, 1.0, "frames" );
+   benchmark::report( "bound pose", pose / frames, 1.0, "frames" );
+   benchmark::reportSpeedup( "bound pose", accumulators, pose );
+
+   return 0;
+}
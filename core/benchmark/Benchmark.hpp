@@ -0,0 +1,102 @@
+#ifndef CRIMILD_CORE_BENCHMARK_
+#define CRIMILD_CORE_BENCHMARK_
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace crimild::benchmark {
+
+   using Clock = std::chrono::steady_clock;
+
+   /**
+      \brief Returns the time (in seconds) it takes to execute fn
+    */
+   template< typename Fn >
+   double measure( Fn &&fn )
+   {
+      const auto start = Clock::now();
+      fn();
+      const auto end = Clock::now();
+      return std::chrono::duration< double >( end - start ).count();
+   }
+
+   /**
+      \brief Executes fn several times and returns the best time (in seconds)
+
+      Using the minimum instead of the average filters out most of the noise
+      introduced by the OS scheduler.
+    */
+   template< typename Fn >
+   double measureBest( int repetitions, Fn &&fn )
+   {
+      double best = measure( fn );
+      for ( int i = 1; i < repetitions; ++i ) {
+         const auto t = measure( fn );
+         if ( t < best ) {
+            best = t;
+         }
+      }
+      return best;
+   }
+
+   /**
+      \brief Reads an integer argument in the form "--name=value"
+    */
+   inline long getArg( int argc, char **argv, const char *name, long defaultValue )
+   {
+      const auto prefix = std::string( "--" ) + name + "=";
+      for ( int i = 1; i < argc; ++i ) {
+         if ( std::strncmp( argv[ i ], prefix.c_str(), prefix.size() ) == 0 ) {
+            return std::strtol( argv[ i ] + prefix.size(), nullptr, 10 );
+         }
+      }
+      return defaultValue;
+   }
+
+   /**
+      \brief Reads a string argument in the form "--name=value"
+    */
+   inline std::string getArg( int argc, char **argv, const char *name, const char *defaultValue )
+   {
+      const auto prefix = std::string( "--" ) + name + "=";
+      for ( int i = 1; i < argc; ++i ) {
+         if ( std::strncmp( argv[ i ], prefix.c_str(), prefix.size() ) == 0 ) {
+            return std::string( argv[ i ] + prefix.size() );
+         }
+      }
+      return defaultValue;
+   }
+
+   inline void printHeader( const char *title )
+   {
+      std::printf( "\n=== %s ===\n", title );
+   }
+
+   /**
+      \brief Prints a single result line
+    */
+   inline void report( const std::string &name, double seconds, double operations, const char *unit = "ops" )
+   {
+      std::printf(
+         "%-48s %10.3f ms %14.0f %s/s\n",
+         name.c_str(),
+         seconds * 1000.0,
+         seconds > 0 ? operations / seconds : 0.0,
+         unit
+      );
+   }
+
+   /**
+      \brief Prints the ratio between a baseline and a candidate time
+    */
+   inline void reportSpeedup( const std::string &name, double baselineSeconds, double seconds )
+   {
+      std::printf( "%-48s %10.2fx\n", ( name + " speedup" ).c_str(), seconds > 0 ? baselineSeconds / seconds : 0.0 );
+   }
+
+}
+
+#endif
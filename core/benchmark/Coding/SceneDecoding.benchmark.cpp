@@ -0,0 +1,153 @@
+#include "Benchmark.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Crimild.hpp"
+#include "Primitives/SpherePrimitive.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+
+#include <crimild/coding/BinaryDecoder.hpp>
+#include <crimild/coding/BinaryEncoder.hpp>
+#include <crimild/coding/FileDecoder.hpp>
+#include <crimild/coding/FileEncoder.hpp>
+#include <crimild/coding/init.hpp>
+#include <crimild/math/translation.hpp>
+#include <filesystem>
+#include <string>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+namespace {
+
+   /**
+      \brief Builds a group with one sphere per geometry, each with its own vertex and index buffers
+    */
+   SharedPointer< Node > buildScene( long objects, long divisions )
+   {
+      auto scene = crimild::alloc< Group >();
+      for ( long i = 0; i < objects; ++i ) {
+         auto geometry = crimild::alloc< Geometry >();
+         geometry->setName( "sphere " + std::to_string( i ) );
+         geometry->attachPrimitive(
+            crimild::alloc< SpherePrimitive >(
+               SpherePrimitive::Params {
+                  .divisions = Vector2i { int( divisions ), int( divisions ) },
+               }
+            )
+         );
+         geometry->setLocal( translation( Real( i % 10 ), 0, Real( i / 10 ) ) );
+         scene->attachNode( geometry );
+      }
+      return scene;
+   }
+
+   volatile size_t sink = 0;
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto objects = benchmark::getArg( argc, argv, "objects", 200 );
+   const auto divisions = benchmark::getArg( argc, argv, "divisions", 64 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 5 ) );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+
+   // Scenes produced by tools/sceneEncoder can be loaded with path=<FILE>
+   const auto path = benchmark::getArg( argc, argv, "path", "" );
+
+   crimild::init();
+   crimild::coding::init();
+
+   const auto directory = std::filesystem::temp_directory_path();
+   const auto tagPath = path.empty() ? directory / "crimild_benchmark_scene.crimild" : std::filesystem::path( path );
+   const auto binaryPath = directory / "crimild_benchmark_scene.crimild_bin";
+
+   SharedPointer< Node > scene;
+   if ( path.empty() ) {
+      scene = buildScene( objects, divisions );
+      FileEncoder encoder;
+      encoder.encode( scene );
+      if ( !encoder.write( tagPath ) ) {
+         std::printf( "Cannot write %s\n", tagPath.string().c_str() );
+         return -1;
+      }
+   } else {
+      FileDecoder decoder;
+      if ( !decoder.read( tagPath ) || decoder.getObjectCount() == 0 ) {
+         std::printf( "Cannot read %s\n", tagPath.string().c_str() );
+         return -1;
+      }
+      scene = decoder.getObjectAt< Node >( 0 );
+   }
+
+   BinaryEncoder binaryEncoder;
+   binaryEncoder.encode( scene );
+   if ( !binaryEncoder.write( binaryPath ) ) {
+      std::printf( "Cannot write %s\n", binaryPath.string().c_str() );
+      return -1;
+   }
+
+   const auto tagMegabytes = double( std::filesystem::file_size( tagPath ) ) / ( 1024.0 * 1024.0 );
+   const auto binaryMegabytes = double( std::filesystem::file_size( binaryPath ) ) / ( 1024.0 * 1024.0 );
+
+   benchmark::printHeader( "SceneDecoding" );
+   std::printf( "%s (%.1f MB), %s (%.1f MB)\n", tagPath.string().c_str(), tagMegabytes, binaryPath.string().c_str(), binaryMegabytes );
+
+   const auto tagged = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         FileDecoder decoder;
+         decoder.read( tagPath );
+         sink = decoder.getObjectAt< Node >( 0 ) != nullptr;
+      }
+   );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+   const auto parallel = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         // Parallel jobs are allocated from per-frame arenas
+         tasks.beginFrame();
+         FileDecoder decoder;
+         decoder.setParallelFor(
+            []( Size count, const std::function< void( Size, Size ) > &fn ) {
+               concurrency::parallel_for(
+                  concurrency::Range { 0, count },
+                  4,
+                  [ &fn ]( concurrency::Range chunk ) {
+                     fn( chunk.begin, chunk.end );
+                  }
+               );
+            }
+         );
+         decoder.read( tagPath );
+         sink = decoder.getObjectAt< Node >( 0 ) != nullptr;
+      }
+   );
+   tasks.stop();
+
+   const auto binary = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         BinaryDecoder decoder;
+         decoder.read( binaryPath );
+         sink = decoder.getObjectAt< Node >( 0 ) != nullptr;
+      }
+   );
+
+   benchmark::report( "FileDecoder (tags, copies)", tagged, tagMegabytes, "MB" );
+   benchmark::report( "FileDecoder (tags, " + std::to_string( tasks.getNumWorkers() ) + " workers)", parallel, tagMegabytes, "MB" );
+   benchmark::report( "BinaryDecoder (mapped, in place)", binary, binaryMegabytes, "MB" );
+   benchmark::reportSpeedup( "FileDecoder, parallel", tagged, parallel );
+   benchmark::reportSpeedup( "BinaryDecoder", tagged, binary );
+
+   if ( path.empty() ) {
+      std::filesystem::remove( tagPath );
+   }
+   std::filesystem::remove( binaryPath );
+
+   return 0;
+}
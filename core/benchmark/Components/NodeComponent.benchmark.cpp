@@ -0,0 +1,174 @@
+#include "Benchmark.hpp"
+#include "Components/MaterialComponent.hpp"
+#include "Components/NodeComponent.hpp"
+#include "Components/RotationComponent.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/Apply.hpp"
+#include "Visitors/UpdateComponents.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   class CounterComponent : public NodeComponent {
+      CRIMILD_IMPLEMENT_RTTI( crimild::benchmark::CounterComponent )
+
+   public:
+      virtual void update( const Clock & ) override { ++count; }
+
+      UInt64 count = 0;
+   };
+
+   class TagComponent : public NodeComponent {
+      CRIMILD_IMPLEMENT_RTTI( crimild::benchmark::TagComponent )
+   };
+
+   /**
+      \brief How nodes used to store components, kept as reference
+    */
+   using ComponentMap = std::map< std::string, SharedPointer< NodeComponent > >;
+
+   struct Scene {
+      SharedPointer< Group > root;
+      std::vector< Node * > nodes;
+      std::vector< ComponentMap > maps;
+   };
+
+   Scene buildScene( long groups, long leaves )
+   {
+      Scene scene;
+      scene.root = std::make_shared< Group >();
+      for ( long i = 0; i < groups; ++i ) {
+         auto group = std::make_shared< Group >();
+         for ( long j = 0; j < leaves; ++j ) {
+            auto node = std::make_shared< Node >();
+            auto counter = node->attachComponent< CounterComponent >();
+            auto tag = node->attachComponent< TagComponent >();
+            ComponentMap map;
+            map[ counter->getComponentName() ] = crimild::retain( counter );
+            map[ tag->getComponentName() ] = crimild::retain( tag );
+            if ( j % 2 == 0 ) {
+               auto materials = node->attachComponent< MaterialComponent >();
+               map[ materials->getComponentName() ] = crimild::retain( materials );
+            }
+            scene.nodes.push_back( crimild::get_ptr( node ) );
+            scene.maps.push_back( std::move( map ) );
+            group->attachNode( node );
+         }
+         scene.root->attachNode( group );
+      }
+      return scene;
+   }
+
+   volatile size_t sink = 0;
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto groups = benchmark::getArg( argc, argv, "groups", 100 );
+   const auto leaves = benchmark::getArg( argc, argv, "leaves", 1000 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 20 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 5 ) );
+
+   auto scene = buildScene( groups, leaves );
+   const auto count = double( scene.nodes.size() );
+
+   benchmark::printHeader( "NodeComponent" );
+   std::printf( "%zu nodes, %ld frames\n", scene.nodes.size(), frames );
+
+   const auto mapLookup = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         size_t found = 0;
+         for ( auto &map : scene.maps ) {
+            auto it = map.find( MaterialComponent::__CLASS_NAME );
+            found += it != map.end() && it->second != nullptr;
+         }
+         sink = found;
+      }
+   );
+
+   const auto typeLookup = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         size_t found = 0;
+         for ( auto node : scene.nodes ) {
+            found += node->getComponent< MaterialComponent >() != nullptr;
+         }
+         sink = found;
+      }
+   );
+
+   const auto missingLookup = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         size_t found = 0;
+         for ( auto node : scene.nodes ) {
+            found += node->getComponent< RotationComponent >() != nullptr;
+         }
+         sink = found;
+      }
+   );
+
+   Clock clock;
+
+   // Visits every node and copies its component map before updating, like UpdateComponents used to
+   const auto legacy = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            size_t next = 0;
+            scene.root->perform(
+               Apply(
+                  [ & ]( Node *node ) {
+                     if ( next < scene.nodes.size() && scene.nodes[ next ] == node ) {
+                        auto cs = scene.maps[ next++ ];
+                        for ( auto &it : cs ) {
+                           if ( it.second != nullptr && it.second->isEnabled() ) {
+                              it.second->update( clock );
+                           }
+                        }
+                     }
+                  }
+               )
+            );
+         }
+      }
+   );
+
+   const auto nodeMajor = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            scene.root->perform( Apply( [ &clock ]( Node *node ) { node->updateComponents( clock ); } ) );
+         }
+      }
+   );
+
+   const auto typeMajor = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            scene.root->perform( UpdateComponents( clock ) );
+         }
+      }
+   );
+
+   benchmark::report( "getComponent (std::map by name)", mapLookup, count, "lookups" );
+   benchmark::report( "getComponent (type id)", typeLookup, count, "lookups" );
+   benchmark::report( "getComponent (type id, missing)", missingLookup, count, "lookups" );
+   benchmark::reportSpeedup( "getComponent", mapLookup, typeLookup );
+
+   benchmark::report( "update components (std::map per node)", legacy / frames, 1.0, "frames" );
+   benchmark::report( "update components (per node)", nodeMajor / frames, 1.0, "frames" );
+   benchmark::report( "update components (per type)", typeMajor / frames, 1.0, "frames" );
+   benchmark::reportSpeedup( "UpdateComponents", legacy, typeMajor );
+
+   return 0;
+}
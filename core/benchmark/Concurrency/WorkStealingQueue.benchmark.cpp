@@ -0,0 +1,191 @@
+#include "Benchmark.hpp"
+#include "Concurrency/WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief The mutex-based queue WorkStealingQueue used to be, kept as reference
+    */
+   template< class T >
+   class LockedWorkStealingQueue {
+      using Lock = std::lock_guard< std::mutex >;
+
+   public:
+      explicit LockedWorkStealingQueue( size_t = 0 ) { }
+
+      bool empty( void )
+      {
+         Lock lock( _mutex );
+         return _elems.empty();
+      }
+
+      void push( T const &elem )
+      {
+         Lock lock( _mutex );
+         _elems.push_back( elem );
+      }
+
+      T pop( void )
+      {
+         Lock lock( _mutex );
+         if ( _elems.empty() ) {
+            return T {};
+         }
+         auto e = _elems.back();
+         _elems.pop_back();
+         return e;
+      }
+
+      T steal( void )
+      {
+         Lock lock( _mutex );
+         if ( _elems.empty() ) {
+            return T {};
+         }
+         auto e = _elems.front();
+         _elems.pop_front();
+         return e;
+      }
+
+   private:
+      std::list< T > _elems;
+      std::mutex _mutex;
+   };
+
+   struct Task {
+      size_t value = 0;
+   };
+
+   /**
+      \brief Simulates a scheduler workload
+
+      Each thread owns a queue and pushes tasks in bursts, consuming part of
+      them right away and leaving the rest for thieves. Once done pushing,
+      threads drain their own queues and steal from others until every task
+      has been consumed.
+    */
+   template< template< class > class QueueType >
+   double run( size_t threadCount, size_t tasksPerThread )
+   {
+      constexpr size_t BURST = 64;
+      constexpr size_t FLUSH = 64;
+
+      std::vector< std::unique_ptr< QueueType< Task * > > > queues;
+      for ( size_t i = 0; i < threadCount; ++i ) {
+         queues.push_back( std::make_unique< QueueType< Task * > >( 1024 ) );
+      }
+
+      std::vector< Task > tasks( threadCount * tasksPerThread );
+      const size_t total = tasks.size();
+      std::atomic< size_t > consumed( 0 );
+      std::atomic< bool > go( false );
+
+      auto worker = [ & ]( size_t id ) {
+         auto &queue = *queues[ id ];
+         auto *myTasks = tasks.data() + id * tasksPerThread;
+         size_t local = 0;
+
+         auto consume = [ & ]( Task *t ) {
+            t->value++;
+            if ( ++local == FLUSH ) {
+               consumed.fetch_add( local, std::memory_order_relaxed );
+               local = 0;
+            }
+         };
+
+         while ( !go.load( std::memory_order_acquire ) ) {
+            std::this_thread::yield();
+         }
+
+         for ( size_t i = 0; i < tasksPerThread; i += BURST ) {
+            const auto end = std::min( tasksPerThread, i + BURST );
+            for ( size_t j = i; j < end; ++j ) {
+               queue.push( &myTasks[ j ] );
+            }
+            for ( size_t j = 0; j < BURST / 2; ++j ) {
+               if ( auto t = queue.pop() ) {
+                  consume( t );
+               }
+            }
+         }
+
+         size_t victim = id;
+         while ( consumed.load( std::memory_order_relaxed ) + local < total ) {
+            if ( auto t = queue.pop() ) {
+               consume( t );
+               continue;
+            }
+            if ( local > 0 ) {
+               consumed.fetch_add( local, std::memory_order_relaxed );
+               local = 0;
+            }
+            victim = ( victim + 1 ) % threadCount;
+            if ( victim != id ) {
+               if ( auto t = queues[ victim ]->steal() ) {
+                  consume( t );
+               }
+            }
+         }
+         consumed.fetch_add( local, std::memory_order_relaxed );
+      };
+
+      std::vector< std::thread > threads;
+      for ( size_t i = 0; i < threadCount; ++i ) {
+         threads.emplace_back( worker, i );
+      }
+
+      const auto seconds = benchmark::measure(
+         [ & ] {
+            go.store( true, std::memory_order_release );
+            for ( auto &t : threads ) {
+               t.join();
+            }
+         }
+      );
+
+      for ( const auto &t : tasks ) {
+         if ( t.value != 1 ) {
+            std::printf( "ERROR: task consumed %zu times\n", t.value );
+            std::exit( 1 );
+         }
+      }
+
+      return seconds;
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto tasksPerThread = size_t( benchmark::getArg( argc, argv, "tasks", 200000 ) );
+   const auto maxThreads = size_t( benchmark::getArg( argc, argv, "threads", 64 ) );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   benchmark::printHeader( "WorkStealingQueue: push/pop/steal throughput" );
+   std::printf( "%zu tasks per thread, best of %d runs\n", tasksPerThread, repetitions );
+
+   for ( size_t threads = 1; threads <= maxThreads; threads *= 2 ) {
+      const auto ops = double( threads * tasksPerThread );
+
+      auto locked = run< LockedWorkStealingQueue >( threads, tasksPerThread );
+      auto lockFree = run< WorkStealingQueue >( threads, tasksPerThread );
+      for ( int i = 1; i < repetitions; ++i ) {
+         locked = std::min( locked, run< LockedWorkStealingQueue >( threads, tasksPerThread ) );
+         lockFree = std::min( lockFree, run< WorkStealingQueue >( threads, tasksPerThread ) );
+      }
+
+      benchmark::report( "mutex + std::list (" + std::to_string( threads ) + " threads)", locked, ops, "tasks" );
+      benchmark::report( "chase-lev (" + std::to_string( threads ) + " threads)", lockFree, ops, "tasks" );
+      benchmark::reportSpeedup( "chase-lev (" + std::to_string( threads ) + " threads)", locked, lockFree );
+   }
+
+   return 0;
+}
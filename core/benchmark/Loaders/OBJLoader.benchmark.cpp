@@ -0,0 +1,131 @@
+#include "Benchmark.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Loaders/OBJLoader.hpp"
+#include "Loaders/OBJParser.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief Writes a grid of size * size quads with positions, texture coordinates and normals
+
+      Each quad is written as two triangles, so most vertices are shared by six of them.
+    */
+   std::string writeGrid( long size )
+   {
+      const auto path = ( std::filesystem::temp_directory_path() / "crimild_benchmark_grid.obj" ).string();
+      std::ofstream out( path );
+      out << "# " << size << "x" << size << " grid\n";
+      out << "o Grid\n";
+
+      const auto n = size + 1;
+      for ( long y = 0; y < n; ++y ) {
+         for ( long x = 0; x < n; ++x ) {
+            const auto u = double( x ) / double( size );
+            const auto v = double( y ) / double( size );
+            out << "v " << u * 100.0 - 50.0 << " " << 0.25 * ( ( x * 7 + y * 13 ) % 17 ) << " " << v * 100.0 - 50.0 << "\n";
+            out << "vt " << u << " " << v << "\n";
+            out << "vn 0 1 0\n";
+         }
+      }
+
+      for ( long y = 0; y < size; ++y ) {
+         for ( long x = 0; x < size; ++x ) {
+            const auto a = y * n + x + 1;
+            const auto b = a + 1;
+            const auto c = a + n;
+            const auto d = c + 1;
+            out << "f " << a << "/" << a << "/" << a << " " << c << "/" << c << "/" << c << " " << b << "/" << b << "/" << b << "\n";
+            out << "f " << b << "/" << b << "/" << b << " " << c << "/" << c << "/" << c << " " << d << "/" << d << "/" << d << "\n";
+         }
+      }
+
+      return path;
+   }
+
+   volatile size_t sink = 0;
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto size = benchmark::getArg( argc, argv, "size", 500 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+   auto path = benchmark::getArg( argc, argv, "path", "" );
+
+   const auto generated = path.empty();
+   if ( generated ) {
+      path = writeGrid( size );
+   }
+
+   const auto megabytes = double( std::filesystem::file_size( path ) ) / ( 1024.0 * 1024.0 );
+
+   benchmark::printHeader( "OBJLoader" );
+   std::printf( "%s (%.1f MB)\n", path.c_str(), megabytes );
+
+   const auto load = [ & ]( OBJLoader::Mode mode, concurrency::TaskSystem *tasks, std::string cacheDirectory = "" ) {
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            if ( tasks != nullptr ) {
+               // Parallel jobs are allocated from per-frame arenas
+               tasks->beginFrame();
+            }
+            OBJLoader loader( path );
+            loader.setMode( mode );
+            loader.setCacheDirectory( cacheDirectory );
+            auto scene = loader.load();
+            sink = scene->getNodeCount();
+         }
+      );
+   };
+
+   const auto stream = load( OBJLoader::Mode::STREAM, nullptr );
+   const auto mapped = load( OBJLoader::Mode::MAPPED, nullptr );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+   const auto parallel = load( OBJLoader::Mode::MAPPED, &tasks );
+   const auto parseOnly = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         tasks.beginFrame();
+         OBJParser parser;
+         parser.parseFile( path );
+         sink = parser.getTriangleCount();
+      }
+   );
+
+   // The first load (not measured) writes the cache file
+   const auto cacheDirectory = ( std::filesystem::temp_directory_path() / "crimild_benchmark_mesh_cache" ).string();
+   std::filesystem::remove_all( cacheDirectory );
+   load( OBJLoader::Mode::MAPPED, &tasks, cacheDirectory );
+   const auto cached = load( OBJLoader::Mode::MAPPED, &tasks, cacheDirectory );
+   tasks.stop();
+
+   const auto workerCount = std::to_string( tasks.getNumWorkers() );
+   benchmark::report( "stream (ifstream + stringstream)", stream, megabytes, "MB" );
+   benchmark::report( "mapped, 1 thread", mapped, megabytes, "MB" );
+   benchmark::report( "mapped, " + workerCount + " workers", parallel, megabytes, "MB" );
+   benchmark::report( "parse only, " + workerCount + " workers", parseOnly, megabytes, "MB" );
+   benchmark::report( "mesh cache", cached, megabytes, "MB" );
+   benchmark::reportSpeedup( "mapped", stream, mapped );
+   benchmark::reportSpeedup( "mapped, parallel", stream, parallel );
+   benchmark::reportSpeedup( "mesh cache", parallel, cached );
+
+   std::filesystem::remove_all( cacheDirectory );
+
+   if ( generated ) {
+      std::filesystem::remove( path );
+   }
+
+   return 0;
+}
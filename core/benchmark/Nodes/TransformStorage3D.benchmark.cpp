@@ -0,0 +1,114 @@
+#include "Benchmark.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Nodes/3D/Spatial3D.hpp"
+#include "Nodes/3D/TransformStorage3D.hpp"
+
+#include <crimild/math/rotation.hpp>
+#include <crimild/math/translation.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::experimental;
+
+namespace {
+
+   struct Scene {
+      std::shared_ptr< Spatial3D > root;
+      std::vector< std::shared_ptr< Spatial3D > > groups;
+      std::vector< std::shared_ptr< Spatial3D > > leaves;
+   };
+
+   /**
+      \brief Builds a three-level hierarchy with branching * branching * leaves nodes
+    */
+   Scene buildScene( long branching, long leaves )
+   {
+      Scene scene;
+      scene.root = std::make_shared< Spatial3D >();
+      for ( long i = 0; i < branching; ++i ) {
+         auto a = scene.root->attach< Spatial3D >();
+         a->setLocal( translation( Real( i ), 0, 0 ) );
+         for ( long j = 0; j < branching; ++j ) {
+            auto b = a->attach< Spatial3D >();
+            b->setLocal( translation( 0, Real( j ), 0 ) );
+            scene.groups.push_back( b );
+            for ( long k = 0; k < leaves; ++k ) {
+               auto leaf = b->attach< Spatial3D >();
+               leaf->setLocal( translation( 0, 0, Real( k ) ) );
+               scene.leaves.push_back( leaf );
+            }
+         }
+      }
+      return scene;
+   }
+
+   volatile Real sink = 0;
+
+   /**
+      \brief Moves every group and reads the world transformation of all leaves
+    */
+   template< typename UpdateFn >
+   double run( Scene &scene, long frames, UpdateFn &&update )
+   {
+      Real sum = 0;
+      const auto ret = benchmark::measure(
+         [ & ] {
+            for ( long frame = 0; frame < frames; ++frame ) {
+               for ( auto &group : scene.groups ) {
+                  group->setLocal( rotationY( Real( frame ) )( translation( 0, 1, 0 ) ) );
+               }
+               update();
+               for ( const auto &leaf : scene.leaves ) {
+                  sum += leaf->getWorld().translate.x;
+               }
+            }
+         }
+      );
+      // Prevent the compiler from discarding reads
+      sink = sum;
+      return ret;
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto branching = benchmark::getArg( argc, argv, "branching", 10 );
+   const auto leaves = benchmark::getArg( argc, argv, "leaves", 1000 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 100 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+
+   auto scene = buildScene( branching, leaves );
+
+   benchmark::printHeader( "TransformStorage3D" );
+   std::printf( "%zu leaves, %ld frames\n", scene.leaves.size(), frames );
+
+   const auto lazy = run( scene, frames, [] {} );
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *scene.root );
+   const auto flat = run( scene, frames, [ & ] { storage.update(); } );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+   const auto parallel = run(
+      scene,
+      frames,
+      [ & ] {
+         tasks.beginFrame();
+         storage.update();
+      }
+   );
+   tasks.stop();
+
+   benchmark::report( "lazy getWorld()", lazy / frames, 1.0, "frames" );
+   benchmark::report( "flat storage", flat / frames, 1.0, "frames" );
+   benchmark::report( "flat storage, " + std::to_string( tasks.getNumWorkers() ) + " workers", parallel / frames, 1.0, "frames" );
+   benchmark::reportSpeedup( "flat storage", lazy, flat );
+   benchmark::reportSpeedup( "flat storage, parallel", lazy, parallel );
+
+   return 0;
+}
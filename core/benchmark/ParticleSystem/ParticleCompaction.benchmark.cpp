@@ -0,0 +1,136 @@
+#include "Benchmark.hpp"
+#include "ParticleSystem/ParticleData.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief Creates particles with the attributes usually found in fire or sparks effects
+    */
+   SharedPointer< ParticleData > createParticles( Size count, Bool lanes )
+   {
+      auto particles = crimild::alloc< ParticleData >( count );
+      particles->setUseAttribLanes( lanes );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::VELOCITY );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::ACCELERATION );
+      particles->createAttribArray< ColorRGBA >( ParticleAttrib::START_COLOR );
+      particles->createAttribArray< ColorRGBA >( ParticleAttrib::END_COLOR );
+      particles->createAttribArray< ColorRGBA >( ParticleAttrib::COLOR );
+      particles->createAttribArray< Real32 >( ParticleAttrib::TIME );
+      particles->createAttribArray< Real32 >( ParticleAttrib::LIFE_TIME );
+      particles->generate();
+      for ( Size i = 0; i < count; ++i ) {
+         particles->wake( i );
+      }
+      return particles;
+   }
+
+   /**
+      \brief Random particles dying each frame, sorted in descending order
+    */
+   std::vector< std::vector< Size > > createDeaths( Size count, long frames, Real64 churn )
+   {
+      std::mt19937 rng( 1234 );
+      std::bernoulli_distribution dies( churn );
+
+      std::vector< std::vector< Size > > deaths( frames );
+      for ( auto &frame : deaths ) {
+         for ( auto i = count; i > 0; --i ) {
+            if ( dies( rng ) ) {
+               frame.push_back( i - 1 );
+            }
+         }
+      }
+      return deaths;
+   }
+
+   /**
+      \brief Kills particles for all frames, waking new ones after each frame to keep the system full
+    */
+   template< typename KillFn >
+   double run( ParticleData &particles, const std::vector< std::vector< Size > > &deaths, int repetitions, KillFn &&kill )
+   {
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            for ( const auto &frame : deaths ) {
+               kill( frame );
+               while ( particles.getAliveCount() < particles.getParticleCount() ) {
+                  particles.wake( particles.getAliveCount() );
+               }
+            }
+         }
+      );
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto count = Size( benchmark::getArg( argc, argv, "particles", 100000 ) );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 100 );
+   const auto churn = benchmark::getArg( argc, argv, "churn", 10 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 5 ) );
+
+   const auto deaths = createDeaths( count, frames, Real64( churn ) / 100.0 );
+   Size kills = 0;
+   for ( const auto &frame : deaths ) {
+      kills += frame.size();
+   }
+
+   benchmark::printHeader( "Particle Compaction" );
+   std::printf( "%zu particles, 8 attributes, %ld frames, %ld%% dying per frame\n", count, frames, churn );
+
+   auto particles = createParticles( count, false );
+   const auto legacy = run(
+      *particles,
+      deaths,
+      repetitions,
+      [ &particles ]( const std::vector< Size > &frame ) {
+         for ( auto pid : frame ) {
+            particles->kill( pid );
+         }
+      }
+   );
+
+   const auto compact = run(
+      *particles,
+      deaths,
+      repetitions,
+      [ &particles ]( const std::vector< Size > &frame ) {
+         for ( auto pid : frame ) {
+            particles->markDead( pid );
+         }
+         particles->compact();
+      }
+   );
+
+   auto lanes = createParticles( count, true );
+   const auto compactLanes = run(
+      *lanes,
+      deaths,
+      repetitions,
+      [ &lanes ]( const std::vector< Size > &frame ) {
+         for ( auto pid : frame ) {
+            lanes->markDead( pid );
+         }
+         lanes->compact();
+      }
+   );
+
+   benchmark::report( "kill (swap per particle)", legacy / frames, 1.0, "frames" );
+   benchmark::report( "markDead + compact", compact / frames, 1.0, "frames" );
+   benchmark::report( "markDead + compact (lanes)", compactLanes / frames, 1.0, "frames" );
+   benchmark::report( "kill (swap per particle)", legacy, double( kills ), "kills" );
+   benchmark::report( "markDead + compact", compact, double( kills ), "kills" );
+   benchmark::reportSpeedup( "compact", legacy, compact );
+   benchmark::reportSpeedup( "compact (lanes)", legacy, compactLanes );
+
+   return 0;
+}
@@ -0,0 +1,101 @@
+#include "Benchmark.hpp"
+#include "ParticleSystem/ParticleData.hpp"
+#include "ParticleSystem/ParticleKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief Creates particles with random positions and the attributes usually required for rendering
+    */
+   SharedPointer< ParticleData > createParticles( Size count )
+   {
+      auto particles = crimild::alloc< ParticleData >( count );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::VELOCITY );
+      particles->createAttribArray< ColorRGBA >( ParticleAttrib::COLOR );
+      particles->createAttribArray< Real32 >( ParticleAttrib::UNIFORM_SCALE );
+      particles->createAttribArray< Real32 >( ParticleAttrib::TIME );
+      particles->createAttribArray< Real32 >( ParticleAttrib::SORT_REFERENCE );
+      particles->generate();
+
+      std::mt19937 rng( 1234 );
+      std::uniform_real_distribution< Real32 > dist( -100.0f, 100.0f );
+      auto ps = particles->getAttrib( ParticleAttrib::POSITION );
+      for ( Size i = 0; i < count; ++i ) {
+         ps->set( i, Vector3f { dist( rng ), dist( rng ), dist( rng ) } );
+         particles->wake( i );
+      }
+      return particles;
+   }
+
+   struct DistanceIndex {
+      Real32 distance;
+      Size index;
+   };
+
+   volatile UInt32 sink = 0;
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto count = Size( benchmark::getArg( argc, argv, "particles", 100000 ) );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 5 ) );
+
+   // The camera moves every frame, so particles are never sorted already
+   const auto getAxis = []( Size frame ) {
+      const auto angle = 0.5f * Real32( frame );
+      return Vector3f { std::sin( angle ), 0, std::cos( angle ) };
+   };
+
+   benchmark::printHeader( "Particle Sort" );
+   std::printf( "%zu particles\n", count );
+
+   // Sorts (distance, index) pairs with comparisons, then swaps every attribute, like updaters used to do
+   auto legacyParticles = createParticles( count );
+   std::vector< DistanceIndex > ds( count );
+   Size frame = 0;
+   const auto legacy = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         const auto axis = getAxis( frame++ );
+         auto ps = legacyParticles->getAttrib( ParticleAttrib::POSITION )->getData< Vector3f >();
+         for ( Size i = 0; i < count; ++i ) {
+            ds[ i ] = DistanceIndex { ps[ i ].x * axis.x + ps[ i ].y * axis.y + ps[ i ].z * axis.z, i };
+         }
+         std::sort( ds.begin(), ds.end(), []( const auto &a, const auto &b ) { return a.distance > b.distance; } );
+         for ( Size i = 0; i < count; ++i ) {
+            if ( ds[ i ].index > i ) {
+               legacyParticles->swap( ds[ i ].index, i );
+            }
+         }
+      }
+   );
+
+   // Only computes keys and sorts indices. Attribute data is not moved
+   auto particles = createParticles( count );
+   frame = 0;
+   const auto radix = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         const auto axis = getAxis( frame++ );
+         auto keys = particles->getAttrib( ParticleAttrib::SORT_REFERENCE )->getData< Real32 >();
+         particles::computeSortKeys( particles->getAttrib( ParticleAttrib::POSITION ), keys, Vector3f { -axis.x, -axis.y, -axis.z }, 0, count );
+         particles->sort( keys );
+         sink = particles->getSortedIndices()[ 0 ];
+      }
+   );
+
+   benchmark::report( "std::sort + swap attributes", legacy, double( count ), "particles" );
+   benchmark::report( "radix sort indices", radix, double( count ), "particles" );
+   benchmark::reportSpeedup( "radix sort", legacy, radix );
+
+   return 0;
+}
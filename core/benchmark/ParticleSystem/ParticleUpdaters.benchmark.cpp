@@ -0,0 +1,194 @@
+#include "Benchmark.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "ParticleSystem/ParticleData.hpp"
+#include "ParticleSystem/Updaters/ColorParticleUpdater.hpp"
+#include "ParticleSystem/Updaters/EulerParticleUpdater.hpp"
+#include "ParticleSystem/Updaters/TimeParticleUpdater.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief Scalar loops over interleaved attributes, like updaters used to do
+    */
+   struct LegacyUpdaters {
+      void update( Real32 dt, ParticleData *particles, const Vector3f &gravity )
+      {
+         const auto count = particles->getAliveCount();
+
+         auto as = particles->getAttrib( ParticleAttrib::ACCELERATION )->getData< Vector3f >();
+         auto vs = particles->getAttrib( ParticleAttrib::VELOCITY )->getData< Vector3f >();
+         auto ps = particles->getAttrib( ParticleAttrib::POSITION )->getData< Vector3f >();
+         auto startColors = particles->getAttrib( ParticleAttrib::START_COLOR )->getData< ColorRGBA >();
+         auto endColors = particles->getAttrib( ParticleAttrib::END_COLOR )->getData< ColorRGBA >();
+         auto colors = particles->getAttrib( ParticleAttrib::COLOR )->getData< ColorRGBA >();
+         auto ts = particles->getAttrib( ParticleAttrib::TIME )->getData< Real32 >();
+         auto lts = particles->getAttrib( ParticleAttrib::LIFE_TIME )->getData< Real32 >();
+
+         // Euler
+         const auto g = dt * gravity;
+         const Size itemsPerCacheLine = 64 / sizeof( Real32 );
+         for ( Size i = 0; i < count; i += itemsPerCacheLine ) {
+            for ( Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
+               as[ j ] += g;
+            }
+         }
+         for ( Size i = 0; i < count; i += itemsPerCacheLine ) {
+            for ( Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
+               vs[ j ] += dt * as[ j ];
+            }
+         }
+         for ( Size i = 0; i < count; i += itemsPerCacheLine ) {
+            for ( Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
+               ps[ j ] += dt * vs[ j ];
+            }
+         }
+
+         // Time
+         for ( Size i = 0; i < count; i++ ) {
+            ts[ i ] -= dt;
+            if ( ts[ i ] <= 0.0f ) {
+               particles->kill( i );
+            }
+         }
+
+         // Color
+         for ( Size i = 0; i < count; i++ ) {
+            const auto &s0 = startColors[ i ];
+            const auto &s1 = endColors[ i ];
+            const auto t = 1.0f - ( ts[ i ] / lts[ i ] );
+            colors[ i ] = ColorRGBA {
+               s0.r + ( s1.r - s0.r ) * t,
+               s0.g + ( s1.g - s0.g ) * t,
+               s0.b + ( s1.b - s0.b ) * t,
+               s0.a + ( s1.a - s0.a ) * t,
+            };
+         }
+      }
+   };
+
+   struct System {
+      SharedPointer< ParticleData > particles;
+      EulerParticleUpdater euler;
+      TimeParticleUpdater time;
+      ColorParticleUpdater color;
+
+      void update( Real32 dt )
+      {
+         euler.update( nullptr, dt, crimild::get_ptr( particles ) );
+         time.update( nullptr, dt, crimild::get_ptr( particles ) );
+         color.update( nullptr, dt, crimild::get_ptr( particles ) );
+         particles->compact();
+      }
+   };
+
+   /**
+      \brief Creates a system with all particles alive. Lifetimes are long enough so none of them die.
+    */
+   std::unique_ptr< System > createSystem( Size count, Bool lanes )
+   {
+      auto system = std::make_unique< System >();
+      system->particles = crimild::alloc< ParticleData >( count );
+      system->particles->setUseAttribLanes( lanes );
+      system->euler.setGlobalAcceleration( Vector3f { 0, -9.8f, 0 } );
+
+      auto particles = crimild::get_ptr( system->particles );
+      system->euler.configure( nullptr, particles );
+      system->time.configure( nullptr, particles );
+      system->color.configure( nullptr, particles );
+      particles->generate();
+
+      auto ps = particles->getAttrib( ParticleAttrib::POSITION );
+      auto vs = particles->getAttrib( ParticleAttrib::VELOCITY );
+      auto startColors = particles->getAttrib( ParticleAttrib::START_COLOR );
+      auto endColors = particles->getAttrib( ParticleAttrib::END_COLOR );
+      auto ts = particles->getAttrib( ParticleAttrib::TIME );
+      auto lts = particles->getAttrib( ParticleAttrib::LIFE_TIME );
+      for ( Size i = 0; i < count; ++i ) {
+         const auto x = Real32( i % 1000 );
+         ps->set( i, Vector3f { x, 0, -x } );
+         vs->set( i, Vector3f { 0, 10, 1 } );
+         startColors->set( i, ColorRGBA { 1, 1, 0, 1 } );
+         endColors->set( i, ColorRGBA { 1, 0, 0, 0 } );
+         ts->set( i, 1000.0f + x );
+         lts->set( i, 1000.0f + x );
+         particles->wake( i );
+      }
+
+      return system;
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto count = Size( benchmark::getArg( argc, argv, "particles", 1000000 ) );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 20 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   const auto dt = 1.0f / 60.0f;
+
+   benchmark::printHeader( "Particle Updaters" );
+   std::printf( "%zu particles, %ld frames\n", count, frames );
+
+   auto legacySystem = createSystem( count, false );
+   LegacyUpdaters legacyUpdaters;
+   const auto legacy = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            legacyUpdaters.update( dt, crimild::get_ptr( legacySystem->particles ), legacySystem->euler.getGlobalAcceleration() );
+         }
+      }
+   );
+
+   auto interleavedSystem = createSystem( count, false );
+   const auto interleaved = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            interleavedSystem->update( dt );
+         }
+      }
+   );
+
+   auto lanesSystem = createSystem( count, true );
+   const auto lanes = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            lanesSystem->update( dt );
+         }
+      }
+   );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+   const auto parallel = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            tasks.beginFrame();
+            lanesSystem->update( dt );
+         }
+      }
+   );
+   tasks.stop();
+
+   benchmark::report( "legacy (scalar, interleaved)", legacy / frames, double( count ), "particles" );
+   benchmark::report( "kernels (interleaved)", interleaved / frames, double( count ), "particles" );
+   benchmark::report( "kernels (lanes)", lanes / frames, double( count ), "particles" );
+   benchmark::report( "kernels (lanes), " + std::to_string( tasks.getNumWorkers() ) + " workers", parallel / frames, double( count ), "particles" );
+   benchmark::reportSpeedup( "kernels (interleaved)", legacy, interleaved );
+   benchmark::reportSpeedup( "kernels (lanes)", legacy, lanes );
+   benchmark::reportSpeedup( "kernels (lanes), parallel", legacy, parallel );
+
+   return 0;
+}
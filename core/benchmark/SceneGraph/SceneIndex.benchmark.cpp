@@ -0,0 +1,148 @@
+#include "Benchmark.hpp"
+#include "Components/MaterialComponent.hpp"
+#include "Primitives/Primitive.hpp"
+#include "Rendering/Material.hpp"
+#include "Rendering/RenderableExtractor.hpp"
+#include "Rendering/RenderableSet.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "SceneGraph/SceneIndex.hpp"
+#include "Visitors/IntersectWorld.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <crimild/math/Random.hpp>
+#include <crimild/math/Ray3.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/translation.hpp>
+#include <memory>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief A cube of spheres, grouped in slices along the X axis
+    */
+   SharedPointer< Group > buildScene( long size )
+   {
+      auto material = crimild::alloc< Material >();
+      auto scene = crimild::alloc< Group >();
+      for ( long i = 0; i < size; ++i ) {
+         auto slice = crimild::alloc< Group >();
+         for ( long j = 0; j < size; ++j ) {
+            for ( long k = 0; k < size; ++k ) {
+               auto geometry = crimild::alloc< Geometry >();
+               geometry->attachPrimitive( crimild::alloc< Primitive >( Primitive::Type::SPHERE ) );
+               geometry->attachComponent< MaterialComponent >( material );
+               geometry->setLocal( translation( 4 * i, 4 * j, -4 * k ) );
+               slice->attachNode( geometry );
+            }
+         }
+         scene->attachNode( slice );
+      }
+      return scene;
+   }
+
+   volatile size_t sink = 0;
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto size = benchmark::getArg( argc, argv, "size", 20 );
+   const auto rayCount = benchmark::getArg( argc, argv, "rays", 200 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 20 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+
+   auto scene = buildScene( size );
+   auto camera = crimild::alloc< Camera >( 45, 1, 0.1f, 4.0f * size );
+   camera->setLocal( translation( 2.0f * size, 2.0f * size, 8 ) );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   SceneIndex index;
+
+   benchmark::printHeader( "SceneIndex" );
+
+   const auto build = benchmark::measureBest( repetitions, [ & ] { index.build( crimild::get_ptr( scene ) ); } );
+   std::printf( "%zu items, %zu nodes, %ld rays\n", index.getItemCount(), index.getNodeCount(), rayCount );
+
+   const auto refit = benchmark::measureBest( repetitions, [ & ] { index.update(); } );
+
+   Random::Generator rnd( 1982 );
+   std::vector< Ray3 > rays;
+   for ( long i = 0; i < rayCount; ++i ) {
+      rays.push_back(
+         Ray3 {
+            camera->getWorld().translate,
+            normalize( Vector3 { Real( rnd.generate( -0.4, 0.4 ) ), Real( rnd.generate( -0.4, 0.4 ) ), -1 } ),
+         }
+      );
+   }
+
+   const auto traverseRays = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         size_t hits = 0;
+         for ( const auto &R : rays ) {
+            IntersectWorld::Results results;
+            scene->perform( IntersectWorld( R, results ) );
+            hits += results.size();
+         }
+         sink = hits;
+      }
+   );
+
+   const auto indexedRays = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         size_t hits = 0;
+         for ( const auto &R : rays ) {
+            IntersectWorld::Results results;
+            scene->perform( IntersectWorld( R, results, &index ) );
+            hits += results.size();
+         }
+         sink = hits;
+      }
+   );
+
+   RenderableExtractor extractor;
+   extractor.setParallelEnabled( false );
+   RenderableSet lit, unlit, env;
+
+   const auto traverseFrustum = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            unlit.reset();
+            extractor.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &lit, &unlit, &env );
+         }
+         sink = extractor.getStats().emitted;
+      }
+   );
+
+   const auto indexedFrustum = benchmark::measureBest(
+      repetitions,
+      [ & ] {
+         for ( long frame = 0; frame < frames; ++frame ) {
+            unlit.reset();
+            extractor.extract( &index, crimild::get_ptr( camera ), &lit, &unlit, &env );
+         }
+         sink = extractor.getStats().emitted;
+      }
+   );
+   std::printf( "%llu of %zu items in frustum\n", (unsigned long long) extractor.getStats().emitted, index.getItemCount() );
+
+   benchmark::report( "build", build, 1.0, "builds" );
+   benchmark::report( "refit", refit, 1.0, "refits" );
+   benchmark::report( "IntersectWorld (scene)", traverseRays, double( rayCount ), "rays" );
+   benchmark::report( "IntersectWorld (index)", indexedRays, double( rayCount ), "rays" );
+   benchmark::reportSpeedup( "IntersectWorld", traverseRays, indexedRays );
+   benchmark::report( "extract renderables (scene)", traverseFrustum / frames, 1.0, "frames" );
+   benchmark::report( "extract renderables (index)", indexedFrustum / frames, 1.0, "frames" );
+   benchmark::reportSpeedup( "extract renderables", traverseFrustum, indexedFrustum );
+
+   return 0;
+}
@@ -0,0 +1,153 @@
+#include "Benchmark.hpp"
+#include "Components/LambdaComponent.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Simulation/Clock.hpp"
+#include "Simulation/FramePipeline.hpp"
+#include "Visitors/ApplyToGeometries.hpp"
+#include "Visitors/UpdateComponents.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <cmath>
+#include <crimild/math/Matrix4.hpp>
+#include <crimild/math/rotation.hpp>
+#include <crimild/math/translation.hpp>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief Builds a scene with groups of animated geometries
+
+      Each geometry spins around its group and does some extra math to simulate
+      the cost of evaluating an animation.
+    */
+   SharedPointer< Group > buildScene( long groupCount, long nodesPerGroup, long work )
+   {
+      auto scene = std::make_shared< Group >();
+      for ( long i = 0; i < groupCount; ++i ) {
+         auto group = std::make_shared< Group >();
+         group->setLocal( translation( Real( i % 100 ), 0, Real( i / 100 ) ) );
+         for ( long j = 0; j < nodesPerGroup; ++j ) {
+            auto geometry = std::make_shared< Geometry >();
+            const auto phase = Real( j ) / Real( nodesPerGroup );
+            auto update = geometry->attachComponent< LambdaComponent >(
+               [ phase, work ]( Node *node, const Clock &clock ) {
+                  auto angle = Real( clock.getAccumTime() ) + phase;
+                  for ( long k = 0; k < work; ++k ) {
+                     angle = angle + Real( 0.001 ) * std::sin( angle ) * std::cos( angle );
+                  }
+                  node->setLocal( rotationY( angle )( translation( 1, 0, 0 ) ) );
+               }
+            );
+            // Only local transformations are modified, so it can run while recording
+            update->setRenderSafe( true );
+            group->attachNode( geometry );
+         }
+         scene->attachNode( group );
+      }
+      scene->perform( UpdateWorldState() );
+      return scene;
+   }
+
+   /**
+      \brief Emulates command recording by computing per-instance model matrices
+    */
+   struct Recorder {
+      std::vector< Matrix4f > instances;
+
+      void begin( void ) { instances.clear(); }
+      void record( const Transformation &world ) { instances.push_back( Matrix4f( world ) ); }
+   };
+
+   double runSerial( Node *scene, long frames )
+   {
+      Clock clock;
+      Recorder recorder;
+      auto tasks = concurrency::TaskSystem::getInstance();
+
+      return benchmark::measure(
+         [ & ] {
+            for ( long i = 0; i < frames; ++i ) {
+               tasks->beginFrame();
+               clock += 1.0 / 60.0;
+
+               // Same sequence as Simulation::step() when pipelining is disabled
+               recorder.begin();
+               scene->perform( ApplyToGeometries( [ & ]( Geometry *geometry ) { recorder.record( geometry->getWorld() ); } ) );
+               scene->perform( UpdateComponents( clock ) );
+               scene->perform( UpdateWorldState() );
+            }
+         }
+      );
+   }
+
+   double runPipelined( Node *scene, long frames )
+   {
+      Clock clock;
+      Recorder recorder;
+      auto tasks = concurrency::TaskSystem::getInstance();
+      FramePipeline pipeline;
+      pipeline.setEnabled( true );
+
+      const auto t = benchmark::measure(
+         [ & ] {
+            for ( long i = 0; i < frames; ++i ) {
+               tasks->beginFrame();
+               clock += 1.0 / 60.0;
+
+               pipeline.execute(
+                  scene,
+                  clock,
+                  [ & ] {
+                     recorder.begin();
+                     if ( auto snapshot = pipeline.getPublishedSnapshot() ) {
+                        for ( const auto &renderable : snapshot->renderables ) {
+                           recorder.record( renderable.world );
+                        }
+                     }
+                     return true;
+                  }
+               );
+            }
+            pipeline.flush();
+         }
+      );
+
+      pipeline.reset();
+      return t;
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto groups = benchmark::getArg( argc, argv, "groups", 100 );
+   const auto nodesPerGroup = benchmark::getArg( argc, argv, "nodes", 50 );
+   const auto work = benchmark::getArg( argc, argv, "work", 64 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 200 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( int( workers ) );
+   tasks.start();
+
+   auto scene = buildScene( groups, nodesPerGroup, work );
+
+   benchmark::printHeader( "Simulation frame pipeline (headless)" );
+   std::printf( "%ld nodes, %d workers, %ld frames\n", groups * nodesPerGroup, tasks.getNumWorkers(), frames );
+
+   const auto serial = runSerial( crimild::get_ptr( scene ), frames );
+   const auto pipelined = runPipelined( crimild::get_ptr( scene ), frames );
+
+   benchmark::report( "serial", serial, double( frames ), "frames" );
+   benchmark::report( "pipelined", pipelined, double( frames ), "frames" );
+   benchmark::reportSpeedup( "pipelined", serial, pipelined );
+
+   tasks.stop();
+
+   return 0;
+}
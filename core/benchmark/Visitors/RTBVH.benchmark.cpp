@@ -0,0 +1,409 @@
+#include "Benchmark.hpp"
+#include "Components/MaterialComponent.hpp"
+#include "Loaders/OBJLoader.hpp"
+#include "Primitives/Primitive.hpp"
+#include "Primitives/SpherePrimitive.hpp"
+#include "Rendering/Materials/PrincipledBSDFMaterial.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "SceneGraph/Node_withTransformation.hpp"
+#include "Visitors/BinTreeScene.hpp"
+#include "Visitors/RTAcceleration.hpp"
+#include "Visitors/RTBVH.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <algorithm>
+#include <crimild/math/Random.hpp>
+#include <crimild/math/length.hpp>
+#include <crimild/math/lookAt.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/scale.hpp>
+#include <crimild/math/translation.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   struct Scene {
+      std::string name;
+      SharedPointer< Group > root;
+      SharedPointer< Camera > camera;
+   };
+
+   SharedPointer< Material > lambertian( const ColorRGB &albedo )
+   {
+      auto material = crimild::alloc< materials::PrincipledBSDF >();
+      material->setAlbedo( albedo );
+      return material;
+   }
+
+   SharedPointer< Node > withMaterial( SharedPointer< Node > const &node, SharedPointer< Material > const &material )
+   {
+      node->attachComponent< MaterialComponent >( material );
+      return node;
+   }
+
+   SharedPointer< Camera > createCamera( Real fov, const Point3f &eye, const Point3f &target )
+   {
+      auto camera = crimild::alloc< Camera >( fov, 4.0f / 3.0f, 0.1f, 1000.0f );
+      camera->setLocal( lookAt( eye, target, Vector3::Constants::UP ) );
+      return camera;
+   }
+
+   /**
+      \brief Same layout as the RT_Cornell example
+    */
+   Scene buildCornell( void )
+   {
+      auto scene = crimild::alloc< Group >();
+
+      auto box = [ primitive = crimild::alloc< Primitive >( Primitive::Type::BOX ) ]() -> SharedPointer< Node > {
+         auto geometry = crimild::alloc< Geometry >();
+         geometry->attachPrimitive( primitive );
+         return geometry;
+      };
+
+      auto emissive = crimild::alloc< materials::PrincipledBSDF >();
+      emissive->setEmissive( ColorRGB { 10, 10, 10 } );
+
+      auto room = crimild::alloc< Group >();
+      const Real w = 1.25;
+      const Real h = 1.25;
+      const Real d = 0.01;
+      room->attachNode( withTranslation( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 1, 1 } ) ), w, d, h ), 0, -h, 0 ) );
+      room->attachNode( withTranslation( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 1, 1 } ) ), w, d, h ), 0, h, 0 ) );
+      room->attachNode( withTranslation( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 1, 1 } ) ), w, h, d ), 0, 0, -h ) );
+      room->attachNode( withTranslation( withScale( withMaterial( box(), lambertian( ColorRGB { 0, 1, 0 } ) ), d, h, h ), w, 0, 0 ) );
+      room->attachNode( withTranslation( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 0, 0 } ) ), d, h, h ), -w, 0, 0 ) );
+      room->attachNode( withTranslation( withScale( withMaterial( box(), emissive ), w / 4, d, w / 4 ), 0, h - d, 0 ) );
+      scene->attachNode( withScale( withTranslation( room, 0, h, 0 ), 3 ) );
+
+      scene->attachNode( withTranslation( withRotationY( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 1, 1 } ) ), 1.1 ), 2.5 ), 1.25, 1.1, 1.25 ) );
+      scene->attachNode( withTranslation( withRotationY( withScale( withMaterial( box(), lambertian( ColorRGB { 1, 1, 1 } ) ), 1, 2.5, 1 ), 0.25 ), -1.5, 2.5, -1.5 ) );
+
+      return Scene { "Cornell", scene, createCamera( 45, Point3f { 0, 3.5, 15 }, Point3f { 0, 3.5, 0 } ) };
+   }
+
+   /**
+      \brief Same layout as the RT_Spheres example (with lambertian materials only)
+    */
+   Scene buildSpheres( void )
+   {
+      auto scene = crimild::alloc< Group >();
+
+      auto primitive = crimild::alloc< Primitive >( Primitive::Type::SPHERE );
+      auto sphere = [ & ]( const Point3f &center, Real radius, const ColorRGB &albedo ) {
+         auto geometry = crimild::alloc< Geometry >();
+         geometry->attachPrimitive( primitive );
+         geometry->setLocal( translation( Vector3f( center ) )( scale( radius ) ) );
+         geometry->attachComponent< MaterialComponent >( lambertian( albedo ) );
+         return geometry;
+      };
+
+      scene->attachNode( sphere( Point3f { 0, -1000, 0 }, 1000, ColorRGB { 0.5, 0.5, 0.5 } ) );
+
+      auto rnd = Random::Generator( 1982 );
+      for ( auto a = -11; a < 11; a++ ) {
+         for ( auto b = -11; b < 11; b++ ) {
+            const auto center = Point3f {
+               a + 0.9f * Real( rnd.generate( 0.0f, 1.0f ) ),
+               0.2,
+               b + 0.9f * Real( rnd.generate( 0.0f, 1.0f ) ),
+            };
+            if ( length( center - Point3f { 4, 0.2, 0 } ) > 0.9f ) {
+               scene->attachNode( sphere( center, 0.2, ColorRGB { 0.5, 0.5, 0.5 } ) );
+            }
+         }
+      }
+
+      scene->attachNode( sphere( Point3f { 0, 1, 0 }, 1.0, ColorRGB { 1, 1, 1 } ) );
+      scene->attachNode( sphere( Point3f { -4, 1, 0 }, 1.0, ColorRGB { 0.4, 0.2, 0.1 } ) );
+      scene->attachNode( sphere( Point3f { 4, 1, 0 }, 1.0, ColorRGB { 0.7, 0.6, 0.5 } ) );
+
+      return Scene { "Spheres", scene, createCamera( 20, Point3f { 13, 2, 3 }, Point3f { 0, 0, 0 } ) };
+   }
+
+   /**
+      \brief Loads an OBJ file, like the RT_OBJ example
+
+      If no file is provided, a few dense tessellated spheres are used instead
+    */
+   Scene buildMeshes( const std::string &path, long divisions )
+   {
+      auto scene = crimild::alloc< Group >();
+
+      if ( !path.empty() ) {
+         OBJLoader loader( path );
+         if ( auto model = loader.load() ) {
+            scene->attachNode( model );
+         }
+      } else {
+         auto mesh = crimild::alloc< SpherePrimitive >(
+            SpherePrimitive::Params {
+               .divisions = Vector2i { Int32( divisions ), Int32( divisions ) },
+            }
+         );
+         for ( auto i = 0; i < 3; ++i ) {
+            auto geometry = crimild::alloc< Geometry >();
+            geometry->attachPrimitive( mesh );
+            geometry->attachComponent< MaterialComponent >( lambertian( ColorRGB { 0.8, 0.8, 0.8 } ) );
+            geometry->setLocal( translation( 2.5f * ( i - 1 ), 0, -i ) );
+            scene->attachNode( geometry );
+         }
+      }
+
+      return Scene { "OBJ", scene, createCamera( 60, Point3f { 3, 3, 3 }, Point3f { 0, 0, 0 } ) };
+   }
+
+   volatile Real sink = 0;
+
+   /**
+      \brief Traces all rays, returning the best time
+    */
+   template< typename IntersectFn >
+   double trace( const std::vector< Ray3 > &rays, int repetitions, IntersectFn &&intersect )
+   {
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            Real sum = 0;
+            for ( const auto &R : rays ) {
+               RTIntersection result;
+               if ( intersect( R, result ) ) {
+                  sum += result.t;
+               }
+            }
+            sink = sum;
+         }
+      );
+   }
+
+   /**
+      \brief Traces all rays in packets, returning the best time
+    */
+   double tracePackets( const std::vector< Ray3 > &rays, int repetitions, const RTSceneBVH &bvh )
+   {
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            Real sum = 0;
+            RTRayPacket packet;
+            for ( size_t begin = 0; begin < rays.size(); begin += RTRayPacket::SIZE ) {
+               packet.reset();
+               for ( auto i = begin; i < std::min( rays.size(), begin + RTRayPacket::SIZE ); ++i ) {
+                  packet.add( rays[ i ] );
+               }
+               bvh.intersect( packet );
+               for ( UInt32 l = 0; l < packet.getCount(); ++l ) {
+                  RTIntersection result;
+                  if ( bvh.resolve( packet, l, result ) ) {
+                     sum += result.t;
+                  }
+               }
+            }
+            sink = sum;
+         }
+      );
+   }
+
+   Ray3 diffuse( const RTIntersection &result, Random::Generator &rnd )
+   {
+      const auto dir = normalize(
+         Vector3 {
+            Real( rnd.generate( -1, 1 ) ),
+            Real( rnd.generate( -1, 1 ) ),
+            Real( rnd.generate( -1, 1 ) ),
+         }
+      );
+      return Ray3 { result.point, Vector3( result.normal ) + dir };
+   }
+
+   /**
+      \brief Traces one sample for each primary ray, one ray at a time
+
+      Rays keep bouncing in random directions until they miss or reach the bounce limit.
+    */
+   double traceSamples( const std::vector< Ray3 > &primary, long bounces, int repetitions, const RTSceneBVH &bvh )
+   {
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            auto rnd = Random::Generator( 1982 );
+            Real sum = 0;
+            for ( const auto &P : primary ) {
+               auto R = P;
+               for ( long bounce = 0; bounce <= bounces; ++bounce ) {
+                  RTIntersection result;
+                  if ( !bvh.intersect( R, result ) ) {
+                     break;
+                  }
+                  sum += result.t;
+                  R = diffuse( result, rnd );
+               }
+            }
+            sink = sum;
+         }
+      );
+   }
+
+   /**
+      \brief Same as traceSamples(), but tracing packets one bounce at a time, like SoftRT does with rt.tracing=stream
+
+      Remaining rays are sorted by direction after each bounce (included in the measured time).
+    */
+   double traceSampleStreams( const std::vector< Ray3 > &primary, long bounces, int repetitions, const RTSceneBVH &bvh )
+   {
+      std::vector< std::pair< UInt32, Ray3 > > stream;
+      std::vector< std::pair< UInt32, Ray3 > > next;
+      stream.reserve( primary.size() );
+      next.reserve( primary.size() );
+
+      return benchmark::measureBest(
+         repetitions,
+         [ & ] {
+            auto rnd = Random::Generator( 1982 );
+            Real sum = 0;
+
+            stream.clear();
+            for ( const auto &R : primary ) {
+               stream.push_back( { 0, R } );
+            }
+
+            RTRayPacket packet;
+            for ( long bounce = 0; bounce <= bounces && !stream.empty(); ++bounce ) {
+               next.clear();
+               for ( size_t begin = 0; begin < stream.size(); begin += RTRayPacket::SIZE ) {
+                  packet.reset();
+                  for ( auto i = begin; i < std::min( stream.size(), begin + RTRayPacket::SIZE ); ++i ) {
+                     packet.add( stream[ i ].second );
+                  }
+                  bvh.intersect( packet );
+                  for ( UInt32 l = 0; l < packet.getCount(); ++l ) {
+                     RTIntersection result;
+                     if ( bvh.resolve( packet, l, result ) ) {
+                        sum += result.t;
+                        const auto R = diffuse( result, rnd );
+                        next.push_back( { RTRayPacket::getSortKey( R ), R } );
+                     }
+                  }
+               }
+               std::sort( next.begin(), next.end(), []( const auto &a, const auto &b ) { return a.first < b.first; } );
+               std::swap( stream, next );
+            }
+
+            sink = sum;
+         }
+      );
+   }
+
+   void run( Scene &scene, long width, long height, long bounces, int repetitions )
+   {
+      scene.root->attachNode( scene.camera );
+      scene.root->perform( UpdateWorldState() );
+
+      auto accelerated = scene.root->perform< BinTreeScene >( BinTreeScene::SplitStrategy::RANDOM_AXIS )->perform< RTAcceleration >();
+
+      RTSceneBVH bvh;
+      const auto build = benchmark::measureBest( repetitions, [ & ] { bvh.build( accelerated ); } );
+
+      size_t triangles = 0;
+      for ( const auto &mesh : bvh.getMeshes() ) {
+         triangles += mesh.triangles.size();
+      }
+
+      // Pixels are visited in blocks of 4x2, so each packet of primary rays covers a compact region
+      std::vector< Ray3 > primary;
+      primary.reserve( width * height );
+      for ( long by = 0; by < height; by += 2 ) {
+         for ( long bx = 0; bx < width; bx += 4 ) {
+            for ( long y = by; y < std::min( height, by + 2 ); ++y ) {
+               for ( long x = bx; x < std::min( width, bx + 4 ); ++x ) {
+                  Ray3 R;
+                  if ( scene.camera->getPickRay( Real( x ) / Real( width - 1 ), Real( y ) / Real( height - 1 ), R ) ) {
+                     primary.push_back( R );
+                  }
+               }
+            }
+         }
+      }
+
+      // Diffuse bounces from primary hits are much less coherent
+      auto rnd = Random::Generator( 1982 );
+      std::vector< Ray3 > secondary;
+      for ( const auto &R : primary ) {
+         RTIntersection result;
+         if ( bvh.intersect( R, result ) ) {
+            secondary.push_back( diffuse( result, rnd ) );
+         }
+      }
+
+      auto sorted = secondary;
+      std::sort( sorted.begin(), sorted.end(), []( const Ray3 &a, const Ray3 &b ) { return RTRayPacket::getSortKey( a ) < RTRayPacket::getSortKey( b ); } );
+
+      const auto tree = [ & ]( const Ray3 &R, RTIntersection &result ) { return intersectRTTree( R, accelerated, result ); };
+      const auto bvh4 = [ & ]( const Ray3 &R, RTIntersection &result ) { return bvh.intersect( R, result ); };
+
+      const auto primaryTree = trace( primary, repetitions, tree );
+      const auto primaryBVH = trace( primary, repetitions, bvh4 );
+      const auto secondaryTree = trace( secondary, repetitions, tree );
+      const auto secondaryBVH = trace( secondary, repetitions, bvh4 );
+      const auto primaryPackets = tracePackets( primary, repetitions, bvh );
+      const auto secondaryPackets = tracePackets( secondary, repetitions, bvh );
+      const auto sortedPackets = tracePackets( sorted, repetitions, bvh );
+      const auto samplesScalar = traceSamples( primary, bounces, repetitions, bvh );
+      const auto samplesStream = traceSampleStreams( primary, bounces, repetitions, bvh );
+
+      benchmark::printHeader( ( "RTBVH: " + scene.name ).c_str() );
+      std::printf(
+         "%zu instances, %zu meshes, %zu triangles, %zu top level nodes\n",
+         bvh.getInstances().size(),
+         bvh.getMeshes().size(),
+         triangles,
+         bvh.getTopLevel().getNodes().size()
+      );
+
+      benchmark::report( "build BVH4", build, 1.0, "builds" );
+      benchmark::report( "primary rays (tree)", primaryTree, double( primary.size() ), "rays" );
+      benchmark::report( "primary rays (BVH4)", primaryBVH, double( primary.size() ), "rays" );
+      benchmark::reportSpeedup( "primary rays", primaryTree, primaryBVH );
+      benchmark::report( "diffuse rays (tree)", secondaryTree, double( secondary.size() ), "rays" );
+      benchmark::report( "diffuse rays (BVH4)", secondaryBVH, double( secondary.size() ), "rays" );
+      benchmark::reportSpeedup( "diffuse rays", secondaryTree, secondaryBVH );
+      benchmark::report( "primary rays (BVH4, packets)", primaryPackets, double( primary.size() ), "rays" );
+      benchmark::reportSpeedup( "primary rays, packets", primaryBVH, primaryPackets );
+      benchmark::report( "diffuse rays (BVH4, packets)", secondaryPackets, double( secondary.size() ), "rays" );
+      benchmark::report( "diffuse rays (BVH4, sorted packets)", sortedPackets, double( secondary.size() ), "rays" );
+      benchmark::reportSpeedup( "diffuse rays, sorted packets", secondaryBVH, sortedPackets );
+      benchmark::report( "samples (scalar)", samplesScalar, double( primary.size() ), "samples" );
+      benchmark::report( "samples (stream)", samplesStream, double( primary.size() ), "samples" );
+      benchmark::reportSpeedup( "samples, stream", samplesScalar, samplesStream );
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto width = benchmark::getArg( argc, argv, "width", 320 );
+   const auto height = benchmark::getArg( argc, argv, "height", 240 );
+   const auto divisions = benchmark::getArg( argc, argv, "divisions", 200 );
+   const auto bounces = benchmark::getArg( argc, argv, "bounces", 4 );
+   const auto repetitions = int( benchmark::getArg( argc, argv, "repetitions", 3 ) );
+   const auto obj = benchmark::getArg( argc, argv, "obj", "" );
+
+   std::vector< Scene > scenes = {
+      buildCornell(),
+      buildSpheres(),
+      buildMeshes( obj, divisions ),
+   };
+
+   for ( auto &scene : scenes ) {
+      run( scene, width, height, bounces, repetitions );
+   }
+
+   return 0;
+}
@@ -0,0 +1,153 @@
+#include "Benchmark.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <crimild/math/rotation.hpp>
+#include <crimild/math/translation.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace crimild;
+
+namespace {
+
+   /**
+      \brief The visitor UpdateWorldState used to be, kept as reference
+
+      Visits every node in the scene, regardless of whether it changed or not.
+    */
+   class FullUpdateWorldState : public NodeVisitor {
+   public:
+      void visitNode( Node *node ) override
+      {
+         if ( node->worldIsCurrent() ) {
+            return;
+         }
+
+         if ( node->hasParent() ) {
+            node->setWorld( node->getParent()->getWorld()( node->getLocal() ) );
+         } else {
+            node->setWorld( node->getLocal() );
+         }
+
+         node->worldBound()->computeFrom( node->getLocalBound(), node->getWorld() );
+      }
+
+      void visitGroup( Group *group ) override
+      {
+         visitNode( group );
+         NodeVisitor::visitGroup( group );
+
+         bool firstChild = true;
+         group->forEachNode( [ & ]( Node *node ) {
+            if ( firstChild ) {
+               firstChild = false;
+               group->worldBound()->computeFrom( node->getWorldBound() );
+            } else {
+               group->worldBound()->expandToContain( node->getWorldBound() );
+            }
+         } );
+      }
+   };
+
+   struct Scene {
+      SharedPointer< Group > root;
+      std::vector< Node * > nodes;
+   };
+
+   /**
+      \brief Builds a three-level hierarchy with branching * branching * leaves nodes
+    */
+   Scene buildScene( long branching, long leaves )
+   {
+      Scene scene;
+      scene.root = std::make_shared< Group >();
+      for ( long i = 0; i < branching; ++i ) {
+         auto a = std::make_shared< Group >();
+         a->setLocal( translation( Real( i ), 0, 0 ) );
+         for ( long j = 0; j < branching; ++j ) {
+            auto b = std::make_shared< Group >();
+            b->setLocal( translation( 0, Real( j ), 0 ) );
+            for ( long k = 0; k < leaves; ++k ) {
+               auto leaf = std::make_shared< Geometry >();
+               leaf->setLocal( translation( 0, 0, Real( k ) ) );
+               scene.nodes.push_back( crimild::get_ptr( leaf ) );
+               b->attachNode( leaf );
+            }
+            a->attachNode( b );
+         }
+         scene.root->attachNode( a );
+      }
+      return scene;
+   }
+
+   /**
+      \brief Moves one every `stride` leaves and updates world state
+    */
+   template< typename UpdateFn >
+   double run( Scene &scene, long frames, long stride, UpdateFn &&update )
+   {
+      // Start from a clean state
+      update( crimild::get_ptr( scene.root ) );
+
+      return benchmark::measure(
+         [ & ] {
+            for ( long frame = 0; frame < frames; ++frame ) {
+               for ( size_t i = frame % stride; i < scene.nodes.size(); i += stride ) {
+                  scene.nodes[ i ]->setLocal( rotationY( Real( frame ) )( translation( 0, 0, Real( i % 100 ) ) ) );
+               }
+               update( crimild::get_ptr( scene.root ) );
+            }
+         }
+      );
+   }
+
+}
+
+int main( int argc, char **argv )
+{
+   const auto branching = benchmark::getArg( argc, argv, "branching", 10 );
+   const auto leaves = benchmark::getArg( argc, argv, "leaves", 1000 );
+   const auto frames = benchmark::getArg( argc, argv, "frames", 100 );
+   const auto workers = benchmark::getArg( argc, argv, "workers", -1 );
+
+   auto scene = buildScene( branching, leaves );
+   scene.root->perform( UpdateWorldState() );
+
+   benchmark::printHeader( "UpdateWorldState" );
+   std::printf( "%zu leaves, %ld frames\n", scene.nodes.size(), frames );
+
+   for ( const auto percent : { 1, 10, 100 } ) {
+      const auto stride = std::max( 1L, 100L / percent );
+      const auto label = std::to_string( percent ) + "% moving";
+
+      const auto full = run( scene, frames, stride, []( Node *root ) { root->perform( FullUpdateWorldState() ); } );
+      const auto dirty = run( scene, frames, stride, []( Node *root ) { root->perform( UpdateWorldState() ); } );
+
+      concurrency::TaskSystem tasks;
+      tasks.configure( int( workers ) );
+      tasks.start();
+      const auto parallel = run(
+         scene,
+         frames,
+         stride,
+         [ & ]( Node *root ) {
+            tasks.beginFrame();
+            root->perform( UpdateWorldState() );
+         }
+      );
+      tasks.stop();
+
+      benchmark::report( "full traversal (" + label + ")", full / frames, 1.0, "frames" );
+      benchmark::report( "dirty only (" + label + ")", dirty / frames, 1.0, "frames" );
+      benchmark::report( "dirty only, " + std::to_string( tasks.getNumWorkers() ) + " workers (" + label + ")", parallel / frames, 1.0, "frames" );
+      benchmark::reportSpeedup( "dirty only (" + label + ")", full, dirty );
+      benchmark::reportSpeedup( "dirty only, parallel (" + label + ")", full, parallel );
+   }
+
+   return 0;
+}
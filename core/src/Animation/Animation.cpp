@@ -27,8 +27,12 @@
 
 #include "Animation.hpp"
 
+#include "Channel.hpp"
 #include "Clip.hpp"
+#include "SceneGraph/Node.hpp"
+#include "Skeleton.hpp"
 
+#include <cassert>
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
 
@@ -100,6 +104,12 @@ void Animation::evaluate( void )
       }
    }
 
+   if ( isBound() ) {
+      // Channels only write the properties they target, so discard whatever was
+      // blended into the pose by the previous evaluation
+      _pose = _restPose;
+   }
+
    getClip()->evaluate( animationTime, this );
 }
 
@@ -114,10 +124,17 @@ Animation *Animation::lerp( Animation *other, crimild::Real32 factor, crimild::B
       return this;
    }
 
+   const auto blendPoses = bindForBlending( other );
+
    if ( sync ) {
       other->sync( this );
    }
 
+   if ( blendPoses ) {
+      _pose.lerp( other->_pose, factor );
+      return this;
+   }
+
    _accumulators.each( [ other, factor ]( const std::string &channelName, SharedPointer< Accumulator > &acc ) {
       if ( other->_accumulators.contains( channelName ) ) {
          acc->lerp( crimild::get_ptr( other->_accumulators[ channelName ] ), factor );
@@ -134,6 +151,11 @@ Animation *Animation::add( SharedPointer< Animation > const &other, crimild::Rea
 
 Animation *Animation::add( Animation *other, crimild::Real32 strength )
 {
+   if ( bindForBlending( other ) ) {
+      _pose.add( other->_pose, strength );
+      return this;
+   }
+
    _accumulators.each( [ other, strength ]( const std::string &channelName, SharedPointer< Accumulator > &acc ) {
       if ( other->_accumulators.contains( channelName ) ) {
          acc->add( crimild::get_ptr( other->_accumulators[ channelName ] ), strength );
@@ -143,6 +165,85 @@ Animation *Animation::add( Animation *other, crimild::Real32 strength )
    return this;
 }
 
+void Animation::bind( Skeleton *skeleton )
+{
+   assert( ( skeleton == nullptr || _skeleton == nullptr || _skeleton == skeleton ) && "Animation is already bound to a different skeleton" );
+
+   _skeleton = nullptr;
+   _poseTargets.clear();
+   _pose.reset( 0 );
+   _restPose.reset( 0 );
+
+   auto clip = getClip();
+   if ( skeleton == nullptr || clip == nullptr ) {
+      return;
+   }
+
+   auto &joints = skeleton->getJoints();
+
+   crimild::Size jointCount = 0;
+   joints.eachValue( [ &jointCount ]( SharedPointer< Joint > const &joint ) {
+      jointCount = std::max( jointCount, crimild::Size( joint->getId() ) + 1 );
+   } );
+
+   // Start from the rest pose, so joints that are not animated keep their transformations
+   _pose.reset( jointCount );
+   joints.eachValue( [ this ]( SharedPointer< Joint > const &joint ) {
+      if ( auto node = joint->getNode() ) {
+         _pose.setTransformation( joint->getId(), node->getLocal() );
+      }
+   } );
+   _restPose = _pose;
+
+   std::string jointName;
+   clip->getChannels().each( [ this, &joints, &jointName ]( SharedPointer< Channel > const &channel ) {
+      Pose::Target target;
+      target.property = Pose::Target::parse( channel->getName(), jointName );
+      if ( target.property != Pose::Target::Property::NONE && joints.contains( jointName ) ) {
+         target.joint = joints[ jointName ]->getId();
+      } else {
+         target.property = Pose::Target::Property::NONE;
+      }
+      _poseTargets.add( target );
+   } );
+
+   _skeleton = skeleton;
+
+   if ( _accumulators.empty() ) {
+      evaluate();
+      return;
+   }
+
+   // Keep values computed before binding, which might have been blended with other
+   // animations already. Accumulators are no longer updated, so they are discarded.
+   for ( crimild::Size i = 0; i < _poseTargets.size(); ++i ) {
+      const auto &target = _poseTargets[ i ];
+      const auto &channelName = clip->getChannels()[ i ]->getName();
+      if ( target.property == Pose::Target::Property::NONE || !_accumulators.contains( channelName ) ) {
+         continue;
+      }
+      auto acc = crimild::get_ptr( _accumulators[ channelName ] );
+      if ( auto v = dynamic_cast< AccumulatorImpl< Vector3f > * >( acc ) ) {
+         _pose.set( target, v->get() );
+      } else if ( auto q = dynamic_cast< AccumulatorImpl< Quaternion > * >( acc ) ) {
+         _pose.set( target, q->get() );
+      }
+   }
+   _accumulators.clear();
+}
+
+crimild::Bool Animation::bindForBlending( Animation *other )
+{
+   if ( isBound() ) {
+      if ( !other->isBoundTo( _skeleton ) ) {
+         other->bind( _skeleton );
+      }
+   } else if ( other->isBound() ) {
+      bind( other->_skeleton );
+   }
+   return isBound() && other->isBoundTo( _skeleton );
+}
+
 void Animation::encode( coding::Encoder &encoder )
 {
    Codable::encode( encoder );
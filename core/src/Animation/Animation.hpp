@@ -29,6 +29,7 @@
 #define CRIMILD_ANIMATION_ANIMATION_
 
 #include "Accumulator.hpp"
+#include "Pose.hpp"
 #include "Simulation/Clock.hpp"
 
 #include <crimild/coding/Codable.hpp>
@@ -39,6 +40,7 @@ namespace crimild {
    namespace animation {
 
       class Clip;
+      class Skeleton;
 
       class Animation : public coding::Codable,
                         public NamedObject {
@@ -99,6 +101,76 @@ namespace crimild {
       private:
          void evaluate( void );
 
+      public:
+         /**
+            \brief Key indices found by the last evaluation, one for each channel in the clip
+
+            \see Channel::evaluate
+          */
+         inline Array< crimild::Size > &getChannelCursors( void ) noexcept { return _channelCursors; }
+
+      private:
+         Array< crimild::Size > _channelCursors;
+
+         /**
+            \name Binding
+         */
+         //@{
+
+      public:
+         /**
+            \brief Binds the animation to a skeleton
+
+            Channel names are resolved to joint indices only once, so bound animations
+            are evaluated directly into a pose without looking up values by name. Joints
+            that are not animated by the clip keep the local transformations of their nodes
+            at the time of binding (the rest pose). Each evaluation starts from the rest
+            pose, so values blended from other animations last only until the next one.
+
+            Lerping and adding bound animations blends their poses. Values are no longer
+            stored in accumulators, so getValue() returns nothing after binding. Values
+            computed before binding (maybe blended with other animations) are kept in
+            the pose.
+
+            Binding to a null skeleton unbinds the animation.
+
+            An animation can only be bound to one skeleton, since skeletons may be
+            updated concurrently (see AnimationStage). Use a different Animation
+            for each skeleton, even if they play the same clip. Binding to another
+            skeleton requires unbinding first.
+          */
+         void bind( Skeleton *skeleton );
+
+         inline crimild::Bool isBound( void ) const noexcept { return _skeleton != nullptr; }
+         inline crimild::Bool isBoundTo( const Skeleton *skeleton ) const noexcept { return skeleton != nullptr && _skeleton == skeleton; }
+
+         /**
+            \brief The pose computed by the last evaluation, or null if the animation is not bound
+          */
+         inline Pose *getPose( void ) noexcept { return isBound() ? &_pose : nullptr; }
+
+         /**
+            \brief Joint and property written by each channel in the clip
+          */
+         inline const Array< Pose::Target > &getPoseTargets( void ) const noexcept { return _poseTargets; }
+
+      private:
+         /**
+            \brief Binds either animation to the other one's skeleton, if needed
+
+            Skeleton::animate() only binds the animation it is given, so animations
+            blended with it are bound here. Returns true if poses can be blended.
+          */
+         crimild::Bool bindForBlending( Animation *other );
+
+      private:
+         Skeleton *_skeleton = nullptr;
+         Array< Pose::Target > _poseTargets;
+         Pose _pose;
+         Pose _restPose;
+
+         //@}
+
       public:
          template< typename T >
          Animation *setValue( const std::string &channelName, const T &value )
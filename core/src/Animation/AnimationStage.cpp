@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "AnimationStage.hpp"
+
+#include "Common/Profiler.hpp"
+#include "Components/ComponentRegistry.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "SceneGraph/Node.hpp"
+#include "Skeleton.hpp"
+
+using namespace crimild;
+using namespace crimild::animation;
+
+void AnimationStage::collect( Node *root ) noexcept
+{
+   _skeletons.clear();
+
+   if ( root == nullptr ) {
+      return;
+   }
+
+   // Skeletons are kept alive by the copy until the next update
+   ComponentRegistry::getInstance().collect( ComponentRegistry::getTypeId< Skeleton >(), _components );
+   for ( auto &component : _components ) {
+      auto skeleton = static_cast< Skeleton * >( crimild::get_ptr( component ) );
+      auto node = skeleton->getNode();
+      if ( skeleton->isEnabled() && skeleton->hasAnimation() && node != nullptr && node->isInHierarchy( root ) ) {
+         _skeletons.push_back( skeleton );
+      }
+   }
+}
+
+void AnimationStage::update( Node *root, const Clock &clock ) noexcept
+{
+   CRIMILD_PROFILE( "Animation Stage" )
+
+   collect( root );
+
+   concurrency::parallel_for(
+      concurrency::Range { 0, _skeletons.size() },
+      _grain,
+      [ this, &clock ]( concurrency::Range range ) {
+         for ( auto i = range.begin; i < range.end; ++i ) {
+            _skeletons[ i ]->updateAnimation( clock );
+         }
+      }
+   );
+
+   if ( _updateJointNodes ) {
+      for ( auto skeleton : _skeletons ) {
+         skeleton->updateJointNodes();
+      }
+   }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_ANIMATION_ANIMATION_STAGE_
+#define CRIMILD_ANIMATION_ANIMATION_STAGE_
+
+#include "Simulation/Clock.hpp"
+
+#include <crimild/foundation.hpp>
+#include <vector>
+
+namespace crimild {
+
+   class Node;
+   class NodeComponent;
+
+   namespace animation {
+
+      class Skeleton;
+
+      /**
+         \brief Updates skeletal animations for many characters in parallel
+
+         On each update, all enabled skeletons in a hierarchy with an active animation
+         are collected from the component registry and split into batches that run on
+         the task system. Each batch evaluates animations, computes joint palettes and
+         performs CPU skinning for its skeletons. Then, joint nodes are updated on the
+         calling thread, since modifying nodes is not thread-safe.
+
+         Since skeletons are updated concurrently, animations must not be shared between
+         them. Each Animation can only be bound to one skeleton (see Animation::bind) and
+         animation callbacks must only touch animations owned by their skeleton.
+
+         \see Skeleton::updateAnimation
+       */
+      class AnimationStage : public NonCopyable {
+      public:
+         static constexpr crimild::Size DEFAULT_GRAIN = 4;
+
+      public:
+         AnimationStage( void ) = default;
+         ~AnimationStage( void ) = default;
+
+         /**
+            \brief Number of skeletons updated by each job
+          */
+         inline void setGrain( crimild::Size grain ) noexcept { _grain = grain; }
+         inline crimild::Size getGrain( void ) const noexcept { return _grain; }
+
+         /**
+            \brief Enables updating local transformations of joint nodes
+
+            Enabled by default. Disable it if joint transformations are only consumed through
+            palettes (i.e. for skinning), saving a serial pass over all joints.
+          */
+         inline void setUpdateJointNodes( crimild::Bool enabled ) noexcept { _updateJointNodes = enabled; }
+         inline crimild::Bool shouldUpdateJointNodes( void ) const noexcept { return _updateJointNodes; }
+
+         void update( Node *root, const Clock &clock ) noexcept;
+
+         /**
+            \brief Skeletons collected by the last update
+          */
+         inline const std::vector< Skeleton * > &getSkeletons( void ) const noexcept { return _skeletons; }
+
+      private:
+         void collect( Node *root ) noexcept;
+
+      private:
+         crimild::Size _grain = DEFAULT_GRAIN;
+         crimild::Bool _updateJointNodes = true;
+         std::vector< SharedPointer< NodeComponent > > _components;
+         std::vector< Skeleton * > _skeletons;
+      };
+
+   }
+
+}
+
+#endif
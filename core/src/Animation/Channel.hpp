@@ -28,6 +28,8 @@
 #ifndef CRIMILD_ANIMATION_CHANNEL_
 #define CRIMILD_ANIMATION_CHANNEL_
 
+#include "Pose.hpp"
+
 #include <crimild/coding/Codable.hpp>
 #include <crimild/foundation.hpp>
 
@@ -48,7 +50,42 @@ namespace crimild {
 
          virtual crimild::Real32 getDuration( void ) const = 0;
 
-         virtual void evaluate( crimild::Real32 t, Animation *animation ) = 0;
+         /**
+            \brief Evaluates the channel at time t and stores the result in the animation
+
+            \param cursor Index of the key found by the previous evaluation. It is updated
+            on return. Animations keep one cursor per channel, so forward playback does not
+            need to search for keys on every frame.
+          */
+         virtual void evaluate( crimild::Real32 t, Animation *animation, crimild::Size &cursor ) = 0;
+
+         /**
+            \brief Evaluates the channel without a cursor
+          */
+         void evaluate( crimild::Real32 t, Animation *animation )
+         {
+            crimild::Size cursor = 0;
+            evaluate( t, animation, cursor );
+         }
+
+         /**
+            \brief Evaluates the channel at time t and stores the result in a pose
+
+            Used by animations bound to a skeleton, which resolve channel names to
+            pose targets only once.
+
+            \see Animation::bind
+          */
+         virtual void evaluate( crimild::Real32 t, Pose &pose, const Pose::Target &target, crimild::Size &cursor ) = 0;
+
+         /**
+            \brief Replaces keys with new ones sampled at a uniform rate
+
+            Keys of uniformly sampled channels are found in constant time. This is lossy,
+            since original keys that are not aligned with the new rate are discarded. The
+            actual rate might be slightly higher, so the first and last keys are preserved.
+          */
+         virtual void resample( crimild::Real32 sampleRate ) = 0;
       };
 
    }
@@ -31,6 +31,8 @@
 #include "Animation.hpp"
 #include "Channel.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
 
@@ -40,7 +42,7 @@ namespace crimild {
 
       template< typename T >
       class ChannelImpl : public Channel {
-      private:
+      public:
          using TimeArray = Array< crimild::Real32 >;
          using KeyArray = Array< T >;
 
@@ -52,6 +54,7 @@ namespace crimild {
               _times( times ),
               _keys( keys )
          {
+            updateSampleInterval();
          }
 
          ChannelImpl( std::string name, TimeArray &&times, KeyArray &&keys )
@@ -59,6 +62,7 @@ namespace crimild {
               _times( times ),
               _keys( keys )
          {
+            updateSampleInterval();
          }
 
          virtual ~ChannelImpl( void )
@@ -74,26 +78,79 @@ namespace crimild {
             return _times.last();
          }
 
-         virtual void evaluate( crimild::Real32 t, Animation *animation ) override
+         using Channel::evaluate;
+
+         virtual void evaluate( crimild::Real32 t, Animation *animation, crimild::Size &cursor ) override
          {
             if ( _keys.size() == 0 || _times.size() == 0 ) {
                return;
             }
 
             T result;
+            sample( t, cursor, result );
+            animation->setValue( getName(), result );
+         }
+
+         virtual void evaluate( crimild::Real32 t, Pose &pose, const Pose::Target &target, crimild::Size &cursor ) override
+         {
+            if ( _keys.size() == 0 || _times.size() == 0 ) {
+               return;
+            }
+
+            T result;
+            sample( t, cursor, result );
+            pose.set( target, result );
+         }
+
+         virtual void resample( crimild::Real32 sampleRate ) override
+         {
+            if ( _keys.size() < 2 || _times.size() < 2 || sampleRate <= 0 ) {
+               return;
+            }
 
+            const auto start = _times.first();
+            const auto end = _times.last();
+            const auto count = crimild::Size( std::ceil( ( end - start ) * sampleRate ) ) + 1;
+
+            // The actual rate might be slightly higher, so the last key is preserved
+            const auto interval = ( end - start ) / crimild::Real32( count - 1 );
+
+            TimeArray times( count );
+            KeyArray keys( count );
+            crimild::Size cursor = 0;
+            for ( crimild::Size i = 0; i < count; ++i ) {
+               times[ i ] = i < count - 1 ? start + crimild::Real32( i ) * interval : end;
+               sample( times[ i ], cursor, keys[ i ] );
+            }
+
+            _times = std::move( times );
+            _keys = std::move( keys );
+            updateSampleInterval();
+         }
+
+         inline const TimeArray &getTimes( void ) const noexcept { return _times; }
+         inline const KeyArray &getKeys( void ) const noexcept { return _keys; }
+
+         /**
+            \brief Time between keys for uniformly sampled channels, or zero otherwise
+          */
+         inline crimild::Real32 getSampleInterval( void ) const noexcept { return _sampleInterval; }
+
+      private:
+         /**
+            \brief Maximum number of keys to move forward from the cursor before using binary search
+          */
+         static constexpr crimild::Size MAX_FORWARD_STEPS = 4;
+
+         void sample( crimild::Real32 t, crimild::Size &cursor, T &result )
+         {
             if ( _keys.size() == 1 || t <= _times.first() ) {
                result = _keys.first();
+               cursor = 0;
             } else if ( t >= _times.last() ) {
                result = _keys.last();
             } else {
-               // TODO: cache last index to avoid this loop
-               crimild::Size index = 0;
-               for ( ; index < _times.size() - 1; index++ ) {
-                  if ( t < _times[ index + 1 ] ) {
-                     break;
-                  }
-               }
+               const auto index = findKey( t, cursor );
 
                const auto t0 = _times[ index ];
                const auto t1 = _times[ index + 1 ];
@@ -104,10 +161,76 @@ namespace crimild {
                const auto u = ( t - t0 ) / ( t1 - t0 );
                interpolate( v0, v1, u, result );
             }
-            animation->setValue( getName(), result );
          }
 
-      private:
+         /**
+            \brief Finds the index of the key such as times[ index ] <= t < times[ index + 1 ]
+
+            Uniformly sampled channels compute the index directly. Otherwise, the search starts
+            at the cursor, since during forward playback the key is usually the same one or
+            the next. Seeks and loops fall back to binary search.
+
+            \remarks Assumes there are at least two keys and that t is between the first and
+            last key times.
+          */
+         crimild::Size findKey( crimild::Real32 t, crimild::Size &cursor ) const noexcept
+         {
+            const auto last = _times.size() - 1;
+
+            if ( _sampleInterval > 0 ) {
+               cursor = std::min( crimild::Size( ( t - _times.first() ) / _sampleInterval ), last - 1 );
+               // Account for rounding errors
+               while ( cursor > 0 && t < _times[ cursor ] ) {
+                  --cursor;
+               }
+               while ( cursor < last - 1 && t >= _times[ cursor + 1 ] ) {
+                  ++cursor;
+               }
+               return cursor;
+            }
+
+            if ( cursor < last && _times[ cursor ] <= t ) {
+               for ( crimild::Size i = 0; i < MAX_FORWARD_STEPS && cursor < last; ++i ) {
+                  if ( t < _times[ cursor + 1 ] ) {
+                     return cursor;
+                  }
+                  ++cursor;
+               }
+            }
+
+            const auto begin = _times.getData();
+            const auto it = std::upper_bound( begin, begin + _times.size(), t );
+            cursor = crimild::Size( it - begin ) - 1;
+            return cursor;
+         }
+
+         /**
+            \brief Checks if keys are sampled at a uniform rate
+          */
+         void updateSampleInterval( void ) noexcept
+         {
+            _sampleInterval = 0;
+
+            if ( _times.size() < 2 ) {
+               return;
+            }
+
+            const auto start = _times.first();
+            const auto interval = ( _times.last() - start ) / crimild::Real32( _times.size() - 1 );
+            if ( interval <= 0 ) {
+               return;
+            }
+
+            for ( crimild::Size i = 1; i < _times.size(); ++i ) {
+               if ( std::abs( _times[ i ] - ( start + crimild::Real32( i ) * interval ) ) > 0.001f * interval ) {
+                  return;
+               }
+            }
+
+            _sampleInterval = interval;
+         }
+
+
          template< typename U >
          void interpolate( const U &start, const U &end, crimild::Real32 t, U &result )
          {
@@ -122,6 +245,7 @@ namespace crimild {
       private:
          TimeArray _times;
          KeyArray _keys;
+         crimild::Real32 _sampleInterval = 0;
 
          /**
                         \name Coding
@@ -148,6 +272,8 @@ namespace crimild {
 
             decoder.decode( "times", _times );
             decoder.decode( "keys", _keys );
+
+            updateSampleInterval();
          }
 
          //@}
@@ -27,7 +27,9 @@
 
 #include "Clip.hpp"
 
+#include "Animation.hpp"
 #include "Channel.hpp"
+#include "CompressedChannel.hpp"
 
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
@@ -59,11 +61,47 @@ void Clip::addChannel( SharedPointer< Channel > const &channel )
 
 void Clip::evaluate( crimild::Real32 t, Animation *animation )
 {
-   _channels.each( [ t, animation ]( SharedPointer< Channel > &channel ) {
-      channel->evaluate( t, animation );
+   auto &cursors = animation->getChannelCursors();
+   if ( cursors.size() != _channels.size() ) {
+      cursors.resize( _channels.size() );
+      for ( crimild::Size i = 0; i < cursors.size(); ++i ) {
+         cursors[ i ] = 0;
+      }
+   }
+
+   if ( auto pose = animation->getPose() ) {
+      const auto &targets = animation->getPoseTargets();
+      for ( crimild::Size i = 0; i < _channels.size(); ++i ) {
+         if ( targets[ i ].property != Pose::Target::Property::NONE ) {
+            _channels[ i ]->evaluate( t, *pose, targets[ i ], cursors[ i ] );
+         }
+      }
+      return;
+   }
+
+   for ( crimild::Size i = 0; i < _channels.size(); ++i ) {
+      _channels[ i ]->evaluate( t, animation, cursors[ i ] );
+   }
+}
+
+void Clip::resample( crimild::Real32 sampleRate )
+{
+   _channels.each( [ sampleRate ]( SharedPointer< Channel > &channel ) {
+      channel->resample( sampleRate );
    } );
 }
 
+CompressionStats Clip::compress( const CompressionSettings &settings )
+{
+   CompressionStats stats;
+   for ( crimild::Size i = 0; i < _channels.size(); ++i ) {
+      if ( auto compressed = animation::compress( crimild::get_ptr( _channels[ i ] ), settings, &stats ) ) {
+         _channels[ i ] = compressed;
+      }
+   }
+   return stats;
+}
+
 void Clip::encode( coding::Encoder &encoder )
 {
    Codable::encode( encoder );
@@ -37,6 +37,8 @@ namespace crimild {
 
       class Animation;
       class Channel;
+      struct CompressionSettings;
+      struct CompressionStats;
 
       class Clip : public coding::Codable,
                    public NamedObject {
@@ -60,12 +62,36 @@ namespace crimild {
       public:
          void addChannel( SharedPointer< Channel > const &channel );
 
+         Array< SharedPointer< Channel > > &getChannels( void ) { return _channels; }
+
       private:
          Array< SharedPointer< Channel > > _channels;
 
       public:
+         /**
+            \brief Evaluates all channels at time t
+
+            If the animation is bound to a skeleton, results are written directly into
+            its pose. Otherwise, they are stored in the animation's accumulators.
+          */
          void evaluate( crimild::Real32 t, Animation *animation );
 
+         /**
+            \brief Resamples all channels at a uniform rate
+
+            \see Channel::resample
+          */
+         void resample( crimild::Real32 sampleRate );
+
+         /**
+            \brief Replaces all channels with compressed ones
+
+            Channels that are already compressed are left untouched.
+
+            \see CompressedChannelImpl
+          */
+         CompressionStats compress( const CompressionSettings &settings );
+
          /**
             \name Coding
          */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CompressedChannel.hpp"
+
+#include <crimild/math/numbers.hpp>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::animation::compression {
+
+   /**
+      \brief Range of the three smallest components of a unit quaternion
+    */
+   static constexpr Real32 SMALLEST_THREE_RANGE = 0.70710678118f;
+   static constexpr Real32 SMALLEST_THREE_MAX = 32767.0f;
+
+}
+
+CompressionStats &CompressionStats::operator+=( const CompressionStats &other ) noexcept
+{
+   channels += other.channels;
+   constantChannels += other.constantChannels;
+   originalKeys += other.originalKeys;
+   compressedKeys += other.compressedKeys;
+   originalBytes += other.originalBytes;
+   compressedBytes += other.compressedBytes;
+   return *this;
+}
+
+UInt16 compression::quantize( Real32 value, Real32 minimum, Real32 extent ) noexcept
+{
+   if ( extent <= 0 ) {
+      return 0;
+   }
+
+   const auto u = std::clamp( ( value - minimum ) / extent, 0.0f, 1.0f );
+   return UInt16( std::lround( u * 65535.0f ) );
+}
+
+void compression::packQuaternion( const Quaternion &q, UInt16 *out ) noexcept
+{
+   UInt16 largest = 0;
+   for ( UInt16 i = 1; i < 4; ++i ) {
+      if ( std::abs( q[ i ] ) > std::abs( q[ largest ] ) ) {
+         largest = i;
+      }
+   }
+
+   const auto length = std::sqrt( q.v.x * q.v.x + q.v.y * q.v.y + q.v.z * q.v.z + q.w * q.w );
+   const auto scale = ( q[ largest ] < 0 ? -1.0f : 1.0f ) / ( length > 0 ? length : 1.0f );
+
+   UInt16 words[ 3 ];
+   for ( UInt16 i = 0, j = 0; i < 4; ++i ) {
+      if ( i != largest ) {
+         const auto u = std::clamp( ( q[ i ] * scale + SMALLEST_THREE_RANGE ) / ( 2.0f * SMALLEST_THREE_RANGE ), 0.0f, 1.0f );
+         words[ j++ ] = UInt16( std::lround( u * SMALLEST_THREE_MAX ) );
+      }
+   }
+
+   out[ 0 ] = UInt16( ( ( largest >> 1 ) << 15 ) | words[ 0 ] );
+   out[ 1 ] = UInt16( ( ( largest & 1 ) << 15 ) | words[ 1 ] );
+   out[ 2 ] = words[ 2 ];
+}
+
+Quaternion compression::unpackQuaternion( const UInt16 *in ) noexcept
+{
+   const auto largest = Size( ( ( in[ 0 ] >> 15 ) << 1 ) | ( in[ 1 ] >> 15 ) );
+
+   Quaternion ret;
+   Real32 sum = 0;
+   for ( Size i = 0, j = 0; i < 4; ++i ) {
+      if ( i != largest ) {
+         const auto value = Real32( in[ j++ ] & 0x7FFF ) * ( 2.0f * SMALLEST_THREE_RANGE / SMALLEST_THREE_MAX ) - SMALLEST_THREE_RANGE;
+         ret[ i ] = value;
+         sum += value * value;
+      }
+   }
+   ret[ largest ] = std::sqrt( std::max( 0.0f, 1.0f - sum ) );
+   return ret;
+}
+
+Real32 compression::error( Real32 a, Real32 b ) noexcept
+{
+   return std::abs( a - b );
+}
+
+Real32 compression::error( const Vector3f &a, const Vector3f &b ) noexcept
+{
+   return std::max( std::abs( a.x - b.x ), std::max( std::abs( a.y - b.y ), std::abs( a.z - b.z ) ) );
+}
+
+Real32 compression::error( const Quaternion &a, const Quaternion &b ) noexcept
+{
+   const auto la = std::sqrt( a.v.x * a.v.x + a.v.y * a.v.y + a.v.z * a.v.z + a.w * a.w );
+   const auto lb = std::sqrt( b.v.x * b.v.x + b.v.y * b.v.y + b.v.z * b.v.z + b.w * b.w );
+   if ( la <= 0 || lb <= 0 ) {
+      return la == lb ? 0.0f : numbers::PI;
+   }
+
+   // q and -q are the same rotation
+   const auto d = std::abs( a.v.x * b.v.x + a.v.y * b.v.y + a.v.z * b.v.z + a.w * b.w ) / ( la * lb );
+   return 2.0f * std::acos( std::min( 1.0f, d ) );
+}
+
+SharedPointer< Channel > crimild::animation::compress( Channel *channel, const CompressionSettings &settings, CompressionStats *stats )
+{
+   if ( auto vector3f = dynamic_cast< Vector3fChannel * >( channel ) ) {
+      return crimild::alloc< CompressedVector3fChannel >( *vector3f, settings, stats );
+   }
+
+   if ( auto quaternion = dynamic_cast< QuaternionChannel * >( channel ) ) {
+      return crimild::alloc< CompressedQuaternionChannel >( *quaternion, settings, stats );
+   }
+
+   if ( auto real32 = dynamic_cast< Real32Channel * >( channel ) ) {
+      return crimild::alloc< CompressedReal32Channel >( *real32, settings, stats );
+   }
+
+   return nullptr;
+}
@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_ANIMATION_COMPRESSED_CHANNEL_
+#define CRIMILD_ANIMATION_COMPRESSED_CHANNEL_
+
+#include "ChannelImpl.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <crimild/coding/Decoder.hpp>
+#include <crimild/coding/Encoder.hpp>
+#include <type_traits>
+
+namespace crimild {
+
+   namespace animation {
+
+      struct CompressionSettings {
+         /**
+            \brief Maximum absolute error for translation, scale and scalar keys
+          */
+         crimild::Real32 tolerance = 0.001f;
+
+         /**
+            \brief Maximum angle (in radians) between original and compressed rotation keys
+          */
+         crimild::Real32 angularTolerance = 0.001f;
+
+         /**
+            \brief Discard keys that can be interpolated from their neighbours within tolerance
+          */
+         crimild::Bool reduceKeys = true;
+      };
+
+      struct CompressionStats {
+         crimild::Size channels = 0;
+         crimild::Size constantChannels = 0;
+         crimild::Size originalKeys = 0;
+         crimild::Size compressedKeys = 0;
+         crimild::Size originalBytes = 0;
+         crimild::Size compressedBytes = 0;
+
+         inline crimild::Size getSavedBytes( void ) const noexcept
+         {
+            return originalBytes > compressedBytes ? originalBytes - compressedBytes : 0;
+         }
+
+         inline crimild::Real32 getRatio( void ) const noexcept
+         {
+            return compressedBytes > 0 ? crimild::Real32( originalBytes ) / crimild::Real32( compressedBytes ) : 0.0f;
+         }
+
+         CompressionStats &operator+=( const CompressionStats &other ) noexcept;
+      };
+
+      namespace compression {
+
+         /**
+            \brief Maps a value in [ minimum, minimum + extent ] to 16-bit fixed point
+          */
+         crimild::UInt16 quantize( crimild::Real32 value, crimild::Real32 minimum, crimild::Real32 extent ) noexcept;
+
+         /**
+            \brief Stores a unit quaternion in three 16-bit words using the "smallest three" method
+
+            The largest component is dropped, since it can be recovered from the other ones,
+            which are then in the range [ -1/sqrt(2), 1/sqrt(2) ] and use 15 bits each. The
+            index of the dropped component is stored in the top bits of the first two words.
+            Quaternions q and -q are the same rotation, so the sign of the dropped component
+            is made positive.
+          */
+         void packQuaternion( const Quaternion &q, crimild::UInt16 *out ) noexcept;
+
+         Quaternion unpackQuaternion( const crimild::UInt16 *in ) noexcept;
+
+         /**
+            \brief Error between two keys, in the units used by CompressionSettings
+          */
+         crimild::Real32 error( crimild::Real32 a, crimild::Real32 b ) noexcept;
+         crimild::Real32 error( const Vector3f &a, const Vector3f &b ) noexcept;
+         crimild::Real32 error( const Quaternion &a, const Quaternion &b ) noexcept;
+
+         /**
+            \brief Number of range-reduced components per key, or zero if keys are not range-reduced
+          */
+         template< typename T >
+         struct KeyTraits;
+
+         template<>
+         struct KeyTraits< crimild::Real32 > {
+            static constexpr crimild::Size COMPONENTS = 1;
+            static constexpr crimild::Size WORDS = 1;
+
+            static inline crimild::Real32 get( const crimild::Real32 &key, crimild::Size ) noexcept { return key; }
+            static inline void set( crimild::Real32 &key, crimild::Size, crimild::Real32 value ) noexcept { key = value; }
+         };
+
+         template<>
+         struct KeyTraits< Vector3f > {
+            static constexpr crimild::Size COMPONENTS = 3;
+            static constexpr crimild::Size WORDS = 3;
+
+            static inline crimild::Real32 get( const Vector3f &key, crimild::Size i ) noexcept { return key[ i ]; }
+            static inline void set( Vector3f &key, crimild::Size i, crimild::Real32 value ) noexcept { key[ i ] = value; }
+         };
+
+         template<>
+         struct KeyTraits< Quaternion > {
+            static constexpr crimild::Size COMPONENTS = 0;
+            static constexpr crimild::Size WORDS = 3;
+         };
+
+      }
+
+      /**
+         \brief A read-only channel storing quantized keys
+
+         Key times are stored as 16-bit fixed point values relative to the channel's duration.
+         Translations, scales and scalars use 16 bits per component, relative to the range of
+         values in the channel. Rotations use the "smallest three" method, packed in 48 bits.
+         Keys that can be interpolated from their neighbours within tolerance are discarded and
+         channels that don't change are reduced to a single key.
+
+         Keys are decoded on the fly during evaluation, which keeps the working set small when
+         evaluating many animations. Error introduced by quantization is added on top of the
+         tolerance used for key reduction, although it's usually much smaller.
+
+         \remarks Compressed channels cannot be resampled. Resample the original channel
+         before compressing it instead.
+       */
+      template< typename T >
+      class CompressedChannelImpl : public Channel {
+      private:
+         using Traits = compression::KeyTraits< T >;
+
+         static constexpr crimild::Size COMPONENTS = Traits::COMPONENTS;
+         static constexpr crimild::Size WORDS = Traits::WORDS;
+         static constexpr crimild::Real32 MAX_VALUE = 65535.0f;
+
+      public:
+         CompressedChannelImpl( void ) { }
+
+         CompressedChannelImpl( const ChannelImpl< T > &source, const CompressionSettings &settings, CompressionStats *stats = nullptr )
+            : Channel( source.getName() )
+         {
+            compress( source.getTimes(), source.getKeys(), settings, stats );
+         }
+
+         virtual ~CompressedChannelImpl( void )
+         {
+         }
+
+         virtual crimild::Real32 getDuration( void ) const override { return _keyCount > 0 ? _endTime : 0.0f; }
+
+         using Channel::evaluate;
+
+         virtual void evaluate( crimild::Real32 t, Animation *animation, crimild::Size &cursor ) override
+         {
+            if ( _keyCount == 0 ) {
+               return;
+            }
+
+            T result;
+            sample( t, cursor, result );
+            animation->setValue( getName(), result );
+         }
+
+         virtual void evaluate( crimild::Real32 t, Pose &pose, const Pose::Target &target, crimild::Size &cursor ) override
+         {
+            if ( _keyCount == 0 ) {
+               return;
+            }
+
+            T result;
+            sample( t, cursor, result );
+            pose.set( target, result );
+         }
+
+         /**
+            \brief Does nothing, since compressed channels are read-only
+          */
+         virtual void resample( crimild::Real32 ) override { }
+
+         inline crimild::Size getKeyCount( void ) const noexcept { return _keyCount; }
+
+         inline crimild::Bool isConstant( void ) const noexcept { return _keyCount == 1; }
+
+         /**
+            \brief Size of the compressed keys and their times, in bytes
+          */
+         inline crimild::Size getSizeInBytes( void ) const noexcept
+         {
+            return _data.size() + _ranges.size() * sizeof( crimild::Real32 ) + 2 * sizeof( crimild::Real32 );
+         }
+
+         /**
+            \brief Decodes a single key
+          */
+         void getKey( crimild::Size index, T &result ) const noexcept
+         {
+            const auto words = getKeyWords() + index * WORDS;
+            if constexpr ( COMPONENTS == 0 ) {
+               result = compression::unpackQuaternion( words );
+            } else {
+               for ( crimild::Size i = 0; i < COMPONENTS; ++i ) {
+                  Traits::set( result, i, _ranges[ i ] + crimild::Real32( words[ i ] ) * _ranges[ COMPONENTS + i ] );
+               }
+            }
+         }
+
+         /**
+            \brief Decodes the time of a single key
+          */
+         inline crimild::Real32 getKeyTime( crimild::Size index ) const noexcept
+         {
+            return _keyCount > 1 ? _startTime + crimild::Real32( getTimeWords()[ index ] ) * _timeStep : _startTime;
+         }
+
+      private:
+         /**
+            \brief Maximum number of keys to move forward from the cursor before using binary search
+          */
+         static constexpr crimild::Size MAX_FORWARD_STEPS = 4;
+
+         inline const crimild::UInt16 *getTimeWords( void ) const noexcept
+         {
+            return reinterpret_cast< const crimild::UInt16 * >( _data.getData() );
+         }
+
+         inline const crimild::UInt16 *getKeyWords( void ) const noexcept
+         {
+            return getTimeWords() + ( _keyCount > 1 ? _keyCount : 0 );
+         }
+
+         void sample( crimild::Real32 t, crimild::Size &cursor, T &result ) const noexcept
+         {
+            if ( _keyCount == 1 || t <= _startTime ) {
+               getKey( 0, result );
+               cursor = 0;
+            } else if ( t >= _endTime ) {
+               getKey( _keyCount - 1, result );
+            } else {
+               // Search in quantized time, so key times don't need to be decoded
+               const auto times = getTimeWords();
+               const auto qt = ( t - _startTime ) * _timeScale;
+               const auto index = findKey( qt, cursor );
+
+               const auto t0 = crimild::Real32( times[ index ] );
+               const auto t1 = crimild::Real32( times[ index + 1 ] );
+
+               T v0, v1;
+               getKey( index, v0 );
+               getKey( index + 1, v1 );
+
+               const auto u = ( qt - t0 ) / ( t1 - t0 );
+               interpolate( v0, v1, u, result );
+            }
+         }
+
+         /**
+            \brief Finds the index of the key such as times[ index ] <= qt < times[ index + 1 ]
+
+            \see ChannelImpl::findKey
+          */
+         crimild::Size findKey( crimild::Real32 qt, crimild::Size &cursor ) const noexcept
+         {
+            const auto times = getTimeWords();
+            const auto last = _keyCount - 1;
+
+            if ( cursor < last && crimild::Real32( times[ cursor ] ) <= qt ) {
+               for ( crimild::Size i = 0; i < MAX_FORWARD_STEPS && cursor < last; ++i ) {
+                  if ( qt < crimild::Real32( times[ cursor + 1 ] ) ) {
+                     return cursor;
+                  }
+                  ++cursor;
+               }
+            }
+
+            const auto it = std::upper_bound(
+               times,
+               times + _keyCount,
+               qt,
+               []( crimild::Real32 value, crimild::UInt16 time ) { return value < crimild::Real32( time ); }
+            );
+            cursor = std::min( crimild::Size( it - times ), last ) - 1;
+            return cursor;
+         }
+
+         template< typename U >
+         static void interpolate( const U &start, const U &end, crimild::Real32 t, U &result ) noexcept
+         {
+            Interpolation::linear( start, end, t, result );
+         }
+
+         static void interpolate( const Quaternion &start, const Quaternion &end, crimild::Real32 t, Quaternion &result ) noexcept
+         {
+            result = slerp( start, end, t );
+         }
+
+         crimild::Real32 getTolerance( const CompressionSettings &settings ) const noexcept
+         {
+            return COMPONENTS == 0 ? settings.angularTolerance : settings.tolerance;
+         }
+
+         /**
+            \brief Selects which keys to keep
+
+            Keys are discarded greedily: each segment is extended for as long as all the keys
+            it skips can be interpolated from its ends within tolerance.
+          */
+         static Array< crimild::Size > reduce( const Array< crimild::Real32 > &times, const Array< T > &keys, crimild::Real32 tolerance, crimild::Bool reduceKeys )
+         {
+            const auto count = std::min( times.size(), keys.size() );
+
+            Array< crimild::Size > ret;
+            if ( count == 0 ) {
+               return ret;
+            }
+
+            // Constant channels only need one key
+            crimild::Bool constant = true;
+            for ( crimild::Size i = 1; constant && i < count; ++i ) {
+               constant = compression::error( keys[ 0 ], keys[ i ] ) <= tolerance;
+            }
+            if ( constant || count == 1 ) {
+               ret.add( 0 );
+               return ret;
+            }
+
+            if ( !reduceKeys ) {
+               for ( crimild::Size i = 0; i < count; ++i ) {
+                  ret.add( i );
+               }
+               return ret;
+            }
+
+            crimild::Size anchor = 0;
+            ret.add( anchor );
+            while ( anchor < count - 1 ) {
+               auto next = anchor + 1;
+               while ( next + 1 < count ) {
+                  const auto candidate = next + 1;
+                  const auto t0 = times[ anchor ];
+                  const auto dt = times[ candidate ] - t0;
+                  crimild::Bool valid = dt > 0;
+                  for ( auto i = anchor + 1; valid && i < candidate; ++i ) {
+                     T value;
+                     interpolate( keys[ anchor ], keys[ candidate ], ( times[ i ] - t0 ) / dt, value );
+                     valid = compression::error( value, keys[ i ] ) <= tolerance;
+                  }
+                  if ( !valid ) {
+                     break;
+                  }
+                  next = candidate;
+               }
+               ret.add( next );
+               anchor = next;
+            }
+
+            return ret;
+         }
+
+         void compress( const Array< crimild::Real32 > &times, const Array< T > &keys, const CompressionSettings &settings, CompressionStats *stats )
+         {
+            const auto indices = reduce( times, keys, getTolerance( settings ), settings.reduceKeys );
+
+            _keyCount = indices.size();
+            _ranges.clear();
+            _data.clear();
+
+            if ( _keyCount == 0 ) {
+               _startTime = _endTime = 0;
+               updateTimeScale();
+               return;
+            }
+
+            _startTime = times[ indices.first() ];
+            // Constant channels still span the original duration
+            _endTime = _keyCount > 1 ? times[ indices.last() ] : times.last();
+            updateTimeScale();
+
+            if constexpr ( COMPONENTS > 0 ) {
+               // Per-channel range reduction
+               _ranges = Array< crimild::Real32 >( 2 * COMPONENTS );
+               for ( crimild::Size c = 0; c < COMPONENTS; ++c ) {
+                  auto lo = Traits::get( keys[ indices[ 0 ] ], c );
+                  auto hi = lo;
+                  for ( crimild::Size i = 1; i < _keyCount; ++i ) {
+                     const auto value = Traits::get( keys[ indices[ i ] ], c );
+                     lo = std::min( lo, value );
+                     hi = std::max( hi, value );
+                  }
+                  _ranges[ c ] = lo;
+                  _ranges[ COMPONENTS + c ] = ( hi - lo ) / MAX_VALUE;
+               }
+            }
+
+            const auto timeWords = _keyCount > 1 ? _keyCount : 0;
+            _data = ByteArray( ( timeWords + _keyCount * WORDS ) * sizeof( crimild::UInt16 ) );
+            auto words = reinterpret_cast< crimild::UInt16 * >( _data.getData() );
+
+            for ( crimild::Size i = 0; i < timeWords; ++i ) {
+               *words++ = compression::quantize( times[ indices[ i ] ], _startTime, _endTime - _startTime );
+            }
+
+            for ( crimild::Size i = 0; i < _keyCount; ++i ) {
+               const auto &key = keys[ indices[ i ] ];
+               if constexpr ( COMPONENTS == 0 ) {
+                  compression::packQuaternion( key, words );
+               } else {
+                  for ( crimild::Size c = 0; c < COMPONENTS; ++c ) {
+                     words[ c ] = compression::quantize( Traits::get( key, c ), _ranges[ c ], _ranges[ COMPONENTS + c ] * MAX_VALUE );
+                  }
+               }
+               words += WORDS;
+            }
+
+            if ( stats != nullptr ) {
+               ++stats->channels;
+               stats->constantChannels += isConstant() ? 1 : 0;
+               stats->originalKeys += keys.size();
+               stats->compressedKeys += _keyCount;
+               stats->originalBytes += times.size() * sizeof( crimild::Real32 ) + keys.size() * sizeof( T );
+               stats->compressedBytes += getSizeInBytes();
+            }
+         }
+
+         void updateTimeScale( void ) noexcept
+         {
+            const auto duration = _endTime - _startTime;
+            _timeStep = duration / MAX_VALUE;
+            _timeScale = duration > 0 ? MAX_VALUE / duration : 0.0f;
+         }
+
+      private:
+         crimild::Real32 _startTime = 0;
+         crimild::Real32 _endTime = 0;
+         crimild::Real32 _timeStep = 0;
+         crimild::Real32 _timeScale = 0;
+         crimild::Size _keyCount = 0;
+
+         /**
+            \brief Minimum value and quantization step for each component
+          */
+         Array< crimild::Real32 > _ranges;
+
+         /**
+            \brief Quantized key times (if more than one key) followed by quantized keys
+          */
+         ByteArray _data;
+
+         /**
+            \name Coding
+         */
+         //@{
+
+      public:
+         virtual void encode( coding::Encoder &encoder ) override
+         {
+            Codable::encode( encoder );
+
+            encoder.encode( "name", getName() );
+            encoder.encode( "startTime", _startTime );
+            encoder.encode( "endTime", _endTime );
+            encoder.encode( "keyCount", _keyCount );
+            encoder.encode( "ranges", _ranges );
+            encoder.encode( "data", _data );
+         }
+
+         virtual void decode( coding::Decoder &decoder ) override
+         {
+            Codable::decode( decoder );
+
+            std::string name;
+            decoder.decode( "name", name );
+            setName( name );
+
+            decoder.decode( "startTime", _startTime );
+            decoder.decode( "endTime", _endTime );
+            decoder.decode( "keyCount", _keyCount );
+            decoder.decode( "ranges", _ranges );
+            decoder.decode( "data", _data );
+
+            const auto timeWords = _keyCount > 1 ? _keyCount : 0;
+            if ( _data.size() < ( timeWords + _keyCount * WORDS ) * sizeof( crimild::UInt16 ) || _ranges.size() < 2 * COMPONENTS ) {
+               // Invalid data. Treat it as an empty channel
+               _keyCount = 0;
+            }
+
+            updateTimeScale();
+         }
+
+         //@}
+      };
+
+      class CompressedVector3fChannel : public CompressedChannelImpl< Vector3f > {
+         CRIMILD_IMPLEMENT_RTTI( crimild::animation::CompressedVector3fChannel )
+
+      public:
+         CompressedVector3fChannel( void ) { }
+
+         CompressedVector3fChannel( const Vector3fChannel &source, const CompressionSettings &settings, CompressionStats *stats = nullptr )
+            : CompressedChannelImpl( source, settings, stats )
+         {
+         }
+
+         virtual ~CompressedVector3fChannel( void )
+         {
+         }
+      };
+
+      class CompressedQuaternionChannel : public CompressedChannelImpl< Quaternion > {
+         CRIMILD_IMPLEMENT_RTTI( crimild::animation::CompressedQuaternionChannel )
+
+      public:
+         CompressedQuaternionChannel( void ) { }
+
+         CompressedQuaternionChannel( const QuaternionChannel &source, const CompressionSettings &settings, CompressionStats *stats = nullptr )
+            : CompressedChannelImpl( source, settings, stats )
+         {
+         }
+
+         virtual ~CompressedQuaternionChannel( void )
+         {
+         }
+      };
+
+      class CompressedReal32Channel : public CompressedChannelImpl< Real32 > {
+         CRIMILD_IMPLEMENT_RTTI( crimild::animation::CompressedReal32Channel )
+
+      public:
+         CompressedReal32Channel( void ) { }
+
+         CompressedReal32Channel( const Real32Channel &source, const CompressionSettings &settings, CompressionStats *stats = nullptr )
+            : CompressedChannelImpl( source, settings, stats )
+         {
+         }
+
+         virtual ~CompressedReal32Channel( void )
+         {
+         }
+      };
+
+      /**
+         \brief Creates a compressed copy of a channel
+
+         \returns The compressed channel, or null if the channel type is not supported (i.e.
+         it is already compressed)
+       */
+      SharedPointer< Channel > compress( Channel *channel, const CompressionSettings &settings, CompressionStats *stats = nullptr );
+
+   }
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Pose.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+Pose::Target::Property Pose::Target::parse( const std::string &channelName, std::string &jointName ) noexcept
+{
+   const auto length = channelName.size();
+   if ( length < 3 || channelName[ length - 3 ] != '[' || channelName[ length - 1 ] != ']' ) {
+      jointName = channelName;
+      return Property::NONE;
+   }
+
+   jointName = channelName.substr( 0, length - 3 );
+   switch ( channelName[ length - 2 ] ) {
+      case 'p':
+         return Property::TRANSLATION;
+      case 'r':
+         return Property::ROTATION;
+      case 's':
+         return Property::SCALE;
+      default:
+         return Property::NONE;
+   }
+}
+
+Pose::Pose( crimild::Size jointCount ) noexcept
+{
+   reset( jointCount );
+}
+
+void Pose::reset( crimild::Size jointCount ) noexcept
+{
+   _jointCount = jointCount;
+   _data.assign( COMPONENT_COUNT * jointCount, 0 );
+   std::fill( component( SX ), component( SZ ) + jointCount, Real32( 1 ) );
+   std::fill( component( RW ), component( RW ) + jointCount, Real32( 1 ) );
+}
+
+void Pose::setTransformation( crimild::Size joint, const Transformation &transformation ) noexcept
+{
+   const auto &t = transformation.translate;
+   setTranslation( joint, Vector3f { t.x, t.y, t.z } );
+   setRotation( joint, transformation.rotate );
+   setScale( joint, transformation.scale );
+}
+
+Transformation Pose::getTransformation( crimild::Size joint ) const noexcept
+{
+   const auto t = getTranslation( joint );
+   Transformation ret;
+   ret.translate = Point3 { t.x, t.y, t.z };
+   ret.rotate = getRotation( joint );
+   ret.scale = getScale( joint );
+   return ret;
+}
+
+void Pose::setRotation( crimild::Size joint, const Quaternion &rotation ) noexcept
+{
+   component( RX )[ joint ] = rotation.v.x;
+   component( RY )[ joint ] = rotation.v.y;
+   component( RZ )[ joint ] = rotation.v.z;
+   component( RW )[ joint ] = rotation.w;
+}
+
+Quaternion Pose::getRotation( crimild::Size joint ) const noexcept
+{
+   return Quaternion {
+      component( RX )[ joint ],
+      component( RY )[ joint ],
+      component( RZ )[ joint ],
+      component( RW )[ joint ],
+   };
+}
+
+crimild::Size Pose::getMask( Target::Property property ) noexcept
+{
+   switch ( property ) {
+      case Target::Property::TRANSLATION:
+         return TRANSLATION_MASK;
+      case Target::Property::ROTATION:
+         return ROTATION_MASK;
+      case Target::Property::SCALE:
+         return SCALE_MASK;
+      default:
+         return COMPONENT_COUNT;
+   }
+}
+
+crimild::Bool Pose::isAnimated( crimild::Size joint, Target::Property property ) const noexcept
+{
+   const auto mask = getMask( property );
+   return joint < _jointCount && mask < COMPONENT_COUNT && component( mask )[ joint ] > 0;
+}
+
+void Pose::set( const Target &target, const Vector3f &value ) noexcept
+{
+   if ( target.joint >= _jointCount ) {
+      return;
+   }
+
+   if ( target.property == Target::Property::TRANSLATION ) {
+      setTranslation( target.joint, value );
+      component( TRANSLATION_MASK )[ target.joint ] = 1;
+   } else if ( target.property == Target::Property::SCALE ) {
+      setScale( target.joint, value );
+      component( SCALE_MASK )[ target.joint ] = 1;
+   }
+}
+
+void Pose::set( const Target &target, const Quaternion &value ) noexcept
+{
+   if ( target.joint < _jointCount && target.property == Target::Property::ROTATION ) {
+      setRotation( target.joint, value );
+      component( ROTATION_MASK )[ target.joint ] = 1;
+   }
+}
+
+void Pose::set( crimild::Size first, crimild::Size joint, const Vector3f &value ) noexcept
+{
+   component( first + 0 )[ joint ] = value.x;
+   component( first + 1 )[ joint ] = value.y;
+   component( first + 2 )[ joint ] = value.z;
+}
+
+Vector3f Pose::get( crimild::Size first, crimild::Size joint ) const noexcept
+{
+   return Vector3f {
+      component( first + 0 )[ joint ],
+      component( first + 1 )[ joint ],
+      component( first + 2 )[ joint ],
+   };
+}
+
+void Pose::lerp( const Pose &other, crimild::Real32 factor ) noexcept
+{
+   assert( _jointCount == other._jointCount && "Pose size mismatch" );
+
+   const auto N = _jointCount;
+
+   // Translations and scales
+   for ( Size c = TX; c <= SZ; ++c ) {
+      auto *a = component( c );
+      const auto *b = other.component( c );
+      const auto *mask = other.component( c < SX ? TRANSLATION_MASK : SCALE_MASK );
+      for ( Size i = 0; i < N; ++i ) {
+         a[ i ] += ( b[ i ] - a[ i ] ) * ( factor * mask[ i ] );
+      }
+   }
+
+   auto *ax = component( RX );
+   auto *ay = component( RY );
+   auto *az = component( RZ );
+   auto *aw = component( RW );
+   const auto *bx = other.component( RX );
+   const auto *by = other.component( RY );
+   const auto *bz = other.component( RZ );
+   const auto *bw = other.component( RW );
+   const auto *mask = other.component( ROTATION_MASK );
+   for ( Size i = 0; i < N; ++i ) {
+      const auto f = factor * mask[ i ];
+
+      // Flip the other rotation if needed, so we interpolate along the shortest path
+      const auto dot = ax[ i ] * bx[ i ] + ay[ i ] * by[ i ] + az[ i ] * bz[ i ] + aw[ i ] * bw[ i ];
+      const auto s = dot < 0 ? -f : f;
+      const auto x = ax[ i ] + ( bx[ i ] * s - ax[ i ] * f );
+      const auto y = ay[ i ] + ( by[ i ] * s - ay[ i ] * f );
+      const auto z = az[ i ] + ( bz[ i ] * s - az[ i ] * f );
+      const auto w = aw[ i ] + ( bw[ i ] * s - aw[ i ] * f );
+      const auto invLength = Real32( 1 ) / std::sqrt( x * x + y * y + z * z + w * w );
+      ax[ i ] = x * invLength;
+      ay[ i ] = y * invLength;
+      az[ i ] = z * invLength;
+      aw[ i ] = w * invLength;
+   }
+
+   mergeMasks( other );
+}
+
+void Pose::add( const Pose &other, crimild::Real32 strength ) noexcept
+{
+   assert( _jointCount == other._jointCount && "Pose size mismatch" );
+
+   const auto N = _jointCount;
+
+   // Translations and scales
+   for ( Size c = TX; c <= SZ; ++c ) {
+      auto *a = component( c );
+      const auto *b = other.component( c );
+      const auto *mask = other.component( c < SX ? TRANSLATION_MASK : SCALE_MASK );
+      for ( Size i = 0; i < N; ++i ) {
+         a[ i ] += b[ i ] * ( strength * mask[ i ] );
+      }
+   }
+
+   auto *ax = component( RX );
+   auto *ay = component( RY );
+   auto *az = component( RZ );
+   auto *aw = component( RW );
+   const auto *bx = other.component( RX );
+   const auto *by = other.component( RY );
+   const auto *bz = other.component( RZ );
+   const auto *bw = other.component( RW );
+   const auto *mask = other.component( ROTATION_MASK );
+   for ( Size i = 0; i < N; ++i ) {
+      const auto s = strength * mask[ i ];
+
+      // Scale the other rotation by strength (nlerp from identity)
+      auto qx = bx[ i ] * s;
+      auto qy = by[ i ] * s;
+      auto qz = bz[ i ] * s;
+      auto qw = Real32( 1 ) + ( bw[ i ] - Real32( 1 ) ) * s;
+      const auto invLength = Real32( 1 ) / std::sqrt( qx * qx + qy * qy + qz * qz + qw * qw );
+      qx *= invLength;
+      qy *= invLength;
+      qz *= invLength;
+      qw *= invLength;
+
+      // a * q
+      const auto x = aw[ i ] * qx + ax[ i ] * qw + ay[ i ] * qz - az[ i ] * qy;
+      const auto y = aw[ i ] * qy - ax[ i ] * qz + ay[ i ] * qw + az[ i ] * qx;
+      const auto z = aw[ i ] * qz + ax[ i ] * qy - ay[ i ] * qx + az[ i ] * qw;
+      const auto w = aw[ i ] * qw - ax[ i ] * qx - ay[ i ] * qy - az[ i ] * qz;
+      ax[ i ] = x;
+      ay[ i ] = y;
+      az[ i ] = z;
+      aw[ i ] = w;
+   }
+
+   mergeMasks( other );
+}
+
+void Pose::mergeMasks( const Pose &other ) noexcept
+{
+   auto *a = component( TRANSLATION_MASK );
+   const auto *b = other.component( TRANSLATION_MASK );
+   const auto count = 3 * _jointCount;
+   for ( Size i = 0; i < count; ++i ) {
+      a[ i ] = std::max( a[ i ], b[ i ] );
+   }
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_ANIMATION_POSE_
+#define CRIMILD_ANIMATION_POSE_
+
+#include <crimild/foundation.hpp>
+#include <crimild/math/Quaternion.hpp>
+#include <crimild/math/Transformation.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <string>
+#include <vector>
+
+namespace crimild {
+
+   namespace animation {
+
+      /**
+         \brief Local transformations for all joints in a skeleton
+
+         Each component is stored in its own array (translation x for all joints,
+         then translation y, and so on), so blending whole poses is a set of plain
+         loops over floats that compilers can vectorize.
+
+         Joints are indexed by their ids. Poses also keep track of which properties
+         have been set by channels, so only animated values are blended into other
+         poses, like accumulators used to do.
+       */
+      class Pose {
+      public:
+         /**
+            \brief Identifies the joint and property that a channel writes to
+          */
+         struct Target {
+            enum class Property : crimild::UInt8 {
+               NONE,
+               TRANSLATION,
+               ROTATION,
+               SCALE,
+            };
+
+            crimild::UInt32 joint = 0;
+            Property property = Property::NONE;
+
+            /**
+               \brief Parses channel names like "joint[p]", "joint[r]" or "joint[s]"
+
+               \param jointName Set to the name of the joint on return
+             */
+            static Property parse( const std::string &channelName, std::string &jointName ) noexcept;
+         };
+
+      public:
+         Pose( void ) = default;
+         explicit Pose( crimild::Size jointCount ) noexcept;
+         ~Pose( void ) = default;
+
+         /**
+            \brief Resizes the pose, resetting all joints to identity
+
+            All properties are marked as not animated.
+          */
+         void reset( crimild::Size jointCount ) noexcept;
+
+         inline crimild::Size getJointCount( void ) const noexcept { return _jointCount; }
+
+         /**
+            \brief Checks if a property has been set by a channel or blended from another pose
+          */
+         crimild::Bool isAnimated( crimild::Size joint, Target::Property property ) const noexcept;
+
+         void setTransformation( crimild::Size joint, const Transformation &transformation ) noexcept;
+         Transformation getTransformation( crimild::Size joint ) const noexcept;
+
+         void setTranslation( crimild::Size joint, const Vector3f &translation ) noexcept { set( TX, joint, translation ); }
+         Vector3f getTranslation( crimild::Size joint ) const noexcept { return get( TX, joint ); }
+
+         void setRotation( crimild::Size joint, const Quaternion &rotation ) noexcept;
+         Quaternion getRotation( crimild::Size joint ) const noexcept;
+
+         void setScale( crimild::Size joint, const Vector3f &scale ) noexcept { set( SX, joint, scale ); }
+         Vector3f getScale( crimild::Size joint ) const noexcept { return get( SX, joint ); }
+
+         /**
+            \brief Sets the value of a channel
+
+            Only Vector3f (translation or scale) and Quaternion (rotation) values
+            are supported. Other types are ignored. The property is marked as animated.
+          */
+         //@{
+         void set( const Target &target, const Vector3f &value ) noexcept;
+         void set( const Target &target, const Quaternion &value ) noexcept;
+
+         template< typename T >
+         inline void set( const Target &, const T & ) noexcept { }
+         //@}
+
+         /**
+            \brief Blends with another pose
+
+            Translations and scales are interpolated linearly. Rotations use normalized
+            linear interpolation along the shortest path, which is close enough to slerp
+            for blending and much cheaper. Only properties animated in the other pose
+            are modified.
+
+            \remarks Both poses must have the same number of joints
+          */
+         void lerp( const Pose &other, crimild::Real32 factor ) noexcept;
+
+         /**
+            \brief Adds another pose on top of this one (additive blending)
+
+            Translations and scales are added. Rotations are concatenated. Only properties
+            animated in the other pose are modified.
+          */
+         void add( const Pose &other, crimild::Real32 strength ) noexcept;
+
+      private:
+         /**
+            \brief Component arrays, in storage order
+
+            Masks are 1 for animated properties and 0 otherwise, so they can be used as
+            blending weights without branching.
+          */
+         enum Component : crimild::Size {
+            TX,
+            TY,
+            TZ,
+            SX,
+            SY,
+            SZ,
+            RX,
+            RY,
+            RZ,
+            RW,
+            TRANSLATION_MASK,
+            ROTATION_MASK,
+            SCALE_MASK,
+            COMPONENT_COUNT,
+         };
+
+         inline crimild::Real32 *component( crimild::Size c ) noexcept { return _data.data() + c * _jointCount; }
+         inline const crimild::Real32 *component( crimild::Size c ) const noexcept { return _data.data() + c * _jointCount; }
+
+         static crimild::Size getMask( Target::Property property ) noexcept;
+
+         void set( crimild::Size first, crimild::Size joint, const Vector3f &value ) noexcept;
+         Vector3f get( crimild::Size first, crimild::Size joint ) const noexcept;
+
+         void mergeMasks( const Pose &other ) noexcept;
+
+      private:
+         crimild::Size _jointCount = 0;
+         std::vector< crimild::Real32 > _data;
+      };
+
+   }
+
+}
+
+#endif
@@ -29,12 +29,16 @@
 
 #include "Animation.hpp"
 #include "Clip.hpp"
+#include "Skinning.hpp"
 #include "Debug/DebugRenderHelper.hpp"
+#include "Rendering/VertexBuffer.hpp"
 #include "SceneGraph/Node.hpp"
 #include "Visitors/Apply.hpp"
 
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
+#include <algorithm>
+#include <unordered_map>
 
 using namespace crimild;
 using namespace crimild::animation;
@@ -99,24 +103,172 @@ void Skeleton::start( void )
          getJoints().insert( joint->getName(), crimild::retain( joint ) );
       }
    } ) );
+
+   invalidateHierarchy();
 }
 
 void Skeleton::animate( Animation *animation )
 {
-   getJoints().each( [ animation ]( const std::string &, SharedPointer< Joint > const &joint ) {
-      auto name = joint->getName();
-      auto node = joint->getNode();
+   if ( animation == nullptr ) {
+      return;
+   }
 
-      // TODO
-      // animation->getValue( name + "[p]", node->local().translate() );
-      // animation->getValue( name + "[r]", node->local().rotate() );
-      // animation->getValue( name + "[s]", node->local().scale() );
+   if ( !animation->isBoundTo( this ) ) {
+      animation->bind( this );
+   }
 
-      // Transformation pose;
-      // pose.computeFrom( node->getParent()->getWorld(), node->getLocal() );
-      // pose.computeFrom( pose, joint->getOffset() );
-      // joint->setPoseMatrix( pose.computeModelMatrix() );
+   auto pose = animation->getPose();
+   if ( pose == nullptr ) {
+      return;
+   }
+
+   getJoints().eachValue( [ pose ]( SharedPointer< Joint > const &joint ) {
+      auto node = joint->getNode();
+      if ( node != nullptr && joint->getId() < pose->getJointCount() ) {
+         node->setLocal( pose->getTransformation( joint->getId() ) );
+      }
    } );
+
+   computePalette( *pose );
+}
+
+Animation *Skeleton::updateAnimation( const Clock &clock ) noexcept
+{
+   _appliedAnimation = nullptr;
+
+   auto animation = _animationCallback != nullptr ? _animationCallback( clock ) : getAnimation();
+   if ( animation == nullptr ) {
+      return nullptr;
+   }
+
+   if ( _animationCallback == nullptr ) {
+      animation->update( clock );
+   }
+
+   if ( !animation->isBoundTo( this ) ) {
+      animation->bind( this );
+   }
+
+   auto pose = animation->getPose();
+   if ( pose == nullptr ) {
+      return nullptr;
+   }
+
+   computePalette( *pose );
+   skin();
+
+   _appliedAnimation = animation;
+   return animation;
+}
+
+void Skeleton::updateJointNodes( void ) noexcept
+{
+   if ( _appliedAnimation == nullptr ) {
+      return;
+   }
+
+   const auto pose = _appliedAnimation->getPose();
+   if ( pose == nullptr ) {
+      return;
+   }
+
+   for ( const auto &entry : _hierarchy ) {
+      const auto id = entry.joint->getId();
+      auto node = entry.joint->getNode();
+      if ( node != nullptr && id < pose->getJointCount() ) {
+         node->setLocal( pose->getTransformation( id ) );
+      }
+   }
+}
+
+SharedPointer< VertexBuffer > Skeleton::attachSkin( SharedPointer< SkinnedVertices > const &vertices, SharedPointer< VertexBuffer > target ) noexcept
+{
+   if ( vertices == nullptr ) {
+      return nullptr;
+   }
+
+   if ( target == nullptr ) {
+      target = vertices->createTarget();
+   }
+
+   _skins.push_back( Skin { vertices, target } );
+   return target;
+}
+
+void Skeleton::skin( void ) noexcept
+{
+   for ( auto &skin : _skins ) {
+      skin.vertices->skin( _palette.data(), _palette.size(), crimild::get_ptr( skin.target ) );
+   }
+}
+
+void Skeleton::buildHierarchy( void ) noexcept
+{
+   _hierarchy.clear();
+
+   auto root = getNode();
+   if ( root == nullptr ) {
+      return;
+   }
+
+   std::unordered_map< const Node *, crimild::Int32 > entries;
+
+   // Apply visits parents before children
+   root->perform( Apply( [ this, root, &entries ]( Node *node ) {
+      auto joint = node->getComponent< Joint >();
+      if ( joint == nullptr || !getJoints().contains( joint->getName() ) ) {
+         return;
+      }
+
+      JointEntry entry;
+      entry.joint = joint;
+      entry.rest = node->getLocal();
+
+      // Find the closest joint ancestor, accumulating transformations of nodes in between
+      auto parent = node->getParent();
+      while ( parent != nullptr && parent != root ) {
+         auto it = entries.find( parent );
+         if ( it != entries.end() ) {
+            entry.parent = it->second;
+            break;
+         }
+         entry.intermediate = parent->getLocal()( entry.intermediate );
+         parent = parent->getParent();
+      }
+
+      entries[ node ] = crimild::Int32( _hierarchy.size() );
+      _hierarchy.push_back( entry );
+   } ) );
+}
+
+void Skeleton::computePalette( const Pose &pose ) noexcept
+{
+   if ( _hierarchy.empty() ) {
+      buildHierarchy();
+   }
+
+   crimild::Size jointCount = 0;
+   for ( const auto &entry : _hierarchy ) {
+      jointCount = std::max( jointCount, crimild::Size( entry.joint->getId() ) + 1 );
+   }
+
+   _model.resize( _hierarchy.size() );
+   _palette.resize( jointCount, Matrix4f::Constants::IDENTITY );
+
+   for ( crimild::Size i = 0; i < _hierarchy.size(); ++i ) {
+      const auto &entry = _hierarchy[ i ];
+      const auto id = entry.joint->getId();
+
+      const auto local = id < pose.getJointCount() ? pose.getTransformation( id ) : entry.rest;
+      auto model = entry.intermediate( local );
+      if ( entry.parent >= 0 ) {
+         model = _model[ entry.parent ]( model );
+      }
+      _model[ i ] = model;
+
+      _palette[ id ] = Matrix4f( _globalInverseTransform( model( entry.joint->getOffset() ) ) );
+      entry.joint->setPoseMatrix( _palette[ id ] );
+   }
 }
 
 void Skeleton::encode( coding::Encoder &encoder )
@@ -30,14 +30,21 @@
 
 #include "Components/NodeComponent.hpp"
 
+#include <crimild/math/Matrix4.hpp>
 #include <crimild/math/Transformation.hpp>
+#include <functional>
+#include <vector>
 
 namespace crimild {
 
+   class VertexBuffer;
+
    namespace animation {
 
       class Clip;
       class Animation;
+      class Pose;
+      class SkinnedVertices;
 
       class Joint : public NamedObject,
                     public NodeComponent {
@@ -94,7 +101,11 @@ namespace crimild {
          Skeleton( void );
          virtual ~Skeleton( void );
 
-         void setJoints( const JointCatalog &joints ) { _joints = joints; }
+         void setJoints( const JointCatalog &joints )
+         {
+            _joints = joints;
+            invalidateHierarchy();
+         }
          JointCatalog &getJoints( void ) { return _joints; }
 
          void setGlobalInverseTransform( const Transformation &transform ) { _globalInverseTransform = transform; }
@@ -110,7 +121,143 @@ namespace crimild {
          ClipCatalog _clips;
          Transformation _globalInverseTransform;
 
+         /**
+            \name Joint palette
+          */
+         //@{
+
       public:
+         /**
+            \brief Computes pose matrices for all joints from a pose
+
+            Joint transformations are composed from the pose alone, without touching
+            nodes, so palettes for different skeletons can be computed in parallel.
+            Results are relative to the skeleton's node and are stored contiguously,
+            indexed by joint id. They are also copied to each joint.
+
+            \see Joint::getPoseMatrix
+          */
+         void computePalette( const Pose &pose ) noexcept;
+
+         inline const std::vector< Matrix4f > &getPalette( void ) const noexcept { return _palette; }
+
+         /**
+            \brief Rebuilds cached joint hierarchy on the next palette update
+
+            Call this whenever joints are added, removed or reparented.
+          */
+         void invalidateHierarchy( void ) noexcept { _hierarchy.clear(); }
+
+      private:
+         void buildHierarchy( void ) noexcept;
+
+      private:
+         /**
+            \brief Joints in hierarchy order, so parents are always processed before their children
+          */
+         struct JointEntry {
+            Joint *joint = nullptr;
+            crimild::Int32 parent = -1;
+
+            /**
+               \brief Transformation of nodes in between this joint and its parent's
+             */
+            Transformation intermediate;
+
+            /**
+               \brief Local transformation used for joints that are not in the pose
+             */
+            Transformation rest;
+         };
+
+         std::vector< JointEntry > _hierarchy;
+         std::vector< Transformation > _model;
+         std::vector< Matrix4f > _palette;
+
+         //@}
+
+         /**
+            \name Playback
+          */
+         //@{
+
+      public:
+         using AnimationCallback = std::function< Animation *( const Clock & ) >;
+
+         /**
+            \brief Sets the animation played by this skeleton
+
+            Active animations are updated by AnimationStage. The animation is bound
+            to this skeleton, so it must not be shared with other ones.
+          */
+         void setAnimation( SharedPointer< Animation > const &animation ) noexcept { _animation = animation; }
+         Animation *getAnimation( void ) noexcept { return crimild::get_ptr( _animation ); }
+
+         /**
+            \brief Overrides how the active animation is updated
+
+            Useful for blending several animations together. The callback must return
+            the animation whose pose is applied to joints. It is invoked from worker
+            threads, so it should only touch animations owned by this skeleton.
+
+            Animations used by the callback should be bound to this skeleton beforehand,
+            so they are blended as poses.
+          */
+         void setAnimationCallback( AnimationCallback const &callback ) noexcept { _animationCallback = callback; }
+
+         inline crimild::Bool hasAnimation( void ) const noexcept { return _animation != nullptr || _animationCallback != nullptr; }
+
+         /**
+            \brief Updates the active animation, computes the joint palette and deforms all skins
+
+            Nodes are not modified, so different skeletons can be updated in parallel.
+
+            \returns The animation that was applied, or null if there is none
+          */
+         Animation *updateAnimation( const Clock &clock ) noexcept;
+
+         /**
+            \brief Sets local transformations of joint nodes from the last applied animation
+
+            \remarks Must be called from the main thread
+          */
+         void updateJointNodes( void ) noexcept;
+
+         /**
+            \brief Attaches vertices to be deformed by this skeleton on the CPU
+
+            \param target A dynamic vertex buffer for the deformed vertices. If null,
+            a new one is created.
+          */
+         SharedPointer< VertexBuffer > attachSkin( SharedPointer< SkinnedVertices > const &vertices, SharedPointer< VertexBuffer > target = nullptr ) noexcept;
+
+         /**
+            \brief Deforms all attached skins using the current palette
+          */
+         void skin( void ) noexcept;
+
+      private:
+         struct Skin {
+            SharedPointer< SkinnedVertices > vertices;
+            SharedPointer< VertexBuffer > target;
+         };
+
+         SharedPointer< Animation > _animation;
+         AnimationCallback _animationCallback;
+         Animation *_appliedAnimation = nullptr;
+         std::vector< Skin > _skins;
+
+         //@}
+
+      public:
+         /**
+            \brief Applies the current pose of an animation to all joints
+
+            The animation is bound to this skeleton first if needed. Joint nodes are
+            updated with the pose and the joint palette is recomputed.
+
+            \see Animation::bind
+          */
          void animate( SharedPointer< Animation > const &animation ) { animate( crimild::get_ptr( animation ) ); }
          void animate( Animation *animation );
 
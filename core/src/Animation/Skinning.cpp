@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Skinning.hpp"
+
+#include "Rendering/VertexBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+SkinnedVertices::SkinnedVertices( const VertexBuffer *source ) noexcept
+{
+   if ( source == nullptr ) {
+      return;
+   }
+
+   const auto positions = source->get( VertexAttribute::Name::POSITION );
+   const auto normals = source->get( VertexAttribute::Name::NORMAL );
+   const auto indices = source->get( VertexAttribute::Name::BLEND_INDICES );
+   const auto weights = source->get( VertexAttribute::Name::BLEND_WEIGHT );
+   if ( positions == nullptr || indices == nullptr || weights == nullptr ) {
+      CRIMILD_LOG_WARNING( "Skinned vertices require positions, blend indices and blend weights" );
+      return;
+   }
+
+   _hasNormals = normals != nullptr;
+
+   _vertices.resize( source->getVertexCount() );
+
+   positions->each< Vector3f >( [ this ]( const Vector3f &p, auto i ) {
+      auto &v = _vertices[ i ];
+      v.position[ 0 ] = p.x;
+      v.position[ 1 ] = p.y;
+      v.position[ 2 ] = p.z;
+      v.position[ 3 ] = 1;
+      v.normal[ 0 ] = 0;
+      v.normal[ 1 ] = 0;
+      v.normal[ 2 ] = 0;
+      v.normal[ 3 ] = 0;
+   } );
+
+   if ( _hasNormals ) {
+      normals->each< Vector3f >( [ this ]( const Vector3f &n, auto i ) {
+         auto &v = _vertices[ i ];
+         v.normal[ 0 ] = n.x;
+         v.normal[ 1 ] = n.y;
+         v.normal[ 2 ] = n.z;
+      } );
+   }
+
+   indices->each< Vector4f >( [ this ]( const Vector4f &j, auto i ) {
+      auto &v = _vertices[ i ];
+      for ( Size k = 0; k < 4; ++k ) {
+         v.joints[ k ] = UInt32( std::max( Real32( 0 ), j[ k ] ) );
+         _maxJoint = std::max( _maxJoint, v.joints[ k ] );
+      }
+   } );
+
+   weights->each< Vector4f >( [ this ]( const Vector4f &w, auto i ) {
+      auto &v = _vertices[ i ];
+      for ( Size k = 0; k < 4; ++k ) {
+         v.weights[ k ] = w[ k ];
+      }
+   } );
+}
+
+SharedPointer< VertexBuffer > SkinnedVertices::createTarget( void ) const noexcept
+{
+   auto ret = crimild::alloc< VertexBuffer >( _hasNormals ? VertexLayout::P3_N3 : VertexLayout::P3, getVertexCount() );
+   ret->getBufferView()->setUsage( BufferView::Usage::DYNAMIC );
+
+   // Start with the bind pose, so targets are valid even before skinning
+   auto positions = ret->get( VertexAttribute::Name::POSITION );
+   auto normals = _hasNormals ? ret->get( VertexAttribute::Name::NORMAL ) : nullptr;
+   for ( Size i = 0; i < _vertices.size(); ++i ) {
+      const auto &v = _vertices[ i ];
+      positions->set( i, Vector3f { v.position[ 0 ], v.position[ 1 ], v.position[ 2 ] } );
+      if ( normals != nullptr ) {
+         normals->set( i, Vector3f { v.normal[ 0 ], v.normal[ 1 ], v.normal[ 2 ] } );
+      }
+   }
+
+   return ret;
+}
+
+void SkinnedVertices::skin( const Matrix4f *palette, crimild::Size jointCount, VertexBuffer *target ) noexcept
+{
+   if ( _vertices.empty() || palette == nullptr || target == nullptr ) {
+      return;
+   }
+
+   if ( _maxJoint >= jointCount ) {
+      CRIMILD_LOG_WARNING( "Not enough joints in palette for skinning" );
+      return;
+   }
+
+   auto positions = target->get( VertexAttribute::Name::POSITION );
+   auto normals = _hasNormals ? target->get( VertexAttribute::Name::NORMAL ) : nullptr;
+   if ( positions == nullptr || target->getVertexCount() < _vertices.size() ) {
+      return;
+   }
+
+   _rows.resize( jointCount );
+   for ( Size j = 0; j < jointCount; ++j ) {
+      const auto &M = palette[ j ];
+      for ( Size r = 0; r < 3; ++r ) {
+         for ( Size c = 0; c < 4; ++c ) {
+            _rows[ j ].r[ r ][ c ] = M[ c ][ r ];
+         }
+      }
+   }
+
+   auto data = target->getBufferView()->getData();
+   const auto stride = target->getBufferView()->getStride();
+   const auto positionOffset = positions->getOffset();
+   const auto normalOffset = normals != nullptr ? normals->getOffset() : 0;
+
+   const auto N = _vertices.size();
+   const auto *rows = _rows.data();
+
+#if CRIMILD_ANIMATION_SKINNING_SSE
+   alignas( 16 ) Real32 out[ 4 ];
+
+   for ( Size i = 0; i < N; ++i ) {
+      const auto &v = _vertices[ i ];
+      auto *dst = data + i * stride;
+
+      // Blend joint matrices by weight
+      const auto w = _mm_load_ps( v.weights );
+      auto r0 = _mm_setzero_ps();
+      auto r1 = _mm_setzero_ps();
+      auto r2 = _mm_setzero_ps();
+      const auto accumulate = [ &r0, &r1, &r2 ]( const Rows &M, __m128 wk ) {
+         r0 = _mm_add_ps( r0, _mm_mul_ps( wk, _mm_load_ps( M.r[ 0 ] ) ) );
+         r1 = _mm_add_ps( r1, _mm_mul_ps( wk, _mm_load_ps( M.r[ 1 ] ) ) );
+         r2 = _mm_add_ps( r2, _mm_mul_ps( wk, _mm_load_ps( M.r[ 2 ] ) ) );
+      };
+      accumulate( rows[ v.joints[ 0 ] ], _mm_shuffle_ps( w, w, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+      accumulate( rows[ v.joints[ 1 ] ], _mm_shuffle_ps( w, w, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+      accumulate( rows[ v.joints[ 2 ] ], _mm_shuffle_ps( w, w, _MM_SHUFFLE( 2, 2, 2, 2 ) ) );
+      accumulate( rows[ v.joints[ 3 ] ], _mm_shuffle_ps( w, w, _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+
+      const auto transform = [ &r0, &r1, &r2 ]( __m128 p ) {
+         auto x = _mm_mul_ps( r0, p );
+         auto y = _mm_mul_ps( r1, p );
+         auto z = _mm_mul_ps( r2, p );
+         auto t = _mm_setzero_ps();
+         _MM_TRANSPOSE4_PS( x, y, z, t );
+         return _mm_add_ps( _mm_add_ps( x, y ), _mm_add_ps( z, t ) );
+      };
+
+      _mm_store_ps( out, transform( _mm_load_ps( v.position ) ) );
+      std::memcpy( dst + positionOffset, out, 3 * sizeof( Real32 ) );
+
+      if ( normals != nullptr ) {
+         const auto n = transform( _mm_load_ps( v.normal ) );
+         const auto n2 = _mm_mul_ps( n, n );
+         _mm_store_ps( out, n2 );
+         const auto length2 = out[ 0 ] + out[ 1 ] + out[ 2 ];
+         const auto invLength = length2 > 0 ? _mm_set1_ps( 1.0f / std::sqrt( length2 ) ) : _mm_setzero_ps();
+         _mm_store_ps( out, _mm_mul_ps( n, invLength ) );
+         std::memcpy( dst + normalOffset, out, 3 * sizeof( Real32 ) );
+      }
+   }
+#else
+   Real32 out[ 3 ];
+
+   for ( Size i = 0; i < N; ++i ) {
+      const auto &v = _vertices[ i ];
+      auto *dst = data + i * stride;
+
+      // Blend joint matrices by weight
+      Real32 m[ 3 ][ 4 ] = {};
+      for ( Size k = 0; k < 4; ++k ) {
+         const auto &M = rows[ v.joints[ k ] ];
+         const auto wk = v.weights[ k ];
+         for ( Size r = 0; r < 3; ++r ) {
+            for ( Size c = 0; c < 4; ++c ) {
+               m[ r ][ c ] += wk * M.r[ r ][ c ];
+            }
+         }
+      }
+
+      for ( Size r = 0; r < 3; ++r ) {
+         out[ r ] = m[ r ][ 0 ] * v.position[ 0 ] + m[ r ][ 1 ] * v.position[ 1 ] + m[ r ][ 2 ] * v.position[ 2 ] + m[ r ][ 3 ];
+      }
+      std::memcpy( dst + positionOffset, out, sizeof( out ) );
+
+      if ( normals != nullptr ) {
+         for ( Size r = 0; r < 3; ++r ) {
+            out[ r ] = m[ r ][ 0 ] * v.normal[ 0 ] + m[ r ][ 1 ] * v.normal[ 1 ] + m[ r ][ 2 ] * v.normal[ 2 ];
+         }
+         const auto length2 = out[ 0 ] * out[ 0 ] + out[ 1 ] * out[ 1 ] + out[ 2 ] * out[ 2 ];
+         const auto invLength = length2 > 0 ? 1.0f / std::sqrt( length2 ) : 0.0f;
+         for ( Size r = 0; r < 3; ++r ) {
+            out[ r ] *= invLength;
+         }
+         std::memcpy( dst + normalOffset, out, sizeof( out ) );
+      }
+   }
+#endif
+}
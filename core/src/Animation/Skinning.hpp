@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_ANIMATION_SKINNING_
+#define CRIMILD_ANIMATION_SKINNING_
+
+#include <crimild/foundation.hpp>
+#include <crimild/math/Matrix4.hpp>
+#include <vector>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+   #define CRIMILD_ANIMATION_SKINNING_SSE 1
+   #include <xmmintrin.h>
+#endif
+
+namespace crimild {
+
+   class VertexBuffer;
+
+   namespace animation {
+
+      /**
+         \brief Deforms vertices on the CPU using a joint palette
+
+         Bind pose positions, normals and up to four joint influences per vertex are
+         copied from a source vertex buffer once, packed so each vertex fits in a single
+         cache line. Skinning writes deformed positions and normals into a target
+         buffer, which is usually dynamic and streamed to the GPU every frame.
+
+         Joint indices are read from BLEND_INDICES and weights from BLEND_WEIGHT, both
+         stored as Vector4f. NORMAL is optional.
+
+         Instances are not thread-safe, but different instances can be skinned in parallel.
+       */
+      class SkinnedVertices {
+      public:
+         SkinnedVertices( void ) = default;
+         explicit SkinnedVertices( const VertexBuffer *source ) noexcept;
+         ~SkinnedVertices( void ) = default;
+
+         inline crimild::Size getVertexCount( void ) const noexcept { return _vertices.size(); }
+         inline crimild::Bool hasNormals( void ) const noexcept { return _hasNormals; }
+
+         /**
+            \brief Creates a dynamic vertex buffer with positions and normals, matching the source
+
+            The buffer is initialized with the bind pose.
+          */
+         SharedPointer< VertexBuffer > createTarget( void ) const noexcept;
+
+         /**
+            \brief Deforms all vertices and stores the results in target
+
+            \param palette Pose matrices indexed by joint id
+            \param target A vertex buffer with at least as many vertices as the source.
+            Positions are required and stored as Vector3f. Normals are written only if
+            both the source and the target have them.
+
+            \see Skeleton::getPalette
+          */
+         void skin( const Matrix4f *palette, crimild::Size jointCount, VertexBuffer *target ) noexcept;
+
+      private:
+         struct alignas( 16 ) Vertex {
+            crimild::Real32 position[ 4 ];
+            crimild::Real32 normal[ 4 ];
+            crimild::Real32 weights[ 4 ];
+            crimild::UInt32 joints[ 4 ];
+         };
+
+         /**
+            \brief The top three rows of a pose matrix
+          */
+         struct alignas( 16 ) Rows {
+            crimild::Real32 r[ 3 ][ 4 ];
+         };
+
+         std::vector< Vertex > _vertices;
+         std::vector< Rows > _rows;
+         crimild::UInt32 _maxJoint = 0;
+         crimild::Bool _hasNormals = false;
+      };
+
+   }
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 
 #include "Rendering/VertexBuffer.hpp"
 
+#include <crimild/math/corner.hpp>
 #include <crimild/math/distance.hpp>
 #include <crimild/math/intersect.hpp>
 #include <crimild/math/max.hpp>
@@ -62,11 +63,15 @@ void AABBBoundingVolume::computeFrom( const BoundingVolume *volume )
 
 void AABBBoundingVolume::computeFrom( const BoundingVolume *volume, const Transformation &transformation )
 {
-   const auto p0 = transformation( volume->getMin() );
-   const auto p1 = transformation( volume->getMax() );
-
-   const auto min = crimild::min( p0, p1 );
-   const auto max = crimild::max( p0, p1 );
+   // All corners must be transformed, since rotations change which ones are the extremes
+   const auto B = Bounds3 { volume->getMin(), volume->getMax() };
+   auto min = transformation( corner( B, 0 ) );
+   auto max = min;
+   for ( size_t i = 1; i < 8; ++i ) {
+      const auto P = transformation( corner( B, i ) );
+      min = crimild::min( min, P );
+      max = crimild::max( max, P );
+   }
 
    computeFrom( min, max );
 }
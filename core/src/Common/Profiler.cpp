@@ -27,7 +27,7 @@
 
 #include "Profiler.hpp"
 
-#include "Concurrency/JobScheduler.hpp"
+#include "Concurrency/TaskSystem.hpp"
 #include "Debug/DebugRenderHelper.hpp"
 #include "Rendering/Renderer.hpp"
 #include "Rendering/ShaderProgram.hpp"
@@ -81,11 +81,11 @@ void ProfilerOutputHandler::beginOutput( crimild::Size fps, crimild::Real64 avgF
            << "\n----------------------------------------------------------------------------------------\n";
 
    // Job system
-   _output << "Job count (" << ( JobScheduler::getInstance()->getNumWorkers() + 1 ) << " workers): ";
-   JobScheduler::getInstance()->eachWorkerStat( [ this ]( JobScheduler::WorkerId workerId, const JobScheduler::WorkerStat &stat ) {
+   _output << "Job count (" << ( TaskSystem::getInstance()->getNumWorkers() + 1 ) << " workers): ";
+   TaskSystem::getInstance()->eachWorkerStat( [ this ]( TaskSystem::WorkerIndex, const TaskSystem::WorkerStat &stat ) {
       _output << std::setw( 5 ) << std::right << stat.jobCount;
    } );
-   JobScheduler::getInstance()->clearWorkerStats();
+   TaskSystem::getInstance()->clearWorkerStats();
    _output << std::left
            << "\n----------------------------------------------------------------------------------------\n";
 
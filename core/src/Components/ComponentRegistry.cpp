@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Components/ComponentRegistry.hpp"
+
+#include "Components/NodeComponent.hpp"
+
+using namespace crimild;
+
+ComponentTypeId ComponentRegistry::getTypeId( const std::string &componentName )
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   auto it = m_typeIds.find( componentName );
+   if ( it != m_typeIds.end() ) {
+      return it->second;
+   }
+
+   const auto typeId = ComponentTypeId( m_pools.size() );
+   m_typeIds[ componentName ] = typeId;
+   m_pools.emplace_back();
+   return typeId;
+}
+
+ComponentTypeId ComponentRegistry::findTypeId( const std::string &componentName ) const
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   auto it = m_typeIds.find( componentName );
+   return it != m_typeIds.end() ? it->second : INVALID_TYPE_ID;
+}
+
+ComponentTypeId ComponentRegistry::getTypeCount( void ) const
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   return ComponentTypeId( m_pools.size() );
+}
+
+size_t ComponentRegistry::getComponentCount( ComponentTypeId typeId ) const
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   if ( typeId >= m_pools.size() ) {
+      return 0;
+   }
+
+   const auto &pool = m_pools[ typeId ];
+   if ( !m_needsCompaction ) {
+      return pool.size();
+   }
+   return std::count_if( pool.begin(), pool.end(), []( auto component ) { return component != nullptr; } );
+}
+
+void ComponentRegistry::collect( ComponentTypeId typeId, std::vector< SharedPointer< NodeComponent > > &out ) const
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   out.clear();
+   if ( typeId >= m_pools.size() ) {
+      return;
+   }
+
+   const auto &pool = m_pools[ typeId ];
+   out.reserve( pool.size() );
+   for ( auto component : pool ) {
+      if ( component != nullptr ) {
+         out.push_back( crimild::retain( component ) );
+      }
+   }
+}
+
+void ComponentRegistry::add( NodeComponent *component )
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   auto &pool = m_pools[ component->getComponentTypeId() ];
+   component->_registryIndex = pool.size();
+   pool.push_back( component );
+}
+
+void ComponentRegistry::remove( NodeComponent *component )
+{
+   std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+   const auto index = component->_registryIndex;
+   auto &pool = m_pools[ component->getComponentTypeId() ];
+   if ( index >= pool.size() || pool[ index ] != component ) {
+      return;
+   }
+
+   if ( m_iterating > 0 ) {
+      pool[ index ] = nullptr;
+      m_needsCompaction = true;
+   } else {
+      pool[ index ] = pool.back();
+      pool[ index ]->_registryIndex = index;
+      pool.pop_back();
+   }
+
+   component->_registryIndex = NodeComponent::INVALID_REGISTRY_INDEX;
+}
+
+void ComponentRegistry::compact( void )
+{
+   // Keep the relative order of the remaining components
+   for ( auto &pool : m_pools ) {
+      size_t count = 0;
+      for ( auto component : pool ) {
+         if ( component != nullptr ) {
+            component->_registryIndex = count;
+            pool[ count++ ] = component;
+         }
+      }
+      pool.resize( count );
+   }
+   m_needsCompaction = false;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_COMPONENTS_REGISTRY_
+#define CRIMILD_CORE_COMPONENTS_REGISTRY_
+
+#include <crimild/foundation.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crimild {
+
+   class NodeComponent;
+
+   using ComponentTypeId = UInt32;
+
+   /**
+      \brief Assigns dense type ids to component classes and tracks all attached components
+
+      Ids are assigned on first use, based on component names, so they are only
+      valid for the current run and must never be serialized.
+
+      Attached components are grouped by type in contiguous arrays, so systems can
+      process all components of a given type in a tight loop (see forEach()).
+
+      \remarks All methods are thread-safe. Iteration holds a lock, so components
+      should not wait for other threads attaching or detaching components while
+      being visited.
+    */
+   class ComponentRegistry {
+   public:
+      static constexpr ComponentTypeId INVALID_TYPE_ID = ~ComponentTypeId( 0 );
+
+   private:
+      ComponentRegistry( void ) = default;
+      ~ComponentRegistry( void ) = default;
+
+   public:
+      static ComponentRegistry &getInstance( void )
+      {
+         static ComponentRegistry instance;
+         return instance;
+      }
+
+      /**
+         \brief Type id for a component class
+
+         The id is computed only once per class.
+       */
+      template< class NodeComponentType >
+      static ComponentTypeId getTypeId( void )
+      {
+         static const auto typeId = getInstance().getTypeId( NodeComponentType::__CLASS_NAME );
+         return typeId;
+      }
+
+      /**
+         \brief Type id for a component name, registering it if needed
+       */
+      ComponentTypeId getTypeId( const std::string &componentName );
+
+      /**
+         \brief Type id for a component name, or INVALID_TYPE_ID if not registered yet
+       */
+      ComponentTypeId findTypeId( const std::string &componentName ) const;
+
+      ComponentTypeId getTypeCount( void ) const;
+
+      /**
+         \brief Number of attached components with the given type
+       */
+      size_t getComponentCount( ComponentTypeId typeId ) const;
+
+      /**
+         \brief Copies every attached component of a given type into out
+
+         Components in out are retained, so they can be visited without holding
+         the registry lock while other components are attached or detached. Order
+         is unspecified, since removing a component moves the last one in its
+         place.
+       */
+      void collect( ComponentTypeId typeId, std::vector< SharedPointer< NodeComponent > > &out ) const;
+
+      /**
+         \brief Invokes callback for every attached component of a given type
+
+         Components attached while iterating are not visited. Components detached
+         while iterating are skipped if not visited yet.
+       */
+      template< typename Fn >
+      void forEach( ComponentTypeId typeId, Fn &&callback )
+      {
+         std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+         if ( typeId >= m_pools.size() ) {
+            return;
+         }
+
+         ++m_iterating;
+         const auto count = m_pools[ typeId ].size();
+         for ( size_t i = 0; i < count; ++i ) {
+            // Pools may grow while iterating, so don't keep references around
+            if ( auto component = m_pools[ typeId ][ i ] ) {
+               callback( component );
+            }
+         }
+         if ( --m_iterating == 0 && m_needsCompaction ) {
+            compact();
+         }
+      }
+
+   private:
+      friend class Node;
+
+      /**
+         \brief Invoked by nodes when attaching a component
+       */
+      void add( NodeComponent *component );
+
+      /**
+         \brief Invoked by nodes when detaching a component
+
+         If iterating, components are only removed from their pools after
+         iteration ends in order to keep indices stable.
+       */
+      void remove( NodeComponent *component );
+
+      void compact( void );
+
+   private:
+      mutable std::recursive_mutex m_mutex;
+      std::unordered_map< std::string, ComponentTypeId > m_typeIds;
+      std::vector< std::vector< NodeComponent * > > m_pools;
+      UInt32 m_iterating = 0;
+      bool m_needsCompaction = false;
+   };
+
+}
+
+#endif
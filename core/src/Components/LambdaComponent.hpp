@@ -48,9 +48,18 @@ namespace crimild {
         virtual void start( void ) override;
 		virtual void update( const Clock &t ) override;
 
+        /**
+           \brief Flags the callback as safe to run while rendering
+
+           \see NodeComponent::isRenderSafe()
+         */
+        void setRenderSafe( bool renderSafe ) { m_renderSafe = renderSafe; }
+        virtual bool isRenderSafe( void ) const override { return m_renderSafe; }
+
 	private:
         Callback _callback;
         bool m_invokeOnStart = false;
+        bool m_renderSafe = false;
 	};
 
 	using UpdateCallback = LambdaComponent;
@@ -49,6 +49,15 @@ NodeComponent *NodeComponent::getComponentWithName( std::string name )
     return getNode()->getComponentWithName( name );
 }
 
+NodeComponent *NodeComponent::getComponentWithTypeId( ComponentTypeId typeId )
+{
+    if ( getNode() == nullptr ) {
+        return nullptr;
+    }
+
+    return getNode()->getComponentWithTypeId( typeId );
+}
+
 void NodeComponent::onAttach( void )
 {
 }
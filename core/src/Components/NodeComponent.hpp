@@ -28,6 +28,7 @@
 #ifndef CRIMILD_COMPONENTS_NODE_COMPONENT_
 #define CRIMILD_COMPONENTS_NODE_COMPONENT_
 
+#include "Components/ComponentRegistry.hpp"
 #include "Simulation/Clock.hpp"
 
 #include <crimild/coding/Codable.hpp>
@@ -57,6 +58,19 @@ namespace crimild {
    public:
       virtual const char *getComponentName( void ) const { return getClassName(); }
 
+      /**
+         \brief Dense id for this component's name
+
+         \see ComponentRegistry
+       */
+      ComponentTypeId getComponentTypeId( void ) const
+      {
+         if ( _componentTypeId == ComponentRegistry::INVALID_TYPE_ID ) {
+            _componentTypeId = ComponentRegistry::getInstance().getTypeId( getComponentName() );
+         }
+         return _componentTypeId;
+      }
+
       Node *getNode( void ) { return _node; }
 
       const Node *getNode( void ) const { return _node; }
@@ -70,14 +84,20 @@ namespace crimild {
    private:
       Node *_node = nullptr;
       bool _enabled = true;
+      mutable ComponentTypeId _componentTypeId = ComponentRegistry::INVALID_TYPE_ID;
+
+      friend class ComponentRegistry;
+      static constexpr size_t INVALID_REGISTRY_INDEX = ~size_t( 0 );
+      size_t _registryIndex = INVALID_REGISTRY_INDEX;
 
    public:
       NodeComponent *getComponentWithName( std::string name );
+      NodeComponent *getComponentWithTypeId( ComponentTypeId typeId );
 
       template< class NODE_COMPONENT_CLASS >
       NODE_COMPONENT_CLASS *getComponent( void )
       {
-         return static_cast< NODE_COMPONENT_CLASS * >( getComponentWithName( NODE_COMPONENT_CLASS::__CLASS_NAME ) );
+         return static_cast< NODE_COMPONENT_CLASS * >( getComponentWithTypeId( ComponentRegistry::getTypeId< NODE_COMPONENT_CLASS >() ) );
       }
 
    public:
@@ -96,6 +116,19 @@ namespace crimild {
               */
       virtual void update( const Clock & );
 
+      /**
+         \brief Whether update() can run while render stages read the scene
+
+         When the frame pipeline is enabled, only components returning true
+         are updated while commands for the previous frame are recorded. They
+         must not modify world transformations, bounds, materials, primitives
+         or the hierarchy itself. Every other component is updated once
+         recording is done. Defaults to false.
+
+         \see FramePipeline
+       */
+      virtual bool isRenderSafe( void ) const { return false; }
+
       /**
                       \brief Invoked only if debug rendering is enabled
               */
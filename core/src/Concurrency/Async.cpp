@@ -26,54 +26,16 @@
  */
 
 #include "Async.hpp"
-#include "JobScheduler.hpp"
 
 using namespace crimild;
 using namespace crimild::concurrency;
 
 JobPtr crimild::concurrency::async( void )
 {
-    auto job = crimild::alloc< Job >();
-	job->reset();
-	return job;
+   return TaskSystem::getInstance()->create();
 }
 
-JobPtr crimild::concurrency::async( JobCallback const &callback )
+void crimild::concurrency::wait( JobPtr job )
 {
-    auto job = crimild::alloc< Job >();
-	job->reset( callback );
-	JobScheduler::getInstance()->schedule( job );
-	return job;
+   TaskSystem::getInstance()->wait( job );
 }
-
-JobPtr crimild::concurrency::async( JobPtr const &parent, JobCallback const &callback )
-{
-    auto child = crimild::alloc< Job >();
-	child->reset( parent, callback );
-	JobScheduler::getInstance()->schedule( child );
-	return child;
-}
-
-JobPtr crimild::concurrency::sync_frame( JobCallback const &callback )
-{
-    auto job = crimild::alloc< Job >();
-    job->reset( callback );
-    JobScheduler::getInstance()->delaySync( job );
-    return job;
-}
-
-JobPtr crimild::concurrency::async_frame( JobCallback const &callback )
-{
-    auto job = crimild::alloc< Job >();
-    job->reset( callback );
-    JobScheduler::getInstance()->delayAsync( job );
-    return job;
-}
-
-void crimild::concurrency::wait( JobPtr const &job )
-{
-	JobScheduler::getInstance()->wait( job );
-}
-
-
-
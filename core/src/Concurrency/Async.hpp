@@ -29,67 +29,95 @@
 #define CRIMILD_CORE_ASYNC_
 
 #include "Job.hpp"
+#include "TaskSystem.hpp"
 
 namespace crimild {
 
-	namespace concurrency {
-
-        /**
-            \brief Creates an empty job
-         
-            Since the job is empty, it is not dispatched to the scheduler. This
-            function is useful to create parent jobs for parallel operations
-         
-            \remarks The new job will not be executed since it's empty
-         */
-		JobPtr async( void );
-
-        /**
-            \brief Creates and dispatches an async job
-         
-            \remarks The job will be executed in a background thread
-         */
-		JobPtr async( JobCallback const &callback );
-
-        /**
-            \brief Creates and dispatches an async job linked to a parent
-         
-            \remarks The job will be executed in a background thread
-         */
-		JobPtr async( JobPtr const &parent, JobCallback const &callback );
-
-        /**
-            \brief Creates and dispatches a job in the main thread
-         
-            This method will create a new job and enqueue it to be executed
-            at the beginning of the next simulation step. 
-         
-            \remarks The job will be executed in the main thread.
-         */
-		JobPtr sync_frame( JobCallback const &callback );
-
-        /**
-            \brief Creates and dispatches an async job in the main thread
-         
-            This method will create a new job and enqueue it to be executed
-            at the beginning of the next simulation step. 
-         
-            \remarks The job will be executed in a background thread
-         */
-		JobPtr async_frame( JobCallback const &callback );
-
-        /**
-            \brief Waits for a job to be completed
-         
-            Blocks the operation of the current thread until the job
-            is completed. In the meantime, other jobs may be executed
-            in the current thread, if any.
-         */
-		void wait( JobPtr const &job );
-
-	}
+   namespace concurrency {
+
+      /**
+         \brief Creates an empty job
+
+         Since the job is empty, it is not dispatched to the scheduler. This
+         function is useful to create parent jobs for parallel operations
+
+         \remarks The new job will not be executed since it's empty
+       */
+      JobPtr async( void );
+
+      /**
+         \brief Creates and dispatches an async job
+
+         \remarks The job will be executed in a background thread
+       */
+      template< typename Fn >
+      JobPtr async( Fn &&callback )
+      {
+         auto tasks = TaskSystem::getInstance();
+         auto job = tasks->create( nullptr, std::forward< Fn >( callback ) );
+         tasks->submit( job );
+         return job;
+      }
+
+      /**
+         \brief Creates and dispatches an async job linked to a parent
+
+         \remarks The job will be executed in a background thread
+       */
+      template< typename Fn >
+      JobPtr async( JobPtr parent, Fn &&callback )
+      {
+         auto tasks = TaskSystem::getInstance();
+         auto job = tasks->create( parent, std::forward< Fn >( callback ) );
+         tasks->submit( job );
+         return job;
+      }
+
+      /**
+         \brief Creates and dispatches a job in the main thread
+
+         This method will create a new job and enqueue it to be executed
+         at the beginning of the next simulation step.
+
+         \remarks The job will be executed in the main thread.
+       */
+      template< typename Fn >
+      JobPtr sync_frame( Fn &&callback )
+      {
+         auto tasks = TaskSystem::getInstance();
+         auto job = tasks->create( nullptr, std::forward< Fn >( callback ) );
+         tasks->delaySync( job );
+         return job;
+      }
+
+      /**
+         \brief Creates and dispatches an async job in the main thread
+
+         This method will create a new job and enqueue it to be executed
+         at the beginning of the next simulation step.
+
+         \remarks The job will be executed in a background thread
+       */
+      template< typename Fn >
+      JobPtr async_frame( Fn &&callback )
+      {
+         auto tasks = TaskSystem::getInstance();
+         auto job = tasks->create( nullptr, std::forward< Fn >( callback ) );
+         tasks->delayAsync( job );
+         return job;
+      }
+
+      /**
+         \brief Waits for a job to be completed
+
+         Blocks the operation of the current thread until the job
+         is completed. In the meantime, other jobs may be executed
+         in the current thread, if any.
+       */
+      void wait( JobPtr job );
+
+   }
 
 }
 
 #endif
-
@@ -27,81 +27,87 @@
 
 #include "Job.hpp"
 
-using namespace crimild;
-using namespace crimild::concurrency;
-
-Job::Job( void )
-	: _callback( nullptr ),
-      _parent( nullptr ),
-	  _childCount( 0 )
-{
+#include "TaskSystem.hpp"
 
-}
+#include <cassert>
 
-Job::~Job( void )
-{
-
-}
-
-void Job::reset( void )
-{
-	_callback = nullptr;
-	_parent = nullptr;
-	_childCount = 0;
-}
-
-void Job::reset( JobCallback const &callback )
-{
-	_callback = callback;
-	_parent = nullptr;
-	_childCount = 1;
-}
+using namespace crimild;
+using namespace crimild::concurrency;
 
-void Job::reset( JobPtr const &parent, JobCallback const &callback )
-{
-	_callback = callback;
-    _parent = crimild::get_ptr( parent );
-	_childCount = 1;
+namespace crimild::concurrency::impl {
 
-	if ( _parent != nullptr ) {
-		_parent->increaseChildCount();
-	}
-}
+   /**
+      \brief Marks a continuation list as closed (i.e. the job is completed)
+    */
+   static Job *const CLOSED_CONTINUATIONS = reinterpret_cast< Job * >( std::uintptr_t( 1 ) );
 
-void Job::increaseChildCount( void )
-{
-	++_childCount;
 }
 
-void Job::decreaseChildCount( void )
+void Job::reset( Job *parent )
 {
-	if ( _childCount > 0 ) {
-		--_childCount;
-	}
+   _invoke = nullptr;
+   _destroy = nullptr;
+   _parent = parent;
+   _continuations.store( nullptr, std::memory_order_relaxed );
+   _nextContinuation = nullptr;
+   _next = nullptr;
+   _unfinished.store( 0, std::memory_order_relaxed );
+   _dependencies.store( 1, std::memory_order_relaxed );
+   _finishing.store( 0, std::memory_order_relaxed );
 }
 
-void Job::attachContinuation( JobContinuationCallback const &callback )
+void Job::attachContinuation( Job *continuation )
 {
-	_continuations.push_back( callback );
+   if ( continuation == nullptr ) {
+      return;
+   }
+
+   continuation->_dependencies.fetch_add( 1, std::memory_order_relaxed );
+
+   auto head = _continuations.load( std::memory_order_acquire );
+   while ( head != impl::CLOSED_CONTINUATIONS ) {
+      continuation->_nextContinuation = head;
+      if ( _continuations.compare_exchange_weak( head, continuation, std::memory_order_acq_rel, std::memory_order_acquire ) ) {
+         return;
+      }
+   }
+
+   // This job is already completed. Resolve the dependency right away
+   TaskSystem::getInstance()->release( continuation );
 }
 
 void Job::execute( void )
 {
-	if ( _callback != nullptr ) {
-		_callback();
-	}
-
-	finish();
+   if ( _invoke != nullptr ) {
+      _invoke( this );
+      _destroy( this );
+      _invoke = nullptr;
+      _destroy = nullptr;
+   }
+
+   finish();
 }
 
 void Job::finish( void )
 {
-	decreaseChildCount();
-	if ( isCompleted() ) {
-		if ( _parent != nullptr ) {
-			_parent->finish();
-		}
-        _callback = nullptr;
-	}
+   // Keep the job busy until we're done with it, even after the counter drops to zero
+   _finishing.fetch_add( 1, std::memory_order_relaxed );
+
+   if ( _unfinished.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+      auto parent = _parent;
+
+      auto continuation = _continuations.exchange( impl::CLOSED_CONTINUATIONS, std::memory_order_acq_rel );
+      assert( continuation != impl::CLOSED_CONTINUATIONS && "Job completed more than once" );
+      while ( continuation != nullptr && continuation != impl::CLOSED_CONTINUATIONS ) {
+         auto next = continuation->_nextContinuation;
+         TaskSystem::getInstance()->release( continuation );
+         continuation = next;
+      }
+
+      if ( parent != nullptr ) {
+         parent->finish();
+      }
+   }
+
+   _finishing.fetch_sub( 1, std::memory_order_release );
 }
-
@@ -1,7 +1,7 @@
 /*
  * Copyright (c) 2013, Hernan Saez
  * All rights reserved.
- *
+ * 
  * Redistribution and use in source and binary forms, with or without
  * modification, are permitted provided that the following conditions are met:
  *     * Redistributions of source code must retain the above copyright
@@ -12,7 +12,7 @@
  *     * Neither the name of the <organization> nor the
  *       names of its contributors may be used to endorse or promote products
  *       derived from this software without specific prior written permission.
- *
+ * 
  * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
  * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
@@ -30,86 +30,179 @@
 
 #include <atomic>
 #include <crimild/foundation.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace crimild {
 
    namespace concurrency {
 
       class Job;
-
-      using JobPtr = SharedPointer< Job >;
+      class TaskSystem;
 
       /**
-         \brief Callback for a job
+         \brief Handle to a job
+
+         Jobs are owned by the TaskSystem, which allocates them from per-worker
+         arenas. A handle is valid until the job is completed and the next
+         frame begins. Do not keep handles around for longer than that.
        */
-      using JobCallback = std::function< void( void ) >;
+      using JobPtr = Job *;
 
       /**
-         \brief Callback for job continuations
+         \brief Callback for a job
        */
-      using JobContinuationCallback = std::function< void( void ) >;
+      using JobCallback = std::function< void( void ) >;
 
       /**
          \brief Describes a job that can be executed concurrently
+
+         Jobs are fixed-size objects that keep their callable inline, so
+         scheduling work does not allocate memory as long as the callable is
+         small enough (see STORAGE_SIZE). Larger callables are moved into a
+         heap-allocated copy instead.
+
+         Completion is tracked with intrusive counters:
+         - The unfinished counter starts at 1 if the job has work to do (0 for
+           empty jobs) and is incremented for each child job. The job is
+           completed once the counter drops to zero.
+         - The dependency counter holds the number of events that must happen
+           before the job can be executed. It starts at 1 (released by
+           TaskSystem::submit()) and is incremented for every job this one
+           is a continuation of.
+
+         \remarks Jobs are created through the TaskSystem and should never be
+         instantiated directly.
        */
-      class Job : public SharedObject, public NamedObject {
+      class alignas( 64 ) Job {
       public:
-         Job( void );
-         virtual ~Job( void );
+         static constexpr size_t SIZE = 128;
 
-         void reset( void );
-         void reset( JobCallback const &callback );
-         void reset( JobPtr const &parent, JobCallback const &callback );
+      private:
+         static constexpr size_t HEADER_SIZE = 2 * sizeof( void * ) + 4 * sizeof( Job * ) + 3 * sizeof( std::atomic< std::int32_t > );
 
-         void execute( void );
-         void finish( void );
+      public:
+         static constexpr size_t STORAGE_SIZE = SIZE - ( ( HEADER_SIZE + 15 ) & ~size_t( 15 ) );
 
-         bool isCompleted( void ) const { return _childCount == 0; }
+      public:
+         Job( void ) = default;
+         ~Job( void ) = default;
 
-      private:
-         JobCallback _callback;
+         Job( Job const & ) = delete;
+         Job &operator=( Job const & ) = delete;
+
+         bool isCompleted( void ) const { return _unfinished.load( std::memory_order_acquire ) == 0; }
 
-      public:
          Job *getParent( void ) const { return _parent; }
 
-      private:
-         Job *_parent = nullptr;
+         std::int32_t getChildCount( void ) const { return _unfinished.load( std::memory_order_relaxed ); }
 
          /**
-            \name Child management
+            \brief Attach a job to be submitted once this one is completed
+
+            The continuation is submitted immediately if this job is already
+            completed. A continuation may depend on more than one job, in which
+            case it will be executed after all of them are completed.
+
+            \remarks The continuation must not have been submitted yet.
           */
-      public:
-         void increaseChildCount( void );
-         void decreaseChildCount( void );
-         size_t getChildCount( void ) const { return _childCount; }
+         void attachContinuation( Job *continuation );
 
       private:
+         friend class TaskSystem;
+
+         template< typename Fn >
+         void reset( Job *parent, Fn &&fn );
+
+         void reset( Job *parent );
+
+         void execute( void );
+         void finish( void );
+
          /**
-            \brief Keep track of child jobs
+            \brief Checks if the job's memory can be reused
 
-            The starting value for the _childCount variable depends on
-            whether or not the job has anything to do. If the job was
-            created with a valid callback, the child count starts at 1.
-            Otherwise, it starts at zero indicating this job does nothing
-            (and will probably be used to manage child jobs)
+            A job is busy while it has pending work (including children),
+            has not been submitted yet or some thread is still completing it.
           */
-         std::atomic< size_t > _childCount;
+         bool isBusy( void ) const
+         {
+            return _unfinished.load( std::memory_order_acquire ) > 0
+                   || _dependencies.load( std::memory_order_acquire ) > 0
+                   || _finishing.load( std::memory_order_acquire ) > 0;
+         }
 
          /**
-            \name Continuation support
-         */
-         //@{
+            \brief Decrements the dependency counter
 
-      public:
-         void attachContinuation( JobContinuationCallback const &continuation );
+            \returns true if the job is ready to be executed
+          */
+         bool release( void ) { return _dependencies.fetch_sub( 1, std::memory_order_acq_rel ) == 1; }
 
       private:
-         std::vector< JobContinuationCallback > _continuations;
+         using Invoke = void ( * )( Job * );
 
-         //@}
+         Invoke _invoke = nullptr;
+         Invoke _destroy = nullptr;
+
+         Job *_parent = nullptr;
+
+         /**
+            \brief Intrusive list of continuations
+          */
+         std::atomic< Job * > _continuations = { nullptr };
+         Job *_nextContinuation = nullptr;
+
+         /**
+            \brief Intrusive link used by TaskSystem for delayed jobs
+          */
+         Job *_next = nullptr;
+
+         std::atomic< std::int32_t > _unfinished = { 0 };
+         std::atomic< std::int32_t > _dependencies = { 0 };
+         std::atomic< std::int32_t > _finishing = { 0 };
+
+         alignas( 16 ) std::byte _storage[ STORAGE_SIZE ];
       };
 
+      static_assert( sizeof( Job ) == Job::SIZE, "Job size does not match Job::SIZE" );
+
+      template< typename Fn >
+      void Job::reset( Job *parent, Fn &&fn )
+      {
+         using Callable = std::decay_t< Fn >;
+
+         reset( parent );
+
+         if constexpr ( sizeof( Callable ) <= STORAGE_SIZE && alignof( Callable ) <= 16 ) {
+            new ( _storage ) Callable( std::forward< Fn >( fn ) );
+            _invoke = []( Job *job ) {
+               ( *std::launder( reinterpret_cast< Callable * >( job->_storage ) ) )();
+            };
+            _destroy = []( Job *job ) {
+               std::launder( reinterpret_cast< Callable * >( job->_storage ) )->~Callable();
+            };
+         } else {
+            // Callable is too big. Keep a heap copy instead
+            new ( _storage ) Callable *( new Callable( std::forward< Fn >( fn ) ) );
+            _invoke = []( Job *job ) {
+               ( **std::launder( reinterpret_cast< Callable ** >( job->_storage ) ) )();
+            };
+            _destroy = []( Job *job ) {
+               delete *std::launder( reinterpret_cast< Callable ** >( job->_storage ) );
+            };
+         }
+
+         _unfinished.store( 1, std::memory_order_relaxed );
+         if ( _parent != nullptr ) {
+            _parent->_unfinished.fetch_add( 1, std::memory_order_relaxed );
+         }
+      }
+
    }
 
 }
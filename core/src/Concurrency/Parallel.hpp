@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CONCURRENCY_PARALLEL_
+#define CRIMILD_CORE_CONCURRENCY_PARALLEL_
+
+#include "TaskSystem.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace crimild::concurrency {
+
+   /**
+      \brief A half-open range of indices [begin, end)
+    */
+   struct Range {
+      size_t begin = 0;
+      size_t end = 0;
+
+      constexpr size_t size( void ) const noexcept { return end > begin ? end - begin : 0; }
+   };
+
+   namespace impl {
+
+      /**
+         \brief Recursively splits a range in halves until chunks are no bigger than grain
+
+         The right half is always spawned as a new job, so idle workers can steal
+         big chunks of work first. Chunk boundaries are always multiples of grain
+         relative to the beginning of the original range.
+       */
+      template< typename Fn >
+      void parallelForSplit( TaskSystem *tasks, Job *root, Range range, size_t grain, Fn *fn )
+      {
+         while ( range.size() > grain ) {
+            const auto chunks = ( range.size() + grain - 1 ) / grain;
+            const auto mid = range.begin + ( chunks / 2 ) * grain;
+            const auto right = Range { mid, range.end };
+            tasks->submit(
+               tasks->create(
+                  root,
+                  [ tasks, root, right, grain, fn ] {
+                     parallelForSplit( tasks, root, right, grain, fn );
+                  }
+               )
+            );
+            range.end = mid;
+         }
+
+         ( *fn )( range );
+      }
+
+   }
+
+   /**
+      \brief Invokes fn( Range chunk ) for each chunk of the range, in parallel
+
+      Chunks have at most grain elements. The calling thread takes part in the
+      work and this function returns only after all chunks have been processed.
+    */
+   template< typename Fn >
+   void parallel_for( Range range, size_t grain, Fn &&fn )
+   {
+      if ( range.size() == 0 ) {
+         return;
+      }
+
+      grain = std::max( size_t( 1 ), grain );
+
+      auto tasks = TaskSystem::getInstance();
+      if ( tasks == nullptr || range.size() <= grain ) {
+         fn( range );
+         return;
+      }
+
+      // The root has work of its own (a no-op) that is only submitted once the
+      // calling thread is done spawning children. Otherwise, the root could be
+      // completed more than once if children finish before the next one is spawned.
+      auto root = tasks->create( nullptr, [] {} );
+      impl::parallelForSplit( tasks, root, range, grain, &fn );
+      tasks->submit( root );
+      tasks->wait( root );
+   }
+
+   /**
+      \brief Computes map( Range chunk ) for every chunk in parallel and combines results with reduce
+
+      Partial results are combined in chunk order, so the result does not depend
+      on the number of workers nor on the order in which chunks are executed.
+    */
+   template< typename T, typename Map, typename Reduce >
+   T parallel_reduce( Range range, size_t grain, T identity, Map &&map, Reduce &&reduce )
+   {
+      if ( range.size() == 0 ) {
+         return identity;
+      }
+
+      grain = std::max( size_t( 1 ), grain );
+
+      const auto chunkCount = ( range.size() + grain - 1 ) / grain;
+      std::vector< T > partials( chunkCount, identity );
+
+      parallel_for(
+         range,
+         grain,
+         [ & ]( Range chunk ) {
+            partials[ ( chunk.begin - range.begin ) / grain ] = map( chunk );
+         }
+      );
+
+      auto ret = identity;
+      for ( const auto &partial : partials ) {
+         ret = reduce( ret, partial );
+      }
+      return ret;
+   }
+
+}
+
+#endif
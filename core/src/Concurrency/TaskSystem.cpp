@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2013, Hernan Saez
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TaskSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace crimild;
+using namespace crimild::concurrency;
+
+namespace crimild::concurrency::impl {
+
+   static thread_local TaskSystem::WorkerIndex t_workerIndex = TaskSystem::INVALID_WORKER_INDEX;
+
+}
+
+TaskSystem::TaskSystem( void )
+   : _numWorkers( std::thread::hardware_concurrency() )
+{
+}
+
+TaskSystem::~TaskSystem( void )
+{
+   if ( getState() != State::STOPPED ) {
+      stop();
+   }
+
+   std::lock_guard< std::mutex > lock( _externalMutex );
+   releaseOverflow( _externalOverflow, true );
+}
+
+void TaskSystem::configure( int numWorkers, size_t arenaSize )
+{
+   _numWorkers = numWorkers;
+   if ( _numWorkers < 0 ) {
+      _numWorkers = std::thread::hardware_concurrency();
+   }
+
+   _arenaSize = std::max( size_t( 1 ), arenaSize );
+}
+
+bool TaskSystem::start( void )
+{
+   if ( getState() != State::STOPPED ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Task system is already running" );
+      return false;
+   }
+
+   _state = State::INITIALIZING;
+
+   Log::info( CRIMILD_CURRENT_CLASS_NAME, "Initializing task system with ", getNumWorkers(), " workers" );
+
+   // The main thread is always worker 0
+   for ( int i = 0; i <= getNumWorkers(); ++i ) {
+      auto worker = std::make_unique< Worker >();
+      worker->arena = std::unique_ptr< Job[] >( new Job[ _arenaSize ] );
+      worker->arenaSize = _arenaSize;
+      worker->arenaFrame = getFrame();
+      worker->nextVictim = UInt32( i + 1 );
+      _workers.push_back( std::move( worker ) );
+   }
+
+   impl::t_workerIndex = 0;
+
+   for ( int i = 1; i <= getNumWorkers(); ++i ) {
+      _threads.push_back( std::thread( &TaskSystem::worker, this, WorkerIndex( i ) ) );
+   }
+
+   _state = State::RUNNING;
+
+   return true;
+}
+
+void TaskSystem::stop( void )
+{
+   if ( getState() == State::STOPPED ) {
+      return;
+   }
+
+   _state = State::STOPPING;
+
+   for ( auto &t : _threads ) {
+      if ( t.joinable() ) {
+         t.join();
+      }
+   }
+   _threads.clear();
+
+   // Execute any pending jobs in the calling thread. New jobs created at
+   // this point will be executed immediately, since we're not running anymore.
+   for ( auto &w : _workers ) {
+      while ( auto job = w->queue.steal() ) {
+         job->execute();
+      }
+   }
+
+   {
+      std::unique_lock< std::mutex > lock( _externalMutex );
+      while ( !_externalJobs.empty() ) {
+         auto job = _externalJobs.front();
+         _externalJobs.pop_front();
+         lock.unlock();
+         job->execute();
+         lock.lock();
+      }
+      _externalJobCount = 0;
+   }
+
+   // Delayed jobs will never be executed
+   for ( auto list : { &_delayedSyncJobs, &_delayedAsyncJobs } ) {
+      auto job = takeDelayed( *list );
+      while ( job != nullptr ) {
+         auto next = job->_next;
+         discard( job );
+         job = next;
+      }
+   }
+
+   for ( auto &w : _workers ) {
+      releaseOverflow( w->overflow, true );
+   }
+   _workers.clear();
+
+   impl::t_workerIndex = INVALID_WORKER_INDEX;
+
+   _state = State::STOPPED;
+}
+
+TaskSystem::WorkerIndex TaskSystem::getWorkerIndex( void )
+{
+   return impl::t_workerIndex;
+}
+
+void TaskSystem::worker( WorkerIndex index )
+{
+   impl::t_workerIndex = index;
+
+   while ( getState() == State::INITIALIZING ) {
+      // wait for startup to complete
+      yield();
+   }
+
+   UInt32 idleCount = 0;
+   while ( getState() == State::RUNNING ) {
+      if ( executeNextJob() ) {
+         idleCount = 0;
+      } else if ( ++idleCount < 64 ) {
+         yield();
+      } else {
+         // Nothing to do for a while. Back off to avoid burning CPU
+         std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+      }
+   }
+
+   impl::t_workerIndex = INVALID_WORKER_INDEX;
+}
+
+Job *TaskSystem::create( void )
+{
+   auto job = allocate();
+   job->reset( nullptr );
+
+   // Empty jobs are never submitted
+   job->_dependencies.store( 0, std::memory_order_relaxed );
+
+   return job;
+}
+
+Job *TaskSystem::allocate( void )
+{
+   const auto index = getWorkerIndex();
+   if ( index == INVALID_WORKER_INDEX || size_t( index ) >= _workers.size() ) {
+      auto job = new Job();
+      std::lock_guard< std::mutex > lock( _externalMutex );
+      _externalOverflow.push_back( job );
+      return job;
+   }
+
+   auto &w = *_workers[ index ];
+
+   const auto frame = getFrame();
+   if ( w.arenaFrame != frame ) {
+      // New frame. Start over, skipping jobs that are still busy
+      w.arenaFrame = frame;
+      w.arenaNext = 0;
+      releaseOverflow( w.overflow, false );
+   }
+
+   while ( w.arenaNext < w.arenaSize ) {
+      auto job = &w.arena[ w.arenaNext++ ];
+      if ( !job->isBusy() ) {
+         return job;
+      }
+   }
+
+   if ( w.overflow.empty() ) {
+      Log::warning( CRIMILD_CURRENT_CLASS_NAME, "Worker ", index, " ran out of jobs for this frame (arena size is ", w.arenaSize, "). Allocating from the heap" );
+   }
+
+   w.overflowCount.fetch_add( 1, std::memory_order_relaxed );
+   auto job = new Job();
+   w.overflow.push_back( job );
+   return job;
+}
+
+void TaskSystem::releaseOverflow( std::vector< Job * > &overflow, bool force )
+{
+   overflow.erase(
+      std::remove_if(
+         overflow.begin(),
+         overflow.end(),
+         [ force ]( Job *job ) {
+            if ( !force && job->isBusy() ) {
+               return false;
+            }
+            delete job;
+            return true;
+         }
+      ),
+      overflow.end()
+   );
+}
+
+void TaskSystem::discard( Job *job )
+{
+   if ( job->_destroy != nullptr ) {
+      job->_destroy( job );
+   }
+   job->_invoke = nullptr;
+   job->_destroy = nullptr;
+   job->_unfinished.store( 0, std::memory_order_relaxed );
+   job->_dependencies.store( 0, std::memory_order_release );
+}
+
+void TaskSystem::submit( Job *job )
+{
+   if ( job == nullptr ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot submit null job" );
+      return;
+   }
+
+   release( job );
+}
+
+void TaskSystem::release( Job *job )
+{
+   if ( job->release() ) {
+      schedule( job );
+   }
+}
+
+void TaskSystem::schedule( Job *job )
+{
+   if ( getNumWorkers() == 0 || !isRunning() ) {
+      // No workers. Execute it right away
+      job->execute();
+      return;
+   }
+
+   const auto index = getWorkerIndex();
+   if ( index == INVALID_WORKER_INDEX ) {
+      std::lock_guard< std::mutex > lock( _externalMutex );
+      _externalJobs.push_back( job );
+      _externalJobCount.fetch_add( 1, std::memory_order_release );
+      return;
+   }
+
+   _workers[ index ]->queue.push( job );
+}
+
+Job *TaskSystem::getJob( void )
+{
+   const auto index = getWorkerIndex();
+   if ( index == INVALID_WORKER_INDEX || size_t( index ) >= _workers.size() ) {
+      return nullptr;
+   }
+
+   auto &w = *_workers[ index ];
+
+   if ( auto job = w.queue.pop() ) {
+      return job;
+   }
+
+   if ( _externalJobCount.load( std::memory_order_acquire ) > 0 ) {
+      std::lock_guard< std::mutex > lock( _externalMutex );
+      if ( !_externalJobs.empty() ) {
+         auto job = _externalJobs.front();
+         _externalJobs.pop_front();
+         _externalJobCount.fetch_sub( 1, std::memory_order_relaxed );
+         return job;
+      }
+   }
+
+   const auto count = UInt32( _workers.size() );
+   for ( UInt32 i = 0; i < count; ++i ) {
+      const auto victim = w.nextVictim++ % count;
+      if ( victim == UInt32( index ) ) {
+         // do not steal from ourselves
+         continue;
+      }
+
+      if ( auto job = _workers[ victim ]->queue.steal() ) {
+         w.stealCount.fetch_add( 1, std::memory_order_relaxed );
+         return job;
+      }
+   }
+
+   return nullptr;
+}
+
+bool TaskSystem::executeNextJob( void )
+{
+   auto job = getJob();
+   if ( job == nullptr ) {
+      return false;
+   }
+
+   job->execute();
+   _workers[ getWorkerIndex() ]->jobCount.fetch_add( 1, std::memory_order_relaxed );
+   return true;
+}
+
+void TaskSystem::wait( Job *job )
+{
+   if ( job == nullptr ) {
+      return;
+   }
+
+   waitUntil( [ job ] { return job->isCompleted(); } );
+}
+
+void TaskSystem::yield( void )
+{
+   std::this_thread::yield();
+}
+
+void TaskSystem::beginFrame( void )
+{
+   // Workers will reset their arenas the next time they create a job
+   _frame.fetch_add( 1, std::memory_order_release );
+
+   {
+      std::lock_guard< std::mutex > lock( _externalMutex );
+      releaseOverflow( _externalOverflow, false );
+   }
+
+   // Submit async jobs first since we don't need to wait for them.
+   // Jobs delayed from now on will be executed in the next frame.
+   auto job = takeDelayed( _delayedAsyncJobs );
+   while ( job != nullptr ) {
+      auto next = job->_next;
+      submit( job );
+      job = next;
+   }
+
+   job = takeDelayed( _delayedSyncJobs );
+   while ( job != nullptr ) {
+      auto next = job->_next;
+      if ( job->release() ) {
+         job->execute();
+      }
+      job = next;
+   }
+}
+
+void TaskSystem::delaySync( Job *job )
+{
+   delay( _delayedSyncJobs, job );
+}
+
+void TaskSystem::delayAsync( Job *job )
+{
+   delay( _delayedAsyncJobs, job );
+}
+
+void TaskSystem::delay( std::atomic< Job * > &list, Job *job )
+{
+   if ( job == nullptr ) {
+      return;
+   }
+
+   auto head = list.load( std::memory_order_relaxed );
+   do {
+      job->_next = head;
+   } while ( !list.compare_exchange_weak( head, job, std::memory_order_release, std::memory_order_relaxed ) );
+}
+
+Job *TaskSystem::takeDelayed( std::atomic< Job * > &list )
+{
+   auto head = list.exchange( nullptr, std::memory_order_acquire );
+
+   // Jobs are pushed in LIFO order. Reverse the list so they're executed
+   // in the same order they were delayed.
+   Job *ret = nullptr;
+   while ( head != nullptr ) {
+      auto next = head->_next;
+      head->_next = ret;
+      ret = head;
+      head = next;
+   }
+   return ret;
+}
+
+void TaskSystem::eachWorkerStat( std::function< void( WorkerIndex, const WorkerStat & ) > const &callback ) const
+{
+   for ( size_t i = 0; i < _workers.size(); ++i ) {
+      const auto &w = *_workers[ i ];
+      callback(
+         WorkerIndex( i ),
+         WorkerStat {
+            .jobCount = w.jobCount.load( std::memory_order_relaxed ),
+            .stealCount = w.stealCount.load( std::memory_order_relaxed ),
+            .overflowCount = w.overflowCount.load( std::memory_order_relaxed ),
+         }
+      );
+   }
+}
+
+void TaskSystem::clearWorkerStats( void )
+{
+   for ( auto &w : _workers ) {
+      w->jobCount = 0;
+      w->stealCount = 0;
+      w->overflowCount = 0;
+   }
+}
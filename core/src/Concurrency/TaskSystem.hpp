@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2013, Hernan Saez
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CONCURRENCY_TASK_SYSTEM_
+#define CRIMILD_CORE_CONCURRENCY_TASK_SYSTEM_
+
+#include "Job.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <crimild/foundation.hpp>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace crimild {
+
+   namespace concurrency {
+
+      /**
+         \brief Schedules jobs on a pool of worker threads
+
+         Each worker (including the main thread, which is always worker 0)
+         owns a slot indexed by a thread-local worker index. A slot holds a
+         lock-free work-stealing queue and a ring arena of preallocated Job
+         objects, so creating and scheduling jobs does not lock nor allocate.
+
+         Arenas are reset at the beginning of every frame (see beginFrame()).
+         Jobs that are still busy at that point (i.e. long-running background
+         jobs) are skipped, so their memory is never reused while they run.
+         If a worker runs out of jobs within a single frame, new jobs are
+         allocated from the heap and a warning is logged.
+
+         Threads that are not workers may still create and submit jobs. Those
+         are allocated from the heap and go through a mutex-protected queue.
+       */
+      class TaskSystem : public DynamicSingleton< TaskSystem > {
+      public:
+         static constexpr size_t DEFAULT_ARENA_SIZE = 4096;
+
+      public:
+         /**
+             \brief Default constructor
+
+             \remarks The constructor does not automatically start workers. You
+             need to call the start() method for doing that.
+          */
+         TaskSystem( void );
+
+         /**
+             \brief Destructor
+
+             \remarks Stops all workers if they are still running.
+          */
+         virtual ~TaskSystem( void );
+
+         /**
+            \param numWorkers Number of background workers. Use a negative value
+            to spawn one worker per hardware thread. With no workers, jobs are
+            executed immediately in the calling thread.
+            \param arenaSize Number of jobs each worker can create per frame
+            before falling back to heap allocations.
+          */
+         void configure( int numWorkers = -1, size_t arenaSize = DEFAULT_ARENA_SIZE );
+
+         /**
+            \brief Start all worker threads
+
+            \remarks This method must be invoked from the main thread.
+          */
+         bool start( void );
+
+         /**
+             \brief Stop all worker threads and wait for them to complete
+
+             \remarks Invoke this method from the main thread
+          */
+         void stop( void );
+
+      public:
+         enum class State {
+            INITIALIZING,
+            RUNNING,
+            STOPPING,
+            STOPPED
+         };
+
+         bool isRunning( void ) const { return _state == State::RUNNING; }
+
+         State getState( void ) const { return _state; }
+
+      private:
+         std::atomic< State > _state = { State::STOPPED };
+
+      public:
+         using WorkerIndex = Int32;
+
+         static constexpr WorkerIndex INVALID_WORKER_INDEX = -1;
+
+         /**
+            \brief Index of the calling thread's worker slot
+
+            Returns 0 for the main thread and INVALID_WORKER_INDEX for threads
+            not managed by the task system.
+          */
+         static WorkerIndex getWorkerIndex( void );
+
+         int getNumWorkers( void ) const { return _numWorkers; }
+
+         bool isMainWorker( void ) const { return getWorkerIndex() == 0; }
+
+         /**
+            \name Job creation and scheduling
+          */
+         //@{
+
+      public:
+         /**
+            \brief Creates an empty job
+
+            Empty jobs have nothing to execute, so they don't need to be submitted.
+            They are useful as parents for grouping several child jobs.
+          */
+         Job *create( void );
+
+         /**
+            \brief Creates a new job (without submitting it)
+
+            If parent is not null, the new job is added as one of its children
+            and the parent will not be completed until this one is.
+          */
+         template< typename Fn >
+         Job *create( Job *parent, Fn &&fn )
+         {
+            auto job = allocate();
+            job->reset( parent, std::forward< Fn >( fn ) );
+            return job;
+         }
+
+         /**
+            \brief Submits a job for execution
+
+            The job is executed as soon as all of its dependencies are resolved.
+          */
+         void submit( Job *job );
+
+         /**
+            \brief Waits for a job to be completed
+
+            The calling thread executes other jobs while waiting.
+          */
+         void wait( Job *job );
+
+         /**
+            \brief Waits until a condition is met
+
+            Like wait(), the calling thread executes other jobs in the meantime.
+            Use this for work spanning several frames, since job handles are
+            recycled once a new frame begins.
+          */
+         template< typename Predicate >
+         void waitUntil( Predicate &&predicate )
+         {
+            while ( !predicate() ) {
+               if ( !executeNextJob() ) {
+                  yield();
+               }
+            }
+         }
+
+         void yield( void );
+
+      private:
+         friend class Job;
+
+         /**
+            \brief Resolves one dependency and schedules the job if it's ready
+          */
+         void release( Job *job );
+
+         void schedule( Job *job );
+
+         Job *allocate( void );
+
+         Job *getJob( void );
+         bool executeNextJob( void );
+
+         //@}
+
+         /**
+            \name Frame synchronization
+          */
+         //@{
+
+      public:
+         /**
+            \brief Starts a new frame
+
+            Executes all jobs delayed with delaySync() in the calling thread
+            (which should be the main thread), submits jobs delayed with
+            delayAsync() and lets workers reuse their arenas.
+          */
+         void beginFrame( void );
+
+         UInt64 getFrame( void ) const { return _frame.load( std::memory_order_relaxed ); }
+
+         void delaySync( Job *job );
+         void delayAsync( Job *job );
+
+      private:
+         void delay( std::atomic< Job * > &list, Job *job );
+         Job *takeDelayed( std::atomic< Job * > &list );
+
+      private:
+         std::atomic< UInt64 > _frame = { 0 };
+         std::atomic< Job * > _delayedSyncJobs = { nullptr };
+         std::atomic< Job * > _delayedAsyncJobs = { nullptr };
+
+         //@}
+
+         /**
+            \name Stats
+          */
+         //@{
+
+      public:
+         struct WorkerStat {
+            size_t jobCount = 0;
+            size_t stealCount = 0;
+            size_t overflowCount = 0;
+         };
+
+         void eachWorkerStat( std::function< void( WorkerIndex, const WorkerStat & ) > const &callback ) const;
+
+         void clearWorkerStats( void );
+
+         //@}
+
+      private:
+         struct Worker {
+            WorkStealingQueue< Job * > queue;
+
+            std::unique_ptr< Job[] > arena;
+            size_t arenaSize = 0;
+            size_t arenaNext = 0;
+            UInt64 arenaFrame = 0;
+
+            /**
+               \brief Jobs allocated from the heap when the arena was exhausted
+             */
+            std::vector< Job * > overflow;
+
+            std::atomic< size_t > jobCount = { 0 };
+            std::atomic< size_t > stealCount = { 0 };
+            std::atomic< size_t > overflowCount = { 0 };
+
+            UInt32 nextVictim = 0;
+         };
+
+         void worker( WorkerIndex index );
+
+         static void releaseOverflow( std::vector< Job * > &overflow, bool force );
+
+         static void discard( Job *job );
+
+      private:
+         int _numWorkers = 0;
+         size_t _arenaSize = DEFAULT_ARENA_SIZE;
+         std::vector< std::unique_ptr< Worker > > _workers;
+         std::vector< std::thread > _threads;
+
+         /**
+            \name External threads
+          */
+         //@{
+
+         std::mutex _externalMutex;
+         std::deque< Job * > _externalJobs;
+         std::atomic< size_t > _externalJobCount = { 0 };
+         std::vector< Job * > _externalOverflow;
+
+         //@}
+      };
+
+   }
+
+}
+
+#endif
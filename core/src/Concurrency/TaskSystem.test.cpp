@@ -0,0 +1,301 @@
+#include "Concurrency/Async.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "Concurrency/TaskSystem.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace crimild;
+using namespace crimild::concurrency;
+
+TEST( TaskSystem, execute_inline_without_workers )
+{
+   TaskSystem tasks;
+   tasks.configure( 0 );
+   tasks.start();
+
+   const auto caller = std::this_thread::get_id();
+   std::thread::id executor;
+
+   auto job = async( [ & ] { executor = std::this_thread::get_id(); } );
+
+   EXPECT_TRUE( job->isCompleted() );
+   EXPECT_EQ( caller, executor );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, wait_for_children )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   std::atomic< int > counter( 0 );
+
+   auto parent = async();
+   for ( int i = 0; i < 400; ++i ) {
+      async( parent, [ &counter ] { counter++; } );
+   }
+   wait( parent );
+
+   EXPECT_TRUE( parent->isCompleted() );
+   EXPECT_EQ( 400, counter.load() );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, nested_children )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   std::atomic< int > counter( 0 );
+
+   auto parent = async();
+   for ( int i = 0; i < 16; ++i ) {
+      async(
+         parent,
+         [ parent, &counter ] {
+            for ( int j = 0; j < 16; ++j ) {
+               async( parent, [ &counter ] { counter++; } );
+            }
+         }
+      );
+   }
+   wait( parent );
+
+   EXPECT_EQ( 256, counter.load() );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, continuation_executes_after_dependencies )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   std::atomic< int > counter( 0 );
+   std::atomic< int > observed( -1 );
+
+   auto continuation = tasks.create( nullptr, [ & ] { observed = counter.load(); } );
+
+   std::vector< Job * > jobs;
+   for ( int i = 0; i < 8; ++i ) {
+      auto job = tasks.create( nullptr, [ &counter ] { counter++; } );
+      job->attachContinuation( continuation );
+      jobs.push_back( job );
+   }
+
+   tasks.submit( continuation );
+   for ( auto job : jobs ) {
+      tasks.submit( job );
+   }
+
+   tasks.wait( continuation );
+
+   EXPECT_EQ( 8, observed.load() );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, continuation_of_completed_job )
+{
+   TaskSystem tasks;
+   tasks.configure( 0 );
+   tasks.start();
+
+   auto job = async( [] {} );
+   EXPECT_TRUE( job->isCompleted() );
+
+   bool executed = false;
+   auto continuation = tasks.create( nullptr, [ & ] { executed = true; } );
+   job->attachContinuation( continuation );
+   tasks.submit( continuation );
+
+   EXPECT_TRUE( executed );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, sync_frame )
+{
+   TaskSystem tasks;
+   tasks.configure( 2 );
+   tasks.start();
+
+   std::vector< int > log;
+   sync_frame( [ & ] { log.push_back( 1 ); } );
+   sync_frame(
+      [ & ] {
+         log.push_back( 2 );
+
+         // Delayed until the next frame
+         sync_frame( [ & ] { log.push_back( 3 ); } );
+      }
+   );
+
+   EXPECT_TRUE( log.empty() );
+
+   tasks.beginFrame();
+   EXPECT_EQ( ( std::vector< int > { 1, 2 } ), log );
+
+   tasks.beginFrame();
+   EXPECT_EQ( ( std::vector< int > { 1, 2, 3 } ), log );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, large_callables )
+{
+   TaskSystem tasks;
+   tasks.configure( 2 );
+   tasks.start();
+
+   std::array< int, 64 > values;
+   std::iota( values.begin(), values.end(), 0 );
+
+   std::atomic< int > sum( 0 );
+   auto job = async(
+      [ values, &sum ] {
+         sum = std::accumulate( values.begin(), values.end(), 0 );
+      }
+   );
+   wait( job );
+
+   EXPECT_EQ( 2016, sum.load() );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, arena_overflow )
+{
+   TaskSystem tasks;
+   tasks.configure( 0, 16 );
+   tasks.start();
+
+   int counter = 0;
+   for ( int i = 0; i < 32; ++i ) {
+      async( [ &counter ] { counter++; } );
+   }
+   EXPECT_EQ( 32, counter );
+
+   size_t overflowCount = 0;
+   tasks.eachWorkerStat(
+      [ & ]( auto, auto const &stat ) {
+         overflowCount += stat.overflowCount;
+      }
+   );
+   EXPECT_EQ( 16, overflowCount );
+
+   // Completed jobs are reused in the next frame
+   tasks.clearWorkerStats();
+   tasks.beginFrame();
+   for ( int i = 0; i < 16; ++i ) {
+      async( [ &counter ] { counter++; } );
+   }
+   overflowCount = 0;
+   tasks.eachWorkerStat(
+      [ & ]( auto, auto const &stat ) {
+         overflowCount += stat.overflowCount;
+      }
+   );
+   EXPECT_EQ( 0, overflowCount );
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, parallel_for )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   std::vector< std::atomic< int > > visited( 10000 );
+   for ( auto &v : visited ) {
+      v = 0;
+   }
+
+   parallel_for(
+      Range { 0, visited.size() },
+      64,
+      [ & ]( Range chunk ) {
+         EXPECT_LE( chunk.size(), 64 );
+         for ( auto i = chunk.begin; i < chunk.end; ++i ) {
+            visited[ i ]++;
+         }
+      }
+   );
+
+   for ( auto &v : visited ) {
+      ASSERT_EQ( 1, v.load() );
+   }
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, parallel_for_tiny_chunks )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   // Chunks finish before the next one is spawned, so the root job might
+   // reach zero unfinished jobs while it's still being split
+   for ( int i = 0; i < 50; ++i ) {
+      tasks.beginFrame();
+
+      std::atomic< size_t > count( 0 );
+      parallel_for(
+         Range { 0, 2000 },
+         1,
+         [ & ]( Range chunk ) {
+            count += chunk.size();
+         }
+      );
+      ASSERT_EQ( 2000, count.load() );
+   }
+
+   tasks.stop();
+}
+
+TEST( TaskSystem, parallel_reduce )
+{
+   TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   std::vector< double > values( 100000 );
+   for ( size_t i = 0; i < values.size(); ++i ) {
+      values[ i ] = 1.0 / double( i + 1 );
+   }
+
+   const auto sum = [ & ] {
+      return parallel_reduce(
+         Range { 0, values.size() },
+         1000,
+         0.0,
+         [ & ]( Range chunk ) {
+            double ret = 0;
+            for ( auto i = chunk.begin; i < chunk.end; ++i ) {
+               ret += values[ i ];
+            }
+            return ret;
+         },
+         []( double a, double b ) { return a + b; }
+      );
+   };
+
+   // Partial results are combined in order, so the result is deterministic
+   const auto expected = sum();
+   for ( int i = 0; i < 10; ++i ) {
+      EXPECT_EQ( expected, sum() );
+   }
+
+   tasks.stop();
+}
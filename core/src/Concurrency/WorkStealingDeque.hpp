@@ -28,97 +28,217 @@
 #ifndef CRIMILD_CORE_CONCURRENCY_WORK_STEALING_QUEUE_
 #define CRIMILD_CORE_CONCURRENCY_WORK_STEALING_QUEUE_
 
+#include <atomic>
 #include <crimild/foundation.hpp>
-#include <list>
-#include <mutex>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace crimild {
 
    /**
-      \brief A double-ended queue implemeting the work stealing pattern
+      \brief A lock-free double-ended queue implementing the work stealing pattern
+
+      This is a Chase-Lev deque, following the weak memory model formulation
+      described by Lê et al. in "Correct and Efficient Work-Stealing for Weak
+      Memory Models" (PPoPP 2013).
+
+      Only the thread owning the queue may call push(), pop() and clear(). Any
+      other thread may call steal() concurrently. Owner operations do not use
+      atomic read-modify-write instructions except when competing with thieves
+      for the very last element. Thieves only use a single CAS on the top index.
+
+      The underlying storage is a circular buffer that grows (doubling its
+      capacity) whenever the owner pushes into a full queue. Retired buffers
+      are kept alive until the queue is destroyed, since a thief may still be
+      reading from them.
+
+      \remarks Elements are stored in atomic slots, so T must be trivially
+      copyable (i.e. raw pointers or small handles). A default-constructed T
+      (i.e. nullptr) is returned when there is nothing to pop or steal.
     */
    template< class T >
-   class WorkStealingQueue : public SharedObject {
-      using Mutex = std::mutex;
-      using Lock = std::lock_guard< Mutex >;
+   class WorkStealingQueue : public NonCopyable {
+      static_assert( std::is_trivially_copyable_v< T >, "WorkStealingQueue elements must be trivially copyable" );
+
+      using Index = std::int64_t;
+
+      static constexpr size_t CACHE_LINE_SIZE = 64;
+
+      /**
+         \brief Circular buffer with a power-of-two capacity
+       */
+      class Buffer {
+      public:
+         explicit Buffer( Index capacity )
+            : _capacity( capacity ),
+              _mask( capacity - 1 ),
+              _slots( new std::atomic< T >[ capacity ] )
+         {
+         }
+
+         Index getCapacity( void ) const { return _capacity; }
+
+         T get( Index i ) const { return _slots[ i & _mask ].load( std::memory_order_relaxed ); }
+
+         void put( Index i, T const &elem ) { _slots[ i & _mask ].store( elem, std::memory_order_relaxed ); }
+
+         Buffer *grow( Index bottom, Index top ) const
+         {
+            auto ret = new Buffer( 2 * _capacity );
+            for ( auto i = top; i != bottom; ++i ) {
+               ret->put( i, get( i ) );
+            }
+            return ret;
+         }
+
+      private:
+         Index _capacity;
+         Index _mask;
+         std::unique_ptr< std::atomic< T >[] > _slots;
+      };
 
    public:
-      WorkStealingQueue( void )
+      /**
+         \param capacity Initial capacity. It will be rounded up to the next power of two.
+       */
+      explicit WorkStealingQueue( size_t capacity = 1024 )
       {
+         Index c = 1;
+         while ( c < Index( capacity ) ) {
+            c <<= 1;
+         }
+         auto buffer = new Buffer( c );
+         _retired.push_back( std::unique_ptr< Buffer >( buffer ) );
+         _buffer.store( buffer, std::memory_order_relaxed );
       }
 
-      ~WorkStealingQueue( void )
+      ~WorkStealingQueue( void ) = default;
+
+      /**
+         \brief Number of elements in the queue
+
+         \remarks The result is only an approximation if other threads are
+         modifying the queue at the same time.
+       */
+      size_t size( void ) const
       {
+         const auto b = _bottom.load( std::memory_order_relaxed );
+         const auto t = _top.load( std::memory_order_relaxed );
+         return b > t ? size_t( b - t ) : 0;
       }
 
-      size_t size( void )
+      bool empty( void ) const
       {
-         Lock lock( _mutex );
-         return _elems.size();
+         return size() == 0;
       }
 
-      bool empty( void )
+      size_t getCapacity( void ) const
       {
-         return size() == 0;
+         return size_t( _buffer.load( std::memory_order_relaxed )->getCapacity() );
       }
 
+      /**
+         \brief Discards all elements in the queue
+
+         \remarks Only the owner thread may call this method.
+       */
       void clear( void )
       {
-         Lock lock( _mutex );
-
-         _elems.clear();
+         while ( !empty() ) {
+            pop();
+         }
       }
 
       /**
          \brief Adds an element to the private end of the queue (LIFO)
 
+         \remarks Only the owner thread may call this method.
        */
       void push( T const &elem )
       {
-         Lock lock( _mutex );
-         _elems.push_back( elem );
+         const auto b = _bottom.load( std::memory_order_relaxed );
+         const auto t = _top.load( std::memory_order_acquire );
+         auto buffer = _buffer.load( std::memory_order_relaxed );
+
+         if ( b - t > buffer->getCapacity() - 1 ) {
+            buffer = buffer->grow( b, t );
+            _retired.push_back( std::unique_ptr< Buffer >( buffer ) );
+            _buffer.store( buffer, std::memory_order_release );
+         }
+
+         buffer->put( b, elem );
+         _bottom.store( b + 1, std::memory_order_release );
       }
 
       /**
          \brief Retrieves an element from the private end of the queue (LIFO)
 
-         \warning You should check if the collection is empty before calling this method.
+         \remarks Only the owner thread may call this method. Returns a
+         default-constructed T if the queue is empty.
        */
       T pop( void )
       {
-         Lock lock( _mutex );
-
-         if ( _elems.size() == 0 ) {
-            return nullptr;
+         const auto b = _bottom.load( std::memory_order_relaxed ) - 1;
+         auto buffer = _buffer.load( std::memory_order_relaxed );
+         _bottom.store( b, std::memory_order_relaxed );
+         std::atomic_thread_fence( std::memory_order_seq_cst );
+         auto t = _top.load( std::memory_order_relaxed );
+
+         if ( t > b ) {
+            // Queue was already empty
+            _bottom.store( b + 1, std::memory_order_relaxed );
+            return T {};
          }
 
-         auto e = _elems.back();
-         _elems.pop_back();
-         return e;
+         auto elem = buffer->get( b );
+         if ( t == b ) {
+            // Last element. Compete with thieves for it
+            if ( !_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+               elem = T {};
+            }
+            _bottom.store( b + 1, std::memory_order_relaxed );
+         }
+         return elem;
       }
 
       /**
          \brief Retrieves an element from the public end of the queue (FIFO)
 
-         \warning You should check if the collection is empty before calling this method
+         \remarks Any thread may call this method. Returns a default-constructed
+         T if the queue is empty or if another thread won the race for the
+         same element.
        */
       T steal( void )
       {
-         Lock lock( _mutex );
+         auto t = _top.load( std::memory_order_acquire );
+         std::atomic_thread_fence( std::memory_order_seq_cst );
+         const auto b = _bottom.load( std::memory_order_acquire );
 
-         if ( _elems.size() == 0 ) {
-            return nullptr;
+         if ( t >= b ) {
+            return T {};
          }
 
-         auto e = _elems.front();
-         _elems.pop_front();
-         return e;
+         auto buffer = _buffer.load( std::memory_order_acquire );
+         auto elem = buffer->get( t );
+         if ( !_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+            return T {};
+         }
+         return elem;
       }
 
    private:
-      std::list< T > _elems;
-      std::mutex _mutex;
+      alignas( CACHE_LINE_SIZE ) std::atomic< Index > _top = { 0 };
+      alignas( CACHE_LINE_SIZE ) std::atomic< Index > _bottom = { 0 };
+      alignas( CACHE_LINE_SIZE ) std::atomic< Buffer * > _buffer = { nullptr };
+
+      /**
+         \brief All buffers ever used by this queue (including the current one)
+
+         \remarks Only accessed by the owner thread
+       */
+      std::vector< std::unique_ptr< Buffer > > _retired;
    };
 
 }
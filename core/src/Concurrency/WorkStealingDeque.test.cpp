@@ -0,0 +1,185 @@
+#include "WorkStealingDeque.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace crimild;
+
+TEST( WorkStealingQueue, construction )
+{
+   WorkStealingQueue< int * > queue;
+
+   EXPECT_TRUE( queue.empty() );
+   EXPECT_EQ( 0, queue.size() );
+   EXPECT_EQ( nullptr, queue.pop() );
+   EXPECT_EQ( nullptr, queue.steal() );
+}
+
+TEST( WorkStealingQueue, capacity_is_power_of_two )
+{
+   WorkStealingQueue< int * > queue( 100 );
+   EXPECT_EQ( 128, queue.getCapacity() );
+}
+
+TEST( WorkStealingQueue, pop_is_lifo )
+{
+   int values[] = { 1, 2, 3 };
+
+   WorkStealingQueue< int * > queue;
+   for ( auto &v : values ) {
+      queue.push( &v );
+   }
+
+   EXPECT_EQ( 3, queue.size() );
+   EXPECT_EQ( &values[ 2 ], queue.pop() );
+   EXPECT_EQ( &values[ 1 ], queue.pop() );
+   EXPECT_EQ( &values[ 0 ], queue.pop() );
+   EXPECT_EQ( nullptr, queue.pop() );
+   EXPECT_TRUE( queue.empty() );
+}
+
+TEST( WorkStealingQueue, steal_is_fifo )
+{
+   int values[] = { 1, 2, 3 };
+
+   WorkStealingQueue< int * > queue;
+   for ( auto &v : values ) {
+      queue.push( &v );
+   }
+
+   EXPECT_EQ( &values[ 0 ], queue.steal() );
+   EXPECT_EQ( &values[ 1 ], queue.steal() );
+   EXPECT_EQ( &values[ 2 ], queue.steal() );
+   EXPECT_EQ( nullptr, queue.steal() );
+   EXPECT_TRUE( queue.empty() );
+}
+
+TEST( WorkStealingQueue, grows_when_full )
+{
+   std::vector< int > values( 100 );
+
+   WorkStealingQueue< int * > queue( 4 );
+   for ( auto &v : values ) {
+      queue.push( &v );
+   }
+
+   EXPECT_EQ( 100, queue.size() );
+   EXPECT_GE( queue.getCapacity(), 100 );
+
+   // Mix both ends to make sure elements survived the resizes in order
+   EXPECT_EQ( &values[ 0 ], queue.steal() );
+   EXPECT_EQ( &values[ 99 ], queue.pop() );
+   for ( size_t i = 98; i > 0; --i ) {
+      EXPECT_EQ( &values[ i ], queue.pop() );
+   }
+   EXPECT_TRUE( queue.empty() );
+}
+
+TEST( WorkStealingQueue, clear )
+{
+   int values[] = { 1, 2, 3 };
+
+   WorkStealingQueue< int * > queue;
+   for ( auto &v : values ) {
+      queue.push( &v );
+   }
+   queue.clear();
+
+   EXPECT_TRUE( queue.empty() );
+   EXPECT_EQ( nullptr, queue.pop() );
+}
+
+TEST( WorkStealingQueue, stress_every_element_is_taken_exactly_once )
+{
+   constexpr size_t ELEMENT_COUNT = 200000;
+   constexpr size_t THIEF_COUNT = 4;
+
+   std::vector< std::atomic< int > > taken( ELEMENT_COUNT );
+   for ( auto &t : taken ) {
+      t = 0;
+   }
+
+   // Start with a small capacity to exercise growth while thieves are active
+   WorkStealingQueue< std::atomic< int > * > queue( 8 );
+   std::atomic< bool > done( false );
+   std::atomic< size_t > total( 0 );
+
+   std::vector< std::thread > thieves;
+   for ( size_t i = 0; i < THIEF_COUNT; ++i ) {
+      thieves.emplace_back(
+         [ & ] {
+            while ( !done || !queue.empty() ) {
+               if ( auto e = queue.steal() ) {
+                  ( *e )++;
+                  total++;
+               }
+            }
+         }
+      );
+   }
+
+   for ( size_t i = 0; i < ELEMENT_COUNT; ++i ) {
+      queue.push( &taken[ i ] );
+      if ( i % 3 == 0 ) {
+         if ( auto e = queue.pop() ) {
+            ( *e )++;
+            total++;
+         }
+      }
+   }
+
+   while ( auto e = queue.pop() ) {
+      ( *e )++;
+      total++;
+   }
+
+   done = true;
+   for ( auto &t : thieves ) {
+      t.join();
+   }
+
+   EXPECT_EQ( ELEMENT_COUNT, total.load() );
+   for ( auto &t : taken ) {
+      ASSERT_EQ( 1, t.load() );
+   }
+}
+
+TEST( WorkStealingQueue, stress_thieves_racing_for_last_element )
+{
+   constexpr size_t ROUNDS = 20000;
+   constexpr size_t THIEF_COUNT = 3;
+
+   WorkStealingQueue< size_t * > queue;
+   std::vector< size_t > values( ROUNDS );
+   std::atomic< size_t > stolen( 0 );
+   std::atomic< bool > done( false );
+
+   std::vector< std::thread > thieves;
+   for ( size_t i = 0; i < THIEF_COUNT; ++i ) {
+      thieves.emplace_back(
+         [ & ] {
+            while ( !done ) {
+               if ( queue.steal() != nullptr ) {
+                  stolen++;
+               }
+            }
+         }
+      );
+   }
+
+   size_t popped = 0;
+   for ( size_t i = 0; i < ROUNDS; ++i ) {
+      // A single element in the queue means owner and thieves compete for it
+      queue.push( &values[ i ] );
+      if ( queue.pop() != nullptr ) {
+         ++popped;
+      }
+   }
+
+   done = true;
+   for ( auto &t : thieves ) {
+      t.join();
+   }
+
+   EXPECT_EQ( ROUNDS, popped + stolen.load() );
+}
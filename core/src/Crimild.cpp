@@ -153,6 +153,9 @@ void crimild::init( void )
 
    CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::Animation );
    CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::Clip );
+   CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::CompressedQuaternionChannel );
+   CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::CompressedReal32Channel );
+   CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::CompressedVector3fChannel );
    CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::Joint );
    CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::QuaternionChannel );
    CRIMILD_REGISTER_OBJECT_BUILDER( crimild::animation::Real32Channel );
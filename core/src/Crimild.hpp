@@ -29,9 +29,13 @@
 #define CRIMILD_
 
 #include "Animation/Animation.hpp"
+#include "Animation/AnimationStage.hpp"
 #include "Animation/ChannelImpl.hpp"
 #include "Animation/Clip.hpp"
+#include "Animation/CompressedChannel.hpp"
+#include "Animation/Pose.hpp"
 #include "Animation/Skeleton.hpp"
+#include "Animation/Skinning.hpp"
 #include "Assemblies/Assembly.hpp"
 #include "Audio/AudioListener.hpp"
 #include "Audio/AudioSource.hpp"
@@ -96,6 +100,7 @@
 #include "Components/AudioListenerComponent.hpp"
 #include "Components/AudioSourceComponent.hpp"
 #include "Components/BillboardComponent.hpp"
+#include "Components/ComponentRegistry.hpp"
 #include "Components/FreeLookCameraComponent.hpp"
 #include "Components/LambdaComponent.hpp"
 #include "Components/MaterialComponent.hpp"
@@ -112,7 +117,8 @@
 #include "Components/UIResponder.hpp"
 #include "Concurrency/Async.hpp"
 #include "Concurrency/Job.hpp"
-#include "Concurrency/JobScheduler.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "Concurrency/TaskSystem.hpp"
 #include "Concurrency/WorkStealingDeque.hpp"
 #include "Debug/DebugRenderComponent.hpp"
 #include "Debug/DebugRenderHelper.hpp"
@@ -134,6 +140,7 @@
 #include "Nodes/3D/Camera3D.hpp"
 #include "Nodes/3D/Geometry3D.hpp"
 #include "Nodes/3D/Spatial3D.hpp"
+#include "Nodes/3D/TransformStorage3D.hpp"
 #include "Nodes/Node.hpp"
 #include "Nodes/Visitors/NodeConstVisitor.hpp"
 #include "Nodes/Visitors/NodeVisitor.hpp"
@@ -152,6 +159,8 @@
 #include "ParticleSystem/Generators/UniformScaleParticleGenerator.hpp"
 #include "ParticleSystem/Generators/VelocityParticleGenerator.hpp"
 #include "ParticleSystem/ParticleData.hpp"
+#include "ParticleSystem/ParticleKernels.hpp"
+#include "ParticleSystem/ParticleLaneArray.hpp"
 #include "ParticleSystem/ParticleSystemComponent.hpp"
 #include "ParticleSystem/Renderers/AnimatedSpriteParticleRenderer.hpp"
 #include "ParticleSystem/Renderers/InstancedParticleRenderer.hpp"
@@ -191,6 +200,7 @@
 #include "Rendering/DescriptorSet.hpp"
 #include "Rendering/Font.hpp"
 #include "Rendering/Image.hpp"
+#include "Rendering/ImageHDR.hpp"
 #include "Rendering/ImageManager.hpp"
 #include "Rendering/ImageTGA.hpp"
 #include "Rendering/IndexBuffer.hpp"
@@ -210,6 +220,7 @@
 #include "Rendering/RenderPass.hpp"
 #include "Rendering/RenderResource.hpp"
 #include "Rendering/RenderState.hpp"
+#include "Rendering/RenderableExtractor.hpp"
 #include "Rendering/Renderer.hpp"
 #include "Rendering/Sampler.hpp"
 #include "Rendering/Shader.hpp"
@@ -237,12 +248,14 @@
 #include "SceneGraph/Light.hpp"
 #include "SceneGraph/Node.hpp"
 #include "SceneGraph/Node_withTransformation.hpp"
+#include "SceneGraph/SceneIndex.hpp"
 #include "SceneGraph/Skybox.hpp"
 #include "SceneGraph/Switch.hpp"
 #include "SceneGraph/Text.hpp"
 #include "Simulation/Console/Console.hpp"
 #include "Simulation/Event.hpp"
 #include "Simulation/FileSystem.hpp"
+#include "Simulation/FramePipeline.hpp"
 #include "Simulation/Input.hpp"
 #include "Simulation/Simulation.hpp"
 #include "Simulation/Systems/AudioSystem.hpp"
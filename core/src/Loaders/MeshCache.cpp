@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Loaders/MeshCache.hpp"
+
+#include "Primitives/Primitive.hpp"
+
+#include <crimild/foundation/filesystem/MappedFile.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace crimild;
+
+namespace crimild {
+
+   namespace meshcache {
+
+      // 'CMSH'
+      static constexpr UInt32 MAGIC = 0x48534d43;
+
+      // Vertex and index blocks are aligned so attributes can be read in place
+      static constexpr Size ALIGNMENT = 16;
+
+      struct FileHeader {
+         UInt32 magic;
+         UInt32 version;
+         UInt32 importerVersion;
+         UInt32 meshCount;
+         Int64 timestamp;
+         UInt64 tableSize;
+         UInt32 libraryCount;
+         UInt32 reserved;
+      };
+
+      struct MeshHeader {
+         UInt32 type;
+         UInt32 vertexBufferCount;
+         UInt32 indexFormat;
+         UInt32 reserved;
+         UInt64 indexOffset;
+         UInt64 indexSize;
+         Real32 min[ 3 ];
+         Real32 max[ 3 ];
+      };
+
+      struct VertexBufferHeader {
+         UInt32 attributeCount;
+         UInt32 stride;
+         UInt64 offset;
+         UInt64 size;
+      };
+
+      struct AttributeHeader {
+         UInt32 name;
+         UInt32 format;
+      };
+
+      inline Size align( Size value ) noexcept
+      {
+         return ( value + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 );
+      }
+
+      /**
+         \brief Appends records to the table of contents
+       */
+      class TableWriter {
+      public:
+         template< typename T >
+         void write( const T &value ) noexcept
+         {
+            const auto bytes = reinterpret_cast< const Byte * >( &value );
+            m_bytes.insert( m_bytes.end(), bytes, bytes + sizeof( T ) );
+         }
+
+         void write( const std::string &str ) noexcept
+         {
+            write( UInt32( str.size() ) );
+            m_bytes.insert( m_bytes.end(), str.begin(), str.end() );
+         }
+
+         inline const std::vector< Byte > &getBytes( void ) const noexcept { return m_bytes; }
+
+      private:
+         std::vector< Byte > m_bytes;
+      };
+
+      /**
+         \brief Reads records from the table of contents, checking bounds
+       */
+      class TableReader {
+      public:
+         TableReader( const Byte *data, Size size ) noexcept
+            : m_data( data ),
+              m_size( size )
+         {
+         }
+
+         template< typename T >
+         Bool read( T &value ) noexcept
+         {
+            if ( m_size - m_offset < sizeof( T ) ) {
+               return false;
+            }
+            memcpy( &value, m_data + m_offset, sizeof( T ) );
+            m_offset += sizeof( T );
+            return true;
+         }
+
+         Bool read( std::string &str ) noexcept
+         {
+            UInt32 length = 0;
+            if ( !read( length ) || m_size - m_offset < length ) {
+               return false;
+            }
+            str.assign( reinterpret_cast< const char * >( m_data + m_offset ), length );
+            m_offset += length;
+            return true;
+         }
+
+      private:
+         const Byte *m_data = nullptr;
+         Size m_size = 0;
+         Size m_offset = 0;
+      };
+
+      /**
+         \brief A block of vertex or index data
+       */
+      struct Block {
+         const Byte *data;
+         Size size;
+      };
+
+   }
+
+}
+
+MeshCache::Key MeshCache::Key::fromFile( const std::string &path, UInt32 importerVersion ) noexcept
+{
+   Key key;
+   key.source = path;
+   key.importerVersion = importerVersion;
+
+   std::error_code ec;
+   const auto time = std::filesystem::last_write_time( path, ec );
+   if ( !ec ) {
+      key.timestamp = Int64( time.time_since_epoch().count() );
+   }
+
+   return key;
+}
+
+MeshCache::MeshCache( std::string directory ) noexcept
+   : m_directory( std::move( directory ) )
+{
+}
+
+std::string MeshCache::getPath( const Key &key ) const noexcept
+{
+   std::stringstream ss;
+   ss << std::filesystem::path( key.source ).filename().string()
+      << "."
+      << std::hex << std::hash< std::string >()( key.source )
+      << ".mesh";
+   return ( std::filesystem::path( m_directory ) / ss.str() ).string();
+}
+
+Bool MeshCache::load( const Key &key, Contents &contents ) const noexcept
+{
+   using namespace meshcache;
+
+   // Buffers point straight into the mapping and might be modified later on
+   auto file = crimild::alloc< MappedFile >( getPath( key ), MappedFile::Access::COPY_ON_WRITE );
+   if ( !file->isOpen() || file->getSize() < sizeof( FileHeader ) ) {
+      return false;
+   }
+
+   const auto base = file->getWritableData();
+   const auto fileSize = file->getSize();
+
+   FileHeader header;
+   memcpy( &header, base, sizeof( FileHeader ) );
+   if ( header.magic != MAGIC
+        || header.version != VERSION
+        || header.importerVersion != key.importerVersion
+        || header.timestamp != key.timestamp
+        || header.tableSize > fileSize - sizeof( FileHeader ) ) {
+      return false;
+   }
+
+   const auto dataOffset = align( sizeof( FileHeader ) + header.tableSize );
+   if ( dataOffset > fileSize ) {
+      return false;
+   }
+   const auto data = base + dataOffset;
+   const auto dataSize = fileSize - dataOffset;
+
+   // Returns the block at [offset, offset + size) in the data section, if valid
+   const auto getBlock = [ & ]( UInt64 offset, UInt64 size, Byte *&ret ) {
+      if ( offset > dataSize || size > dataSize - offset ) {
+         return false;
+      }
+      ret = data + offset;
+      return true;
+   };
+
+   TableReader reader( base + sizeof( FileHeader ), header.tableSize );
+
+   std::string source;
+   if ( !reader.read( source ) || source != key.source ) {
+      // Hash collision
+      return false;
+   }
+
+   Contents ret;
+
+   ret.materialLibraries.resize( header.libraryCount );
+   for ( auto &library : ret.materialLibraries ) {
+      if ( !reader.read( library ) ) {
+         return false;
+      }
+   }
+
+   ret.meshes.resize( header.meshCount );
+   for ( auto &mesh : ret.meshes ) {
+      MeshHeader meshHeader;
+      if ( !reader.read( meshHeader ) || !reader.read( mesh.object ) || !reader.read( mesh.material ) ) {
+         return false;
+      }
+
+      mesh.min = Point3f { meshHeader.min[ 0 ], meshHeader.min[ 1 ], meshHeader.min[ 2 ] };
+      mesh.max = Point3f { meshHeader.max[ 0 ], meshHeader.max[ 1 ], meshHeader.max[ 2 ] };
+
+      auto primitive = crimild::alloc< Primitive >( Primitive::Type( meshHeader.type ) );
+
+      Array< SharedPointer< VertexBuffer > > vertexData( meshHeader.vertexBufferCount );
+      for ( Size i = 0; i < vertexData.size(); ++i ) {
+         VertexBufferHeader vbHeader;
+         if ( !reader.read( vbHeader ) ) {
+            return false;
+         }
+
+         Array< std::shared_ptr< VertexAttribute > > attributes( vbHeader.attributeCount );
+         for ( Size j = 0; j < attributes.size(); ++j ) {
+            AttributeHeader attribHeader;
+            if ( !reader.read( attribHeader ) ) {
+               return false;
+            }
+            attributes[ j ] = crimild::alloc< VertexAttribute >( VertexAttribute::Name( attribHeader.name ), Format( attribHeader.format ) );
+         }
+         const auto layout = VertexLayout( attributes );
+
+         Byte *vertices = nullptr;
+         if ( layout.getSize() != vbHeader.stride || !getBlock( vbHeader.offset, vbHeader.size, vertices ) ) {
+            return false;
+         }
+
+         vertexData[ i ] = crimild::alloc< VertexBuffer >(
+            layout,
+            crimild::alloc< BufferView >(
+               BufferView::Target::VERTEX,
+               crimild::alloc< Buffer >( vertices, vbHeader.size, file ),
+               0,
+               layout.getSize()
+            )
+         );
+      }
+      primitive->setVertexData( vertexData );
+
+      if ( meshHeader.indexSize > 0 ) {
+         Byte *indices = nullptr;
+         if ( !getBlock( meshHeader.indexOffset, meshHeader.indexSize, indices ) ) {
+            return false;
+         }
+
+         const auto format = Format( meshHeader.indexFormat );
+         primitive->setIndices(
+            crimild::alloc< IndexBuffer >(
+               format,
+               crimild::alloc< BufferView >(
+                  BufferView::Target::INDEX,
+                  crimild::alloc< Buffer >( indices, meshHeader.indexSize, file ),
+                  0,
+                  utils::getFormatSize( format )
+               )
+            )
+         );
+      }
+
+      mesh.primitive = primitive;
+   }
+
+   contents = std::move( ret );
+
+   return true;
+}
+
+Bool MeshCache::store( const Key &key, const Contents &contents ) const noexcept
+{
+   using namespace meshcache;
+
+   std::vector< Block > blocks;
+   Size dataSize = 0;
+
+   const auto addBlock = [ & ]( const Byte *data, Size size ) {
+      const auto offset = dataSize;
+      blocks.push_back( Block { data, size } );
+      dataSize = align( dataSize + size );
+      return UInt64( offset );
+   };
+
+   TableWriter table;
+
+   table.write( key.source );
+
+   for ( const auto &library : contents.materialLibraries ) {
+      table.write( library );
+   }
+
+   for ( const auto &mesh : contents.meshes ) {
+      const auto primitive = crimild::get_ptr( mesh.primitive );
+      if ( primitive == nullptr ) {
+         return false;
+      }
+
+      const auto &vertexData = primitive->getVertexData();
+      const auto indices = primitive->getIndices();
+
+      MeshHeader meshHeader;
+      memset( &meshHeader, 0, sizeof( MeshHeader ) );
+      meshHeader.type = UInt32( primitive->getType() );
+      meshHeader.vertexBufferCount = UInt32( vertexData.size() );
+      if ( indices != nullptr ) {
+         const auto view = indices->getBufferView();
+         meshHeader.indexFormat = UInt32( indices->getFormat() );
+         meshHeader.indexSize = view->getLength();
+         meshHeader.indexOffset = addBlock( view->getData(), view->getLength() );
+      }
+      for ( int i = 0; i < 3; ++i ) {
+         meshHeader.min[ i ] = Real32( mesh.min[ i ] );
+         meshHeader.max[ i ] = Real32( mesh.max[ i ] );
+      }
+
+      table.write( meshHeader );
+      table.write( mesh.object );
+      table.write( mesh.material );
+
+      for ( Size i = 0; i < vertexData.size(); ++i ) {
+         const auto &vbo = vertexData[ i ];
+         const auto &layout = vbo->getVertexLayout();
+         const auto view = vbo->getBufferView();
+
+         VertexBufferHeader vbHeader;
+         memset( &vbHeader, 0, sizeof( VertexBufferHeader ) );
+         vbHeader.stride = layout.getSize();
+         vbHeader.size = view->getLength();
+         vbHeader.offset = addBlock( view->getData(), view->getLength() );
+
+         std::vector< AttributeHeader > attributes;
+         layout.eachAttribute(
+            [ & ]( const auto &attrib ) {
+               attributes.push_back( AttributeHeader { UInt32( attrib->getName() ), UInt32( attrib->getFormat() ) } );
+            }
+         );
+         vbHeader.attributeCount = UInt32( attributes.size() );
+
+         table.write( vbHeader );
+         for ( const auto &attrib : attributes ) {
+            table.write( attrib );
+         }
+      }
+   }
+
+   FileHeader header;
+   memset( &header, 0, sizeof( FileHeader ) );
+   header.magic = MAGIC;
+   header.version = VERSION;
+   header.importerVersion = key.importerVersion;
+   header.meshCount = UInt32( contents.meshes.size() );
+   header.timestamp = key.timestamp;
+   header.tableSize = table.getBytes().size();
+   header.libraryCount = UInt32( contents.materialLibraries.size() );
+
+   std::error_code ec;
+   std::filesystem::create_directories( m_directory, ec );
+
+   // Write to a temporary file first, so readers never see a partial cache
+   const auto path = getPath( key );
+   const auto tmpPath = path + ".tmp";
+   {
+      std::ofstream out( tmpPath, std::ios::binary | std::ios::trunc );
+      if ( !out.is_open() ) {
+         return false;
+      }
+
+      const Byte padding[ ALIGNMENT ] = { 0 };
+      const auto pad = [ & ]( Size size ) {
+         out.write( reinterpret_cast< const char * >( padding ), std::streamsize( align( size ) - size ) );
+      };
+
+      out.write( reinterpret_cast< const char * >( &header ), sizeof( FileHeader ) );
+      out.write( reinterpret_cast< const char * >( table.getBytes().data() ), std::streamsize( table.getBytes().size() ) );
+      pad( sizeof( FileHeader ) + table.getBytes().size() );
+
+      for ( const auto &block : blocks ) {
+         out.write( reinterpret_cast< const char * >( block.data ), std::streamsize( block.size ) );
+         pad( block.size );
+      }
+
+      if ( !out.good() ) {
+         out.close();
+         std::filesystem::remove( tmpPath, ec );
+         return false;
+      }
+   }
+
+   std::filesystem::rename( tmpPath, path, ec );
+   if ( ec ) {
+      std::filesystem::remove( tmpPath, ec );
+      return false;
+   }
+
+   return true;
+}
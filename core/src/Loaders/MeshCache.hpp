@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_LOADERS_MESH_CACHE_
+#define CRIMILD_LOADERS_MESH_CACHE_
+
+#include <crimild/foundation/common/Types.hpp>
+#include <crimild/foundation/memory/Memory.hpp>
+#include <crimild/math/Point3.hpp>
+#include <string>
+#include <vector>
+
+namespace crimild {
+
+   class Primitive;
+
+   /**
+      \brief Binary cache for imported meshes
+
+      Importers store the primitives they generate from a source asset so later
+      loads can skip parsing it altogether. A cache file holds a header identifying
+      the source asset, one record per mesh and the vertex and index data, already
+      laid out the way render devices expect it.
+
+      Loading memory-maps the cache file and creates primitives whose buffers point
+      straight into the mapping. Nothing is parsed or copied, and the mapping is
+      kept alive for as long as any of those buffers exists.
+
+      Cache files are keyed by the path of the source asset, its modification time
+      and the version of the importer that generated them. Any mismatch, including
+      a different file format version, is treated as a miss.
+
+      \remarks Data is stored in native byte order, so cache files are not meant to
+      be shared between platforms.
+      \remarks Cache files are mapped copy-on-write. Buffers loaded from a cache
+      can be modified, but changes are private to the process and never reach
+      the file. Only the pages written to are copied.
+    */
+   class MeshCache {
+   public:
+      /**
+         \brief Version of the file format
+
+         Increment it whenever the layout of cache files changes
+       */
+      static constexpr UInt32 VERSION = 1;
+
+      /**
+         \brief Identifies the source asset a cache file was generated from
+       */
+      struct Key {
+         std::string source;
+         Int64 timestamp = 0;
+         UInt32 importerVersion = 0;
+
+         /**
+            \brief Creates a key using the file's last modification time
+          */
+         static Key fromFile( const std::string &path, UInt32 importerVersion ) noexcept;
+      };
+
+      struct Mesh {
+         /**
+            \brief Name of the object this mesh belongs to
+          */
+         std::string object;
+
+         /**
+            \brief Material reference, resolved by the importer
+          */
+         std::string material;
+
+         SharedPointer< Primitive > primitive;
+
+         /**
+            \brief Model bounds of the primitive
+          */
+         //@{
+         Point3f min;
+         Point3f max;
+         //@}
+      };
+
+      struct Contents {
+         /**
+            \brief Files referenced by materials (i.e. OBJ's material libraries)
+          */
+         std::vector< std::string > materialLibraries;
+
+         std::vector< Mesh > meshes;
+      };
+
+   public:
+      explicit MeshCache( std::string directory ) noexcept;
+      ~MeshCache( void ) = default;
+
+      inline const std::string &getDirectory( void ) const noexcept { return m_directory; }
+
+      /**
+         \brief Path of the cache file for the given key
+
+         The name depends only on the source path, so stale files are replaced
+         when a newer version of the asset is stored.
+       */
+      std::string getPath( const Key &key ) const noexcept;
+
+      /**
+         \brief Loads cached meshes
+
+         \returns false if there is no valid cache file for the given key
+       */
+      Bool load( const Key &key, Contents &contents ) const noexcept;
+
+      /**
+         \brief Stores meshes in a new cache file for the given key
+
+         Only vertex and index data are stored. Primitives are expected to use
+         packed vertex layouts and views enclosing their full buffers.
+
+         \returns false if the file cannot be written
+       */
+      Bool store( const Key &key, const Contents &contents ) const noexcept;
+
+   private:
+      std::string m_directory;
+   };
+
+}
+
+#endif
@@ -28,12 +28,14 @@
 #include "OBJLoader.hpp"
 
 #include "Components/MaterialComponent.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "Loaders/MeshCache.hpp"
+#include "Loaders/OBJParser.hpp"
 #include "Primitives/Primitive.hpp"
 #include "Rendering/ImageManager.hpp"
 #include "Rendering/ImageView.hpp"
 #include "Rendering/Materials/PrincipledBSDFMaterial.hpp"
 #include "Rendering/Sampler.hpp"
-#include "Rendering/Vertex.hpp"
 #include "Simulation/FileSystem.hpp"
 
 namespace crimild {
@@ -173,15 +175,57 @@ void OBJLoader::reset( void )
    _positions.clear();
    _normals.clear();
    _textureCoords.clear();
+
+   _materialLibraries.clear();
+}
+
+namespace crimild {
+
+   namespace obj {
+
+      /**
+         \brief Version of the geometry generated by OBJLoader
+
+         Increment it whenever the generated geometry changes, so existing
+         cache files are discarded.
+       */
+      static constexpr UInt32 CACHE_VERSION = 1;
+
+      /**
+         \brief Modes generate different geometry, so they are cached separately
+       */
+      inline MeshCache::Key getCacheKey( const std::string &fileName, OBJLoader::Mode mode ) noexcept
+      {
+         return MeshCache::Key::fromFile( fileName, ( CACHE_VERSION << 8 ) | UInt32( mode ) );
+      }
+
+   }
+
 }
 
 SharedPointer< Group > OBJLoader::load( void )
 {
    reset();
 
-   getOBJProcessor().readFile( getFileName() );
+   if ( !_cacheDirectory.empty() ) {
+      if ( auto scene = loadCached() ) {
+         return scene;
+      }
+   }
+
+   SharedPointer< Group > scene;
+   if ( _mode == Mode::MAPPED ) {
+      scene = loadMapped();
+   } else {
+      getOBJProcessor().readFile( getFileName() );
+      scene = generateScene();
+   }
 
-   return generateScene();
+   if ( !_cacheDirectory.empty() ) {
+      storeCached( crimild::get_ptr( scene ) );
+   }
+
+   return scene;
 }
 
 void OBJLoader::generateGeometry( void )
@@ -229,29 +273,149 @@ void OBJLoader::generateGeometry( void )
    }
    printProgress( progress + " COMPLETED", true );
 
-   _currentObject->attachNode(
+   _currentObject->attachNode( createGeometry( vertices, indices, _currentMaterial ) );
+
+   _faces.clear();
+}
+
+SharedPointer< Geometry > OBJLoader::createGeometry( Array< VertexP3N3TC2 > const &vertices, Array< UInt32 > const &indices, materials::PrincipledBSDF *material ) noexcept
+{
+   auto geometry = crimild::alloc< Geometry >( "geometry" );
+   geometry->attachPrimitive(
       [ & ] {
-         auto geometry = crimild::alloc< Geometry >( "geometry" );
-         geometry->attachPrimitive(
-            [ & ] {
-               auto primitive = crimild::alloc< Primitive >( Primitive::Type::TRIANGLES );
-               primitive->setVertexData(
-                  { crimild::alloc< VertexBuffer >( VertexP3N3TC2::getLayout(), vertices ) }
-               );
-               primitive->setIndices(
-                  crimild::alloc< IndexBuffer >( Format::INDEX_32_UINT, indices )
-               );
-               return primitive;
-            }()
+         auto primitive = crimild::alloc< Primitive >( Primitive::Type::TRIANGLES );
+         primitive->setVertexData(
+            { crimild::alloc< VertexBuffer >( VertexP3N3TC2::getLayout(), vertices ) }
          );
-         if ( _currentMaterial != nullptr ) {
-            geometry->attachComponent< MaterialComponent >()->attachMaterial( _currentMaterial );
-         }
-         return geometry;
+         primitive->setIndices(
+            crimild::alloc< IndexBuffer >( Format::INDEX_32_UINT, indices )
+         );
+         return primitive;
       }()
    );
+   if ( material != nullptr ) {
+      geometry->attachComponent< MaterialComponent >()->attachMaterial( material );
+   }
+   return geometry;
+}
 
-   _faces.clear();
+SharedPointer< Group > OBJLoader::loadMapped( void )
+{
+   OBJParser parser;
+   parser.parseFile( getFileName() );
+
+   for ( const auto &library : parser.getMaterialLibraries() ) {
+      readMaterialLibrary( library );
+   }
+
+   const auto &positions = parser.getPositions();
+   const auto &texCoords = parser.getTexCoords();
+   const auto &normals = parser.getNormals();
+
+   auto scene = crimild::alloc< Group >( getFileName() );
+
+   for ( const auto &obj : parser.getObjects() ) {
+      auto group = crimild::alloc< Group >( obj.name );
+      for ( const auto &mesh : obj.meshes ) {
+         printProgress( StringUtils::toString( "Generating geometry ", obj.name, "... ", mesh.indices.size() / 3, " triangles" ) );
+
+         // Invalid or missing indices fall back to zero, like missing pools do
+         Array< VertexP3N3TC2 > vertices( mesh.vertices.size() );
+         concurrency::parallel_for(
+            concurrency::Range { 0, mesh.vertices.size() },
+            4096,
+            [ & ]( concurrency::Range range ) {
+               for ( auto i = range.begin; i < range.end; ++i ) {
+                  const auto &corner = mesh.vertices[ i ];
+                  vertices[ i ] = VertexP3N3TC2 {
+                     .position = corner.position >= 0 && Size( corner.position ) < positions.size() ? positions[ corner.position ] : Vector3f::Constants::ZERO,
+                     .normal = corner.normal >= 0 && Size( corner.normal ) < normals.size() ? normals[ corner.normal ] : Vector3f::Constants::ZERO,
+                     .texCoord = corner.texCoord >= 0 && Size( corner.texCoord ) < texCoords.size() ? texCoords[ corner.texCoord ] : Vector2f::Constants::ZERO,
+                  };
+               }
+            }
+         );
+
+         Array< UInt32 > indices( mesh.indices.size(), const_cast< UInt32 * >( mesh.indices.data() ) );
+
+         auto material = !mesh.material.empty() ? crimild::get_ptr( _materials[ mesh.material ] ) : nullptr;
+         group->attachNode( createGeometry( vertices, indices, material ) );
+      }
+      scene->attachNode( group );
+   }
+
+   printProgress( StringUtils::toString( "Loaded ", parser.getTriangleCount(), " triangles" ), true );
+
+   return scene;
+}
+
+SharedPointer< Group > OBJLoader::loadCached( void )
+{
+   MeshCache::Contents contents;
+   if ( !MeshCache( _cacheDirectory ).load( obj::getCacheKey( getFileName(), _mode ), contents ) ) {
+      return nullptr;
+   }
+
+   for ( const auto &library : contents.materialLibraries ) {
+      readMaterialLibrary( library );
+   }
+
+   auto scene = crimild::alloc< Group >( getFileName() );
+
+   // Consecutive meshes with the same object name belong to the same group
+   SharedPointer< Group > group;
+   for ( const auto &mesh : contents.meshes ) {
+      if ( group == nullptr || group->getName() != mesh.object ) {
+         group = crimild::alloc< Group >( mesh.object );
+         scene->attachNode( group );
+      }
+
+      auto geometry = crimild::alloc< Geometry >( "geometry" );
+      geometry->attachPrimitive( mesh.primitive, mesh.min, mesh.max );
+      if ( !mesh.material.empty() ) {
+         if ( auto material = crimild::get_ptr( _materials[ mesh.material ] ) ) {
+            geometry->attachComponent< MaterialComponent >()->attachMaterial( material );
+         }
+      }
+      group->attachNode( geometry );
+   }
+
+   printProgress( StringUtils::toString( "Loaded ", contents.meshes.size(), " meshes from cache" ), true );
+
+   return scene;
+}
+
+void OBJLoader::storeCached( Group *scene ) noexcept
+{
+   MeshCache::Contents contents;
+   contents.materialLibraries = _materialLibraries;
+
+   for ( UInt32 i = 0; i < scene->getNodeCount(); ++i ) {
+      auto group = scene->getNodeAt< Group >( i );
+      for ( UInt32 j = 0; j < group->getNodeCount(); ++j ) {
+         auto geometry = group->getNodeAt< Geometry >( j );
+         auto primitive = geometry->anyPrimitive();
+         if ( primitive == nullptr ) {
+            continue;
+         }
+
+         MeshCache::Mesh mesh;
+         mesh.object = group->getName();
+         mesh.primitive = crimild::retain( primitive );
+         mesh.min = geometry->getLocalBound()->getMin();
+         mesh.max = geometry->getLocalBound()->getMax();
+         if ( auto materials = geometry->getComponent< MaterialComponent >() ) {
+            if ( materials->hasMaterials() ) {
+               mesh.material = materials->first()->getName();
+            }
+         }
+         contents.meshes.push_back( mesh );
+      }
+   }
+
+   if ( !MeshCache( _cacheDirectory ).store( obj::getCacheKey( getFileName(), _mode ), contents ) ) {
+      CRIMILD_LOG_WARNING( "Cannot write mesh cache for ", getFileName() );
+   }
 }
 
 SharedPointer< Group > OBJLoader::generateScene( void )
@@ -321,11 +485,17 @@ void OBJLoader::readObjectMaterial( std::stringstream &line )
 
 void OBJLoader::readMaterialFile( std::stringstream &line )
 {
-   std::string mtlFileName = StringUtils::readFullString( line );
+   readMaterialLibrary( StringUtils::readFullString( line ) );
+   _currentMaterial = nullptr;
+}
+
+void OBJLoader::readMaterialLibrary( std::string mtlFileName )
+{
+   _materialLibraries.push_back( mtlFileName );
+
    std::string mtlFilePath = FileSystem::getInstance().extractDirectory( _fileName ) + "/" + mtlFileName;
 
    getMTLProcessor().readFile( mtlFilePath );
-   _currentMaterial = nullptr;
 }
 
 void OBJLoader::readMaterialName( std::stringstream &line )
@@ -32,6 +32,7 @@
 #include "Rendering/Texture.hpp"
 #include "SceneGraph/Geometry.hpp"
 #include "SceneGraph/Group.hpp"
+#include "Rendering/Vertex.hpp"
 
 #include <fstream>
 #include <map>
@@ -65,12 +66,49 @@ namespace crimild {
             std::map< std::string, LineProcessor > _lineProcessors;
         };
 
+    public:
+        /**
+           \brief How OBJ files are read
+         */
+        enum class Mode {
+            /**
+               \brief Reads the file line by line
+             */
+            STREAM,
+
+            /**
+               \brief Memory-maps the file and parses it in parallel
+
+               Much faster for large files. Faces are split into one geometry per
+               material, and polygons with more than three corners are triangulated.
+
+               \see OBJParser
+             */
+            MAPPED,
+        };
+
     public:
         explicit OBJLoader( std::string fileName );
         ~OBJLoader( void ) = default;
 
         SharedPointer< Group > load( void );
 
+        inline void setMode( Mode mode ) noexcept { _mode = mode; }
+        inline Mode getMode( void ) const noexcept { return _mode; }
+
+        /**
+           \brief Directory for caching loaded meshes
+
+           When set, meshes are stored in a MeshCache after loading the file, and
+           later loads create them straight from the cache for as long as the file
+           is unchanged. Materials are not cached and are always read from their
+           libraries. Empty by default, which disables caching.
+
+           \see MeshCache
+         */
+        inline void setCacheDirectory( std::string directory ) noexcept { _cacheDirectory = directory; }
+        inline const std::string &getCacheDirectory( void ) const noexcept { return _cacheDirectory; }
+
         inline void setVerbose( Bool verbose ) noexcept { _verbose = verbose; }
         Bool isVerbose( void ) const noexcept { return _verbose; }
 
@@ -84,6 +122,9 @@ namespace crimild {
 
         void reset( void );
         SharedPointer< Group > generateScene( void );
+        SharedPointer< Group > loadMapped( void );
+        SharedPointer< Group > loadCached( void );
+        void storeCached( Group *scene ) noexcept;
 
         void generateGeometry( void );
 
@@ -95,6 +136,7 @@ namespace crimild {
         void readObjectMaterial( std::stringstream &line );
 
         void readMaterialFile( std::stringstream &line );
+        void readMaterialLibrary( std::string mtlFileName );
         void readMaterialName( std::stringstream &line );
         void readMaterialAmbient( std::stringstream &line );
         void readMaterialDiffuse( std::stringstream &line );
@@ -108,11 +150,15 @@ namespace crimild {
 
         SharedPointer< Texture > loadTexture( std::string fileName );
 
+        SharedPointer< Geometry > createGeometry( Array< VertexP3N3TC2 > const &vertices, Array< UInt32 > const &indices, materials::PrincipledBSDF *material ) noexcept;
+
         void printProgress( std::string text, Bool endLine = false ) noexcept;
 
     private:
         std::string _fileName;
+        Mode _mode = Mode::STREAM;
         Bool _verbose = false;
+        std::string _cacheDirectory;
 
         FileProcessor _objProcessor;
         FileProcessor _mtlProcessor;
@@ -121,6 +167,7 @@ namespace crimild {
         Group *_currentObject = nullptr;
 
         std::map< std::string, SharedPointer< materials::PrincipledBSDF > > _materials;
+        std::vector< std::string > _materialLibraries;
         materials::PrincipledBSDF *_currentMaterial = nullptr;
 
         std::vector< Vector3f > _positions;
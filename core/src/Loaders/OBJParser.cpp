@@ -0,0 +1,664 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Loaders/OBJParser.hpp"
+
+#include "Concurrency/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <crimild/foundation/filesystem/MappedFile.hpp>
+#include <crimild/foundation/log/Log.hpp>
+#include <cstring>
+
+using namespace crimild;
+
+namespace {
+
+   enum class CommandType {
+      OBJECT,
+      MATERIAL,
+      LIBRARY,
+   };
+
+   /**
+      \brief Statements splitting faces into objects and meshes
+
+      Commands store the number of corners read before them in the same chunk,
+      so chunks can be stitched together in order after parsing.
+    */
+   struct Command {
+      CommandType type;
+      Size corner;
+      std::string name;
+   };
+
+   /**
+      \brief A range of lines parsed by a single job
+    */
+   struct Chunk {
+      const char *begin = nullptr;
+      const char *end = nullptr;
+
+      std::vector< Vector3f > positions;
+      std::vector< Vector2f > texCoords;
+      std::vector< Vector3f > normals;
+
+      /**
+         \brief Three corners per triangle
+       */
+      std::vector< OBJParser::Corner > corners;
+
+      /**
+         \brief Indices relative to the end of a pool, stored as (corner * 3 + component)
+
+         They are parsed relative to the chunk and fixed once pools are merged.
+       */
+      std::vector< Size > relative;
+
+      std::vector< Command > commands;
+
+      Size positionBase = 0;
+      Size texCoordBase = 0;
+      Size normalBase = 0;
+   };
+
+   /**
+      \brief Corners of a mesh, which may span several chunks
+    */
+   struct Slice {
+      const Chunk *chunk;
+      Size begin;
+      Size end;
+   };
+
+   struct PendingMesh {
+      Size object;
+      std::string material;
+      std::vector< Slice > slices;
+      Size cornerCount = 0;
+   };
+
+   constexpr Size NONE = ~Size( 0 );
+
+   inline bool isSpace( char c ) noexcept
+   {
+      return c == ' ' || c == '\t' || c == '\r';
+   }
+
+   inline bool isDigit( char c ) noexcept
+   {
+      return c >= '0' && c <= '9';
+   }
+
+   inline const char *skipSpaces( const char *it, const char *end ) noexcept
+   {
+      while ( it < end && isSpace( *it ) ) {
+         ++it;
+      }
+      return it;
+   }
+
+   /**
+      \brief Returns a pointer to the end of line character, or end
+    */
+   inline const char *findLineEnd( const char *it, const char *end ) noexcept
+   {
+      const auto eol = static_cast< const char * >( memchr( it, '\n', end - it ) );
+      return eol != nullptr ? eol : end;
+   }
+
+   inline bool isKeyword( const char *it, const char *eol, const char *keyword, Size length ) noexcept
+   {
+      return Size( eol - it ) >= length
+             && memcmp( it, keyword, length ) == 0
+             && ( it + length == eol || isSpace( it[ length ] ) );
+   }
+
+   /**
+      \brief First word after the keyword
+    */
+   inline std::string readToken( const char *it, const char *eol ) noexcept
+   {
+      it = skipSpaces( it, eol );
+      auto last = it;
+      while ( last < eol && !isSpace( *last ) ) {
+         ++last;
+      }
+      return std::string( it, last );
+   }
+
+   /**
+      \brief Everything after the keyword, without leading or trailing spaces
+    */
+   inline std::string readRestOfLine( const char *it, const char *eol ) noexcept
+   {
+      it = skipSpaces( it, eol );
+      auto last = eol;
+      while ( last > it && isSpace( *( last - 1 ) ) ) {
+         --last;
+      }
+      return std::string( it, last );
+   }
+
+   /**
+      \brief Converts a 1-based (or negative) OBJ index into a 0-based one
+
+      \returns true if the index is relative to the current end of the pool
+    */
+   inline bool resolveIndex( Int32 idx, Size count, Int32 &out ) noexcept
+   {
+      if ( idx > 0 ) {
+         out = idx - 1;
+         return false;
+      }
+
+      if ( idx < 0 ) {
+         out = Int32( count ) + idx;
+         return true;
+      }
+
+      out = -1;
+      return false;
+   }
+
+   void parseFace( Chunk &chunk, const char *it, const char *eol ) noexcept
+   {
+      OBJParser::Corner first;
+      OBJParser::Corner previous;
+      UInt32 firstRelative = 0;
+      UInt32 previousRelative = 0;
+      Size count = 0;
+
+      const auto emit = [ &chunk ]( const OBJParser::Corner &corner, UInt32 relative ) {
+         const auto idx = chunk.corners.size();
+         chunk.corners.push_back( corner );
+         for ( Size i = 0; i < 3; ++i ) {
+            if ( relative & ( 1 << i ) ) {
+               chunk.relative.push_back( idx * 3 + i );
+            }
+         }
+      };
+
+      while ( true ) {
+         Int32 idx;
+         auto next = OBJParser::parseInt( it, eol, idx );
+         if ( next == it ) {
+            break;
+         }
+         it = next;
+
+         OBJParser::Corner corner;
+         UInt32 relative = 0;
+         relative |= resolveIndex( idx, chunk.positions.size(), corner.position ) ? 1 : 0;
+
+         if ( it < eol && *it == '/' ) {
+            ++it;
+            if ( it < eol && *it != '/' ) {
+               next = OBJParser::parseInt( it, eol, idx );
+               if ( next != it ) {
+                  relative |= resolveIndex( idx, chunk.texCoords.size(), corner.texCoord ) ? 2 : 0;
+                  it = next;
+               }
+            }
+            if ( it < eol && *it == '/' ) {
+               ++it;
+               next = OBJParser::parseInt( it, eol, idx );
+               if ( next != it ) {
+                  relative |= resolveIndex( idx, chunk.normals.size(), corner.normal ) ? 4 : 0;
+                  it = next;
+               }
+            }
+         }
+
+         // Polygons are triangulated as fans around the first corner
+         if ( count == 0 ) {
+            first = corner;
+            firstRelative = relative;
+         } else if ( count >= 2 ) {
+            emit( first, firstRelative );
+            emit( previous, previousRelative );
+            emit( corner, relative );
+         }
+
+         previous = corner;
+         previousRelative = relative;
+         ++count;
+      }
+   }
+
+   void parseChunk( Chunk &chunk ) noexcept
+   {
+      auto it = chunk.begin;
+      const auto end = chunk.end;
+
+      while ( it < end ) {
+         it = skipSpaces( it, end );
+         const auto eol = findLineEnd( it, end );
+         const auto length = Size( eol - it );
+
+         if ( length > 0 ) {
+            switch ( it[ 0 ] ) {
+               case 'v': {
+                  if ( length > 1 && isSpace( it[ 1 ] ) ) {
+                     Vector3f v;
+                     auto p = OBJParser::parseReal( it + 1, eol, v.x );
+                     p = OBJParser::parseReal( p, eol, v.y );
+                     OBJParser::parseReal( p, eol, v.z );
+                     chunk.positions.push_back( v );
+                  } else if ( isKeyword( it, eol, "vt", 2 ) ) {
+                     Real32 s = 0;
+                     Real32 t = 0;
+                     OBJParser::parseReal( OBJParser::parseReal( it + 2, eol, s ), eol, t );
+                     chunk.texCoords.push_back( Vector2f { s, Real32( 1 ) - t } );
+                  } else if ( isKeyword( it, eol, "vn", 2 ) ) {
+                     Vector3f n;
+                     auto p = OBJParser::parseReal( it + 2, eol, n.x );
+                     p = OBJParser::parseReal( p, eol, n.y );
+                     OBJParser::parseReal( p, eol, n.z );
+                     chunk.normals.push_back( n );
+                  }
+                  break;
+               }
+
+               case 'f': {
+                  if ( length > 1 && isSpace( it[ 1 ] ) ) {
+                     parseFace( chunk, it + 1, eol );
+                  }
+                  break;
+               }
+
+               case 'o':
+               case 'g': {
+                  if ( length == 1 || isSpace( it[ 1 ] ) ) {
+                     chunk.commands.push_back( Command { CommandType::OBJECT, chunk.corners.size(), readToken( it + 1, eol ) } );
+                  }
+                  break;
+               }
+
+               case 'u': {
+                  if ( isKeyword( it, eol, "usemtl", 6 ) ) {
+                     chunk.commands.push_back( Command { CommandType::MATERIAL, chunk.corners.size(), readToken( it + 6, eol ) } );
+                  }
+                  break;
+               }
+
+               case 'm': {
+                  if ( isKeyword( it, eol, "mtllib", 6 ) ) {
+                     chunk.commands.push_back( Command { CommandType::LIBRARY, chunk.corners.size(), readRestOfLine( it + 6, eol ) } );
+                  }
+                  break;
+               }
+
+               default:
+                  // Comments and unsupported statements
+                  break;
+            }
+         }
+
+         it = eol < end ? eol + 1 : end;
+      }
+   }
+
+   inline UInt64 hashCorner( const OBJParser::Corner &corner ) noexcept
+   {
+      auto h = UInt64( UInt32( corner.position ) ) * 0x9E3779B97F4A7C15ull;
+      h ^= UInt64( UInt32( corner.texCoord ) ) * 0xC2B2AE3D27D4EB4Full;
+      h ^= UInt64( UInt32( corner.normal ) ) * 0x165667B19E3779F9ull;
+      return h ^ ( h >> 29 );
+   }
+
+   /**
+      \brief Assigns one vertex to each unique corner
+
+      Uses an open-addressing table with linear probing, storing only vertex indices.
+      Keys are compared against the vertex array, keeping the table small.
+    */
+   void deduplicate( const PendingMesh &pending, OBJParser::Mesh &mesh ) noexcept
+   {
+      constexpr auto EMPTY = ~UInt32( 0 );
+
+      Size capacity = 16;
+      while ( capacity < 2 * pending.cornerCount ) {
+         capacity <<= 1;
+      }
+      const auto mask = capacity - 1;
+      std::vector< UInt32 > table( capacity, EMPTY );
+
+      mesh.indices.reserve( pending.cornerCount );
+
+      for ( const auto &slice : pending.slices ) {
+         const auto corners = slice.chunk->corners.data();
+         for ( auto i = slice.begin; i < slice.end; ++i ) {
+            const auto &corner = corners[ i ];
+            auto slot = hashCorner( corner ) & mask;
+            while ( true ) {
+               const auto vertex = table[ slot ];
+               if ( vertex == EMPTY ) {
+                  table[ slot ] = UInt32( mesh.vertices.size() );
+                  mesh.indices.push_back( table[ slot ] );
+                  mesh.vertices.push_back( corner );
+                  break;
+               }
+               if ( mesh.vertices[ vertex ] == corner ) {
+                  mesh.indices.push_back( vertex );
+                  break;
+               }
+               slot = ( slot + 1 ) & mask;
+            }
+         }
+      }
+   }
+
+   template< typename T >
+   inline void appendPool( std::vector< T > &pool, std::vector< T > &dst, Size base ) noexcept
+   {
+      std::copy( pool.begin(), pool.end(), dst.begin() + base );
+      std::vector< T >().swap( pool );
+   }
+
+}
+
+const char *OBJParser::parseReal( const char *it, const char *end, Real32 &value ) noexcept
+{
+   // Powers of 10 up to 1e22 are exact in double precision
+   static constexpr double POW10[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
+   static constexpr UInt64 MANTISSA_LIMIT = 100000000000000000ull;
+
+   const auto start = it;
+   it = skipSpaces( it, end );
+
+   auto negative = false;
+   if ( it < end && ( *it == '-' || *it == '+' ) ) {
+      negative = *it == '-';
+      ++it;
+   }
+
+   UInt64 mantissa = 0;
+   Int32 exponent = 0;
+   auto hasDigits = false;
+
+   while ( it < end && isDigit( *it ) ) {
+      if ( mantissa < MANTISSA_LIMIT ) {
+         mantissa = mantissa * 10 + UInt64( *it - '0' );
+      } else {
+         ++exponent;
+      }
+      hasDigits = true;
+      ++it;
+   }
+
+   if ( it < end && *it == '.' ) {
+      ++it;
+      while ( it < end && isDigit( *it ) ) {
+         if ( mantissa < MANTISSA_LIMIT ) {
+            mantissa = mantissa * 10 + UInt64( *it - '0' );
+            --exponent;
+         }
+         hasDigits = true;
+         ++it;
+      }
+   }
+
+   if ( !hasDigits ) {
+      value = 0;
+      return start;
+   }
+
+   if ( it < end && ( *it == 'e' || *it == 'E' ) ) {
+      auto e = it + 1;
+      auto negativeExponent = false;
+      if ( e < end && ( *e == '-' || *e == '+' ) ) {
+         negativeExponent = *e == '-';
+         ++e;
+      }
+      if ( e < end && isDigit( *e ) ) {
+         Int32 x = 0;
+         while ( e < end && isDigit( *e ) ) {
+            if ( x < 10000 ) {
+               x = x * 10 + ( *e - '0' );
+            }
+            ++e;
+         }
+         exponent += negativeExponent ? -x : x;
+         it = e;
+      }
+   }
+
+   auto result = double( mantissa );
+   if ( exponent < 0 ) {
+      result = exponent >= -22 ? result / POW10[ -exponent ] : result * std::pow( 10.0, exponent );
+   } else if ( exponent > 0 ) {
+      result = exponent <= 22 ? result * POW10[ exponent ] : result * std::pow( 10.0, exponent );
+   }
+
+   value = Real32( negative ? -result : result );
+   return it;
+}
+
+const char *OBJParser::parseInt( const char *it, const char *end, Int32 &value ) noexcept
+{
+   const auto start = it;
+   it = skipSpaces( it, end );
+
+   auto negative = false;
+   if ( it < end && ( *it == '-' || *it == '+' ) ) {
+      negative = *it == '-';
+      ++it;
+   }
+
+   if ( it == end || !isDigit( *it ) ) {
+      value = 0;
+      return start;
+   }
+
+   Int64 result = 0;
+   while ( it < end && isDigit( *it ) ) {
+      result = std::min( result * 10 + ( *it - '0' ), Int64( 0x7FFFFFFF ) );
+      ++it;
+   }
+
+   value = Int32( negative ? -result : result );
+   return it;
+}
+
+Bool OBJParser::parseFile( const std::string &path ) noexcept
+{
+   MappedFile file;
+   if ( !file.open( path ) ) {
+      CRIMILD_LOG_ERROR( "Cannot load file ", path );
+      return false;
+   }
+
+   parse( reinterpret_cast< const char * >( file.getData() ), file.getSize() );
+   return true;
+}
+
+void OBJParser::parse( const char *data, Size size ) noexcept
+{
+   m_positions.clear();
+   m_texCoords.clear();
+   m_normals.clear();
+   m_objects.clear();
+   m_materialLibraries.clear();
+
+   if ( data == nullptr || size == 0 ) {
+      return;
+   }
+
+   // Split data at line boundaries. There are a few chunks per worker, so
+   // workers finishing early can steal from others
+   auto tasks = concurrency::TaskSystem::getInstance();
+   const auto workers = Size( tasks != nullptr ? std::max( 1, tasks->getNumWorkers() ) : 1 );
+   const auto chunkSize = std::max( m_chunkSize, size / ( 4 * workers ) + 1 );
+
+   std::vector< Chunk > chunks;
+   const auto end = data + size;
+   for ( auto it = data; it < end; ) {
+      auto next = end;
+      if ( Size( end - it ) > chunkSize ) {
+         const auto eol = findLineEnd( it + chunkSize - 1, end );
+         next = eol < end ? eol + 1 : end;
+      }
+      chunks.push_back( Chunk { .begin = it, .end = next } );
+      it = next;
+   }
+
+   concurrency::parallel_for(
+      concurrency::Range { 0, chunks.size() },
+      1,
+      [ & ]( concurrency::Range range ) {
+         for ( auto i = range.begin; i < range.end; ++i ) {
+            parseChunk( chunks[ i ] );
+         }
+      }
+   );
+
+   // Merge pools. Each chunk knows where its own values start
+   Size positionCount = 0;
+   Size texCoordCount = 0;
+   Size normalCount = 0;
+   for ( auto &chunk : chunks ) {
+      chunk.positionBase = positionCount;
+      chunk.texCoordBase = texCoordCount;
+      chunk.normalBase = normalCount;
+      positionCount += chunk.positions.size();
+      texCoordCount += chunk.texCoords.size();
+      normalCount += chunk.normals.size();
+   }
+
+   m_positions.resize( positionCount );
+   m_texCoords.resize( texCoordCount );
+   m_normals.resize( normalCount );
+
+   concurrency::parallel_for(
+      concurrency::Range { 0, chunks.size() },
+      1,
+      [ & ]( concurrency::Range range ) {
+         for ( auto i = range.begin; i < range.end; ++i ) {
+            auto &chunk = chunks[ i ];
+            appendPool( chunk.positions, m_positions, chunk.positionBase );
+            appendPool( chunk.texCoords, m_texCoords, chunk.texCoordBase );
+            appendPool( chunk.normals, m_normals, chunk.normalBase );
+
+            const Int32 bases[] = { Int32( chunk.positionBase ), Int32( chunk.texCoordBase ), Int32( chunk.normalBase ) };
+            for ( const auto r : chunk.relative ) {
+               auto &corner = chunk.corners[ r / 3 ];
+               switch ( r % 3 ) {
+                  case 0:
+                     corner.position += bases[ 0 ];
+                     break;
+                  case 1:
+                     corner.texCoord += bases[ 1 ];
+                     break;
+                  default:
+                     corner.normal += bases[ 2 ];
+                     break;
+               }
+            }
+         }
+      }
+   );
+
+   // Stitch chunks together in order, splitting faces into objects and meshes
+   std::vector< PendingMesh > pending;
+   auto currentObject = NONE;
+   auto currentMesh = NONE;
+   std::string currentMaterial;
+
+   const auto addCorners = [ & ]( const Chunk &chunk, Size begin, Size end ) {
+      if ( begin >= end ) {
+         return;
+      }
+      if ( currentObject == NONE ) {
+         // Anonymous object
+         m_objects.push_back( Object {} );
+         currentObject = m_objects.size() - 1;
+      }
+      if ( currentMesh == NONE ) {
+         pending.push_back( PendingMesh { .object = currentObject, .material = currentMaterial } );
+         currentMesh = pending.size() - 1;
+      }
+      pending[ currentMesh ].slices.push_back( Slice { &chunk, begin, end } );
+      pending[ currentMesh ].cornerCount += end - begin;
+   };
+
+   for ( const auto &chunk : chunks ) {
+      Size cursor = 0;
+      for ( const auto &cmd : chunk.commands ) {
+         addCorners( chunk, cursor, cmd.corner );
+         cursor = cmd.corner;
+         switch ( cmd.type ) {
+            case CommandType::OBJECT:
+               m_objects.push_back( Object { .name = cmd.name } );
+               currentObject = m_objects.size() - 1;
+               break;
+
+            case CommandType::MATERIAL:
+               currentMaterial = cmd.name;
+               break;
+
+            case CommandType::LIBRARY:
+               m_materialLibraries.push_back( cmd.name );
+               currentMaterial.clear();
+               break;
+         }
+         currentMesh = NONE;
+      }
+      addCorners( chunk, cursor, chunk.corners.size() );
+   }
+
+   std::vector< Mesh > meshes( pending.size() );
+   concurrency::parallel_for(
+      concurrency::Range { 0, pending.size() },
+      1,
+      [ & ]( concurrency::Range range ) {
+         for ( auto i = range.begin; i < range.end; ++i ) {
+            meshes[ i ].material = pending[ i ].material;
+            deduplicate( pending[ i ], meshes[ i ] );
+         }
+      }
+   );
+
+   for ( Size i = 0; i < pending.size(); ++i ) {
+      m_objects[ pending[ i ].object ].meshes.push_back( std::move( meshes[ i ] ) );
+   }
+}
+
+Size OBJParser::getTriangleCount( void ) const noexcept
+{
+   Size count = 0;
+   for ( const auto &obj : m_objects ) {
+      for ( const auto &mesh : obj.meshes ) {
+         count += mesh.indices.size() / 3;
+      }
+   }
+   return count;
+}
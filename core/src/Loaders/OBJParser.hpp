@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_LOADERS_OBJ_PARSER_
+#define CRIMILD_LOADERS_OBJ_PARSER_
+
+#include <crimild/foundation/common/Types.hpp>
+#include <crimild/math/Vector2.hpp>
+#include <crimild/math/Vector3.hpp>
+#include <string>
+#include <vector>
+
+namespace crimild {
+
+   /**
+      \brief Parses OBJ files in parallel
+
+      Files are memory-mapped and split in chunks at line boundaries. Each chunk is
+      tokenized in parallel with hand-written number parsers, producing its own pools
+      of positions, normals and texture coordinates. Pools are then merged by offset
+      and faces are resolved into meshes, deduplicating vertices with an open-addressing
+      hash table keyed by their position/texCoord/normal indices.
+
+      Only geometry is parsed. Material libraries and names are reported as they
+      appear in the file, but reading them is up to the caller.
+
+      \see OBJLoader::Mode::MAPPED
+    */
+   class OBJParser {
+   public:
+      /**
+         \brief Indices into the position, texture coordinates and normal pools
+
+         Missing indices are stored as -1
+       */
+      struct Corner {
+         Int32 position = -1;
+         Int32 texCoord = -1;
+         Int32 normal = -1;
+
+         inline bool operator==( const Corner &other ) const noexcept
+         {
+            return position == other.position && texCoord == other.texCoord && normal == other.normal;
+         }
+      };
+
+      /**
+         \brief Triangles sharing the same material
+
+         Each unique corner becomes one vertex.
+       */
+      struct Mesh {
+         std::string material;
+         std::vector< Corner > vertices;
+         std::vector< UInt32 > indices;
+      };
+
+      /**
+         \brief Declared with either 'o' or 'g'
+
+         Faces before any object declaration are stored in an unnamed object.
+       */
+      struct Object {
+         std::string name;
+         std::vector< Mesh > meshes;
+      };
+
+      /**
+         \brief Chunks are never smaller than this, in bytes
+       */
+      static constexpr Size DEFAULT_CHUNK_SIZE = 1 << 20;
+
+   public:
+      /**
+         \brief Parses an OBJ file
+
+         \returns false if the file cannot be read
+       */
+      Bool parseFile( const std::string &path ) noexcept;
+
+      /**
+         \brief Parses OBJ data already in memory
+       */
+      void parse( const char *data, Size size ) noexcept;
+
+      /**
+         \brief Minimum size for each chunk parsed in parallel, in bytes
+       */
+      inline void setChunkSize( Size chunkSize ) noexcept { m_chunkSize = chunkSize > 0 ? chunkSize : 1; }
+      inline Size getChunkSize( void ) const noexcept { return m_chunkSize; }
+
+      inline const std::vector< Vector3f > &getPositions( void ) const noexcept { return m_positions; }
+      inline const std::vector< Vector2f > &getTexCoords( void ) const noexcept { return m_texCoords; }
+      inline const std::vector< Vector3f > &getNormals( void ) const noexcept { return m_normals; }
+
+      inline const std::vector< Object > &getObjects( void ) const noexcept { return m_objects; }
+
+      /**
+         \brief Material files referenced with 'mtllib', in order of appearance
+       */
+      inline const std::vector< std::string > &getMaterialLibraries( void ) const noexcept { return m_materialLibraries; }
+
+      /**
+         \brief Total number of triangles in all meshes
+       */
+      Size getTriangleCount( void ) const noexcept;
+
+   public:
+      /**
+         \name Tokenizer
+       */
+      //@{
+
+      /**
+         \brief Parses a floating point number, skipping leading spaces
+
+         \returns A pointer past the last character used, or the input pointer if no number was found
+       */
+      static const char *parseReal( const char *it, const char *end, Real32 &value ) noexcept;
+
+      /**
+         \brief Parses a (possibly negative) integer, skipping leading spaces
+
+         \returns A pointer past the last character used, or the input pointer if no number was found
+       */
+      static const char *parseInt( const char *it, const char *end, Int32 &value ) noexcept;
+
+      //@}
+
+   private:
+      Size m_chunkSize = DEFAULT_CHUNK_SIZE;
+
+      std::vector< Vector3f > m_positions;
+      std::vector< Vector2f > m_texCoords;
+      std::vector< Vector3f > m_normals;
+      std::vector< Object > m_objects;
+      std::vector< std::string > m_materialLibraries;
+   };
+
+}
+
+#endif
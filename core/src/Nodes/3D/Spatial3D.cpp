@@ -9,6 +9,13 @@
 using namespace crimild;
 using namespace crimild::experimental;
 
+Spatial3D::~Spatial3D( void ) noexcept
+{
+   if ( m_storage != nullptr ) {
+      m_storage->detach( *this );
+   }
+}
+
 std::shared_ptr< Spatial3D > Spatial3D::getParent3D( void ) const
 {
    if ( m_parent3D.expired() ) {
@@ -28,6 +35,12 @@ std::shared_ptr< Spatial3D > Spatial3D::getParent3D( void ) const
 
 void Spatial3D::setLocal( const Transformation &local )
 {
+   if ( m_storage != nullptr ) {
+      m_storage->setLocal( *this, local );
+      perform< InvalidateWorldState >();
+      return;
+   }
+
    m_local = local;
    m_localIsCurrent = true;
    perform< InvalidateWorldState >();
@@ -35,6 +48,10 @@ void Spatial3D::setLocal( const Transformation &local )
 
 const Transformation &Spatial3D::getLocal( void ) const
 {
+   if ( m_storage != nullptr ) {
+      return m_storage->getLocal( *this );
+   }
+
    if ( !m_localIsCurrent ) {
       if ( auto parent = getParent3D() ) {
          // When a parent is present, world is computed as W = P * L
@@ -51,6 +68,16 @@ const Transformation &Spatial3D::getLocal( void ) const
 
 void Spatial3D::setWorld( const Transformation &world )
 {
+   if ( m_storage != nullptr ) {
+      // Resolve local right away. Otherwise, the storage might recompute world
+      // from a stale local transformation during its next update.
+      const auto parent = getParent3D();
+      m_storage->setLocal( *this, parent != nullptr ? inverse( parent->getWorld() )( world ) : world );
+      perform< InvalidateWorldState >();
+      m_storage->setWorld( *this, world );
+      return;
+   }
+
    m_world = world;
    m_localIsCurrent = false;
    perform< InvalidateWorldState >();
@@ -59,6 +86,10 @@ void Spatial3D::setWorld( const Transformation &world )
 
 const Transformation &Spatial3D::getWorld( void ) const
 {
+   if ( m_storage != nullptr ) {
+      return m_storage->getWorld( *this );
+   }
+
    if ( !m_worldIsCurrent ) {
       if ( auto parent = getParent3D() ) {
          m_world = parent->getWorld()( m_local );
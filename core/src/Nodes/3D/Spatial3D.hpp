@@ -2,6 +2,7 @@
 #define CRIMILD_CORE_NODES_3D_SPATIAL_
 
 #include "Common/Signal.hpp"
+#include "Nodes/3D/TransformStorage3D.hpp"
 #include "Nodes/Node.hpp"
 
 #include <crimild/math/Transformation.hpp>
@@ -19,13 +20,16 @@ namespace crimild::experimental {
     *
     * World invalidation appens on explicit hiearchy/local/world mutations,
     * not on lazy recomputation via getWorld()
+    *
+    * Transformations can be optionally kept in a TransformStorage3D instead,
+    * which updates world state for many nodes at once.
     */
    class Spatial3D : public Node {
    public:
       Signal<> worldChanged;
 
    public:
-      virtual ~Spatial3D( void ) = default;
+      virtual ~Spatial3D( void ) noexcept;
 
       inline bool hasParent3D( void ) const { return getParent3D() != nullptr; }
 
@@ -35,7 +39,7 @@ namespace crimild::experimental {
        */
       std::shared_ptr< Spatial3D > getParent3D( void ) const;
 
-      inline bool isLocalCurrent( void ) const { return m_localIsCurrent; }
+      inline bool isLocalCurrent( void ) const { return m_storage != nullptr || m_localIsCurrent; }
 
       /**
        * @remarks Invalidates world state
@@ -43,7 +47,7 @@ namespace crimild::experimental {
       void setLocal( const Transformation &local );
       const Transformation &getLocal( void ) const;
 
-      inline bool isWorldCurrent( void ) const { return m_worldIsCurrent; }
+      inline bool isWorldCurrent( void ) const { return m_storage != nullptr ? m_storage->isWorldCurrent( *this ) : m_worldIsCurrent; }
 
       /**
        * @remarks Invalidates local state
@@ -67,10 +71,23 @@ namespace crimild::experimental {
 
    protected:
       friend class InvalidateHierarchy;
-      inline void invalidateParent3D( void ) const { m_parent3D.reset(); }
+      inline void invalidateParent3D( void ) const
+      {
+         m_parent3D.reset();
+         if ( m_storage != nullptr ) {
+            m_storage->invalidateHierarchy();
+         }
+      }
 
       friend class InvalidateWorldState;
-      inline void invalidateWorldState( void ) const { m_worldIsCurrent = false; }
+      inline void invalidateWorldState( void ) const
+      {
+         if ( m_storage != nullptr ) {
+            m_storage->invalidateWorld( *this );
+         } else {
+            m_worldIsCurrent = false;
+         }
+      }
       /*
    virtual void onParentChanged( void ) override
    {
@@ -90,6 +107,19 @@ namespace crimild::experimental {
       mutable Transformation m_world = Transformation::Constants::IDENTITY;
       mutable bool m_worldIsCurrent = true;
 
+   public:
+      /**
+       * @brief Storage holding this node's transformations, if any
+       *
+       * @see TransformStorage3D::attach()
+       */
+      inline TransformStorage3D *getTransformStorage( void ) const { return m_storage; }
+
+   private:
+      friend class TransformStorage3D;
+      TransformStorage3D *m_storage = nullptr;
+      TransformStorage3D::Index m_storageIndex = TransformStorage3D::INVALID_INDEX;
+
    public:
       void accept( NodeVisitor &visitor ) override;
       void accept( NodeConstVisitor &visitor ) const override;
@@ -0,0 +1,289 @@
+#include "Nodes/3D/TransformStorage3D.hpp"
+
+#include "Concurrency/Parallel.hpp"
+#include "Nodes/3D/Spatial3D.hpp"
+#include "Nodes/Visitors/NodeVisitor.hpp"
+
+using namespace crimild;
+using namespace crimild::experimental;
+
+namespace crimild::experimental::impl {
+
+   class AttachToTransformStorage3D : public NodeVoidVisitor {
+   public:
+      explicit AttachToTransformStorage3D( TransformStorage3D &storage ) noexcept
+         : m_storage( storage )
+      {
+      }
+
+      virtual ~AttachToTransformStorage3D( void ) = default;
+
+      void visitSpatial3D( Spatial3D &spatial ) override
+      {
+         // Register parents before children, so entries are mostly sorted already
+         m_storage.attach( spatial );
+         NodeVoidVisitor::visitSpatial3D( spatial );
+      }
+
+   private:
+      TransformStorage3D &m_storage;
+   };
+
+}
+
+TransformStorage3D::~TransformStorage3D( void ) noexcept
+{
+   detachAll();
+}
+
+void TransformStorage3D::attach( Spatial3D &node ) noexcept
+{
+   if ( node.m_storage == this ) {
+      return;
+   }
+
+   if ( node.m_storage != nullptr ) {
+      node.m_storage->detach( node );
+   }
+
+   const auto index = Index( m_nodes.size() );
+   m_nodes.push_back( &node );
+   m_local.push_back( node.getLocal() );
+   m_world.push_back( node.m_world );
+   m_parent.push_back( INVALID_INDEX );
+   m_worldIsCurrent.push_back( node.isWorldCurrent() );
+
+   node.m_storage = this;
+   node.m_storageIndex = index;
+
+   m_hierarchyIsCurrent = false;
+}
+
+void TransformStorage3D::attachHierarchy( Node &root ) noexcept
+{
+   impl::AttachToTransformStorage3D attach( *this );
+   attach.traverse( root );
+}
+
+void TransformStorage3D::detach( Spatial3D &node ) noexcept
+{
+   if ( node.m_storage != this ) {
+      return;
+   }
+
+   const auto index = node.m_storageIndex;
+
+   // Give transformations back to the node
+   node.m_local = m_local[ index ];
+   node.m_localIsCurrent = true;
+   node.m_world = m_world[ index ];
+   node.m_worldIsCurrent = m_worldIsCurrent[ index ];
+   node.m_storage = nullptr;
+   node.m_storageIndex = INVALID_INDEX;
+
+   remove( index );
+}
+
+void TransformStorage3D::detachAll( void ) noexcept
+{
+   while ( !m_nodes.empty() ) {
+      detach( *m_nodes.back() );
+   }
+   m_levels.clear();
+   m_hierarchyIsCurrent = true;
+}
+
+bool TransformStorage3D::contains( const Spatial3D &node ) const noexcept
+{
+   return node.m_storage == this;
+}
+
+void TransformStorage3D::update( void ) noexcept
+{
+   if ( !m_hierarchyIsCurrent ) {
+      sort();
+   }
+
+   if ( m_levels.size() < 2 ) {
+      return;
+   }
+
+   // Roots may depend on nodes outside this storage, which are updated lazily
+   // and are not thread-safe. Always update them serially.
+   for ( Index i = m_levels[ 0 ]; i < m_levels[ 1 ]; ++i ) {
+      if ( !m_worldIsCurrent[ i ] ) {
+         computeWorld( i );
+      }
+   }
+
+   // Entries in the same level only read from previous levels
+   for ( size_t level = 1; level + 1 < m_levels.size(); ++level ) {
+      const auto range = concurrency::Range { m_levels[ level ], m_levels[ level + 1 ] };
+      const auto sweep = [ this ]( concurrency::Range chunk ) {
+         for ( auto i = chunk.begin; i < chunk.end; ++i ) {
+            if ( !m_worldIsCurrent[ i ] ) {
+               computeWorld( Index( i ) );
+            }
+         }
+      };
+
+      if ( range.size() < PARALLEL_MIN_ENTRIES ) {
+         sweep( range );
+      } else {
+         concurrency::parallel_for( range, PARALLEL_MIN_ENTRIES / 4, sweep );
+      }
+   }
+}
+
+const Transformation &TransformStorage3D::getLocal( const Spatial3D &node ) const noexcept
+{
+   return m_local[ node.m_storageIndex ];
+}
+
+void TransformStorage3D::setLocal( const Spatial3D &node, const Transformation &local ) noexcept
+{
+   m_local[ node.m_storageIndex ] = local;
+}
+
+const Transformation &TransformStorage3D::getWorld( const Spatial3D &node ) noexcept
+{
+   if ( !m_hierarchyIsCurrent ) {
+      sort();
+   }
+
+   const auto index = node.m_storageIndex;
+   if ( !m_worldIsCurrent[ index ] ) {
+      resolve( index );
+   }
+   return m_world[ index ];
+}
+
+void TransformStorage3D::setWorld( const Spatial3D &node, const Transformation &world ) noexcept
+{
+   m_world[ node.m_storageIndex ] = world;
+   m_worldIsCurrent[ node.m_storageIndex ] = true;
+}
+
+bool TransformStorage3D::isWorldCurrent( const Spatial3D &node ) const noexcept
+{
+   return m_worldIsCurrent[ node.m_storageIndex ];
+}
+
+void TransformStorage3D::invalidateWorld( const Spatial3D &node ) noexcept
+{
+   m_worldIsCurrent[ node.m_storageIndex ] = false;
+}
+
+void TransformStorage3D::sort( void ) noexcept
+{
+   const auto count = m_nodes.size();
+
+   for ( size_t i = 0; i < count; ++i ) {
+      const auto parent = m_nodes[ i ]->getParent3D();
+      m_parent[ i ] = parent != nullptr && parent->m_storage == this ? parent->m_storageIndex : INVALID_INDEX;
+   }
+
+   // Depth of each entry, relative to its registered root
+   std::vector< Index > depths( count, INVALID_INDEX );
+   std::vector< Index > chain;
+   Index maxDepth = 0;
+   for ( size_t i = 0; i < count; ++i ) {
+      auto current = Index( i );
+      while ( depths[ current ] == INVALID_INDEX && m_parent[ current ] != INVALID_INDEX ) {
+         chain.push_back( current );
+         current = m_parent[ current ];
+      }
+      if ( depths[ current ] == INVALID_INDEX ) {
+         depths[ current ] = 0;
+      }
+      auto depth = depths[ current ];
+      while ( !chain.empty() ) {
+         depths[ chain.back() ] = ++depth;
+         chain.pop_back();
+      }
+      maxDepth = std::max( maxDepth, depths[ i ] );
+   }
+
+   // Counting sort keeps the relative order of entries within each level
+   m_levels.assign( count > 0 ? maxDepth + 2 : 1, 0 );
+   for ( const auto depth : depths ) {
+      ++m_levels[ depth + 1 ];
+   }
+   for ( size_t level = 1; level < m_levels.size(); ++level ) {
+      m_levels[ level ] += m_levels[ level - 1 ];
+   }
+
+   std::vector< Index > remap( count );
+   {
+      auto next = m_levels;
+      for ( size_t i = 0; i < count; ++i ) {
+         remap[ i ] = next[ depths[ i ] ]++;
+      }
+   }
+
+   std::vector< Spatial3D * > nodes( count );
+   std::vector< Transformation > local( count );
+   std::vector< Transformation > world( count );
+   std::vector< Index > parent( count );
+   std::vector< UInt8 > worldIsCurrent( count );
+   for ( size_t i = 0; i < count; ++i ) {
+      const auto j = remap[ i ];
+      nodes[ j ] = m_nodes[ i ];
+      local[ j ] = m_local[ i ];
+      world[ j ] = m_world[ i ];
+      parent[ j ] = m_parent[ i ] != INVALID_INDEX ? remap[ m_parent[ i ] ] : INVALID_INDEX;
+      worldIsCurrent[ j ] = m_worldIsCurrent[ i ];
+      nodes[ j ]->m_storageIndex = j;
+   }
+
+   m_nodes = std::move( nodes );
+   m_local = std::move( local );
+   m_world = std::move( world );
+   m_parent = std::move( parent );
+   m_worldIsCurrent = std::move( worldIsCurrent );
+
+   m_hierarchyIsCurrent = true;
+}
+
+void TransformStorage3D::remove( Index index ) noexcept
+{
+   const auto last = Index( m_nodes.size() - 1 );
+   if ( index != last ) {
+      m_nodes[ index ] = m_nodes[ last ];
+      m_local[ index ] = m_local[ last ];
+      m_world[ index ] = m_world[ last ];
+      m_worldIsCurrent[ index ] = m_worldIsCurrent[ last ];
+      m_nodes[ index ]->m_storageIndex = index;
+   }
+
+   m_nodes.pop_back();
+   m_local.pop_back();
+   m_world.pop_back();
+   m_parent.pop_back();
+   m_worldIsCurrent.pop_back();
+
+   // Parent indices and levels are no longer valid
+   m_hierarchyIsCurrent = false;
+}
+
+void TransformStorage3D::resolve( Index index ) noexcept
+{
+   const auto parent = m_parent[ index ];
+   if ( parent != INVALID_INDEX && !m_worldIsCurrent[ parent ] ) {
+      resolve( parent );
+   }
+   computeWorld( index );
+}
+
+void TransformStorage3D::computeWorld( Index index ) noexcept
+{
+   const auto parent = m_parent[ index ];
+   if ( parent != INVALID_INDEX ) {
+      m_world[ index ] = m_world[ parent ]( m_local[ index ] );
+   } else if ( auto parent3D = m_nodes[ index ]->getParent3D() ) {
+      m_world[ index ] = parent3D->getWorld()( m_local[ index ] );
+   } else {
+      m_world[ index ] = m_local[ index ];
+   }
+   m_worldIsCurrent[ index ] = true;
+}
@@ -0,0 +1,160 @@
+#ifndef CRIMILD_CORE_NODES_3D_TRANSFORM_STORAGE_
+#define CRIMILD_CORE_NODES_3D_TRANSFORM_STORAGE_
+
+#include <crimild/foundation.hpp>
+#include <crimild/math/Transformation.hpp>
+#include <vector>
+
+namespace crimild::experimental {
+
+   class Node;
+   class Spatial3D;
+
+   /**
+    * @brief Optional flat storage for Spatial3D transformations
+    *
+    * By default, each Spatial3D owns its transformations and computes its world
+    * state lazily by walking up the hierarchy. Nodes registered in a storage keep
+    * their transformations in parallel arrays instead (local, world, parent index
+    * and dirty flags), sorted by depth so parents always come before their children.
+    *
+    * Calling update() recomputes all invalid world transformations in a single
+    * linear sweep, one depth level at a time. Entries in the same level don't depend
+    * on each other, so big levels are processed in parallel.
+    *
+    * Registered nodes keep using the same Spatial3D API. getWorld() still resolves
+    * world transformations lazily if invoked before update().
+    *
+    * A registered node whose closest Spatial3D ancestor is not registered is stored
+    * as a root and its world transformation is computed from that ancestor's.
+    *
+    * @remarks Nodes attached to the hierarchy after attach() are not registered
+    * automatically.
+    */
+   class TransformStorage3D : public NonCopyable {
+   public:
+      using Index = UInt32;
+
+      static constexpr Index INVALID_INDEX = ~Index( 0 );
+
+      /**
+       * @brief Levels with fewer entries than this are updated serially
+       */
+      static constexpr size_t PARALLEL_MIN_ENTRIES = 1024;
+
+   public:
+      TransformStorage3D( void ) = default;
+
+      /**
+       * @brief Releases all registered nodes
+       *
+       * Nodes get their transformations back and continue working as usual.
+       */
+      ~TransformStorage3D( void ) noexcept;
+
+      /**
+       * @brief Registers a single node
+       *
+       * Nodes can only be registered in one storage at a time. If the node is
+       * registered somewhere else, it is detached from that storage first.
+       */
+      void attach( Spatial3D &node ) noexcept;
+
+      /**
+       * @brief Registers all Spatial3D nodes in a hierarchy
+       */
+      void attachHierarchy( Node &root ) noexcept;
+
+      /**
+       * @brief Unregisters a node
+       *
+       * Registered descendants are not affected.
+       */
+      void detach( Spatial3D &node ) noexcept;
+
+      void detachAll( void ) noexcept;
+
+      [[nodiscard]] bool contains( const Spatial3D &node ) const noexcept;
+
+      [[nodiscard]] inline size_t size( void ) const noexcept { return m_nodes.size(); }
+      [[nodiscard]] inline bool empty( void ) const noexcept { return m_nodes.empty(); }
+
+      /**
+       * @brief Number of depth levels
+       *
+       * Only valid after update()
+       */
+      [[nodiscard]] inline size_t getLevelCount( void ) const noexcept { return m_levels.empty() ? 0 : m_levels.size() - 1; }
+
+      /**
+       * @brief Sorts entries if needed and recomputes all invalid world transformations
+       */
+      void update( void ) noexcept;
+
+   private:
+      friend class Spatial3D;
+
+      const Transformation &getLocal( const Spatial3D &node ) const noexcept;
+      void setLocal( const Spatial3D &node, const Transformation &local ) noexcept;
+
+      /**
+       * @brief Returns the world transformation for a node, computing it if needed
+       */
+      const Transformation &getWorld( const Spatial3D &node ) noexcept;
+
+      /**
+       * @brief Overrides the world transformation for a node
+       *
+       * The local transformation must be already set accordingly.
+       */
+      void setWorld( const Spatial3D &node, const Transformation &world ) noexcept;
+
+      bool isWorldCurrent( const Spatial3D &node ) const noexcept;
+      void invalidateWorld( const Spatial3D &node ) noexcept;
+
+      /**
+       * @brief Schedules a re-sort of entries
+       *
+       * Invoked when the closest Spatial3D ancestor of a registered node changes.
+       */
+      void invalidateHierarchy( void ) noexcept { m_hierarchyIsCurrent = false; }
+
+      /**
+       * @brief Computes parent indices and sorts entries by depth
+       */
+      void sort( void ) noexcept;
+
+      void remove( Index index ) noexcept;
+
+      /**
+       * @brief Computes the world transformation for an entry and all of its invalid ancestors
+       */
+      void resolve( Index index ) noexcept;
+
+      /**
+       * @brief Computes the world transformation for a single entry
+       *
+       * Assumes the parent entry (if any) is up to date.
+       */
+      void computeWorld( Index index ) noexcept;
+
+   private:
+      std::vector< Spatial3D * > m_nodes;
+      std::vector< Transformation > m_local;
+      std::vector< Transformation > m_world;
+      std::vector< Index > m_parent;
+      std::vector< UInt8 > m_worldIsCurrent;
+
+      /**
+       * @brief Offsets for each depth level
+       *
+       * Level i contains entries in the range [ m_levels[ i ], m_levels[ i + 1 ] )
+       */
+      std::vector< Index > m_levels;
+
+      bool m_hierarchyIsCurrent = true;
+   };
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+#include "TransformStorage3D.hpp"
+
+#include "Spatial3D.hpp"
+
+#include <crimild/math/rotation.hpp>
+#include <crimild/math/translation.hpp>
+#include <gtest/gtest.h>
+
+TEST( TransformStorage3D, attach_keeps_transformations )
+{
+   using namespace crimild::experimental;
+
+   auto parent = std::make_shared< Spatial3D >();
+   parent->setLocal( crimild::translation( 1, 2, 3 ) );
+   auto child = parent->attach< Spatial3D >();
+   child->setLocal( crimild::translation( 4, 5, 6 ) );
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *parent );
+
+   EXPECT_EQ( storage.size(), 2 );
+   EXPECT_TRUE( storage.contains( *parent ) );
+   EXPECT_TRUE( storage.contains( *child ) );
+   EXPECT_EQ( child->getTransformStorage(), &storage );
+
+   EXPECT_EQ( crimild::translation( 1, 2, 3 ), parent->getLocal() );
+   EXPECT_EQ( crimild::translation( 4, 5, 6 ), child->getLocal() );
+   EXPECT_EQ( crimild::translation( 5, 7, 9 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, sorts_entries_by_depth )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   auto a = root->attach< Spatial3D >();
+   auto b = a->attach< Node >()->attach< Spatial3D >();
+   auto c = root->attach< Spatial3D >();
+
+   TransformStorage3D storage;
+
+   // Register children first
+   storage.attach( *b );
+   storage.attach( *a );
+   storage.attach( *c );
+   storage.attach( *root );
+
+   storage.update();
+
+   EXPECT_EQ( storage.getLevelCount(), 3 );
+}
+
+TEST( TransformStorage3D, update_computes_world )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   auto child = root->attach< Spatial3D >();
+   auto grandchild = child->attach< Spatial3D >();
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *root );
+
+   root->setLocal( crimild::translation( 1, 0, 0 ) );
+   child->setLocal( crimild::translation( 0, 2, 0 ) );
+   grandchild->setLocal( crimild::translation( 0, 0, 3 ) );
+
+   EXPECT_FALSE( root->isWorldCurrent() );
+   EXPECT_FALSE( child->isWorldCurrent() );
+   EXPECT_FALSE( grandchild->isWorldCurrent() );
+
+   storage.update();
+
+   EXPECT_TRUE( root->isWorldCurrent() );
+   EXPECT_TRUE( child->isWorldCurrent() );
+   EXPECT_TRUE( grandchild->isWorldCurrent() );
+   EXPECT_EQ( crimild::translation( 1, 2, 3 ), grandchild->getWorld() );
+}
+
+TEST( TransformStorage3D, parent_local_invalidates_descendants )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   auto child = root->attach< Spatial3D >();
+   child->setLocal( crimild::translation( 0, 2, 0 ) );
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *root );
+   storage.update();
+
+   root->setLocal( crimild::translation( 1, 0, 0 ) );
+
+   EXPECT_FALSE( child->isWorldCurrent() );
+
+   // Lazily computed, without calling update()
+   EXPECT_EQ( crimild::translation( 1, 2, 0 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, set_world_resolves_local )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   root->setLocal( crimild::translation( 1, 0, 0 ) );
+   auto child = root->attach< Spatial3D >();
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *root );
+
+   child->setWorld( crimild::translation( 1, 2, 3 ) );
+
+   EXPECT_TRUE( child->isWorldCurrent() );
+   EXPECT_EQ( crimild::translation( 0, 2, 3 ), child->getLocal() );
+
+   root->setLocal( crimild::translation( 2, 0, 0 ) );
+   storage.update();
+
+   EXPECT_EQ( crimild::translation( 2, 2, 3 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, root_with_external_parent )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   root->setLocal( crimild::translation( 1, 0, 0 ) );
+   auto child = root->attach< Spatial3D >();
+   child->setLocal( crimild::translation( 0, 2, 0 ) );
+
+   TransformStorage3D storage;
+   storage.attach( *child );
+   storage.update();
+
+   EXPECT_EQ( crimild::translation( 1, 2, 0 ), child->getWorld() );
+
+   root->setLocal( crimild::translation( 3, 0, 0 ) );
+   storage.update();
+
+   EXPECT_EQ( crimild::translation( 3, 2, 0 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, reparenting )
+{
+   using namespace crimild::experimental;
+
+   auto a = std::make_shared< Spatial3D >();
+   a->setLocal( crimild::translation( 1, 0, 0 ) );
+   auto b = std::make_shared< Spatial3D >();
+   b->setLocal( crimild::translation( 0, 1, 0 ) );
+   auto child = a->attach< Spatial3D >();
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *a );
+   storage.attachHierarchy( *b );
+   storage.update();
+
+   EXPECT_EQ( crimild::translation( 1, 0, 0 ), child->getWorld() );
+
+   b->attach( child );
+   storage.update();
+
+   EXPECT_EQ( crimild::translation( 0, 1, 0 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, detach_returns_transformations )
+{
+   using namespace crimild::experimental;
+
+   auto root = std::make_shared< Spatial3D >();
+   root->setLocal( crimild::translation( 1, 0, 0 ) );
+   auto child = root->attach< Spatial3D >();
+
+   {
+      TransformStorage3D storage;
+      storage.attachHierarchy( *root );
+      child->setLocal( crimild::translation( 0, 2, 0 ) );
+      storage.detach( *root );
+
+      EXPECT_FALSE( storage.contains( *root ) );
+      EXPECT_EQ( root->getTransformStorage(), nullptr );
+      EXPECT_EQ( crimild::translation( 1, 2, 0 ), child->getWorld() );
+   }
+
+   EXPECT_EQ( child->getTransformStorage(), nullptr );
+   EXPECT_EQ( crimild::translation( 0, 2, 0 ), child->getLocal() );
+   EXPECT_EQ( crimild::translation( 1, 2, 0 ), child->getWorld() );
+
+   root->setLocal( crimild::translation( 3, 0, 0 ) );
+   EXPECT_EQ( crimild::translation( 3, 2, 0 ), child->getWorld() );
+}
+
+TEST( TransformStorage3D, destroying_nodes_detaches_them )
+{
+   using namespace crimild::experimental;
+
+   TransformStorage3D storage;
+
+   auto root = std::make_shared< Spatial3D >();
+   auto child = root->attach< Spatial3D >();
+   storage.attachHierarchy( *root );
+
+   root->detach( child );
+   child = nullptr;
+
+   EXPECT_EQ( storage.size(), 1 );
+   storage.update();
+   EXPECT_EQ( storage.getLevelCount(), 1 );
+}
+
+TEST( TransformStorage3D, matches_default_storage )
+{
+   using namespace crimild::experimental;
+
+   auto build = [] {
+      auto root = std::make_shared< Spatial3D >();
+      std::vector< std::shared_ptr< Spatial3D > > leaves;
+      for ( int i = 0; i < 8; ++i ) {
+         auto group = root->attach< Spatial3D >();
+         group->setLocal( crimild::rotationY( 0.1f * i )( crimild::translation( i, 0, 0 ) ) );
+         for ( int j = 0; j < 256; ++j ) {
+            auto leaf = group->attach< Spatial3D >();
+            leaf->setLocal( crimild::translation( 0, j, 0 ) );
+            leaves.push_back( leaf );
+         }
+      }
+      return std::make_pair( root, leaves );
+   };
+
+   auto [ expectedRoot, expected ] = build();
+   auto [ root, actual ] = build();
+
+   TransformStorage3D storage;
+   storage.attachHierarchy( *root );
+
+   expectedRoot->setLocal( crimild::translation( 0, 0, 5 ) );
+   root->setLocal( crimild::translation( 0, 0, 5 ) );
+   storage.update();
+
+   for ( size_t i = 0; i < expected.size(); ++i ) {
+      EXPECT_EQ( expected[ i ]->getWorld(), actual[ i ]->getWorld() );
+   }
+}
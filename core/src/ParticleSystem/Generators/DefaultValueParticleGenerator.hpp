@@ -62,10 +62,17 @@ namespace crimild {
 
       virtual void generate( Node *node, crimild::Real64 dt, ParticleData *particles, ParticleId startId, ParticleId endId ) override
       {
-         auto as = _attribs->getData< T >();
-
          const auto v = _value;
 
+         if ( _attribs->getLaneCount() > 0 ) {
+            for ( ParticleId i = startId; i < endId; i++ ) {
+               _attribs->set( i, v );
+            }
+            return;
+         }
+
+         auto as = _attribs->getData< T >();
+
          for ( ParticleId i = startId; i < endId; i++ ) {
             as[ i ] = v;
          }
@@ -68,6 +68,13 @@ namespace crimild {
 
       virtual void generate( Node *node, crimild::Real64 dt, ParticleData *particles, ParticleId startId, ParticleId endId ) override
       {
+         if ( _attribs->getLaneCount() > 0 ) {
+            for ( ParticleId i = startId; i < endId; i++ ) {
+               _attribs->set( i, Random::generate< T >( _minValue, _maxValue ) );
+            }
+            return;
+         }
+
          auto as = _attribs->getData< T >();
 
          for ( ParticleId i = startId; i < endId; i++ ) {
@@ -34,6 +34,9 @@
 #include <crimild/math/ColorRGBA.hpp>
 #include <crimild/math/Vector3.hpp>
 
+#include <cassert>
+#include <algorithm>
+
 namespace crimild {
 
    using ParticleId = crimild::Size;
@@ -67,6 +70,18 @@ namespace crimild {
 
    using ParticleAttribType = crimild::UInt16;
 
+   /**
+          \brief Copies a run of consecutive particles towards the beginning of an array
+
+          \remarks Source and destination ranges never overlap
+          \see ParticleData::compact
+        */
+   struct ParticleMove {
+      ParticleId src;
+      ParticleId dst;
+      crimild::Size count;
+   };
+
    /**
           \brief Interface for all particle attributes
         */
@@ -86,11 +101,88 @@ namespace crimild {
                */
       virtual void swap( ParticleId a, ParticleId b ) = 0;
 
+      /**
+                 \brief Applies a list of moves, in order
+
+                 Invoked once per frame when removing dead particles in bulk.
+                 The default implementation swaps elements one by one.
+               */
+      virtual void compact( const ParticleMove *moves, crimild::Size count )
+      {
+         for ( crimild::Size i = 0; i < count; ++i ) {
+            const auto &move = moves[ i ];
+            for ( crimild::Size j = 0; j < move.count; ++j ) {
+               swap( move.dst + j, move.src + j );
+            }
+         }
+      }
+
       /**
                  \brief Gets the number of elements in the array
                */
       virtual crimild::Size getCount( void ) const = 0;
 
+      /**
+                 \brief Number of separate float lanes used to store each element
+
+                 Zero means elements are stored interleaved (i.e. xyzxyz...)
+
+                 \see ParticleLaneArray
+               */
+      virtual crimild::Size getLaneCount( void ) const { return 0; }
+
+      /**
+                 \brief Number of floats between the beginning of two consecutive lanes
+               */
+      virtual crimild::Size getLaneStride( void ) const { return 0; }
+
+      /**
+                 \brief Sets the value of an element, regardless of the layout
+
+                 \remarks T must be made of floats only (i.e. Real32, Vector3f, ColorRGBA)
+               */
+      template< typename T >
+      void set( crimild::Size idx, const T &value )
+      {
+         const auto lanes = getLaneCount();
+         if ( lanes == 0 ) {
+            getData< T >()[ idx ] = value;
+            return;
+         }
+
+         assert( lanes * sizeof( crimild::Real32 ) == sizeof( T ) );
+         const auto src = reinterpret_cast< const crimild::Real32 * >( &value );
+         const auto stride = getLaneStride();
+         auto dst = static_cast< crimild::Real32 * >( getRawData() );
+         for ( crimild::Size i = 0; i < lanes; ++i ) {
+            dst[ i * stride + idx ] = src[ i ];
+         }
+      }
+
+      /**
+                 \brief Gets the value of an element, regardless of the layout
+
+                 \see set
+               */
+      template< typename T >
+      T get( crimild::Size idx ) const
+      {
+         const auto lanes = getLaneCount();
+         if ( lanes == 0 ) {
+            return getData< T >()[ idx ];
+         }
+
+         assert( lanes * sizeof( crimild::Real32 ) == sizeof( T ) );
+         T ret;
+         auto dst = reinterpret_cast< crimild::Real32 * >( &ret );
+         const auto stride = getLaneStride();
+         const auto src = static_cast< const crimild::Real32 * >( getRawData() );
+         for ( crimild::Size i = 0; i < lanes; ++i ) {
+            dst[ i ] = src[ i * stride + idx ];
+         }
+         return ret;
+      }
+
       /**
                  \brief Data accessor
                */
@@ -115,6 +207,8 @@ namespace crimild {
       template< typename T >
       T *getData( void )
       {
+         // Elements stored in several lanes cannot be accessed as an array of T
+         assert( getLaneCount() <= 1 || sizeof( T ) == sizeof( crimild::Real32 ) );
          return static_cast< T * >( getRawData() );
       }
 
@@ -124,7 +218,8 @@ namespace crimild {
       template< typename T >
       const T *getData( void ) const
       {
-         return static_cast< T * >( getRawData() );
+         assert( getLaneCount() <= 1 || sizeof( T ) == sizeof( crimild::Real32 ) );
+         return static_cast< const T * >( getRawData() );
       }
 
       /**
@@ -184,6 +279,20 @@ namespace crimild {
          _data[ b ] = temp;
       }
 
+      virtual void compact( const ParticleMove *moves, crimild::Size count ) override
+      {
+         auto data = _data.getData();
+         for ( crimild::Size i = 0; i < count; ++i ) {
+            const auto &move = moves[ i ];
+            if ( move.count == 1 ) {
+               // Most runs have a single particle. Avoid calling memmove for them
+               data[ move.dst ] = data[ move.src ];
+            } else {
+               std::copy_n( data + move.src, move.count, data + move.dst );
+            }
+         }
+      }
+
    private:
       /**
                  \brief Holds the data for the attributes
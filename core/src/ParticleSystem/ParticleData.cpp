@@ -27,9 +27,14 @@
 
 #include "ParticleData.hpp"
 
+#include "ParticleKernels.hpp"
+
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
 
+#include <algorithm>
+#include <bit>
+
 using namespace crimild;
 
 ParticleData::ParticleData( void )
@@ -62,6 +67,9 @@ void ParticleData::generate( void )
    for ( auto i = 0; i < count; i++ ) {
       _alive[ i ] = false;
    }
+
+   _deathMask.assign( ( count + DEATH_MASK_WORD_BITS - 1 ) / DEATH_MASK_WORD_BITS, 0 );
+   _sortedIndices.clear();
 }
 
 void ParticleData::kill( ParticleId pid )
@@ -75,6 +83,82 @@ void ParticleData::kill( ParticleId pid )
 
    _alive[ pid ] = false;
    swap( pid, --_aliveCount );
+   _sortedIndices.clear();
+}
+
+namespace crimild {
+
+   /**
+      \brief Finds the first particle in [ i, end ) whose bit in the mask matches the given value
+    */
+   static crimild::Size findNextInMask( const crimild::UInt64 *mask, crimild::Size i, crimild::Size end, crimild::Bool value ) noexcept
+   {
+      constexpr auto BITS = ParticleData::DEATH_MASK_WORD_BITS;
+      while ( i < end ) {
+         auto word = mask[ i / BITS ];
+         if ( !value ) {
+            word = ~word;
+         }
+         word >>= i % BITS;
+         if ( word != 0 ) {
+            return std::min( end, i + std::countr_zero( word ) );
+         }
+         i = ( i / BITS + 1 ) * BITS;
+      }
+      return end;
+   }
+
+}
+
+void ParticleData::compact( void )
+{
+   const auto count = _aliveCount;
+   const auto mask = _deathMask.data();
+   const auto words = ( count + DEATH_MASK_WORD_BITS - 1 ) / DEATH_MASK_WORD_BITS;
+
+   Size deadCount = 0;
+   for ( Size i = 0; i < words; ++i ) {
+      deadCount += std::popcount( mask[ i ] );
+   }
+
+   if ( deadCount == 0 ) {
+      return;
+   }
+
+   // Fill holes left by dead particles at the front with survivors from the back,
+   // so only as many particles as the ones that died are moved. Holes and survivors
+   // are both visited in ascending order, which merges consecutive ones into runs.
+   const auto aliveCount = count - deadCount;
+   _moves.clear();
+   auto hole = findNextInMask( mask, 0, aliveCount, true );
+   auto src = findNextInMask( mask, aliveCount, count, false );
+   while ( hole < aliveCount ) {
+      assert( src < count );
+      if ( !_moves.empty() && _moves.back().dst + _moves.back().count == hole && _moves.back().src + _moves.back().count == src ) {
+         ++_moves.back().count;
+      } else {
+         _moves.push_back( ParticleMove { src, hole, 1 } );
+      }
+      hole = findNextInMask( mask, hole + 1, aliveCount, true );
+      src = findNextInMask( mask, src + 1, count, false );
+   }
+
+   if ( !_moves.empty() ) {
+      const auto moves = _moves.data();
+      const auto moveCount = _moves.size();
+      _attribs.each( [ moves, moveCount ]( const ParticleAttribType &, ParticleAttribArrayPtr &attr ) {
+         if ( attr != nullptr ) {
+            attr->compact( moves, moveCount );
+         }
+      } );
+   }
+
+   for ( auto i = aliveCount; i < count; ++i ) {
+      _alive[ i ] = false;
+   }
+   std::fill_n( _deathMask.begin(), words, 0 );
+   _aliveCount = aliveCount;
+   _sortedIndices.clear();
 }
 
 void ParticleData::wake( ParticleId pid )
@@ -83,6 +167,15 @@ void ParticleData::wake( ParticleId pid )
 
    _alive[ pid ] = true;
    swap( pid, _aliveCount++ );
+   _sortedIndices.clear();
+}
+
+void ParticleData::sort( const crimild::Real32 *keys )
+{
+   const auto count = _aliveCount;
+   _sortedIndices.resize( count );
+   _sortScratch.resize( 3 * count );
+   particles::radixSort( keys, _sortedIndices.data(), _sortScratch.data(), count );
 }
 
 void ParticleData::swap( ParticleId a, ParticleId b )
@@ -106,6 +199,7 @@ void ParticleData::encode( coding::Encoder &encoder )
 
    encoder.encode( "maxParticles", _count );
    encoder.encode( "computeInWorldSpace", _computeInWorldSpace );
+   encoder.encode( "useAttribLanes", _useAttribLanes );
 }
 
 void ParticleData::decode( coding::Decoder &decoder )
@@ -114,4 +208,5 @@ void ParticleData::decode( coding::Decoder &decoder )
 
    decoder.decode( "maxParticles", _count );
    decoder.decode( "computeInWorldSpace", _computeInWorldSpace );
+   decoder.decode( "useAttribLanes", _useAttribLanes );
 }
@@ -29,8 +29,10 @@
 #define CRIMILD_PARTICLE_SYSTEM_DATA_
 
 #include "ParticleAttribArray.hpp"
+#include "ParticleLaneArray.hpp"
 
 #include <crimild/coding/Codable.hpp>
+#include <vector>
 
 namespace crimild {
 
@@ -102,9 +104,53 @@ namespace crimild {
          This method set the alive flag to false for the given particle
          and swaps the particle so it is stored in the far end of the
          data array
+
+         \warning Do not kill particles while others are marked as dead,
+         since swapping particles does not update the death mask
        */
       void kill( ParticleId pid );
 
+      /**
+         \brief Flags a particle to be removed by the next call to compact()
+
+         Unlike kill(), particles are not moved, so updaters can keep iterating over
+         alive particles while marking them.
+
+         \remarks Marking different particles from several threads at once is safe
+         as long as each thread works on ranges aligned to DEATH_MASK_WORD_BITS
+         particles.
+       */
+      inline void markDead( ParticleId pid )
+      {
+         assert( pid < _aliveCount );
+         _deathMask[ pid / DEATH_MASK_WORD_BITS ] |= crimild::UInt64( 1 ) << ( pid % DEATH_MASK_WORD_BITS );
+      }
+
+      /**
+         \brief Number of particles stored in each word of the death mask
+       */
+      static constexpr crimild::Size DEATH_MASK_WORD_BITS = 64;
+
+      /**
+         \brief One bit per particle, set for particles marked as dead
+
+         \see markDead
+       */
+      inline crimild::UInt64 *getDeathMask( void ) { return _deathMask.data(); }
+
+      /**
+         \brief Removes all particles marked as dead
+
+         Dead particles at the front are replaced with survivors from the back, so
+         each attribute array is updated once with bulk copies instead of swapping
+         particles one at a time while locking the attribute map.
+
+         \remarks Survivors might not keep their relative order.
+
+         \remarks Invoked by ParticleSystemComponent after all updaters are done.
+       */
+      void compact( void );
+
       /**
          \brief Activates a particle
        */
@@ -117,9 +163,46 @@ namespace crimild {
        */
       void swap( ParticleId a, ParticleId b );
 
+      /**
+         \brief Sorts alive particles by the given keys, in ascending order
+
+         Particle data is not moved. Instead, the resulting order is stored as a list
+         of indices that renderers use when drawing particles.
+
+         \param keys One key per alive particle (i.e. SORT_REFERENCE)
+
+         \see getSortedIndices
+       */
+      void sort( const crimild::Real32 *keys );
+
+      /**
+         \brief Indices of alive particles in the order they should be drawn
+
+         \remarks Indices are invalidated when particles are woken, killed or
+         removed, in which case this function returns false.
+       */
+      inline crimild::Bool hasSortedIndices( void ) const { return _aliveCount > 0 && _sortedIndices.size() == _aliveCount; }
+      inline const crimild::UInt32 *getSortedIndices( void ) const { return _sortedIndices.data(); }
+
       inline void setComputeInWorldSpace( crimild::Bool value ) { _computeInWorldSpace = value; }
       inline crimild::Bool shouldComputeInWorldSpace( void ) const { return _computeInWorldSpace; }
 
+      /**
+         \brief Store new attributes in separate float lanes
+
+         Updaters based on SIMD kernels are faster when attributes use lanes, but
+         generators and renderers accessing attribute data directly as arrays of
+         Vector3f or ColorRGBA won't work with them. Use ParticleAttribArray::set()
+         and ParticleAttribArray::get() to access values regardless of the layout.
+
+         \remarks Must be set before attributes are created (i.e. before the particle
+         system starts). Disabled by default.
+
+         \see ParticleLaneArray
+       */
+      inline void setUseAttribLanes( crimild::Bool value ) { _useAttribLanes = value; }
+      inline crimild::Bool shouldUseAttribLanes( void ) const { return _useAttribLanes; }
+
    private:
       ParticleAttribs _attribs;
 
@@ -127,8 +210,13 @@ namespace crimild {
       crimild::Size _aliveCount = 0;
 
       std::vector< crimild::Bool > _alive; // replace this for a custom array
+      std::vector< crimild::UInt64 > _deathMask;
+      std::vector< ParticleMove > _moves;
+      std::vector< crimild::UInt32 > _sortedIndices;
+      std::vector< crimild::UInt32 > _sortScratch;
 
       crimild::Bool _computeInWorldSpace = false;
+      crimild::Bool _useAttribLanes = false;
 
    public:
       /**
@@ -142,7 +230,12 @@ namespace crimild {
       {
          auto attribs = getAttrib( attribType );
          if ( attribs == nullptr ) {
-            setAttribs( attribType, crimild::alloc< ParticleAttribArrayImpl< T > >() );
+            const auto lanes = ParticleLaneArray::getLaneCount< T >();
+            if ( _useAttribLanes && lanes > 0 ) {
+               setAttribs( attribType, crimild::alloc< ParticleLaneArray >( lanes ) );
+            } else {
+               setAttribs( attribType, crimild::alloc< ParticleAttribArrayImpl< T > >() );
+            }
             attribs = getAttrib( attribType );
          }
 
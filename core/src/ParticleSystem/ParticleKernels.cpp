@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleKernels.hpp"
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+   #define CRIMILD_PARTICLE_KERNELS_SSE 1
+   #include <xmmintrin.h>
+#else
+   #define CRIMILD_PARTICLE_KERNELS_SSE 0
+#endif
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+using namespace crimild;
+
+void particles::add( Real32 *dst, Real32 value, Size begin, Size end ) noexcept
+{
+   auto i = begin;
+
+#if CRIMILD_PARTICLE_KERNELS_SSE
+   const auto v = _mm_set1_ps( value );
+   for ( ; i + 8 <= end; i += 8 ) {
+      _mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), v ) );
+      _mm_storeu_ps( dst + i + 4, _mm_add_ps( _mm_loadu_ps( dst + i + 4 ), v ) );
+   }
+#endif
+
+   for ( ; i < end; ++i ) {
+      dst[ i ] += value;
+   }
+}
+
+void particles::addScaled( Real32 *dst, const Real32 *src, Real32 scale, Size begin, Size end ) noexcept
+{
+   auto i = begin;
+
+#if CRIMILD_PARTICLE_KERNELS_SSE
+   const auto s = _mm_set1_ps( scale );
+   for ( ; i + 8 <= end; i += 8 ) {
+      _mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), _mm_mul_ps( s, _mm_loadu_ps( src + i ) ) ) );
+      _mm_storeu_ps( dst + i + 4, _mm_add_ps( _mm_loadu_ps( dst + i + 4 ), _mm_mul_ps( s, _mm_loadu_ps( src + i + 4 ) ) ) );
+   }
+#endif
+
+   for ( ; i < end; ++i ) {
+      dst[ i ] += scale * src[ i ];
+   }
+}
+
+void particles::lerpByAge( Real32 *const *dst, const Real32 *const *from, const Real32 *const *to, Size lanes, const Real32 *times, const Real32 *lifetimes, Size begin, Size end ) noexcept
+{
+   auto i = begin;
+
+#if CRIMILD_PARTICLE_KERNELS_SSE
+   const auto one = _mm_set1_ps( 1.0f );
+   for ( ; i + 4 <= end; i += 4 ) {
+      const auto u = _mm_sub_ps( one, _mm_div_ps( _mm_loadu_ps( times + i ), _mm_loadu_ps( lifetimes + i ) ) );
+      for ( Size k = 0; k < lanes; ++k ) {
+         const auto a = _mm_loadu_ps( from[ k ] + i );
+         const auto b = _mm_loadu_ps( to[ k ] + i );
+         _mm_storeu_ps( dst[ k ] + i, _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), u ) ) );
+      }
+   }
+#endif
+
+   for ( ; i < end; ++i ) {
+      const auto u = 1.0f - times[ i ] / lifetimes[ i ];
+      for ( Size k = 0; k < lanes; ++k ) {
+         dst[ k ][ i ] = from[ k ][ i ] + ( to[ k ][ i ] - from[ k ][ i ] ) * u;
+      }
+   }
+}
+
+void particles::lerpByAge4( Real32 *dst, const Real32 *from, const Real32 *to, const Real32 *times, const Real32 *lifetimes, Size begin, Size end ) noexcept
+{
+   for ( auto i = begin; i < end; ++i ) {
+      const auto u = 1.0f - times[ i ] / lifetimes[ i ];
+      const auto k = 4 * i;
+
+#if CRIMILD_PARTICLE_KERNELS_SSE
+      // One particle per register
+      const auto a = _mm_loadu_ps( from + k );
+      const auto b = _mm_loadu_ps( to + k );
+      _mm_storeu_ps( dst + k, _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), _mm_set1_ps( u ) ) ) );
+#else
+      for ( Size c = 0; c < 4; ++c ) {
+         dst[ k + c ] = from[ k + c ] + ( to[ k + c ] - from[ k + c ] ) * u;
+      }
+#endif
+   }
+}
+
+void particles::markLessEqual( UInt64 *mask, const Real32 *src, Real32 threshold, Size begin, Size end ) noexcept
+{
+   auto i = begin;
+   while ( i < end ) {
+      const auto wordEnd = std::min( end, ( i / 64 + 1 ) * 64 );
+      UInt64 bits = 0;
+      auto j = i;
+
+#if CRIMILD_PARTICLE_KERNELS_SSE
+      const auto t = _mm_set1_ps( threshold );
+      for ( ; j + 4 <= wordEnd; j += 4 ) {
+         const auto m = _mm_movemask_ps( _mm_cmple_ps( _mm_loadu_ps( src + j ), t ) );
+         bits |= UInt64( m ) << ( j % 64 );
+      }
+#endif
+
+      for ( ; j < wordEnd; ++j ) {
+         bits |= UInt64( src[ j ] <= threshold ) << ( j % 64 );
+      }
+
+      if ( bits != 0 ) {
+         mask[ i / 64 ] |= bits;
+      }
+      i = wordEnd;
+   }
+}
+
+void particles::project( Real32 *dst, const Real32 *x, const Real32 *y, const Real32 *z, Size stride, const Vector3f &axis, Real32 offset, Size begin, Size end ) noexcept
+{
+   const auto ax = axis.x;
+   const auto ay = axis.y;
+   const auto az = axis.z;
+
+   if ( stride == 1 ) {
+      // Simple enough for the compiler to vectorize
+      for ( auto i = begin; i < end; ++i ) {
+         dst[ i ] = x[ i ] * ax + y[ i ] * ay + z[ i ] * az + offset;
+      }
+      return;
+   }
+
+   for ( auto i = begin; i < end; ++i ) {
+      const auto k = i * stride;
+      dst[ i ] = x[ k ] * ax + y[ k ] * ay + z[ k ] * az + offset;
+   }
+}
+
+void particles::computeSortKeys( const ParticleAttribArray *positions, Real32 *keys, const Vector3f &axis, Real32 offset, Size count ) noexcept
+{
+   const auto data = static_cast< const Real32 * >( positions->getRawData() );
+   const auto lanes = positions->getLaneCount();
+   const auto laneStride = positions->getLaneStride();
+
+   const Real32 *x = data;
+   const Real32 *y = data + ( lanes > 0 ? laneStride : 1 );
+   const Real32 *z = data + ( lanes > 0 ? 2 * laneStride : 2 );
+   const Size stride = lanes > 0 ? 1 : 3;
+
+   forEachChunk(
+      count,
+      [ & ]( Size begin, Size end ) {
+         project( keys, x, y, z, stride, axis, offset, begin, end );
+      }
+   );
+}
+
+namespace crimild::particles {
+
+   /**
+      \brief Maps floats to unsigned integers with the same order
+
+      Positive values get their sign bit set, while negative ones get all of their
+      bits flipped, so larger magnitudes end up lower.
+    */
+   static inline UInt32 toSortableBits( Real32 value ) noexcept
+   {
+      const auto bits = std::bit_cast< UInt32 >( value );
+      const auto mask = UInt32( -Int32( bits >> 31 ) ) | 0x80000000u;
+      return bits ^ mask;
+   }
+
+}
+
+void particles::radixSort( const Real32 *keys, UInt32 *indices, UInt32 *scratch, Size count ) noexcept
+{
+   constexpr UInt32 DIGIT_BITS = 11;
+   constexpr UInt32 BUCKETS = 1 << DIGIT_BITS;
+   constexpr UInt32 PASSES = 3;
+
+   if ( count == 0 ) {
+      return;
+   }
+
+   std::array< std::array< UInt32, BUCKETS >, PASSES > histograms = {};
+
+   auto srcKeys = scratch;
+   auto dstKeys = scratch + count;
+   auto srcIndices = indices;
+   auto dstIndices = scratch + 2 * count;
+
+   // Compute all histograms in a single pass
+   for ( Size i = 0; i < count; ++i ) {
+      const auto bits = toSortableBits( keys[ i ] );
+      srcKeys[ i ] = bits;
+      srcIndices[ i ] = UInt32( i );
+      for ( UInt32 pass = 0; pass < PASSES; ++pass ) {
+         ++histograms[ pass ][ ( bits >> ( pass * DIGIT_BITS ) ) & ( BUCKETS - 1 ) ];
+      }
+   }
+
+   for ( UInt32 pass = 0; pass < PASSES; ++pass ) {
+      auto &histogram = histograms[ pass ];
+      const auto shift = pass * DIGIT_BITS;
+
+      // All keys have the same digit, so this pass will not change the order
+      if ( histogram[ ( srcKeys[ 0 ] >> shift ) & ( BUCKETS - 1 ) ] == count ) {
+         continue;
+      }
+
+      // Exclusive prefix sum
+      UInt32 sum = 0;
+      for ( auto &bucket : histogram ) {
+         const auto n = bucket;
+         bucket = sum;
+         sum += n;
+      }
+
+      for ( Size i = 0; i < count; ++i ) {
+         const auto bits = srcKeys[ i ];
+         const auto dst = histogram[ ( bits >> shift ) & ( BUCKETS - 1 ) ]++;
+         dstKeys[ dst ] = bits;
+         dstIndices[ dst ] = srcIndices[ i ];
+      }
+
+      std::swap( srcKeys, dstKeys );
+      std::swap( srcIndices, dstIndices );
+   }
+
+   if ( srcIndices != indices ) {
+      std::memcpy( indices, srcIndices, count * sizeof( UInt32 ) );
+   }
+}
+
+void particles::writeIndices( UInt32 *dst, const UInt32 *order, Size count, const UInt32 *pattern, Size patternSize, UInt32 verticesPerParticle ) noexcept
+{
+   for ( Size i = 0; i < count; ++i ) {
+      const auto base = ( order != nullptr ? order[ i ] : UInt32( i ) ) * verticesPerParticle;
+      for ( Size k = 0; k < patternSize; ++k ) {
+         *dst++ = base + pattern[ k ];
+      }
+   }
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_PARTICLE_SYSTEM_KERNELS_
+#define CRIMILD_PARTICLE_SYSTEM_KERNELS_
+
+#include "Concurrency/Parallel.hpp"
+#include "ParticleLaneArray.hpp"
+
+#include <algorithm>
+
+namespace crimild {
+
+   namespace particles {
+
+      /**
+         \brief Minimum number of particles before splitting work across workers
+       */
+      static constexpr crimild::Size PARALLEL_MIN_PARTICLES = 32 * 1024;
+
+      /**
+         \brief Maximum number of particles processed by each job
+       */
+      static constexpr crimild::Size PARALLEL_GRAIN = 16 * 1024;
+
+      /**
+         \brief Maximum number of particles in each block
+
+         Small enough for all the attributes used by an updater to fit in cache, so
+         several kernels can be applied to the same block in sequence. It's a multiple
+         of ParticleLaneArray::WIDTH, so all blocks but the last one start and end at
+         aligned positions.
+       */
+      static constexpr crimild::Size BLOCK_SIZE = 2048;
+
+      static_assert( BLOCK_SIZE % ParticleLaneArray::WIDTH == 0 );
+      static_assert( PARALLEL_GRAIN % BLOCK_SIZE == 0 );
+      static_assert( BLOCK_SIZE % 64 == 0, "Blocks must not share words in bit masks" );
+
+      /**
+         \brief Invokes fn( begin, end ) for blocks of at most BLOCK_SIZE particles in [ 0, count )
+
+         Big ranges are split across workers, if there's a task system running.
+       */
+      template< typename Fn >
+      void forEachChunk( crimild::Size count, Fn &&fn )
+      {
+         const auto blocks = [ &fn ]( crimild::Size begin, crimild::Size end ) {
+            for ( auto i = begin; i < end; i += BLOCK_SIZE ) {
+               fn( i, std::min( i + BLOCK_SIZE, end ) );
+            }
+         };
+
+         if ( count < PARALLEL_MIN_PARTICLES ) {
+            blocks( 0, count );
+            return;
+         }
+
+         concurrency::parallel_for(
+            concurrency::Range { 0, count },
+            PARALLEL_GRAIN,
+            [ &blocks ]( concurrency::Range range ) {
+               blocks( range.begin, range.end );
+            }
+         );
+      }
+
+      /**
+         \name Kernels
+
+         Each kernel processes elements in [ begin, end ) and uses SIMD instructions when
+         available. They work on a single float lane, or on interleaved data by scaling
+         the range by the number of components.
+       */
+      //@{
+
+      /**
+         \brief dst[ i ] += value
+       */
+      void add( crimild::Real32 *dst, crimild::Real32 value, crimild::Size begin, crimild::Size end ) noexcept;
+
+      /**
+         \brief dst[ i ] += scale * src[ i ]
+       */
+      void addScaled( crimild::Real32 *dst, const crimild::Real32 *src, crimild::Real32 scale, crimild::Size begin, crimild::Size end ) noexcept;
+
+      /**
+         \brief dst[ k ][ i ] = from[ k ][ i ] + ( to[ k ][ i ] - from[ k ][ i ] ) * ( 1 - times[ i ] / lifetimes[ i ] )
+
+         Interpolates several lanes at once, so the normalized age of each particle is
+         computed only once.
+       */
+      void lerpByAge(
+         crimild::Real32 *const *dst,
+         const crimild::Real32 *const *from,
+         const crimild::Real32 *const *to,
+         crimild::Size lanes,
+         const crimild::Real32 *times,
+         const crimild::Real32 *lifetimes,
+         crimild::Size begin,
+         crimild::Size end
+      ) noexcept;
+
+      /**
+         \brief Same as lerpByAge, but for interleaved values with four components (i.e. ColorRGBA)
+       */
+      void lerpByAge4(
+         crimild::Real32 *dst,
+         const crimild::Real32 *from,
+         const crimild::Real32 *to,
+         const crimild::Real32 *times,
+         const crimild::Real32 *lifetimes,
+         crimild::Size begin,
+         crimild::Size end
+      ) noexcept;
+
+      /**
+         \brief Sets bit i in mask for every src[ i ] <= threshold
+
+         Bits are OR'ed into the mask, 64 particles per word.
+
+         \remarks Ranges processed concurrently must not share words, which holds
+         for blocks returned by forEachChunk.
+         \see ParticleData::getDeathMask
+       */
+      void markLessEqual( crimild::UInt64 *mask, const crimild::Real32 *src, crimild::Real32 threshold, crimild::Size begin, crimild::Size end ) noexcept;
+
+      /**
+         \brief dst[ i ] = dot( p[ i ], axis ) + offset
+
+         Positions are read from x[ i * stride ], y[ i * stride ] and z[ i * stride ],
+         so the same kernel works for lanes (stride = 1) and interleaved values (stride = 3).
+       */
+      void project(
+         crimild::Real32 *dst,
+         const crimild::Real32 *x,
+         const crimild::Real32 *y,
+         const crimild::Real32 *z,
+         crimild::Size stride,
+         const Vector3f &axis,
+         crimild::Real32 offset,
+         crimild::Size begin,
+         crimild::Size end
+      ) noexcept;
+
+      /**
+         \brief Computes sort keys for alive particles, regardless of the positions layout
+
+         \see project
+       */
+      void computeSortKeys( const ParticleAttribArray *positions, crimild::Real32 *keys, const Vector3f &axis, crimild::Real32 offset, crimild::Size count ) noexcept;
+
+      /**
+         \brief Sorts indices in [ 0, count ) by their keys, in ascending order
+
+         Uses a LSD radix sort over 11-bit digits of the keys, skipping passes
+         in which all keys have the same digit. The sort is stable.
+
+         \param indices Output. Must have room for count elements
+         \param scratch Temporary storage for at least 3 * count elements
+       */
+      void radixSort( const crimild::Real32 *keys, crimild::UInt32 *indices, crimild::UInt32 *scratch, crimild::Size count ) noexcept;
+
+      /**
+         \brief Writes indices for drawing particles in a given order
+
+         Each particle emits one index per element in the pattern, computed as
+         pattern[ k ] + verticesPerParticle * pid.
+
+         \param order Particles to draw, in order. If null, particles are drawn
+         in the order they are stored.
+       */
+      void writeIndices(
+         crimild::UInt32 *dst,
+         const crimild::UInt32 *order,
+         crimild::Size count,
+         const crimild::UInt32 *pattern,
+         crimild::Size patternSize,
+         crimild::UInt32 verticesPerParticle
+      ) noexcept;
+
+      //@}
+
+   }
+
+}
+
+#endif
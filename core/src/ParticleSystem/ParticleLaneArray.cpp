@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleLaneArray.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace crimild;
+
+ParticleLaneArray::ParticleLaneArray( crimild::Size laneCount )
+   : _laneCount( laneCount )
+{
+   assert( laneCount > 0 );
+}
+
+ParticleLaneArray::~ParticleLaneArray( void )
+{
+   if ( _data != nullptr ) {
+      ::operator delete[]( _data, std::align_val_t( ALIGNMENT ) );
+   }
+}
+
+void ParticleLaneArray::reset( crimild::Size count )
+{
+   if ( _data != nullptr ) {
+      ::operator delete[]( _data, std::align_val_t( ALIGNMENT ) );
+      _data = nullptr;
+   }
+
+   _count = count;
+
+   // Padding lanes to the alignment keeps all of them aligned
+   constexpr auto padding = ALIGNMENT / sizeof( crimild::Real32 );
+   static_assert( padding % WIDTH == 0 );
+   _stride = ( ( count + padding - 1 ) / padding ) * padding;
+
+   if ( _stride > 0 ) {
+      const auto size = _laneCount * _stride;
+      _data = static_cast< crimild::Real32 * >( ::operator new[]( size * sizeof( crimild::Real32 ), std::align_val_t( ALIGNMENT ) ) );
+      std::memset( _data, 0, size * sizeof( crimild::Real32 ) );
+   }
+}
+
+void ParticleLaneArray::swap( ParticleId a, ParticleId b )
+{
+   for ( crimild::Size i = 0; i < _laneCount; ++i ) {
+      auto lane = getLane( i );
+      const auto temp = lane[ a ];
+      lane[ a ] = lane[ b ];
+      lane[ b ] = temp;
+   }
+}
+
+void ParticleLaneArray::compact( const ParticleMove *moves, crimild::Size count )
+{
+   for ( crimild::Size i = 0; i < _laneCount; ++i ) {
+      auto lane = getLane( i );
+      for ( crimild::Size j = 0; j < count; ++j ) {
+         const auto &move = moves[ j ];
+         if ( move.count == 1 ) {
+            lane[ move.dst ] = lane[ move.src ];
+         } else {
+            std::copy_n( lane + move.src, move.count, lane + move.dst );
+         }
+      }
+   }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_PARTICLE_SYSTEM_LANE_ARRAY_
+#define CRIMILD_PARTICLE_SYSTEM_LANE_ARRAY_
+
+#include "ParticleAttribArray.hpp"
+
+namespace crimild {
+
+   /**
+      \brief Stores each component of an attribute in its own float lane (x[], y[], z[], ...)
+
+      Lanes are aligned and padded to a multiple of WIDTH elements, so SIMD kernels can
+      process all lanes in chunks without gathering components from interleaved data.
+      Active elements are still stored at the beginning of each lane.
+
+      \remarks Arrays with a single lane have the same layout as an array of Real32.
+
+      \see ParticleAttribArray::set
+      \see ParticleData::setUseAttribLanes
+    */
+   class ParticleLaneArray : public ParticleAttribArray {
+   public:
+      /**
+         \brief Lanes are padded to a multiple of this number of elements
+       */
+      static constexpr crimild::Size WIDTH = 8;
+
+      /**
+         \brief Alignment for every lane, in bytes
+       */
+      static constexpr crimild::Size ALIGNMENT = 64;
+
+      /**
+         \brief Number of lanes needed to store values of type T, or zero if T is not made of floats
+       */
+      template< typename T >
+      static constexpr crimild::Size getLaneCount( void ) noexcept
+      {
+         return sizeof( T ) % sizeof( crimild::Real32 ) == 0 ? sizeof( T ) / sizeof( crimild::Real32 ) : 0;
+      }
+
+   public:
+      explicit ParticleLaneArray( crimild::Size laneCount = 1 );
+      virtual ~ParticleLaneArray( void );
+
+      virtual crimild::Size getCount( void ) const override { return _count; }
+
+      virtual crimild::Size getLaneCount( void ) const override { return _laneCount; }
+      virtual crimild::Size getLaneStride( void ) const override { return _stride; }
+
+      inline crimild::Real32 *getLane( crimild::Size lane ) noexcept { return _data + lane * _stride; }
+      inline const crimild::Real32 *getLane( crimild::Size lane ) const noexcept { return _data + lane * _stride; }
+
+      /**
+         \brief Returns the first lane. All lanes are stored contiguously.
+       */
+      virtual void *getRawData( void ) override { return _data; }
+      virtual const void *getRawData( void ) const override { return _data; }
+
+      /**
+         \brief Resizes all lanes. Values are reset to zero.
+       */
+      virtual void reset( crimild::Size count ) override;
+
+      virtual void swap( ParticleId a, ParticleId b ) override;
+      virtual void compact( const ParticleMove *moves, crimild::Size count ) override;
+
+   private:
+      crimild::Size _laneCount = 1;
+      crimild::Size _count = 0;
+      crimild::Size _stride = 0;
+      crimild::Real32 *_data = nullptr;
+   };
+
+}
+
+#endif
@@ -141,6 +141,9 @@ void ParticleSystemComponent::updateUpdaters( Node *node, crimild::Real64 dt, Pa
    _updaters.each( [ node, dt, particles ]( SharedPointer< ParticleUpdater > &u ) {
       u->update( node, dt, particles );
    } );
+
+   // Remove particles marked as dead by updaters all at once
+   particles->compact();
 }
 
 void ParticleSystemComponent::updateRenderers( Node *node, crimild::Real64 dt, ParticleData *particles )
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleVertexStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace crimild;
+
+ParticleVertexStream::ParticleVertexStream( const VertexLayout &layout, const void *defaultValue ) noexcept
+   : _layout( layout ),
+     _defaultValue( layout.getSize() )
+{
+   if ( defaultValue != nullptr ) {
+      memcpy( _defaultValue.getData(), defaultValue, layout.getSize() );
+   } else {
+      memset( _defaultValue.getData(), 0, layout.getSize() );
+   }
+}
+
+crimild::Bool ParticleVertexStream::update( ParticleAttribArray *attribs, crimild::Size capacity, crimild::Size aliveCount ) noexcept
+{
+   const auto elementSize = _layout.getSize();
+   const auto lanes = attribs != nullptr ? attribs->getLaneCount() : 0;
+
+   // Arrays of structs and single lanes (same layout as an array of Real32) can be
+   // used as vertices directly. Multiple lanes are stored as xxx...yyy...zzz...
+   // so they must be interleaved first.
+   const auto canAlias = attribs != nullptr
+                         && ( lanes == 0 || ( lanes == 1 && sizeof( crimild::Real32 ) == elementSize ) )
+                         && attribs->getCount() >= aliveCount;
+
+   auto recreated = false;
+
+   if ( canAlias ) {
+      auto data = static_cast< crimild::Byte * >( attribs->getRawData() );
+      const auto count = attribs->getCount();
+      if ( _vertices == nullptr || _source != data || _capacity != count ) {
+         // No data is copied. Render devices read particles straight from the attribute array
+         auto bufferView = crimild::alloc< BufferView >(
+            BufferView::Target::VERTEX,
+            crimild::alloc< Buffer >( data, count * elementSize ),
+            0,
+            elementSize
+         );
+         bufferView->setUsage( BufferView::Usage::DYNAMIC );
+         _vertices = crimild::alloc< VertexBuffer >( _layout, bufferView );
+         _source = data;
+         _capacity = count;
+         recreated = true;
+      }
+   } else {
+      if ( _vertices == nullptr || _source != nullptr || _capacity < capacity ) {
+         _vertices = crimild::alloc< VertexBuffer >( _layout, capacity );
+         _vertices->getBufferView()->setUsage( BufferView::Usage::DYNAMIC );
+         _source = nullptr;
+         _capacity = capacity;
+         recreated = true;
+
+         if ( attribs == nullptr ) {
+            // Missing attributes never change, so default values are written only once
+            auto dst = _vertices->getBufferView()->getData();
+            for ( crimild::Size i = 0; i < capacity; ++i ) {
+               memcpy( dst + i * elementSize, _defaultValue.getData(), elementSize );
+            }
+         }
+      }
+
+      if ( attribs != nullptr ) {
+         auto dst = _vertices->getBufferView()->getData();
+         const auto visible = std::min( aliveCount, _capacity );
+
+         // Arrays that have not grown yet only hold some of the alive particles
+         const auto count = std::min( attribs->getCount(), visible );
+
+         if ( lanes == 0 ) {
+            // Arrays of structs already have the same layout as vertices
+            memcpy( dst, attribs->getRawData(), count * elementSize );
+         } else {
+            // Interleave lanes into vertices (i.e. xxx...yyy...zzz... into xyzxyzxyz...)
+            assert( lanes * sizeof( crimild::Real32 ) == elementSize && "Invalid vertex layout for particle attribute" );
+            auto values = reinterpret_cast< crimild::Real32 * >( dst );
+            const auto src = static_cast< const crimild::Real32 * >( attribs->getRawData() );
+            const auto stride = attribs->getLaneStride();
+            for ( crimild::Size lane = 0; lane < lanes; ++lane ) {
+               const auto laneSrc = src + lane * stride;
+               for ( crimild::Size i = 0; i < count; ++i ) {
+                  values[ i * lanes + lane ] = laneSrc[ i ];
+               }
+            }
+         }
+
+         // Remaining particles are treated as if the attribute was missing
+         for ( crimild::Size i = count; i < visible; ++i ) {
+            memcpy( dst + i * elementSize, _defaultValue.getData(), elementSize );
+         }
+      }
+   }
+
+   // Only alive particles are visible to render devices
+   _vertices->getBufferView()->setLength( std::min( aliveCount, _capacity ) * elementSize );
+
+   return recreated;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_PARTICLE_SYSTEM_VERTEX_STREAM_
+#define CRIMILD_PARTICLE_SYSTEM_VERTEX_STREAM_
+
+#include "ParticleAttribArray.hpp"
+#include "Rendering/VertexBuffer.hpp"
+#include "Rendering/VertexLayout.hpp"
+
+namespace crimild {
+
+   /**
+      \brief Streams a single particle attribute to render devices
+
+      Whenever the attribute is stored as a contiguous array of the expected vertex
+      type, the vertex buffer aliases the attribute array itself and particles go
+      from the simulation to render devices without intermediate copies. Otherwise
+      (i.e. attributes stored in several lanes), values are interleaved into a vertex
+      buffer owned by the stream.
+
+      In both cases, the length of the vertex buffer only includes alive particles,
+      so render devices upload the [0, aliveCount) prefix only.
+
+      \remarks The vertex layout must have a single attribute matching the type of
+      the particle attribute (i.e. Vector3f for positions or ColorRGBA for colors)
+
+      \see Buffer::isExternal
+    */
+   class ParticleVertexStream {
+   public:
+      /**
+         \param defaultValue (optional) Value for all vertices when particles do not
+         have the attribute. Must be layout.getSize() bytes long.
+       */
+      explicit ParticleVertexStream( const VertexLayout &layout, const void *defaultValue = nullptr ) noexcept;
+      ~ParticleVertexStream( void ) = default;
+
+      inline const VertexLayout &getLayout( void ) const noexcept { return _layout; }
+
+      inline const SharedPointer< VertexBuffer > &getVertices( void ) const noexcept { return _vertices; }
+
+      /**
+         \brief Indicates if the vertex buffer references the particle attribute array
+       */
+      inline crimild::Bool isAliasing( void ) const noexcept { return _source != nullptr; }
+
+      /**
+         \brief Exposes alive particles to render devices
+
+         \param attribs Attribute array. Might be null if particles do not have the attribute.
+         Alive particles beyond the end of the array use the default value, as if it was null.
+         \param capacity Total number of particles
+         \param aliveCount Number of alive particles
+
+         \returns true if the vertex buffer was recreated and must be attached again to primitives.
+         This only happens when the attribute array changes its storage (i.e. after ParticleData::generate)
+       */
+      crimild::Bool update( ParticleAttribArray *attribs, crimild::Size capacity, crimild::Size aliveCount ) noexcept;
+
+   private:
+      VertexLayout _layout;
+      ByteArray _defaultValue;
+      SharedPointer< VertexBuffer > _vertices;
+
+      /**
+         \brief Memory referenced by the vertex buffer, if aliasing
+       */
+      const void *_source = nullptr;
+
+      /**
+         \brief Number of vertices available in the vertex buffer
+       */
+      crimild::Size _capacity = 0;
+   };
+
+}
+
+#endif
@@ -27,14 +27,17 @@
 
 #include "OrientedQuadParticleRenderer.hpp"
 
+#include "../ParticleKernels.hpp"
 #include "Components/MaterialComponent.hpp"
 #include "Concurrency/Async.hpp"
 #include "Rendering/Renderer.hpp"
 #include "SceneGraph/Camera.hpp"
 #include "Simulation/AssetManager.hpp"
+#include "Simulation/Simulation.hpp"
 
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
+#include <crimild/math/inverse.hpp>
 
 using namespace crimild;
 
@@ -62,87 +65,85 @@ void OrientedQuadParticleRenderer::configure( Node *node, ParticleData *particle
    _positions = particles->getAttrib( ParticleAttrib::POSITION );
    _sizes = particles->getAttrib( ParticleAttrib::UNIFORM_SCALE );
 
+   // Buffers are big enough for all particles and reused every frame
+   const auto capacity = particles->getParticleCount();
+   _vertices = crimild::alloc< VertexBuffer >( VertexLayout::P3_TC2, 4 * capacity );
+   _vertices->getBufferView()->setUsage( BufferView::Usage::DYNAMIC );
+   _indices = crimild::alloc< IndexBuffer >( Format::INDEX_32_UINT, 6 * capacity );
+   _indices->getBufferView()->setUsage( BufferView::Usage::DYNAMIC );
+
    _primitive = crimild::alloc< Primitive >( Primitive::Type::TRIANGLES );
+   _primitive->setVertexData( { _vertices } );
+   _primitive->setIndices( _indices );
 
    _geometry->attachPrimitive( _primitive );
 }
 
 void OrientedQuadParticleRenderer::update( Node *node, crimild::Real64 dt, ParticleData *particles )
 {
-   assert( false );
-   /*
    const auto pCount = particles->getAliveCount();
-   if ( pCount == 0 ) {
-       return;
+
+   // Only alive particles are drawn
+   _indices->getBufferView()->setLength( 6 * pCount * sizeof( crimild::UInt32 ) );
+   if ( pCount == 0 || _positions == nullptr ) {
+      return;
    }
 
-   // TODO: this ends up allocating too many VBOs/IBOs. We should reuse them instead
-   auto vbo = crimild::alloc< VertexBufferObject >( VertexFormat::VF_P3_UV2, 4 * pCount );
-       auto ibo = crimild::alloc< IndexBufferObject >( 6 * pCount );
-
-       const auto camera = Camera::getMainCamera();
-       auto cameraUp = camera->getWorld().computeUp();
-       auto cameraRight = camera->getWorld().computeRight();
-
-       node->getWorld().applyInverseToVector( cameraUp, cameraUp );
-       node->getWorld().applyInverseToVector( cameraRight, cameraRight );
-
-       const auto offset0 = cameraUp - cameraRight;
-       const auto offset1 = -cameraUp - cameraRight;
-       const auto offset2 = -cameraUp + cameraRight;
-       const auto offset3 = cameraUp + cameraRight;
-
-       const auto uv0 = Vector2f( 0.0f, 0.0f );
-       const auto uv1 = Vector2f( 0.0f, 1.0f );
-       const auto uv2 = Vector2f( 1.0f, 1.0f );
-       const auto uv3 = Vector2f( 1.0f, 0.0f );
-
-       const auto ps = _positions->getData< Vector3f >();
-       const auto ss = _sizes->getData< crimild::Real32 >();
-
-       // Vertex data is interleaved, so it should be more efficient
-       // to set each vertex attribute per loop (as below) instead of
-       // using separated loops (as in the case of other updaters/renderers)
-       // TODO: I need to confirm this somehow
-       for ( auto i = 0; i < pCount; i++ ) {
-               auto idx = i * 4;
-               auto pos = ps[ i ];
-               if ( particles->shouldComputeInWorldSpace() ) {
-                       // TODO: cache inverse transform?
-                       node->getWorld().applyInverseToPoint( pos, pos );
-               }
-               auto s = ss[ i ];
-
-               vbo->setPositionAt( idx + 0, pos + s * offset0 );
-               vbo->setTextureCoordAt( idx + 0, uv0 );
-
-               vbo->setPositionAt( idx + 1, pos + s * offset1 );
-               vbo->setTextureCoordAt( idx + 1, uv1 );
-
-               vbo->setPositionAt( idx + 2, pos + s * offset2 );
-               vbo->setTextureCoordAt( idx + 2, uv2 );
-
-               vbo->setPositionAt( idx + 3, pos + s * offset3 );
-               vbo->setTextureCoordAt( idx + 3, uv3 );
-       }
-
-       for ( auto i = 0; i < pCount; i++ ) {
-               const auto idx = i * 6;
-               const auto vdx = i * 4;
-               ibo->setIndexAt( idx + 0, vdx + 0 );
-               ibo->setIndexAt( idx + 1, vdx + 1 );
-               ibo->setIndexAt( idx + 2, vdx + 2 );
-               ibo->setIndexAt( idx + 3, vdx + 0 );
-               ibo->setIndexAt( idx + 4, vdx + 2 );
-               ibo->setIndexAt( idx + 5, vdx + 3 );
-       }
-
-   auto primitive = _primitive;
-   crimild::concurrency::sync_frame( [ primitive, vbo, ibo ] {
-       primitive->setVertexBuffer( vbo );
-       primitive->setIndexBuffer( ibo );
-   });
-   */
+   const auto camera = Simulation::getInstance() != nullptr ? Simulation::getInstance()->getMainCamera() : nullptr;
+   if ( camera == nullptr ) {
+      _indices->getBufferView()->setLength( 0 );
+      return;
+   }
+
+   const auto invWorld = inverse( node->getWorld() );
+   const auto cameraUp = invWorld( up( camera->getWorld() ) );
+   const auto cameraRight = invWorld( right( camera->getWorld() ) );
+
+   const Vector3f offsets[] = {
+      Vector3f( cameraUp - cameraRight ),
+      Vector3f( -cameraUp - cameraRight ),
+      Vector3f( -cameraUp + cameraRight ),
+      Vector3f( cameraUp + cameraRight ),
+   };
+
+   const Vector2f uvs[] = {
+      Vector2f { 0.0f, 0.0f },
+      Vector2f { 0.0f, 1.0f },
+      Vector2f { 1.0f, 1.0f },
+      Vector2f { 1.0f, 0.0f },
+   };
+
+   auto positions = _vertices->get( VertexAttribute::Name::POSITION );
+   auto texCoords = _vertices->get( VertexAttribute::Name::TEX_COORD );
+
+   const auto worldSpace = particles->shouldComputeInWorldSpace();
+
+   // Vertex data is interleaved, so set all attributes for each vertex in the same loop
+   for ( crimild::Size i = 0; i < pCount; ++i ) {
+      auto pos = _positions->get< Vector3f >( i );
+      if ( worldSpace ) {
+         pos = Vector3f( invWorld( Point3( pos ) ) );
+      }
+      const auto s = _sizes != nullptr ? _sizes->get< crimild::Real32 >( i ) : 1.0f;
+
+      const auto idx = 4 * i;
+      for ( crimild::Size k = 0; k < 4; ++k ) {
+         positions->set( idx + k, pos + s * offsets[ k ] );
+         texCoords->set( idx + k, uvs[ k ] );
+      }
+   }
+
+   // Quads are stored in the same order as particles, so sorting them
+   // only requires to change the order of indices
+   const crimild::UInt32 pattern[] = { 0, 1, 2, 0, 2, 3 };
+   particles::writeIndices(
+      reinterpret_cast< crimild::UInt32 * >( _indices->getBufferView()->getData() ),
+      particles->hasSortedIndices() ? particles->getSortedIndices() : nullptr,
+      pCount,
+      pattern,
+      6,
+      4
+   );
 }
 
 void OrientedQuadParticleRenderer::encode( coding::Encoder &encoder )
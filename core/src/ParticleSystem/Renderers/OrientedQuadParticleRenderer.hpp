@@ -53,6 +53,8 @@ namespace crimild {
 		MaterialPtr _material;
 		PrimitivePtr _primitive;
 		GeometryPtr _geometry;
+		SharedPointer< VertexBuffer > _vertices;
+		SharedPointer< IndexBuffer > _indices;
 		
 		ParticleAttribArray *_positions = nullptr;
 		ParticleAttribArray *_sizes = nullptr;
@@ -27,6 +27,7 @@
 
 #include "PointSpriteParticleRenderer.hpp"
 
+#include "../ParticleKernels.hpp"
 #include "Components/MaterialComponent.hpp"
 #include "Concurrency/Async.hpp"
 #include "Rendering/Renderer.hpp"
@@ -37,7 +38,26 @@ using namespace crimild;
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
 
+namespace crimild {
+
+   static const ColorRGBA DEFAULT_PARTICLE_COLOR = ColorRGBA { 1, 1, 1, 1 };
+   static const crimild::Real32 DEFAULT_PARTICLE_SIZE = 1.0f;
+
+}
+
+Array< VertexLayout > PointSpriteParticleRenderer::getVertexLayouts( void ) noexcept
+{
+   return {
+      VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ),
+      VertexLayout().withAttribute< ColorRGBA >( VertexAttribute::Name::COLOR ),
+      VertexLayout().withAttribute< crimild::Real32 >( VertexAttribute::Name::TEX_COORD ),
+   };
+}
+
 PointSpriteParticleRenderer::PointSpriteParticleRenderer( void )
+   : _positionStream( VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ) ),
+     _colorStream( VertexLayout().withAttribute< ColorRGBA >( VertexAttribute::Name::COLOR ), &DEFAULT_PARTICLE_COLOR ),
+     _sizeStream( VertexLayout().withAttribute< crimild::Real32 >( VertexAttribute::Name::TEX_COORD ), &DEFAULT_PARTICLE_SIZE )
 {
    // create the material here so it can be modified later
    _material = crimild::alloc< Material >();
@@ -62,58 +82,65 @@ void PointSpriteParticleRenderer::configure( Node *node, ParticleData *particles
    _colors = particles->getAttrib( ParticleAttrib::COLOR );
    _sizes = particles->getAttrib( ParticleAttrib::UNIFORM_SCALE );
 
+   // Index buffer is big enough for all particles and reused every frame
+   const auto capacity = particles->getParticleCount();
+   _indices = crimild::alloc< IndexBuffer >( Format::INDEX_32_UINT, capacity );
+   _indices->getBufferView()->setUsage( BufferView::Usage::DYNAMIC );
+
    _primitive = crimild::alloc< Primitive >( Primitive::Type::POINTS );
+   _primitive->setIndices( _indices );
 
    _geometry->attachPrimitive( _primitive );
 }
 
 void PointSpriteParticleRenderer::update( Node *node, crimild::Real64 dt, ParticleData *particles )
 {
-   assert( false );
-   /*
    const auto pCount = particles->getAliveCount();
+
+   // Only alive particles are drawn
+   _indices->getBufferView()->setLength( pCount * sizeof( crimild::UInt32 ) );
+   if ( _positions == nullptr ) {
+      return;
+   }
+
+   // Particles computed in world space are rendered as they are, instead
+   // of transforming each of them back into the node's local space
+   const auto worldSpace = particles->shouldComputeInWorldSpace();
+   if ( _geometry->worldIsCurrent() != worldSpace ) {
+      _geometry->setWorldIsCurrent( worldSpace );
+      _geometry->setWorld( Transformation::Constants::IDENTITY );
+   }
+
+   // Streams alias particle attributes, so the primitive only changes when their storage does
+   const auto capacity = particles->getParticleCount();
+   auto recreated = _positionStream.update( _positions, capacity, pCount );
+   recreated |= _colorStream.update( _colors, capacity, pCount );
+   recreated |= _sizeStream.update( _sizes, capacity, pCount );
+   if ( recreated ) {
+      _primitive->setVertexData(
+         {
+            _positionStream.getVertices(),
+            _colorStream.getVertices(),
+            _sizeStream.getVertices(),
+         }
+      );
+   }
+
    if ( pCount == 0 ) {
-       return;
+      return;
    }
 
-   auto vbo = crimild::alloc< VertexBufferObject >( VertexFormat::VF_P3_C4_UV2, pCount );
-
-       const auto ps = _positions->getData< Vector3f >();
-       const auto ss = _sizes->getData< crimild::Real32 >();
-       const auto cs = _colors->getData< RGBAColorf >();
-
-   // TODO: should I traverse the arrays by grouping data in 4/8 byte touples?
-
-       if ( particles->shouldComputeInWorldSpace() ) {
-               for ( auto i = 0; i < pCount; i++ ) {
-                       auto p = ps[ i ];
-                       // TODO: cache inverse transform?
-                       node->getWorld().applyInverseToPoint( p, p );
-                       vbo->setPositionAt( i, p );
-               }
-       }
-       else {
-               for ( auto i = 0; i < pCount; i++ ) {
-                       vbo->setPositionAt( i, ps[ i ] );
-               }
-       }
-
-       for ( auto i = 0; i < pCount; i++ ) {
-               vbo->setTextureCoordAt( i, Vector2f( ss[ i ], 0.0f ) );
-       }
-
-       for ( auto i = 0; i < pCount; i++ ) {
-               vbo->setRGBAColorAt( i, cs[ i ] );
-       }
-
-   auto ibo = crimild::alloc< IndexBufferObject >( pCount );
-   ibo->generateIncrementalIndices();
-
-   crimild::concurrency::sync_frame( [this, vbo, ibo] {
-       _primitive->setVertexBuffer( vbo );
-       _primitive->setIndexBuffer( ibo );
-   });
-   */
+   // Vertices are stored in the same order as particles, so sorting them
+   // only requires to change the order of indices
+   const crimild::UInt32 pattern[] = { 0 };
+   particles::writeIndices(
+      reinterpret_cast< crimild::UInt32 * >( _indices->getBufferView()->getData() ),
+      particles->hasSortedIndices() ? particles->getSortedIndices() : nullptr,
+      pCount,
+      pattern,
+      1,
+      1
+   );
 }
 
 void PointSpriteParticleRenderer::encode( coding::Encoder &encoder )
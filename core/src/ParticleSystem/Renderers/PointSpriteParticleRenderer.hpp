@@ -29,6 +29,7 @@
 #define CRIMILD_PARTICLE_RENDERER_POINT_SPRITE_
 
 #include "../ParticleSystemComponent.hpp"
+#include "../ParticleVertexStream.hpp"
 
 #include "Rendering/Material.hpp"
 #include "SceneGraph/Geometry.hpp"
@@ -36,9 +37,24 @@
 
 namespace crimild {
 
+    /**
+       \brief Renders particles as points
+
+       Positions, colors and sizes are streamed in separate vertex buffers (one binding
+       each) that alias particle attributes whenever possible, so no copies are made.
+       Programs used by the material must declare the layouts returned by getVertexLayouts()
+
+       \see ParticleVertexStream
+     */
     class PointSpriteParticleRenderer : public ParticleSystemComponent::ParticleRenderer {
 		CRIMILD_IMPLEMENT_RTTI( crimild::PointSpriteParticleRenderer )
 		
+    public:
+        /**
+           \brief Layouts for each vertex binding: positions, colors and sizes (as TEX_COORD)
+         */
+        static Array< VertexLayout > getVertexLayouts( void ) noexcept;
+
     public:
         PointSpriteParticleRenderer( void );
         virtual ~PointSpriteParticleRenderer( void );
@@ -52,6 +68,10 @@ namespace crimild {
 		MaterialPtr _material;
 		PrimitivePtr _primitive;
 		GeometryPtr _geometry;
+		ParticleVertexStream _positionStream;
+		ParticleVertexStream _colorStream;
+		ParticleVertexStream _sizeStream;
+		SharedPointer< IndexBuffer > _indices;
 		
 		ParticleAttribArray *_positions = nullptr;
 		ParticleAttribArray *_colors = nullptr;
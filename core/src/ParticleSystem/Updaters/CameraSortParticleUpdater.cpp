@@ -27,7 +27,11 @@
 
 #include "CameraSortParticleUpdater.hpp"
 
+#include "../ParticleKernels.hpp"
 #include "SceneGraph/Camera.hpp"
+#include "Simulation/Simulation.hpp"
+
+#include <crimild/math/inverse.hpp>
 
 using namespace crimild;
 
@@ -42,50 +46,46 @@ CameraSortParticleUpdater::~CameraSortParticleUpdater( void )
 void CameraSortParticleUpdater::configure( Node *node, ParticleData *particles )
 {
    _positions = particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
-   _distances = particles->createAttribArray< Vector2f >( ParticleAttrib::SORT_REFERENCE );
+   _distances = particles->createAttribArray< crimild::Real32 >( ParticleAttrib::SORT_REFERENCE );
 }
 
 void CameraSortParticleUpdater::update( Node *node, double dt, ParticleData *particles )
 {
-   /*
-       const auto camera = Camera::getMainCamera();
-       auto cameraPos = camera->getWorld().getTranslate();
-       auto cameraDirection = camera->getWorld().computeDirection();
-       if ( !particles->shouldComputeInWorldSpace() ) {
-               // compute local camera pos only if we're not using
-               // the world space
-               node->getWorld().applyInverseToPoint( cameraPos, cameraPos );
-               node->getWorld().applyInverseToVector( cameraDirection, cameraDirection );
-       }
-
-       const auto pCount = particles->getAliveCount();
+   auto camera = _camera;
+   if ( camera == nullptr && Simulation::getInstance() != nullptr ) {
+      camera = Simulation::getInstance()->getMainCamera();
+   }
 
-       const auto ps = _positions->getData< Vector3f >();
-   auto ds = _distances->getData< Vector2f >();
+   if ( camera == nullptr ) {
+      return;
+   }
 
-       const auto cameraPlane = Plane3f( cameraDirection, cameraPos );
+   // Indices must refer to alive particles only
+   particles->compact();
 
-   // Step 1: Precompute distances to camera plane for each particle
-   for ( crimild::Size i = 0; i < pCount; ++i ) {
-       ds[ i ] = Vector2f( Distance::compute( cameraPlane, ps[ i ] ), i );
+   auto cameraPos = camera->getWorld().translate;
+   auto cameraDirection = forward( camera->getWorld() );
+   if ( !particles->shouldComputeInWorldSpace() && node != nullptr ) {
+      // compute local camera pos only if we're not using
+      // the world space
+      const auto invWorld = inverse( node->getWorld() );
+      cameraPos = invWorld( cameraPos );
+      cameraDirection = invWorld( cameraDirection );
    }
 
-   // Step 2: Sort particle indices using distances
-   std::sort( ds, ds + pCount, []( const Vector2f &a, const Vector2f &b ) {
-       return a.x() > b.x();
-   });
+   // Farther particles have larger depths, so negate them to draw them first:
+   // key = -dot( p - cameraPos, cameraDirection )
+   const auto axis = Vector3f {
+      -cameraDirection.x,
+      -cameraDirection.y,
+      -cameraDirection.z,
+   };
+   const auto offset = cameraPos.x * cameraDirection.x + cameraPos.y * cameraDirection.y + cameraPos.z * cameraDirection.z;
 
-   // Step 3: reorder
-   for ( crimild::Size i = 0; i < pCount; ++i ) {
-       crimild::Size d = ds[ i ].y();
-       // The trick here is that we only need to swap if the index is
-       // greater than the current one, since it only need to reorder
-       // half of the collection.
-       if ( d > i ) {
-           particles->swap( d, i );
-       }
-   }
-   */
+   const auto count = particles->getAliveCount();
+   auto keys = _distances->getData< crimild::Real32 >();
+   particles::computeSortKeys( _positions, keys, axis, offset, count );
+   particles->sort( keys );
 }
 
 void CameraSortParticleUpdater::encode( coding::Encoder &encoder )
@@ -32,13 +32,23 @@
 
 namespace crimild {
 
+	class Camera;
+
 	/**
 	   \brief Sort particles by their position from the camera
 
 	   Sorting particles is not always required (i.e. particles with depth
 	   buffer disabled).
 
-	   \remarks Use it after a position updater
+	   Keys are computed as the view-space depth of each particle and stored in
+	   the SORT_REFERENCE attribute. Particles are then sorted back to front using
+	   a radix sort, which only produces the order in which they should be drawn.
+	   Attribute data is not moved.
+
+	   \remarks Use it as the last updater, since it removes dead particles first
+	   so the resulting order is still valid when rendering.
+
+	   \see ParticleData::getSortedIndices
 	 */
     class CameraSortParticleUpdater : public ParticleSystemComponent::ParticleUpdater {
         CRIMILD_IMPLEMENT_RTTI( crimild::CameraSortParticleUpdater )
@@ -47,10 +57,16 @@ namespace crimild {
         CameraSortParticleUpdater( void );
         virtual ~CameraSortParticleUpdater( void );
 
+        /**
+           \brief Camera used for sorting. If null, the simulation's main camera is used instead
+         */
+        inline void setCamera( Camera *camera ) { _camera = camera; }
+
         virtual void configure( Node *node, ParticleData *particles ) override;
         virtual void update( Node *node, crimild::Real64 dt, ParticleData *particles ) override;
         
     private:
+        Camera *_camera = nullptr;
         ParticleAttribArray *_positions = nullptr;
         ParticleAttribArray *_distances = nullptr;
 
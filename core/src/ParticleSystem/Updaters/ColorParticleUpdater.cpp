@@ -27,6 +27,8 @@
 
 #include "ColorParticleUpdater.hpp"
 
+#include "../ParticleKernels.hpp"
+
 using namespace crimild;
 
 ColorParticleUpdater::ColorParticleUpdater( void )
@@ -48,26 +50,43 @@ void ColorParticleUpdater::configure( Node *node, ParticleData *particles )
 
 void ColorParticleUpdater::update( Node *node, double dt, ParticleData *particles )
 {
-   /*
-       const auto count = particles->getAliveCount();
+   const auto count = particles->getAliveCount();
+
+   const auto timeData = _times->getData< crimild::Real32 >();
+   const auto lifetimeData = _lifetimes->getData< crimild::Real32 >();
+
+   if ( _startColors->getLaneCount() == 4 && _endColors->getLaneCount() == 4 && _colors->getLaneCount() == 4 ) {
+      const crimild::Real32 *startData[ 4 ];
+      const crimild::Real32 *endData[ 4 ];
+      crimild::Real32 *colorData[ 4 ];
+      for ( crimild::Size i = 0; i < 4; ++i ) {
+         startData[ i ] = static_cast< ParticleLaneArray * >( _startColors )->getLane( i );
+         endData[ i ] = static_cast< ParticleLaneArray * >( _endColors )->getLane( i );
+         colorData[ i ] = static_cast< ParticleLaneArray * >( _colors )->getLane( i );
+      }
 
-       auto startData = _startColors->getData< ColorRGBA >();
-       auto endData = _endColors->getData< ColorRGBA >();
-       auto colorData = _colors->getData< ColorRGBA >();
-       auto timeData = _times->getData< crimild::Real32 >();
-       auto lifetimeData = _lifetimes->getData< crimild::Real32 >();
+      particles::forEachChunk(
+         count,
+         [ & ]( crimild::Size begin, crimild::Size end ) {
+            particles::lerpByAge( colorData, startData, endData, 4, timeData, lifetimeData, begin, end );
+         }
+      );
+      return;
+   }
 
-       for ( crimild::Size i = 0; i < count; i++ ) {
-               const auto s0 = startData[ i ];
-               const auto s1 = endData[ i ];
+   assert( _startColors->getLaneCount() == 0 && _endColors->getLaneCount() == 0 && _colors->getLaneCount() == 0 );
+   static_assert( sizeof( ColorRGBA ) == 4 * sizeof( crimild::Real32 ) );
 
-               const auto t = 1.0f - ( timeData[ i ] / lifetimeData[ i ] );
+   const auto startData = reinterpret_cast< const crimild::Real32 * >( _startColors->getData< ColorRGBA >() );
+   const auto endData = reinterpret_cast< const crimild::Real32 * >( _endColors->getData< ColorRGBA >() );
+   auto colorData = reinterpret_cast< crimild::Real32 * >( _colors->getData< ColorRGBA >() );
 
-               ColorRGBA c;
-               Interpolation::linear( s0, s1, t, c );
-               colorData[ i ] = c;
-       }
-   */
+   particles::forEachChunk(
+      count,
+      [ & ]( crimild::Size begin, crimild::Size end ) {
+         particles::lerpByAge4( colorData, startData, endData, timeData, lifetimeData, begin, end );
+      }
+   );
 }
 
 void ColorParticleUpdater::encode( coding::Encoder &encoder )
@@ -27,6 +27,8 @@
 
 #include "EulerParticleUpdater.hpp"
 
+#include "../ParticleKernels.hpp"
+
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
 
@@ -50,42 +52,53 @@ void EulerParticleUpdater::configure( Node *node, ParticleData *particles )
 
 void EulerParticleUpdater::update( Node *node, crimild::Real64 dt, ParticleData *particles )
 {
-   /*
-       const auto count = particles->getAliveCount();
-
-       const auto g = dt * _globalAcceleration;
-
-       auto as = _accelerations->getData< Vector3f >();
-       auto vs = _velocities->getData< Vector3f >();
-       auto ps = _positions->getData< Vector3f >();
-
-   crimild::Size itemsPerCacheLine = 64 / sizeof( crimild::Real32 );
-
-       // TODO: all the accelerations are the same value
-       // I think this could be optimized, but other
-       // updaters may need separated values
-       // Also, accelerations are handled in the same way
-       // regardless of the computation space (world or local)
-   for ( crimild::Size i = 0; i < count; i += itemsPerCacheLine ) {
-       for ( crimild::Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
-           as[ j ] += g;
-       }
-       }
-
-       // Velocities are handled in the same way
-       // regardless of the computation space (world or local)
-   for ( crimild::Size i = 0; i < count; i += itemsPerCacheLine ) {
-       for ( crimild::Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
-           vs[ j ] += dt * as[ j ];
-       }
-       }
-
-   for ( crimild::Size i = 0; i < count; i += itemsPerCacheLine ) {
-       for ( crimild::Size j = i; j < std::min( count, i + itemsPerCacheLine ); j++ ) {
-           ps[ j ] += dt * vs[ j ];
-       }
-       }
-   */
+   const auto count = particles->getAliveCount();
+   const auto h = crimild::Real32( dt );
+   const auto g = h * _globalAcceleration;
+
+   // Accelerations and velocities are handled in the same way
+   // regardless of the computation space (world or local)
+
+   if ( _positions->getLaneCount() == 3 && _velocities->getLaneCount() == 3 && _accelerations->getLaneCount() == 3 ) {
+      auto as = static_cast< ParticleLaneArray * >( _accelerations );
+      auto vs = static_cast< ParticleLaneArray * >( _velocities );
+      auto ps = static_cast< ParticleLaneArray * >( _positions );
+
+      particles::forEachChunk(
+         count,
+         [ & ]( crimild::Size begin, crimild::Size end ) {
+            for ( crimild::Size i = 0; i < 3; ++i ) {
+               particles::add( as->getLane( i ), g[ i ], begin, end );
+               particles::addScaled( vs->getLane( i ), as->getLane( i ), h, begin, end );
+               particles::addScaled( ps->getLane( i ), vs->getLane( i ), h, begin, end );
+            }
+         }
+      );
+      return;
+   }
+
+   assert( _positions->getLaneCount() == 0 && _velocities->getLaneCount() == 0 && _accelerations->getLaneCount() == 0 );
+
+   auto as = _accelerations->getData< Vector3f >();
+   auto vs = _velocities->getData< Vector3f >();
+   auto ps = _positions->getData< Vector3f >();
+
+   // Interleaved data is processed as flat float arrays
+   static_assert( sizeof( Vector3f ) == 3 * sizeof( crimild::Real32 ) );
+   auto af = reinterpret_cast< crimild::Real32 * >( as );
+   auto vf = reinterpret_cast< crimild::Real32 * >( vs );
+   auto pf = reinterpret_cast< crimild::Real32 * >( ps );
+
+   particles::forEachChunk(
+      count,
+      [ & ]( crimild::Size begin, crimild::Size end ) {
+         for ( auto i = begin; i < end; ++i ) {
+            as[ i ] += g;
+         }
+         particles::addScaled( vf, af, h, 3 * begin, 3 * end );
+         particles::addScaled( pf, vf, h, 3 * begin, 3 * end );
+      }
+   );
 }
 
 void EulerParticleUpdater::encode( coding::Encoder &encoder )
@@ -63,6 +63,13 @@ namespace crimild {
       {
          const auto count = particles->getAliveCount();
 
+         if ( _attribData->getLaneCount() > 0 ) {
+            for ( crimild::Size i = 0; i < count; i++ ) {
+               _attribData->set( i, _value );
+            }
+            return;
+         }
+
          auto as = _attribData->getData< T >();
 
          for ( int i = 0; i < count; i++ ) {
@@ -27,6 +27,8 @@
 
 #include "TimeParticleUpdater.hpp"
 
+#include "../ParticleKernels.hpp"
+
 using namespace crimild;
 
 TimeParticleUpdater::TimeParticleUpdater( void )
@@ -49,15 +51,21 @@ void TimeParticleUpdater::update( Node *node, double dt, ParticleData *particles
 {
 	const auto count = particles->getAliveCount();
 
+	// Single-lane arrays have the same layout as an array of Real32
 	auto ts = _times->getData< crimild::Real32 >();
 	assert( ts != nullptr );
 
-	for ( int i = 0; i < count; i++ ) {
-		ts[ i ] -= dt;
-		if ( ts[ i ] <= 0.0f ) {
-			particles->kill( i );
+	const auto h = crimild::Real32( dt );
+	auto mask = particles->getDeathMask();
+	particles::forEachChunk(
+		count,
+		[ ts, h, mask ]( crimild::Size begin, crimild::Size end ) {
+			particles::add( ts, -h, begin, end );
+			particles::markLessEqual( mask, ts, 0.0f, begin, end );
 		}
-	}
+	);
+
+	// Expired particles are removed in bulk by ParticleData::compact()
 }
 
 void TimeParticleUpdater::encode( coding::Encoder &encoder ) 
@@ -33,7 +33,9 @@
 namespace crimild {
 
 	/**
-	   Updates the time of particle. Kills it if it's time is over
+	   Updates the time of particle. Marks it as dead if it's time is over
+
+	   \see ParticleData::compact
 	 */
     class TimeParticleUpdater : public ParticleSystemComponent::ParticleUpdater {
         CRIMILD_IMPLEMENT_RTTI( crimild::TimeParticleUpdater )
@@ -27,7 +27,7 @@
 
 #include "ZSortParticleUpdater.hpp"
 
-#include "SceneGraph/Camera.hpp"
+#include "../ParticleKernels.hpp"
 
 using namespace crimild;
 
@@ -42,38 +42,18 @@ ZSortParticleUpdater::~ZSortParticleUpdater( void )
 void ZSortParticleUpdater::configure( Node *node, ParticleData *particles )
 {
    _positions = particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
-   _distances = particles->createAttribArray< Vector2f >( ParticleAttrib::SORT_REFERENCE );
+   _distances = particles->createAttribArray< crimild::Real32 >( ParticleAttrib::SORT_REFERENCE );
 }
 
 void ZSortParticleUpdater::update( Node *node, double dt, ParticleData *particles )
 {
-   /*
-       const auto pCount = particles->getAliveCount();
+   // Indices must refer to alive particles only
+   particles->compact();
 
-       const auto ps = _positions->getData< Vector3f >();
-   const auto ds = _distances->getData< Vector2f >();
-
-   // Step 1: Get z values form particles
-   for ( crimild::Size i = 0; i < pCount; ++i ) {
-       ds[ i ] = Vector2f( ps[ i ].z(), i );
-   }
-
-   // Step 2: Sort particle indices using distances
-   std::sort( ds, ds + pCount, []( const Vector2f &a, const Vector2f &b ) {
-       return a.x() < b.x();
-   });
-
-   // Step 3: reorder
-   for ( crimild::Size i = 0; i < pCount; ++i ) {
-       crimild::Size d = ds[ i ].y();
-       // The trick here is that we only need to swap if the index is
-       // greater than the current one, since it only need to reorder
-       // half of the collection.
-       if ( d > i ) {
-           particles->swap( d, i );
-       }
-   }
-   */
+   const auto count = particles->getAliveCount();
+   auto keys = _distances->getData< crimild::Real32 >();
+   particles::computeSortKeys( _positions, keys, Vector3f { 0, 0, 1 }, 0, count );
+   particles->sort( keys );
 }
 
 void ZSortParticleUpdater::encode( coding::Encoder &encoder )
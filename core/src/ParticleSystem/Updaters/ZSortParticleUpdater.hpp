@@ -38,7 +38,12 @@ namespace crimild {
 	   Sorting particles is not always required (i.e. particles with depth
 	   buffer disabled).
 
-	   \remarks Use it after a position updater
+	   Particle data is not moved. Instead, the resulting order is stored in
+	   ParticleData and used by renderers.
+
+	   \remarks Use it as the last updater, after any position updater
+
+	   \see CameraSortParticleUpdater
 	 */
     class ZSortParticleUpdater : public ParticleSystemComponent::ParticleUpdater {
         CRIMILD_IMPLEMENT_RTTI( crimild::ZSortParticleUpdater )
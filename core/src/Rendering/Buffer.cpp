@@ -36,6 +36,13 @@ void Buffer::encode( coding::Encoder &encoder )
 {
    Codable::encode( encoder );
 
+   if ( isExternal() ) {
+      // External memory is encoded as a copy, so decoded buffers own their data
+      ByteArray data( m_externalSize, m_externalData );
+      encoder.encode( "data", data );
+      return;
+   }
+
    encoder.encode( "data", m_data );
 }
 
@@ -43,5 +50,21 @@ void Buffer::decode( coding::Decoder &decoder )
 {
    Codable::decode( decoder );
 
+   // Reference data in place when the decoder supports it (i.e. mapped binary files),
+   // keeping the underlying storage alive for as long as this buffer exists
+   Byte *data = nullptr;
+   Size size = 0;
+   std::shared_ptr< const void > owner;
+   if ( decoder.decodeInPlace( "data", data, size, owner ) && data != nullptr && size > 0 ) {
+      m_data = ByteArray();
+      m_externalData = data;
+      m_externalSize = size;
+      m_externalOwner = std::move( owner );
+      return;
+   }
+
    decoder.decode( "data", m_data );
+   m_externalData = nullptr;
+   m_externalSize = 0;
+   m_externalOwner = nullptr;
 }
@@ -34,6 +34,7 @@
 #include <crimild/coding/Codable.hpp>
 #include <crimild/foundation.hpp>
 #include <cstring>
+#include <memory>
 
 namespace crimild {
 
@@ -78,25 +79,50 @@ namespace crimild {
          memcpy( &m_data[ 0 ], &data, m_data.size() );
       }
 
+      /**
+         \brief Initialize buffer referencing external memory
+
+         No data is copied and the buffer does not own the memory, which must
+         outlive it. This is usually used for streaming data that is already
+         laid out the way render devices expect it (i.e. particle attributes).
+
+         \param owner (optional) Object keeping the memory alive (i.e. a mapped
+         file). The buffer holds a reference to it until destroyed.
+       */
+      Buffer( crimild::Byte *data, crimild::Size size, std::shared_ptr< const void > owner = nullptr ) noexcept
+         : m_externalData( data ),
+           m_externalSize( size ),
+           m_externalOwner( std::move( owner ) )
+      {
+      }
+
       virtual ~Buffer( void ) = default;
 
+      /**
+         \brief Indicates if this buffer references memory it does not own
+       */
+      inline crimild::Bool isExternal( void ) const noexcept { return m_externalData != nullptr; }
+
       /**
          \brief Get size of buffer in bytes
        */
-      inline crimild::Size getSize( void ) const noexcept { return m_data.size(); }
+      inline crimild::Size getSize( void ) const noexcept { return isExternal() ? m_externalSize : m_data.size(); }
 
       /**
          \brief Get raw data
        */
-      inline crimild::Byte *getData( void ) noexcept { return m_data.getData(); }
+      inline crimild::Byte *getData( void ) noexcept { return isExternal() ? m_externalData : m_data.getData(); }
 
       /**
          \brief Get raw data
        */
-      inline const crimild::Byte *getData( void ) const noexcept { return m_data.getData(); }
+      inline const crimild::Byte *getData( void ) const noexcept { return isExternal() ? m_externalData : m_data.getData(); }
 
    private:
       ByteArray m_data;
+      crimild::Byte *m_externalData = nullptr;
+      crimild::Size m_externalSize = 0;
+      std::shared_ptr< const void > m_externalOwner;
 
       /**
        * \name FrameGraphResource impl
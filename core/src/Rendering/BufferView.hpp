@@ -129,6 +129,15 @@ namespace crimild {
        */
       inline void setLength( Size length ) noexcept { m_length = length; }
 
+      /**
+         \brief Get the maximum length in bytes this view can grow to
+
+         That is, the number of bytes from the offset to the end of the buffer.
+         Render devices use it to allocate memory for dynamic views whose length
+         changes over time.
+       */
+      inline crimild::Size getCapacity( void ) const noexcept { return m_buffer != nullptr ? m_buffer->getSize() - m_offset : m_length; }
+
       /**
          \brief Get count of elements
        */
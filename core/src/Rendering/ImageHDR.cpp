@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/ImageHDR.hpp"
+
+#include "Rendering/BufferView.hpp"
+#include "Rendering/Image.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace crimild;
+
+namespace crimild::utils::impl {
+
+   /**
+      \brief Both PFM (with a negative scale) and EXR store values in little endian
+    */
+   class LittleEndianWriter {
+   public:
+      inline void write( UInt8 value ) noexcept { m_bytes.push_back( value ); }
+
+      inline void write( Int32 value ) noexcept { write( UInt32( value ) ); }
+
+      void write( UInt32 value ) noexcept
+      {
+         for ( auto i = 0; i < 4; ++i ) {
+            m_bytes.push_back( UInt8( value >> ( 8 * i ) ) );
+         }
+      }
+
+      void write( UInt64 value ) noexcept
+      {
+         for ( auto i = 0; i < 8; ++i ) {
+            m_bytes.push_back( UInt8( value >> ( 8 * i ) ) );
+         }
+      }
+
+      void write( Real32 value ) noexcept
+      {
+         UInt32 bits;
+         std::memcpy( &bits, &value, sizeof( bits ) );
+         write( bits );
+      }
+
+      /**
+         \brief Writes a null-terminated string
+       */
+      void write( const char *str ) noexcept
+      {
+         m_bytes.insert( m_bytes.end(), str, str + std::strlen( str ) + 1 );
+      }
+
+      inline void patch( Size offset, UInt64 value ) noexcept
+      {
+         for ( auto i = 0; i < 8; ++i ) {
+            m_bytes[ offset + i ] = UInt8( value >> ( 8 * i ) );
+         }
+      }
+
+      inline Size getSize( void ) const noexcept { return m_bytes.size(); }
+
+      Bool save( const std::filesystem::path &path, const std::string &header = "" ) const noexcept
+      {
+         std::ofstream out( path, std::ios::binary );
+         if ( !out.is_open() ) {
+            CRIMILD_LOG_ERROR( "Cannot open file for writing: ", path.string() );
+            return false;
+         }
+         out.write( header.data(), header.size() );
+         out.write( reinterpret_cast< const char * >( m_bytes.data() ), m_bytes.size() );
+         return out.good();
+      }
+
+   private:
+      std::vector< UInt8 > m_bytes;
+   };
+
+   static const Real32 *getPixels( const Image *image ) noexcept
+   {
+      if ( image == nullptr || image->getBufferView() == nullptr ) {
+         CRIMILD_LOG_ERROR( "Invalid image" );
+         return nullptr;
+      }
+
+      if ( image->format != Format::R32G32B32A32_SFLOAT || image->type != Image::Type::IMAGE_2D ) {
+         CRIMILD_LOG_ERROR( "Unsupported image format. Only 2D images with R32G32B32A32_SFLOAT pixels can be written as HDR" );
+         return nullptr;
+      }
+
+      const auto width = Size( image->extent.width );
+      const auto height = Size( image->extent.height );
+      if ( width == 0 || height == 0 || image->getBufferView()->getLength() < width * height * 4 * sizeof( Real32 ) ) {
+         CRIMILD_LOG_ERROR( "Image data does not match its extent" );
+         return nullptr;
+      }
+
+      return reinterpret_cast< const Real32 * >( image->getBufferView()->getData() );
+   }
+
+   static void writeAttribute( LittleEndianWriter &out, const char *name, const char *type, UInt32 size ) noexcept
+   {
+      out.write( name );
+      out.write( type );
+      out.write( size );
+   }
+
+}
+
+Bool utils::writePFM( const Image *image, const std::filesystem::path &path ) noexcept
+{
+   const auto pixels = impl::getPixels( image );
+   if ( pixels == nullptr ) {
+      return false;
+   }
+
+   const auto width = UInt32( image->extent.width );
+   const auto height = UInt32( image->extent.height );
+
+   // A negative scale means little endian. Rows are stored from bottom to top
+   const auto header = "PF\n" + std::to_string( width ) + " " + std::to_string( height ) + "\n-1.0\n";
+
+   impl::LittleEndianWriter out;
+   for ( auto y = height; y > 0; --y ) {
+      const auto row = pixels + Size( y - 1 ) * width * 4;
+      for ( UInt32 x = 0; x < width; ++x ) {
+         out.write( row[ x * 4 + 0 ] );
+         out.write( row[ x * 4 + 1 ] );
+         out.write( row[ x * 4 + 2 ] );
+      }
+   }
+
+   return out.save( path, header );
+}
+
+Bool utils::writeEXR( const Image *image, const std::filesystem::path &path ) noexcept
+{
+   const auto pixels = impl::getPixels( image );
+   if ( pixels == nullptr ) {
+      return false;
+   }
+
+   const auto width = UInt32( image->extent.width );
+   const auto height = UInt32( image->extent.height );
+
+   // Channels must be sorted by name
+   constexpr const char *CHANNEL_NAMES[] = { "B", "G", "R" };
+   constexpr UInt32 CHANNEL_OFFSETS[] = { 2, 1, 0 };
+   constexpr UInt32 CHANNEL_COUNT = 3;
+   constexpr Int32 PIXEL_TYPE_FLOAT = 2;
+
+   impl::LittleEndianWriter out;
+
+   // Magic number and version (2, single-part scanline)
+   out.write( UInt32( 20000630 ) );
+   out.write( UInt32( 2 ) );
+
+   impl::writeAttribute( out, "channels", "chlist", CHANNEL_COUNT * ( 2 + 16 ) + 1 );
+   for ( const auto name : CHANNEL_NAMES ) {
+      out.write( name );
+      out.write( PIXEL_TYPE_FLOAT );
+      // pLinear and reserved bytes
+      out.write( UInt32( 0 ) );
+      // x and y sampling
+      out.write( Int32( 1 ) );
+      out.write( Int32( 1 ) );
+   }
+   out.write( UInt8( 0 ) );
+
+   impl::writeAttribute( out, "compression", "compression", 1 );
+   out.write( UInt8( 0 ) );
+
+   for ( const auto name : { "dataWindow", "displayWindow" } ) {
+      impl::writeAttribute( out, name, "box2i", 16 );
+      out.write( Int32( 0 ) );
+      out.write( Int32( 0 ) );
+      out.write( Int32( width - 1 ) );
+      out.write( Int32( height - 1 ) );
+   }
+
+   // Increasing Y, so the first scanline is the top of the image
+   impl::writeAttribute( out, "lineOrder", "lineOrder", 1 );
+   out.write( UInt8( 0 ) );
+
+   impl::writeAttribute( out, "pixelAspectRatio", "float", 4 );
+   out.write( Real32( 1 ) );
+
+   impl::writeAttribute( out, "screenWindowCenter", "v2f", 8 );
+   out.write( Real32( 0 ) );
+   out.write( Real32( 0 ) );
+
+   impl::writeAttribute( out, "screenWindowWidth", "float", 4 );
+   out.write( Real32( 1 ) );
+
+   // End of header
+   out.write( UInt8( 0 ) );
+
+   // Uncompressed files store one scanline per block. Offsets are filled in later
+   const auto offsetTable = out.getSize();
+   for ( UInt32 y = 0; y < height; ++y ) {
+      out.write( UInt64( 0 ) );
+   }
+
+   const auto blockSize = UInt32( width * CHANNEL_COUNT * sizeof( Real32 ) );
+   for ( UInt32 y = 0; y < height; ++y ) {
+      out.patch( offsetTable + y * sizeof( UInt64 ), UInt64( out.getSize() ) );
+      out.write( Int32( y ) );
+      out.write( blockSize );
+      const auto row = pixels + Size( y ) * width * 4;
+      for ( const auto offset : CHANNEL_OFFSETS ) {
+         for ( UInt32 x = 0; x < width; ++x ) {
+            out.write( row[ x * 4 + offset ] );
+         }
+      }
+   }
+
+   return out.save( path );
+}
+
+Bool utils::writeHDR( const Image *image, const std::filesystem::path &path ) noexcept
+{
+   auto extension = path.extension().string();
+   std::transform( extension.begin(), extension.end(), extension.begin(), []( auto c ) { return std::tolower( c ); } );
+   if ( extension == ".exr" ) {
+      return writeEXR( image, path );
+   }
+   return writePFM( image, path );
+}
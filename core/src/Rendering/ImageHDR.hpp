@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_RENDERING_IMAGE_HDR_
+#define CRIMILD_RENDERING_IMAGE_HDR_
+
+#include <crimild/foundation.hpp>
+#include <filesystem>
+
+namespace crimild {
+
+   class Image;
+
+   namespace utils {
+
+      /**
+         \brief Writes HDR images to disk
+
+         Only 2D images with R32G32B32A32_SFLOAT pixels are supported, which is the
+         format used by the soft ray tracer. Pixels are stored in linear space and the
+         first row is the top of the image. Alpha is discarded.
+       */
+      //@{
+
+      /**
+         \brief Writes an image as PFM (Portable Float Map), with three channels
+       */
+      [[nodiscard]] Bool writePFM( const Image *image, const std::filesystem::path &path ) noexcept;
+
+      /**
+         \brief Writes an image as an uncompressed, single-part scanline OpenEXR file
+
+         Channels are stored as 32-bit floats.
+       */
+      [[nodiscard]] Bool writeEXR( const Image *image, const std::filesystem::path &path ) noexcept;
+
+      /**
+         \brief Writes an image either as EXR or PFM, based on the extension of the path
+       */
+      [[nodiscard]] Bool writeHDR( const Image *image, const std::filesystem::path &path ) noexcept;
+
+      //@}
+
+   }
+
+}
+
+#endif
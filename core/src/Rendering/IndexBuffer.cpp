@@ -37,6 +37,17 @@ IndexBuffer::IndexBuffer( Format format, crimild::Size count ) noexcept
 {
 }
 
+IndexBuffer::IndexBuffer( Format format, SharedPointer< BufferView > const &bufferView ) noexcept
+   : m_format( format ),
+     m_bufferView( bufferView )
+{
+   m_accessor = crimild::alloc< BufferAccessor >(
+      m_bufferView,
+      0,
+      utils::getFormatSize( format )
+   );
+}
+
 void IndexBuffer::encode( coding::Encoder &encoder )
 {
    Entity::encode( encoder );
@@ -76,6 +76,13 @@ namespace crimild {
          );
       }
 
+      /**
+         \brief Creates an index buffer from a buffer view
+
+         \remarks The view's stride must match the size of the index format
+       */
+      IndexBuffer( Format format, SharedPointer< BufferView > const &bufferView ) noexcept;
+
       virtual ~IndexBuffer( void ) = default;
 
       inline Format getFormat( void ) const noexcept
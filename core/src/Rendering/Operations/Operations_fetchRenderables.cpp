@@ -25,18 +25,15 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "Components/MaterialComponent.hpp"
-#include "Rendering/DescriptorSet.hpp"
-#include "Rendering/Material.hpp"
 #include "Rendering/Operations/OperationUtils.hpp"
 #include "Rendering/Operations/Operations.hpp"
-#include "Rendering/Pipeline.hpp"
+#include "Rendering/RenderableExtractor.hpp"
 #include "Rendering/RenderableSet.hpp"
 #include "Rendering/ScenePass.hpp"
 #include "SceneGraph/Camera.hpp"
-#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/SceneIndex.hpp"
+#include "Simulation/FramePipeline.hpp"
 #include "Simulation/Simulation.hpp"
-#include "Visitors/ApplyToGeometries.hpp"
 
 using namespace crimild;
 
@@ -49,10 +46,16 @@ SharedPointer< FrameGraphOperation > crimild::framegraph::fetchRenderables( void
     auto unlitRenderables = crimild::alloc< RenderableSet >();
     auto envRenderables = crimild::alloc< RenderableSet >();
 
-    fetch->apply = [ litRenderables, unlitRenderables, envRenderables ]( auto, auto ) {
+    // Lit geometries, including the ones outside the camera frustum
+    auto shadowCasters = crimild::alloc< RenderableSet >();
+
+    auto extractor = std::make_shared< RenderableExtractor >();
+
+    fetch->apply = [ litRenderables, unlitRenderables, envRenderables, shadowCasters, extractor ]( auto, auto ) {
         envRenderables->reset();
         litRenderables->reset();
         unlitRenderables->reset();
+        shadowCasters->reset();
 
         // envRenderables->setCamera( Camera::getMainCamera() );
         // litRenderables->setCamera( Camera::getMainCamera() );
@@ -63,39 +66,41 @@ SharedPointer< FrameGraphOperation > crimild::framegraph::fetchRenderables( void
             return false;
         }
 
-        scene->perform(
-            ApplyToGeometries(
-                [ & ]( Geometry *geometry ) {
-                    if ( geometry->getLayer() == Node::Layer::SKYBOX ) {
-                        envRenderables->addGeometry( geometry );
-                    } else if ( auto material = geometry->getComponent< MaterialComponent >()->first() ) {
-                        // TODO: What if there are multiple materials?
-                        // Can we add the same geometry to multiple lists? That will result
-                        // in multiple render passes for a single geometry, but I don't know
-                        // if that's ok.
-                        if ( auto pipeline = material->getGraphicsPipeline() ) {
-                            if ( auto program = crimild::get_ptr( pipeline->getProgram() ) ) {
-                                auto isLit = false;
-                                program->descriptorSetLayouts.each(
-                                    [ & ]( auto layout ) {
-                                        if ( layout->bindings.filter( []( auto &binding ) { return binding.descriptorType == DescriptorType::ALBEDO_MAP; } ).size() > 0 ) {
-                                            isLit = true;
-                                        }
-                                    } );
-                                if ( isLit ) {
-                                    litRenderables->addGeometry( geometry );
-                                } else {
-                                    unlitRenderables->addGeometry( geometry );
-                                }
-                            }
-                        }
-                    }
-                } ) );
+        if ( auto pipeline = Simulation::getInstance()->getFramePipeline() ) {
+            if ( pipeline->isEnabled() ) {
+                // Renderables have already been extracted by the frame pipeline
+                if ( auto snapshot = pipeline->getPublishedSnapshot() ) {
+                    snapshot->litRenderables->eachGeometry( [ & ]( auto geometry ) { litRenderables->addGeometry( geometry ); } );
+                    snapshot->unlitRenderables->eachGeometry( [ & ]( auto geometry ) { unlitRenderables->addGeometry( geometry ); } );
+                    snapshot->envRenderables->eachGeometry( [ & ]( auto geometry ) { envRenderables->addGeometry( geometry ); } );
+
+                    // Snapshots are not culled
+                    snapshot->litRenderables->eachGeometry( [ & ]( auto geometry ) { shadowCasters->addGeometry( geometry ); } );
+                }
+                return true;
+            }
+        }
+
+        auto camera = Simulation::getInstance()->getMainCamera();
+        auto index = Simulation::getInstance()->getSceneIndex();
+        if ( index != nullptr && index->getScene() == scene && index->isCurrent() ) {
+            extractor->extract( index, camera, crimild::get_ptr( litRenderables ), crimild::get_ptr( unlitRenderables ), crimild::get_ptr( envRenderables ), crimild::get_ptr( shadowCasters ) );
+        } else {
+            extractor->extract( scene, camera, crimild::get_ptr( litRenderables ), crimild::get_ptr( unlitRenderables ), crimild::get_ptr( envRenderables ), crimild::get_ptr( shadowCasters ) );
+        }
+
+        if ( auto settings = Simulation::getInstance()->getSettings() ) {
+            const auto &stats = extractor->getStats();
+            settings->set( "stats.renderables.visited", stats.visited );
+            settings->set( "stats.renderables.culled", stats.culled );
+            settings->set( "stats.renderables.emitted", stats.emitted );
+        }
+
         return true;
     };
 
-    fetch->writes( { litRenderables, unlitRenderables, envRenderables } );
-    fetch->produces( { litRenderables, unlitRenderables, envRenderables } );
+    fetch->writes( { litRenderables, unlitRenderables, envRenderables, shadowCasters } );
+    fetch->produces( { litRenderables, unlitRenderables, envRenderables, shadowCasters } );
 
     return fetch;
 }
@@ -31,6 +31,8 @@
 #include "Rendering/Image.hpp"
 #include "Rendering/Materials/PrincipledBSDFMaterial.hpp"
 #include "Rendering/Materials/PrincipledVolumeMaterial.hpp"
+#include "Rendering/RTRandom.hpp"
+#include "Rendering/RTTileScheduler.hpp"
 #include "Rendering/ScenePass.hpp"
 #include "SceneGraph/CSGNode.hpp"
 #include "Simulation/Simulation.hpp"
@@ -38,22 +40,19 @@
 #include "Visitors/FetchCameras.hpp"
 #include "Visitors/IntersectWorld.hpp"
 #include "Visitors/RTAcceleration.hpp"
+#include "Visitors/RTBVH.hpp"
 #include "Visitors/UpdateWorldState.hpp"
 
-#include <crimild/math/Box.hpp>
+#include <atomic>
+#include <chrono>
 #include <crimild/math/Random.hpp>
-#include <crimild/math/Triangle.hpp>
 #include <crimild/math/intersect.hpp>
-#include <crimild/math/inverse.hpp>
 #include <crimild/math/isNaN.hpp>
 #include <crimild/math/reflect.hpp>
 #include <crimild/math/refract.hpp>
-#include <crimild/math/whichSide.hpp>
 
 using namespace crimild;
 
-#define CRIMILD_RT_SAMPLES_PER_FRAME 1
-
 [[nodiscard]] static Real reflectance( Real cosTheta, Real refIdx ) noexcept
 {
    // Use Schlick's approximation for reflectance
@@ -62,310 +61,6 @@ using namespace crimild;
    return rr + ( 1 - rr ) * pow( ( 1 - cosTheta ), 5 );
 }
 
-struct IntersectionResult {
-   Int32 materialId = -1;
-   Real t = numbers::POSITIVE_INFINITY;
-   Point3f point;
-   Normal3 normal;
-   Bool frontFace;
-
-   inline void setFaceNormal( const Ray3 &R, const Normal3 &N ) noexcept
-   {
-      frontFace = dot( direction( R ), N ) < 0;
-      normal = frontFace ? N : -N;
-   }
-};
-
-[[nodiscard]] Bool intersectPrim( const Ray3 &R, const RTAcceleration::Result &scene, Int32 nodeId, Real minT, Real maxT, IntersectionResult &result ) noexcept
-{
-   Bool hasResult = false;
-
-   const auto &node = scene.nodes[ nodeId ];
-   const auto primIdx = node.primitiveIndex;
-   if ( primIdx < 0 ) {
-      return false;
-   }
-
-   struct FrontierNode {
-      Int32 id;
-      Real t0;
-      Real t1;
-   };
-
-   FrontierNode frontier[ 64 ] = { { primIdx, minT, maxT } };
-   Int32 currentIdx = 0;
-
-   while ( currentIdx >= 0 ) {
-      const auto expanded = frontier[ currentIdx-- ];
-      if ( expanded.id < 0 ) {
-         continue;
-      }
-
-      const auto &prim = scene.primitives.primTree[ expanded.id ];
-      if ( prim.isLeaf() ) {
-         const auto idxOffset = prim.primitiveIndicesOffset;
-         const auto primCount = prim.getPrimCount();
-         for ( auto i = 0; i < primCount; ++i ) {
-            const auto baseIdx = scene.primitives.indexOffsets[ idxOffset + i ];
-
-            const auto &v0 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 0 ] ];
-            const auto &v1 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 1 ] ];
-            const auto &v2 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 2 ] ];
-
-            const auto T = Triangle {
-               Point3( v0.position ),
-               Point3( v1.position ),
-               Point3( v2.position ),
-            };
-
-            Real t;
-            // TODO(hernan): Pre-compute inverse world ray to avoid doing it every loop
-            if ( intersect( R, T, node.world, t ) ) {
-               if ( t >= numbers::EPSILON && !isNaN( t ) && !isEqual( t, numbers::POSITIVE_INFINITY ) && ( !hasResult || t < result.t ) ) {
-                  result.t = t;
-                  result.point = R( result.t );
-                  result.setFaceNormal( R, Normal3( v0.normal ) );
-                  result.materialId = node.materialIndex;
-                  hasResult = true;
-               }
-            }
-         }
-      } else {
-         const auto P = Plane3 {
-            [ & ] {
-               auto N = Normal3 { 0, 0, 0 };
-               N[ prim.getSplitAxis() ] = 1;
-               return N;
-            }(),
-            prim.getSplitPos()
-         };
-
-         // TODO: Do this earlier
-         const auto R1 = inverse( node.world )( R );
-
-         Real t;
-         if ( intersect( R1, P, t ) ) {
-            if ( prim.getAboveChild() > ( expanded.id + 1 ) ) {
-               const bool belowFirst = whichSide( P, origin( R1 ) ) < 0;
-               if ( belowFirst ) {
-                  frontier[ ++currentIdx ] = {
-                     prim.getAboveChild(),
-                     t,
-                     expanded.t1,
-                  };
-                  frontier[ ++currentIdx ] = {
-                     expanded.id + 1,
-                     expanded.t0,
-                     t,
-                  };
-               } else {
-                  frontier[ ++currentIdx ] = {
-                     expanded.id + 1,
-                     expanded.t0,
-                     t,
-                  };
-                  frontier[ ++currentIdx ] = {
-                     prim.getAboveChild(),
-                     t,
-                     expanded.t1,
-                  };
-               }
-            } else {
-               // visit first child
-               frontier[ ++currentIdx ] = {
-                  expanded.id + 1,
-                  expanded.t0,
-                  t,
-               };
-            }
-         }
-      }
-   }
-
-   return hasResult;
-}
-
-[[nodiscard]] Bool intersectNR( const Ray3 &R, const RTAcceleration::Result &scene, IntersectionResult &result ) noexcept
-{
-   if ( scene.nodes.empty() ) {
-      return false;
-   }
-
-   Bool hasResult = false;
-
-   Index frontier[ 64 ] = { 0 };
-   Int32 currentIndex = 0;
-
-   auto computeVolume = [ & ]( const auto &node, auto t0, auto t1 ) {
-      const auto &material = scene.materials[ node.materialIndex ];
-      const auto isVolume = material.density >= 0;
-      if ( !isVolume ) {
-         return false;
-      }
-
-      const bool enableDebug = true;
-      const bool debugging = enableDebug && random::next() < 0.00001;
-      if ( debugging )
-         std::cerr << "\nt_min=" << t0 << ", t_max=" << t1 << '\n';
-
-      if ( t0 < 0 ) {
-         t0 = 0;
-      }
-
-      if ( t1 > t0 ) {
-         Real d = length( direction( R ) );
-         Real distanceInsideBoundary = ( t1 - t0 ) * d;
-         Real density = material.density;
-         Real negInvDensity = Real( -1 ) / density;
-         Real hitDistance = negInvDensity * std::log( random::next() );
-         if ( hitDistance <= distanceInsideBoundary ) {
-            Real t = t0 + hitDistance / d;
-            const auto P = R( t );
-
-            if ( debugging ) {
-               std::cerr << "hit_distance = " << hitDistance << '\n'
-                         << "rec.t = " << t << '\n'
-                         << "rec.p = " << P.x << ", " << P.y << ", " << P.z << '\n';
-            }
-
-            result.t = t;
-            result.point = P;
-            result.normal = Normal3 { 1, 0, 0 }; // arbitrary value
-            result.frontFace = true;             // arbitrary value
-            result.materialId = node.materialIndex;
-            hasResult = true;
-         }
-      }
-
-      return true;
-   };
-
-   while ( currentIndex >= 0 ) {
-      const auto nodeIdx = frontier[ currentIndex ];
-      --currentIndex;
-
-      const auto &node = scene.nodes[ nodeIdx ];
-
-      switch ( node.type ) {
-         case RTAcceleratedNode::Type::GROUP: {
-            const auto B = Box {};
-            Real t0, t1;
-            if ( intersect( R, B, node.world, t0, t1 ) ) {
-               // A very simple test: only expand child nodes if the intersection point
-               // is less than the current result. Otherwise, the entire group is occluded
-               // by the current hit and can be safely discarded.
-               if ( !hasResult || t0 <= result.t ) {
-                  if ( node.secondChildIndex > 0 ) {
-                     frontier[ ++currentIndex ] = node.secondChildIndex;
-                  }
-                  frontier[ ++currentIndex ] = nodeIdx + 1;
-               }
-            }
-            break;
-         }
-
-         case RTAcceleratedNode::Type::GEOMETRY: {
-            const auto B = Box {};
-            Real t0, t1;
-            if ( intersect( R, B, node.world, t0, t1 ) ) {
-               // TODO(hernan): when traversing optimized triangles, we need to keep
-               // track of the min/max times for the intersection above.
-               // TODO(hernan): Maybe by keeping track of those values I can also
-               // solve how CSG nodes will be evaluated, since they also need to
-               // save min/max times for intersections.
-               const auto primIdx = nodeIdx + 1;
-               if ( scene.nodes[ primIdx ].type == RTAcceleratedNode::Type::PRIMITIVE_TRIANGLES ) {
-                  if ( intersectPrim( R, scene, primIdx, t0, t1, result ) ) {
-                     hasResult = true;
-                  }
-               } else {
-                  frontier[ ++currentIndex ] = nodeIdx + 1;
-               }
-            }
-            break;
-         }
-
-         case RTAcceleratedNode::Type::PRIMITIVE_SPHERE: {
-            const auto S = Sphere {};
-            Real t0, t1;
-            if ( intersect( R, S, node.world, t0, t1 ) ) {
-               if ( t0 >= numbers::EPSILON && !isEqual( t0, numbers::POSITIVE_INFINITY ) && ( !hasResult || t0 < result.t ) ) {
-                  result.t = t0;
-                  result.point = R( result.t );
-                  result.setFaceNormal( R, normal( S, node.world, result.point ) );
-                  result.materialId = node.materialIndex;
-                  hasResult = true;
-               }
-
-               if ( t1 >= numbers::EPSILON && !isEqual( t1, numbers::POSITIVE_INFINITY ) && ( !hasResult || t1 < result.t ) ) {
-                  result.t = t1;
-                  result.point = R( result.t );
-                  result.setFaceNormal( R, normal( S, node.world, result.point ) );
-                  result.materialId = node.materialIndex;
-                  hasResult = true;
-               }
-            }
-            break;
-         }
-
-         case RTAcceleratedNode::Type::PRIMITIVE_BOX: {
-            const auto B = Box {};
-            Real t0, t1;
-            if ( intersect( R, B, node.world, t0, t1 ) ) {
-               if ( !computeVolume( node, t0, t1 ) ) {
-                  if ( t0 >= numbers::EPSILON && !isEqual( t0, numbers::POSITIVE_INFINITY ) && ( !hasResult || t0 < result.t ) ) {
-                     result.t = t0;
-                     result.point = R( result.t );
-                     result.setFaceNormal( R, normal( B, node.world, result.point ) );
-                     result.materialId = node.materialIndex;
-                     hasResult = true;
-                  }
-
-                  if ( t1 >= numbers::EPSILON && !isEqual( t1, numbers::POSITIVE_INFINITY ) && ( !hasResult || t1 < result.t ) ) {
-                     result.t = t1;
-                     result.point = R( result.t );
-                     result.setFaceNormal( R, normal( B, node.world, result.point ) );
-                     result.materialId = node.materialIndex;
-                     hasResult = true;
-                  }
-               }
-            }
-            break;
-         }
-
-         // case Primitive::Type::OPEN_CYLINDER:
-         case RTAcceleratedNode::Type::PRIMITIVE_CYLINDER: {
-            const auto C = Cylinder { .closed = true };
-            Real t0, t1;
-            if ( intersect( R, C, node.world, t0, t1 ) ) {
-               if ( t0 >= numbers::EPSILON && !isEqual( t0, numbers::POSITIVE_INFINITY ) && ( !hasResult || t0 < result.t ) ) {
-                  result.t = t0;
-                  result.point = R( result.t );
-                  result.setFaceNormal( R, normal( C, node.world, result.point ) );
-                  result.materialId = node.materialIndex;
-                  hasResult = true;
-               }
-
-               if ( t1 >= numbers::EPSILON && !isEqual( t1, numbers::POSITIVE_INFINITY ) && ( !hasResult || t1 < result.t ) ) {
-                  result.t = t1;
-                  result.point = R( result.t );
-                  result.setFaceNormal( R, normal( C, node.world, result.point ) );
-                  result.materialId = node.materialIndex;
-                  hasResult = true;
-               }
-            }
-            break;
-         }
-
-         default: {
-            break;
-         }
-      }
-   }
-
-   return hasResult;
-}
-
 // [[nodiscard]] ColorRGB rayColor( const Ray3 &R, const RTAcceleration::Result &scene, const ColorRGB &backgroundColor, Int32 depth ) noexcept
 // {
 //     auto ret = backgroundColor;
@@ -374,7 +69,7 @@ struct IntersectionResult {
 //         return ColorRGB::Constants::BLACK;
 //     }
 
-//     IntersectionResult result;
+//     RTIntersection result;
 //     if ( intersectR( R, scene, result ) ) {
 //         if ( result.materialId >= 0 ) {
 //             return scene.materials[ result.materialId ].albedo;
@@ -393,8 +88,9 @@ struct IntersectionResult {
    }
 
 #if 1
+   // The index is only used if it was built for this scene
    auto results = IntersectWorld::Results {};
-   scene->perform( IntersectWorld( R, results ) );
+   scene->perform( IntersectWorld( R, results, Simulation::getInstance()->getSceneIndex() ) );
    if ( !results.empty() ) {
       auto res = results.first();
 
@@ -409,8 +105,9 @@ struct IntersectionResult {
 
 #else
 
+   // The index is only used if it was built for this scene
    auto results = IntersectWorld::Results {};
-   scene->perform( IntersectWorld( R, results ) );
+   scene->perform( IntersectWorld( R, results, Simulation::getInstance()->getSceneIndex() ) );
    if ( !results.empty() ) {
       auto res = results.first();
       Ray3 scattered;
@@ -486,11 +183,18 @@ namespace crimild {
     * - Convert the scene to a binary tree
     * - Accelerate the binary tree and transform it into a linear tree
     * - Traverse the tree non-recursively
+    *
+    * Rendering is progressive. Workers get tiles from a scheduler and trace one sample
+    * for each pixel in a tile at a time. Pixels stop receiving samples once they converge
+    * (see rt.adaptive.threshold) and rendering stops once all of them converged.
+    *
+    * Each sample uses its own random sequence (seeded by pixel, sample and bounce), so
+    * results are the same regardless of the number of workers.
+    *
+    * Rendering can be paused/resumed with rt.paused and cancelled with rt.cancel. Stats
+    * are reported every frame as rt.stats.* settings.
     */
    class SoftRT : public ScenePass {
-   private:
-      using Job = std::function< void( void ) >;
-
    public:
       SoftRT( void ) noexcept
       {
@@ -517,6 +221,26 @@ namespace crimild {
 
          m_tileSize = settings->get< Int32 >( "rt.tile_size", 64 );
 
+         // Disable to traverse the binary tree produced by RTAcceleration instead
+         m_useBVH = settings->get< Bool >( "rt.bvh", true );
+
+         // Either "scalar" (one ray at a time) or "stream" (packets of rays per tile). Streams require the BVH.
+         m_useStreams = settings->get< std::string >( "rt.tracing", "scalar" ) == "stream";
+         if ( m_useStreams && !m_useBVH ) {
+            CRIMILD_LOG_WARNING( "Stream tracing requires rt.bvh. Using scalar tracing instead" );
+            m_useStreams = false;
+         }
+
+         m_tileOrder = settings->get< Bool >( "rt.use_scanline", true ) ? RTTileScheduler::Order::SCANLINE : RTTileScheduler::Order::SPIRAL;
+
+         // Pixels stop receiving samples once the relative error of their mean luminance
+         // is below the threshold, or after reaching the maximum number of samples.
+         // Set the threshold to zero to disable adaptive sampling.
+         m_minSamples = std::max( 1, settings->get< Int32 >( "rt.samples.min", 16 ) );
+         m_maxSamples = std::max( m_minSamples, settings->get< Int32 >( "rt.samples.max", 5000 ) );
+         m_threshold = settings->get< Real >( "rt.adaptive.threshold", 0.01f );
+         m_seed = settings->get< UInt32 >( "rt.seed", 0 );
+
          m_image = crimild::alloc< Image >();
          m_image->extent = Extent3D {
             .width = Real32( m_width ),
@@ -534,8 +258,6 @@ namespace crimild {
 
          m_imageAaccessor = crimild::alloc< BufferAccessor >( m_image->getBufferView(), 0, sizeof( ColorRGBA ) );
 
-         m_progress = m_width * m_height;
-
          settings->set( "rt.samples.count", 0 );
 
          writes( { m_image } );
@@ -545,12 +267,7 @@ namespace crimild {
       virtual ~SoftRT( void ) noexcept
       {
          m_running = false;
-
-         // clear all pending jobs
-         // m_jobs.clear();
-
-         // wait for workers
-         // reset();
+         m_scheduler.cancel();
 
          for ( auto &w : m_workers ) {
             w.join();
@@ -560,6 +277,13 @@ namespace crimild {
       }
 
    private:
+      /**
+         \brief Samples bouncing more than this are discarded
+
+         It might indicate that no light (or only a tiny bit of it) reaches that point.
+       */
+      static constexpr Int32 MAX_BOUNCES = 50;
+
       // Maybe rename to SampleInfo?
       struct RayInfo {
          Ray3 ray;
@@ -568,6 +292,25 @@ namespace crimild {
          Vector2 uv;
          Int32 bounces;
          Int32 samples;
+
+         /**
+            \brief Running mean and sum of squared differences for the luminance of all samples (Welford)
+          */
+         //@{
+         Real mean = 0;
+         Real m2 = 0;
+         //@}
+
+         Bool converged = false;
+      };
+
+      /**
+         \brief Work done while rendering a tile
+       */
+      struct TileResult {
+         UInt64 rays = 0;
+         UInt64 samples = 0;
+         Bool converged = true;
       };
 
       std::vector< RayInfo > m_rays;
@@ -590,10 +333,22 @@ namespace crimild {
             }
          }
 
-         // TODO(hernan): Add a setting for suffling rays.
-         if ( getSettings()->get< Bool >( "rt.shuffle", true ) ) {
-            std::shuffle( m_rays.begin(), m_rays.end(), random::defaultGenerator() );
-         }
+      }
+
+      /**
+         \brief Rays are stored in scanline order
+       */
+      [[nodiscard]] inline UInt32 getPixelIndex( const RayInfo &rayInfo ) const noexcept
+      {
+         return UInt32( &rayInfo - m_rays.data() );
+      }
+
+      /**
+         \brief Restarts the random sequence for the current bounce of a sample
+       */
+      inline void seedRandom( const RayInfo &rayInfo, UInt64 stream = 0 ) noexcept
+      {
+         RTRandom::getInstance().seed( m_seed, getPixelIndex( rayInfo ), UInt32( rayInfo.samples ), UInt32( rayInfo.bounces ), stream );
       }
 
       [[nodiscard]] inline Settings *getSettings( void ) noexcept
@@ -606,9 +361,20 @@ namespace crimild {
          // Check for NaN values before accumulating color. That way
          // we avoid "dead" pixels (either black or white) due to
          // invalid values.
-         rayInfo.accumColor = rayInfo.accumColor + ( isNaN( rayInfo.sampleColor ) ? ColorRGB { 0, 0, 0 } : rayInfo.sampleColor );
+         const auto sampleColor = isNaN( rayInfo.sampleColor ) ? ColorRGB { 0, 0, 0 } : rayInfo.sampleColor;
+         rayInfo.accumColor = rayInfo.accumColor + sampleColor;
          rayInfo.samples++;
 
+         const auto luminance = Real( 0.2126 ) * sampleColor.r + Real( 0.7152 ) * sampleColor.g + Real( 0.0722 ) * sampleColor.b;
+         const auto delta = luminance - rayInfo.mean;
+         rayInfo.mean += delta / Real( rayInfo.samples );
+         rayInfo.m2 += delta * ( luminance - rayInfo.mean );
+
+         if ( !rayInfo.converged && isConverged( rayInfo ) ) {
+            rayInfo.converged = true;
+            ++m_convergedPixels;
+         }
+
          ColorRGB color = rayInfo.accumColor / Real( rayInfo.samples );
          m_imageAaccessor->set( rayInfo.uv.y * m_width + rayInfo.uv.x, rgba( color ) );
 
@@ -616,6 +382,23 @@ namespace crimild {
          rayInfo.bounces = 0;
       }
 
+      [[nodiscard]] Bool isConverged( const RayInfo &rayInfo ) const noexcept
+      {
+         if ( rayInfo.samples >= m_maxSamples ) {
+            return true;
+         }
+
+         if ( rayInfo.samples < m_minSamples || m_threshold <= 0 ) {
+            return false;
+         }
+
+         // Standard error of the mean, relative to the mean itself. Dark pixels
+         // use a small lower bound, so they don't need a huge number of samples.
+         const auto variance = rayInfo.m2 / Real( rayInfo.samples - 1 );
+         const auto error = std::sqrt( variance / Real( rayInfo.samples ) );
+         return error <= m_threshold * std::max( rayInfo.mean, Real( 0.01 ) );
+      }
+
       [[nodiscard]] Ray3 getRay( RayInfo &rayInfo ) noexcept
       {
          if ( rayInfo.bounces > 0 ) {
@@ -627,7 +410,7 @@ namespace crimild {
 
          // Basic antialliasing by offseting the UV coordinates
          auto uv = rayInfo.uv;
-         uv = uv + random::nextVector2( -1, 1 );
+         uv = uv + RTRandom::getInstance().nextVector2( -1, 1 );
          uv = uv / Vector2 { m_width - 1.0f, m_height - 1.0f };
 
          Ray3 ray;
@@ -643,7 +426,7 @@ namespace crimild {
          const auto cameraRight = right( m_camera->getWorld() );
          const auto cameraUp = up( m_camera->getWorld() );
 
-         const auto rd = cameraLensRadius * random::nextInUnitDisk();
+         const auto rd = cameraLensRadius * RTRandom::getInstance().nextInUnitDisk();
          const auto offset = cameraRight * rd.x + cameraUp * rd.y;
 
          rayInfo.ray = Ray3 {
@@ -654,7 +437,7 @@ namespace crimild {
          return rayInfo.ray;
       }
 
-      bool scatter( const RTAcceleration::Result &scene, const Ray3 &R, const IntersectionResult &result, Ray3 &scattered, ColorRGB &attenuation, Bool &shouldBounce ) noexcept
+      bool scatter( const RTAcceleration::Result &scene, const Ray3 &R, const RTIntersection &result, Ray3 &scattered, ColorRGB &attenuation, Bool &shouldBounce ) noexcept
       {
          shouldBounce = true;
 
@@ -672,7 +455,7 @@ namespace crimild {
             double sinTheta = sqrt( Real( 1 ) - cosTheta * cosTheta );
             const auto cannotRefract = refractionRatio * sinTheta > 1;
             const auto scatteredDirection = [ & ]() -> Vector3 {
-               if ( cannotRefract || reflectance( cosTheta, refractionRatio ) > random::next() ) {
+               if ( cannotRefract || reflectance( cosTheta, refractionRatio ) > RTRandom::getInstance().next() ) {
                   return reflect( dir, result.normal );
                } else {
                   return Vector3( refract( dir, result.normal, refractionRatio ) );
@@ -686,7 +469,7 @@ namespace crimild {
             auto reflected = reflect( direction( R ), result.normal );
             scattered = Ray3 {
                result.point,
-               reflected + material.roughness * random::nextInUnitSphere(),
+               reflected + material.roughness * RTRandom::getInstance().nextInUnitSphere(),
             };
             attenuation = material.albedo;
             return dot( direction( scattered ), result.normal ) > 0;
@@ -698,7 +481,7 @@ namespace crimild {
             return true;
          }
 
-         auto scatteredDirection = Vector3f( result.normal ) + normalize( random::nextInUnitSphere() );
+         auto scatteredDirection = Vector3f( result.normal ) + normalize( RTRandom::getInstance().nextInUnitSphere() );
          if ( isZero( scatteredDirection ) ) {
             scatteredDirection = Vector3f( result.normal );
          }
@@ -709,17 +492,52 @@ namespace crimild {
 
       void doSampleBounce( RayInfo &rayInfo, const RTAcceleration::Result &scene ) noexcept
       {
-         if ( rayInfo.bounces > 50 ) {
-            // If ray bounces too many times, it migth indicate that
-            // no light (or only a tiny bit of it) reaches that point.
+         if ( rayInfo.bounces > MAX_BOUNCES ) {
             rayInfo.sampleColor = ColorRGB { 0, 0, 0 };
             onSampleCompleted( rayInfo );
             return;
          }
 
-         IntersectionResult result;
+         seedRandom( rayInfo );
+
+         RTIntersection result;
          const auto R = getRay( rayInfo );
-         if ( !intersectNR( R, scene, result ) ) {
+         const auto hasResult = m_useBVH ? m_sceneBVH.intersect( R, result ) : intersectRTTree( R, scene, result );
+         shade( rayInfo, scene, R, hasResult, result );
+      }
+
+      /**
+         \brief Traces one sample for every pixel in a tile that has not converged yet
+       */
+      TileResult renderTile( const RTTileScheduler::Tile &tile ) noexcept
+      {
+         TileResult ret;
+         for ( auto y = tile.y; y < tile.y + tile.height; ++y ) {
+            for ( auto x = tile.x; x < tile.x + tile.width; ++x ) {
+               auto &rayInfo = m_rays[ y * m_width + x ];
+               if ( rayInfo.converged ) {
+                  continue;
+               }
+
+               const auto samples = rayInfo.samples;
+               while ( rayInfo.samples == samples ) {
+                  doSampleBounce( rayInfo, m_acceleratedScene );
+                  ++ret.rays;
+               }
+
+               ++ret.samples;
+               ret.converged = ret.converged && rayInfo.converged;
+            }
+         }
+         return ret;
+      }
+
+      /**
+         \brief Accumulates the result of tracing a ray and computes the next bounce, if any
+       */
+      void shade( RayInfo &rayInfo, const RTAcceleration::Result &scene, const Ray3 &R, Bool hasResult, const RTIntersection &result ) noexcept
+      {
+         if ( !hasResult ) {
             // no intersection. Use background color
             // TODO(hernan): Avoid getting settings every time
             auto settings = getSettings();
@@ -750,18 +568,134 @@ namespace crimild {
          }
       }
 
-      Bool execute( void ) noexcept
+      /**
+         \brief Traces one sample for every pixel in a tile that has not converged yet, one bounce at a time
+
+         Rays are traced in packets. Primary rays are sorted in blocks of 4x2 pixels,
+         so each packet covers a compact region of the tile. After each bounce, the
+         remaining rays are sorted by direction, so packets are still (somewhat)
+         coherent after diffuse bounces.
+
+         \param stream Scratch storage, to avoid allocations on every tile
+       */
+      TileResult traceTile( const RTTileScheduler::Tile &tile, std::vector< std::pair< UInt32, Size > > &stream ) noexcept
       {
-         if ( !m_workers.empty() ) {
-            return true;
+         TileResult ret;
+
+         stream.clear();
+         for ( auto by = tile.y; by < tile.y + tile.height; by += 2 ) {
+            for ( auto bx = tile.x; bx < tile.x + tile.width; bx += 4 ) {
+               for ( auto y = by; y < std::min( by + 2, tile.y + tile.height ); ++y ) {
+                  for ( auto x = bx; x < std::min( bx + 4, tile.x + tile.width ); ++x ) {
+                     const auto rayID = Size( y * m_width + x );
+                     if ( !m_rays[ rayID ].converged ) {
+                        stream.push_back( { 0, rayID } );
+                     }
+                  }
+               }
+            }
+         }
+         ret.samples = stream.size();
+
+         RTRayPacket packet;
+         while ( !stream.empty() ) {
+            for ( Size begin = 0; begin < stream.size(); begin += RTRayPacket::SIZE ) {
+               const auto end = std::min( stream.size(), begin + RTRayPacket::SIZE );
+
+               packet.reset();
+               for ( auto j = begin; j < end; ++j ) {
+                  auto &rayInfo = m_rays[ stream[ j ].second ];
+                  seedRandom( rayInfo );
+                  packet.add( getRay( rayInfo ) );
+               }
+
+               // Volumes sample distances while intersecting
+               seedRandom( m_rays[ stream[ begin ].second ], 1 );
+               m_sceneBVH.intersect( packet );
+
+               for ( auto j = begin; j < end; ++j ) {
+                  const auto lane = UInt32( j - begin );
+                  auto &rayInfo = m_rays[ stream[ j ].second ];
+                  seedRandom( rayInfo, 2 );
+
+                  RTIntersection result;
+                  const auto hasResult = m_sceneBVH.resolve( packet, lane, result );
+                  shade( rayInfo, m_acceleratedScene, packet.getRay( lane ), hasResult, result );
+
+                  if ( rayInfo.bounces > MAX_BOUNCES ) {
+                     rayInfo.sampleColor = ColorRGB { 0, 0, 0 };
+                     onSampleCompleted( rayInfo );
+                  }
+
+                  stream[ j ].first = RTRayPacket::getSortKey( rayInfo.ray );
+               }
+
+               ret.rays += end - begin;
+            }
+
+            // Completed samples have their bounces reset
+            stream.erase(
+               std::remove_if( stream.begin(), stream.end(), [ & ]( const auto &entry ) { return m_rays[ entry.second ].bounces == 0; } ),
+               stream.end()
+            );
+            std::sort( stream.begin(), stream.end() );
+         }
+
+         for ( auto by = tile.y; by < tile.y + tile.height && ret.converged; ++by ) {
+            for ( auto bx = tile.x; bx < tile.x + tile.width && ret.converged; ++bx ) {
+               ret.converged = m_rays[ by * m_width + bx ].converged;
+            }
+         }
+
+         return ret;
+      }
+
+      /**
+         \brief Applies rt.paused and rt.cancel, and reports progress as rt.stats.* settings
+       */
+      void updateProgress( Settings *settings ) noexcept
+      {
+         const auto paused = settings->get< Bool >( "rt.paused", false );
+         if ( paused != m_scheduler.isPaused() ) {
+            if ( paused ) {
+               m_scheduler.pause();
+            } else {
+               m_scheduler.resume();
+            }
+         }
+
+         if ( settings->get< Bool >( "rt.cancel", false ) && !m_scheduler.isCancelled() ) {
+            m_scheduler.cancel();
          }
 
-         // if ( !isDone() ) {
-         //     return true;
-         // }
+         const auto now = std::chrono::steady_clock::now();
+         const auto elapsed = std::chrono::duration< Real >( now - m_startTime ).count();
+         const auto rays = m_rayCount.load();
+         const auto samples = m_sampleCount.load();
+         const auto pixels = std::max( Size( 1 ), m_rays.size() );
 
+         settings->set( "rt.samples.count", UInt32( samples / pixels ) );
+         settings->set( "rt.stats.rays", rays );
+         settings->set( "rt.stats.samples", samples );
+         settings->set( "rt.stats.rays_per_second", elapsed > 0 ? Real( rays ) / elapsed : Real( 0 ) );
+         settings->set( "rt.stats.samples_per_second", elapsed > 0 ? Real( samples ) / elapsed : Real( 0 ) );
+         settings->set( "rt.stats.converged_pixels", UInt64( m_convergedPixels.load() ) );
+         settings->set( "rt.stats.converged", Real( m_convergedPixels.load() ) / Real( pixels ) );
+         settings->set( "rt.stats.done", m_scheduler.isDone() );
+         if ( !m_scheduler.isDone() && !paused ) {
+            settings->set( "rt.stats.elapsed", elapsed );
+         }
+      }
+
+      Bool execute( void ) noexcept
+      {
          auto settings = Simulation::getInstance()->getSettings();
 
+         if ( !m_workers.empty() ) {
+            updateProgress( settings );
+            return true;
+         }
+
          auto scene = [ & ]() -> SharedPointer< Node > {
             if ( m_scene != nullptr ) {
                return m_scene;
@@ -802,6 +736,9 @@ namespace crimild {
                }
             }();
             m_acceleratedScene = scene->perform< BinTreeScene >( splitStrategy )->perform< RTAcceleration >();
+            if ( m_useBVH ) {
+               m_sceneBVH.build( m_acceleratedScene );
+            }
 
             return m_scene;
          }();
@@ -838,221 +775,31 @@ namespace crimild {
             return true;
          }
 
-#if 1
          initializeRays();
+         m_scheduler.reset( m_width, m_height, m_tileSize, m_tileOrder );
+         m_startTime = std::chrono::steady_clock::now();
 
          m_workers.clear();
          for ( auto i = 0; i < m_workerCount; ++i ) {
             m_workers.push_back(
                std::thread(
-                  [ self = this, i ] {
-                     Size next = i;
-                     while ( self->m_running ) {
-                        // It is possible that id clashing happens for two or more
-                        // workers, but I guess that's ok for now since only one of
-                        // them will actually write the final color in the image
-                        Size rayID = next;
-                        next += self->m_workerCount;
-                        if ( next >= self->m_rays.size() ) {
-                           next = i;
-                        }
-                        if ( rayID < self->m_rays.size() ) {
-                           auto &ray = self->m_rays[ rayID ];
-                           self->doSampleBounce( ray, self->m_acceleratedScene );
-                        }
-                     }
-                  }
-               )
-            );
-         }
-
-#else
-
-         auto maxSamples = settings->get< UInt32 >( "rt.samples.max", 5000 );
-         auto sampleCount = settings->get< UInt32 >( "rt.samples.count", 1 );
-         auto bounces = settings->get< UInt32 >( "rt.bounces", 10 );
-         auto focusDist = settings->get< Real >( "rt.focusDist", Real( 10 ) ); // move to camera
-         auto aperture = settings->get< Real >( "rt.aperture", Real( 0 ) );    // move to camera
-         auto backgroundColor = ColorRGB {
-            settings->get< Real >( "rt.background_color.r", 0.5f ),
-            settings->get< Real >( "rt.background_color.g", 0.7f ),
-            settings->get< Real >( "rt.background_color.b", 1.0f ),
-         };
-         auto useScanline = settings->get< Bool >( "rt.use_scanline", true );
-
-         const auto cameraFocusDistance = focusDist; // camera->getFocusDistance();
-         const auto cameraAperture = aperture;       // camera->getAperture();
-         const auto cameraLensRadius = 0.5f * cameraAperture;
-         const auto cameraRight = right( camera->getWorld() );
-         const auto cameraUp = up( camera->getWorld() );
-
-         auto job = [ & ]( UInt32 x, UInt32 y ) {
-            return [ self = this,
-                     scene,
-                     camera,
-                     cameraFocusDistance,
-                     cameraLensRadius,
-                     cameraUp,
-                     cameraRight,
-                     sampleCount,
-                     bounces,
-                     backgroundColor,
-                     x,
-                     y ]() {
-               for ( auto dy = 0; dy < self->m_tileSize; ++dy ) {
-                  if ( y + dy >= self->m_height ) {
-                     break;
-                  }
-                  for ( auto dx = 0; dx < self->m_tileSize; ++dx ) {
-                     if ( x + dx >= self->m_width ) {
-                        break;
+                  [ self = this ] {
+                     std::vector< std::pair< UInt32, Size > > stream;
+                     RTTileScheduler::Tile tile;
+                     while ( self->m_scheduler.next( tile ) ) {
+                        const auto result = self->m_useStreams ? self->traceTile( tile, stream ) : self->renderTile( tile );
+                        self->m_rayCount += result.rays;
+                        self->m_sampleCount += result.samples;
+                        self->m_scheduler.release( tile, result.converged );
                      }
-
-                     auto color = ColorRGB::Constants::BLACK;
-                     for ( auto s = 0l; s < CRIMILD_RT_SAMPLES_PER_FRAME; ++s ) {
-                        const auto u = ( ( x + dx ) + Random::generate< Real >() ) / Real( self->m_width - 1 );
-                        const auto v = ( ( y + dy ) + Random::generate< Real >() ) / Real( self->m_height - 1 );
-
-                        Ray3 ray;
-                        if ( camera->getPickRay( u, v, ray ) ) {
-                           // Calculate depth-of-field based on camera properties
-                           const auto rd = cameraLensRadius * randomInUnitDisk();
-                           const auto offset = cameraRight * rd.x + cameraUp * rd.y;
-                           ray = Ray3 {
-                              origin( ray ) + offset,
-                              cameraFocusDistance * direction( ray ) - offset,
-                           };
-
-   #if 0
-                                    color = color + rayColor( ray, self->m_acceleratedScene, backgroundColor, bounces );
-   #else
-                           color = color + rayColor( ray, self->m_scene, backgroundColor, bounces );
-   #endif
-                        }
-                     }
-
-                     const Index idx = ( y + dy ) * self->m_width + ( x + dx );
-                     const auto prevColor = self->m_imageAaccessor->get< ColorRGBA >( idx ) * sampleCount;
-                     self->m_imageAaccessor->set( idx, ( prevColor + rgba( color ) ) / ( sampleCount + CRIMILD_RT_SAMPLES_PER_FRAME ) );
-
-                     std::this_thread::yield();
                   }
-               }
-            };
-         };
-
-         if ( useScanline ) {
-            for ( auto y = 0; y < m_height; y += m_tileSize ) {
-               for ( auto x = 0; x < m_width; x += m_tileSize ) {
-                  m_jobs.push_back( job( x, y ) );
-               }
-            }
-         } else {
-            // Render tiles in a spiral, so center ones show up first
-            const Int32 MAX_X = ( m_width / m_tileSize ) / 2;
-            const Int32 MAX_Y = ( m_height / m_tileSize ) / 2;
-            Int32 x = 0;
-            Int32 y = 0;
-            Int32 dx = 0;
-            Int32 dy = -1;
-            Int32 t = max( 2 * MAX_X, 2 * MAX_Y );
-            const Int32 N = t * t;
-            for ( auto i = 0l; i < N; i++ ) {
-               if ( -MAX_X <= x && x <= MAX_X && -MAX_Y <= y && y <= MAX_Y ) {
-                  const auto jx = x * m_tileSize + m_width / 2 - m_tileSize;
-                  const auto jy = y * m_tileSize + m_height / 2;
-                  m_jobs.push_back( job( jx, jy ) );
-               }
-               if ( ( x == y ) || ( ( x < 0 ) && ( x == -y ) ) || ( ( x > 0 ) && ( x == 1 - y ) ) ) {
-                  t = dx;
-                  dx = -dy;
-                  dy = t;
-               }
-               x += dx;
-               y += dy;
-            }
-         }
-
-         // launch all threads
-         for ( auto i = 0; i < m_workerCount; ++i ) {
-            m_workers.push_back(
-               std::move(
-                  std::thread(
-                     [ & ] {
-                        Job job;
-                        while ( getNextJob( job ) ) {
-                           job();
-                        }
-                        reportProgress();
-                     }
-                  )
                )
             );
          }
 
-         CRIMILD_LOG_INFO( "RT Samples: ", sampleCount );
-
-#endif
-
-         return true;
-      }
-
-      void reset( void ) noexcept
-      {
-         // wait for all threads to finish
-         for ( auto &worker : m_workers ) {
-            worker.join();
-         }
-
-         m_nextJobIdx = 0;
-         m_jobs.clear();
-         m_workers.clear();
-
-         m_progress = 0;
-
-         auto settings = Simulation::getInstance()->getSettings();
-         auto sampleCount = settings->get< UInt32 >( "rt.samples.count", 0 );
-
-         if ( sampleCount == 0 ) {
-            // Reset colors
-            for ( auto i = 0l; i < m_width * m_height; ++i ) {
-               m_imageAaccessor->set( i, ColorRGBA { 0, 0, 0, 1 } );
-            }
-         }
-
-         // settings->set( "rt.samples.count", sampleCount + CRIMILD_RT_SAMPLES_PER_FRAME );
-
-         if ( Simulation::getInstance()->getSettings()->get< Bool >( "rt.dynamic_scene", false ) ) {
-            // Scene is dynamic, so reset cached scene and camera
-            m_scene = nullptr;
-            m_camera = nullptr;
-         }
-      }
-
-      Bool getNextJob( Job &nextJob ) noexcept
-      {
-         std::lock_guard< std::mutex > lock( m_mutex );
-
-         if ( m_nextJobIdx >= m_jobs.size() ) {
-            return false;
-         }
-
-         nextJob = m_jobs[ m_nextJobIdx++ ];
          return true;
       }
 
-      void reportProgress( void ) noexcept
-      {
-         std::lock_guard< std::mutex > lock( m_progressMutex );
-         m_progress++;
-      }
-
-      Bool isDone( void ) noexcept
-      {
-         std::lock_guard< std::mutex > lock( m_progressMutex );
-         return m_progress >= m_workerCount;
-      }
-
    private:
       Int32 m_width;
       Int32 m_height;
@@ -1063,6 +810,17 @@ namespace crimild {
       Bool m_running = true;
 
       RTAcceleration::Result m_acceleratedScene;
+      RTSceneBVH m_sceneBVH;
+      Bool m_useBVH = true;
+
+      Bool m_useStreams = false;
+
+      RTTileScheduler m_scheduler;
+      RTTileScheduler::Order m_tileOrder = RTTileScheduler::Order::SCANLINE;
+      Int32 m_minSamples = 16;
+      Int32 m_maxSamples = 5000;
+      Real m_threshold = 0.01;
+      UInt32 m_seed = 0;
 
       SharedPointer< Node > m_scene;
       SharedPointer< Camera > m_camera;
@@ -1070,14 +828,17 @@ namespace crimild {
       SharedPointer< Image > m_image;
       SharedPointer< BufferAccessor > m_imageAaccessor;
 
-      std::vector< Job > m_jobs;
-      Index m_nextJobIdx = 0;
-
       std::vector< std::thread > m_workers;
-      std::mutex m_mutex;
 
-      Size m_progress = 0l;
-      std::mutex m_progressMutex;
+      /**
+         \brief Stats
+       */
+      //@{
+      std::chrono::steady_clock::time_point m_startTime;
+      std::atomic< UInt64 > m_rayCount = 0;
+      std::atomic< UInt64 > m_sampleCount = 0;
+      std::atomic< UInt32 > m_convergedPixels = 0;
+      //@}
    };
 }
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_RENDERING_RT_RANDOM_
+#define CRIMILD_RENDERING_RT_RANDOM_
+
+#include <crimild/foundation.hpp>
+#include <crimild/math/Vector2.hpp>
+#include <crimild/math/Vector3.hpp>
+
+namespace crimild {
+
+   /**
+      \brief A small random number generator for the soft ray tracer (PCG32)
+
+      Unlike the default generator, seeding is cheap. The ray tracer seeds the
+      generator for each pixel, sample and bounce, so every sample uses its own
+      sequence of numbers. That way, renders are reproducible regardless of the
+      number of threads or the order in which pixels are traced.
+
+      \see https://www.pcg-random.org
+    */
+   class RTRandom {
+   public:
+      explicit RTRandom( UInt64 seed = 0, UInt64 stream = 0 ) noexcept
+      {
+         this->seed( seed, stream );
+      }
+
+      /**
+         \brief Restarts the generator
+
+         Generators with the same seed but different streams produce unrelated sequences.
+       */
+      inline void seed( UInt64 seed, UInt64 stream = 0 ) noexcept
+      {
+         m_state = 0;
+         m_increment = ( stream << 1u ) | 1u;
+         nextUInt32();
+         m_state += seed;
+         nextUInt32();
+      }
+
+      /**
+         \brief Seeds the generator for a given pixel sample
+       */
+      inline void seed( UInt32 seed, UInt32 pixel, UInt32 sample, UInt32 bounce, UInt64 stream = 0 ) noexcept
+      {
+         this->seed( hash( hash( hash( seed, pixel ), sample ), bounce ), stream );
+      }
+
+      [[nodiscard]] inline UInt32 nextUInt32( void ) noexcept
+      {
+         const auto old = m_state;
+         m_state = old * 6364136223846793005ull + m_increment;
+         const auto xorShifted = UInt32( ( ( old >> 18u ) ^ old ) >> 27u );
+         const auto rot = UInt32( old >> 59u );
+         return ( xorShifted >> rot ) | ( xorShifted << ( ( -rot ) & 31 ) );
+      }
+
+      /**
+         \brief Returns a number in [0, 1)
+       */
+      [[nodiscard]] inline Real next( void ) noexcept
+      {
+         // Only 24 bits fit in the mantissa of a float
+         return Real( nextUInt32() >> 8 ) * Real( 1.0 / 16777216.0 );
+      }
+
+      [[nodiscard]] inline Real next( Real lo, Real hi ) noexcept
+      {
+         return lo + ( hi - lo ) * next();
+      }
+
+      [[nodiscard]] inline Vector2 nextVector2( Real lo, Real hi ) noexcept
+      {
+         const auto x = next( lo, hi );
+         const auto y = next( lo, hi );
+         return Vector2 { x, y };
+      }
+
+      [[nodiscard]] inline Vector2 nextInUnitDisk( void ) noexcept
+      {
+         while ( true ) {
+            const auto v = nextVector2( -1, 1 );
+            if ( v.x * v.x + v.y * v.y < 1 ) {
+               return v;
+            }
+         }
+      }
+
+      [[nodiscard]] inline Vector3 nextInUnitSphere( void ) noexcept
+      {
+         while ( true ) {
+            const auto x = next( -1, 1 );
+            const auto y = next( -1, 1 );
+            const auto z = next( -1, 1 );
+            if ( x * x + y * y + z * z < 1 ) {
+               return Vector3 { x, y, z };
+            }
+         }
+      }
+
+      /**
+         \brief The generator used by the current thread
+       */
+      [[nodiscard]] static inline RTRandom &getInstance( void ) noexcept
+      {
+         static thread_local RTRandom instance;
+         return instance;
+      }
+
+   private:
+      /**
+         \brief Combines two values into a well distributed 64-bit key (splitmix64)
+       */
+      [[nodiscard]] static inline UInt64 hash( UInt64 a, UInt64 b ) noexcept
+      {
+         auto x = a * 0x9e3779b97f4a7c15ull + b;
+         x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+         x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebull;
+         return x ^ ( x >> 31 );
+      }
+
+   private:
+      UInt64 m_state = 0;
+      UInt64 m_increment = 1;
+   };
+
+}
+
+#endif
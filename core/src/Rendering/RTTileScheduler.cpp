@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/RTTileScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+using namespace crimild;
+
+RTTileScheduler::RTTileScheduler( Int32 width, Int32 height, Int32 tileSize, Order order ) noexcept
+{
+   reset( width, height, tileSize, order );
+}
+
+void RTTileScheduler::reset( Int32 width, Int32 height, Int32 tileSize, Order order ) noexcept
+{
+   tileSize = std::max( 1, tileSize );
+   const auto tilesX = ( std::max( 0, width ) + tileSize - 1 ) / tileSize;
+   const auto tilesY = ( std::max( 0, height ) + tileSize - 1 ) / tileSize;
+
+   m_tiles.clear();
+   m_tiles.reserve( tilesX * tilesY );
+   for ( auto ty = 0; ty < tilesY; ++ty ) {
+      for ( auto tx = 0; tx < tilesX; ++tx ) {
+         const auto x = tx * tileSize;
+         const auto y = ty * tileSize;
+         m_tiles.push_back(
+            Tile {
+               .x = x,
+               .y = y,
+               .width = std::min( tileSize, width - x ),
+               .height = std::min( tileSize, height - y ),
+            }
+         );
+      }
+   }
+
+   if ( order == Order::SPIRAL ) {
+      // Sort tiles by rings around the center, so the center of the image shows up first
+      const auto cx = Real( tilesX - 1 ) / 2;
+      const auto cy = Real( tilesY - 1 ) / 2;
+      const auto key = [ & ]( const Tile &tile ) {
+         const auto dx = Real( tile.x / tileSize ) - cx;
+         const auto dy = Real( tile.y / tileSize ) - cy;
+         return std::make_pair( std::round( std::max( std::abs( dx ), std::abs( dy ) ) ), std::atan2( dy, dx ) );
+      };
+      std::stable_sort( m_tiles.begin(), m_tiles.end(), [ & ]( const Tile &a, const Tile &b ) { return key( a ) < key( b ); } );
+   }
+
+   for ( size_t i = 0; i < m_tiles.size(); ++i ) {
+      m_tiles[ i ].index = UInt32( i );
+   }
+
+   m_states = std::make_unique< std::atomic< UInt8 >[] >( m_tiles.size() );
+   for ( size_t i = 0; i < m_tiles.size(); ++i ) {
+      m_states[ i ] = FREE;
+   }
+
+   m_next = 0;
+   m_renderedCount = 0;
+   m_convergedCount = 0;
+   m_paused = false;
+   m_cancelled = false;
+}
+
+Bool RTTileScheduler::next( Tile &tile ) noexcept
+{
+   while ( true ) {
+      if ( m_paused ) {
+         std::unique_lock< std::mutex > lock( m_mutex );
+         m_wakeUp.wait( lock, [ this ] { return !m_paused || m_cancelled; } );
+      }
+
+      if ( m_cancelled || isDone() ) {
+         return false;
+      }
+
+      const auto i = m_next.fetch_add( 1, std::memory_order_relaxed ) % m_tiles.size();
+      auto expected = UInt8( FREE );
+      if ( m_states[ i ].compare_exchange_strong( expected, UInt8( BUSY ), std::memory_order_acquire ) ) {
+         tile = m_tiles[ i ];
+         return true;
+      }
+
+      if ( expected == BUSY ) {
+         // Only happens when there are fewer tiles left than workers
+         std::this_thread::yield();
+      }
+   }
+}
+
+void RTTileScheduler::release( const Tile &tile, Bool converged ) noexcept
+{
+   ++m_renderedCount;
+   if ( converged ) {
+      ++m_convergedCount;
+   }
+   m_states[ tile.index ].store( UInt8( converged ? CONVERGED : FREE ), std::memory_order_release );
+}
+
+void RTTileScheduler::pause( void ) noexcept
+{
+   std::lock_guard< std::mutex > lock( m_mutex );
+   m_paused = true;
+}
+
+void RTTileScheduler::resume( void ) noexcept
+{
+   {
+      std::lock_guard< std::mutex > lock( m_mutex );
+      m_paused = false;
+   }
+   m_wakeUp.notify_all();
+}
+
+void RTTileScheduler::cancel( void ) noexcept
+{
+   {
+      std::lock_guard< std::mutex > lock( m_mutex );
+      m_cancelled = true;
+   }
+   m_wakeUp.notify_all();
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_RENDERING_RT_TILE_SCHEDULER_
+#define CRIMILD_RENDERING_RT_TILE_SCHEDULER_
+
+#include <atomic>
+#include <condition_variable>
+#include <crimild/foundation.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace crimild {
+
+   /**
+      \brief Hands out image tiles to workers for progressive rendering
+
+      Tiles are visited in passes, either in scanline order or in a spiral
+      starting at the center of the image. Workers get a tile with next(),
+      render one sample for each of its pixels and give it back with release().
+      A tile is never handed out to more than one worker at the same time, even
+      if there are more workers than tiles.
+
+      Once all pixels in a tile converged, the tile is released as converged and
+      skipped from then on. Rendering is done when every tile has converged.
+
+      Workers can be paused, resumed or cancelled at any time. Tiles in progress
+      are always completed first.
+    */
+   class RTTileScheduler : public NonCopyable {
+   public:
+      enum class Order {
+         SCANLINE,
+         SPIRAL,
+      };
+
+      struct Tile {
+         UInt32 index = 0;
+         Int32 x = 0;
+         Int32 y = 0;
+         Int32 width = 0;
+         Int32 height = 0;
+      };
+
+   public:
+      RTTileScheduler( void ) = default;
+      RTTileScheduler( Int32 width, Int32 height, Int32 tileSize, Order order = Order::SCANLINE ) noexcept;
+      ~RTTileScheduler( void ) = default;
+
+      /**
+         \brief Splits an image in tiles, discarding previous state
+
+         \remarks Not thread-safe. Workers must be stopped before calling this function.
+       */
+      void reset( Int32 width, Int32 height, Int32 tileSize, Order order = Order::SCANLINE ) noexcept;
+
+      [[nodiscard]] inline const std::vector< Tile > &getTiles( void ) const noexcept { return m_tiles; }
+      [[nodiscard]] inline size_t getTileCount( void ) const noexcept { return m_tiles.size(); }
+
+      /**
+         \brief Gets the next tile to render
+
+         Blocks while paused.
+
+         \returns False if rendering was cancelled or every tile converged
+       */
+      [[nodiscard]] Bool next( Tile &tile ) noexcept;
+
+      /**
+         \brief Gives a tile back after rendering it
+       */
+      void release( const Tile &tile, Bool converged ) noexcept;
+
+      void pause( void ) noexcept;
+      void resume( void ) noexcept;
+
+      /**
+         \brief Stops handing out tiles, waking up paused workers
+       */
+      void cancel( void ) noexcept;
+
+      [[nodiscard]] inline Bool isPaused( void ) const noexcept { return m_paused; }
+      [[nodiscard]] inline Bool isCancelled( void ) const noexcept { return m_cancelled; }
+      [[nodiscard]] inline Bool isDone( void ) const noexcept { return m_convergedCount >= m_tiles.size(); }
+
+      [[nodiscard]] inline size_t getConvergedTileCount( void ) const noexcept { return m_convergedCount; }
+
+      /**
+         \brief Number of tiles rendered so far
+       */
+      [[nodiscard]] inline UInt64 getRenderedTileCount( void ) const noexcept { return m_renderedCount; }
+
+   private:
+      enum State : UInt8 {
+         FREE,
+         BUSY,
+         CONVERGED,
+      };
+
+      std::vector< Tile > m_tiles;
+      std::unique_ptr< std::atomic< UInt8 >[] > m_states;
+
+      std::atomic< UInt64 > m_next = 0;
+      std::atomic< UInt64 > m_renderedCount = 0;
+      std::atomic< size_t > m_convergedCount = 0;
+
+      std::atomic< Bool > m_paused = false;
+      std::atomic< Bool > m_cancelled = false;
+      std::mutex m_mutex;
+      std::condition_variable m_wakeUp;
+   };
+
+}
+
+#endif
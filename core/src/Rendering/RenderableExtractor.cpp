@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/RenderableExtractor.hpp"
+
+#include "Components/MaterialComponent.hpp"
+#include "Concurrency/Parallel.hpp"
+#include "Rendering/Material.hpp"
+#include "Rendering/Pipeline.hpp"
+#include "Rendering/RenderableSet.hpp"
+#include "SceneGraph/CSGNode.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/NodeVisitor.hpp"
+
+#include <algorithm>
+
+using namespace crimild;
+using namespace crimild::concurrency;
+
+namespace crimild::impl {
+
+   static Bool isCulled( Camera *camera, Node *node ) noexcept
+   {
+      switch ( node->getCullMode() ) {
+         case Node::CullMode::NEVER:
+            return false;
+
+         case Node::CullMode::ALWAYS:
+            return true;
+
+         default:
+            // Skyboxes are always visible, no matter what their bounds say
+            if ( camera == nullptr || node->getLayer() == Node::Layer::SKYBOX ) {
+               return false;
+            }
+            return camera->culled( node->getWorldBound() );
+      }
+   }
+
+   static FrameSnapshot::Classification classify( RenderableClassificationCache &cache, Geometry *geometry ) noexcept
+   {
+      Material *material = nullptr;
+      if ( auto materials = geometry->getComponent< MaterialComponent >() ) {
+         material = materials->first();
+      }
+      return cache.classify( geometry->getLayer(), material );
+   }
+
+   class ExtractRenderables : public NodeVisitor {
+   public:
+      ExtractRenderables( Camera *camera, RenderableExtractor::Chunk &chunk, Bool collectCasters ) noexcept
+         : m_camera( camera ),
+           m_chunk( chunk ),
+           m_collectCasters( collectCasters )
+      {
+      }
+
+      virtual ~ExtractRenderables( void ) = default;
+
+      void visitNode( Node * ) override
+      {
+         if ( !m_inCulledSubtree ) {
+            ++m_chunk.stats.visited;
+         }
+      }
+
+      void visitGroup( Group *group ) override
+      {
+         if ( m_inCulledSubtree ) {
+            // Only looking for shadow casters
+            if ( group->getCullMode() != Node::CullMode::ALWAYS ) {
+               NodeVisitor::visitGroup( group );
+            }
+            return;
+         }
+
+         ++m_chunk.stats.visited;
+         if ( isCulled( m_camera, group ) ) {
+            ++m_chunk.stats.culled;
+            if ( m_collectCasters && group->getCullMode() != Node::CullMode::ALWAYS ) {
+               m_inCulledSubtree = true;
+               NodeVisitor::visitGroup( group );
+               m_inCulledSubtree = false;
+            }
+            return;
+         }
+         NodeVisitor::visitGroup( group );
+      }
+
+      void visitGeometry( Geometry *geometry ) override
+      {
+         auto culled = m_inCulledSubtree;
+         if ( !m_inCulledSubtree ) {
+            ++m_chunk.stats.visited;
+            if ( isCulled( m_camera, geometry ) ) {
+               ++m_chunk.stats.culled;
+               culled = true;
+            }
+         }
+
+         if ( culled && ( !m_collectCasters || geometry->getCullMode() == Node::CullMode::ALWAYS ) ) {
+            return;
+         }
+
+         const auto classification = classify( m_chunk.classifications, geometry );
+         if ( m_collectCasters && classification == FrameSnapshot::Classification::LIT ) {
+            m_chunk.casters.push_back( geometry );
+         }
+
+         if ( culled ) {
+            return;
+         }
+
+         switch ( classification ) {
+            case FrameSnapshot::Classification::LIT:
+               m_chunk.lit.push_back( geometry );
+               break;
+            case FrameSnapshot::Classification::UNLIT:
+               m_chunk.unlit.push_back( geometry );
+               break;
+            case FrameSnapshot::Classification::ENVIRONMENT:
+               m_chunk.env.push_back( geometry );
+               break;
+            default:
+               return;
+         }
+         ++m_chunk.stats.emitted;
+      }
+
+      void visitCSGNode( CSGNode *csg ) override
+      {
+         if ( !m_inCulledSubtree ) {
+            ++m_chunk.stats.visited;
+         }
+         NodeVisitor::visitCSGNode( csg );
+      }
+
+   private:
+      Camera *m_camera = nullptr;
+      RenderableExtractor::Chunk &m_chunk;
+      Bool m_collectCasters = false;
+
+      /**
+         \brief Set while traversing a culled subtree looking for shadow casters
+       */
+      Bool m_inCulledSubtree = false;
+   };
+
+}
+
+FrameSnapshot::Classification RenderableClassificationCache::classify( Node::Layer::Impl layer, Material *material ) noexcept
+{
+   if ( layer == Node::Layer::SKYBOX ) {
+      return FrameSnapshot::Classification::ENVIRONMENT;
+   }
+
+   if ( material == nullptr ) {
+      return FrameSnapshot::Classification::NONE;
+   }
+
+   auto pipeline = material->getGraphicsPipeline();
+   auto program = pipeline != nullptr ? pipeline->getProgram() : nullptr;
+
+   auto [ it, inserted ] = m_entries.try_emplace( crimild::retain( material ) );
+   auto &entry = it->second;
+   if ( inserted || entry.pipeline != pipeline || entry.program != program ) {
+      // Either a new material or one whose pipeline has changed
+      entry.pipeline = pipeline;
+      entry.program = program;
+      entry.classification = FramePipeline::classify( layer, material );
+   }
+   return entry.classification;
+}
+
+void RenderableClassificationCache::evictExpired( void ) noexcept
+{
+   std::erase_if( m_entries, []( const auto &it ) { return it.first.expired(); } );
+}
+
+void RenderableExtractor::Chunk::reset( void ) noexcept
+{
+   // Classifications are kept between frames
+   lit.clear();
+   unlit.clear();
+   env.clear();
+   casters.clear();
+   stats = {};
+   classifications.evictExpired();
+}
+
+void RenderableExtractor::extract( Node *scene, Camera *camera, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters ) noexcept
+{
+   m_stats = {};
+   m_subtrees.clear();
+
+   if ( scene == nullptr ) {
+      return;
+   }
+
+   if ( camera != nullptr ) {
+      camera->computeCullingPlanes();
+   }
+
+   auto tasks = TaskSystem::getInstance();
+   const auto parallel = m_parallelEnabled && tasks != nullptr && tasks->isRunning() && tasks->getNumWorkers() > 0;
+   if ( parallel ) {
+      split( scene, camera, casters != nullptr );
+   } else {
+      m_subtrees.push_back( scene );
+   }
+
+   const auto count = m_subtrees.size();
+   const auto grain = parallel ? PARALLEL_GRAIN : std::max( size_t( 1 ), count );
+   const auto chunkCount = ( count + grain - 1 ) / grain;
+   while ( m_chunks.size() < chunkCount ) {
+      m_chunks.push_back( std::make_unique< Chunk >() );
+   }
+   for ( size_t i = 0; i < chunkCount; ++i ) {
+      m_chunks[ i ]->reset();
+   }
+
+   parallel_for(
+      Range { 0, count },
+      grain,
+      [ & ]( Range range ) {
+         // Chunks always start at a multiple of grain
+         auto &chunk = *m_chunks[ range.begin / grain ];
+         impl::ExtractRenderables visitor( camera, chunk, casters != nullptr );
+         for ( auto i = range.begin; i < range.end; ++i ) {
+            m_subtrees[ i ]->accept( visitor );
+         }
+      }
+   );
+
+   merge( chunkCount, lit, unlit, env, casters );
+}
+
+void RenderableExtractor::extract( const SceneIndex *index, Camera *camera, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters ) noexcept
+{
+   m_stats = {};
+   m_items.clear();
+
+   if ( index == nullptr ) {
+      return;
+   }
+
+   if ( camera != nullptr ) {
+      camera->computeCullingPlanes();
+   }
+
+   index->queryFrustum( camera, m_items );
+
+   // Items are indexed in traversal order
+   std::sort( m_items.begin(), m_items.end() );
+
+   if ( m_chunks.empty() ) {
+      m_chunks.push_back( std::make_unique< Chunk >() );
+   }
+   auto &chunk = *m_chunks.front();
+   chunk.reset();
+
+   // Items are still tested individually, since the index ignores CullMode::ALWAYS
+   impl::ExtractRenderables visitor( camera, chunk, false );
+   for ( const auto item : m_items ) {
+      index->getItem( item )->accept( visitor );
+   }
+
+   if ( casters != nullptr ) {
+      // Objects outside the frustum may still cast shadows into it
+      for ( size_t i = 0; i < index->getItemCount(); ++i ) {
+         auto geometry = dynamic_cast< Geometry * >( index->getItem( i ) );
+         if ( geometry != nullptr
+              && geometry->getCullMode() != Node::CullMode::ALWAYS
+              && impl::classify( chunk.classifications, geometry ) == FrameSnapshot::Classification::LIT ) {
+            chunk.casters.push_back( geometry );
+         }
+      }
+   }
+
+   merge( 1, lit, unlit, env, casters );
+
+   m_stats.culled += index->getItemCount() - m_items.size();
+}
+
+void RenderableExtractor::merge( size_t chunkCount, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters ) noexcept
+{
+   // Merge in traversal order
+   for ( size_t i = 0; i < chunkCount; ++i ) {
+      const auto &chunk = *m_chunks[ i ];
+      if ( lit != nullptr ) {
+         for ( auto geometry : chunk.lit ) {
+            lit->addGeometry( geometry );
+         }
+      }
+      if ( unlit != nullptr ) {
+         for ( auto geometry : chunk.unlit ) {
+            unlit->addGeometry( geometry );
+         }
+      }
+      if ( env != nullptr ) {
+         for ( auto geometry : chunk.env ) {
+            env->addGeometry( geometry );
+         }
+      }
+      if ( casters != nullptr ) {
+         for ( auto geometry : chunk.casters ) {
+            casters->addGeometry( geometry );
+         }
+      }
+      m_stats.visited += chunk.stats.visited;
+      m_stats.culled += chunk.stats.culled;
+      m_stats.emitted += chunk.stats.emitted;
+   }
+}
+
+void RenderableExtractor::split( Node *scene, Camera *camera, Bool collectCasters ) noexcept
+{
+   m_subtrees.push_back( scene );
+
+   std::vector< Node * > next;
+   auto expanded = true;
+   while ( expanded && m_subtrees.size() < PARALLEL_MIN_SUBTREES ) {
+      expanded = false;
+      next.clear();
+      for ( auto node : m_subtrees ) {
+         auto group = dynamic_cast< Group * >( node );
+         if ( group == nullptr ) {
+            next.push_back( node );
+            continue;
+         }
+
+         if ( impl::isCulled( camera, group ) ) {
+            if ( collectCasters ) {
+               // Traversed by a chunk looking for shadow casters, which
+               // counts it as visited and culled
+               next.push_back( group );
+            } else {
+               ++m_stats.visited;
+               ++m_stats.culled;
+            }
+            continue;
+         }
+         expanded = true;
+         ++m_stats.visited;
+         group->forEachNode( [ & ]( Node *child ) { next.push_back( child ); } );
+      }
+      std::swap( m_subtrees, next );
+   }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_RENDERING_RENDERABLE_EXTRACTOR_
+#define CRIMILD_CORE_RENDERING_RENDERABLE_EXTRACTOR_
+
+#include "SceneGraph/Node.hpp"
+#include "SceneGraph/SceneIndex.hpp"
+#include "Simulation/FramePipeline.hpp"
+
+#include <crimild/foundation.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace crimild {
+
+   class Camera;
+   class GraphicsPipeline;
+   class Geometry;
+   class Material;
+   class RenderableSet;
+   class ShaderProgram;
+
+   /**
+      \brief Caches how materials are classified by FramePipeline::classify()
+
+      Classifying a material requires scanning the descriptor set layouts of its
+      pipeline, so results are cached per material. Entries are recomputed if
+      the material's pipeline/program changes.
+
+      Entries are keyed by weak references, so a new material allocated at the
+      address of a destroyed one never matches a stale entry. Entries for
+      destroyed materials are dropped by evictExpired().
+
+      \remarks Not thread-safe. Use one cache per thread.
+    */
+   class RenderableClassificationCache {
+   public:
+      FrameSnapshot::Classification classify( Node::Layer::Impl layer, Material *material ) noexcept;
+
+      /**
+         \brief Drops entries for materials that have been destroyed
+       */
+      void evictExpired( void ) noexcept;
+
+      void clear( void ) noexcept { m_entries.clear(); }
+
+      inline size_t size( void ) const noexcept { return m_entries.size(); }
+
+   private:
+      struct Entry {
+         const GraphicsPipeline *pipeline = nullptr;
+         const ShaderProgram *program = nullptr;
+         FrameSnapshot::Classification classification = FrameSnapshot::Classification::NONE;
+      };
+
+      std::map< std::weak_ptr< Material >, Entry, std::owner_less< std::weak_ptr< Material > > > m_entries;
+   };
+
+   /**
+      \brief Collects visible geometries from a scene, grouped by classification
+
+      Subtrees are culled against the camera frustum using their world bounds,
+      so a culled Group discards all of its descendants at once. Nodes with
+      CullMode::NEVER and nodes in the skybox layer are never culled.
+
+      Big scenes are split into subtrees that are traversed in parallel, each
+      chunk with its own output arrays and classification cache. Results are
+      merged in traversal order, so output does not depend on the number of
+      workers.
+    */
+   class RenderableExtractor : public NonCopyable {
+   public:
+      /**
+         \brief Minimum number of subtrees before switching to parallel traversal
+       */
+      static constexpr size_t PARALLEL_MIN_SUBTREES = 16;
+
+      /**
+         \brief Subtrees traversed by each parallel job
+       */
+      static constexpr size_t PARALLEL_GRAIN = 4;
+
+      struct Stats {
+         UInt64 visited = 0;
+         UInt64 culled = 0;
+         UInt64 emitted = 0;
+      };
+
+      /**
+         \brief Output for a single traversal chunk
+       */
+      struct Chunk {
+         std::vector< Geometry * > lit;
+         std::vector< Geometry * > unlit;
+         std::vector< Geometry * > env;
+         std::vector< Geometry * > casters;
+         Stats stats;
+         RenderableClassificationCache classifications;
+
+         void reset( void ) noexcept;
+      };
+
+   public:
+      inline void setParallelEnabled( Bool enabled ) noexcept { m_parallelEnabled = enabled; }
+      inline Bool isParallelEnabled( void ) const noexcept { return m_parallelEnabled; }
+
+      /**
+         \brief Fills renderable sets with the visible geometries in a scene
+
+         If camera is null, no culling is performed. Sets are not reset, so
+         geometries are appended to any existing ones.
+
+         If casters is not null, it is filled with every lit geometry in the
+         scene, whether it is visible or not, since objects outside the camera
+         frustum may still cast shadows into it. Only CullMode::ALWAYS excludes
+         a geometry from casting shadows.
+       */
+      void extract( Node *scene, Camera *camera, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters = nullptr ) noexcept;
+
+      /**
+         \brief Fills renderable sets using a scene index
+
+         Only items in the camera frustum are visited, so big scenes don't need to
+         be traversed at all. Output is sorted in traversal order, matching the
+         one for the overload above. Items outside the frustum count as culled.
+
+         Shadow casters, if requested, are collected from all items in the index.
+
+         The index must be up to date.
+       */
+      void extract( const SceneIndex *index, Camera *camera, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters = nullptr ) noexcept;
+
+      /**
+         \brief Counters for the last extraction
+       */
+      inline const Stats &getStats( void ) const noexcept { return m_stats; }
+
+   private:
+      /**
+         \brief Splits a scene into subtrees that can be traversed independently
+
+         Groups are expanded in place, preserving traversal order. Expanded groups
+         are visited (and maybe culled) here, so they count towards m_stats.
+         When collecting shadow casters, culled groups are kept as subtrees.
+       */
+      void split( Node *scene, Camera *camera, Bool collectCasters ) noexcept;
+
+      /**
+         \brief Appends results from the first chunkCount chunks, in order
+       */
+      void merge( size_t chunkCount, RenderableSet *lit, RenderableSet *unlit, RenderableSet *env, RenderableSet *casters ) noexcept;
+
+   private:
+      Bool m_parallelEnabled = true;
+      Stats m_stats;
+      std::vector< Node * > m_subtrees;
+      std::vector< SceneIndex::Index > m_items;
+      std::vector< std::unique_ptr< Chunk > > m_chunks;
+   };
+
+}
+
+#endif
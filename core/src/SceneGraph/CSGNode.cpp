@@ -41,6 +41,12 @@ CSGNode::CSGNode( Operator op, SharedPointer< Node > const &left, SharedPointer<
     setRight( right );
 }
 
+CSGNode::~CSGNode( void )
+{
+    setLeft( nullptr );
+    setRight( nullptr );
+}
+
 void CSGNode::setLeft( SharedPointer< Node > const &left ) noexcept
 {
     if ( m_left ) {
@@ -62,6 +68,16 @@ void CSGNode::setRight( SharedPointer< Node > const &right ) noexcept
     }
 }
 
+void CSGNode::forEachChild( const std::function< void( Node * ) > &callback )
+{
+    if ( m_left ) {
+        callback( get_ptr( m_left ) );
+    }
+    if ( m_right ) {
+        callback( get_ptr( m_right ) );
+    }
+}
+
 void CSGNode::accept( NodeVisitor &visitor )
 {
     visitor.visitCSGNode( this );
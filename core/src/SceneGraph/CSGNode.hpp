@@ -46,7 +46,7 @@ namespace crimild {
         CSGNode( void ) = default;
         explicit CSGNode( Operator op ) noexcept;
         CSGNode( Operator op, SharedPointer< Node > const &left, SharedPointer< Node > const &right ) noexcept;
-        virtual ~CSGNode( void ) = default;
+        virtual ~CSGNode( void );
 
         inline Operator getOperator( void ) const noexcept { return m_operator; }
 
@@ -56,6 +56,9 @@ namespace crimild {
         inline Node *getRight( void ) noexcept { return get_ptr( m_right ); }
         void setRight( SharedPointer< Node > const &right ) noexcept;
 
+    protected:
+        virtual void forEachChild( const std::function< void( Node * ) > &callback ) override;
+
     private:
         Operator m_operator;
         SharedPointer< Node > m_left;
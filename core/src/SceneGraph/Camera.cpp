@@ -31,7 +31,9 @@
 
 #include <crimild/coding/Decoder.hpp>
 #include <crimild/coding/Encoder.hpp>
+#include <crimild/math/dot.hpp>
 #include <crimild/math/inverse.hpp>
+#include <crimild/math/normalize.hpp>
 #include <crimild/math/origin.hpp>
 #include <crimild/math/perspective.hpp>
 
@@ -89,6 +91,7 @@ Matrix4f Camera::getViewMatrix( void ) const
 void Camera::updateProjectionMatrix( void )
 {
    _projectionMatrix = perspective( m_fov, m_aspect, m_near, m_far );
+   m_frustum = Frustum( m_fov, m_aspect, m_near, m_far );
 }
 
 bool Camera::getPickRay( float portX, float portY, Ray3 &result ) const
@@ -123,40 +126,35 @@ void Camera::setAspectRatio( float aspect )
 
 void Camera::computeCullingPlanes( void )
 {
-   /*
-   Vector3f normal;
-
-   Vector3f position = getWorld().getTranslate();
-   Vector3f direction = getWorld().computeDirection().getNormalized();
-   Vector3f up = getWorld().computeUp().getNormalized();
-   Vector3f right = getWorld().computeRight().getNormalized();
-
-   // near plane
-   _cullingPlanes[ 0 ] = Plane3f( direction, position + getFrustum().getDMin() * direction );
-
-   // far plane
-   _cullingPlanes[ 1 ] = Plane3f( -direction, position + getFrustum().getDMax() * direction );
-
-   // top plane
-   float invLengthTop = 1.0f / sqrtf( getFrustum().getDMin() * getFrustum().getDMin() + getFrustum().getUMax() * getFrustum().getUMax() );
-   normal = ( -getFrustum().getDMin() * up + getFrustum().getUMax() * direction ) * invLengthTop;
-   _cullingPlanes[ 2 ] = Plane3f( normal, position );
-
-   // bottom plane
-   float invLengthBottom = 1.0f / sqrtf( getFrustum().getDMin() * getFrustum().getDMin() + getFrustum().getUMin() * getFrustum().getUMin() );
-   normal = ( getFrustum().getDMin() * up - getFrustum().getUMin() * direction ) * invLengthBottom;
-   _cullingPlanes[ 3 ] = Plane3f( normal, position );
-
-   // left plane
-   float invLengthLeft = 1.0f / sqrtf( getFrustum().getDMin() * getFrustum().getDMin() + getFrustum().getRMin() * getFrustum().getRMin() );
-   normal = ( getFrustum().getDMin() * right - getFrustum().getRMin() * direction ) * invLengthLeft;
-   _cullingPlanes[ 4 ] = Plane3f( normal, position );
-
-   // right plane
-   float invLengthRight = 1.0f / sqrtf( getFrustum().getDMin() * getFrustum().getDMin() + getFrustum().getRMax() * getFrustum().getRMax() );
-   normal = ( -getFrustum().getDMin() * right + getFrustum().getRMax() * direction ) * invLengthRight;
-   _cullingPlanes[ 5 ] = Plane3f( normal, position );
-   */
+   const auto &world = getWorld();
+   const auto position = origin( world );
+   const auto D = forward( world );
+   const auto U = up( world );
+   const auto R = right( world );
+
+   // Plane normals point inwards, so visible volumes are on the positive side of all of them
+   const auto plane = []( const Vector3 &n, const Point3 &p ) {
+      return Plane3 { Normal3( n ), -dot( n, Vector3( p ) ) };
+   };
+
+   const auto dMin = m_frustum.getDMin();
+   const auto dMax = m_frustum.getDMax();
+   const auto uMin = m_frustum.getUMin();
+   const auto uMax = m_frustum.getUMax();
+   const auto rMin = m_frustum.getRMin();
+   const auto rMax = m_frustum.getRMax();
+
+   // near and far
+   _cullingPlanes[ 0 ] = plane( D, position + dMin * D );
+   _cullingPlanes[ 1 ] = plane( -D, position + dMax * D );
+
+   // top and bottom
+   _cullingPlanes[ 2 ] = plane( normalize( -dMin * U + uMax * D ), position );
+   _cullingPlanes[ 3 ] = plane( normalize( dMin * U - uMin * D ), position );
+
+   // left and right
+   _cullingPlanes[ 4 ] = plane( normalize( dMin * R - rMin * D ), position );
+   _cullingPlanes[ 5 ] = plane( normalize( -dMin * R + rMax * D ), position );
 }
 
 bool Camera::culled( const BoundingVolume *volume ) const
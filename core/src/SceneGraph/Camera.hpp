@@ -110,9 +110,18 @@ namespace crimild {
 
       bool culled( const BoundingVolume *volume ) const;
 
+      static constexpr size_t CULLING_PLANE_COUNT = 6;
+
+      /**
+         \brief Frustum planes in world space, pointing inwards
+
+         Only valid after computeCullingPlanes()
+       */
+      inline const Plane3 *getCullingPlanes( void ) const noexcept { return _cullingPlanes; }
+
    private:
       bool _cullingEnabled = true;
-      Plane3 _cullingPlanes[ 6 ];
+      Plane3 _cullingPlanes[ CULLING_PLANE_COUNT ];
 
       /**
        * \name Physical properties
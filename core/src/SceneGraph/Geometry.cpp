@@ -60,16 +60,32 @@ void Geometry::attachPrimitive( SharedPointer< Primitive > const &primitive )
 {
    _primitives.add( primitive );
    updateModelBounds();
+   invalidateHierarchy();
+}
+
+void Geometry::attachPrimitive( SharedPointer< Primitive > const &primitive, const Point3f &min, const Point3f &max )
+{
+   auto bound = localBound();
+   if ( _primitives.empty() ) {
+      bound->computeFrom( min, max );
+   } else {
+      bound->expandToContain( min );
+      bound->expandToContain( max );
+   }
+   _primitives.add( primitive );
+   invalidateHierarchy();
 }
 
 void Geometry::detachPrimitive( Primitive *primitive )
 {
    _primitives.remove( crimild::retain( primitive ) );
+   invalidateHierarchy();
 }
 
 void Geometry::detachPrimitive( SharedPointer< Primitive > const &primitive )
 {
    _primitives.remove( primitive );
+   invalidateHierarchy();
 }
 
 void Geometry::forEachPrimitive( std::function< void( Primitive * ) > callback )
@@ -82,6 +98,7 @@ void Geometry::forEachPrimitive( std::function< void( Primitive * ) > callback )
 void Geometry::detachAllPrimitives( void )
 {
    _primitives.clear();
+   invalidateHierarchy();
 }
 
 void Geometry::accept( NodeVisitor &visitor )
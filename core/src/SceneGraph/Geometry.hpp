@@ -50,6 +50,15 @@ namespace crimild {
       void attachPrimitive( Primitive *primitive );
       void attachPrimitive( SharedPointer< Primitive > const &primitive );
 
+      /**
+         \brief Attaches a primitive whose bounds are already known
+
+         Model bounds are expanded to contain the given box instead of being
+         computed from vertex data, which is never read. Used for primitives
+         loaded from caches.
+       */
+      void attachPrimitive( SharedPointer< Primitive > const &primitive, const Point3f &min, const Point3f &max );
+
       void detachPrimitive( Primitive *primitive );
       void detachPrimitive( SharedPointer< Primitive > const &primitive );
 
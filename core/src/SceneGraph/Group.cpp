@@ -64,9 +64,10 @@ void Group::attachNode( SharedPointer< Node > const &node )
       throw HasParentException( node->getName(), this->getName(), node->getParent()->getName() );
    }
 
-   node->setParent( this );
-
+   // Add it first so the node can be selected when computing its state
    _nodes.add( node );
+
+   node->setParent( this );
 }
 
 void Group::attachNodeAfter( SharedPointer< Node > const &node, SharedPointer< Node > const &before ) noexcept
@@ -82,6 +83,9 @@ void Group::attachNodeAfter( SharedPointer< Node > const &node, SharedPointer< N
       _nodes.add( node );
    }
    node->setParent( this );
+
+   // Inserting may change which children are selected by index
+   refreshChildrenHierarchyState();
 }
 
 void Group::attachNodeBefore( SharedPointer< Node > const &node, SharedPointer< Node > const &before ) noexcept
@@ -98,6 +102,9 @@ void Group::attachNodeBefore( SharedPointer< Node > const &node, SharedPointer<
    }
 
    node->setParent( this );
+
+   // Inserting may change which children are selected by index
+   refreshChildrenHierarchyState();
 }
 
 void Group::detachNode( Node *node )
@@ -105,6 +112,7 @@ void Group::detachNode( Node *node )
    if ( node->getParent() == this ) {
       node->setParent( nullptr );
       _nodes.remove( crimild::retain( node ) );
+      refreshChildrenHierarchyState();
    }
 }
 
@@ -159,6 +167,17 @@ void Group::forEachNode( std::function< void( Node * ) > callback, bool skipDisa
    }
 }
 
+void Group::forEachChild( const std::function< void( Node * ) > &callback )
+{
+   _nodes.each(
+      [ &callback ]( SharedPointer< Node > &node ) {
+         if ( node != nullptr ) {
+            callback( crimild::get_ptr( node ) );
+         }
+      }
+   );
+}
+
 void Group::accept( NodeVisitor &visitor )
 {
    visitor.visitGroup( this );
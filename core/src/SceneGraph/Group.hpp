@@ -77,6 +77,9 @@ namespace crimild {
 
       virtual void forEachNode( std::function< void( Node * ) > callback, bool skipDisabledNodes = true );
 
+   protected:
+      virtual void forEachChild( const std::function< void( Node * ) > &callback ) override;
+
    protected:
       Array< SharedPointer< Node > > _nodes;
 
@@ -35,6 +35,8 @@
 
 using namespace crimild;
 
+std::atomic< UInt64 > Node::s_nextHierarchyVersion = { 1 };
+
 Node::Node( std::string name )
    : NamedObject( name ),
      _local( Transformation::Constants::IDENTITY ),
@@ -50,16 +52,72 @@ Node::~Node( void )
    detachAllComponents();
 }
 
-Node *Node::getRootParent( void )
+void Node::setParent( Node *parent )
+{
+   // Both the previous and the new parent need to recompute their bounds
+   invalidateAncestors( _parent );
+   if ( _parent != nullptr ) {
+      invalidateHierarchy();
+   }
+
+   _parent = parent;
+   updateHierarchyState();
+   invalidateWorldState();
+   invalidateHierarchy();
+}
+
+void Node::updateHierarchyState( void ) noexcept
+{
+   _root = _parent != nullptr ? _parent->_root : this;
+   _depth = _parent != nullptr ? _parent->_depth + 1 : 0;
+   _activeInHierarchy = computeActiveInHierarchy();
+   forEachChild( []( Node *child ) { child->updateHierarchyState(); } );
+}
+
+bool Node::computeActiveInHierarchy( void ) const noexcept
 {
-   auto root = getParent();
-   if ( root != nullptr ) {
-      while ( root->hasParent() ) {
-         root = root->getParent();
+   if ( !_enabled ) {
+      return false;
+   }
+
+   if ( _parent == nullptr ) {
+      return true;
+   }
+
+   return _parent->_activeInHierarchy && _parent->isChildActive( this );
+}
+
+void Node::refreshChildrenHierarchyState( void ) noexcept
+{
+   forEachChild(
+      []( Node *child ) {
+         if ( child->computeActiveInHierarchy() != child->_activeInHierarchy ) {
+            child->updateHierarchyState();
+         }
       }
+   );
+}
+
+bool Node::isInHierarchy( Node *root ) noexcept
+{
+   if ( root == nullptr || root->getRoot() != _root ) {
+      return false;
    }
 
-   return root;
+   if ( root == _root ) {
+      return true;
+   }
+
+   auto node = this;
+   while ( node != nullptr && node != root ) {
+      node = node->getParent();
+   }
+   return node != nullptr;
+}
+
+Node *Node::getRootParent( void )
+{
+   return _root != this ? _root : nullptr;
 }
 
 SharedPointer< Node > Node::detachFromParent( void )
@@ -102,11 +160,19 @@ void Node::attachComponent( SharedPointer< NodeComponent > const &component )
       return;
    }
 
+   const auto typeId = component->getComponentTypeId();
+
    // ignore return?
-   detachComponentWithName( component->getComponentName() );
+   detachComponentWithTypeId( typeId );
 
    component->setNode( this );
-   _components[ component->getComponentName() ] = component;
+
+   auto it = std::find_if( _components.begin(), _components.end(), [ typeId ]( const auto &slot ) { return slot.typeId > typeId; } );
+   _components.insert( it, ComponentSlot { typeId, component } );
+   updateComponentMask();
+
+   ComponentRegistry::getInstance().add( crimild::get_ptr( component ) );
+
    component->onAttach();
 }
 
@@ -117,7 +183,7 @@ void Node::detachComponent( NodeComponent *component )
       return;
    }
 
-   detachComponentWithName( component->getComponentName() );
+   detachComponentWithTypeId( component->getComponentTypeId() );
 }
 
 void Node::detachComponent( SharedPointer< NodeComponent > const &component )
@@ -127,20 +193,28 @@ void Node::detachComponent( SharedPointer< NodeComponent > const &component )
 
 SharedPointer< NodeComponent > Node::detachComponentWithName( std::string name )
 {
-   if ( _components.find( name ) != _components.end() ) {
-      auto current = _components[ name ];
-      if ( current != nullptr ) {
-         current->onDetach();
-         current->setNode( nullptr );
-      }
+   return detachComponentWithTypeId( ComponentRegistry::getInstance().findTypeId( name ) );
+}
+
+SharedPointer< NodeComponent > Node::detachComponentWithTypeId( ComponentTypeId typeId )
+{
+   auto current = crimild::retain( getComponentWithTypeId( typeId ) );
+   if ( current == nullptr ) {
+      return nullptr;
+   }
 
-      _components[ name ] = nullptr;
-      _components.erase( name );
+   current->onDetach();
+   current->setNode( nullptr );
+   ComponentRegistry::getInstance().remove( crimild::get_ptr( current ) );
 
-      return current;
+   // onDetach() might have modified the collection
+   auto it = std::find_if( _components.begin(), _components.end(), [ typeId ]( const auto &slot ) { return slot.typeId == typeId; } );
+   if ( it != _components.end() && it->component == current ) {
+      _components.erase( it );
+      updateComponentMask();
    }
 
-   return nullptr;
+   return current;
 }
 
 void Node::detachAllComponents( void )
@@ -148,9 +222,11 @@ void Node::detachAllComponents( void )
    forEachComponent( []( NodeComponent *cmp ) {
       cmp->onDetach();
       cmp->setNode( nullptr );
+      ComponentRegistry::getInstance().remove( cmp );
    } );
 
    _components.clear();
+   _componentMask = 0;
 }
 
 void Node::startComponents( void )
@@ -170,13 +246,21 @@ void Node::forEachComponent( std::function< void( NodeComponent * ) > callback )
    // components during an update pass
    // TODO: should we lock this instead?
    auto cs = _components;
-   for ( auto cmp : cs ) {
-      if ( cmp.second != nullptr ) {
-         callback( crimild::get_ptr( cmp.second ) );
+   for ( auto &slot : cs ) {
+      if ( slot.component != nullptr ) {
+         callback( crimild::get_ptr( slot.component ) );
       }
    }
 }
 
+void Node::updateComponentMask( void ) noexcept
+{
+   _componentMask = 0;
+   for ( const auto &slot : _components ) {
+      _componentMask |= getComponentMaskBit( slot.typeId );
+   }
+}
+
 void Node::encode( coding::Encoder &encoder )
 {
    Entity::encode( encoder );
@@ -187,9 +271,9 @@ void Node::encode( coding::Encoder &encoder )
    encoder.encode( "worldIsCurrent", worldIsCurrent() );
 
    Array< SharedPointer< NodeComponent > > cmps;
-   for ( auto &it : _components ) {
-      if ( it.second != nullptr ) {
-         cmps.add( it.second );
+   for ( auto &slot : _components ) {
+      if ( slot.component != nullptr ) {
+         cmps.add( slot.component );
       }
    }
    encoder.encode( "components", cmps );
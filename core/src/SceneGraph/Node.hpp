@@ -33,7 +33,9 @@
 #include "Entity/Entity.hpp"
 #include "Visitors/NodeVisitor.hpp"
 
+#include <atomic>
 #include <map>
+#include <vector>
 
 namespace crimild {
 
@@ -60,7 +62,7 @@ namespace crimild {
          return static_cast< NodeClass * >( _parent );
       }
 
-      void setParent( Node *parent ) { _parent = parent; }
+      void setParent( Node *parent );
 
       SharedPointer< Node > detachFromParent( void );
 
@@ -72,6 +74,65 @@ namespace crimild {
          return static_cast< NodeClass * >( getRootParent() );
       }
 
+      /**
+         \brief The topmost ancestor of this node, or the node itself if it has no parent
+
+         Kept up to date when attaching or detaching nodes, so it does not walk the
+         hierarchy (see getRootParent()).
+       */
+      Node *getRoot( void ) noexcept { return _root; }
+
+      /**
+         \brief Checks if this node is either root or one of its descendants
+
+         Nodes in other hierarchies are rejected without walking up the hierarchy.
+       */
+      bool isInHierarchy( Node *root ) noexcept;
+
+      /**
+         \brief Checks if this node and all of its ancestors are enabled and selected
+
+         A node is inactive if it or any of its ancestors is disabled, or if one of its
+         ancestors does not select it (see Switch). Like getRoot(), this is kept up to
+         date when the hierarchy changes instead of walking it.
+       */
+      bool isActiveInHierarchy( void ) const noexcept { return _activeInHierarchy; }
+
+      /**
+         \brief Number of ancestors of this node (zero for roots)
+       */
+      UInt32 getDepth( void ) const noexcept { return _depth; }
+
+   protected:
+      /**
+         \brief Invokes callback for every child of this node
+
+         Unlike visitors, disabled or inactive children are included. Nodes with
+         children must override this so they are kept in the same hierarchy.
+       */
+      virtual void forEachChild( const std::function< void( Node * ) > & ) { }
+
+      /**
+         \brief Whether an active node should keep a given child active
+
+         Defaults to true. Nodes that select some of their children override it
+         and call refreshChildrenHierarchyState() when the selection changes.
+       */
+      virtual bool isChildActive( const Node * ) const { return true; }
+
+      /**
+         \brief Recomputes the active state of children whose state changed
+       */
+      void refreshChildrenHierarchyState( void ) noexcept;
+
+   private:
+      /**
+         \brief Recomputes root, depth and active state for this node and its descendants
+       */
+      void updateHierarchyState( void ) noexcept;
+
+      bool computeActiveInHierarchy( void ) const noexcept;
+
    private:
       /**
                       \brief A node's parent
@@ -81,6 +142,10 @@ namespace crimild {
               */
       Node *_parent = nullptr;
 
+      Node *_root = this;
+      UInt32 _depth = 0;
+      bool _activeInHierarchy = true;
+
    public:
       void perform( NodeVisitor &visitor );
       void perform( const NodeVisitor &visitor );
@@ -98,13 +163,27 @@ namespace crimild {
    public:
       NodeComponent *getComponentWithName( std::string name )
       {
-         return crimild::get_ptr( _components[ name ] );
+         return getComponentWithTypeId( ComponentRegistry::getInstance().findTypeId( name ) );
+      }
+
+      NodeComponent *getComponentWithTypeId( ComponentTypeId typeId )
+      {
+         if ( ( _componentMask & getComponentMaskBit( typeId ) ) == 0 ) {
+            return nullptr;
+         }
+
+         for ( const auto &slot : _components ) {
+            if ( slot.typeId >= typeId ) {
+               return slot.typeId == typeId ? crimild::get_ptr( slot.component ) : nullptr;
+            }
+         }
+         return nullptr;
       }
 
       template< class NODE_COMPONENT_CLASS >
       NODE_COMPONENT_CLASS *getComponent( void )
       {
-         return static_cast< NODE_COMPONENT_CLASS * >( getComponentWithName( NODE_COMPONENT_CLASS::__CLASS_NAME ) );
+         return static_cast< NODE_COMPONENT_CLASS * >( getComponentWithTypeId( ComponentRegistry::getTypeId< NODE_COMPONENT_CLASS >() ) );
       }
 
       bool hasComponent( SharedPointer< NodeComponent > const &component )
@@ -114,8 +193,7 @@ namespace crimild {
 
       bool hasComponent( NodeComponent *component )
       {
-         auto it = _components.find( component->getComponentName() );
-         return ( it != _components.end() && crimild::get_ptr( it->second ) == component );
+         return component != nullptr && getComponentWithTypeId( component->getComponentTypeId() ) == component;
       }
 
       void attachComponent( NodeComponent *component );
@@ -133,6 +211,7 @@ namespace crimild {
       void detachComponent( SharedPointer< NodeComponent > const &component );
 
       SharedPointer< NodeComponent > detachComponentWithName( std::string name );
+      SharedPointer< NodeComponent > detachComponentWithTypeId( ComponentTypeId typeId );
 
       void detachAllComponents( void );
 
@@ -143,19 +222,85 @@ namespace crimild {
       void forEachComponent( std::function< void( NodeComponent * ) > callback );
 
    private:
-      std::map< std::string, SharedPointer< NodeComponent > > _components;
+      /**
+         \brief Components sorted by type id
+
+         Nodes usually have just a few components, so a linear search over
+         a small array is faster than any associative container.
+       */
+      struct ComponentSlot {
+         ComponentTypeId typeId;
+         SharedPointer< NodeComponent > component;
+      };
+
+      std::vector< ComponentSlot > _components;
+
+      /**
+         \brief One bit per type id (modulo 64)
+
+         Used to discard most lookups for components that are not attached.
+       */
+      UInt64 _componentMask = 0;
+
+      static constexpr UInt64 getComponentMaskBit( ComponentTypeId typeId ) noexcept { return UInt64( 1 ) << ( typeId & 63 ); }
+
+      void updateComponentMask( void ) noexcept;
 
    public:
-      void setLocal( const Transformation &t ) { _local = t; }
+      void setLocal( const Transformation &t )
+      {
+         _local = t;
+         invalidateWorldState();
+      }
+
       const Transformation &getLocal( void ) const { return _local; }
-      Transformation &local( void ) { return _local; }
 
-      void setWorld( const Transformation &t ) { _world = t; }
+      /**
+         \brief Mutable access to the local transformation
+
+         The node is assumed to be modified, so its world state is invalidated.
+         Use getLocal() for read-only access.
+       */
+      Transformation &local( void )
+      {
+         invalidateWorldState();
+         return _local;
+      }
+
+      void setWorld( const Transformation &t )
+      {
+         _world = t;
+         invalidateWorldState();
+      }
+
+   private:
+      friend class UpdateWorldState;
+
+      /**
+         \brief Sets a world transformation computed from the local one
+
+         Unlike setWorld(), the world state is not invalidated. Otherwise,
+         UpdateWorldState would flag nodes (and their ancestors) as dirty again
+         while updating them.
+       */
+      void setComputedWorld( const Transformation &t ) noexcept { _world = t; }
+
+   public:
       const Transformation &getWorld( void ) const { return _world; }
-      Transformation &world( void ) { return _world; }
+
+      Transformation &world( void )
+      {
+         invalidateWorldState();
+         return _world;
+      }
 
       bool worldIsCurrent( void ) const { return _worldIsCurrent; }
-      void setWorldIsCurrent( bool isCurrent ) { _worldIsCurrent = isCurrent; }
+
+      void setWorldIsCurrent( bool isCurrent )
+      {
+         _worldIsCurrent = isCurrent;
+         invalidateWorldState();
+      }
 
    private:
       Transformation _local = Transformation::Constants::IDENTITY;
@@ -172,10 +317,25 @@ namespace crimild {
       bool _worldIsCurrent;
 
    public:
-      BoundingVolume *localBound( void ) { return crimild::get_ptr( _localBound ); }
+      BoundingVolume *localBound( void )
+      {
+         invalidateWorldState();
+         return crimild::get_ptr( _localBound );
+      }
+
       const BoundingVolume *getLocalBound( void ) const { return crimild::get_ptr( _localBound ); }
-      void setLocalBound( BoundingVolume *bound ) { _localBound = crimild::retain( bound ); }
-      void setLocalBound( SharedPointer< BoundingVolume > const &bound ) { _localBound = bound; }
+
+      void setLocalBound( BoundingVolume *bound )
+      {
+         _localBound = crimild::retain( bound );
+         invalidateWorldState();
+      }
+
+      void setLocalBound( SharedPointer< BoundingVolume > const &bound )
+      {
+         _localBound = bound;
+         invalidateWorldState();
+      }
 
       BoundingVolume *worldBound( void ) { return crimild::get_ptr( _worldBound ); }
       const BoundingVolume *getWorldBound( void ) const { return crimild::get_ptr( _worldBound ); }
@@ -186,8 +346,88 @@ namespace crimild {
       SharedPointer< BoundingVolume > _localBound;
       SharedPointer< BoundingVolume > _worldBound;
 
+      /**
+         \name World state invalidation
+
+         A node is flagged as dirty whenever its transformation, bounds or
+         hierarchy change. Ancestors of a dirty node are flagged as having dirty
+         descendants, so UpdateWorldState can skip subtrees that did not change.
+       */
+      //@{
+
+   public:
+      void invalidateWorldState( void ) noexcept
+      {
+         _worldStateIsDirty.store( true, std::memory_order_relaxed );
+         invalidateAncestors( _parent );
+      }
+
+      inline bool isWorldStateDirty( void ) const noexcept { return _worldStateIsDirty.load( std::memory_order_relaxed ); }
+      inline bool hasDirtyDescendants( void ) const noexcept { return _hasDirtyDescendants.load( std::memory_order_relaxed ); }
+
+      /**
+         \brief Marks the world state as up to date
+
+         Invoked by UpdateWorldState once the node and all of its descendants
+         have been updated.
+       */
+      void clearWorldStateDirty( void ) noexcept
+      {
+         _worldStateIsDirty.store( false, std::memory_order_relaxed );
+         _hasDirtyDescendants.store( false, std::memory_order_relaxed );
+      }
+
+   private:
+      static void invalidateAncestors( Node *ancestor ) noexcept
+      {
+         // Stop as soon as we find a flagged ancestor. Its own ancestors are flagged too.
+         while ( ancestor != nullptr && !ancestor->hasDirtyDescendants() ) {
+            ancestor->_hasDirtyDescendants.store( true, std::memory_order_relaxed );
+            ancestor = ancestor->_parent;
+         }
+      }
+
+   private:
+      std::atomic< bool > _worldStateIsDirty = { true };
+      std::atomic< bool > _hasDirtyDescendants = { false };
+
+      //@}
+
+      /**
+         \name Hierarchy versioning
+
+         Each hierarchy has a version that changes whenever nodes are attached,
+         detached, enabled or disabled in it, or when their layer, cull mode or
+         primitives change (which might make them unbounded). Structures built
+         from a scene (like SceneIndex) use it to know when they need to be
+         rebuilt, so changes in other hierarchies don't affect them.
+
+         Versions are stored in root nodes and taken from a global sequence, so
+         they never repeat, even if nodes are moved between hierarchies.
+       */
+      //@{
+
    public:
-      void setEnabled( bool enabled ) { _enabled = enabled; }
+      UInt64 getHierarchyVersion( void ) const noexcept { return _root->_hierarchyVersion.load( std::memory_order_relaxed ); }
+
+   protected:
+      void invalidateHierarchy( void ) noexcept { _root->_hierarchyVersion.store( s_nextHierarchyVersion.fetch_add( 1, std::memory_order_relaxed ), std::memory_order_relaxed ); }
+
+   private:
+      std::atomic< UInt64 > _hierarchyVersion = { 0 };
+
+      static std::atomic< UInt64 > s_nextHierarchyVersion;
+
+      //@}
+
+   public:
+      void setEnabled( bool enabled )
+      {
+         _enabled = enabled;
+         updateHierarchyState();
+         invalidateWorldState();
+         invalidateHierarchy();
+      }
       bool isEnabled( void ) { return _enabled; }
 
    private:
@@ -216,7 +456,13 @@ namespace crimild {
       };
 
       inline Layer::Impl getLayer( void ) const { return _layer; }
-      void setLayer( Layer::Impl value ) { _layer = value; }
+      void setLayer( Layer::Impl value )
+      {
+         if ( _layer != value ) {
+            _layer = value;
+            invalidateHierarchy();
+         }
+      }
 
    private:
       Layer::Impl _layer = Layer::DEFAULT;
@@ -239,7 +485,13 @@ namespace crimild {
       };
 
       inline CullMode::Impl getCullMode( void ) const { return _cullMode; }
-      void setCullMode( CullMode::Impl value ) { _cullMode = value; }
+      void setCullMode( CullMode::Impl value )
+      {
+         if ( _cullMode != value ) {
+            _cullMode = value;
+            invalidateHierarchy();
+         }
+      }
 
    private:
       CullMode::Impl _cullMode = CullMode::DEFAULT;
@@ -0,0 +1,731 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SceneGraph/SceneIndex.hpp"
+
+#include "Primitives/Primitive.hpp"
+#include "SceneGraph/CSGNode.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "Visitors/NodeVisitor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <crimild/math/combine.hpp>
+#include <crimild/math/origin.hpp>
+#include <crimild/math/overlaps.hpp>
+#include <crimild/math/radius.hpp>
+#include <crimild/math/surfaceArea.hpp>
+
+using namespace crimild;
+
+namespace crimild::impl {
+
+   class CollectSceneIndexItems : public NodeVisitor {
+   public:
+      explicit CollectSceneIndexItems( std::vector< SharedPointer< Node > > &items ) noexcept
+         : m_items( items )
+      {
+      }
+
+      virtual ~CollectSceneIndexItems( void ) = default;
+
+      void visitGeometry( Geometry *geometry ) override
+      {
+         m_items.push_back( crimild::retain( geometry ) );
+      }
+
+      void visitCSGNode( CSGNode *csg ) override
+      {
+         // Results depend on both operands, so they're indexed as a single item
+         m_items.push_back( crimild::retain( csg ) );
+      }
+
+   private:
+      std::vector< SharedPointer< Node > > &m_items;
+   };
+
+   /**
+      \brief Items that cannot be culled using their bounds
+    */
+   static Bool isUnbounded( Node *node ) noexcept
+   {
+      if ( node->getLayer() == Node::Layer::SKYBOX || node->getCullMode() == Node::CullMode::NEVER ) {
+         return true;
+      }
+
+      auto unbounded = false;
+      if ( auto geometry = dynamic_cast< Geometry * >( node ) ) {
+         // Planes are infinite, but their bounds are not
+         geometry->forEachPrimitive(
+            [ & ]( Primitive *primitive ) {
+               unbounded = unbounded || primitive->getType() == Primitive::Type::PLANE;
+            }
+         );
+      }
+      return unbounded;
+   }
+
+   static Bool isEmpty( const Bounds3 &B ) noexcept
+   {
+      return B.min.x > B.max.x || B.min.y > B.max.y || B.min.z > B.max.z;
+   }
+
+   static Real area( const Bounds3 &B ) noexcept
+   {
+      return isEmpty( B ) ? Real( 0 ) : surfaceArea( B );
+   }
+
+   /**
+      \brief Slab test, with a precomputed inverse direction
+    */
+   static Bool intersects( const Bounds3 &B, const Point3 &O, const Vector3 &invD, Real tMax, Real &tEnter ) noexcept
+   {
+      auto t0 = Real( 0 );
+      auto t1 = tMax;
+      for ( auto a = 0; a < 3; ++a ) {
+         auto tNear = ( B.min[ a ] - O[ a ] ) * invD[ a ];
+         auto tFar = ( B.max[ a ] - O[ a ] ) * invD[ a ];
+         if ( tNear > tFar ) {
+            std::swap( tNear, tFar );
+         }
+         // Written so NaNs (0 * inf) never shrink the range
+         t0 = tNear > t0 ? tNear : t0;
+         t1 = tFar < t1 ? tFar : t1;
+         if ( t0 > t1 ) {
+            return false;
+         }
+      }
+      tEnter = t0;
+      return true;
+   }
+
+   /**
+      \brief Distance to a plane for the corner of a box that is farthest along (or against) its normal
+    */
+   static Real distanceToCorner( const Plane3 &P, const Bounds3 &B, Bool positive ) noexcept
+   {
+      const auto &n = P.n;
+      const auto x = ( n.x >= 0 ) == positive ? B.max.x : B.min.x;
+      const auto y = ( n.y >= 0 ) == positive ? B.max.y : B.min.y;
+      const auto z = ( n.z >= 0 ) == positive ? B.max.z : B.min.z;
+      return n.x * x + n.y * y + n.z * z + P.d;
+   }
+
+   static Vector3 inverseDirection( const Ray3 &R ) noexcept
+   {
+      const auto &D = direction( R );
+      return Vector3 { Real( 1 ) / D.x, Real( 1 ) / D.y, Real( 1 ) / D.z };
+   }
+
+   /**
+      \brief Deeper nodes are always leaves, so traversal stacks never overflow
+    */
+   static constexpr size_t MAX_DEPTH = 48;
+
+   static constexpr size_t MAX_STACK_SIZE = MAX_DEPTH + 2;
+
+}
+
+void SceneIndex::build( Node *scene ) noexcept
+{
+   clear();
+
+   m_scene = scene;
+   if ( scene == nullptr ) {
+      return;
+   }
+
+   m_hierarchyVersion = scene->getHierarchyVersion();
+   collect( scene );
+   rebuild();
+}
+
+void SceneIndex::update( void ) noexcept
+{
+   if ( m_scene == nullptr ) {
+      return;
+   }
+
+   if ( !isCurrent() ) {
+      build( m_scene );
+      return;
+   }
+
+   ++m_updatesSinceBuild;
+   fetchBounds();
+
+   if ( m_rebuildInterval > 0 && m_updatesSinceBuild >= m_rebuildInterval ) {
+      rebuild();
+      return;
+   }
+
+   refit();
+
+   if ( computeCost() > m_rebuildThreshold * m_builtCost ) {
+      rebuild();
+   }
+}
+
+void SceneIndex::clear( void ) noexcept
+{
+   m_scene = nullptr;
+   m_items.clear();
+   m_bounds.clear();
+   m_unbounded.clear();
+   m_nodes.clear();
+   m_entries.clear();
+   m_updatesSinceBuild = 0;
+   m_builtCost = 0;
+}
+
+Bool SceneIndex::isCurrent( void ) const noexcept
+{
+   return m_scene != nullptr && m_hierarchyVersion == m_scene->getHierarchyVersion();
+}
+
+Real SceneIndex::computeCost( void ) const noexcept
+{
+   if ( m_nodes.empty() ) {
+      return 0;
+   }
+
+   const auto rootArea = impl::area( m_nodes.front().bounds );
+   if ( rootArea <= 0 ) {
+      return 0;
+   }
+
+   auto cost = Real( 0 );
+   for ( const auto &node : m_nodes ) {
+      const auto area = impl::area( node.bounds );
+      cost += node.isLeaf() ? area * node.count : area * SAH_TRAVERSAL_COST;
+   }
+   return cost / rootArea;
+}
+
+void SceneIndex::collect( Node *scene ) noexcept
+{
+   impl::CollectSceneIndexItems collect( m_items );
+   collect.traverse( scene );
+
+   m_bounds.resize( m_items.size() );
+   fetchBounds();
+}
+
+void SceneIndex::fetchBounds( void ) noexcept
+{
+   for ( size_t i = 0; i < m_items.size(); ++i ) {
+      const auto bound = m_items[ i ]->getWorldBound();
+      m_bounds[ i ] = Bounds3 { bound->getMin(), bound->getMax() };
+   }
+}
+
+void SceneIndex::rebuild( void ) noexcept
+{
+   m_nodes.clear();
+   m_entries.clear();
+   m_unbounded.clear();
+
+   std::vector< Index > entries;
+   entries.reserve( m_items.size() );
+   for ( size_t i = 0; i < m_items.size(); ++i ) {
+      if ( impl::isUnbounded( get_ptr( m_items[ i ] ) ) ) {
+         m_unbounded.push_back( Index( i ) );
+      } else {
+         entries.push_back( Index( i ) );
+      }
+   }
+
+   if ( !entries.empty() ) {
+      std::vector< Point3 > centroids( m_items.size() );
+      for ( const auto i : entries ) {
+         const auto &B = m_bounds[ i ];
+         centroids[ i ] = Point3 {
+            Real( 0.5 ) * ( B.min.x + B.max.x ),
+            Real( 0.5 ) * ( B.min.y + B.max.y ),
+            Real( 0.5 ) * ( B.min.z + B.max.z ),
+         };
+      }
+
+      m_nodes.reserve( 2 * entries.size() / MAX_LEAF_SIZE + 1 );
+      m_entries.reserve( entries.size() );
+      build( entries, 0, entries.size(), centroids, 0 );
+   }
+
+   m_updatesSinceBuild = 0;
+   m_builtCost = computeCost();
+   ++m_stats.builds;
+}
+
+SceneIndex::Index SceneIndex::build( std::vector< Index > &entries, size_t begin, size_t end, std::vector< Point3 > &centroids, size_t depth ) noexcept
+{
+   const auto nodeIndex = Index( m_nodes.size() );
+   m_nodes.push_back( BVHNode {} );
+
+   auto bounds = Bounds3 {};
+   auto centroidBounds = Bounds3 {};
+   for ( auto i = begin; i < end; ++i ) {
+      bounds = combine( bounds, m_bounds[ entries[ i ] ] );
+      centroidBounds = combine( centroidBounds, centroids[ entries[ i ] ] );
+   }
+   m_nodes[ nodeIndex ].bounds = bounds;
+
+   const auto count = end - begin;
+
+   const auto makeLeaf = [ & ] {
+      auto &node = m_nodes[ nodeIndex ];
+      node.offset = Index( m_entries.size() );
+      node.count = Index( count );
+      for ( auto i = begin; i < end; ++i ) {
+         m_entries.push_back( entries[ i ] );
+      }
+      return nodeIndex;
+   };
+
+   if ( count <= MAX_LEAF_SIZE || depth >= impl::MAX_DEPTH ) {
+      return makeLeaf();
+   }
+
+   const auto extent = centroidBounds.max - centroidBounds.min;
+   const auto axis = extent.x > extent.y ? ( extent.x > extent.z ? 0 : 2 ) : ( extent.y > extent.z ? 1 : 2 );
+   if ( extent[ axis ] <= 0 ) {
+      // All centroids are the same. Splitting won't help.
+      return makeLeaf();
+   }
+
+   // Binned SAH
+   struct Bin {
+      Bounds3 bounds;
+      size_t count = 0;
+   };
+   std::array< Bin, SAH_BIN_COUNT > bins;
+
+   const auto binIndex = [ & ]( Index entry ) {
+      const auto t = ( centroids[ entry ][ axis ] - centroidBounds.min[ axis ] ) / extent[ axis ];
+      return std::min( SAH_BIN_COUNT - 1, size_t( t * SAH_BIN_COUNT ) );
+   };
+
+   for ( auto i = begin; i < end; ++i ) {
+      auto &bin = bins[ binIndex( entries[ i ] ) ];
+      bin.bounds = combine( bin.bounds, m_bounds[ entries[ i ] ] );
+      ++bin.count;
+   }
+
+   // Sweep from the right first, so costs can be computed in a single pass from the left
+   std::array< Real, SAH_BIN_COUNT - 1 > rightCosts;
+   {
+      auto B = Bounds3 {};
+      auto n = size_t( 0 );
+      for ( auto i = SAH_BIN_COUNT - 1; i > 0; --i ) {
+         B = combine( B, bins[ i ].bounds );
+         n += bins[ i ].count;
+         rightCosts[ i - 1 ] = n * impl::area( B );
+      }
+   }
+
+   auto bestCost = numbers::POSITIVE_INFINITY;
+   auto bestSplit = size_t( 0 );
+   {
+      auto B = Bounds3 {};
+      auto n = size_t( 0 );
+      for ( size_t i = 0; i < SAH_BIN_COUNT - 1; ++i ) {
+         B = combine( B, bins[ i ].bounds );
+         n += bins[ i ].count;
+         const auto cost = n * impl::area( B ) + rightCosts[ i ];
+         if ( n > 0 && n < count && cost < bestCost ) {
+            bestCost = cost;
+            bestSplit = i;
+         }
+      }
+   }
+
+   const auto area = impl::area( bounds );
+   const auto leafCost = Real( count );
+   const auto splitCost = SAH_TRAVERSAL_COST + ( area > 0 ? bestCost / area : leafCost );
+
+   auto mid = begin;
+   if ( splitCost < leafCost ) {
+      mid = std::partition(
+               entries.begin() + begin,
+               entries.begin() + end,
+               [ & ]( Index entry ) { return binIndex( entry ) <= bestSplit; }
+            )
+            - entries.begin();
+   }
+
+   if ( mid == begin || mid == end ) {
+      // Either a leaf is cheaper or the partition failed. Leaves can't get too big, though.
+      if ( count <= 4 * MAX_LEAF_SIZE ) {
+         return makeLeaf();
+      }
+      mid = begin + count / 2;
+      std::nth_element(
+         entries.begin() + begin,
+         entries.begin() + mid,
+         entries.begin() + end,
+         [ & ]( Index a, Index b ) { return centroids[ a ][ axis ] < centroids[ b ][ axis ]; }
+      );
+   }
+
+   // Left child is always the next node
+   build( entries, begin, mid, centroids, depth + 1 );
+   const auto right = build( entries, mid, end, centroids, depth + 1 );
+   m_nodes[ nodeIndex ].offset = right;
+
+   return nodeIndex;
+}
+
+void SceneIndex::refit( void ) noexcept
+{
+   // Children are always stored after their parents
+   for ( auto i = m_nodes.size(); i > 0; --i ) {
+      auto &node = m_nodes[ i - 1 ];
+      auto bounds = Bounds3 {};
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            bounds = combine( bounds, m_bounds[ m_entries[ node.offset + j ] ] );
+         }
+      } else {
+         bounds = combine( m_nodes[ i ].bounds, m_nodes[ node.offset ].bounds );
+      }
+      node.bounds = bounds;
+   }
+
+   ++m_stats.refits;
+}
+
+void SceneIndex::queryFrustum( const Camera *camera, std::vector< Index > &results ) const noexcept
+{
+   if ( camera == nullptr || !camera->isCullingEnabled() ) {
+      for ( size_t i = 0; i < m_items.size(); ++i ) {
+         results.push_back( Index( i ) );
+      }
+      return;
+   }
+
+   queryFrustum( camera->getCullingPlanes(), Camera::CULLING_PLANE_COUNT, results );
+}
+
+void SceneIndex::queryFrustum( const Plane3 *planes, size_t planeCount, std::vector< Index > &results ) const noexcept
+{
+   results.insert( results.end(), m_unbounded.begin(), m_unbounded.end() );
+
+   if ( m_nodes.empty() ) {
+      return;
+   }
+
+   assert( planeCount <= 32 && "Too many planes" );
+
+   // Each entry keeps track of the planes that still need to be tested. Once a
+   // node is fully inside a plane, its descendants are too.
+   struct Entry {
+      Index node;
+      UInt32 mask;
+   };
+   std::array< Entry, impl::MAX_STACK_SIZE > stack;
+   size_t top = 0;
+   stack[ top++ ] = Entry { 0, UInt32( ( UInt64( 1 ) << planeCount ) - 1 ) };
+
+   // Returns true if the box is outside any of the planes in the mask. Otherwise,
+   // clears the bits for the planes the box is fully inside of.
+   const auto cull = [ & ]( const Bounds3 &B, UInt32 &mask ) {
+      for ( size_t i = 0; i < planeCount && mask != 0; ++i ) {
+         const auto bit = UInt32( 1 ) << i;
+         if ( mask & bit ) {
+            if ( impl::distanceToCorner( planes[ i ], B, true ) < 0 ) {
+               return true;
+            } else if ( impl::distanceToCorner( planes[ i ], B, false ) >= 0 ) {
+               mask &= ~bit;
+            }
+         }
+      }
+      return false;
+   };
+
+   while ( top > 0 ) {
+      auto [ nodeIndex, mask ] = stack[ --top ];
+      const auto &node = m_nodes[ nodeIndex ];
+
+      if ( cull( node.bounds, mask ) ) {
+         continue;
+      }
+
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            const auto item = m_entries[ node.offset + j ];
+            auto itemMask = mask;
+            if ( !cull( m_bounds[ item ], itemMask ) ) {
+               results.push_back( item );
+            }
+         }
+      } else {
+         stack[ top++ ] = Entry { node.offset, mask };
+         stack[ top++ ] = Entry { nodeIndex + 1, mask };
+      }
+   }
+}
+
+void SceneIndex::queryBounds( const Bounds3 &bounds, std::vector< Index > &results ) const noexcept
+{
+   results.insert( results.end(), m_unbounded.begin(), m_unbounded.end() );
+
+   if ( m_nodes.empty() ) {
+      return;
+   }
+
+   std::array< Index, impl::MAX_STACK_SIZE > stack;
+   size_t top = 0;
+   stack[ top++ ] = 0;
+
+   while ( top > 0 ) {
+      const auto nodeIndex = stack[ --top ];
+      const auto &node = m_nodes[ nodeIndex ];
+      if ( !overlaps( node.bounds, bounds ) ) {
+         continue;
+      }
+
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            const auto item = m_entries[ node.offset + j ];
+            if ( overlaps( m_bounds[ item ], bounds ) ) {
+               results.push_back( item );
+            }
+         }
+      } else {
+         stack[ top++ ] = node.offset;
+         stack[ top++ ] = nodeIndex + 1;
+      }
+   }
+}
+
+void SceneIndex::querySphere( const Sphere &sphere, std::vector< Index > &results ) const noexcept
+{
+   results.insert( results.end(), m_unbounded.begin(), m_unbounded.end() );
+
+   if ( m_nodes.empty() ) {
+      return;
+   }
+
+   const auto &C = origin( sphere );
+   const auto R2 = radius( sphere ) * radius( sphere );
+
+   const auto overlapsSphere = [ & ]( const Bounds3 &B ) {
+      // Squared distance from the center of the sphere to the box
+      auto d2 = Real( 0 );
+      for ( auto a = 0; a < 3; ++a ) {
+         const auto v = C[ a ] < B.min[ a ] ? B.min[ a ] - C[ a ] : ( C[ a ] > B.max[ a ] ? C[ a ] - B.max[ a ] : Real( 0 ) );
+         d2 += v * v;
+      }
+      return d2 <= R2;
+   };
+
+   std::array< Index, impl::MAX_STACK_SIZE > stack;
+   size_t top = 0;
+   stack[ top++ ] = 0;
+
+   while ( top > 0 ) {
+      const auto nodeIndex = stack[ --top ];
+      const auto &node = m_nodes[ nodeIndex ];
+      if ( !overlapsSphere( node.bounds ) ) {
+         continue;
+      }
+
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            const auto item = m_entries[ node.offset + j ];
+            if ( overlapsSphere( m_bounds[ item ] ) ) {
+               results.push_back( item );
+            }
+         }
+      } else {
+         stack[ top++ ] = node.offset;
+         stack[ top++ ] = nodeIndex + 1;
+      }
+   }
+}
+
+void SceneIndex::queryRay( const Ray3 &ray, Real tMax, std::vector< Index > &results ) const noexcept
+{
+   results.insert( results.end(), m_unbounded.begin(), m_unbounded.end() );
+
+   if ( m_nodes.empty() ) {
+      return;
+   }
+
+   const auto &O = origin( ray );
+   const auto invD = impl::inverseDirection( ray );
+
+   std::array< Index, impl::MAX_STACK_SIZE > stack;
+   size_t top = 0;
+   stack[ top++ ] = 0;
+
+   Real t;
+   while ( top > 0 ) {
+      const auto nodeIndex = stack[ --top ];
+      const auto &node = m_nodes[ nodeIndex ];
+      if ( !impl::intersects( node.bounds, O, invD, tMax, t ) ) {
+         continue;
+      }
+
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            const auto item = m_entries[ node.offset + j ];
+            if ( impl::intersects( m_bounds[ item ], O, invD, tMax, t ) ) {
+               results.push_back( item );
+            }
+         }
+      } else {
+         stack[ top++ ] = node.offset;
+         stack[ top++ ] = nodeIndex + 1;
+      }
+   }
+}
+
+SceneIndex::Index SceneIndex::intersectClosest( const Ray3 &ray, const IntersectionCallback &intersect, Real &t ) const noexcept
+{
+   auto closest = INVALID_INDEX;
+   auto tMax = numbers::POSITIVE_INFINITY;
+
+   // Unbounded items first, so they can be used to prune the hierarchy
+   for ( const auto item : m_unbounded ) {
+      const auto tHit = intersect( item, tMax );
+      if ( tHit < tMax ) {
+         tMax = tHit;
+         closest = item;
+      }
+   }
+
+   if ( !m_nodes.empty() ) {
+      const auto &O = origin( ray );
+      const auto invD = impl::inverseDirection( ray );
+
+      struct Entry {
+         Index node;
+         Real tEnter;
+      };
+      std::array< Entry, impl::MAX_STACK_SIZE > stack;
+      size_t top = 0;
+
+      Real tEnter;
+      if ( impl::intersects( m_nodes[ 0 ].bounds, O, invD, tMax, tEnter ) ) {
+         stack[ top++ ] = Entry { 0, tEnter };
+      }
+
+      while ( top > 0 ) {
+         const auto entry = stack[ --top ];
+         if ( entry.tEnter > tMax ) {
+            // A closer hit was found after this node was pushed
+            continue;
+         }
+
+         const auto &node = m_nodes[ entry.node ];
+         if ( node.isLeaf() ) {
+            for ( Index j = 0; j < node.count; ++j ) {
+               const auto item = m_entries[ node.offset + j ];
+               if ( impl::intersects( m_bounds[ item ], O, invD, tMax, tEnter ) ) {
+                  const auto tHit = intersect( item, tMax );
+                  if ( tHit < tMax ) {
+                     tMax = tHit;
+                     closest = item;
+                  }
+               }
+            }
+            continue;
+         }
+
+         Real tLeft, tRight;
+         const auto left = entry.node + 1;
+         const auto right = node.offset;
+         const auto hitLeft = impl::intersects( m_nodes[ left ].bounds, O, invD, tMax, tLeft );
+         const auto hitRight = impl::intersects( m_nodes[ right ].bounds, O, invD, tMax, tRight );
+
+         // Push the farthest child first, so the closest one is visited next
+         if ( hitLeft && hitRight ) {
+            if ( tLeft < tRight ) {
+               stack[ top++ ] = Entry { right, tRight };
+               stack[ top++ ] = Entry { left, tLeft };
+            } else {
+               stack[ top++ ] = Entry { left, tLeft };
+               stack[ top++ ] = Entry { right, tRight };
+            }
+         } else if ( hitLeft ) {
+            stack[ top++ ] = Entry { left, tLeft };
+         } else if ( hitRight ) {
+            stack[ top++ ] = Entry { right, tRight };
+         }
+      }
+   }
+
+   if ( closest != INVALID_INDEX ) {
+      t = tMax;
+   }
+   return closest;
+}
+
+Bool SceneIndex::intersectAny( const Ray3 &ray, Real tMax, const IntersectionCallback &intersect ) const noexcept
+{
+   for ( const auto item : m_unbounded ) {
+      if ( intersect( item, tMax ) < tMax ) {
+         return true;
+      }
+   }
+
+   if ( m_nodes.empty() ) {
+      return false;
+   }
+
+   const auto &O = origin( ray );
+   const auto invD = impl::inverseDirection( ray );
+
+   std::array< Index, impl::MAX_STACK_SIZE > stack;
+   size_t top = 0;
+   stack[ top++ ] = 0;
+
+   Real t;
+   while ( top > 0 ) {
+      const auto nodeIndex = stack[ --top ];
+      const auto &node = m_nodes[ nodeIndex ];
+      if ( !impl::intersects( node.bounds, O, invD, tMax, t ) ) {
+         continue;
+      }
+
+      if ( node.isLeaf() ) {
+         for ( Index j = 0; j < node.count; ++j ) {
+            const auto item = m_entries[ node.offset + j ];
+            if ( impl::intersects( m_bounds[ item ], O, invD, tMax, t ) && intersect( item, tMax ) < tMax ) {
+               return true;
+            }
+         }
+      } else {
+         stack[ top++ ] = node.offset;
+         stack[ top++ ] = nodeIndex + 1;
+      }
+   }
+
+   return false;
+}
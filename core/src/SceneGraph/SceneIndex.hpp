@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_SCENE_GRAPH_SCENE_INDEX_
+#define CRIMILD_CORE_SCENE_GRAPH_SCENE_INDEX_
+
+#include <crimild/foundation.hpp>
+#include <crimild/math/Bounds3.hpp>
+#include <crimild/math/Plane3.hpp>
+#include <crimild/math/Ray3.hpp>
+#include <crimild/math/Sphere.hpp>
+#include <functional>
+#include <vector>
+
+namespace crimild {
+
+   class Camera;
+   class Node;
+
+   /**
+      \brief A bounding volume hierarchy over the renderable nodes in a scene
+
+      Items in the index are geometries and CSG nodes (which are indexed as a
+      whole, without their children), collected in traversal order and using
+      their world bounds. Disabled nodes are not indexed.
+
+      The hierarchy is built using the surface area heuristic (SAH) and it is
+      kept alive between frames. Calling update() after world states have been
+      updated either refits the existing hierarchy, which is linear on the
+      number of items, or rebuilds it if:
+      - The scene hierarchy changed (see Node::getHierarchyVersion()). Changes
+        in other hierarchies are ignored.
+      - Refitting degraded the quality of the hierarchy too much.
+      - The rebuild interval, if any, has elapsed.
+
+      Queries return indices of items, which can be sorted to get them in
+      traversal order. Items that cannot be bounded (like planes, skyboxes or
+      nodes with CullMode::NEVER) are stored apart from the hierarchy and they
+      are returned by every query.
+
+      \remarks Queries are thread-safe as long as update() is not invoked
+      concurrently.
+    */
+   class SceneIndex : public NonCopyable {
+   public:
+      using Index = UInt32;
+
+      static constexpr Index INVALID_INDEX = ~Index( 0 );
+
+      /**
+         \brief Nodes with this many items or fewer are never split
+       */
+      static constexpr size_t MAX_LEAF_SIZE = 4;
+
+      /**
+         \brief Number of bins used to evaluate split candidates
+       */
+      static constexpr size_t SAH_BIN_COUNT = 16;
+
+      /**
+         \brief Cost of traversing a node, relative to testing an item
+       */
+      static constexpr Real SAH_TRAVERSAL_COST = 0.125;
+
+      struct Stats {
+         UInt64 builds = 0;
+         UInt64 refits = 0;
+      };
+
+      /**
+         \brief Invoked for candidate items during ray queries
+
+         Returns the distance to the closest intersection with the item that
+         is less than tMax, or infinity if there is none.
+       */
+      using IntersectionCallback = std::function< Real( Index item, Real tMax ) >;
+
+   public:
+      SceneIndex( void ) = default;
+      ~SceneIndex( void ) = default;
+
+      /**
+         \brief Collects all items in a scene and builds the hierarchy
+
+         World states must be up to date. The scene itself is not retained, so
+         it must outlive the index (or the index must be cleared).
+       */
+      void build( Node *scene ) noexcept;
+
+      /**
+         \brief Refits or rebuilds the hierarchy for the current scene
+       */
+      void update( void ) noexcept;
+
+      void clear( void ) noexcept;
+
+      inline Node *getScene( void ) const noexcept { return m_scene; }
+
+      /**
+         \brief Indicates if the indexed hierarchy did not change since the last build
+       */
+      Bool isCurrent( void ) const noexcept;
+
+      inline size_t getItemCount( void ) const noexcept { return m_items.size(); }
+      inline Node *getItem( Index item ) const noexcept { return get_ptr( m_items[ item ] ); }
+      inline const Bounds3 &getItemBounds( Index item ) const noexcept { return m_bounds[ item ]; }
+
+      inline size_t getNodeCount( void ) const noexcept { return m_nodes.size(); }
+
+      /**
+         \brief Cost of the hierarchy, according to the surface area heuristic
+
+         Relative to the area of the root node, so it can be compared between
+         refits.
+       */
+      Real computeCost( void ) const noexcept;
+
+      /**
+         \brief Rebuild when the cost grows by this factor since the last build
+       */
+      inline void setRebuildThreshold( Real threshold ) noexcept { m_rebuildThreshold = threshold; }
+      inline Real getRebuildThreshold( void ) const noexcept { return m_rebuildThreshold; }
+
+      /**
+         \brief Rebuild after this number of updates. Zero means never.
+       */
+      inline void setRebuildInterval( UInt32 updates ) noexcept { m_rebuildInterval = updates; }
+      inline UInt32 getRebuildInterval( void ) const noexcept { return m_rebuildInterval; }
+
+      inline const Stats &getStats( void ) const noexcept { return m_stats; }
+
+      /**
+         \name Queries
+
+         Results are appended to the output array, in no particular order.
+       */
+      //@{
+
+   public:
+      /**
+         \brief Items inside or intersecting the camera frustum
+
+         Culling planes must be computed before invoking this function.
+       */
+      void queryFrustum( const Camera *camera, std::vector< Index > &results ) const noexcept;
+
+      /**
+         \brief Items on the positive side (or intersecting) of all planes
+       */
+      void queryFrustum( const Plane3 *planes, size_t planeCount, std::vector< Index > &results ) const noexcept;
+
+      void queryBounds( const Bounds3 &bounds, std::vector< Index > &results ) const noexcept;
+
+      void querySphere( const Sphere &sphere, std::vector< Index > &results ) const noexcept;
+
+      /**
+         \brief Items whose bounds are hit by a ray in the range [0, tMax]
+       */
+      void queryRay( const Ray3 &ray, Real tMax, std::vector< Index > &results ) const noexcept;
+
+      /**
+         \brief Finds the closest intersection along a ray
+
+         Nodes are visited front to back and skipped if they are farther than the
+         closest hit so far.
+
+         \returns The item with the closest intersection, or INVALID_INDEX.
+       */
+      Index intersectClosest( const Ray3 &ray, const IntersectionCallback &intersect, Real &t ) const noexcept;
+
+      /**
+         \brief Checks if there is any intersection along a ray in the range [0, tMax]
+
+         Stops as soon as an intersection is found. Useful for shadow rays.
+       */
+      Bool intersectAny( const Ray3 &ray, Real tMax, const IntersectionCallback &intersect ) const noexcept;
+
+      //@}
+
+   private:
+      /**
+         \brief A node in the hierarchy, stored in depth-first order
+
+         The left child of an interior node is always the next one, so only the
+         right one is stored. For leaves, offset points to the first entry in
+         m_entries.
+       */
+      struct BVHNode {
+         Bounds3 bounds;
+         Index offset = 0;
+         Index count = 0;
+
+         inline Bool isLeaf( void ) const noexcept { return count > 0; }
+      };
+
+      void collect( Node *scene ) noexcept;
+      void rebuild( void ) noexcept;
+      Index build( std::vector< Index > &entries, size_t begin, size_t end, std::vector< Point3 > &centroids, size_t depth ) noexcept;
+      void refit( void ) noexcept;
+      void fetchBounds( void ) noexcept;
+
+   private:
+      Node *m_scene = nullptr;
+      UInt64 m_hierarchyVersion = 0;
+
+      /**
+         \brief Indexed nodes, in traversal order
+
+         Nodes are retained, so queries are safe even if the hierarchy changed
+         since the last update.
+       */
+      std::vector< SharedPointer< Node > > m_items;
+      std::vector< Bounds3 > m_bounds;
+
+      /**
+         \brief Items that are not part of the hierarchy
+       */
+      std::vector< Index > m_unbounded;
+
+      std::vector< BVHNode > m_nodes;
+      std::vector< Index > m_entries;
+
+      Real m_rebuildThreshold = 1.5;
+      UInt32 m_rebuildInterval = 0;
+      UInt32 m_updatesSinceBuild = 0;
+      Real m_builtCost = 0;
+
+      Stats m_stats;
+   };
+
+}
+
+#endif
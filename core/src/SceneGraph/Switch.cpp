@@ -57,6 +57,9 @@ void Switch::selectNextNode( void )
     }
 
     _currentIndex = ( _currentIndex + 1 ) % getNodeCount();
+    refreshChildrenHierarchyState();
+    invalidateWorldState();
+    invalidateHierarchy();
 }
 
 void Switch::selectPrevNode( void )
@@ -66,6 +69,17 @@ void Switch::selectPrevNode( void )
     }
 
     _currentIndex = ( _currentIndex + getNodeCount() - 1 ) % getNodeCount();
+    refreshChildrenHierarchyState();
+    invalidateWorldState();
+    invalidateHierarchy();
+}
+
+bool Switch::isChildActive( const Node *child ) const
+{
+    // Only the current node is visited (see forEachNode())
+    return _currentIndex >= 0
+           && _currentIndex < int( _nodes.size() )
+           && crimild::get_ptr( _nodes[ _currentIndex ] ) == child;
 }
 
 Node *Switch::getCurrentNode( void )
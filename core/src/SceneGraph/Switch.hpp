@@ -42,11 +42,20 @@ namespace crimild {
         Node *getCurrentNode( void );
 
         int getCurrentNodeIndex( void ) const { return _currentIndex; }
-        void setCurrentNodeIndex( int index ) { _currentIndex = index; }
+        void setCurrentNodeIndex( int index )
+        {
+            _currentIndex = index;
+            refreshChildrenHierarchyState();
+            invalidateWorldState();
+            invalidateHierarchy();
+        }
 
         void selectNextNode( void );
         void selectPrevNode( void );
 
+    protected:
+        virtual bool isChildActive( const Node *child ) const override;
+
     private:
         int _currentIndex = 0;
     };
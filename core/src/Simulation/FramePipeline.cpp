@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Simulation/FramePipeline.hpp"
+
+#include "Components/MaterialComponent.hpp"
+#include "Concurrency/Async.hpp"
+#include "Rendering/DescriptorSet.hpp"
+#include "Rendering/Material.hpp"
+#include "Rendering/Pipeline.hpp"
+#include "Rendering/RenderableExtractor.hpp"
+#include "Rendering/RenderableSet.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Light.hpp"
+#include "Simulation/Clock.hpp"
+#include "Simulation/Simulation.hpp"
+#include "Visitors/NodeVisitor.hpp"
+#include "Visitors/UpdateComponents.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <thread>
+
+using namespace crimild;
+using namespace crimild::concurrency;
+
+namespace crimild::impl {
+
+   /**
+      \brief Copies the render state of a scene into a snapshot
+    */
+   class CaptureFrameSnapshot : public NodeVisitor {
+   public:
+      explicit CaptureFrameSnapshot( FrameSnapshot &snapshot ) noexcept
+         : m_snapshot( snapshot )
+      {
+      }
+
+      virtual ~CaptureFrameSnapshot( void ) = default;
+
+      void visitGeometry( Geometry *geometry ) override
+      {
+         Material *material = nullptr;
+         if ( auto materials = geometry->getComponent< MaterialComponent >() ) {
+            material = materials->first();
+         }
+
+         FrameSnapshot::Renderable renderable;
+         renderable.geometry = crimild::retain( geometry );
+         renderable.material = crimild::retain( material );
+         renderable.world = geometry->getWorld();
+         if ( auto bound = geometry->getWorldBound() ) {
+            renderable.boundCenter = bound->getCenter();
+            renderable.boundRadius = bound->getRadius();
+         }
+         renderable.layer = geometry->getLayer();
+         m_snapshot.renderables.push_back( std::move( renderable ) );
+      }
+
+      void visitLight( Light *light ) override
+      {
+         m_snapshot.lights.push_back( crimild::retain( light ) );
+      }
+
+   private:
+      FrameSnapshot &m_snapshot;
+   };
+
+}
+
+void FrameSnapshot::reset( void ) noexcept
+{
+   frame = 0;
+   camera = nullptr;
+   renderables.clear();
+   lights.clear();
+
+   if ( litRenderables == nullptr ) {
+      litRenderables = std::make_shared< RenderableSet >();
+      unlitRenderables = std::make_shared< RenderableSet >();
+      envRenderables = std::make_shared< RenderableSet >();
+   }
+
+   litRenderables->reset();
+   unlitRenderables->reset();
+   envRenderables->reset();
+}
+
+FramePipeline::FramePipeline( void )
+   : m_classifications( std::make_unique< RenderableClassificationCache >() )
+{
+   m_snapshots[ 0 ].reset();
+   m_snapshots[ 1 ].reset();
+}
+
+FramePipeline::~FramePipeline( void )
+{
+   flush();
+}
+
+Bool FramePipeline::execute( Node *scene, const Clock &clock, std::function< Bool( void ) > const &render ) noexcept
+{
+   // Render stages consume the last extracted frame, so make sure it's ready
+   waitForExtraction();
+
+   // Update stage. Only render-safe components are updated in parallel with
+   // command recording for the previous frame, since recording reads world
+   // transformations, materials and primitives from live geometries.
+   JobPtr update = nullptr;
+   if ( scene != nullptr ) {
+      if ( TaskSystem::getInstance() != nullptr ) {
+         update = async( [ scene, &clock ] { scene->perform( UpdateComponents( clock, UpdateComponents::Filter::RENDER_SAFE ) ); } );
+      } else {
+         scene->perform( UpdateComponents( clock, UpdateComponents::Filter::RENDER_SAFE ) );
+      }
+   }
+
+   const auto ret = render();
+
+   if ( update != nullptr ) {
+      concurrency::wait( update );
+   }
+
+   if ( !ret || scene == nullptr ) {
+      return ret;
+   }
+
+   // Remaining components might modify anything render stages read, so
+   // they are updated only after recording is done.
+   scene->perform( UpdateComponents( clock, UpdateComponents::Filter::RENDER_UNSAFE ) );
+
+   // World state stage. Requires both update and recording to be completed
+   // since the render stage might still read world transformations.
+   scene->perform( UpdateWorldState() );
+
+   // Capture into the back buffer (the one that is not published)
+   auto &snapshot = m_published == &m_snapshots[ 0 ] ? m_snapshots[ 1 ] : m_snapshots[ 0 ];
+   capture( scene, snapshot );
+
+   // Extraction stage. Only reads from the snapshot, so it can keep running
+   // while the next frame begins.
+   m_pending = &snapshot;
+   m_extracted.store( false, std::memory_order_relaxed );
+   auto extraction = [ this, &snapshot ] {
+      extract( snapshot );
+      m_extracted.store( true, std::memory_order_release );
+   };
+   if ( TaskSystem::getInstance() != nullptr ) {
+      async( extraction );
+   } else {
+      extraction();
+   }
+
+   return true;
+}
+
+void FramePipeline::flush( void ) noexcept
+{
+   waitForExtraction();
+}
+
+void FramePipeline::reset( void ) noexcept
+{
+   flush();
+
+   m_published = nullptr;
+   m_snapshots[ 0 ].reset();
+   m_snapshots[ 1 ].reset();
+   m_classifications->clear();
+}
+
+void FramePipeline::waitForExtraction( void ) noexcept
+{
+   if ( m_pending == nullptr ) {
+      return;
+   }
+
+   auto isExtracted = [ this ] { return m_extracted.load( std::memory_order_acquire ); };
+   if ( auto tasks = TaskSystem::getInstance() ) {
+      tasks->waitUntil( isExtracted );
+   } else {
+      while ( !isExtracted() ) {
+         std::this_thread::yield();
+      }
+   }
+
+   m_published = m_pending;
+   m_pending = nullptr;
+}
+
+void FramePipeline::capture( Node *scene, FrameSnapshot &snapshot ) noexcept
+{
+   snapshot.reset();
+   snapshot.frame = ++m_frame;
+   if ( auto sim = Simulation::getInstance() ) {
+      snapshot.camera = sim->getMainCamera();
+   }
+
+   impl::CaptureFrameSnapshot visitor( snapshot );
+   scene->perform( visitor );
+}
+
+void FramePipeline::extract( FrameSnapshot &snapshot ) noexcept
+{
+   m_classifications->evictExpired();
+
+   for ( auto &renderable : snapshot.renderables ) {
+      renderable.classification = m_classifications->classify( renderable.layer, crimild::get_ptr( renderable.material ) );
+      switch ( renderable.classification ) {
+         case FrameSnapshot::Classification::LIT:
+            snapshot.litRenderables->addGeometry( crimild::get_ptr( renderable.geometry ) );
+            break;
+         case FrameSnapshot::Classification::UNLIT:
+            snapshot.unlitRenderables->addGeometry( crimild::get_ptr( renderable.geometry ) );
+            break;
+         case FrameSnapshot::Classification::ENVIRONMENT:
+            snapshot.envRenderables->addGeometry( crimild::get_ptr( renderable.geometry ) );
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+FrameSnapshot::Classification FramePipeline::classify( Node::Layer::Impl layer, Material *material ) noexcept
+{
+   if ( layer == Node::Layer::SKYBOX ) {
+      return FrameSnapshot::Classification::ENVIRONMENT;
+   }
+
+   if ( material == nullptr ) {
+      return FrameSnapshot::Classification::NONE;
+   }
+
+   // TODO: What if there are multiple materials?
+   // Can we add the same geometry to multiple lists? That will result
+   // in multiple render passes for a single geometry, but I don't know
+   // if that's ok.
+   auto pipeline = material->getGraphicsPipeline();
+   if ( pipeline == nullptr ) {
+      return FrameSnapshot::Classification::NONE;
+   }
+
+   auto program = crimild::get_ptr( pipeline->getProgram() );
+   if ( program == nullptr ) {
+      return FrameSnapshot::Classification::NONE;
+   }
+
+   auto isLit = false;
+   program->descriptorSetLayouts.each(
+      [ & ]( auto layout ) {
+         if ( layout->bindings.filter( []( auto &binding ) { return binding.descriptorType == DescriptorType::ALBEDO_MAP; } ).size() > 0 ) {
+            isLit = true;
+         }
+      }
+   );
+
+   return isLit ? FrameSnapshot::Classification::LIT : FrameSnapshot::Classification::UNLIT;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_SIMULATION_FRAME_PIPELINE_
+#define CRIMILD_CORE_SIMULATION_FRAME_PIPELINE_
+
+#include "SceneGraph/Node.hpp"
+
+#include <atomic>
+#include <crimild/foundation.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace crimild {
+
+   class Camera;
+   class Clock;
+   class Geometry;
+   class Light;
+   class Material;
+   class RenderableClassificationCache;
+   class RenderableSet;
+
+   /**
+      \brief A copy of the render state of a scene for a single frame
+
+      Snapshots are filled right after world state has been computed for a
+      frame, so render stages can work on them while the scene graph is being
+      updated for the next one. Nodes and materials are retained to prevent
+      them from being destroyed while a snapshot is still in use.
+    */
+   struct FrameSnapshot {
+      enum class Classification : UInt8 {
+         NONE,
+         LIT,
+         UNLIT,
+         ENVIRONMENT,
+      };
+
+      struct Renderable {
+         SharedPointer< Geometry > geometry;
+         SharedPointer< Material > material;
+         Transformation world;
+         Point3f boundCenter;
+         Real boundRadius = 0;
+         Node::Layer::Impl layer = Node::Layer::DEFAULT;
+         Classification classification = Classification::NONE;
+      };
+
+      UInt64 frame = 0;
+      Camera *camera = nullptr;
+      std::vector< Renderable > renderables;
+      std::vector< SharedPointer< Light > > lights;
+
+      /**
+         \name Extraction results
+
+         Filled by the extraction stage, grouping renderables the same way
+         framegraph::fetchRenderables() does.
+       */
+      //@{
+
+      SharedPointer< RenderableSet > litRenderables;
+      SharedPointer< RenderableSet > unlitRenderables;
+      SharedPointer< RenderableSet > envRenderables;
+
+      //@}
+
+      void reset( void ) noexcept;
+   };
+
+   /**
+      \brief Overlaps simulation and render stages of consecutive frames
+
+      When enabled, Simulation::step() runs as a sequence of stages:
+
+      1. Update: render-safe components (see NodeComponent::isRenderSafe())
+         are updated for frame N in a background job while the main thread
+         records commands for frame N - 1 (SIMULATION_RENDER). Every other
+         component is updated once both are done.
+      2. World state: world transformations and bounds are propagated for
+         frame N.
+      3. Capture: transformations and bounds of every renderable are copied
+         into the back snapshot.
+      4. Extraction: renderables in the back snapshot are classified in a
+         background job that keeps running while the next frame starts.
+
+      Snapshots are double-buffered. The published one (the last completely
+      extracted frame) is what render stages should consume.
+
+      \remarks Render stages record commands from the live geometries listed
+      in the published snapshot, not from the captured transformations. This is
+      safe only because nothing but render-safe components runs while they do.
+      Components opting in must honor that contract, modifying only state that
+      render stages never read (i.e. local transformations). Any other change
+      can be deferred with concurrency::sync_frame().
+    */
+   class FramePipeline : public NonCopyable {
+   public:
+      FramePipeline( void );
+      ~FramePipeline( void );
+
+      inline void setEnabled( Bool enabled ) noexcept { m_enabled = enabled; }
+      inline Bool isEnabled( void ) const noexcept { return m_enabled; }
+
+      /**
+         \brief Executes a full frame
+
+         The render callback is invoked in the calling thread while the update
+         stage is running. Returns false if the render callback did.
+       */
+      Bool execute( Node *scene, const Clock &clock, std::function< Bool( void ) > const &render ) noexcept;
+
+      /**
+         \brief Waits for any pending stage to complete
+       */
+      void flush( void ) noexcept;
+
+      /**
+         \brief Discards all snapshots, releasing any retained node
+
+         Invoked when the scene changes.
+       */
+      void reset( void ) noexcept;
+
+      /**
+         \brief The last frame whose extraction has been completed
+
+         Might be null if no frame has been completed yet.
+       */
+      inline const FrameSnapshot *getPublishedSnapshot( void ) const noexcept { return m_published; }
+
+      /**
+         \brief Classifies a renderable based on its layer and material
+
+         Lit materials are the ones whose pipeline uses an albedo map.
+       */
+      static FrameSnapshot::Classification classify( Node::Layer::Impl layer, Material *material ) noexcept;
+
+   private:
+      void waitForExtraction( void ) noexcept;
+      void capture( Node *scene, FrameSnapshot &snapshot ) noexcept;
+      void extract( FrameSnapshot &snapshot ) noexcept;
+
+   private:
+      Bool m_enabled = false;
+      UInt64 m_frame = 0;
+      FrameSnapshot m_snapshots[ 2 ];
+      FrameSnapshot *m_published = nullptr;
+      FrameSnapshot *m_pending = nullptr;
+
+      /**
+         \brief Signals that the pending snapshot has been extracted
+
+         Extraction spans frames and job handles are recycled when a new one
+         begins, so we cannot wait on the job itself.
+       */
+      std::atomic< Bool > m_extracted = { true };
+
+      /**
+         \brief Classification results, reused between frames
+
+         Only accessed by the extraction stage, which never runs concurrently
+         with itself.
+       */
+      std::unique_ptr< RenderableClassificationCache > m_classifications;
+   };
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+#include "Simulation/FramePipeline.hpp"
+
+#include "Components/LambdaComponent.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Rendering/RenderableSet.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Simulation/Clock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <crimild/math/translation.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static SharedPointer< Group > createPipelineScene( Size count )
+   {
+      auto scene = std::make_shared< Group >();
+      for ( Size i = 0; i < count; ++i ) {
+         auto geometry = std::make_shared< Geometry >();
+         geometry->attachComponent< LambdaComponent >(
+            []( Node *node, const Clock &clock ) {
+               node->setLocal( translation( Real( clock.getAccumTime() ), 0, 0 ) );
+            }
+         );
+         scene->attachNode( geometry );
+      }
+      return scene;
+   }
+
+}
+
+TEST( FramePipeline, disabled_by_default )
+{
+   FramePipeline pipeline;
+   EXPECT_FALSE( pipeline.isEnabled() );
+   EXPECT_EQ( nullptr, pipeline.getPublishedSnapshot() );
+}
+
+TEST( FramePipeline, render_happens_before_update )
+{
+   auto scene = crimild::test::createPipelineScene( 1 );
+   auto geometry = scene->getNodeAt( 0 );
+
+   FramePipeline pipeline;
+   Clock clock;
+   clock += 1.0;
+
+   auto renderCount = 0;
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         // World state has not been computed for this frame yet
+         EXPECT_EQ( Transformation::Constants::IDENTITY, geometry->getWorld() );
+         ++renderCount;
+         return true;
+      }
+   );
+
+   EXPECT_EQ( 1, renderCount );
+   EXPECT_EQ( translation( Real( clock.getAccumTime() ), 0, 0 ), geometry->getWorld() );
+}
+
+TEST( FramePipeline, only_render_safe_components_overlap_render )
+{
+   auto scene = std::make_shared< Group >();
+   auto geometry = std::make_shared< Geometry >();
+   scene->attachNode( geometry );
+
+   auto safeCount = 0;
+   auto unsafeCount = 0;
+   geometry->attachComponent< LambdaComponent >( [ & ]( Node *, const Clock & ) { ++safeCount; } )->setRenderSafe( true );
+   auto unsafe = std::make_shared< Group >();
+   unsafe->attachComponent< LambdaComponent >( [ & ]( Node *, const Clock & ) { ++unsafeCount; } );
+   scene->attachNode( unsafe );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         EXPECT_EQ( 0, unsafeCount );
+         return true;
+      }
+   );
+
+   EXPECT_EQ( 1, safeCount );
+   EXPECT_EQ( 1, unsafeCount );
+}
+
+TEST( FramePipeline, recording_overlaps_next_update )
+{
+   concurrency::TaskSystem tasks;
+   tasks.configure( 1 );
+   tasks.start();
+
+   // Gives up eventually, so the test fails instead of hanging if stages are serialized
+   auto waitFor = []( std::atomic< Bool > &flag ) {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+      while ( !flag.load() && std::chrono::steady_clock::now() < deadline ) {
+         std::this_thread::yield();
+      }
+      return flag.load();
+   };
+
+   std::atomic< Bool > updating = { false };
+   std::atomic< Bool > recorded = { false };
+
+   auto scene = crimild::test::createPipelineScene( 1 );
+   auto blocking = scene->attachComponent< LambdaComponent >( [ & ]( Node *, const Clock & ) {
+      updating = true;
+      waitFor( recorded );
+   } );
+   blocking->setRenderSafe( true );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         recorded = true;
+         return true;
+      }
+   );
+
+   updating = false;
+   recorded = false;
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         // Frame 2 is being updated while frame 1 is recorded
+         EXPECT_TRUE( waitFor( updating ) );
+         auto snapshot = pipeline.getPublishedSnapshot();
+         EXPECT_NE( nullptr, snapshot );
+         EXPECT_EQ( 1, snapshot->frame );
+         recorded = true;
+         return true;
+      }
+   );
+
+   pipeline.flush();
+   tasks.stop();
+}
+
+TEST( FramePipeline, snapshot_is_published_on_next_frame )
+{
+   auto scene = crimild::test::createPipelineScene( 10 );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   clock += 1.0;
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         EXPECT_EQ( nullptr, pipeline.getPublishedSnapshot() );
+         return true;
+      }
+   );
+
+   const auto worldAtFirstFrame = scene->getNodeAt( 0 )->getWorld();
+
+   clock += 1.0;
+   pipeline.execute(
+      crimild::get_ptr( scene ),
+      clock,
+      [ & ] {
+         auto snapshot = pipeline.getPublishedSnapshot();
+         EXPECT_NE( nullptr, snapshot );
+         EXPECT_EQ( 1, snapshot->frame );
+         EXPECT_EQ( 10, snapshot->renderables.size() );
+         EXPECT_EQ( worldAtFirstFrame, snapshot->renderables[ 0 ].world );
+         return true;
+      }
+   );
+
+   // Snapshot is not affected by later updates
+   pipeline.flush();
+   auto snapshot = pipeline.getPublishedSnapshot();
+   EXPECT_EQ( 2, snapshot->frame );
+   EXPECT_EQ( scene->getNodeAt( 0 )->getWorld(), snapshot->renderables[ 0 ].world );
+   EXPECT_NE( worldAtFirstFrame, snapshot->renderables[ 0 ].world );
+}
+
+TEST( FramePipeline, render_can_terminate )
+{
+   auto scene = crimild::test::createPipelineScene( 1 );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   EXPECT_FALSE( pipeline.execute( crimild::get_ptr( scene ), clock, [] { return false; } ) );
+}
+
+TEST( FramePipeline, reset_discards_snapshots )
+{
+   auto scene = crimild::test::createPipelineScene( 5 );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   pipeline.execute( crimild::get_ptr( scene ), clock, [] { return true; } );
+   pipeline.flush();
+   EXPECT_NE( nullptr, pipeline.getPublishedSnapshot() );
+
+   pipeline.reset();
+   EXPECT_EQ( nullptr, pipeline.getPublishedSnapshot() );
+}
+
+TEST( FramePipeline, classify )
+{
+   EXPECT_EQ( FrameSnapshot::Classification::ENVIRONMENT, FramePipeline::classify( Node::Layer::SKYBOX, nullptr ) );
+   EXPECT_EQ( FrameSnapshot::Classification::NONE, FramePipeline::classify( Node::Layer::DEFAULT, nullptr ) );
+}
+
+TEST( FramePipeline, renderables_without_material_are_not_extracted )
+{
+   auto scene = crimild::test::createPipelineScene( 3 );
+   scene->getNodeAt( 0 )->setLayer( Node::Layer::SKYBOX );
+
+   FramePipeline pipeline;
+   Clock clock;
+
+   pipeline.execute( crimild::get_ptr( scene ), clock, [] { return true; } );
+   pipeline.flush();
+
+   auto snapshot = pipeline.getPublishedSnapshot();
+   EXPECT_EQ( 3, snapshot->renderables.size() );
+   EXPECT_TRUE( snapshot->envRenderables->hasGeometries() );
+   EXPECT_FALSE( snapshot->litRenderables->hasGeometries() );
+   EXPECT_FALSE( snapshot->unlitRenderables->hasGeometries() );
+}
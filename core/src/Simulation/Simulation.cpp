@@ -66,6 +66,14 @@ void Simulation::start( void ) noexcept
       return;
    }
 
+   if ( auto settings = getSettings() ) {
+      m_framePipeline.setEnabled( settings->get< Bool >( "simulation.pipelined", false ) );
+      m_sceneIndexEnabled = settings->get< Bool >( "simulation.scene_index", false );
+      m_animationStageEnabled = settings->get< Bool >( "simulation.parallel_animation", false );
+   }
+
+   updateSceneIndex();
+
    m_running = true;
 }
 
@@ -89,13 +97,31 @@ bool Simulation::step( void ) noexcept
       return false;
    }
 
-   if ( handle( Event { .type = Event::Type::SIMULATION_RENDER } ).type == Event::Type::TERMINATE ) {
-      return false;
-   }
+   if ( m_framePipeline.isEnabled() ) {
+      const auto rendered = m_framePipeline.execute(
+         scene,
+         _simulationClock,
+         [ & ] {
+            return handle( Event { .type = Event::Type::SIMULATION_RENDER } ).type != Event::Type::TERMINATE;
+         }
+      );
+      if ( !rendered ) {
+         return false;
+      }
+   } else {
+      if ( handle( Event { .type = Event::Type::SIMULATION_RENDER } ).type == Event::Type::TERMINATE ) {
+         return false;
+      }
+
+      if ( scene != nullptr ) {
+         if ( auto animations = getAnimationStage() ) {
+            animations->update( scene, _simulationClock );
+         }
+         scene->perform( UpdateComponents( _simulationClock ) );
+         scene->perform( UpdateWorldState() );
+      }
 
-   if ( scene != nullptr ) {
-      scene->perform( UpdateComponents( _simulationClock ) );
-      scene->perform( UpdateWorldState() );
+      updateSceneIndex();
    }
 
 #if CRIMILD_SIMULATION_FORCE_SLEEP_ON_UPDATE
@@ -155,7 +181,7 @@ Event Simulation::handle( const Event &e ) noexcept
          //             Ray3 R;
          //             if ( camera->getPickRay( x, y, R ) ) {
          //                 Picking::Results res;
-         //                 scene->perform( Picking( R, res, []( auto node ) { return node->getClassName() == Geometry::__CLASS_NAME; } ) );
+         //                 scene->perform( Picking( R, res, []( auto node ) { return node->getClassName() == Geometry::__CLASS_NAME; }, getSceneIndex() ) );
          //                 if ( res.hasResults() ) {
          //                     auto node = res.getBestCandidate();
          //                     return Event {
@@ -187,6 +213,10 @@ void Simulation::setScene( SharedPointer< Node > const &scene )
    // If input scene is null, create a NullNode
    // This way we avoid a lot of checks of wheter the scene is valid or not
    // (same for main camera?)
+
+   // Snapshots may still reference nodes from the previous scene
+   m_framePipeline.reset();
+
    _scene = scene;
 
    m_cameras.clear();
@@ -206,6 +236,22 @@ void Simulation::setScene( SharedPointer< Node > const &scene )
       _scene->perform( UpdateWorldState() );
       _scene->perform( StartComponents() );
    }
+
+   updateSceneIndex();
+}
+
+void Simulation::updateSceneIndex( void ) noexcept
+{
+   if ( getSceneIndex() == nullptr || _scene == nullptr ) {
+      m_sceneIndex.clear();
+      return;
+   }
+
+   if ( m_sceneIndex.getScene() != crimild::get_ptr( _scene ) ) {
+      m_sceneIndex.build( crimild::get_ptr( _scene ) );
+   } else {
+      m_sceneIndex.update();
+   }
 }
 
 void Simulation::forEachCamera( std::function< void( Camera * ) > callback )
@@ -30,14 +30,17 @@
 
 #include "AssetManager.hpp"
 #include "Common/Profiler.hpp"
-#include "Concurrency/JobScheduler.hpp"
+#include "Concurrency/TaskSystem.hpp"
 #include "Input.hpp"
 #include "Rendering/Renderer.hpp"
 #include "SceneGraph/Camera.hpp"
 #include "SceneGraph/Node.hpp"
+#include "Animation/AnimationStage.hpp"
+#include "SceneGraph/SceneIndex.hpp"
 #include "Settings.hpp"
 #include "Simulation/Clock.hpp"
 #include "Simulation/Event.hpp"
+#include "Simulation/FramePipeline.hpp"
 #include "Systems/System.hpp"
 
 #include <crimild/foundation.hpp>
@@ -148,6 +151,61 @@ namespace crimild {
    private:
       AssetManager _assetManager;
 
+   public:
+      /**
+         \brief Pipeline used to overlap stages of consecutive frames
+
+         Disabled by default. Use the `simulation.pipelined` setting to enable
+         it on start. Only components flagged as render-safe are updated while
+         commands are recorded (see FramePipeline for the full contract).
+       */
+      inline FramePipeline *getFramePipeline( void ) noexcept { return &m_framePipeline; }
+
+   private:
+      FramePipeline m_framePipeline;
+
+   public:
+      /**
+         \brief Bounding volume hierarchy for the current scene
+
+         Disabled by default. Use the `simulation.scene_index` setting to enable
+         it on start. The index is refitted after world states are updated in
+         each step, but it is not maintained while the frame pipeline is enabled.
+
+         \returns The index, or null if disabled
+       */
+      inline SceneIndex *getSceneIndex( void ) noexcept
+      {
+         return m_sceneIndexEnabled && !m_framePipeline.isEnabled() ? &m_sceneIndex : nullptr;
+      }
+
+   private:
+      void updateSceneIndex( void ) noexcept;
+
+   private:
+      Bool m_sceneIndexEnabled = false;
+      SceneIndex m_sceneIndex;
+
+   public:
+      /**
+         \brief Parallel update of skeletal animations
+
+         Disabled by default. Use the `simulation.parallel_animation` setting to enable
+         it on start. Skeletons with active animations are updated right before other
+         components in each step. The stage is not used while the frame pipeline is
+         enabled, since skinning modifies vertex buffers that might be in use.
+
+         \returns The stage, or null if disabled
+       */
+      inline animation::AnimationStage *getAnimationStage( void ) noexcept
+      {
+         return m_animationStageEnabled && !m_framePipeline.isEnabled() ? &m_animationStage : nullptr;
+      }
+
+   private:
+      Bool m_animationStageEnabled = false;
+      animation::AnimationStage m_animationStage;
+
    private:
       Profiler _profiler;
       Input _input;
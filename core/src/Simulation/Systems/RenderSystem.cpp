@@ -235,6 +235,7 @@ void RenderSystem::useDefaultRenderPath( Bool enableDebug ) noexcept
             auto litRenderables = renderables->getProduct( 0 );
             auto unlitRenderables = renderables->getProduct( 1 );
             auto envRenderables = renderables->getProduct( 2 );
+            auto shadowCasters = renderables->getProduct( 3 );
 
             auto gBuffer = gBufferPass( litRenderables );
             auto albedo = gBuffer->getProduct( 0 );
@@ -268,7 +269,7 @@ void RenderSystem::useDefaultRenderPath( Bool enableDebug ) noexcept
             auto prefilterMapPass = computePrefilterMap( useResource( reflectionAtlasPass ) );
             auto brdfLutPass = computeBRDFLUT( nullptr );
 
-            auto shadowAtlasPass = renderShadowAtlas( litRenderables );
+            auto shadowAtlasPass = renderShadowAtlas( shadowCasters );
 
             auto shadowAtlas = useResource( shadowAtlasPass );
             auto reflectionAtlas = useResource( reflectionAtlasPass );
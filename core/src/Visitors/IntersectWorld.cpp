@@ -33,7 +33,9 @@
 #include "SceneGraph/CSGNode.hpp"
 #include "SceneGraph/Geometry.hpp"
 #include "SceneGraph/Group.hpp"
+#include "SceneGraph/SceneIndex.hpp"
 
+#include <algorithm>
 #include <crimild/math/Random.hpp>
 #include <crimild/math/intersect.hpp>
 #include <crimild/math/inverse.hpp>
@@ -45,7 +47,18 @@ using namespace crimild;
 
 void IntersectWorld::traverse( Node *node ) noexcept
 {
-   NodeVisitor::traverse( node );
+   if ( m_index != nullptr && m_index->getScene() == node && m_index->isCurrent() ) {
+      std::vector< SceneIndex::Index > candidates;
+      m_index->queryRay( m_ray, numbers::POSITIVE_INFINITY, candidates );
+
+      // Keep traversal order, so results are the same as without the index
+      std::sort( candidates.begin(), candidates.end() );
+      for ( const auto item : candidates ) {
+         m_index->getItem( item )->accept( *this );
+      }
+   } else {
+      NodeVisitor::traverse( node );
+   }
 
    m_results.sort( []( auto &a, auto &b ) { return a.t < b.t; } );
 }
@@ -40,10 +40,14 @@ namespace crimild {
 
    class Geometry;
    class Primitive;
+   class SceneIndex;
 
    /**
     * Collects geometries that intersect with a given ray
     *
+    * If a scene index is provided and it is up to date, only geometries whose
+    * bounds are hit by the ray are tested. Otherwise, the whole scene is traversed.
+    *
     * \todo Test intersection with groups to speed things up
     */
    class IntersectWorld : public NodeVisitor {
@@ -72,6 +76,14 @@ namespace crimild {
          // no-op
       }
 
+      IntersectWorld( const Ray3 &ray, Results &results, const SceneIndex *index ) noexcept
+         : m_ray( ray ),
+           m_results( results ),
+           m_index( index )
+      {
+         // no-op
+      }
+
       ~IntersectWorld( void ) = default;
 
       virtual void traverse( Node *node ) noexcept override;
@@ -85,6 +97,7 @@ namespace crimild {
    private:
       Ray3 m_ray;
       Results &m_results;
+      const SceneIndex *m_index = nullptr;
    };
 
 }
@@ -29,15 +29,19 @@
 
 #include "SceneGraph/Group.hpp"
 #include "SceneGraph/Node.hpp"
+#include "SceneGraph/SceneIndex.hpp"
 
+#include <algorithm>
 #include <crimild/math/distance.hpp>
+#include <crimild/math/numbers.hpp>
 
 using namespace crimild;
 
-Picking::Picking( const Ray3 &tester, Picking::Results &results, FilterType filter )
+Picking::Picking( const Ray3 &tester, Picking::Results &results, FilterType filter, const SceneIndex *index )
    : _tester( tester ),
      _results( results ),
-     _filter( filter )
+     _filter( filter ),
+     _index( index )
 {
 }
 
@@ -49,7 +53,17 @@ void Picking::traverse( Node *node )
 {
    _results.reset();
 
-   NodeVisitor::traverse( node );
+   // Without a filter, groups are candidates too, but they are not indexed
+   if ( _filter != nullptr && _index != nullptr && _index->getScene() == node && _index->isCurrent() ) {
+      std::vector< SceneIndex::Index > candidates;
+      _index->queryRay( _tester, numbers::POSITIVE_INFINITY, candidates );
+      std::sort( candidates.begin(), candidates.end() );
+      for ( const auto item : candidates ) {
+         visitNode( _index->getItem( item ) );
+      }
+   } else {
+      NodeVisitor::traverse( node );
+   }
 
    // sort nodes based on how close the ray is to
    // intersecting the scene of each bounding volume
@@ -37,6 +37,18 @@
 
 namespace crimild {
 
+   class SceneIndex;
+
+   /**
+      \brief Collects nodes whose bounds intersect a ray
+
+      If a scene index is provided and it is up to date, only indexed nodes
+      (geometries and CSG nodes) are passed to the filter, so groups and any
+      other node are never picked. Use an index only with filters that reject
+      those nodes anyway. Without a filter every node is a candidate, so the
+      whole scene is traversed even if an index is provided, as it is when
+      the index is not up to date.
+    */
    class Picking : public NodeVisitor {
    private:
       typedef std::function< bool( Node * ) > FilterType;
@@ -89,7 +101,7 @@ namespace crimild {
       };
 
    public:
-      Picking( const Ray3 &tester, Results &results, FilterType filter = nullptr );
+      Picking( const Ray3 &tester, Results &results, FilterType filter = nullptr, const SceneIndex *index = nullptr );
       virtual ~Picking( void );
 
       virtual void traverse( Node *node ) override;
@@ -101,6 +113,7 @@ namespace crimild {
       Ray3 _tester;
       Results &_results;
       FilterType _filter;
+      const SceneIndex *_index = nullptr;
    };
 
 }
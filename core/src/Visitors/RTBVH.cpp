@@ -0,0 +1,1061 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Visitors/RTBVH.hpp"
+
+#include "Rendering/RTRandom.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <crimild/math/Box.hpp>
+#include <crimild/math/Cylinder.hpp>
+#include <crimild/math/Sphere.hpp>
+#include <crimild/math/combine.hpp>
+#include <crimild/math/intersect.hpp>
+#include <crimild/math/inverse.hpp>
+#include <crimild/math/length.hpp>
+#include <crimild/math/normal.hpp>
+#include <crimild/math/surfaceArea.hpp>
+#include <crimild/math/whichSide.hpp>
+#include <numeric>
+#include <unordered_map>
+
+using namespace crimild;
+
+namespace crimild::impl {
+
+   static Real area( const Bounds3 &B ) noexcept
+   {
+      const auto isEmpty = B.min.x > B.max.x || B.min.y > B.max.y || B.min.z > B.max.z;
+      return isEmpty ? Real( 0 ) : surfaceArea( B );
+   }
+
+   static Point3 centroid( const Bounds3 &B ) noexcept
+   {
+      return Point3 {
+         Real( 0.5 ) * ( B.min.x + B.max.x ),
+         Real( 0.5 ) * ( B.min.y + B.max.y ),
+         Real( 0.5 ) * ( B.min.z + B.max.z ),
+      };
+   }
+
+   /**
+      \brief Keeps the closest of two intersections (if any) for a unit shape
+    */
+   template< typename Shape >
+   static Bool intersectSurface( const Ray3 &R, const Shape &S, const RTAcceleratedNode &node, Real t0, Real t1, RTIntersection &result ) noexcept
+   {
+      for ( const auto t : { t0, t1 } ) {
+         if ( t >= numbers::EPSILON && t < result.t ) {
+            result.t = t;
+            result.point = R( t );
+            result.setFaceNormal( R, normal( S, node.world, result.point ) );
+            result.materialId = node.materialIndex;
+            return true;
+         }
+      }
+      return false;
+   }
+
+   /**
+      \brief Samples a scattering event inside a volume, between t0 and t1
+    */
+   static Bool intersectVolume( const Ray3 &R, const RTAcceleratedNode &node, Real density, Real t0, Real t1, RTIntersection &result ) noexcept
+   {
+      if ( t0 < 0 ) {
+         t0 = 0;
+      }
+
+      if ( t1 <= t0 ) {
+         return false;
+      }
+
+      const auto d = length( direction( R ) );
+      const auto distanceInsideBoundary = ( t1 - t0 ) * d;
+      const auto hitDistance = ( Real( -1 ) / density ) * std::log( RTRandom::getInstance().next() );
+      if ( hitDistance > distanceInsideBoundary ) {
+         return false;
+      }
+
+      const auto t = t0 + hitDistance / d;
+      if ( t >= result.t ) {
+         return false;
+      }
+
+      result.t = t;
+      result.point = R( t );
+      result.normal = Normal3 { 1, 0, 0 }; // arbitrary value
+      result.frontFace = true;             // arbitrary value
+      result.materialId = node.materialIndex;
+      return true;
+   }
+
+   /**
+      \brief Intersects a unit primitive (sphere, box or cylinder)
+    */
+   static Bool intersectPrimitive( const Ray3 &R, const RTAcceleration::Result &scene, const RTAcceleratedNode &node, RTIntersection &result ) noexcept
+   {
+      Real t0, t1;
+      switch ( node.type ) {
+         case RTAcceleratedNode::Type::PRIMITIVE_SPHERE: {
+            const auto S = Sphere {};
+            return intersect( R, S, node.world, t0, t1 ) && intersectSurface( R, S, node, t0, t1, result );
+         }
+
+         case RTAcceleratedNode::Type::PRIMITIVE_BOX: {
+            const auto B = Box {};
+            if ( !intersect( R, B, node.world, t0, t1 ) ) {
+               return false;
+            }
+            const auto &material = scene.materials[ node.materialIndex ];
+            if ( material.density >= 0 ) {
+               return intersectVolume( R, node, material.density, t0, t1, result );
+            }
+            return intersectSurface( R, B, node, t0, t1, result );
+         }
+
+         case RTAcceleratedNode::Type::PRIMITIVE_CYLINDER: {
+            const auto C = Cylinder { .closed = true };
+            return intersect( R, C, node.world, t0, t1 ) && intersectSurface( R, C, node, t0, t1, result );
+         }
+
+         default: {
+            return false;
+         }
+      }
+   }
+
+   /**
+      \brief Intersects a triangulated primitive using its kd-tree
+    */
+   static Bool intersectKdTree( const Ray3 &R, const RTAcceleration::Result &scene, Int32 nodeId, Real minT, Real maxT, RTIntersection &result ) noexcept
+   {
+      Bool hasResult = false;
+
+      const auto &node = scene.nodes[ nodeId ];
+      const auto primIdx = node.primitiveIndex;
+      if ( primIdx < 0 ) {
+         return false;
+      }
+
+      struct FrontierNode {
+         Int32 id;
+         Real t0;
+         Real t1;
+      };
+
+      FrontierNode frontier[ 64 ] = { { primIdx, minT, maxT } };
+      Int32 currentIdx = 0;
+
+      while ( currentIdx >= 0 ) {
+         const auto expanded = frontier[ currentIdx-- ];
+         if ( expanded.id < 0 ) {
+            continue;
+         }
+
+         const auto &prim = scene.primitives.primTree[ expanded.id ];
+         if ( prim.isLeaf() ) {
+            const auto idxOffset = prim.primitiveIndicesOffset;
+            const auto primCount = prim.getPrimCount();
+            for ( auto i = 0; i < primCount; ++i ) {
+               const auto baseIdx = scene.primitives.indexOffsets[ idxOffset + i ];
+
+               const auto &v0 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 0 ] ];
+               const auto &v1 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 1 ] ];
+               const auto &v2 = scene.primitives.triangles[ scene.primitives.indices[ baseIdx + 2 ] ];
+
+               const auto T = Triangle {
+                  Point3( v0.position ),
+                  Point3( v1.position ),
+                  Point3( v2.position ),
+               };
+
+               Real t;
+               if ( intersect( R, T, node.world, t ) ) {
+                  if ( t >= numbers::EPSILON && t < result.t ) {
+                     result.t = t;
+                     result.point = R( result.t );
+                     result.setFaceNormal( R, Normal3( v0.normal ) );
+                     result.materialId = node.materialIndex;
+                     hasResult = true;
+                  }
+               }
+            }
+         } else {
+            const auto P = Plane3 {
+               [ & ] {
+                  auto N = Normal3 { 0, 0, 0 };
+                  N[ prim.getSplitAxis() ] = 1;
+                  return N;
+               }(),
+               prim.getSplitPos()
+            };
+
+            const auto R1 = inverse( node.world )( R );
+
+            Real t;
+            if ( intersect( R1, P, t ) ) {
+               if ( prim.getAboveChild() > ( expanded.id + 1 ) ) {
+                  const bool belowFirst = whichSide( P, origin( R1 ) ) < 0;
+                  if ( belowFirst ) {
+                     frontier[ ++currentIdx ] = { prim.getAboveChild(), t, expanded.t1 };
+                     frontier[ ++currentIdx ] = { expanded.id + 1, expanded.t0, t };
+                  } else {
+                     frontier[ ++currentIdx ] = { expanded.id + 1, expanded.t0, t };
+                     frontier[ ++currentIdx ] = { prim.getAboveChild(), t, expanded.t1 };
+                  }
+               } else {
+                  frontier[ ++currentIdx ] = { expanded.id + 1, expanded.t0, t };
+               }
+            }
+         }
+      }
+
+      return hasResult;
+   }
+
+   /**
+      \brief Transforms all lanes in a packet, keeping distances and hits
+
+      Transformations are affine, so they're applied to every lane as a 3x4 matrix.
+      Directions are not normalized, so distances along transformed rays are the
+      same as in the original space.
+    */
+   static void transformPacket( const RTRayPacket &packet, const Transformation &T, RTRayPacket &out ) noexcept
+   {
+      const auto X = T( Vector3 { 1, 0, 0 } );
+      const auto Y = T( Vector3 { 0, 1, 0 } );
+      const auto Z = T( Vector3 { 0, 0, 1 } );
+      const auto &P = T.translate;
+
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         const auto ox = packet.ox[ l ];
+         const auto oy = packet.oy[ l ];
+         const auto oz = packet.oz[ l ];
+         out.ox[ l ] = X.x * ox + Y.x * oy + Z.x * oz + P.x;
+         out.oy[ l ] = X.y * ox + Y.y * oy + Z.y * oz + P.y;
+         out.oz[ l ] = X.z * ox + Y.z * oy + Z.z * oz + P.z;
+
+         const auto dx = packet.dx[ l ];
+         const auto dy = packet.dy[ l ];
+         const auto dz = packet.dz[ l ];
+         out.dx[ l ] = X.x * dx + Y.x * dy + Z.x * dz;
+         out.dy[ l ] = X.y * dx + Y.y * dy + Z.y * dz;
+         out.dz[ l ] = X.z * dx + Y.z * dy + Z.z * dz;
+      }
+
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         constexpr auto TINY = Real32( 1e-20 );
+         out.ix[ l ] = Real32( 1 ) / ( out.dx[ l ] >= 0 ? std::max( out.dx[ l ], TINY ) : std::min( out.dx[ l ], -TINY ) );
+         out.iy[ l ] = Real32( 1 ) / ( out.dy[ l ] >= 0 ? std::max( out.dy[ l ], TINY ) : std::min( out.dy[ l ], -TINY ) );
+         out.iz[ l ] = Real32( 1 ) / ( out.dz[ l ] >= 0 ? std::max( out.dz[ l ], TINY ) : std::min( out.dz[ l ], -TINY ) );
+         out.t[ l ] = packet.t[ l ];
+         out.instance[ l ] = packet.instance[ l ];
+         out.primitive[ l ] = packet.primitive[ l ];
+      }
+
+      out.count = packet.count;
+   }
+
+   /**
+      \brief Keeps distances in ts for lanes in mask that are closer than their current hits
+    */
+   static void commitPacket( RTRayPacket &packet, UInt32 mask, const Real32 *ts, Int32 primitive ) noexcept
+   {
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         if ( ( mask & ( 1u << l ) ) && ts[ l ] < packet.t[ l ] ) {
+            packet.t[ l ] = ts[ l ];
+            packet.primitive[ l ] = primitive;
+         }
+      }
+   }
+
+   /**
+      \brief Intersects all lanes with a unit sphere, in object space
+    */
+   static void intersectSpherePacket( RTRayPacket &packet, UInt32 mask ) noexcept
+   {
+      alignas( 32 ) Real32 ts[ RTRayPacket::SIZE ];
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         const auto ox = packet.ox[ l ];
+         const auto oy = packet.oy[ l ];
+         const auto oz = packet.oz[ l ];
+         const auto dx = packet.dx[ l ];
+         const auto dy = packet.dy[ l ];
+         const auto dz = packet.dz[ l ];
+
+         const auto a = dx * dx + dy * dy + dz * dz;
+         const auto b = ox * dx + oy * dy + oz * dz;
+         const auto c = ox * ox + oy * oy + oz * oz - 1;
+         const auto d = b * b - a * c;
+         const auto s = std::sqrt( std::max( d, Real32( 0 ) ) );
+         const auto t0 = ( -b - s ) / a;
+         const auto t1 = ( -b + s ) / a;
+         const auto t = t0 >= numbers::EPSILON ? t0 : t1;
+         ts[ l ] = d >= 0 && t >= numbers::EPSILON ? t : numbers::POSITIVE_INFINITY;
+      }
+      commitPacket( packet, mask, ts, RTRayPacket::UNIT_PRIMITIVE );
+   }
+
+   /**
+      \brief Intersects all lanes with the surface of a unit box, in object space
+    */
+   static void intersectBoxPacket( RTRayPacket &packet, UInt32 mask ) noexcept
+   {
+      alignas( 32 ) Real32 ts[ RTRayPacket::SIZE ];
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         const auto tx0 = ( -1 - packet.ox[ l ] ) * packet.ix[ l ];
+         const auto tx1 = ( +1 - packet.ox[ l ] ) * packet.ix[ l ];
+         const auto ty0 = ( -1 - packet.oy[ l ] ) * packet.iy[ l ];
+         const auto ty1 = ( +1 - packet.oy[ l ] ) * packet.iy[ l ];
+         const auto tz0 = ( -1 - packet.oz[ l ] ) * packet.iz[ l ];
+         const auto tz1 = ( +1 - packet.oz[ l ] ) * packet.iz[ l ];
+         const auto t0 = std::max( std::max( std::min( tx0, tx1 ), std::min( ty0, ty1 ) ), std::min( tz0, tz1 ) );
+         const auto t1 = std::min( std::min( std::max( tx0, tx1 ), std::max( ty0, ty1 ) ), std::max( tz0, tz1 ) );
+         const auto t = t0 >= numbers::EPSILON ? t0 : t1;
+         ts[ l ] = t0 < t1 && t >= numbers::EPSILON ? t : numbers::POSITIVE_INFINITY;
+      }
+      commitPacket( packet, mask, ts, RTRayPacket::UNIT_PRIMITIVE );
+   }
+
+   /**
+      \brief Intersects all lanes with a closed unit cylinder, in object space
+    */
+   static void intersectCylinderPacket( RTRayPacket &packet, UInt32 mask ) noexcept
+   {
+      const auto closest = []( Bool valid, Real32 t, Real32 tMin ) {
+         return valid && t >= numbers::EPSILON && t < tMin ? t : tMin;
+      };
+
+      alignas( 32 ) Real32 ts[ RTRayPacket::SIZE ];
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         const auto ox = packet.ox[ l ];
+         const auto oy = packet.oy[ l ];
+         const auto oz = packet.oz[ l ];
+         const auto dx = packet.dx[ l ];
+         const auto dy = packet.dy[ l ];
+         const auto dz = packet.dz[ l ];
+
+         // Side
+         const auto a = dx * dx + dz * dz;
+         const auto b = 2 * ( ox * dx + oz * dz );
+         const auto c = ox * ox + oz * oz - 1;
+         const auto d = b * b - 4 * a * c;
+         const auto hasSide = d >= 0 && a > numbers::EPSILON;
+         const auto s = std::sqrt( std::max( d, Real32( 0 ) ) );
+         const auto inv2a = Real32( 0.5 ) / std::max( a, Real32( numbers::EPSILON ) );
+         const auto ts0 = ( -b - s ) * inv2a;
+         const auto ts1 = ( -b + s ) * inv2a;
+         const auto y0 = oy + ts0 * dy;
+         const auto y1 = oy + ts1 * dy;
+
+         // Caps
+         const auto hasCaps = std::abs( dy ) > numbers::EPSILON;
+         const auto tc0 = ( -1 - oy ) * packet.iy[ l ];
+         const auto tc1 = ( +1 - oy ) * packet.iy[ l ];
+         const auto x0 = ox + tc0 * dx;
+         const auto z0 = oz + tc0 * dz;
+         const auto x1 = ox + tc1 * dx;
+         const auto z1 = oz + tc1 * dz;
+
+         auto t = numbers::POSITIVE_INFINITY;
+         t = closest( hasSide && y0 < 1 && y0 > -1, ts0, t );
+         t = closest( hasSide && y1 < 1 && y1 > -1, ts1, t );
+         t = closest( hasCaps && x0 * x0 + z0 * z0 <= 1, tc0, t );
+         t = closest( hasCaps && x1 * x1 + z1 * z1 <= 1, tc1, t );
+         ts[ l ] = t;
+      }
+      commitPacket( packet, mask, ts, RTRayPacket::UNIT_PRIMITIVE );
+   }
+
+   /**
+      \brief Intersects the lanes in mask with a single triangle, in object space
+    */
+   static void intersectTrianglePacket( RTRayPacket &packet, UInt32 mask, const Triangle &T, Int32 triangleIndex ) noexcept
+   {
+      const auto e0 = T.p1 - T.p0;
+      const auto e1 = T.p2 - T.p0;
+
+      alignas( 32 ) Real32 ts[ RTRayPacket::SIZE ];
+      for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+         const auto dx = packet.dx[ l ];
+         const auto dy = packet.dy[ l ];
+         const auto dz = packet.dz[ l ];
+
+         // Möller-Trumbore, like crimild::intersect( Ray3, Triangle )
+         const auto px = dy * e1.z - dz * e1.y;
+         const auto py = dz * e1.x - dx * e1.z;
+         const auto pz = dx * e1.y - dy * e1.x;
+         const auto det = e0.x * px + e0.y * py + e0.z * pz;
+         const auto f = Real32( 1 ) / ( std::abs( det ) > numbers::EPSILON ? det : Real32( 1 ) );
+
+         const auto sx = packet.ox[ l ] - T.p0.x;
+         const auto sy = packet.oy[ l ] - T.p0.y;
+         const auto sz = packet.oz[ l ] - T.p0.z;
+         const auto u = f * ( sx * px + sy * py + sz * pz );
+
+         const auto qx = sy * e0.z - sz * e0.y;
+         const auto qy = sz * e0.x - sx * e0.z;
+         const auto qz = sx * e0.y - sy * e0.x;
+         const auto v = f * ( dx * qx + dy * qy + dz * qz );
+         const auto t = f * ( e1.x * qx + e1.y * qy + e1.z * qz );
+
+         const auto valid = std::abs( det ) > numbers::EPSILON && u >= 0 && v >= 0 && u + v <= 1 && t >= numbers::EPSILON;
+         ts[ l ] = valid ? t : numbers::POSITIVE_INFINITY;
+      }
+      commitPacket( packet, mask, ts, triangleIndex );
+   }
+
+   static Bounds3 boundsFromTransformation( const Transformation &T ) noexcept
+   {
+      // Bounding volumes are represented as a unit box scaled by half their size
+      return Bounds3 {
+         T.translate - T.scale,
+         T.translate + T.scale,
+      };
+   }
+
+}
+
+void RTBVH4::build( const std::vector< Bounds3 > &bounds ) noexcept
+{
+   clear();
+
+   if ( bounds.empty() ) {
+      return;
+   }
+
+   m_itemBounds = &bounds;
+   m_items.resize( bounds.size() );
+   std::iota( m_items.begin(), m_items.end(), UInt32( 0 ) );
+   m_centroids.resize( bounds.size() );
+   for ( size_t i = 0; i < bounds.size(); ++i ) {
+      m_centroids[ i ] = impl::centroid( bounds[ i ] );
+   }
+
+   m_nodes.reserve( bounds.size() / MAX_LEAF_SIZE + 1 );
+
+   const auto root = Range { 0, bounds.size(), computeBounds( 0, bounds.size() ) };
+   m_bounds = root.bounds;
+   buildNode( root, 0 );
+
+   m_itemBounds = nullptr;
+   m_centroids.clear();
+   m_centroids.shrink_to_fit();
+}
+
+void RTBVH4::clear( void ) noexcept
+{
+   m_nodes.clear();
+   m_items.clear();
+   m_bounds = Bounds3 {};
+}
+
+Int32 RTBVH4::buildNode( const Range &range, size_t depth ) noexcept
+{
+   const auto nodeIndex = Int32( m_nodes.size() );
+   m_nodes.push_back(
+      [] {
+         auto node = RTBVH4Node {};
+         for ( auto i = 0; i < 4; ++i ) {
+            node.minX[ i ] = node.minY[ i ] = node.minZ[ i ] = numbers::POSITIVE_INFINITY;
+            node.maxX[ i ] = node.maxY[ i ] = node.maxZ[ i ] = numbers::NEGATIVE_INFINITY;
+            node.children[ i ] = RTBVH4Node::EMPTY;
+            node.counts[ i ] = 0;
+         }
+         return node;
+      }()
+   );
+
+   // Keep splitting the biggest child until there are four of them
+   std::array< Range, 4 > children = { range };
+   std::array< Bool, 4 > leaves = { false };
+   size_t count = 1;
+   while ( count < 4 ) {
+      auto best = -1;
+      auto bestArea = Real( -1 );
+      for ( size_t i = 0; i < count; ++i ) {
+         const auto area = impl::area( children[ i ].bounds );
+         if ( !leaves[ i ] && area > bestArea ) {
+            best = Int32( i );
+            bestArea = area;
+         }
+      }
+
+      if ( best < 0 ) {
+         break;
+      }
+
+      Range left, right;
+      if ( split( children[ best ], depth, left, right ) ) {
+         children[ best ] = left;
+         children[ count ] = right;
+         leaves[ count ] = false;
+         ++count;
+      } else {
+         leaves[ best ] = true;
+      }
+   }
+
+   for ( size_t i = 0; i < count; ++i ) {
+      const auto &child = children[ i ];
+      const auto isLeaf = leaves[ i ] || child.size() <= MAX_LEAF_SIZE || depth + 1 >= MAX_DEPTH;
+      const auto childIndex = isLeaf ? Int32( child.begin ) : buildNode( child, depth + 1 );
+
+      // Nodes might have been reallocated while building children
+      auto &node = m_nodes[ nodeIndex ];
+      node.minX[ i ] = child.bounds.min.x;
+      node.minY[ i ] = child.bounds.min.y;
+      node.minZ[ i ] = child.bounds.min.z;
+      node.maxX[ i ] = child.bounds.max.x;
+      node.maxY[ i ] = child.bounds.max.y;
+      node.maxZ[ i ] = child.bounds.max.z;
+      node.children[ i ] = childIndex;
+      node.counts[ i ] = isLeaf ? UInt32( child.size() ) : 0;
+   }
+
+   return nodeIndex;
+}
+
+Bool RTBVH4::split( const Range &range, size_t depth, Range &left, Range &right ) noexcept
+{
+   const auto count = range.size();
+   if ( count <= MAX_LEAF_SIZE ) {
+      return false;
+   }
+
+   auto centroidBounds = Bounds3 {};
+   for ( auto i = range.begin; i < range.end; ++i ) {
+      centroidBounds = combine( centroidBounds, m_centroids[ m_items[ i ] ] );
+   }
+
+   const auto extent = centroidBounds.max - centroidBounds.min;
+   const auto axis = extent.x > extent.y ? ( extent.x > extent.z ? 0 : 2 ) : ( extent.y > extent.z ? 1 : 2 );
+
+   auto mid = range.begin;
+
+   if ( extent[ axis ] > 0 && depth < SAH_MAX_DEPTH ) {
+      // Binned SAH
+      struct Bin {
+         Bounds3 bounds;
+         size_t count = 0;
+      };
+      std::array< Bin, SAH_BIN_COUNT > bins;
+
+      const auto binIndex = [ & ]( UInt32 item ) {
+         const auto t = ( m_centroids[ item ][ axis ] - centroidBounds.min[ axis ] ) / extent[ axis ];
+         return std::min( SAH_BIN_COUNT - 1, size_t( t * SAH_BIN_COUNT ) );
+      };
+
+      for ( auto i = range.begin; i < range.end; ++i ) {
+         auto &bin = bins[ binIndex( m_items[ i ] ) ];
+         bin.bounds = combine( bin.bounds, ( *m_itemBounds )[ m_items[ i ] ] );
+         ++bin.count;
+      }
+
+      std::array< Real, SAH_BIN_COUNT - 1 > rightCosts;
+      {
+         auto B = Bounds3 {};
+         auto n = size_t( 0 );
+         for ( auto i = SAH_BIN_COUNT - 1; i > 0; --i ) {
+            B = combine( B, bins[ i ].bounds );
+            n += bins[ i ].count;
+            rightCosts[ i - 1 ] = n * impl::area( B );
+         }
+      }
+
+      auto bestCost = numbers::POSITIVE_INFINITY;
+      auto bestSplit = size_t( 0 );
+      {
+         auto B = Bounds3 {};
+         auto n = size_t( 0 );
+         for ( size_t i = 0; i < SAH_BIN_COUNT - 1; ++i ) {
+            B = combine( B, bins[ i ].bounds );
+            n += bins[ i ].count;
+            const auto cost = n * impl::area( B ) + rightCosts[ i ];
+            if ( n > 0 && n < count && cost < bestCost ) {
+               bestCost = cost;
+               bestSplit = i;
+            }
+         }
+      }
+
+      const auto area = impl::area( range.bounds );
+      const auto leafCost = Real( count );
+      const auto splitCost = SAH_TRAVERSAL_COST + ( area > 0 ? bestCost / area : leafCost );
+      if ( splitCost < leafCost ) {
+         mid = std::partition(
+                  m_items.begin() + range.begin,
+                  m_items.begin() + range.end,
+                  [ & ]( UInt32 item ) { return binIndex( item ) <= bestSplit; }
+               )
+               - m_items.begin();
+      }
+   }
+
+   if ( mid == range.begin || mid == range.end ) {
+      // Either a leaf is cheaper or the partition failed. Leaves can't get too big, though.
+      if ( count <= 4 * MAX_LEAF_SIZE && depth < SAH_MAX_DEPTH ) {
+         return false;
+      }
+      mid = range.begin + count / 2;
+      std::nth_element(
+         m_items.begin() + range.begin,
+         m_items.begin() + mid,
+         m_items.begin() + range.end,
+         [ & ]( UInt32 a, UInt32 b ) { return m_centroids[ a ][ axis ] < m_centroids[ b ][ axis ]; }
+      );
+   }
+
+   left = Range { range.begin, mid, computeBounds( range.begin, mid ) };
+   right = Range { mid, range.end, computeBounds( mid, range.end ) };
+   return true;
+}
+
+Bounds3 RTBVH4::computeBounds( size_t begin, size_t end ) const noexcept
+{
+   auto bounds = Bounds3 {};
+   for ( auto i = begin; i < end; ++i ) {
+      bounds = combine( bounds, ( *m_itemBounds )[ m_items[ i ] ] );
+   }
+   return bounds;
+}
+
+void RTRayPacket::reset( void ) noexcept
+{
+   // Unused lanes still go through every kernel, so they must hold valid values
+   for ( UInt32 l = 0; l < SIZE; ++l ) {
+      ox[ l ] = oy[ l ] = oz[ l ] = 0;
+      dx[ l ] = ix[ l ] = 1;
+      dy[ l ] = dz[ l ] = 0;
+      iy[ l ] = iz[ l ] = 1;
+      t[ l ] = 0;
+      instance[ l ] = -1;
+      primitive[ l ] = UNIT_PRIMITIVE;
+   }
+   count = 0;
+}
+
+UInt32 RTRayPacket::add( const Ray3 &R, Real tMax ) noexcept
+{
+   assert( count < SIZE && "Packet is full" );
+
+   const auto l = count++;
+   const auto &O = origin( R );
+   const auto &D = direction( R );
+   const auto invD = RTBVH4::inverseDirection( D );
+   ox[ l ] = O.x;
+   oy[ l ] = O.y;
+   oz[ l ] = O.z;
+   dx[ l ] = D.x;
+   dy[ l ] = D.y;
+   dz[ l ] = D.z;
+   ix[ l ] = invD.x;
+   iy[ l ] = invD.y;
+   iz[ l ] = invD.z;
+   t[ l ] = tMax;
+   instance[ l ] = -1;
+   primitive[ l ] = UNIT_PRIMITIVE;
+   return l;
+}
+
+Ray3 RTRayPacket::getRay( UInt32 i ) const noexcept
+{
+   return Ray3 {
+      Point3 { ox[ i ], oy[ i ], oz[ i ] },
+      Vector3 { dx[ i ], dy[ i ], dz[ i ] },
+   };
+}
+
+UInt32 RTRayPacket::getSortKey( const Ray3 &R ) noexcept
+{
+   const auto &D = direction( R );
+   const auto octant = UInt32( D.x < 0 ) | ( UInt32( D.y < 0 ) << 1 ) | ( UInt32( D.z < 0 ) << 2 );
+   const auto length = std::abs( D.x ) + std::abs( D.y ) + std::abs( D.z );
+   if ( length <= 0 ) {
+      return octant << 16;
+   }
+   const auto u = UInt32( Real( 255 ) * std::abs( D.x ) / length );
+   const auto v = UInt32( Real( 255 ) * std::abs( D.y ) / length );
+   return ( octant << 16 ) | ( u << 8 ) | v;
+}
+
+RTSceneBVH::RTSceneBVH( const RTAcceleration::Result &scene ) noexcept
+{
+   build( scene );
+}
+
+void RTSceneBVH::build( const RTAcceleration::Result &scene ) noexcept
+{
+   m_scene = &scene;
+   m_instances.clear();
+   m_meshes.clear();
+   m_topLevel.clear();
+
+   if ( scene.nodes.empty() ) {
+      return;
+   }
+
+   std::vector< Instance > instances;
+   std::vector< Bounds3 > bounds;
+   std::unordered_map< Int32, Int32 > meshIDs;
+
+   // The original hierarchy is discarded, so it's traversed iteratively to avoid deep recursion
+   std::vector< Int32 > pending = { 0 };
+   while ( !pending.empty() ) {
+      const auto nodeIndex = pending.back();
+      pending.pop_back();
+
+      const auto &node = scene.nodes[ nodeIndex ];
+      const auto hasNext = size_t( nodeIndex + 1 ) < scene.nodes.size();
+
+      switch ( node.type ) {
+         case RTAcceleratedNode::Type::GROUP: {
+            if ( node.secondChildIndex > 0 ) {
+               pending.push_back( node.secondChildIndex );
+            }
+            if ( hasNext ) {
+               pending.push_back( nodeIndex + 1 );
+            }
+            break;
+         }
+
+         case RTAcceleratedNode::Type::GEOMETRY: {
+            if ( !hasNext ) {
+               break;
+            }
+
+            const auto &primitive = scene.nodes[ nodeIndex + 1 ];
+            auto instance = Instance {
+               .nodeIndex = nodeIndex,
+               .invWorld = inverse( primitive.world ),
+            };
+
+            if ( primitive.type == RTAcceleratedNode::Type::PRIMITIVE_TRIANGLES ) {
+               if ( primitive.primitiveIndex < 0 ) {
+                  break;
+               }
+               if ( !meshIDs.contains( primitive.primitiveIndex ) ) {
+                  meshIDs[ primitive.primitiveIndex ] = buildMesh( scene, primitive.primitiveIndex );
+               }
+               instance.meshIndex = meshIDs[ primitive.primitiveIndex ];
+            }
+
+            instances.push_back( instance );
+            bounds.push_back( impl::boundsFromTransformation( node.world ) );
+            break;
+         }
+
+         default: {
+            break;
+         }
+      }
+   }
+
+   m_topLevel.build( bounds );
+
+   // Store instances in the same order as the BVH
+   m_instances.reserve( instances.size() );
+   for ( const auto i : m_topLevel.getItems() ) {
+      m_instances.push_back( instances[ i ] );
+   }
+}
+
+Int32 RTSceneBVH::buildMesh( const RTAcceleration::Result &scene, Int32 primitiveIndex ) noexcept
+{
+   const auto &primitives = scene.primitives;
+
+   // Triangles can be referenced by many leaves in the kd-tree
+   std::vector< Int32 > offsets;
+   std::vector< Int32 > pending = { primitiveIndex };
+   while ( !pending.empty() ) {
+      const auto id = pending.back();
+      pending.pop_back();
+
+      const auto &node = primitives.primTree[ id ];
+      if ( node.isLeaf() ) {
+         for ( auto i = 0; i < node.getPrimCount(); ++i ) {
+            offsets.push_back( primitives.indexOffsets[ node.primitiveIndicesOffset + i ] );
+         }
+      } else {
+         pending.push_back( node.getAboveChild() );
+         pending.push_back( id + 1 );
+      }
+   }
+   std::sort( offsets.begin(), offsets.end() );
+   offsets.erase( std::unique( offsets.begin(), offsets.end() ), offsets.end() );
+
+   std::vector< Triangle > triangles;
+   std::vector< Normal3 > normals;
+   std::vector< Bounds3 > bounds;
+   triangles.reserve( offsets.size() );
+   normals.reserve( offsets.size() );
+   bounds.reserve( offsets.size() );
+   for ( const auto offset : offsets ) {
+      const auto &v0 = primitives.triangles[ primitives.indices[ offset + 0 ] ];
+      const auto &v1 = primitives.triangles[ primitives.indices[ offset + 1 ] ];
+      const auto &v2 = primitives.triangles[ primitives.indices[ offset + 2 ] ];
+      const auto T = Triangle { Point3( v0.position ), Point3( v1.position ), Point3( v2.position ) };
+      triangles.push_back( T );
+      normals.push_back( Normal3( v0.normal ) );
+      bounds.push_back( combine( combine( combine( Bounds3 {}, T.p0 ), T.p1 ), T.p2 ) );
+   }
+
+   const auto meshIndex = Int32( m_meshes.size() );
+   auto &mesh = m_meshes.emplace_back();
+   mesh.bvh.build( bounds );
+
+   // Store triangles in the same order as the BVH
+   mesh.triangles.reserve( triangles.size() );
+   mesh.normals.reserve( normals.size() );
+   for ( const auto i : mesh.bvh.getItems() ) {
+      mesh.triangles.push_back( triangles[ i ] );
+      mesh.normals.push_back( normals[ i ] );
+   }
+
+   return meshIndex;
+}
+
+Bool RTSceneBVH::intersect( const Ray3 &R, RTIntersection &result ) const noexcept
+{
+   auto hasResult = false;
+   auto tMax = result.t;
+   m_topLevel.intersect(
+      R,
+      tMax,
+      [ & ]( UInt32 i, Real &limit ) {
+         if ( intersect( R, m_instances[ i ], result ) ) {
+            hasResult = true;
+            limit = result.t;
+         }
+      }
+   );
+   return hasResult;
+}
+
+Bool RTSceneBVH::intersect( const Ray3 &R, const Instance &instance, RTIntersection &result ) const noexcept
+{
+   const auto &primitive = m_scene->nodes[ instance.nodeIndex + 1 ];
+   if ( instance.meshIndex < 0 ) {
+      return impl::intersectPrimitive( R, *m_scene, primitive, result );
+   }
+
+   const auto &mesh = m_meshes[ instance.meshIndex ];
+
+   // Triangles are in object space. Since the direction is not normalized,
+   // distances along the transformed ray are the same as in world space.
+   const auto R1 = instance.invWorld( R );
+
+   auto tMax = result.t;
+   auto hit = -1;
+   mesh.bvh.intersect(
+      R1,
+      tMax,
+      [ & ]( UInt32 i, Real &limit ) {
+         Real t;
+         if ( crimild::intersect( R1, mesh.triangles[ i ], t ) && t >= numbers::EPSILON && t < limit ) {
+            limit = t;
+            hit = Int32( i );
+         }
+      }
+   );
+
+   if ( hit < 0 ) {
+      return false;
+   }
+
+   result.t = tMax;
+   result.point = R( tMax );
+   result.setFaceNormal( R, primitive.world( mesh.normals[ hit ] ) );
+   result.materialId = primitive.materialIndex;
+   return true;
+}
+
+void RTSceneBVH::intersect( RTRayPacket &packet ) const noexcept
+{
+   m_topLevel.intersect(
+      packet,
+      packet.getActiveMask(),
+      [ & ]( UInt32 i, UInt32 mask ) {
+         intersect( packet, mask, Int32( i ) );
+      }
+   );
+}
+
+void RTSceneBVH::intersect( RTRayPacket &packet, UInt32 mask, Int32 instanceIndex ) const noexcept
+{
+   const auto &instance = m_instances[ instanceIndex ];
+   const auto &primitive = m_scene->nodes[ instance.nodeIndex + 1 ];
+
+   RTRayPacket local;
+   impl::transformPacket( packet, instance.invWorld, local );
+
+   if ( instance.meshIndex >= 0 ) {
+      const auto &mesh = m_meshes[ instance.meshIndex ];
+      mesh.bvh.intersect(
+         local,
+         mask,
+         [ & ]( UInt32 i, UInt32 lanes ) {
+            impl::intersectTrianglePacket( local, lanes, mesh.triangles[ i ], Int32( i ) );
+         }
+      );
+   } else {
+      switch ( primitive.type ) {
+         case RTAcceleratedNode::Type::PRIMITIVE_SPHERE: {
+            impl::intersectSpherePacket( local, mask );
+            break;
+         }
+
+         case RTAcceleratedNode::Type::PRIMITIVE_BOX: {
+            const auto &material = m_scene->materials[ primitive.materialIndex ];
+            if ( material.density < 0 ) {
+               impl::intersectBoxPacket( local, mask );
+               break;
+            }
+
+            // Volumes are sampled randomly, one lane at a time
+            for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+               if ( mask & ( 1u << l ) ) {
+                  RTIntersection result;
+                  result.t = packet.t[ l ];
+                  if ( impl::intersectPrimitive( packet.getRay( l ), *m_scene, primitive, result ) ) {
+                     local.t[ l ] = result.t;
+                     local.primitive[ l ] = RTRayPacket::VOLUME;
+                  }
+               }
+            }
+            break;
+         }
+
+         case RTAcceleratedNode::Type::PRIMITIVE_CYLINDER: {
+            impl::intersectCylinderPacket( local, mask );
+            break;
+         }
+
+         default: {
+            return;
+         }
+      }
+   }
+
+   for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+      if ( ( mask & ( 1u << l ) ) && local.t[ l ] < packet.t[ l ] ) {
+         packet.t[ l ] = local.t[ l ];
+         packet.instance[ l ] = instanceIndex;
+         packet.primitive[ l ] = local.primitive[ l ];
+      }
+   }
+}
+
+Bool RTSceneBVH::resolve( const RTRayPacket &packet, UInt32 lane, RTIntersection &result ) const noexcept
+{
+   if ( !packet.hasHit( lane ) ) {
+      return false;
+   }
+
+   const auto R = packet.getRay( lane );
+   const auto &instance = m_instances[ packet.instance[ lane ] ];
+   const auto &primitive = m_scene->nodes[ instance.nodeIndex + 1 ];
+
+   result.t = packet.t[ lane ];
+   result.point = R( result.t );
+   result.materialId = primitive.materialIndex;
+
+   const auto hit = packet.primitive[ lane ];
+   if ( hit == RTRayPacket::VOLUME ) {
+      result.normal = Normal3 { 1, 0, 0 }; // arbitrary value
+      result.frontFace = true;             // arbitrary value
+   } else if ( hit >= 0 ) {
+      result.setFaceNormal( R, primitive.world( m_meshes[ instance.meshIndex ].normals[ hit ] ) );
+   } else if ( primitive.type == RTAcceleratedNode::Type::PRIMITIVE_SPHERE ) {
+      result.setFaceNormal( R, normal( Sphere {}, primitive.world, result.point ) );
+   } else if ( primitive.type == RTAcceleratedNode::Type::PRIMITIVE_BOX ) {
+      result.setFaceNormal( R, normal( Box {}, primitive.world, result.point ) );
+   } else {
+      result.setFaceNormal( R, normal( Cylinder { .closed = true }, primitive.world, result.point ) );
+   }
+
+   return true;
+}
+
+Bool crimild::intersectRTTree( const Ray3 &R, const RTAcceleration::Result &scene, RTIntersection &result ) noexcept
+{
+   if ( scene.nodes.empty() ) {
+      return false;
+   }
+
+   Bool hasResult = false;
+
+   Index frontier[ 64 ] = { 0 };
+   Int32 currentIndex = 0;
+
+   while ( currentIndex >= 0 ) {
+      const auto nodeIdx = frontier[ currentIndex ];
+      --currentIndex;
+
+      const auto &node = scene.nodes[ nodeIdx ];
+
+      switch ( node.type ) {
+         case RTAcceleratedNode::Type::GROUP: {
+            const auto B = Box {};
+            Real t0, t1;
+            if ( intersect( R, B, node.world, t0, t1 ) ) {
+               // Only expand child nodes if the group is not occluded by the current hit
+               if ( t0 <= result.t ) {
+                  if ( node.secondChildIndex > 0 ) {
+                     frontier[ ++currentIndex ] = node.secondChildIndex;
+                  }
+                  frontier[ ++currentIndex ] = nodeIdx + 1;
+               }
+            }
+            break;
+         }
+
+         case RTAcceleratedNode::Type::GEOMETRY: {
+            const auto B = Box {};
+            Real t0, t1;
+            if ( intersect( R, B, node.world, t0, t1 ) ) {
+               const auto primIdx = nodeIdx + 1;
+               const auto &primitive = scene.nodes[ primIdx ];
+               if ( primitive.type == RTAcceleratedNode::Type::PRIMITIVE_TRIANGLES ) {
+                  hasResult = impl::intersectKdTree( R, scene, primIdx, t0, t1, result ) || hasResult;
+               } else {
+                  hasResult = impl::intersectPrimitive( R, scene, primitive, result ) || hasResult;
+               }
+            }
+            break;
+         }
+
+         default: {
+            break;
+         }
+      }
+   }
+
+   return hasResult;
+}
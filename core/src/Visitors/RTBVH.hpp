@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_VISITORS_RT_BVH_
+#define CRIMILD_VISITORS_RT_BVH_
+
+#include "Visitors/RTAcceleration.hpp"
+
+#include <algorithm>
+#include <crimild/math/Bounds3.hpp>
+#include <crimild/math/Normal3.hpp>
+#include <crimild/math/Ray3.hpp>
+#include <crimild/math/Triangle.hpp>
+#include <crimild/math/dot.hpp>
+#include <crimild/math/numbers.hpp>
+#include <vector>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+   #define CRIMILD_RT_BVH_SSE 1
+   #include <xmmintrin.h>
+#endif
+
+namespace crimild {
+
+   struct RTIntersection {
+      Int32 materialId = -1;
+      Real t = numbers::POSITIVE_INFINITY;
+      Point3f point;
+      Normal3 normal;
+      Bool frontFace = false;
+
+      inline void setFaceNormal( const Ray3 &R, const Normal3 &N ) noexcept
+      {
+         frontFace = dot( direction( R ), N ) < 0;
+         normal = frontFace ? N : -N;
+      }
+   };
+
+   /**
+      \brief A node in a 4-wide BVH
+
+      Bounds for all children are stored as structures of arrays, so a ray
+      can be tested against the four of them at once. Nodes take exactly two
+      cache lines.
+    */
+   struct alignas( 64 ) RTBVH4Node {
+      static constexpr Int32 EMPTY = -1;
+
+      alignas( 16 ) Real32 minX[ 4 ];
+      alignas( 16 ) Real32 minY[ 4 ];
+      alignas( 16 ) Real32 minZ[ 4 ];
+      alignas( 16 ) Real32 maxX[ 4 ];
+      alignas( 16 ) Real32 maxY[ 4 ];
+      alignas( 16 ) Real32 maxZ[ 4 ];
+
+      /**
+         \brief Index of the child node, or offset to the first item for leaves
+
+         Unused slots are set to EMPTY.
+       */
+      Int32 children[ 4 ];
+
+      /**
+         \brief Number of items in a leaf. Always zero for interior children.
+       */
+      UInt32 counts[ 4 ];
+
+      [[nodiscard]] inline Bool isEmpty( Int32 i ) const noexcept { return children[ i ] == EMPTY; }
+      [[nodiscard]] inline Bool isLeaf( Int32 i ) const noexcept { return counts[ i ] > 0; }
+   };
+
+   static_assert( sizeof( RTBVH4Node ) == 128, "RTBVH4Node should use exactly two cache lines" );
+
+   /**
+      \brief A group of rays traced together
+
+      Rays are stored as structures of arrays, so kernels process all lanes
+      with the same instructions. Loops over lanes have a fixed width and no
+      branches, which lets the compiler vectorize them for whatever SIMD
+      instruction set is available.
+
+      Packets work best when rays are coherent (i.e. they have similar origins
+      and directions), like primary rays for neighboring pixels. Otherwise, most
+      lanes end up inactive during traversal.
+
+      Lanes beyond getCount() are kept valid but they are never reported.
+    */
+   struct alignas( 32 ) RTRayPacket {
+      static constexpr UInt32 SIZE = 8;
+
+      /**
+         \brief Values for primitive[ i ] that are not triangle indices
+       */
+      //@{
+      static constexpr Int32 UNIT_PRIMITIVE = -1;
+      static constexpr Int32 VOLUME = -2;
+      //@}
+
+      alignas( 32 ) Real32 ox[ SIZE ];
+      alignas( 32 ) Real32 oy[ SIZE ];
+      alignas( 32 ) Real32 oz[ SIZE ];
+      alignas( 32 ) Real32 dx[ SIZE ];
+      alignas( 32 ) Real32 dy[ SIZE ];
+      alignas( 32 ) Real32 dz[ SIZE ];
+
+      /**
+         \brief Inverse directions, as computed by RTBVH4::inverseDirection()
+       */
+      //@{
+      alignas( 32 ) Real32 ix[ SIZE ];
+      alignas( 32 ) Real32 iy[ SIZE ];
+      alignas( 32 ) Real32 iz[ SIZE ];
+      //@}
+
+      /**
+         \brief Distance to the closest hit so far for each lane
+       */
+      alignas( 32 ) Real32 t[ SIZE ];
+
+      /**
+         \brief Index of the instance hit by each lane, or -1
+       */
+      alignas( 32 ) Int32 instance[ SIZE ];
+
+      /**
+         \brief Index of the triangle hit by each lane, or one of UNIT_PRIMITIVE or VOLUME
+       */
+      alignas( 32 ) Int32 primitive[ SIZE ];
+
+      UInt32 count = 0;
+
+      RTRayPacket( void ) noexcept { reset(); }
+
+      void reset( void ) noexcept;
+
+      /**
+         \brief Adds a ray to the next free lane
+
+         \returns The lane index
+       */
+      UInt32 add( const Ray3 &R, Real tMax = numbers::POSITIVE_INFINITY ) noexcept;
+
+      [[nodiscard]] Ray3 getRay( UInt32 i ) const noexcept;
+
+      [[nodiscard]] inline UInt32 getCount( void ) const noexcept { return count; }
+      [[nodiscard]] inline Bool full( void ) const noexcept { return count == SIZE; }
+      [[nodiscard]] inline Bool hasHit( UInt32 i ) const noexcept { return instance[ i ] >= 0; }
+
+      /**
+         \brief A mask with one bit set for each lane in use
+       */
+      [[nodiscard]] inline UInt32 getActiveMask( void ) const noexcept { return ( 1u << count ) - 1; }
+
+      /**
+         \brief Key for sorting streams of rays, so consecutive packets are more coherent
+
+         Rays are grouped by the octant of their direction first, and then by
+         a coarse quantization of the direction itself.
+       */
+      [[nodiscard]] static UInt32 getSortKey( const Ray3 &R ) noexcept;
+   };
+
+   /**
+      \brief A bounding volume hierarchy with four children per node
+
+      The hierarchy is built top-down using a binned SAH. Each node is created
+      by splitting its range of items twice, so it ends up having (at most) four
+      children. Items themselves are not stored in the hierarchy. Instead, leaves
+      reference ranges in getItems(), which is a permutation of the indices for
+      the bounds used when building.
+    */
+   class RTBVH4 {
+   public:
+      /**
+         \brief Ranges with this many items or fewer are never split
+       */
+      static constexpr UInt32 MAX_LEAF_SIZE = 4;
+
+      static constexpr size_t SAH_BIN_COUNT = 16;
+
+      /**
+         \brief Cost of traversing a node, relative to intersecting an item
+       */
+      static constexpr Real SAH_TRAVERSAL_COST = 0.5;
+
+      /**
+         \brief Deeper ranges are split at the median, which bounds the depth of the tree
+       */
+      static constexpr size_t SAH_MAX_DEPTH = 32;
+
+      /**
+         \brief Deeper ranges are always leaves, so traversal stacks never overflow
+       */
+      static constexpr size_t MAX_DEPTH = 48;
+
+      static constexpr size_t MAX_STACK_SIZE = 3 * MAX_DEPTH + 1;
+
+   public:
+      void build( const std::vector< Bounds3 > &bounds ) noexcept;
+
+      void clear( void ) noexcept;
+
+      [[nodiscard]] inline Bool empty( void ) const noexcept { return m_nodes.empty(); }
+      [[nodiscard]] inline const std::vector< RTBVH4Node > &getNodes( void ) const noexcept { return m_nodes; }
+      [[nodiscard]] inline const std::vector< UInt32 > &getItems( void ) const noexcept { return m_items; }
+      [[nodiscard]] inline const Bounds3 &getBounds( void ) const noexcept { return m_bounds; }
+
+      /**
+         \brief Finds the closest intersection for a ray
+
+         Items are reported with fn( i, tMax ), where i is a position in getItems()
+         and fn is expected to reduce tMax whenever it finds a closer hit. Items
+         are visited roughly front to back, and subtrees beyond tMax are skipped.
+
+         Owners usually store their items sorted like getItems(), so leaves
+         reference contiguous memory.
+       */
+      template< typename Fn >
+      void intersect( const Ray3 &R, Real &tMax, Fn &&fn ) const noexcept
+      {
+         if ( m_nodes.empty() ) {
+            return;
+         }
+
+         const auto O = origin( R );
+         const auto invD = inverseDirection( direction( R ) );
+
+         struct Entry {
+            Int32 node;
+            Real32 t;
+         };
+
+         Entry stack[ MAX_STACK_SIZE ];
+         size_t top = 0;
+         stack[ top++ ] = Entry { 0, 0 };
+
+         alignas( 16 ) Real32 tNear[ 4 ];
+
+         while ( top > 0 ) {
+            const auto entry = stack[ --top ];
+            if ( entry.t > tMax ) {
+               continue;
+            }
+
+            const auto &node = m_nodes[ entry.node ];
+            const auto mask = intersectChildren( node, O, invD, tMax, tNear );
+            if ( mask == 0 ) {
+               continue;
+            }
+
+            Int32 order[ 4 ];
+            Int32 count = 0;
+            for ( Int32 i = 0; i < 4; ++i ) {
+               if ( ( mask & ( 1 << i ) ) == 0 || node.isEmpty( i ) ) {
+                  continue;
+               }
+
+               if ( node.isLeaf( i ) ) {
+                  for ( UInt32 j = 0; j < node.counts[ i ]; ++j ) {
+                     fn( UInt32( node.children[ i ] ) + j, tMax );
+                  }
+               } else {
+                  // Keep interior children sorted by distance, farthest first
+                  auto k = count++;
+                  while ( k > 0 && tNear[ order[ k - 1 ] ] < tNear[ i ] ) {
+                     order[ k ] = order[ k - 1 ];
+                     --k;
+                  }
+                  order[ k ] = i;
+               }
+            }
+
+            // Closest child ends up at the top of the stack
+            for ( Int32 k = 0; k < count; ++k ) {
+               stack[ top++ ] = Entry { node.children[ order[ k ] ], tNear[ order[ k ] ] };
+            }
+         }
+      }
+
+      /**
+         \brief Finds the closest intersections for all active lanes in a packet
+
+         Items are reported with fn( i, mask ), where i is a position in getItems()
+         and mask has one bit set for each lane whose ray overlaps the item's leaf.
+         fn is expected to reduce packet.t for lanes with closer hits, which
+         culls subtrees for those lanes.
+
+         Children are visited in order of the closest entry distance among their
+         active lanes. Subtrees are skipped once no lane overlaps them anymore.
+       */
+      template< typename Fn >
+      void intersect( const RTRayPacket &packet, UInt32 mask, Fn &&fn ) const noexcept
+      {
+         if ( m_nodes.empty() || mask == 0 ) {
+            return;
+         }
+
+         struct Entry {
+            Int32 node;
+            UInt32 mask;
+         };
+
+         Entry stack[ MAX_STACK_SIZE ];
+         size_t top = 0;
+         stack[ top++ ] = Entry { 0, mask };
+
+         UInt32 masks[ 4 ];
+         Real32 tNear[ 4 ];
+
+         while ( top > 0 ) {
+            const auto entry = stack[ --top ];
+            const auto &node = m_nodes[ entry.node ];
+            intersectChildren( node, packet, entry.mask, masks, tNear );
+
+            Int32 order[ 4 ];
+            Int32 count = 0;
+            for ( Int32 i = 0; i < 4; ++i ) {
+               if ( masks[ i ] == 0 ) {
+                  continue;
+               }
+
+               if ( node.isLeaf( i ) ) {
+                  for ( UInt32 j = 0; j < node.counts[ i ]; ++j ) {
+                     fn( UInt32( node.children[ i ] ) + j, masks[ i ] );
+                  }
+               } else {
+                  // Keep interior children sorted by distance, farthest first
+                  auto k = count++;
+                  while ( k > 0 && tNear[ order[ k - 1 ] ] < tNear[ i ] ) {
+                     order[ k ] = order[ k - 1 ];
+                     --k;
+                  }
+                  order[ k ] = i;
+               }
+            }
+
+            for ( Int32 k = 0; k < count; ++k ) {
+               stack[ top++ ] = Entry { node.children[ order[ k ] ], masks[ order[ k ] ] };
+            }
+         }
+      }
+
+      /**
+         \brief Returns the inverse of a ray direction, without infinities
+
+         Zero components are replaced by a tiny value, so slab tests never
+         compute 0 * inf.
+       */
+      [[nodiscard]] static inline Vector3f inverseDirection( const Vector3 &D ) noexcept
+      {
+         const auto inv = []( Real d ) {
+            constexpr auto TINY = Real( 1e-20 );
+            return Real( 1 ) / ( d >= 0 ? std::max( d, TINY ) : std::min( d, -TINY ) );
+         };
+         return Vector3f { inv( D.x ), inv( D.y ), inv( D.z ) };
+      }
+
+      /**
+         \brief Tests a ray against the bounds of all children in a node
+
+         \returns A mask with one bit set for each child hit within [0, tMax]. Entry
+         distances for each child are written to tNear.
+       */
+      [[nodiscard]] static inline Int32 intersectChildren( const RTBVH4Node &node, const Point3 &O, const Vector3f &invD, Real tMax, Real32 *tNear ) noexcept
+      {
+#if CRIMILD_RT_BVH_SSE
+         const auto ox = _mm_set1_ps( O.x );
+         const auto oy = _mm_set1_ps( O.y );
+         const auto oz = _mm_set1_ps( O.z );
+         const auto ix = _mm_set1_ps( invD.x );
+         const auto iy = _mm_set1_ps( invD.y );
+         const auto iz = _mm_set1_ps( invD.z );
+
+         const auto tx0 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.minX ), ox ), ix );
+         const auto tx1 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.maxX ), ox ), ix );
+         const auto ty0 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.minY ), oy ), iy );
+         const auto ty1 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.maxY ), oy ), iy );
+         const auto tz0 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.minZ ), oz ), iz );
+         const auto tz1 = _mm_mul_ps( _mm_sub_ps( _mm_load_ps( node.maxZ ), oz ), iz );
+
+         const auto t0 = _mm_max_ps(
+            _mm_max_ps( _mm_min_ps( tx0, tx1 ), _mm_min_ps( ty0, ty1 ) ),
+            _mm_max_ps( _mm_min_ps( tz0, tz1 ), _mm_setzero_ps() )
+         );
+         const auto t1 = _mm_min_ps(
+            _mm_min_ps( _mm_max_ps( tx0, tx1 ), _mm_max_ps( ty0, ty1 ) ),
+            _mm_min_ps( _mm_max_ps( tz0, tz1 ), _mm_set1_ps( tMax ) )
+         );
+
+         _mm_store_ps( tNear, t0 );
+         return _mm_movemask_ps( _mm_cmple_ps( t0, t1 ) );
+#else
+         Int32 mask = 0;
+         for ( Int32 i = 0; i < 4; ++i ) {
+            const auto tx0 = ( node.minX[ i ] - O.x ) * invD.x;
+            const auto tx1 = ( node.maxX[ i ] - O.x ) * invD.x;
+            const auto ty0 = ( node.minY[ i ] - O.y ) * invD.y;
+            const auto ty1 = ( node.maxY[ i ] - O.y ) * invD.y;
+            const auto tz0 = ( node.minZ[ i ] - O.z ) * invD.z;
+            const auto tz1 = ( node.maxZ[ i ] - O.z ) * invD.z;
+            const auto t0 = std::max( std::max( std::min( tx0, tx1 ), std::min( ty0, ty1 ) ), std::max( std::min( tz0, tz1 ), Real32( 0 ) ) );
+            const auto t1 = std::min( std::min( std::max( tx0, tx1 ), std::max( ty0, ty1 ) ), std::min( std::max( tz0, tz1 ), Real32( tMax ) ) );
+            tNear[ i ] = t0;
+            mask |= ( t0 <= t1 ) ? ( 1 << i ) : 0;
+         }
+         return mask;
+#endif
+      }
+
+      /**
+         \brief Tests all lanes in a packet against the bounds of all children in a node
+
+         For each child, writes a mask with the lanes (within mask) that hit its
+         bounds in [0, packet.t] and the closest entry distance among them.
+       */
+      static inline void intersectChildren( const RTBVH4Node &node, const RTRayPacket &packet, UInt32 mask, UInt32 *masks, Real32 *tNear ) noexcept
+      {
+         for ( Int32 i = 0; i < 4; ++i ) {
+            masks[ i ] = 0;
+            tNear[ i ] = numbers::POSITIVE_INFINITY;
+            if ( node.isEmpty( i ) ) {
+               continue;
+            }
+
+            alignas( 32 ) Real32 t0[ RTRayPacket::SIZE ];
+            alignas( 32 ) Int32 hits[ RTRayPacket::SIZE ];
+            for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+               const auto tx0 = ( node.minX[ i ] - packet.ox[ l ] ) * packet.ix[ l ];
+               const auto tx1 = ( node.maxX[ i ] - packet.ox[ l ] ) * packet.ix[ l ];
+               const auto ty0 = ( node.minY[ i ] - packet.oy[ l ] ) * packet.iy[ l ];
+               const auto ty1 = ( node.maxY[ i ] - packet.oy[ l ] ) * packet.iy[ l ];
+               const auto tz0 = ( node.minZ[ i ] - packet.oz[ l ] ) * packet.iz[ l ];
+               const auto tz1 = ( node.maxZ[ i ] - packet.oz[ l ] ) * packet.iz[ l ];
+               const auto tEnter = std::max( std::max( std::min( tx0, tx1 ), std::min( ty0, ty1 ) ), std::max( std::min( tz0, tz1 ), Real32( 0 ) ) );
+               const auto tExit = std::min( std::min( std::max( tx0, tx1 ), std::max( ty0, ty1 ) ), std::min( std::max( tz0, tz1 ), packet.t[ l ] ) );
+               t0[ l ] = tEnter;
+               hits[ l ] = tEnter <= tExit ? 1 : 0;
+            }
+
+            for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+               if ( hits[ l ] && ( mask & ( 1u << l ) ) ) {
+                  masks[ i ] |= 1u << l;
+                  tNear[ i ] = std::min( tNear[ i ], t0[ l ] );
+               }
+            }
+         }
+      }
+
+   private:
+      struct Range {
+         size_t begin;
+         size_t end;
+         Bounds3 bounds;
+
+         [[nodiscard]] inline size_t size( void ) const noexcept { return end - begin; }
+      };
+
+      Int32 buildNode( const Range &range, size_t depth ) noexcept;
+
+      /**
+         \brief Splits a range in two, reordering items as needed
+
+         \returns False if the range should be a leaf instead
+       */
+      Bool split( const Range &range, size_t depth, Range &left, Range &right ) noexcept;
+
+      [[nodiscard]] Bounds3 computeBounds( size_t begin, size_t end ) const noexcept;
+
+   private:
+      std::vector< RTBVH4Node > m_nodes;
+      std::vector< UInt32 > m_items;
+      Bounds3 m_bounds;
+
+      /**
+         \brief Only valid while building
+       */
+      //@{
+      const std::vector< Bounds3 > *m_itemBounds = nullptr;
+      std::vector< Point3 > m_centroids;
+      //@}
+   };
+
+   /**
+      \brief Two-level acceleration structure for the soft ray tracer
+
+      The top level is a BVH over all geometries in the scene, in world space.
+      Triangulated primitives get their own BVH over triangles, in object space,
+      which is shared by every geometry using that primitive. Rays are transformed
+      into object space once per geometry, instead of once per triangle.
+
+      Geometries are collected from the linear tree produced by RTAcceleration,
+      whose original hierarchy is ignored. The accelerated scene must outlive
+      this structure.
+
+      \remarks CSG nodes are not supported yet (and neither are they when
+      traversing the linear tree).
+    */
+   class RTSceneBVH {
+   public:
+      struct Instance {
+         /**
+            \brief Index of a GEOMETRY node in the accelerated scene
+
+            The actual primitive is always stored in the next node.
+          */
+         Int32 nodeIndex;
+
+         /**
+            \brief Index of the triangle mesh, if any
+          */
+         Int32 meshIndex = -1;
+
+         Transformation invWorld;
+      };
+
+      struct Mesh {
+         RTBVH4 bvh;
+
+         /**
+            \brief Triangles and their normals, in the same order used by BVH leaves
+          */
+         //@{
+         std::vector< Triangle > triangles;
+         std::vector< Normal3 > normals;
+         //@}
+      };
+
+   public:
+      RTSceneBVH( void ) = default;
+      explicit RTSceneBVH( const RTAcceleration::Result &scene ) noexcept;
+
+      void build( const RTAcceleration::Result &scene ) noexcept;
+
+      [[nodiscard]] inline Bool empty( void ) const noexcept { return m_instances.empty(); }
+      [[nodiscard]] inline const std::vector< Instance > &getInstances( void ) const noexcept { return m_instances; }
+      [[nodiscard]] inline const std::vector< Mesh > &getMeshes( void ) const noexcept { return m_meshes; }
+      [[nodiscard]] inline const RTBVH4 &getTopLevel( void ) const noexcept { return m_topLevel; }
+
+      /**
+         \brief Finds the closest intersection for a ray
+       */
+      [[nodiscard]] Bool intersect( const Ray3 &R, RTIntersection &result ) const noexcept;
+
+      /**
+         \brief Finds the closest intersections for all rays in a packet
+
+         Only distances and the instance/primitive hit by each lane are computed.
+         Use resolve() to get the actual intersection for a lane.
+       */
+      void intersect( RTRayPacket &packet ) const noexcept;
+
+      /**
+         \brief Computes the intersection found for a lane after intersecting a packet
+
+         \returns False if the lane didn't hit anything
+       */
+      [[nodiscard]] Bool resolve( const RTRayPacket &packet, UInt32 lane, RTIntersection &result ) const noexcept;
+
+   private:
+      void collect( const RTAcceleration::Result &scene, Int32 nodeIndex, std::vector< Bounds3 > &bounds ) noexcept;
+      Int32 buildMesh( const RTAcceleration::Result &scene, Int32 primitiveIndex ) noexcept;
+
+      [[nodiscard]] Bool intersect( const Ray3 &R, const Instance &instance, RTIntersection &result ) const noexcept;
+
+      /**
+         \brief Intersects the lanes in mask with a single instance, updating those with closer hits
+       */
+      void intersect( RTRayPacket &packet, UInt32 mask, Int32 instanceIndex ) const noexcept;
+
+   private:
+      const RTAcceleration::Result *m_scene = nullptr;
+      std::vector< Instance > m_instances;
+      std::vector< Mesh > m_meshes;
+      RTBVH4 m_topLevel;
+   };
+
+   /**
+      \brief Finds the closest intersection for a ray by traversing the linear tree produced by RTAcceleration
+
+      Triangulated primitives are intersected using their kd-trees.
+    */
+   [[nodiscard]] Bool intersectRTTree( const Ray3 &R, const RTAcceleration::Result &scene, RTIntersection &result ) noexcept;
+
+}
+
+#endif
@@ -27,13 +27,19 @@
 
 #include "UpdateComponents.hpp"
 
+#include "Components/ComponentRegistry.hpp"
+#include "Components/NodeComponent.hpp"
 #include "SceneGraph/Node.hpp"
 #include "SceneGraph/Group.hpp"
 
+#include <algorithm>
+
 using namespace crimild;
 
-UpdateComponents::UpdateComponents( const Clock &clock )
-	: Apply( [clock]( Node *n ) { n->updateComponents( clock ); } )
+UpdateComponents::UpdateComponents( const Clock &clock, Filter filter )
+	: Apply( [clock]( Node *n ) { n->updateComponents( clock ); } ),
+	  _clock( clock ),
+	  _filter( filter )
 {
 
 }
@@ -43,3 +49,39 @@ UpdateComponents::~UpdateComponents( void )
 
 }
 
+void UpdateComponents::traverse( Node *root )
+{
+	auto &registry = ComponentRegistry::getInstance();
+	const auto typeCount = registry.getTypeCount();
+	std::vector< SharedPointer< NodeComponent > > components;
+	std::vector< std::pair< UInt32, SharedPointer< NodeComponent > > > pending;
+	for ( ComponentTypeId typeId = 0; typeId < typeCount; ++typeId ) {
+		registry.collect( typeId, components );
+		for ( auto &component : components ) {
+			if ( _filter != Filter::ALL && component->isRenderSafe() != ( _filter == Filter::RENDER_SAFE ) ) {
+				continue;
+			}
+
+			// Same nodes a visitor would reach: enabled and selected ones only
+			auto node = component->getNode();
+			if ( component->isEnabled() && node != nullptr && node->isActiveInHierarchy() && node->isInHierarchy( root ) ) {
+				pending.emplace_back( node->getDepth(), component );
+			}
+		}
+	}
+
+	// Parents before children. Stable, so types keep their order within each level
+	std::stable_sort(
+		pending.begin(),
+		pending.end(),
+		[]( const auto &a, const auto &b ) { return a.first < b.first; }
+	);
+
+	for ( auto &[ depth, component ] : pending ) {
+		// Previous updates might have detached or disabled this one
+		auto node = component->getNode();
+		if ( component->isEnabled() && node != nullptr && node->isActiveInHierarchy() ) {
+			component->update( _clock );
+		}
+	}
+}
@@ -33,10 +33,46 @@
 
 namespace crimild {
 
+    /**
+       \brief Updates all enabled components in a hierarchy
+
+       Components are collected from the contiguous arrays kept by
+       ComponentRegistry instead of visiting every node. As with a visitor,
+       components in disabled nodes, in nodes with disabled ancestors or in
+       children not selected by a Switch are skipped (see
+       Node::isActiveInHierarchy()).
+
+       Components are updated level by level, so parents are always updated
+       before their children. Within a level they are grouped by type and,
+       within a type, update order is unspecified.
+
+       Each type is copied from the registry before updating it, so components
+       can attach or detach other components (even from other threads) without
+       waiting for the pass to end. Components detached during the pass are
+       skipped, while the ones attached during it are updated next time.
+
+       A filter can be used to update only the components that are safe to
+       run while render stages read the scene (see NodeComponent::isRenderSafe()),
+       or only the ones that are not. FramePipeline relies on this to overlap
+       updates with command recording.
+     */
     class UpdateComponents : public Apply {
     public:
-        UpdateComponents( const Clock &clock );
+        enum class Filter : UInt8 {
+            ALL,
+            RENDER_SAFE,
+            RENDER_UNSAFE,
+        };
+
+    public:
+        UpdateComponents( const Clock &clock, Filter filter = Filter::ALL );
         virtual ~UpdateComponents( void );
+
+        virtual void traverse( Node *node ) override;
+
+    private:
+        Clock _clock;
+        Filter _filter;
     };
 
 }
@@ -27,39 +27,71 @@
 
 #include "UpdateWorldState.hpp"
 
+#include "Concurrency/Parallel.hpp"
 #include "SceneGraph/CSGNode.hpp"
 #include "SceneGraph/Group.hpp"
 #include "SceneGraph/Node.hpp"
 
+#include <algorithm>
+#include <vector>
+
 using namespace crimild;
 
 UpdateWorldState::UpdateWorldState( void )
 {
 }
 
+UpdateWorldState::UpdateWorldState( bool force, int nesting )
+   : m_force( force ),
+     m_nesting( nesting )
+{
+}
+
 UpdateWorldState::~UpdateWorldState( void )
 {
 }
 
-void UpdateWorldState::visitNode( Node *node )
+void UpdateWorldState::updateWorld( Node *node ) noexcept
 {
    if ( node->worldIsCurrent() ) {
       return;
    }
 
    if ( node->hasParent() ) {
-      node->setWorld( node->getParent()->getWorld()( node->getLocal() ) );
+      node->setComputedWorld( node->getParent()->getWorld()( node->getLocal() ) );
    } else {
-      node->setWorld( node->getLocal() );
+      node->setComputedWorld( node->getLocal() );
    }
 
    node->worldBound()->computeFrom( node->getLocalBound(), node->getWorld() );
 }
 
+void UpdateWorldState::visitNode( Node *node )
+{
+   if ( !needsUpdate( node ) ) {
+      return;
+   }
+
+   updateWorld( node );
+   node->clearWorldStateDirty();
+}
+
 void UpdateWorldState::visitGroup( Group *group )
 {
-   visitNode( group );
-   NodeVisitor::visitGroup( group );
+   if ( !needsUpdate( group ) ) {
+      return;
+   }
+
+   const auto dirty = m_force || group->isWorldStateDirty();
+   if ( dirty ) {
+      updateWorld( group );
+   }
+
+   // If this group moved, all of its descendants must be updated too
+   const auto force = m_force;
+   m_force = dirty;
+   visitChildren( group );
+   m_force = force;
 
    if ( group->hasNodes() ) {
       bool firstChild = true;
@@ -72,12 +104,66 @@ void UpdateWorldState::visitGroup( Group *group )
          }
       } );
    }
+
+   group->clearWorldStateDirty();
+}
+
+void UpdateWorldState::visitChildren( Group *group )
+{
+   auto tasks = concurrency::TaskSystem::getInstance();
+   const auto canSplit = m_nesting < PARALLEL_MAX_NESTING
+                         && tasks != nullptr
+                         && tasks->isRunning()
+                         && tasks->getNumWorkers() > 0
+                         && group->getNodeCount() >= PARALLEL_MIN_CHILDREN;
+   if ( !canSplit ) {
+      NodeVisitor::visitGroup( group );
+      return;
+   }
+
+   std::vector< Node * > pending;
+   group->forEachNode( [ & ]( Node *node ) {
+      if ( needsUpdate( node ) ) {
+         pending.push_back( node );
+      }
+   } );
+
+   if ( pending.size() < PARALLEL_MIN_CHILDREN ) {
+      for ( auto node : pending ) {
+         node->accept( *this );
+      }
+      return;
+   }
+
+   // Children are independent from each other. Each chunk uses its own visitor
+   const auto grain = std::max( size_t( 1 ), pending.size() / ( 4 * size_t( tasks->getNumWorkers() + 1 ) ) );
+   concurrency::parallel_for(
+      concurrency::Range { 0, pending.size() },
+      grain,
+      [ & ]( concurrency::Range chunk ) {
+         UpdateWorldState visitor( m_force, m_nesting + 1 );
+         for ( auto i = chunk.begin; i < chunk.end; ++i ) {
+            pending[ i ]->accept( visitor );
+         }
+      }
+   );
 }
 
 void UpdateWorldState::visitCSGNode( CSGNode *csg )
 {
-   visitNode( csg );
+   if ( !needsUpdate( csg ) ) {
+      return;
+   }
+
+   const auto dirty = m_force || csg->isWorldStateDirty();
+   if ( dirty ) {
+      updateWorld( csg );
+   }
+
+   const auto force = m_force;
+   m_force = dirty;
    NodeVisitor::visitCSGNode( csg );
+   m_force = force;
 
    bool firstChild = true;
    if ( auto left = csg->getLeft() ) {
@@ -97,4 +183,6 @@ void UpdateWorldState::visitCSGNode( CSGNode *csg )
          csg->worldBound()->expandToContain( right->getWorldBound() );
       }
    }
+
+   csg->clearWorldStateDirty();
 }
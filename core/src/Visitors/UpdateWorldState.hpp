@@ -29,9 +29,19 @@
 #define CRIMILD_VISITORS_UPDATE_WORLD_STATE_
 
 #include "NodeVisitor.hpp"
+#include "SceneGraph/Node.hpp"
 
 namespace crimild {
 
+    /**
+       \brief Propagates world transformations and bounds
+
+       Only subtrees that changed since the last update are visited (see
+       Node::invalidateWorldState()), so static content has no cost. Groups with
+       many children to update are split across worker threads, if any. Bounds
+       are always merged bottom-up in children order, so the result does not
+       depend on how work is scheduled.
+     */
     class UpdateWorldState : public NodeVisitor {
     public:
         UpdateWorldState( void );
@@ -40,6 +50,39 @@ namespace crimild {
         virtual void visitNode( Node *node ) override;
         virtual void visitGroup( Group *node ) override;
         virtual void visitCSGNode( CSGNode *csg ) override;
+
+    private:
+        UpdateWorldState( bool force, int nesting );
+
+        inline bool needsUpdate( Node *node ) const noexcept
+        {
+            return m_force || node->isWorldStateDirty() || node->hasDirtyDescendants();
+        }
+
+        void updateWorld( Node *node ) noexcept;
+        void visitChildren( Group *group );
+
+    private:
+        /**
+           \brief Minimum number of children to update before splitting a group across workers
+         */
+        static constexpr size_t PARALLEL_MIN_CHILDREN = 8;
+
+        /**
+           \brief How many levels of parallel splits are allowed
+
+           Limits the number of jobs for deep hierarchies.
+         */
+        static constexpr int PARALLEL_MAX_NESTING = 2;
+
+        /**
+           \brief Set if the parent's world transformation has changed
+
+           In that case, all descendants must be updated regardless of their flags.
+         */
+        bool m_force = false;
+
+        int m_nesting = 0;
     };
 
 }
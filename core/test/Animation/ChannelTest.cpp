@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Animation/Animation.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::test {
+
+   static Real32 evaluate( Channel *channel, Real32 t, Size &cursor )
+   {
+      Animation animation;
+      channel->evaluate( t, &animation, cursor );
+      Real32 ret = 0;
+      animation.getValue( "x", ret );
+      return ret;
+   }
+
+   static Real32 evaluate( Channel *channel, Real32 t )
+   {
+      Size cursor = 0;
+      return evaluate( channel, t, cursor );
+   }
+
+   /**
+      \brief Keys follow y = 10 * t at irregular intervals
+    */
+   static SharedPointer< Real32Channel > createChannel( void )
+   {
+      Array< Real32 > times;
+      Array< Real32 > keys;
+      Real32 t = 0;
+      for ( auto i = 0; i < 100; ++i ) {
+         times.add( t );
+         keys.add( 10.0f * t );
+         t += 0.5f + 0.25f * Real32( i % 3 );
+      }
+      return crimild::alloc< Real32Channel >( "x", times, keys );
+   }
+
+}
+
+TEST( Channel, evaluate )
+{
+   auto channel = crimild::alloc< Real32Channel >( "x", Array< Real32 > { 0, 1, 3, 4 }, Array< Real32 > { 0, 10, 30, 20 } );
+
+   EXPECT_FLOAT_EQ( 0, test::evaluate( crimild::get_ptr( channel ), -1 ) );
+   EXPECT_FLOAT_EQ( 5, test::evaluate( crimild::get_ptr( channel ), 0.5f ) );
+   EXPECT_FLOAT_EQ( 10, test::evaluate( crimild::get_ptr( channel ), 1 ) );
+   EXPECT_FLOAT_EQ( 20, test::evaluate( crimild::get_ptr( channel ), 2 ) );
+   EXPECT_FLOAT_EQ( 25, test::evaluate( crimild::get_ptr( channel ), 3.5f ) );
+   EXPECT_FLOAT_EQ( 20, test::evaluate( crimild::get_ptr( channel ), 5 ) );
+}
+
+TEST( Channel, cursor_forward_and_seek )
+{
+   auto channel = test::createChannel();
+
+   Size cursor = 0;
+   for ( Real32 t = 0; t < 70; t += 0.1f ) {
+      EXPECT_NEAR( 10.0f * t, test::evaluate( crimild::get_ptr( channel ), t, cursor ), 1e-3f * t + 1e-4f );
+   }
+
+   // Looping back
+   EXPECT_NEAR( 15.0f, test::evaluate( crimild::get_ptr( channel ), 1.5f, cursor ), 1e-4f );
+   EXPECT_GE( 2, cursor );
+
+   // Seeking forward
+   EXPECT_NEAR( 600.0f, test::evaluate( crimild::get_ptr( channel ), 60.0f, cursor ), 1e-2f );
+   EXPECT_NEAR( 605.0f, test::evaluate( crimild::get_ptr( channel ), 60.5f, cursor ), 1e-2f );
+
+   // Invalid cursors are ignored
+   cursor = 1000;
+   EXPECT_NEAR( 300.0f, test::evaluate( crimild::get_ptr( channel ), 30.0f, cursor ), 1e-2f );
+}
+
+TEST( Channel, uniform_keys )
+{
+   auto irregular = test::createChannel();
+   EXPECT_EQ( 0, irregular->getSampleInterval() );
+
+   auto uniform = crimild::alloc< Real32Channel >( "x", Array< Real32 > { 1, 1.5f, 2, 2.5f }, Array< Real32 > { 0, 1, 2, 3 } );
+   EXPECT_FLOAT_EQ( 0.5f, uniform->getSampleInterval() );
+   EXPECT_FLOAT_EQ( 0.5f, test::evaluate( crimild::get_ptr( uniform ), 1.25f ) );
+   EXPECT_FLOAT_EQ( 2, test::evaluate( crimild::get_ptr( uniform ), 2 ) );
+   EXPECT_FLOAT_EQ( 2.8f, test::evaluate( crimild::get_ptr( uniform ), 2.4f ) );
+}
+
+TEST( Channel, resample )
+{
+   auto channel = test::createChannel();
+   const auto duration = channel->getDuration();
+
+   channel->resample( 30 );
+
+   EXPECT_LT( 0, channel->getSampleInterval() );
+   EXPECT_GE( 1.0f / 30.0f, channel->getSampleInterval() );
+   EXPECT_FLOAT_EQ( duration, channel->getDuration() );
+
+   // Keys are linear, so resampling is exact (up to rounding errors)
+   Size cursor = 0;
+   for ( Real32 t = 0; t < duration; t += 0.37f ) {
+      EXPECT_NEAR( 10.0f * t, test::evaluate( crimild::get_ptr( channel ), t, cursor ), 1e-3f * t + 1e-3f );
+   }
+}
+
+TEST( Channel, animation_keeps_cursors )
+{
+   auto clip = crimild::alloc< Clip >( "clip", test::createChannel() );
+   auto animation = crimild::alloc< Animation >( clip );
+
+   const auto duration = clip->getDuration();
+   Clock clock( 0.25 );
+   for ( auto i = 0; i < 1000; ++i ) {
+      animation->update( clock );
+
+      const auto t = std::fmod( Real32( animation->getClock().getAccumTime() ), duration );
+      Real32 value = 0;
+      animation->getValue( "x", value );
+      EXPECT_NEAR( 10.0f * t, value, 1e-2f );
+   }
+
+   EXPECT_EQ( 1, animation->getChannelCursors().size() );
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Animation/CompressedChannel.hpp"
+
+#include "Animation/Animation.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::test {
+
+   template< typename T >
+   static T evaluate( Channel *channel, Real32 t, Size &cursor )
+   {
+      Animation animation;
+      channel->evaluate( t, &animation, cursor );
+      T ret;
+      animation.getValue( channel->getName(), ret );
+      return ret;
+   }
+
+   static Quaternion rotationY( Real32 angle )
+   {
+      return Quaternion( 0, std::sin( 0.5f * angle ), 0, std::cos( 0.5f * angle ) );
+   }
+
+   /**
+      \brief Keys sampled at 30 fps from a smooth curve
+    */
+   static SharedPointer< Vector3fChannel > createTranslationChannel( void )
+   {
+      Array< Real32 > times;
+      Array< Vector3f > keys;
+      for ( auto i = 0; i <= 300; ++i ) {
+         const auto t = Real32( i ) / 30.0f;
+         times.add( t );
+         keys.add( Vector3f { 2.0f * std::sin( t ), 0.5f * t, 3.0f } );
+      }
+      return crimild::alloc< Vector3fChannel >( "joint[p]", times, keys );
+   }
+
+   static SharedPointer< QuaternionChannel > createRotationChannel( void )
+   {
+      Array< Real32 > times;
+      Array< Quaternion > keys;
+      for ( auto i = 0; i <= 300; ++i ) {
+         const auto t = Real32( i ) / 30.0f;
+         times.add( t );
+         keys.add( rotationY( 0.5f * t ) );
+      }
+      return crimild::alloc< QuaternionChannel >( "joint[r]", times, keys );
+   }
+
+}
+
+TEST( CompressedChannel, quantize )
+{
+   EXPECT_EQ( 0, compression::quantize( -1, -1, 2 ) );
+   EXPECT_EQ( 65535, compression::quantize( 1, -1, 2 ) );
+   EXPECT_EQ( 0, compression::quantize( -5, -1, 2 ) );
+   EXPECT_EQ( 65535, compression::quantize( 5, -1, 2 ) );
+   EXPECT_EQ( 0, compression::quantize( 3, 3, 0 ) );
+}
+
+TEST( CompressedChannel, smallest_three )
+{
+   const Quaternion qs[] = {
+      Quaternion( 0, 0, 0, 1 ),
+      Quaternion( 0, 0, 0, -1 ),
+      Quaternion( 1, 0, 0, 0 ),
+      Quaternion( 0, -1, 0, 0 ),
+      test::rotationY( 2.5f ),
+      Quaternion( 0.5f, -0.5f, 0.5f, -0.5f ),
+      Quaternion( 0.1f, 0.7f, -0.3f, 0.2f ),
+   };
+
+   for ( const auto &q : qs ) {
+      UInt16 words[ 3 ];
+      compression::packQuaternion( q, words );
+      const auto r = compression::unpackQuaternion( words );
+      EXPECT_LT( compression::error( q, r ), 1e-3f );
+   }
+}
+
+TEST( CompressedChannel, constant_channels )
+{
+   auto channel = crimild::alloc< Vector3fChannel >(
+      "joint[s]",
+      Array< Real32 > { 0, 1, 2, 3 },
+      Array< Vector3f > { Vector3f { 1, 1, 1 }, Vector3f { 1, 1, 1 }, Vector3f { 1, 1.0001f, 1 }, Vector3f { 1, 1, 1 } }
+   );
+
+   CompressionStats stats;
+   auto compressed = crimild::alloc< CompressedVector3fChannel >( *channel, CompressionSettings {}, &stats );
+
+   EXPECT_TRUE( compressed->isConstant() );
+   EXPECT_EQ( 1, compressed->getKeyCount() );
+   EXPECT_FLOAT_EQ( 3, compressed->getDuration() );
+   EXPECT_EQ( 1, stats.constantChannels );
+   EXPECT_EQ( 4, stats.originalKeys );
+   EXPECT_EQ( 1, stats.compressedKeys );
+
+   Size cursor = 0;
+   for ( Real32 t = -1; t < 4; t += 0.5f ) {
+      const auto value = test::evaluate< Vector3f >( crimild::get_ptr( compressed ), t, cursor );
+      EXPECT_NEAR( 1, value.x, 1e-3f );
+      EXPECT_NEAR( 1, value.y, 1e-3f );
+      EXPECT_NEAR( 1, value.z, 1e-3f );
+   }
+}
+
+TEST( CompressedChannel, reduce_linear_keys )
+{
+   Array< Real32 > times;
+   Array< Real32 > keys;
+   for ( auto i = 0; i < 100; ++i ) {
+      times.add( Real32( i ) );
+      keys.add( 10.0f * Real32( i ) );
+   }
+   auto channel = crimild::alloc< Real32Channel >( "x", times, keys );
+
+   auto compressed = crimild::alloc< CompressedReal32Channel >( *channel, CompressionSettings {} );
+   EXPECT_EQ( 2, compressed->getKeyCount() );
+   EXPECT_FLOAT_EQ( 99, compressed->getDuration() );
+
+   Size cursor = 0;
+   for ( Real32 t = 0; t < 99; t += 0.7f ) {
+      EXPECT_NEAR( 10.0f * t, test::evaluate< Real32 >( crimild::get_ptr( compressed ), t, cursor ), 0.1f );
+   }
+
+   CompressionSettings settings;
+   settings.reduceKeys = false;
+   auto quantized = crimild::alloc< CompressedReal32Channel >( *channel, settings );
+   EXPECT_EQ( 100, quantized->getKeyCount() );
+}
+
+TEST( CompressedChannel, translation_error_within_tolerance )
+{
+   auto channel = test::createTranslationChannel();
+
+   CompressionSettings settings;
+   settings.tolerance = 0.01f;
+
+   CompressionStats stats;
+   auto compressed = crimild::alloc< CompressedVector3fChannel >( *channel, settings, &stats );
+
+   EXPECT_LT( compressed->getKeyCount(), channel->getKeys().size() );
+   EXPECT_LT( stats.compressedBytes, stats.originalBytes );
+   EXPECT_FLOAT_EQ( channel->getDuration(), compressed->getDuration() );
+
+   // Quantization adds a small error on top of the tolerance
+   const auto maxError = settings.tolerance + 1e-3f;
+
+   Size cursor = 0;
+   Size compressedCursor = 0;
+   for ( Real32 t = 0; t < channel->getDuration(); t += 0.013f ) {
+      const auto expected = test::evaluate< Vector3f >( crimild::get_ptr( channel ), t, cursor );
+      const auto actual = test::evaluate< Vector3f >( crimild::get_ptr( compressed ), t, compressedCursor );
+      EXPECT_LE( compression::error( expected, actual ), maxError );
+   }
+}
+
+TEST( CompressedChannel, rotation_error_within_tolerance )
+{
+   auto channel = test::createRotationChannel();
+
+   CompressionSettings settings;
+   settings.angularTolerance = 0.005f;
+
+   auto compressed = crimild::alloc< CompressedQuaternionChannel >( *channel, settings );
+
+   // Rotation keys have constant angular velocity, so most of them can be discarded
+   EXPECT_LT( compressed->getKeyCount(), 10 );
+
+   Size cursor = 0;
+   Size compressedCursor = 0;
+   for ( Real32 t = 0; t < channel->getDuration(); t += 0.013f ) {
+      const auto expected = test::evaluate< Quaternion >( crimild::get_ptr( channel ), t, cursor );
+      const auto actual = test::evaluate< Quaternion >( crimild::get_ptr( compressed ), t, compressedCursor );
+      EXPECT_LE( compression::error( expected, actual ), settings.angularTolerance + 1e-3f );
+   }
+}
+
+TEST( CompressedChannel, evaluate_pose )
+{
+   auto channel = test::createTranslationChannel();
+   auto compressed = crimild::alloc< CompressedVector3fChannel >( *channel, CompressionSettings {} );
+
+   Pose pose;
+   pose.reset( 1 );
+   const auto target = Pose::Target { 0, Pose::Target::Property::TRANSLATION };
+
+   Size cursor = 0;
+   compressed->evaluate( 2.0f, pose, target, cursor );
+   EXPECT_TRUE( pose.isAnimated( 0, Pose::Target::Property::TRANSLATION ) );
+   EXPECT_NEAR( 2.0f * std::sin( 2.0f ), pose.getTranslation( 0 ).x, 2e-3f );
+   EXPECT_NEAR( 1.0f, pose.getTranslation( 0 ).y, 2e-3f );
+}
+
+TEST( CompressedChannel, compress_clip )
+{
+   auto clip = crimild::alloc< Clip >( "clip" );
+   clip->addChannel( test::createTranslationChannel() );
+   clip->addChannel( test::createRotationChannel() );
+   clip->addChannel( crimild::alloc< Vector3fChannel >( "joint[s]", Array< Real32 > { 0, 10 }, Array< Vector3f > { Vector3f { 1, 1, 1 }, Vector3f { 1, 1, 1 } } ) );
+
+   const auto duration = clip->getDuration();
+   const auto stats = clip->compress( CompressionSettings {} );
+
+   EXPECT_EQ( 3, stats.channels );
+   EXPECT_EQ( 1, stats.constantChannels );
+   EXPECT_EQ( 604, stats.originalKeys );
+   EXPECT_LT( stats.compressedKeys, stats.originalKeys );
+   EXPECT_LT( stats.compressedBytes, stats.originalBytes );
+   EXPECT_GT( stats.getSavedBytes(), 0 );
+   EXPECT_GT( stats.getRatio(), 1.0f );
+   EXPECT_FLOAT_EQ( duration, clip->getDuration() );
+
+   auto &channels = clip->getChannels();
+   for ( Size i = 0; i < channels.size(); ++i ) {
+      EXPECT_EQ( nullptr, compress( crimild::get_ptr( channels[ i ] ), CompressionSettings {} ) );
+   }
+
+   // Already compressed channels are ignored
+   const auto again = clip->compress( CompressionSettings {} );
+   EXPECT_EQ( 0, again.channels );
+
+   auto animation = crimild::alloc< Animation >( clip );
+   Clock clock( 2.0 );
+   animation->update( clock );
+
+   Vector3f translation;
+   animation->getValue( "joint[p]", translation );
+   EXPECT_NEAR( 2.0f * std::sin( 2.0f ), translation.x, 2e-3f );
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Animation/Pose.hpp"
+
+#include "Animation/Animation.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Animation/Skeleton.hpp"
+#include "SceneGraph/Group.hpp"
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::test {
+
+   static Quaternion rotationY( Real32 angle )
+   {
+      return Quaternion { 0, std::sin( 0.5f * angle ), 0, std::cos( 0.5f * angle ) };
+   }
+
+   static Pose::Target target( UInt32 joint, Pose::Target::Property property )
+   {
+      Pose::Target ret;
+      ret.joint = joint;
+      ret.property = property;
+      return ret;
+   }
+
+}
+
+TEST( Pose, parseTarget )
+{
+   std::string jointName;
+   EXPECT_EQ( Pose::Target::Property::TRANSLATION, Pose::Target::parse( "hip[p]", jointName ) );
+   EXPECT_EQ( "hip", jointName );
+   EXPECT_EQ( Pose::Target::Property::ROTATION, Pose::Target::parse( "left knee[r]", jointName ) );
+   EXPECT_EQ( "left knee", jointName );
+   EXPECT_EQ( Pose::Target::Property::SCALE, Pose::Target::parse( "hip[s]", jointName ) );
+   EXPECT_EQ( Pose::Target::Property::NONE, Pose::Target::parse( "hip[x]", jointName ) );
+   EXPECT_EQ( Pose::Target::Property::NONE, Pose::Target::parse( "hip", jointName ) );
+}
+
+TEST( Pose, reset )
+{
+   Pose pose( 3 );
+
+   EXPECT_EQ( 3, pose.getJointCount() );
+   for ( Size i = 0; i < 3; ++i ) {
+      EXPECT_EQ( ( Vector3f { 0, 0, 0 } ), pose.getTranslation( i ) );
+      EXPECT_EQ( ( Vector3f { 1, 1, 1 } ), pose.getScale( i ) );
+      EXPECT_EQ( ( Quaternion { 0, 0, 0, 1 } ), pose.getRotation( i ) );
+      EXPECT_FALSE( pose.isAnimated( i, Pose::Target::Property::TRANSLATION ) );
+   }
+}
+
+TEST( Pose, set )
+{
+   Pose pose( 2 );
+
+   pose.set( test::target( 1, Pose::Target::Property::TRANSLATION ), Vector3f { 1, 2, 3 } );
+   pose.set( test::target( 1, Pose::Target::Property::SCALE ), Vector3f { 2, 2, 2 } );
+   pose.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 1 ) );
+
+   // Ignored
+   pose.set( test::target( 5, Pose::Target::Property::TRANSLATION ), Vector3f { 1, 2, 3 } );
+   pose.set( test::target( 0, Pose::Target::Property::TRANSLATION ), Real32( 5 ) );
+
+   EXPECT_EQ( ( Vector3f { 0, 0, 0 } ), pose.getTranslation( 0 ) );
+   EXPECT_EQ( ( Vector3f { 1, 2, 3 } ), pose.getTranslation( 1 ) );
+   EXPECT_EQ( ( Vector3f { 2, 2, 2 } ), pose.getScale( 1 ) );
+   EXPECT_EQ( test::rotationY( 1 ), pose.getRotation( 0 ) );
+
+   EXPECT_FALSE( pose.isAnimated( 0, Pose::Target::Property::TRANSLATION ) );
+   EXPECT_TRUE( pose.isAnimated( 0, Pose::Target::Property::ROTATION ) );
+   EXPECT_TRUE( pose.isAnimated( 1, Pose::Target::Property::TRANSLATION ) );
+   EXPECT_TRUE( pose.isAnimated( 1, Pose::Target::Property::SCALE ) );
+}
+
+TEST( Pose, lerp )
+{
+   Pose a( 2 );
+   a.set( test::target( 0, Pose::Target::Property::TRANSLATION ), Vector3f { 0, 0, 0 } );
+   a.set( test::target( 1, Pose::Target::Property::TRANSLATION ), Vector3f { 2, 0, 0 } );
+   a.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 0.5f ) );
+
+   Pose b( 2 );
+   b.set( test::target( 0, Pose::Target::Property::TRANSLATION ), Vector3f { 10, 20, 30 } );
+   b.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 1.5f ) );
+   b.set( test::target( 1, Pose::Target::Property::SCALE ), Vector3f { 3, 3, 3 } );
+
+   a.lerp( b, 0.5f );
+
+   const auto t0 = a.getTranslation( 0 );
+   EXPECT_FLOAT_EQ( 5, t0.x );
+   EXPECT_FLOAT_EQ( 10, t0.y );
+   EXPECT_FLOAT_EQ( 15, t0.z );
+
+   // Not animated in b
+   EXPECT_EQ( ( Vector3f { 2, 0, 0 } ), a.getTranslation( 1 ) );
+
+   const auto s1 = a.getScale( 1 );
+   EXPECT_FLOAT_EQ( 2, s1.x );
+   EXPECT_TRUE( a.isAnimated( 1, Pose::Target::Property::SCALE ) );
+
+   const auto r0 = a.getRotation( 0 );
+   const auto expected = test::rotationY( 1 );
+   EXPECT_NEAR( expected.v.y, r0.v.y, 1e-5f );
+   EXPECT_NEAR( expected.w, r0.w, 1e-5f );
+}
+
+TEST( Pose, lerpShortestPath )
+{
+   Pose a( 1 );
+   a.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 0.5f ) );
+
+   // Same rotation as rotationY( 1.5 ), but on the opposite hemisphere
+   const auto q = test::rotationY( 1.5f );
+   Pose b( 1 );
+   b.set( test::target( 0, Pose::Target::Property::ROTATION ), Quaternion { -q.v.x, -q.v.y, -q.v.z, -q.w } );
+
+   a.lerp( b, 0.5f );
+
+   const auto r = a.getRotation( 0 );
+   const auto expected = test::rotationY( 1 );
+   EXPECT_NEAR( expected.v.y, r.v.y, 1e-5f );
+   EXPECT_NEAR( expected.w, r.w, 1e-5f );
+}
+
+TEST( Pose, add )
+{
+   Pose a( 2 );
+   a.set( test::target( 0, Pose::Target::Property::TRANSLATION ), Vector3f { 1, 2, 3 } );
+   a.set( test::target( 1, Pose::Target::Property::TRANSLATION ), Vector3f { 1, 1, 1 } );
+   a.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 0.5f ) );
+
+   Pose b( 2 );
+   b.set( test::target( 0, Pose::Target::Property::TRANSLATION ), Vector3f { 2, 2, 2 } );
+   b.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 1.0f ) );
+
+   a.add( b, 0.5f );
+
+   const auto t0 = a.getTranslation( 0 );
+   EXPECT_FLOAT_EQ( 2, t0.x );
+   EXPECT_FLOAT_EQ( 3, t0.y );
+   EXPECT_FLOAT_EQ( 4, t0.z );
+   EXPECT_EQ( ( Vector3f { 1, 1, 1 } ), a.getTranslation( 1 ) );
+
+   // Half of a rotation of 1 radian around the same axis
+   const auto r0 = a.getRotation( 0 );
+   const auto expected = test::rotationY( 1.0f );
+   EXPECT_NEAR( expected.v.y, r0.v.y, 1e-5f );
+   EXPECT_NEAR( expected.w, r0.w, 1e-5f );
+
+   Pose c( 2 );
+   c.set( test::target( 0, Pose::Target::Property::ROTATION ), test::rotationY( 1.0f ) );
+   a.add( c, 1.0f );
+   const auto r1 = a.getRotation( 0 );
+   const auto expected1 = test::rotationY( 2.0f );
+   EXPECT_NEAR( expected1.v.y, r1.v.y, 1e-5f );
+   EXPECT_NEAR( expected1.w, r1.w, 1e-5f );
+}
+
+TEST( Pose, animateSkeleton )
+{
+   auto root = crimild::alloc< Group >();
+   auto skeleton = root->attachComponent< Skeleton >();
+
+   auto hip = crimild::alloc< Group >();
+   auto hipJoint = hip->attachComponent< Joint >( "hip", 0 );
+   root->attachNode( hip );
+
+   auto knee = crimild::alloc< Group >();
+   auto kneeJoint = knee->attachComponent< Joint >( "knee", 1 );
+   auto kneeLocal = knee->getLocal();
+   kneeLocal.translate = Point3 { 0, -1, 0 };
+   knee->setLocal( kneeLocal );
+   hip->attachNode( knee );
+
+   skeleton->getJoints().insert( "hip", crimild::retain( hipJoint ) );
+   skeleton->getJoints().insert( "knee", crimild::retain( kneeJoint ) );
+
+   auto clip = crimild::alloc< Clip >( "walk" );
+   clip->addChannel( crimild::alloc< Vector3fChannel >( "hip[p]", Array< Real32 > { 0, 2 }, Array< Vector3f > { Vector3f { 0, 0, 0 }, Vector3f { 0, 0, 4 } } ) );
+   clip->addChannel( crimild::alloc< Vector3fChannel >( "missing[p]", Array< Real32 > { 0, 2 }, Array< Vector3f > { Vector3f { 0, 0, 0 }, Vector3f { 1, 1, 1 } } ) );
+
+   auto animation = crimild::alloc< Animation >( clip );
+   animation->bind( skeleton );
+
+   ASSERT_TRUE( animation->isBoundTo( skeleton ) );
+   ASSERT_NE( nullptr, animation->getPose() );
+   EXPECT_EQ( 2, animation->getPose()->getJointCount() );
+   EXPECT_EQ( Pose::Target::Property::NONE, animation->getPoseTargets()[ 1 ].property );
+
+   animation->update( Clock( 0.5 ) );
+   skeleton->animate( animation );
+
+   EXPECT_FLOAT_EQ( 1, hip->getLocal().translate.z );
+
+   // Not animated, so it keeps its rest pose
+   EXPECT_FLOAT_EQ( -1, knee->getLocal().translate.y );
+
+   animation->bind( nullptr );
+   EXPECT_FALSE( animation->isBound() );
+   EXPECT_EQ( nullptr, animation->getPose() );
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Animation/Skeleton.hpp"
+
+#include "Animation/Animation.hpp"
+#include "Animation/AnimationStage.hpp"
+#include "Animation/ChannelImpl.hpp"
+#include "Animation/Clip.hpp"
+#include "Common/Profiler.hpp"
+#include "SceneGraph/Group.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::test {
+
+   struct Character {
+      SharedPointer< Group > root;
+      Skeleton *skeleton = nullptr;
+      SharedPointer< Group > hip;
+      SharedPointer< Group > knee;
+   };
+
+   /**
+      \brief A skeleton with two joints. The knee is one unit below the hip and
+      there is an intermediate node between them.
+    */
+   static Character createCharacter( void )
+   {
+      Character character;
+      character.root = crimild::alloc< Group >();
+      character.skeleton = character.root->attachComponent< Skeleton >();
+
+      character.hip = crimild::alloc< Group >();
+      auto hipJoint = character.hip->attachComponent< Joint >( "hip", 0 );
+      character.root->attachNode( character.hip );
+
+      auto leg = crimild::alloc< Group >();
+      auto legLocal = leg->getLocal();
+      legLocal.translate = Point3 { 0, -0.5f, 0 };
+      leg->setLocal( legLocal );
+      character.hip->attachNode( leg );
+
+      character.knee = crimild::alloc< Group >();
+      auto kneeJoint = character.knee->attachComponent< Joint >( "knee", 1 );
+      auto kneeLocal = character.knee->getLocal();
+      kneeLocal.translate = Point3 { 0, -0.5f, 0 };
+      character.knee->setLocal( kneeLocal );
+      leg->attachNode( character.knee );
+
+      character.skeleton->getJoints().insert( "hip", crimild::retain( hipJoint ) );
+      character.skeleton->getJoints().insert( "knee", crimild::retain( kneeJoint ) );
+
+      return character;
+   }
+
+   /**
+      \brief Moves the hip from the origin to ( 0, 0, distance ) in 2 seconds
+    */
+   static SharedPointer< Animation > createAnimation( Real32 distance = 4 )
+   {
+      auto clip = crimild::alloc< Clip >( "walk" );
+      clip->addChannel( crimild::alloc< Vector3fChannel >( "hip[p]", Array< Real32 > { 0, 2 }, Array< Vector3f > { Vector3f { 0, 0, 0 }, Vector3f { 0, 0, distance } } ) );
+      return crimild::alloc< Animation >( clip );
+   }
+
+   static void expectTranslation( const Matrix4f &M, Real32 x, Real32 y, Real32 z )
+   {
+      EXPECT_FLOAT_EQ( x, M[ 3 ][ 0 ] );
+      EXPECT_FLOAT_EQ( y, M[ 3 ][ 1 ] );
+      EXPECT_FLOAT_EQ( z, M[ 3 ][ 2 ] );
+   }
+
+}
+
+TEST( Skeleton, computePalette )
+{
+   auto character = test::createCharacter();
+   auto animation = test::createAnimation();
+   animation->bind( character.skeleton );
+   animation->update( Clock( 0.5 ) );
+
+   character.skeleton->computePalette( *animation->getPose() );
+
+   const auto &palette = character.skeleton->getPalette();
+   ASSERT_EQ( 2, palette.size() );
+   test::expectTranslation( palette[ 0 ], 0, 0, 1 );
+   test::expectTranslation( palette[ 1 ], 0, -1, 1 );
+
+   auto knee = character.skeleton->getJoints()[ "knee" ];
+   test::expectTranslation( knee->getPoseMatrix(), 0, -1, 1 );
+}
+
+TEST( Skeleton, updateAnimation )
+{
+   auto character = test::createCharacter();
+   character.skeleton->setAnimation( test::createAnimation() );
+
+   ASSERT_TRUE( character.skeleton->hasAnimation() );
+   ASSERT_NE( nullptr, character.skeleton->updateAnimation( Clock( 0.5 ) ) );
+
+   test::expectTranslation( character.skeleton->getPalette()[ 0 ], 0, 0, 1 );
+
+   // Nodes are not modified until requested
+   EXPECT_FLOAT_EQ( 0, character.hip->getLocal().translate.z );
+   character.skeleton->updateJointNodes();
+   EXPECT_FLOAT_EQ( 1, character.hip->getLocal().translate.z );
+   EXPECT_FLOAT_EQ( -0.5f, character.knee->getLocal().translate.y );
+}
+
+TEST( Skeleton, animationCallback )
+{
+   auto character = test::createCharacter();
+   auto walk = test::createAnimation();
+   auto run = test::createAnimation();
+   run->setTimeScale( 2 );
+   walk->bind( character.skeleton );
+   run->bind( character.skeleton );
+
+   character.skeleton->setAnimationCallback( [ walk, run ]( const Clock &c ) {
+      run->update( c );
+      return walk->update( c )->lerp( run, 0.5f, false );
+   } );
+
+   character.skeleton->updateAnimation( Clock( 0.5 ) );
+
+   // Halfway between 1 and 2
+   test::expectTranslation( character.skeleton->getPalette()[ 0 ], 0, 0, 1.5f );
+}
+
+TEST( Skeleton, blendWithAnimate )
+{
+   auto character = test::createCharacter();
+   auto walk = test::createAnimation( 4 );
+   auto run = test::createAnimation( 8 );
+   auto stop = test::createAnimation( 0 );
+
+   // Only the animation passed to animate() is bound to the skeleton by it
+   for ( auto frame = 1; frame <= 3; ++frame ) {
+      auto animation = walk->update( Clock( 0.5 ) )->lerp( run, 0.5f )->add( stop, 1 );
+      character.skeleton->animate( animation );
+
+      // Halfway between walking and running
+      EXPECT_FLOAT_EQ( 1.5f * frame, character.hip->getLocal().translate.z );
+   }
+
+   EXPECT_TRUE( walk->isBoundTo( character.skeleton ) );
+   EXPECT_TRUE( run->isBoundTo( character.skeleton ) );
+}
+
+TEST( Skeleton, blendDifferentChannels )
+{
+   auto character = test::createCharacter();
+   auto walk = test::createAnimation( 4 );
+
+   // Moves the knee sideways instead
+   auto clip = crimild::alloc< Clip >( "sway" );
+   clip->addChannel( crimild::alloc< Vector3fChannel >( "knee[p]", Array< Real32 > { 0, 2 }, Array< Vector3f > { Vector3f { 0, 0, 0 }, Vector3f { 2, 0, 0 } } ) );
+   auto sway = crimild::alloc< Animation >( clip );
+
+   // Blending binds the other animation, but only if this one is bound already
+   walk->bind( character.skeleton );
+
+   // Blended values must not carry over to the next frame
+   for ( auto frame = 1; frame <= 3; ++frame ) {
+      auto animation = walk->update( Clock( 0.5 ) )->add( sway->update( Clock( 0.5 ) ), 1 );
+      character.skeleton->animate( animation );
+
+      EXPECT_FLOAT_EQ( frame, character.hip->getLocal().translate.z );
+      EXPECT_FLOAT_EQ( 0.5f * frame, character.knee->getLocal().translate.x );
+      EXPECT_FLOAT_EQ( -0.5f, character.knee->getLocal().translate.y );
+   }
+
+   // Both stay 1.5 seconds in
+   for ( auto frame = 0; frame < 3; ++frame ) {
+      auto animation = walk->update( Clock( 0 ) )->lerp( sway->update( Clock( 0 ) ), 0.5f, false );
+      character.skeleton->animate( animation );
+
+      // Halfway between the rest pose and swaying
+      EXPECT_FLOAT_EQ( 0.75f, character.knee->getLocal().translate.x );
+      EXPECT_FLOAT_EQ( -0.25f, character.knee->getLocal().translate.y );
+   }
+
+   // Without blending, the knee goes back to its rest pose
+   character.skeleton->animate( walk->update( Clock( 0 ) ) );
+   EXPECT_FALSE( walk->getPose()->isAnimated( 1, Pose::Target::Property::TRANSLATION ) );
+   EXPECT_FLOAT_EQ( 0, character.knee->getLocal().translate.x );
+   EXPECT_FLOAT_EQ( -0.5f, character.knee->getLocal().translate.y );
+}
+
+TEST( AnimationStage, update )
+{
+   auto scene = crimild::alloc< Group >();
+   std::vector< test::Character > characters;
+   for ( auto i = 0; i < 10; ++i ) {
+      auto character = test::createCharacter();
+      character.skeleton->setAnimation( test::createAnimation() );
+      scene->attachNode( character.root );
+      characters.push_back( character );
+   }
+
+   // Not in the scene
+   auto other = test::createCharacter();
+   other.skeleton->setAnimation( test::createAnimation() );
+
+   // The stage is profiled, which is usually set up by the simulation
+   Profiler profiler;
+
+   AnimationStage stage;
+   stage.setGrain( 3 );
+   stage.update( crimild::get_ptr( scene ), Clock( 0.5 ) );
+
+   EXPECT_EQ( 10, stage.getSkeletons().size() );
+   for ( auto &character : characters ) {
+      test::expectTranslation( character.skeleton->getPalette()[ 1 ], 0, -1, 1 );
+      EXPECT_FLOAT_EQ( 1, character.hip->getLocal().translate.z );
+   }
+
+   EXPECT_TRUE( other.skeleton->getPalette().empty() );
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Animation/Skinning.hpp"
+
+#include "Rendering/VertexBuffer.hpp"
+
+#include <cmath>
+#include <crimild/math/Transformation.hpp>
+#include <crimild/math/numbers.hpp>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::animation;
+
+namespace crimild::test {
+
+   /**
+      \brief Two vertices. The first one follows joint 0 and the second one is
+      influenced by both joints equally.
+    */
+   static SharedPointer< VertexBuffer > createSkinnedVertices( void )
+   {
+      auto layout = VertexLayout()
+                       .withAttribute< Vector3f >( VertexAttribute::Name::POSITION )
+                       .withAttribute< Vector3f >( VertexAttribute::Name::NORMAL )
+                       .withAttribute< Vector4f >( VertexAttribute::Name::BLEND_INDICES )
+                       .withAttribute< Vector4f >( VertexAttribute::Name::BLEND_WEIGHT );
+
+      auto vertices = crimild::alloc< VertexBuffer >( layout, 2 );
+
+      auto positions = vertices->get( VertexAttribute::Name::POSITION );
+      positions->set( 0, Vector3f { 1, 0, 0 } );
+      positions->set( 1, Vector3f { 0, 1, 0 } );
+
+      auto normals = vertices->get( VertexAttribute::Name::NORMAL );
+      normals->set( 0, Vector3f { 1, 0, 0 } );
+      normals->set( 1, Vector3f { 0, 1, 0 } );
+
+      auto indices = vertices->get( VertexAttribute::Name::BLEND_INDICES );
+      indices->set( 0, Vector4f { 0, 0, 0, 0 } );
+      indices->set( 1, Vector4f { 0, 1, 0, 0 } );
+
+      auto weights = vertices->get( VertexAttribute::Name::BLEND_WEIGHT );
+      weights->set( 0, Vector4f { 1, 0, 0, 0 } );
+      weights->set( 1, Vector4f { 0.5f, 0.5f, 0, 0 } );
+
+      return vertices;
+   }
+
+   static void expectNear( const Vector3f &expected, const Vector3f &actual )
+   {
+      EXPECT_NEAR( expected.x, actual.x, 1e-5f );
+      EXPECT_NEAR( expected.y, actual.y, 1e-5f );
+      EXPECT_NEAR( expected.z, actual.z, 1e-5f );
+   }
+
+}
+
+TEST( SkinnedVertices, construction )
+{
+   auto source = test::createSkinnedVertices();
+   SkinnedVertices skin( crimild::get_ptr( source ) );
+
+   EXPECT_EQ( 2, skin.getVertexCount() );
+   EXPECT_TRUE( skin.hasNormals() );
+
+   auto target = skin.createTarget();
+   EXPECT_EQ( 2, target->getVertexCount() );
+   EXPECT_EQ( BufferView::Usage::DYNAMIC, target->getBufferView()->getUsage() );
+   EXPECT_NE( nullptr, target->get( VertexAttribute::Name::NORMAL ) );
+}
+
+TEST( SkinnedVertices, missingWeights )
+{
+   auto source = crimild::alloc< VertexBuffer >( VertexLayout::P3_N3, 2 );
+   SkinnedVertices skin( crimild::get_ptr( source ) );
+   EXPECT_EQ( 0, skin.getVertexCount() );
+}
+
+TEST( SkinnedVertices, skin )
+{
+   auto source = test::createSkinnedVertices();
+   SkinnedVertices skin( crimild::get_ptr( source ) );
+   auto target = skin.createTarget();
+
+   Transformation translate;
+   translate.translate = Point3 { 0, 0, 2 };
+
+   Transformation rotate;
+   rotate.rotate = Quaternion { 0, 0, std::sin( 0.25f * numbers::PI ), std::cos( 0.25f * numbers::PI ) };
+
+   std::vector< Matrix4f > palette = {
+      Matrix4f( translate ),
+      Matrix4f( rotate ),
+   };
+
+   skin.skin( palette.data(), palette.size(), crimild::get_ptr( target ) );
+
+   auto positions = target->get( VertexAttribute::Name::POSITION );
+   auto normals = target->get( VertexAttribute::Name::NORMAL );
+
+   test::expectNear( Vector3f { 1, 0, 2 }, positions->get< Vector3f >( 0 ) );
+   test::expectNear( Vector3f { 1, 0, 0 }, normals->get< Vector3f >( 0 ) );
+
+   // Half translated and half rotated 90 degrees around Z
+   test::expectNear( Vector3f { -0.5f, 0.5f, 1 }, positions->get< Vector3f >( 1 ) );
+   test::expectNear( Vector3f { -1.0f / std::sqrt( 2.0f ), 1.0f / std::sqrt( 2.0f ), 0 }, normals->get< Vector3f >( 1 ) );
+}
+
+TEST( SkinnedVertices, notEnoughJoints )
+{
+   auto source = test::createSkinnedVertices();
+   SkinnedVertices skin( crimild::get_ptr( source ) );
+   auto target = skin.createTarget();
+
+   std::vector< Matrix4f > palette = { Matrix4f::Constants::IDENTITY };
+   skin.skin( palette.data(), palette.size(), crimild::get_ptr( target ) );
+
+   // Target keeps the bind pose
+   auto positions = target->get( VertexAttribute::Name::POSITION );
+   EXPECT_EQ( ( Vector3f { 1, 0, 0 } ), positions->get< Vector3f >( 0 ) );
+}
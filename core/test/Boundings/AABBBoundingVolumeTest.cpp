@@ -29,6 +29,7 @@
 
 #include <crimild/math/isEqual.hpp>
 #include <crimild/math/numbers.hpp>
+#include <crimild/math/rotation.hpp>
 #include <crimild/math/translation.hpp>
 #include <gtest/gtest.h>
 
@@ -70,6 +71,18 @@ TEST( AABBBoundingVolume, compute_from_transformed_volume )
    EXPECT_EQ( ( Point3f { -1 + 1, 2 + 1, 3 + 1 } ), bb->getMax() );
 }
 
+TEST( AABBBoundingVolume, compute_from_rotated_volume )
+{
+   auto bb = crimild::alloc< AABBBoundingVolume >();
+   auto other = crimild::alloc< AABBBoundingVolume >();
+   other->computeFrom( Point3f { -2, -1, -1 }, Point3f { 2, 1, 1 } );
+
+   bb->computeFrom( crimild::get_ptr( other ), rotationY( numbers::PI_DIV_2 ) );
+
+   EXPECT_TRUE( isEqual( Point3f { -1, -1, -2 }, bb->getMin() ) );
+   EXPECT_TRUE( isEqual( Point3f { 1, 1, 2 }, bb->getMax() ) );
+}
+
 TEST( AABBBoundingVolume, ray_intersection_hit )
 {
    auto bb = crimild::alloc< AABBBoundingVolume >();
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Components/ComponentRegistry.hpp"
+
+#include "Components/LambdaComponent.hpp"
+#include "Components/NodeComponent.hpp"
+#include "SceneGraph/Group.hpp"
+#include "SceneGraph/Switch.hpp"
+#include "Visitors/UpdateComponents.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace crimild;
+
+namespace crimild {
+
+   namespace test {
+
+      class CountingComponent : public NodeComponent {
+         CRIMILD_IMPLEMENT_RTTI( crimild::test::CountingComponent )
+
+      public:
+         virtual void update( const Clock & ) override { ++count; }
+
+         int count = 0;
+      };
+
+      class OtherComponent : public NodeComponent {
+         CRIMILD_IMPLEMENT_RTTI( crimild::test::OtherComponent )
+      };
+
+   }
+
+}
+
+TEST( ComponentRegistry, type_ids_are_dense_and_stable )
+{
+   auto &registry = ComponentRegistry::getInstance();
+
+   const auto a = ComponentRegistry::getTypeId< test::CountingComponent >();
+   const auto b = ComponentRegistry::getTypeId< test::OtherComponent >();
+
+   EXPECT_NE( a, b );
+   EXPECT_LT( a, registry.getTypeCount() );
+   EXPECT_LT( b, registry.getTypeCount() );
+   EXPECT_EQ( a, registry.getTypeId( test::CountingComponent::__CLASS_NAME ) );
+   EXPECT_EQ( a, registry.findTypeId( test::CountingComponent::__CLASS_NAME ) );
+   EXPECT_EQ( ComponentRegistry::INVALID_TYPE_ID, registry.findTypeId( "crimild::test::NotAComponent" ) );
+
+   auto cmp = crimild::alloc< test::CountingComponent >();
+   EXPECT_EQ( a, cmp->getComponentTypeId() );
+}
+
+TEST( ComponentRegistry, tracks_attached_components )
+{
+   auto &registry = ComponentRegistry::getInstance();
+   const auto typeId = ComponentRegistry::getTypeId< test::CountingComponent >();
+   const auto count = registry.getComponentCount( typeId );
+
+   auto node = crimild::alloc< Node >();
+   auto cmp = crimild::alloc< test::CountingComponent >();
+   node->attachComponent( cmp );
+
+   EXPECT_EQ( count + 1, registry.getComponentCount( typeId ) );
+   EXPECT_EQ( crimild::get_ptr( cmp ), node->getComponent< test::CountingComponent >() );
+   EXPECT_EQ( nullptr, node->getComponent< test::OtherComponent >() );
+
+   node->detachComponent( cmp );
+
+   EXPECT_EQ( count, registry.getComponentCount( typeId ) );
+   EXPECT_EQ( nullptr, node->getComponent< test::CountingComponent >() );
+}
+
+TEST( ComponentRegistry, destroying_node_removes_components )
+{
+   auto &registry = ComponentRegistry::getInstance();
+   const auto typeId = ComponentRegistry::getTypeId< test::CountingComponent >();
+   const auto count = registry.getComponentCount( typeId );
+
+   {
+      auto node = crimild::alloc< Node >();
+      node->attachComponent< test::CountingComponent >();
+      node->attachComponent< test::OtherComponent >();
+      EXPECT_EQ( count + 1, registry.getComponentCount( typeId ) );
+   }
+
+   EXPECT_EQ( count, registry.getComponentCount( typeId ) );
+}
+
+TEST( ComponentRegistry, detach_while_iterating )
+{
+   auto &registry = ComponentRegistry::getInstance();
+   const auto typeId = ComponentRegistry::getTypeId< test::CountingComponent >();
+
+   auto a = crimild::alloc< Node >();
+   auto cmpA = a->attachComponent< test::CountingComponent >();
+   auto b = crimild::alloc< Node >();
+   auto cmpB = b->attachComponent< test::CountingComponent >();
+
+   const auto count = registry.getComponentCount( typeId );
+
+   registry.forEach( typeId, [ & ]( NodeComponent *component ) {
+      if ( component == cmpA ) {
+         b->detachAllComponents();
+      } else {
+         EXPECT_NE( cmpB, component );
+      }
+   } );
+
+   EXPECT_EQ( count - 1, registry.getComponentCount( typeId ) );
+   EXPECT_EQ( cmpA, a->getComponent< test::CountingComponent >() );
+}
+
+TEST( ComponentRegistry, update_components_only_in_hierarchy )
+{
+   auto scene = crimild::alloc< Group >();
+   auto child = crimild::alloc< Node >();
+   scene->attachNode( child );
+   auto inScene = scene->attachComponent< test::CountingComponent >();
+   auto inChild = child->attachComponent< test::CountingComponent >();
+   auto disabled = child->attachComponent< test::OtherComponent >();
+   disabled->setEnabled( false );
+
+   auto other = crimild::alloc< Node >();
+   auto notInScene = other->attachComponent< test::CountingComponent >();
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 1, inScene->count );
+   EXPECT_EQ( 1, inChild->count );
+   EXPECT_EQ( 0, notInScene->count );
+
+   child->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 1, inScene->count );
+   EXPECT_EQ( 2, inChild->count );
+}
+
+TEST( ComponentRegistry, update_components_skips_disabled_subtrees )
+{
+   auto scene = crimild::alloc< Group >();
+   auto group = crimild::alloc< Group >();
+   auto child = crimild::alloc< Node >();
+   scene->attachNode( group );
+   group->attachNode( child );
+   auto inScene = scene->attachComponent< test::CountingComponent >();
+   auto inGroup = group->attachComponent< test::CountingComponent >();
+   auto inChild = child->attachComponent< test::CountingComponent >();
+
+   group->setEnabled( false );
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 1, inScene->count );
+   EXPECT_EQ( 0, inGroup->count );
+   EXPECT_EQ( 0, inChild->count );
+
+   group->setEnabled( true );
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 2, inScene->count );
+   EXPECT_EQ( 1, inGroup->count );
+   EXPECT_EQ( 1, inChild->count );
+}
+
+TEST( ComponentRegistry, update_components_only_selected_switch_nodes )
+{
+   auto scene = crimild::alloc< Switch >();
+   auto a = crimild::alloc< Group >();
+   auto b = crimild::alloc< Node >();
+   auto c = crimild::alloc< Node >();
+   scene->attachNode( a );
+   scene->attachNode( b );
+   a->attachNode( c );
+   auto inA = a->attachComponent< test::CountingComponent >();
+   auto inB = b->attachComponent< test::CountingComponent >();
+   auto inC = c->attachComponent< test::CountingComponent >();
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 1, inA->count );
+   EXPECT_EQ( 0, inB->count );
+   EXPECT_EQ( 1, inC->count );
+
+   scene->selectNextNode();
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_EQ( 1, inA->count );
+   EXPECT_EQ( 1, inB->count );
+   EXPECT_EQ( 1, inC->count );
+}
+
+TEST( ComponentRegistry, update_components_parents_before_children )
+{
+   // Attach components to children first, so registry order is not hierarchical
+   auto scene = crimild::alloc< Group >();
+   auto group = crimild::alloc< Group >();
+   auto child = crimild::alloc< Node >();
+
+   std::vector< Node * > updated;
+   auto record = [ & ]( Node *node, const Clock & ) { updated.push_back( node ); };
+   child->attachComponent< LambdaComponent >( record );
+   group->attachComponent< LambdaComponent >( record );
+   scene->attachComponent< LambdaComponent >( record );
+
+   group->attachNode( child );
+   scene->attachNode( group );
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+
+   ASSERT_EQ( 3, updated.size() );
+   EXPECT_EQ( crimild::get_ptr( scene ), updated[ 0 ] );
+   EXPECT_EQ( crimild::get_ptr( group ), updated[ 1 ] );
+   EXPECT_EQ( crimild::get_ptr( child ), updated[ 2 ] );
+}
+
+TEST( ComponentRegistry, update_components_attached_while_updating )
+{
+   auto scene = crimild::alloc< Node >();
+   test::CountingComponent *attached = nullptr;
+   scene->attachComponent< LambdaComponent >( [ & ]( Node *node, const Clock & ) {
+      if ( attached == nullptr ) {
+         attached = node->attachComponent< test::CountingComponent >();
+      }
+   } );
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+   ASSERT_NE( nullptr, attached );
+
+   // Whether it's updated in the same pass depends on type ids
+   const auto count = attached->count;
+   EXPECT_LE( count, 1 );
+
+   scene->perform( UpdateComponents( clock ) );
+   EXPECT_EQ( count + 1, attached->count );
+}
+
+TEST( ComponentRegistry, update_components_detached_while_updating )
+{
+   auto scene = crimild::alloc< Group >();
+   auto a = crimild::alloc< Node >();
+   scene->attachNode( a );
+   auto b = crimild::alloc< Node >();
+   scene->attachNode( b );
+
+   // All components have the same type, so any of them might be updated first
+   auto updates = 0;
+   auto detach = [ & ]( Node *node, const Clock & ) {
+      ASSERT_NE( nullptr, node );
+      ++updates;
+      if ( a != nullptr ) {
+         // Destroys a and its components, which are kept alive until the pass ends
+         scene->detachNode( a );
+         a = nullptr;
+         b->detachAllComponents();
+      }
+   };
+   scene->attachComponent< LambdaComponent >( detach );
+   a->attachComponent< LambdaComponent >( detach );
+   b->attachComponent< LambdaComponent >( detach );
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+   EXPECT_LE( updates, 3 );
+
+   updates = 0;
+   scene->perform( UpdateComponents( clock ) );
+   EXPECT_EQ( 1, updates );
+}
+
+TEST( ComponentRegistry, update_components_does_not_block_other_threads )
+{
+   auto scene = crimild::alloc< Node >();
+   auto attached = false;
+   scene->attachComponent< LambdaComponent >( [ & ]( Node *, const Clock & ) {
+      // Would deadlock if the registry was locked while updating
+      std::thread(
+         [ & ] {
+            auto node = crimild::alloc< Node >();
+            node->attachComponent< test::CountingComponent >();
+            attached = true;
+         }
+      ).join();
+   } );
+
+   Clock clock;
+   scene->perform( UpdateComponents( clock ) );
+
+   EXPECT_TRUE( attached );
+}
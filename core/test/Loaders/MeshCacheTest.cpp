@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Loaders/MeshCache.hpp"
+
+#include "Primitives/Primitive.hpp"
+#include "Rendering/Vertex.hpp"
+#include "SceneGraph/Geometry.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static std::string getCacheDirectory( void )
+   {
+      return ( std::filesystem::temp_directory_path() / "crimild_mesh_cache_test" ).string();
+   }
+
+   static MeshCache::Key getKey( void )
+   {
+      MeshCache::Key key;
+      key.source = "assets/models/quad.obj";
+      key.timestamp = 1234;
+      key.importerVersion = 1;
+      return key;
+   }
+
+   static SharedPointer< Primitive > createQuad( void )
+   {
+      auto primitive = crimild::alloc< Primitive >( Primitive::Type::TRIANGLES );
+      primitive->setVertexData(
+         {
+            crimild::alloc< VertexBuffer >(
+               VertexP3N3TC2::getLayout(),
+               Array< VertexP3N3TC2 > {
+                  { .position = Vector3f { -1, -1, 0 }, .normal = Vector3f { 0, 0, 1 }, .texCoord = Vector2f { 0, 0 } },
+                  { .position = Vector3f { 1, -1, 0 }, .normal = Vector3f { 0, 0, 1 }, .texCoord = Vector2f { 1, 0 } },
+                  { .position = Vector3f { 1, 1, 0 }, .normal = Vector3f { 0, 0, 1 }, .texCoord = Vector2f { 1, 1 } },
+                  { .position = Vector3f { -1, 1, 0 }, .normal = Vector3f { 0, 0, 1 }, .texCoord = Vector2f { 0, 1 } },
+               }
+            ),
+         }
+      );
+      primitive->setIndices(
+         crimild::alloc< IndexBuffer >( Format::INDEX_32_UINT, Array< UInt32 > { 0, 1, 2, 0, 2, 3 } )
+      );
+      return primitive;
+   }
+
+   static MeshCache::Contents createContents( void )
+   {
+      MeshCache::Contents contents;
+      contents.materialLibraries = { "quad.mtl" };
+      contents.meshes.push_back(
+         MeshCache::Mesh {
+            .object = "Quad",
+            .material = "red",
+            .primitive = createQuad(),
+            .min = Point3f { -1, -1, 0 },
+            .max = Point3f { 1, 1, 0 },
+         }
+      );
+      return contents;
+   }
+
+}
+
+TEST( MeshCache, storeAndLoad )
+{
+   const auto key = test::getKey();
+   const auto contents = test::createContents();
+
+   MeshCache cache( test::getCacheDirectory() );
+   ASSERT_TRUE( cache.store( key, contents ) );
+
+   MeshCache::Contents loaded;
+   ASSERT_TRUE( cache.load( key, loaded ) );
+
+   EXPECT_EQ( contents.materialLibraries, loaded.materialLibraries );
+   ASSERT_EQ( 1, loaded.meshes.size() );
+
+   const auto &mesh = loaded.meshes[ 0 ];
+   EXPECT_EQ( "Quad", mesh.object );
+   EXPECT_EQ( "red", mesh.material );
+   EXPECT_EQ( ( Point3f { -1, -1, 0 } ), mesh.min );
+   EXPECT_EQ( ( Point3f { 1, 1, 0 } ), mesh.max );
+
+   const auto primitive = crimild::get_ptr( mesh.primitive );
+   ASSERT_NE( nullptr, primitive );
+   EXPECT_EQ( Primitive::Type::TRIANGLES, primitive->getType() );
+
+   ASSERT_EQ( 1, primitive->getVertexData().size() );
+   const auto vbo = crimild::get_ptr( primitive->getVertexData()[ 0 ] );
+   const auto expectedVBO = crimild::get_ptr( contents.meshes[ 0 ].primitive->getVertexData()[ 0 ] );
+   EXPECT_EQ( VertexP3N3TC2::getLayout(), vbo->getVertexLayout() );
+   ASSERT_EQ( 4, vbo->getVertexCount() );
+   ASSERT_EQ( expectedVBO->getBufferView()->getLength(), vbo->getBufferView()->getLength() );
+   EXPECT_EQ( 0, memcmp( expectedVBO->getBufferView()->getData(), vbo->getBufferView()->getData(), vbo->getBufferView()->getLength() ) );
+   EXPECT_EQ( ( Vector3f { 1, 1, 0 } ), vbo->get( VertexAttribute::Name::POSITION )->get< Vector3f >( 2 ) );
+
+   const auto indices = primitive->getIndices();
+   ASSERT_NE( nullptr, indices );
+   EXPECT_EQ( Format::INDEX_32_UINT, indices->getFormat() );
+   ASSERT_EQ( 6, indices->getIndexCount() );
+   const UInt32 expectedIndices[] = { 0, 1, 2, 0, 2, 3 };
+   for ( Size i = 0; i < 6; ++i ) {
+      EXPECT_EQ( expectedIndices[ i ], indices->getIndex( i ) );
+   }
+}
+
+TEST( MeshCache, loadedBuffersPointIntoCacheFile )
+{
+   const auto key = test::getKey();
+
+   MeshCache::Contents loaded;
+   {
+      MeshCache cache( test::getCacheDirectory() );
+      ASSERT_TRUE( cache.store( key, test::createContents() ) );
+      ASSERT_TRUE( cache.load( key, loaded ) );
+   }
+
+   // Removing the file does not invalidate the mapping, which is owned by the buffers
+   std::error_code ec;
+   std::filesystem::remove( MeshCache( test::getCacheDirectory() ).getPath( key ), ec );
+
+   const auto primitive = crimild::get_ptr( loaded.meshes[ 0 ].primitive );
+   const auto vertices = primitive->getVertexData()[ 0 ]->getBufferView()->getBuffer();
+   const auto indices = primitive->getIndices()->getBufferView()->getBuffer();
+   EXPECT_TRUE( vertices->isExternal() );
+   EXPECT_TRUE( indices->isExternal() );
+   EXPECT_EQ( 4 * sizeof( VertexP3N3TC2 ), vertices->getSize() );
+   EXPECT_EQ( 6 * sizeof( UInt32 ), indices->getSize() );
+   EXPECT_EQ( 0, reinterpret_cast< uintptr_t >( vertices->getData() ) % 16 );
+   EXPECT_EQ( 0, reinterpret_cast< uintptr_t >( indices->getData() ) % 16 );
+   EXPECT_EQ( 3, primitive->getIndices()->getIndex( 5 ) );
+}
+
+TEST( MeshCache, loadedBuffersCanBeModified )
+{
+   const auto key = test::getKey();
+
+   MeshCache cache( test::getCacheDirectory() );
+   ASSERT_TRUE( cache.store( key, test::createContents() ) );
+
+   {
+      MeshCache::Contents loaded;
+      ASSERT_TRUE( cache.load( key, loaded ) );
+      auto vbo = loaded.meshes[ 0 ].primitive->getVertexData()[ 0 ];
+      vbo->get( VertexAttribute::Name::POSITION )->set( 2, Vector3f { 5, 5, 5 } );
+      EXPECT_EQ( ( Vector3f { 5, 5, 5 } ), vbo->get( VertexAttribute::Name::POSITION )->get< Vector3f >( 2 ) );
+   }
+
+   // Changes are never written back to the cache file
+   MeshCache::Contents reloaded;
+   ASSERT_TRUE( cache.load( key, reloaded ) );
+   auto vbo = reloaded.meshes[ 0 ].primitive->getVertexData()[ 0 ];
+   EXPECT_EQ( ( Vector3f { 1, 1, 0 } ), vbo->get( VertexAttribute::Name::POSITION )->get< Vector3f >( 2 ) );
+}
+
+TEST( MeshCache, missesWhenKeyChanges )
+{
+   const auto key = test::getKey();
+
+   MeshCache cache( test::getCacheDirectory() );
+   ASSERT_TRUE( cache.store( key, test::createContents() ) );
+
+   MeshCache::Contents loaded;
+
+   auto modified = key;
+   modified.timestamp = key.timestamp + 1;
+   EXPECT_FALSE( cache.load( modified, loaded ) );
+
+   auto upgraded = key;
+   upgraded.importerVersion = key.importerVersion + 1;
+   EXPECT_FALSE( cache.load( upgraded, loaded ) );
+
+   auto other = key;
+   other.source = "assets/models/other.obj";
+   EXPECT_FALSE( cache.load( other, loaded ) );
+
+   EXPECT_TRUE( loaded.meshes.empty() );
+   EXPECT_TRUE( cache.load( key, loaded ) );
+}
+
+TEST( MeshCache, missesWhenFileIsTruncated )
+{
+   const auto key = test::getKey();
+
+   MeshCache cache( test::getCacheDirectory() );
+   ASSERT_TRUE( cache.store( key, test::createContents() ) );
+
+   const auto path = cache.getPath( key );
+   const auto size = std::filesystem::file_size( path );
+   for ( auto truncated : { size - 1, size / 2, Size( 16 ), Size( 0 ) } ) {
+      std::filesystem::resize_file( path, truncated );
+      MeshCache::Contents loaded;
+      EXPECT_FALSE( cache.load( key, loaded ) );
+   }
+}
+
+TEST( MeshCache, geometryUsesCachedBounds )
+{
+   const auto contents = test::createContents();
+   const auto &mesh = contents.meshes[ 0 ];
+
+   auto geometry = crimild::alloc< Geometry >();
+   geometry->attachPrimitive( mesh.primitive, Point3f { -2, -2, -2 }, Point3f { 2, 2, 2 } );
+
+   // Bounds come from the arguments, not from vertex data
+   EXPECT_EQ( ( Point3f { -2, -2, -2 } ), geometry->getLocalBound()->getMin() );
+   EXPECT_EQ( ( Point3f { 2, 2, 2 } ), geometry->getLocalBound()->getMax() );
+}
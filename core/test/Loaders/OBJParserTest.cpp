@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Loaders/OBJParser.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static const char *CUBE_FACES = "# two faces of a cube\n"
+                                   "mtllib materials.mtl\n"
+                                   "v 0 0 0\n"
+                                   "v 1 0 0\n"
+                                   "v 1 1 0\n"
+                                   "v 0 1 0\n"
+                                   "v 0 0 -1\n"
+                                   "v 0 1 -1\n"
+                                   "vt 0 0\n"
+                                   "vt 1 0\n"
+                                   "vt 1 1\n"
+                                   "vt 0 1\n"
+                                   "vn 0 0 1\n"
+                                   "vn -1 0 0\n"
+                                   "o Front\n"
+                                   "usemtl red\n"
+                                   "f 1/1/1 2/2/1 3/3/1\n"
+                                   "f 1/1/1 3/3/1 4/4/1\n"
+                                   "o Left\n"
+                                   "usemtl green\n"
+                                   "f 5/1/2 1/2/2 4/3/2 6/4/2\n";
+
+   static void parse( OBJParser &parser, const char *src )
+   {
+      parser.parse( src, strlen( src ) );
+   }
+
+}
+
+TEST( OBJParser, parse_real )
+{
+   const char *inputs[] = {
+      "0",
+      "1",
+      "-1",
+      "+2.5",
+      "0.000001",
+      "3.14159265358979",
+      "-123.456",
+      ".5",
+      "5.",
+      "1e3",
+      "1.5E-3",
+      "-2.75e+2",
+      "0.1234567",
+      "98765.4321",
+      "1e-30",
+   };
+
+   for ( const auto input : inputs ) {
+      Real32 value;
+      const auto end = input + strlen( input );
+      EXPECT_EQ( end, OBJParser::parseReal( input, end, value ) ) << input;
+      EXPECT_EQ( std::strtof( input, nullptr ), value ) << input;
+   }
+}
+
+TEST( OBJParser, parse_real_stops_at_separators )
+{
+   const char *input = "  1.5 -2/3";
+   const auto end = input + strlen( input );
+
+   Real32 value;
+   auto it = OBJParser::parseReal( input, end, value );
+   EXPECT_EQ( 1.5f, value );
+   it = OBJParser::parseReal( it, end, value );
+   EXPECT_EQ( -2.0f, value );
+   EXPECT_EQ( '/', *it );
+
+   // Not a number
+   EXPECT_EQ( it, OBJParser::parseReal( it, end, value ) );
+}
+
+TEST( OBJParser, parse_int )
+{
+   const char *input = " 12/-3//+45 x";
+   const auto end = input + strlen( input );
+
+   Int32 value;
+   auto it = OBJParser::parseInt( input, end, value );
+   EXPECT_EQ( 12, value );
+   it = OBJParser::parseInt( it + 1, end, value );
+   EXPECT_EQ( -3, value );
+   it = OBJParser::parseInt( it + 2, end, value );
+   EXPECT_EQ( 45, value );
+   EXPECT_EQ( it, OBJParser::parseInt( it, end, value ) );
+}
+
+TEST( OBJParser, parse )
+{
+   OBJParser parser;
+   test::parse( parser, test::CUBE_FACES );
+
+   ASSERT_EQ( 6, parser.getPositions().size() );
+   ASSERT_EQ( 4, parser.getTexCoords().size() );
+   ASSERT_EQ( 2, parser.getNormals().size() );
+   EXPECT_EQ( ( Vector3f { 1, 1, 0 } ), parser.getPositions()[ 2 ] );
+   EXPECT_EQ( ( Vector3f { -1, 0, 0 } ), parser.getNormals()[ 1 ] );
+
+   // Texture coordinates are flipped vertically
+   EXPECT_EQ( ( Vector2f { 1, 0 } ), parser.getTexCoords()[ 2 ] );
+
+   ASSERT_EQ( 1, parser.getMaterialLibraries().size() );
+   EXPECT_EQ( "materials.mtl", parser.getMaterialLibraries()[ 0 ] );
+
+   ASSERT_EQ( 2, parser.getObjects().size() );
+   EXPECT_EQ( 4, parser.getTriangleCount() );
+
+   const auto &front = parser.getObjects()[ 0 ];
+   EXPECT_EQ( "Front", front.name );
+   ASSERT_EQ( 1, front.meshes.size() );
+   EXPECT_EQ( "red", front.meshes[ 0 ].material );
+
+   // Shared corners become a single vertex
+   EXPECT_EQ( 4, front.meshes[ 0 ].vertices.size() );
+   EXPECT_EQ( ( std::vector< UInt32 > { 0, 1, 2, 0, 2, 3 } ), front.meshes[ 0 ].indices );
+   EXPECT_EQ( ( OBJParser::Corner { 2, 2, 0 } ), front.meshes[ 0 ].vertices[ 2 ] );
+
+   // Quads are triangulated
+   const auto &left = parser.getObjects()[ 1 ];
+   EXPECT_EQ( "Left", left.name );
+   ASSERT_EQ( 1, left.meshes.size() );
+   EXPECT_EQ( "green", left.meshes[ 0 ].material );
+   EXPECT_EQ( 4, left.meshes[ 0 ].vertices.size() );
+   EXPECT_EQ( ( std::vector< UInt32 > { 0, 1, 2, 0, 2, 3 } ), left.meshes[ 0 ].indices );
+}
+
+TEST( OBJParser, missing_indices )
+{
+   OBJParser parser;
+   test::parse( parser, "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\nf 1 2 3" );
+
+   // Faces before any object declaration go into an anonymous object
+   ASSERT_EQ( 1, parser.getObjects().size() );
+   EXPECT_EQ( "", parser.getObjects()[ 0 ].name );
+
+   const auto &mesh = parser.getObjects()[ 0 ].meshes[ 0 ];
+   ASSERT_EQ( 6, mesh.vertices.size() );
+   EXPECT_EQ( ( OBJParser::Corner { 0, -1, 0 } ), mesh.vertices[ 0 ] );
+   EXPECT_EQ( ( OBJParser::Corner { 0, -1, -1 } ), mesh.vertices[ 3 ] );
+}
+
+TEST( OBJParser, relative_indices )
+{
+   OBJParser parser;
+   test::parse( parser, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 0 0 1\nf -4 -3 -1\n" );
+
+   const auto &mesh = parser.getObjects()[ 0 ].meshes[ 0 ];
+   ASSERT_EQ( 4, mesh.vertices.size() );
+   EXPECT_EQ( 0, mesh.vertices[ 0 ].position );
+   EXPECT_EQ( 1, mesh.vertices[ 1 ].position );
+   EXPECT_EQ( 2, mesh.vertices[ 2 ].position );
+   EXPECT_EQ( 3, mesh.vertices[ 3 ].position );
+}
+
+TEST( OBJParser, chunks_do_not_change_results )
+{
+   OBJParser expected;
+   test::parse( expected, test::CUBE_FACES );
+
+   // One chunk per line, with relative indices referencing values in other chunks
+   OBJParser parser;
+   parser.setChunkSize( 1 );
+   test::parse( parser, test::CUBE_FACES );
+
+   EXPECT_EQ( expected.getPositions(), parser.getPositions() );
+   EXPECT_EQ( expected.getTexCoords(), parser.getTexCoords() );
+   EXPECT_EQ( expected.getNormals(), parser.getNormals() );
+   ASSERT_EQ( expected.getObjects().size(), parser.getObjects().size() );
+   for ( Size i = 0; i < expected.getObjects().size(); ++i ) {
+      const auto &a = expected.getObjects()[ i ];
+      const auto &b = parser.getObjects()[ i ];
+      EXPECT_EQ( a.name, b.name );
+      ASSERT_EQ( a.meshes.size(), b.meshes.size() );
+      for ( Size j = 0; j < a.meshes.size(); ++j ) {
+         EXPECT_EQ( a.meshes[ j ].material, b.meshes[ j ].material );
+         EXPECT_EQ( a.meshes[ j ].vertices, b.meshes[ j ].vertices );
+         EXPECT_EQ( a.meshes[ j ].indices, b.meshes[ j ].indices );
+      }
+   }
+}
+
+TEST( OBJParser, windows_line_endings )
+{
+   OBJParser parser;
+   test::parse( parser, "o Triangle\r\nv 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nf 1 2 3\r\n" );
+
+   ASSERT_EQ( 1, parser.getObjects().size() );
+   EXPECT_EQ( "Triangle", parser.getObjects()[ 0 ].name );
+   EXPECT_EQ( ( Vector3f { 0, 1, 0 } ), parser.getPositions()[ 2 ] );
+   EXPECT_EQ( 1, parser.getTriangleCount() );
+}
+
+TEST( OBJParser, empty )
+{
+   OBJParser parser;
+   parser.parse( nullptr, 0 );
+
+   EXPECT_TRUE( parser.getObjects().empty() );
+   EXPECT_EQ( 0, parser.getTriangleCount() );
+}
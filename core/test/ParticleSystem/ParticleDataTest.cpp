@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleSystem/ParticleData.hpp"
+
+#include "ParticleSystem/Updaters/ZSortParticleUpdater.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   /**
+      \brief Creates particles with a position and a time, both set to the particle's index
+    */
+   static SharedPointer< ParticleData > createParticles( Size count, Bool lanes )
+   {
+      auto particles = crimild::alloc< ParticleData >( count );
+      particles->setUseAttribLanes( lanes );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
+      particles->createAttribArray< Real32 >( ParticleAttrib::TIME );
+      particles->generate();
+
+      auto ps = particles->getAttrib( ParticleAttrib::POSITION );
+      auto ts = particles->getAttrib( ParticleAttrib::TIME );
+      for ( Size i = 0; i < count; ++i ) {
+         ps->set( i, Vector3f { Real32( i ), 1, -Real32( i ) } );
+         ts->set( i, Real32( i ) );
+         particles->wake( i );
+      }
+      return particles;
+   }
+
+   /**
+      \brief Alive particles must be the expected ones, in any order, with all their attributes
+    */
+   static void expectCompacted( ParticleData &particles, const std::vector< Size > &expected )
+   {
+      auto ps = particles.getAttrib( ParticleAttrib::POSITION );
+      auto ts = particles.getAttrib( ParticleAttrib::TIME );
+
+      ASSERT_EQ( expected.size(), particles.getAliveCount() );
+      std::vector< Size > alive;
+      for ( Size i = 0; i < expected.size(); ++i ) {
+         const auto value = ts->get< Real32 >( i );
+         EXPECT_TRUE( particles.isAlive( i ) );
+         EXPECT_EQ( ( Vector3f { value, 1, -value } ), ps->get< Vector3f >( i ) );
+         alive.push_back( Size( value ) );
+      }
+      std::sort( alive.begin(), alive.end() );
+      EXPECT_EQ( expected, alive );
+
+      for ( Size i = expected.size(); i < particles.getParticleCount(); ++i ) {
+         EXPECT_FALSE( particles.isAlive( i ) );
+      }
+   }
+}
+
+TEST( ParticleData, compact )
+{
+   for ( auto lanes : { false, true } ) {
+      auto particles = test::createParticles( 200, lanes );
+
+      std::vector< Size > expected;
+      for ( Size i = 0; i < 200; ++i ) {
+         // Dead particles form runs of different lengths, crossing words in the mask
+         if ( i % 7 == 0 || ( i >= 60 && i < 70 ) || i == 199 ) {
+            particles->markDead( i );
+         } else {
+            expected.push_back( i );
+         }
+      }
+
+      // Particles are not removed until compacted
+      EXPECT_EQ( 200, particles->getAliveCount() );
+
+      particles->compact();
+      test::expectCompacted( *particles, expected );
+
+      // The mask is cleared after compacting
+      particles->compact();
+      test::expectCompacted( *particles, expected );
+   }
+}
+
+TEST( ParticleData, compact_without_dead_particles )
+{
+   auto particles = test::createParticles( 10, false );
+   particles->compact();
+   test::expectCompacted( *particles, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 } );
+}
+
+TEST( ParticleData, compact_all_particles )
+{
+   auto particles = test::createParticles( 100, true );
+   for ( Size i = 0; i < 100; ++i ) {
+      particles->markDead( i );
+   }
+   particles->compact();
+   test::expectCompacted( *particles, {} );
+
+   // Particles can be reused after compacting
+   particles->wake( 0 );
+   EXPECT_EQ( 1, particles->getAliveCount() );
+   particles->markDead( 0 );
+   particles->compact();
+   EXPECT_EQ( 0, particles->getAliveCount() );
+}
+
+TEST( ParticleData, compact_matches_kill )
+{
+   auto killed = test::createParticles( 50, false );
+   auto compacted = test::createParticles( 50, false );
+
+   for ( Size i = 50; i > 0; --i ) {
+      if ( ( i - 1 ) % 3 == 0 ) {
+         killed->kill( i - 1 );
+         compacted->markDead( i - 1 );
+      }
+   }
+   compacted->compact();
+
+   // Both keep the same particles, although not necessarily in the same order
+   ASSERT_EQ( killed->getAliveCount(), compacted->getAliveCount() );
+   std::vector< Real32 > a, b;
+   for ( Size i = 0; i < killed->getAliveCount(); ++i ) {
+      a.push_back( killed->getAttrib( ParticleAttrib::TIME )->get< Real32 >( i ) );
+      b.push_back( compacted->getAttrib( ParticleAttrib::TIME )->get< Real32 >( i ) );
+   }
+   std::sort( a.begin(), a.end() );
+   std::sort( b.begin(), b.end() );
+   EXPECT_EQ( a, b );
+}
+
+TEST( ParticleData, sort )
+{
+   auto particles = test::createParticles( 5, false );
+   EXPECT_FALSE( particles->hasSortedIndices() );
+
+   const Real32 keys[] = { 3, -1, 2, 0, 2 };
+   particles->sort( keys );
+   ASSERT_TRUE( particles->hasSortedIndices() );
+
+   const UInt32 expected[] = { 1, 3, 2, 4, 0 };
+   for ( Size i = 0; i < 5; ++i ) {
+      EXPECT_EQ( expected[ i ], particles->getSortedIndices()[ i ] );
+   }
+
+   // Particle data is not moved
+   EXPECT_EQ( 3.0f, particles->getAttrib( ParticleAttrib::TIME )->get< Real32 >( 3 ) );
+
+   // Indices are no longer valid after particles are removed
+   particles->markDead( 1 );
+   particles->compact();
+   EXPECT_FALSE( particles->hasSortedIndices() );
+}
+
+TEST( ParticleData, z_sort )
+{
+   for ( auto lanes : { false, true } ) {
+      ParticleData particles( 100 );
+      particles.setUseAttribLanes( lanes );
+
+      ZSortParticleUpdater updater;
+      updater.configure( nullptr, &particles );
+      particles.generate();
+
+      auto ps = particles.getAttrib( ParticleAttrib::POSITION );
+      for ( Size i = 0; i < 100; ++i ) {
+         ps->set( i, Vector3f { Real32( i ), 0, Real32( ( i * 37 ) % 100 ) - 50 } );
+         particles.wake( i );
+      }
+
+      // Dead particles are removed before sorting
+      particles.markDead( 10 );
+
+      updater.update( nullptr, 0.0, &particles );
+
+      ASSERT_EQ( 99, particles.getAliveCount() );
+      ASSERT_TRUE( particles.hasSortedIndices() );
+      auto order = particles.getSortedIndices();
+      for ( Size i = 1; i < particles.getAliveCount(); ++i ) {
+         EXPECT_LE( ps->get< Vector3f >( order[ i - 1 ] ).z, ps->get< Vector3f >( order[ i ] ).z );
+      }
+   }
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleSystem/ParticleKernels.hpp"
+
+#include "Concurrency/TaskSystem.hpp"
+#include "ParticleSystem/ParticleData.hpp"
+#include "ParticleSystem/Updaters/ColorParticleUpdater.hpp"
+#include "ParticleSystem/Updaters/EulerParticleUpdater.hpp"
+#include "ParticleSystem/Updaters/TimeParticleUpdater.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   /**
+      \brief Creates particles with positions, velocities and accelerations and wakes all of them
+    */
+   static SharedPointer< ParticleData > createParticles( Size count, Bool lanes, EulerParticleUpdater &euler )
+   {
+      auto particles = crimild::alloc< ParticleData >( count );
+      particles->setUseAttribLanes( lanes );
+      euler.configure( nullptr, crimild::get_ptr( particles ) );
+      particles->generate();
+
+      auto ps = particles->getAttrib( ParticleAttrib::POSITION );
+      auto vs = particles->getAttrib( ParticleAttrib::VELOCITY );
+      auto as = particles->getAttrib( ParticleAttrib::ACCELERATION );
+      for ( Size i = 0; i < count; ++i ) {
+         const auto x = Real32( i % 100 );
+         ps->set( i, Vector3f { x, 1, -x } );
+         vs->set( i, Vector3f { 1, x, 2 } );
+         as->set( i, Vector3f { 0, 0, 0.5f * x } );
+         particles->wake( i );
+      }
+      return particles;
+   }
+
+}
+
+TEST( ParticleKernels, lane_array )
+{
+   ParticleLaneArray lanes( 3 );
+   lanes.reset( 21 );
+
+   EXPECT_EQ( 3, lanes.getLaneCount() );
+   EXPECT_EQ( 21, lanes.getCount() );
+   EXPECT_LE( 21, lanes.getLaneStride() );
+   EXPECT_EQ( 0, lanes.getLaneStride() % ParticleLaneArray::WIDTH );
+   for ( Size i = 0; i < 3; ++i ) {
+      EXPECT_EQ( 0, reinterpret_cast< std::uintptr_t >( lanes.getLane( i ) ) % ParticleLaneArray::ALIGNMENT );
+   }
+
+   lanes.set( 3, Vector3f { 1, 2, 3 } );
+   lanes.set( 7, Vector3f { 4, 5, 6 } );
+   EXPECT_EQ( 1, lanes.getLane( 0 )[ 3 ] );
+   EXPECT_EQ( 2, lanes.getLane( 1 )[ 3 ] );
+   EXPECT_EQ( 3, lanes.getLane( 2 )[ 3 ] );
+
+   lanes.swap( 3, 7 );
+   EXPECT_EQ( ( Vector3f { 4, 5, 6 } ), lanes.get< Vector3f >( 3 ) );
+   EXPECT_EQ( ( Vector3f { 1, 2, 3 } ), lanes.get< Vector3f >( 7 ) );
+}
+
+TEST( ParticleKernels, create_attrib_lanes )
+{
+   ParticleData particles( 10 );
+   particles.setUseAttribLanes( true );
+
+   EXPECT_EQ( 3, particles.createAttribArray< Vector3f >( ParticleAttrib::POSITION )->getLaneCount() );
+   EXPECT_EQ( 4, particles.createAttribArray< ColorRGBA >( ParticleAttrib::COLOR )->getLaneCount() );
+
+   // Single-lane arrays can still be accessed as arrays of Real32
+   auto times = particles.createAttribArray< Real32 >( ParticleAttrib::TIME );
+   EXPECT_EQ( 1, times->getLaneCount() );
+   particles.generate();
+   times->getData< Real32 >()[ 5 ] = 3;
+   EXPECT_EQ( 3, times->get< Real32 >( 5 ) );
+
+   ParticleData interleaved( 10 );
+   EXPECT_EQ( 0, interleaved.createAttribArray< Vector3f >( ParticleAttrib::POSITION )->getLaneCount() );
+}
+
+TEST( ParticleKernels, kernels )
+{
+   // Odd ranges exercise both SIMD and scalar paths
+   const Size count = 37;
+   std::vector< Real32 > a( count ), b( count ), times( count ), lifetimes( count ), dst( count );
+   for ( Size i = 0; i < count; ++i ) {
+      a[ i ] = Real32( i );
+      b[ i ] = Real32( 2 * i + 1 );
+      times[ i ] = Real32( i % 5 );
+      lifetimes[ i ] = 4.0f;
+   }
+
+   auto x = a;
+   particles::add( x.data(), 2.0f, 3, 34 );
+   for ( Size i = 0; i < count; ++i ) {
+      EXPECT_EQ( i >= 3 && i < 34 ? a[ i ] + 2.0f : a[ i ], x[ i ] );
+   }
+
+   x = a;
+   particles::addScaled( x.data(), b.data(), 0.5f, 0, count );
+   for ( Size i = 0; i < count; ++i ) {
+      EXPECT_FLOAT_EQ( a[ i ] + 0.5f * b[ i ], x[ i ] );
+   }
+
+   auto dst2 = dst;
+   Real32 *dsts[] = { dst.data(), dst2.data() };
+   const Real32 *froms[] = { a.data(), b.data() };
+   const Real32 *tos[] = { b.data(), a.data() };
+   particles::lerpByAge( dsts, froms, tos, 2, times.data(), lifetimes.data(), 1, count );
+   for ( Size i = 1; i < count; ++i ) {
+      const auto u = 1.0f - times[ i ] / lifetimes[ i ];
+      EXPECT_FLOAT_EQ( a[ i ] + ( b[ i ] - a[ i ] ) * u, dst[ i ] );
+      EXPECT_FLOAT_EQ( b[ i ] + ( a[ i ] - b[ i ] ) * u, dst2[ i ] );
+   }
+}
+
+TEST( ParticleKernels, euler_lanes_match_interleaved )
+{
+   EulerParticleUpdater interleavedEuler;
+   interleavedEuler.setGlobalAcceleration( Vector3f { 0, -10, 0 } );
+   auto interleaved = test::createParticles( 1000, false, interleavedEuler );
+
+   EulerParticleUpdater lanesEuler;
+   lanesEuler.setGlobalAcceleration( Vector3f { 0, -10, 0 } );
+   auto lanes = test::createParticles( 1000, true, lanesEuler );
+
+   for ( auto i = 0; i < 10; ++i ) {
+      interleavedEuler.update( nullptr, 0.1, crimild::get_ptr( interleaved ) );
+      lanesEuler.update( nullptr, 0.1, crimild::get_ptr( lanes ) );
+   }
+
+   const auto expected = interleaved->getAttrib( ParticleAttrib::POSITION );
+   const auto actual = lanes->getAttrib( ParticleAttrib::POSITION );
+   for ( Size i = 0; i < 1000; ++i ) {
+      const auto p = expected->get< Vector3f >( i );
+      const auto q = actual->get< Vector3f >( i );
+      EXPECT_FLOAT_EQ( p.x, q.x );
+      EXPECT_FLOAT_EQ( p.y, q.y );
+      EXPECT_FLOAT_EQ( p.z, q.z );
+   }
+
+   // x = x0 + t * v0 (no acceleration along x)
+   EXPECT_FLOAT_EQ( 5.0f + 1.0f, actual->get< Vector3f >( 5 ).x );
+}
+
+TEST( ParticleKernels, euler_parallel )
+{
+   const Size count = 4 * particles::PARALLEL_MIN_PARTICLES + 3;
+
+   EulerParticleUpdater serialEuler;
+   auto serial = test::createParticles( count, true, serialEuler );
+   serialEuler.update( nullptr, 0.5, crimild::get_ptr( serial ) );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   EulerParticleUpdater parallelEuler;
+   auto parallel = test::createParticles( count, true, parallelEuler );
+   parallelEuler.update( nullptr, 0.5, crimild::get_ptr( parallel ) );
+
+   tasks.stop();
+
+   const auto expected = serial->getAttrib( ParticleAttrib::POSITION );
+   const auto actual = parallel->getAttrib( ParticleAttrib::POSITION );
+   for ( Size i = 0; i < count; ++i ) {
+      EXPECT_EQ( expected->get< Vector3f >( i ), actual->get< Vector3f >( i ) );
+   }
+}
+
+TEST( ParticleKernels, time_marks_expired_particles )
+{
+   ParticleData particles( 10 );
+   particles.setUseAttribLanes( true );
+
+   TimeParticleUpdater updater;
+   updater.configure( nullptr, &particles );
+   particles.generate();
+
+   // Consecutive particles expire at the same time
+   auto times = particles.getAttrib( ParticleAttrib::TIME );
+   const Real32 values[] = { 1, 0.5f, 0.5f, 2, 0.5f, 0.5f, 3, 1, 0.5f, 0.5f };
+   for ( Size i = 0; i < 10; ++i ) {
+      times->set( i, values[ i ] );
+      particles.wake( i );
+   }
+
+   updater.update( nullptr, 0.75, &particles );
+   EXPECT_EQ( 10, particles.getAliveCount() );
+
+   particles.compact();
+   EXPECT_EQ( 4, particles.getAliveCount() );
+   for ( Size i = 0; i < particles.getAliveCount(); ++i ) {
+      EXPECT_TRUE( particles.isAlive( i ) );
+      EXPECT_LT( 0.0f, times->get< Real32 >( i ) );
+   }
+}
+
+TEST( ParticleKernels, color_lanes )
+{
+   ParticleData particles( 20 );
+   particles.setUseAttribLanes( true );
+
+   ColorParticleUpdater updater;
+   updater.configure( nullptr, &particles );
+   particles.generate();
+
+   auto starts = particles.getAttrib( ParticleAttrib::START_COLOR );
+   auto ends = particles.getAttrib( ParticleAttrib::END_COLOR );
+   auto times = particles.getAttrib( ParticleAttrib::TIME );
+   auto lifetimes = particles.getAttrib( ParticleAttrib::LIFE_TIME );
+   for ( Size i = 0; i < 20; ++i ) {
+      starts->set( i, ColorRGBA { 1, 0, 0, 1 } );
+      ends->set( i, ColorRGBA { 0, 0, 1, 0 } );
+      times->set( i, Real32( i ) );
+      lifetimes->set( i, 20.0f );
+      particles.wake( i );
+   }
+
+   updater.update( nullptr, 0.0, &particles );
+
+   auto colors = particles.getAttrib( ParticleAttrib::COLOR );
+   for ( Size i = 0; i < 20; ++i ) {
+      const auto u = 1.0f - Real32( i ) / 20.0f;
+      const auto c = colors->get< ColorRGBA >( i );
+      EXPECT_FLOAT_EQ( 1.0f - u, c.r );
+      EXPECT_FLOAT_EQ( 0.0f, c.g );
+      EXPECT_FLOAT_EQ( u, c.b );
+      EXPECT_FLOAT_EQ( 1.0f - u, c.a );
+   }
+}
+
+TEST( ParticleKernels, mark_less_equal )
+{
+   const Size count = 150;
+   std::vector< Real32 > values( count );
+   for ( Size i = 0; i < count; ++i ) {
+      values[ i ] = i % 3 == 0 ? -1.0f : 1.0f;
+   }
+
+   std::vector< UInt64 > mask( 3, 0 );
+   particles::markLessEqual( mask.data(), values.data(), 0.0f, 0, 64 );
+   particles::markLessEqual( mask.data(), values.data(), 0.0f, 64, 128 );
+   particles::markLessEqual( mask.data(), values.data(), 0.0f, 128, count - 1 );
+
+   for ( Size i = 0; i < count; ++i ) {
+      const auto marked = ( mask[ i / 64 ] >> ( i % 64 ) ) & 1;
+      EXPECT_EQ( i % 3 == 0 && i < count - 1, marked == 1 );
+   }
+}
+
+TEST( ParticleKernels, radix_sort )
+{
+   const Size count = 5000;
+   std::mt19937 rng( 42 );
+   std::uniform_real_distribution< Real32 > dist( -1000.0f, 1000.0f );
+
+   std::vector< Real32 > keys( count );
+   for ( Size i = 0; i < count; ++i ) {
+      // Include repeated keys, zeros and infinities
+      keys[ i ] = i % 10 == 0 ? 0.0f : ( i % 7 == 0 ? keys[ i / 2 ] : dist( rng ) );
+   }
+   keys[ 1 ] = -std::numeric_limits< Real32 >::infinity();
+   keys[ 2 ] = std::numeric_limits< Real32 >::infinity();
+   keys[ 3 ] = -0.5f;
+   keys[ 4 ] = 0.5f;
+
+   std::vector< UInt32 > expected( count );
+   std::iota( expected.begin(), expected.end(), 0 );
+   std::stable_sort( expected.begin(), expected.end(), [ & ]( auto a, auto b ) { return keys[ a ] < keys[ b ]; } );
+
+   std::vector< UInt32 > indices( count );
+   std::vector< UInt32 > scratch( 3 * count );
+   particles::radixSort( keys.data(), indices.data(), scratch.data(), count );
+   EXPECT_EQ( expected, indices );
+}
+
+TEST( ParticleKernels, radix_sort_same_keys )
+{
+   // Passes are skipped, but indices must still be written
+   const std::vector< Real32 > keys( 10, 3.0f );
+   std::vector< UInt32 > indices( 10, 99 );
+   std::vector< UInt32 > scratch( 30 );
+   particles::radixSort( keys.data(), indices.data(), scratch.data(), keys.size() );
+   for ( Size i = 0; i < indices.size(); ++i ) {
+      EXPECT_EQ( i, indices[ i ] );
+   }
+}
+
+TEST( ParticleKernels, write_indices )
+{
+   const UInt32 order[] = { 2, 0, 1 };
+   const UInt32 pattern[] = { 0, 1, 2, 0, 2, 3 };
+
+   std::vector< UInt32 > indices( 18 );
+   particles::writeIndices( indices.data(), order, 3, pattern, 6, 4 );
+   const std::vector< UInt32 > expected = {
+      8, 9, 10, 8, 10, 11,
+      0, 1, 2, 0, 2, 3,
+      4, 5, 6, 4, 6, 7,
+   };
+   EXPECT_EQ( expected, indices );
+
+   particles::writeIndices( indices.data(), nullptr, 3, pattern, 1, 1 );
+   EXPECT_EQ( 0, indices[ 0 ] );
+   EXPECT_EQ( 1, indices[ 1 ] );
+   EXPECT_EQ( 2, indices[ 2 ] );
+}
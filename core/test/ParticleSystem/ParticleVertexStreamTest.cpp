@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ParticleSystem/ParticleVertexStream.hpp"
+
+#include "ParticleSystem/ParticleData.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static SharedPointer< ParticleData > createStreamedParticles( Size count, Size alive, Bool lanes )
+   {
+      auto particles = crimild::alloc< ParticleData >( count );
+      particles->setUseAttribLanes( lanes );
+      particles->createAttribArray< Vector3f >( ParticleAttrib::POSITION );
+      particles->createAttribArray< Real32 >( ParticleAttrib::UNIFORM_SCALE );
+      particles->generate();
+
+      auto ps = particles->getAttrib( ParticleAttrib::POSITION );
+      auto ss = particles->getAttrib( ParticleAttrib::UNIFORM_SCALE );
+      for ( Size i = 0; i < count; ++i ) {
+         ps->set( i, Vector3f { Real32( i ), 1, -Real32( i ) } );
+         ss->set( i, Real32( i ) );
+      }
+      for ( Size i = 0; i < alive; ++i ) {
+         particles->wake( i );
+      }
+      return particles;
+   }
+
+}
+
+TEST( ParticleVertexStream, aliases_attributes )
+{
+   auto particles = test::createStreamedParticles( 100, 40, false );
+   auto positions = particles->getAttrib( ParticleAttrib::POSITION );
+
+   ParticleVertexStream stream( VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ) );
+   ASSERT_TRUE( stream.update( positions, particles->getParticleCount(), particles->getAliveCount() ) );
+   ASSERT_TRUE( stream.isAliasing() );
+
+   auto bufferView = stream.getVertices()->getBufferView();
+   EXPECT_TRUE( bufferView->getBuffer()->isExternal() );
+   EXPECT_EQ( positions->getRawData(), static_cast< void * >( bufferView->getData() ) );
+   EXPECT_EQ( BufferView::Usage::DYNAMIC, bufferView->getUsage() );
+   EXPECT_EQ( 100 * sizeof( Vector3f ), bufferView->getCapacity() );
+
+   // Only alive particles are exposed
+   EXPECT_EQ( 40 * sizeof( Vector3f ), bufferView->getLength() );
+
+   // Changes in particles are visible without copies
+   positions->set( 5, Vector3f { 1, 2, 3 } );
+   auto accessor = stream.getVertices()->get( VertexAttribute::Name::POSITION );
+   EXPECT_EQ( ( Vector3f { 1, 2, 3 } ), accessor->get< Vector3f >( 5 ) );
+
+   particles->wake( 40 );
+   EXPECT_FALSE( stream.update( positions, particles->getParticleCount(), particles->getAliveCount() ) );
+   EXPECT_EQ( 41 * sizeof( Vector3f ), stream.getVertices()->getBufferView()->getLength() );
+}
+
+TEST( ParticleVertexStream, aliases_single_lanes )
+{
+   auto particles = test::createStreamedParticles( 100, 40, true );
+   auto sizes = particles->getAttrib( ParticleAttrib::UNIFORM_SCALE );
+
+   ParticleVertexStream stream( VertexLayout().withAttribute< Real32 >( VertexAttribute::Name::TEX_COORD ) );
+   stream.update( sizes, particles->getParticleCount(), particles->getAliveCount() );
+
+   ASSERT_TRUE( stream.isAliasing() );
+   EXPECT_EQ( sizes->getRawData(), static_cast< void * >( stream.getVertices()->getBufferView()->getData() ) );
+   EXPECT_EQ( 40 * sizeof( Real32 ), stream.getVertices()->getBufferView()->getLength() );
+}
+
+TEST( ParticleVertexStream, interleaves_lanes )
+{
+   auto particles = test::createStreamedParticles( 100, 40, true );
+   auto positions = particles->getAttrib( ParticleAttrib::POSITION );
+
+   ParticleVertexStream stream( VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ) );
+   ASSERT_TRUE( stream.update( positions, particles->getParticleCount(), particles->getAliveCount() ) );
+
+   ASSERT_FALSE( stream.isAliasing() );
+   EXPECT_EQ( 40 * sizeof( Vector3f ), stream.getVertices()->getBufferView()->getLength() );
+
+   auto accessor = stream.getVertices()->get( VertexAttribute::Name::POSITION );
+   for ( Size i = 0; i < 40; ++i ) {
+      EXPECT_EQ( ( Vector3f { Real32( i ), 1, -Real32( i ) } ), accessor->get< Vector3f >( i ) );
+   }
+
+   positions->set( 5, Vector3f { 1, 2, 3 } );
+   EXPECT_FALSE( stream.update( positions, particles->getParticleCount(), particles->getAliveCount() ) );
+   EXPECT_EQ( ( Vector3f { 1, 2, 3 } ), accessor->get< Vector3f >( 5 ) );
+}
+
+TEST( ParticleVertexStream, missing_attributes )
+{
+   const auto defaultColor = ColorRGBA { 1, 0, 1, 1 };
+   ParticleVertexStream stream( VertexLayout().withAttribute< ColorRGBA >( VertexAttribute::Name::COLOR ), &defaultColor );
+   ASSERT_TRUE( stream.update( nullptr, 100, 40 ) );
+
+   ASSERT_FALSE( stream.isAliasing() );
+   EXPECT_EQ( 40 * sizeof( ColorRGBA ), stream.getVertices()->getBufferView()->getLength() );
+
+   auto accessor = stream.getVertices()->get( VertexAttribute::Name::COLOR );
+   for ( Size i = 0; i < 100; ++i ) {
+      EXPECT_EQ( defaultColor, accessor->get< ColorRGBA >( i ) );
+   }
+}
+
+TEST( ParticleVertexStream, arrays_shorter_than_alive_particles )
+{
+   const auto defaultPosition = Vector3f { 0, 5, 0 };
+   for ( auto lanes : { false, true } ) {
+      auto particles = test::createStreamedParticles( 100, 40, lanes );
+      auto positions = particles->getAttrib( ParticleAttrib::POSITION );
+      positions->reset( 20 );
+      for ( Size i = 0; i < 20; ++i ) {
+         positions->set( i, Vector3f { Real32( i ), 1, -Real32( i ) } );
+      }
+
+      ParticleVertexStream stream( VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ), &defaultPosition );
+      stream.update( positions, particles->getParticleCount(), particles->getAliveCount() );
+
+      ASSERT_FALSE( stream.isAliasing() );
+      EXPECT_EQ( 40 * sizeof( Vector3f ), stream.getVertices()->getBufferView()->getLength() );
+
+      auto accessor = stream.getVertices()->get( VertexAttribute::Name::POSITION );
+      for ( Size i = 0; i < 20; ++i ) {
+         EXPECT_EQ( ( Vector3f { Real32( i ), 1, -Real32( i ) } ), accessor->get< Vector3f >( i ) );
+      }
+      for ( Size i = 20; i < 40; ++i ) {
+         EXPECT_EQ( defaultPosition, accessor->get< Vector3f >( i ) );
+      }
+   }
+}
+
+TEST( ParticleVertexStream, recreated_when_storage_changes )
+{
+   auto particles = test::createStreamedParticles( 100, 40, false );
+   auto positions = particles->getAttrib( ParticleAttrib::POSITION );
+
+   ParticleVertexStream stream( VertexLayout().withAttribute< Vector3f >( VertexAttribute::Name::POSITION ) );
+   stream.update( positions, particles->getParticleCount(), particles->getAliveCount() );
+   auto vertices = stream.getVertices();
+
+   // Growing the array reallocates its storage
+   positions->reset( 200 );
+   EXPECT_TRUE( stream.update( positions, 200, particles->getAliveCount() ) );
+   EXPECT_NE( vertices, stream.getVertices() );
+   EXPECT_EQ( positions->getRawData(), static_cast< void * >( stream.getVertices()->getBufferView()->getData() ) );
+   EXPECT_EQ( 200 * sizeof( Vector3f ), stream.getVertices()->getBufferView()->getCapacity() );
+}
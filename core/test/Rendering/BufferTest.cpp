@@ -27,9 +27,12 @@
 
 #include "Rendering/Buffer.hpp"
 
+#include "crimild/coding/BinaryDecoder.hpp"
+#include "crimild/coding/BinaryEncoder.hpp"
 #include "crimild/coding/MemoryDecoder.hpp"
 #include "crimild/coding/MemoryEncoder.hpp"
 
+#include <filesystem>
 #include <gtest/gtest.h>
 
 using namespace crimild;
@@ -131,3 +134,62 @@ TEST( Buffer, coding )
    EXPECT_EQ( buffer->getSize(), decoded->getSize() );
    EXPECT_EQ( 0, memcmp( buffer->getData(), decoded->getData(), decoded->getSize() ) );
 }
+
+TEST( Buffer, constructionWithExternalData )
+{
+   crimild::Real32 data[] = { 1.0f, 2.0f, 3.0f };
+
+   auto buffer = crimild::alloc< Buffer >( reinterpret_cast< crimild::Byte * >( data ), sizeof( data ) );
+
+   ASSERT_TRUE( buffer->isExternal() );
+   ASSERT_EQ( 3 * sizeof( crimild::Real32 ), buffer->getSize() );
+   ASSERT_EQ( reinterpret_cast< crimild::Byte * >( data ), buffer->getData() );
+
+   // Changes are visible without copying
+   data[ 1 ] = 5.0f;
+   EXPECT_EQ( 5.0f, reinterpret_cast< crimild::Real32 * >( buffer->getData() )[ 1 ] );
+}
+
+TEST( Buffer, codingWithExternalData )
+{
+   crimild::Real32 data[] = { 1.0f, 2.0f, 3.0f };
+
+   auto buffer = crimild::alloc< Buffer >( reinterpret_cast< crimild::Byte * >( data ), sizeof( data ) );
+   coding::MemoryEncoder encoder;
+   ASSERT_TRUE( encoder.encode( buffer ) );
+   const auto bytes = encoder.getBytes();
+
+   coding::MemoryDecoder decoder;
+   ASSERT_TRUE( decoder.fromBytes( bytes ) );
+   auto decoded = decoder.getObjectAt< Buffer >( 0 );
+
+   EXPECT_FALSE( decoded->isExternal() );
+   EXPECT_EQ( buffer->getSize(), decoded->getSize() );
+   EXPECT_EQ( 0, memcmp( data, decoded->getData(), decoded->getSize() ) );
+}
+
+TEST( Buffer, codingInPlace )
+{
+   const auto path = std::filesystem::temp_directory_path() / "crimild_buffer_coding_in_place.crimild";
+
+   auto buffer = crimild::alloc< Buffer >( Array< crimild::Real32 > { 1.0f, 2.0f, 3.0f } );
+   coding::BinaryEncoder encoder;
+   ASSERT_TRUE( encoder.encode( buffer ) );
+   ASSERT_TRUE( encoder.write( path ) );
+
+   SharedPointer< Buffer > decoded;
+   {
+      coding::BinaryDecoder decoder;
+      ASSERT_TRUE( decoder.read( path ) );
+      decoded = decoder.getObjectAt< Buffer >( 0 );
+   }
+
+   // Data references the mapped file, which outlives the decoder
+   ASSERT_NE( nullptr, decoded );
+   EXPECT_TRUE( decoded->isExternal() );
+   EXPECT_EQ( buffer->getSize(), decoded->getSize() );
+   EXPECT_EQ( 0, memcmp( buffer->getData(), decoded->getData(), decoded->getSize() ) );
+
+   decoded = nullptr;
+   std::filesystem::remove( path );
+}
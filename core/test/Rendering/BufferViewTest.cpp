@@ -160,6 +160,7 @@ TEST( BufferView, constructionWithOffsetAndLength )
    ASSERT_EQ( 12, bufferView->getLength() );
    ASSERT_EQ( sizeof( crimild::Byte ), bufferView->getStride() );
    ASSERT_EQ( 12, bufferView->getCount() );
+   ASSERT_EQ( 24, bufferView->getCapacity() );
 
    ASSERT_NE( nullptr, bufferView->getData() );
    ASSERT_EQ( static_cast< crimild::Byte * >( buffer->getData() ) + 12, bufferView->getData() );
@@ -27,6 +27,7 @@
 
 #include "SceneGraph/Camera.hpp"
 
+#include "Boundings/AABBBoundingVolume.hpp"
 #include "SceneGraph/Group.hpp"
 #include "Visitors/FetchCameras.hpp"
 #include "Visitors/SelectNodes.hpp"
@@ -228,6 +229,38 @@ TEST( Camera, fetchCameras )
    EXPECT_EQ( 1, i );
 }
 
+TEST( Camera, culling )
+{
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+
+   const auto culled = [ & ]( const Point3f &center ) {
+      AABBBoundingVolume bound;
+      bound.computeFrom( center - Vector3 { 1, 1, 1 }, center + Vector3 { 1, 1, 1 } );
+      return camera->culled( &bound );
+   };
+
+   camera->computeCullingPlanes();
+
+   EXPECT_FALSE( culled( Point3f { 0, 0, -10 } ) );
+   EXPECT_FALSE( culled( Point3f { 0, 0, 0 } ) );
+   EXPECT_FALSE( culled( Point3f { 9, 0, -10 } ) );
+   EXPECT_TRUE( culled( Point3f { 0, 0, 10 } ) );
+   EXPECT_TRUE( culled( Point3f { 0, 0, -200 } ) );
+   EXPECT_TRUE( culled( Point3f { -20, 0, -10 } ) );
+   EXPECT_TRUE( culled( Point3f { 0, 20, -10 } ) );
+
+   // Planes follow the camera
+   camera->setLocal( rotationY( numbers::PI ) );
+   camera->perform( UpdateWorldState() );
+   camera->computeCullingPlanes();
+
+   EXPECT_TRUE( culled( Point3f { 0, 0, -10 } ) );
+   EXPECT_FALSE( culled( Point3f { 0, 0, 10 } ) );
+
+   camera->setCullingEnabled( false );
+   EXPECT_FALSE( culled( Point3f { 0, 0, -10 } ) );
+}
+
 TEST( Camera, coding )
 {
    auto encoder = crimild::alloc< coding::MemoryEncoder >();
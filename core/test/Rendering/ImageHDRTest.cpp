@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/ImageHDR.hpp"
+
+#include "Rendering/Buffer.hpp"
+#include "Rendering/BufferView.hpp"
+#include "Rendering/Image.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <vector>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static SharedPointer< Image > createImage( UInt32 width, UInt32 height )
+   {
+      auto data = Array< ColorRGBA >( width * height );
+      for ( UInt32 y = 0; y < height; ++y ) {
+         for ( UInt32 x = 0; x < width; ++x ) {
+            data[ y * width + x ] = ColorRGBA { Real( x ), Real( y ), 0.5f, 1.0f };
+         }
+      }
+
+      auto image = crimild::alloc< Image >();
+      image->extent = Extent3D {
+         .width = Real32( width ),
+         .height = Real32( height ),
+      };
+      image->format = Format::R32G32B32A32_SFLOAT;
+      image->setBufferView( crimild::alloc< BufferView >( BufferView::Target::IMAGE, crimild::alloc< Buffer >( data ), 0, sizeof( ColorRGBA ) ) );
+      return image;
+   }
+
+   static std::vector< char > readFile( const std::filesystem::path &path )
+   {
+      std::ifstream in( path, std::ios::binary );
+      return std::vector< char >( std::istreambuf_iterator< char >( in ), std::istreambuf_iterator< char >() );
+   }
+
+   static Real32 readFloat( const std::vector< char > &bytes, Size offset )
+   {
+      Real32 ret;
+      std::memcpy( &ret, bytes.data() + offset, sizeof( Real32 ) );
+      return ret;
+   }
+
+}
+
+TEST( ImageHDR, write_pfm )
+{
+   const auto path = std::filesystem::temp_directory_path() / "crimild_image_hdr_test.pfm";
+   auto image = test::createImage( 3, 2 );
+
+   ASSERT_TRUE( utils::writePFM( crimild::get_ptr( image ), path ) );
+
+   const auto bytes = test::readFile( path );
+   const auto header = std::string( "PF\n3 2\n-1.0\n" );
+   ASSERT_EQ( header.size() + 3 * 2 * 3 * sizeof( Real32 ), bytes.size() );
+   EXPECT_EQ( header, std::string( bytes.begin(), bytes.begin() + header.size() ) );
+
+   // Rows are stored from bottom to top, so the first pixel is (0, 1)
+   EXPECT_EQ( 0.0f, test::readFloat( bytes, header.size() ) );
+   EXPECT_EQ( 1.0f, test::readFloat( bytes, header.size() + 4 ) );
+   EXPECT_EQ( 0.5f, test::readFloat( bytes, header.size() + 8 ) );
+
+   // Last pixel is (2, 0)
+   EXPECT_EQ( 2.0f, test::readFloat( bytes, bytes.size() - 12 ) );
+   EXPECT_EQ( 0.0f, test::readFloat( bytes, bytes.size() - 8 ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( ImageHDR, write_exr )
+{
+   const auto path = std::filesystem::temp_directory_path() / "crimild_image_hdr_test.exr";
+   auto image = test::createImage( 3, 2 );
+
+   ASSERT_TRUE( utils::writeHDR( crimild::get_ptr( image ), path ) );
+
+   const auto bytes = test::readFile( path );
+   ASSERT_LT( 8, bytes.size() );
+   EXPECT_EQ( 0x76, UInt8( bytes[ 0 ] ) );
+   EXPECT_EQ( 0x2f, UInt8( bytes[ 1 ] ) );
+   EXPECT_EQ( 0x31, UInt8( bytes[ 2 ] ) );
+   EXPECT_EQ( 0x01, UInt8( bytes[ 3 ] ) );
+
+   // Last scanline (y = 1) ends with the R channel
+   EXPECT_EQ( 2.0f, test::readFloat( bytes, bytes.size() - 4 ) );
+   EXPECT_EQ( 0.0f, test::readFloat( bytes, bytes.size() - 12 ) );
+
+   // G channel, right before R
+   EXPECT_EQ( 1.0f, test::readFloat( bytes, bytes.size() - 16 ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( ImageHDR, unsupported_format )
+{
+   auto image = test::createImage( 2, 2 );
+   image->format = Format::R8G8B8A8_UNORM;
+
+   EXPECT_FALSE( utils::writePFM( crimild::get_ptr( image ), std::filesystem::temp_directory_path() / "crimild_image_hdr_test_invalid.pfm" ) );
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/RTRandom.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace crimild;
+
+TEST( RTRandom, same_seed_same_sequence )
+{
+   RTRandom a( 42 );
+   RTRandom b( 42 );
+   for ( auto i = 0; i < 100; ++i ) {
+      EXPECT_EQ( a.nextUInt32(), b.nextUInt32() );
+   }
+}
+
+TEST( RTRandom, different_streams )
+{
+   RTRandom a( 42, 0 );
+   RTRandom b( 42, 1 );
+   auto equal = 0;
+   for ( auto i = 0; i < 100; ++i ) {
+      equal += a.nextUInt32() == b.nextUInt32() ? 1 : 0;
+   }
+   EXPECT_GT( 5, equal );
+}
+
+TEST( RTRandom, pixel_samples )
+{
+   RTRandom a;
+   RTRandom b;
+
+   a.seed( 0, 10, 3, 1 );
+   b.seed( 0, 10, 3, 1 );
+   EXPECT_EQ( a.next(), b.next() );
+
+   // Changing any of the inputs produces a different sequence
+   b.seed( 0, 11, 3, 1 );
+   EXPECT_NE( a.next(), b.next() );
+   b.seed( 0, 10, 4, 1 );
+   EXPECT_NE( a.next(), b.next() );
+   b.seed( 0, 10, 3, 2 );
+   EXPECT_NE( a.next(), b.next() );
+   b.seed( 1, 10, 3, 1 );
+   EXPECT_NE( a.next(), b.next() );
+}
+
+TEST( RTRandom, range )
+{
+   RTRandom rnd( 1982 );
+   Real sum = 0;
+   for ( auto i = 0; i < 10000; ++i ) {
+      const auto x = rnd.next();
+      EXPECT_LE( 0, x );
+      EXPECT_GT( 1, x );
+      sum += x;
+   }
+   EXPECT_NEAR( 0.5, sum / 10000, 0.02 );
+
+   for ( auto i = 0; i < 1000; ++i ) {
+      const auto v = rnd.nextInUnitSphere();
+      EXPECT_GT( 1, v.x * v.x + v.y * v.y + v.z * v.z );
+   }
+}
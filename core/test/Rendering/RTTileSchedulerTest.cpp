@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/RTTileScheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace crimild;
+
+TEST( RTTileScheduler, tiles_cover_image )
+{
+   RTTileScheduler scheduler( 100, 50, 32 );
+
+   ASSERT_EQ( 8, scheduler.getTileCount() );
+
+   Int32 area = 0;
+   for ( const auto &tile : scheduler.getTiles() ) {
+      EXPECT_LT( 0, tile.width );
+      EXPECT_LT( 0, tile.height );
+      EXPECT_LE( tile.x + tile.width, 100 );
+      EXPECT_LE( tile.y + tile.height, 50 );
+      area += tile.width * tile.height;
+   }
+   EXPECT_EQ( 100 * 50, area );
+}
+
+TEST( RTTileScheduler, spiral_starts_at_center )
+{
+   RTTileScheduler scheduler( 5 * 16, 5 * 16, 16, RTTileScheduler::Order::SPIRAL );
+
+   ASSERT_EQ( 25, scheduler.getTileCount() );
+
+   const auto &first = scheduler.getTiles().front();
+   EXPECT_EQ( 32, first.x );
+   EXPECT_EQ( 32, first.y );
+
+   // Next ring
+   for ( auto i = 1; i < 9; ++i ) {
+      const auto &tile = scheduler.getTiles()[ i ];
+      EXPECT_LE( 16, tile.x );
+      EXPECT_GE( 48, tile.x );
+      EXPECT_LE( 16, tile.y );
+      EXPECT_GE( 48, tile.y );
+   }
+}
+
+TEST( RTTileScheduler, skips_converged_tiles )
+{
+   RTTileScheduler scheduler( 64, 64, 16 );
+
+   std::vector< UInt32 > rendered( scheduler.getTileCount(), 0 );
+   RTTileScheduler::Tile tile;
+   while ( scheduler.next( tile ) ) {
+      ++rendered[ tile.index ];
+
+      // Even tiles converge right away. Odd ones after a few passes.
+      scheduler.release( tile, tile.index % 2 == 0 || rendered[ tile.index ] == 3 );
+   }
+
+   EXPECT_TRUE( scheduler.isDone() );
+   EXPECT_EQ( scheduler.getTileCount(), scheduler.getConvergedTileCount() );
+   for ( size_t i = 0; i < rendered.size(); ++i ) {
+      EXPECT_EQ( i % 2 == 0 ? 1 : 3, rendered[ i ] );
+   }
+}
+
+TEST( RTTileScheduler, tiles_are_never_shared )
+{
+   // More workers than tiles
+   RTTileScheduler scheduler( 32, 32, 16 );
+
+   std::vector< std::atomic< Int32 > > owners( scheduler.getTileCount() );
+   std::vector< std::atomic< Int32 > > passes( scheduler.getTileCount() );
+   std::atomic< Bool > shared = false;
+
+   std::vector< std::thread > workers;
+   for ( auto i = 0; i < 8; ++i ) {
+      workers.push_back(
+         std::thread(
+            [ & ] {
+               RTTileScheduler::Tile tile;
+               while ( scheduler.next( tile ) ) {
+                  if ( owners[ tile.index ]++ != 0 ) {
+                     shared = true;
+                  }
+                  std::this_thread::yield();
+                  --owners[ tile.index ];
+                  scheduler.release( tile, ++passes[ tile.index ] >= 100 );
+               }
+            }
+         )
+      );
+   }
+
+   for ( auto &worker : workers ) {
+      worker.join();
+   }
+
+   EXPECT_FALSE( shared );
+   EXPECT_TRUE( scheduler.isDone() );
+   EXPECT_EQ( 4 * 100, scheduler.getRenderedTileCount() );
+}
+
+TEST( RTTileScheduler, pause_resume_and_cancel )
+{
+   RTTileScheduler scheduler( 64, 64, 16 );
+
+   std::atomic< UInt32 > count = 0;
+   scheduler.pause();
+
+   auto worker = std::thread(
+      [ & ] {
+         RTTileScheduler::Tile tile;
+         while ( scheduler.next( tile ) ) {
+            ++count;
+            scheduler.release( tile, false );
+         }
+      }
+   );
+
+   std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+   EXPECT_EQ( 0, count );
+
+   scheduler.resume();
+   while ( count < 100 ) {
+      std::this_thread::yield();
+   }
+
+   scheduler.pause();
+   scheduler.cancel();
+   worker.join();
+
+   EXPECT_TRUE( scheduler.isCancelled() );
+   EXPECT_FALSE( scheduler.isDone() );
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Rendering/RenderableExtractor.hpp"
+
+#include "Components/MaterialComponent.hpp"
+#include "Concurrency/TaskSystem.hpp"
+#include "Rendering/DescriptorSet.hpp"
+#include "Rendering/Material.hpp"
+#include "Rendering/Pipeline.hpp"
+#include "Rendering/RenderableSet.hpp"
+#include "Rendering/ShaderProgram.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <crimild/math/translation.hpp>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static SharedPointer< Material > createUnlitMaterial( void )
+   {
+      auto pipeline = crimild::alloc< GraphicsPipeline >();
+      pipeline->setProgram( crimild::alloc< ShaderProgram >() );
+      auto material = crimild::alloc< Material >();
+      material->setGraphicsPipeline( pipeline );
+      return material;
+   }
+
+   static SharedPointer< Material > createLitMaterial( void )
+   {
+      auto layout = crimild::alloc< DescriptorSetLayout >();
+      layout->bindings.add(
+         {
+            .descriptorType = DescriptorType::ALBEDO_MAP,
+            .stage = Shader::Stage::FRAGMENT,
+         }
+      );
+      auto program = crimild::alloc< ShaderProgram >();
+      program->descriptorSetLayouts.add( layout );
+      auto pipeline = crimild::alloc< GraphicsPipeline >();
+      pipeline->setProgram( program );
+      auto material = crimild::alloc< Material >();
+      material->setGraphicsPipeline( pipeline );
+      return material;
+   }
+
+   static SharedPointer< Group > createGroup( SharedPointer< Material > const &material, Real z, Size count )
+   {
+      auto group = crimild::alloc< Group >();
+      group->setLocal( translation( 0, 0, z ) );
+      for ( Size i = 0; i < count; ++i ) {
+         auto geometry = crimild::alloc< Geometry >();
+         geometry->attachComponent< MaterialComponent >( material );
+         group->attachNode( geometry );
+      }
+      return group;
+   }
+
+   static std::vector< Geometry * > collect( RenderableSet &renderables )
+   {
+      std::vector< Geometry * > ret;
+      renderables.eachGeometry( [ & ]( Geometry *geometry ) { ret.push_back( geometry ); } );
+      return ret;
+   }
+
+}
+
+TEST( RenderableExtractor, classification_cache )
+{
+   RenderableClassificationCache cache;
+
+   auto material = test::createUnlitMaterial();
+
+   EXPECT_EQ( FrameSnapshot::Classification::NONE, cache.classify( Node::Layer::DEFAULT, nullptr ) );
+   EXPECT_EQ( FrameSnapshot::Classification::ENVIRONMENT, cache.classify( Node::Layer::SKYBOX, nullptr ) );
+   EXPECT_EQ( FrameSnapshot::Classification::UNLIT, cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( material ) ) );
+   EXPECT_EQ( FrameSnapshot::Classification::UNLIT, cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( material ) ) );
+   EXPECT_EQ( 1, cache.size() );
+
+   // Changing the pipeline invalidates the cached entry
+   material->setGraphicsPipeline( crimild::alloc< GraphicsPipeline >() );
+   EXPECT_EQ( FrameSnapshot::Classification::NONE, cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( material ) ) );
+   EXPECT_EQ( 1, cache.size() );
+
+   cache.clear();
+   EXPECT_EQ( 0, cache.size() );
+}
+
+TEST( RenderableExtractor, classification_cache_evicts_expired )
+{
+   RenderableClassificationCache cache;
+
+   auto material = test::createUnlitMaterial();
+   auto other = test::createUnlitMaterial();
+   cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( material ) );
+   cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( other ) );
+   EXPECT_EQ( 2, cache.size() );
+
+   cache.evictExpired();
+   EXPECT_EQ( 2, cache.size() );
+
+   material = nullptr;
+   cache.evictExpired();
+   EXPECT_EQ( 1, cache.size() );
+
+   // New materials never match entries for destroyed ones, even if they are
+   // allocated at the same address
+   other = nullptr;
+   auto lit = test::createLitMaterial();
+   EXPECT_EQ( FrameSnapshot::Classification::LIT, cache.classify( Node::Layer::DEFAULT, crimild::get_ptr( lit ) ) );
+}
+
+TEST( RenderableExtractor, without_camera )
+{
+   auto material = test::createUnlitMaterial();
+
+   auto scene = crimild::alloc< Group >();
+   scene->attachNode( test::createGroup( material, -10, 3 ) );
+   scene->attachNode( test::createGroup( material, 10, 3 ) );
+   scene->perform( UpdateWorldState() );
+
+   RenderableSet lit, unlit, env;
+   RenderableExtractor extractor;
+   extractor.extract( crimild::get_ptr( scene ), nullptr, &lit, &unlit, &env );
+
+   EXPECT_FALSE( lit.hasGeometries() );
+   EXPECT_FALSE( env.hasGeometries() );
+   EXPECT_EQ( 6, test::collect( unlit ).size() );
+   EXPECT_EQ( 9, extractor.getStats().visited );
+   EXPECT_EQ( 0, extractor.getStats().culled );
+   EXPECT_EQ( 6, extractor.getStats().emitted );
+}
+
+TEST( RenderableExtractor, culls_subtrees )
+{
+   auto material = test::createUnlitMaterial();
+
+   auto scene = crimild::alloc< Group >();
+   auto visible = test::createGroup( material, -10, 3 );
+   scene->attachNode( visible );
+   auto hidden = test::createGroup( material, 10, 3 );
+   scene->attachNode( hidden );
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   {
+      RenderableSet lit, unlit, env;
+      RenderableExtractor extractor;
+      extractor.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &lit, &unlit, &env );
+
+      EXPECT_EQ( 3, test::collect( unlit ).size() );
+      unlit.eachGeometry( [ & ]( Geometry *geometry ) { EXPECT_EQ( visible.get(), geometry->getParent() ); } );
+
+      // Children of the culled group are never visited
+      EXPECT_EQ( 7, extractor.getStats().visited );
+      EXPECT_EQ( 1, extractor.getStats().culled );
+      EXPECT_EQ( 3, extractor.getStats().emitted );
+   }
+
+   {
+      hidden->setCullMode( Node::CullMode::NEVER );
+
+      RenderableSet lit, unlit, env;
+      RenderableExtractor extractor;
+      extractor.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &lit, &unlit, &env );
+
+      // Geometries are still culled individually
+      EXPECT_EQ( 3, test::collect( unlit ).size() );
+      EXPECT_EQ( 10, extractor.getStats().visited );
+      EXPECT_EQ( 3, extractor.getStats().culled );
+   }
+}
+
+TEST( RenderableExtractor, shadow_casters )
+{
+   auto material = test::createLitMaterial();
+
+   auto scene = crimild::alloc< Group >();
+   auto visible = test::createGroup( material, -10, 3 );
+   scene->attachNode( visible );
+   auto hidden = test::createGroup( material, 10, 3 );
+   scene->attachNode( hidden );
+   auto disabled = test::createGroup( material, -10, 3 );
+   disabled->setCullMode( Node::CullMode::ALWAYS );
+   scene->attachNode( disabled );
+   scene->attachNode( test::createGroup( test::createUnlitMaterial(), 10, 3 ) );
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   RenderableSet lit, unlit, env, casters;
+   RenderableExtractor extractor;
+   extractor.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &lit, &unlit, &env, &casters );
+
+   // Geometries outside the frustum still cast shadows
+   EXPECT_EQ( 3, test::collect( lit ).size() );
+   EXPECT_EQ( 6, test::collect( casters ).size() );
+   casters.eachGeometry( [ & ]( Geometry *geometry ) { EXPECT_NE( disabled.get(), geometry->getParent() ); } );
+
+   // Collecting casters does not change stats
+   EXPECT_EQ( 9, extractor.getStats().visited );
+   EXPECT_EQ( 3, extractor.getStats().culled );
+   EXPECT_EQ( 3, extractor.getStats().emitted );
+}
+
+TEST( RenderableExtractor, skybox_is_never_culled )
+{
+   auto skybox = crimild::alloc< Geometry >();
+   skybox->setLayer( Node::Layer::SKYBOX );
+   skybox->setLocal( translation( 0, 0, 10 ) );
+
+   auto scene = crimild::alloc< Group >();
+   scene->attachNode( skybox );
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   // The scene's bound might be visible, but the skybox's is not
+   RenderableSet lit, unlit, env;
+   RenderableExtractor extractor;
+   extractor.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &lit, &unlit, &env );
+
+   EXPECT_EQ( 1, test::collect( env ).size() );
+   EXPECT_FALSE( unlit.hasGeometries() );
+}
+
+TEST( RenderableExtractor, parallel_matches_serial )
+{
+   auto material = test::createLitMaterial();
+
+   auto scene = crimild::alloc< Group >();
+   for ( int i = 0; i < 64; ++i ) {
+      // Every other group is behind the camera
+      scene->attachNode( test::createGroup( material, i % 2 == 0 ? -10 : 10, 16 ) );
+   }
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   RenderableSet expected, expectedCasters, unused;
+   RenderableExtractor serial;
+   serial.setParallelEnabled( false );
+   serial.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &expected, &unused, &unused, &expectedCasters );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   RenderableSet actual, actualCasters;
+   RenderableExtractor parallel;
+   for ( int frame = 0; frame < 3; ++frame ) {
+      actual.reset();
+      actualCasters.reset();
+      parallel.extract( crimild::get_ptr( scene ), crimild::get_ptr( camera ), &actual, &unused, &unused, &actualCasters );
+   }
+
+   tasks.stop();
+
+   EXPECT_EQ( 32 * 16, test::collect( expected ).size() );
+   EXPECT_EQ( 64 * 16, test::collect( expectedCasters ).size() );
+   EXPECT_EQ( test::collect( expected ), test::collect( actual ) );
+   EXPECT_EQ( test::collect( expectedCasters ), test::collect( actualCasters ) );
+   EXPECT_EQ( serial.getStats().visited, parallel.getStats().visited );
+   EXPECT_EQ( serial.getStats().culled, parallel.getStats().culled );
+   EXPECT_EQ( serial.getStats().emitted, parallel.getStats().emitted );
+}
@@ -29,6 +29,7 @@
 
 #include "Components/RotationComponent.hpp"
 #include "SceneGraph/Group.hpp"
+#include "SceneGraph/Switch.hpp"
 #include "Utils/MockComponent.hpp"
 #include "crimild/coding/MemoryDecoder.hpp"
 #include "crimild/coding/MemoryEncoder.hpp"
@@ -272,6 +273,137 @@ TEST( NodeTest, getRootParent )
    EXPECT_EQ( crimild::get_ptr( g1 ), g3->getRootParent() );
 }
 
+TEST( NodeTest, getRoot )
+{
+   auto g1 = crimild::alloc< Group >();
+   auto g2 = crimild::alloc< Group >();
+   auto g3 = crimild::alloc< Group >();
+   auto n = crimild::alloc< Node >();
+
+   g2->attachNode( g3 );
+   g3->attachNode( n );
+   n->setEnabled( false );
+
+   EXPECT_EQ( crimild::get_ptr( g1 ), g1->getRoot() );
+   EXPECT_EQ( crimild::get_ptr( g2 ), n->getRoot() );
+
+   // Attaching a subtree updates all of its nodes, even disabled ones
+   g1->attachNode( g2 );
+   EXPECT_EQ( crimild::get_ptr( g1 ), g2->getRoot() );
+   EXPECT_EQ( crimild::get_ptr( g1 ), g3->getRoot() );
+   EXPECT_EQ( crimild::get_ptr( g1 ), n->getRoot() );
+
+   g2->detachNode( g3 );
+   EXPECT_EQ( crimild::get_ptr( g1 ), g2->getRoot() );
+   EXPECT_EQ( crimild::get_ptr( g3 ), g3->getRoot() );
+   EXPECT_EQ( crimild::get_ptr( g3 ), n->getRoot() );
+   EXPECT_EQ( nullptr, g3->getRootParent() );
+}
+
+TEST( NodeTest, isInHierarchy )
+{
+   auto g1 = crimild::alloc< Group >();
+   auto g2 = crimild::alloc< Group >();
+   auto n1 = crimild::alloc< Node >();
+   auto n2 = crimild::alloc< Node >();
+
+   g1->attachNode( g2 );
+   g2->attachNode( n1 );
+   g1->attachNode( n2 );
+
+   EXPECT_TRUE( n1->isInHierarchy( crimild::get_ptr( g1 ) ) );
+   EXPECT_TRUE( n1->isInHierarchy( crimild::get_ptr( g2 ) ) );
+   EXPECT_TRUE( n1->isInHierarchy( crimild::get_ptr( n1 ) ) );
+   EXPECT_FALSE( n2->isInHierarchy( crimild::get_ptr( g2 ) ) );
+   EXPECT_FALSE( g1->isInHierarchy( crimild::get_ptr( g2 ) ) );
+   EXPECT_FALSE( n1->isInHierarchy( nullptr ) );
+
+   auto other = crimild::alloc< Group >();
+   EXPECT_FALSE( n1->isInHierarchy( crimild::get_ptr( other ) ) );
+}
+
+TEST( NodeTest, getDepth )
+{
+   auto g1 = crimild::alloc< Group >();
+   auto g2 = crimild::alloc< Group >();
+   auto n = crimild::alloc< Node >();
+
+   g2->attachNode( n );
+   EXPECT_EQ( 1, n->getDepth() );
+
+   g1->attachNode( g2 );
+   EXPECT_EQ( 0, g1->getDepth() );
+   EXPECT_EQ( 1, g2->getDepth() );
+   EXPECT_EQ( 2, n->getDepth() );
+
+   g1->detachNode( g2 );
+   EXPECT_EQ( 0, g2->getDepth() );
+   EXPECT_EQ( 1, n->getDepth() );
+}
+
+TEST( NodeTest, isActiveInHierarchy )
+{
+   auto g1 = crimild::alloc< Group >();
+   auto g2 = crimild::alloc< Group >();
+   auto n = crimild::alloc< Node >();
+
+   g1->attachNode( g2 );
+   g2->attachNode( n );
+   EXPECT_TRUE( n->isActiveInHierarchy() );
+
+   g1->setEnabled( false );
+   EXPECT_FALSE( g1->isActiveInHierarchy() );
+   EXPECT_FALSE( g2->isActiveInHierarchy() );
+   EXPECT_FALSE( n->isActiveInHierarchy() );
+
+   // Disabled nodes stay inactive when ancestors are enabled again
+   n->setEnabled( false );
+   g1->setEnabled( true );
+   EXPECT_TRUE( g2->isActiveInHierarchy() );
+   EXPECT_FALSE( n->isActiveInHierarchy() );
+
+   // Moving to another hierarchy takes the new ancestors into account
+   n->setEnabled( true );
+   g2->detachNode( n );
+   auto disabled = crimild::alloc< Group >();
+   disabled->setEnabled( false );
+   disabled->attachNode( n );
+   EXPECT_FALSE( n->isActiveInHierarchy() );
+   disabled->detachNode( n );
+   EXPECT_TRUE( n->isActiveInHierarchy() );
+}
+
+TEST( NodeTest, isActiveInHierarchyWithSwitch )
+{
+   auto s = crimild::alloc< Switch >();
+   auto a = crimild::alloc< Group >();
+   auto b = crimild::alloc< Node >();
+   auto c = crimild::alloc< Node >();
+
+   s->attachNode( a );
+   s->attachNode( b );
+   a->attachNode( c );
+   EXPECT_TRUE( a->isActiveInHierarchy() );
+   EXPECT_TRUE( c->isActiveInHierarchy() );
+   EXPECT_FALSE( b->isActiveInHierarchy() );
+
+   s->selectNextNode();
+   EXPECT_FALSE( a->isActiveInHierarchy() );
+   EXPECT_FALSE( c->isActiveInHierarchy() );
+   EXPECT_TRUE( b->isActiveInHierarchy() );
+
+   // Inserting before the current node changes the selection
+   auto d = crimild::alloc< Node >();
+   s->attachNodeBefore( d, a );
+   EXPECT_TRUE( a->isActiveInHierarchy() );
+   EXPECT_FALSE( b->isActiveInHierarchy() );
+   EXPECT_FALSE( d->isActiveInHierarchy() );
+
+   s->setCurrentNodeIndex( 0 );
+   EXPECT_TRUE( d->isActiveInHierarchy() );
+   EXPECT_FALSE( a->isActiveInHierarchy() );
+}
+
 TEST( NodeTest, coding )
 {
    auto n1 = crimild::alloc< Node >( "Some node" );
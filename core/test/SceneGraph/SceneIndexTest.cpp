@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SceneGraph/SceneIndex.hpp"
+
+#include "Components/MaterialComponent.hpp"
+#include "Primitives/Primitive.hpp"
+#include "Rendering/Material.hpp"
+#include "SceneGraph/Camera.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/IntersectWorld.hpp"
+#include "Visitors/Picking.hpp"
+#include "Visitors/UpdateWorldState.hpp"
+
+#include <algorithm>
+#include <crimild/math/Random.hpp>
+#include <crimild/math/intersect.hpp>
+#include <crimild/math/isEqual.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/overlaps.hpp>
+#include <crimild/math/rotation.hpp>
+#include <crimild/math/translation.hpp>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static SharedPointer< Geometry > createSphere( const Transformation &local )
+   {
+      auto geometry = crimild::alloc< Geometry >();
+      geometry->attachPrimitive( crimild::alloc< Primitive >( Primitive::Type::SPHERE ) );
+      geometry->attachComponent< MaterialComponent >( crimild::alloc< Material >() );
+      geometry->setLocal( local );
+      return geometry;
+   }
+
+   /**
+      \brief A grid of spheres in the XZ plane, spaced 4 units apart
+    */
+   static SharedPointer< Group > createGrid( int size )
+   {
+      auto scene = crimild::alloc< Group >();
+      for ( int i = 0; i < size; ++i ) {
+         auto row = crimild::alloc< Group >();
+         for ( int j = 0; j < size; ++j ) {
+            row->attachNode( createSphere( translation( 4 * i, 0, -4 * j ) ) );
+         }
+         scene->attachNode( row );
+      }
+      scene->perform( UpdateWorldState() );
+      return scene;
+   }
+
+   static std::vector< SceneIndex::Index > sorted( std::vector< SceneIndex::Index > items )
+   {
+      std::sort( items.begin(), items.end() );
+      return items;
+   }
+
+}
+
+TEST( SceneIndex, build )
+{
+   auto scene = test::createGrid( 10 );
+
+   auto disabled = test::createSphere( translation( 0, 10, 0 ) );
+   disabled->setEnabled( false );
+   scene->attachNode( disabled );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   EXPECT_EQ( crimild::get_ptr( scene ), index.getScene() );
+   EXPECT_TRUE( index.isCurrent() );
+   EXPECT_EQ( 100, index.getItemCount() );
+   EXPECT_GT( index.getNodeCount(), 1 );
+   EXPECT_EQ( 1, index.getStats().builds );
+
+   // Items are stored in traversal order
+   auto first = static_cast< Group * >( scene->getNodeAt( 0 ) )->getNodeAt( 0 );
+   EXPECT_EQ( first, index.getItem( 0 ) );
+}
+
+TEST( SceneIndex, query_bounds )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   const auto B = Bounds3 { Point3 { -1, -1, -13 }, Point3 { 9, 1, -3 } };
+
+   std::vector< SceneIndex::Index > expected;
+   for ( SceneIndex::Index i = 0; i < index.getItemCount(); ++i ) {
+      if ( overlaps( index.getItemBounds( i ), B ) ) {
+         expected.push_back( i );
+      }
+   }
+
+   std::vector< SceneIndex::Index > results;
+   index.queryBounds( B, results );
+
+   EXPECT_EQ( 3 * 3, expected.size() );
+   EXPECT_EQ( expected, test::sorted( results ) );
+}
+
+TEST( SceneIndex, query_sphere )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   std::vector< SceneIndex::Index > results;
+   index.querySphere( Sphere { Point3 { 8, 0, -8 }, 2 }, results );
+
+   ASSERT_EQ( 1, results.size() );
+   EXPECT_EQ( ( Point3f { 8, 0, -8 } ), index.getItem( results[ 0 ] )->getWorldBound()->getCenter() );
+}
+
+TEST( SceneIndex, query_ray )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   std::vector< SceneIndex::Index > results;
+   index.queryRay( Ray3 { Point3 { -10, 0, -8 }, Vector3 { 1, 0, 0 } }, numbers::POSITIVE_INFINITY, results );
+   EXPECT_EQ( 10, results.size() );
+
+   results.clear();
+   index.queryRay( Ray3 { Point3 { -10, 0, -8 }, Vector3 { 1, 0, 0 } }, 15, results );
+   EXPECT_EQ( 2, results.size() );
+
+   results.clear();
+   index.queryRay( Ray3 { Point3 { -10, 5, -8 }, Vector3 { 1, 0, 0 } }, numbers::POSITIVE_INFINITY, results );
+   EXPECT_TRUE( results.empty() );
+}
+
+TEST( SceneIndex, intersect_closest_and_any )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   const auto R = Ray3 { Point3 { 50, 0, -8 }, Vector3 { -1, 0, 0 } };
+   auto tested = 0;
+   const auto intersectSphere = [ & ]( SceneIndex::Index item, Real tMax ) {
+      ++tested;
+      Real t0, t1;
+      if ( intersect( R, Sphere {}, index.getItem( item )->getWorld(), t0, t1 ) && t0 > 0 && t0 < tMax ) {
+         return t0;
+      }
+      return numbers::POSITIVE_INFINITY;
+   };
+
+   Real t = 0;
+   const auto closest = index.intersectClosest( R, intersectSphere, t );
+   ASSERT_NE( SceneIndex::INVALID_INDEX, closest );
+   EXPECT_EQ( ( Point3f { 36, 0, -8 } ), index.getItem( closest )->getWorldBound()->getCenter() );
+   EXPECT_TRUE( isEqual( Real( 13 ), t ) );
+
+   // Far nodes are pruned once the closest one is found
+   EXPECT_LT( tested, 10 );
+
+   EXPECT_TRUE( index.intersectAny( R, numbers::POSITIVE_INFINITY, intersectSphere ) );
+   EXPECT_FALSE( index.intersectAny( R, 10, intersectSphere ) );
+   EXPECT_EQ( SceneIndex::INVALID_INDEX, index.intersectClosest( Ray3 { Point3 { 50, 5, -8 }, Vector3 { -1, 0, 0 } }, intersectSphere, t ) );
+}
+
+TEST( SceneIndex, query_frustum )
+{
+   auto scene = crimild::alloc< Group >();
+   auto visible = test::createSphere( translation( 0, 0, -10 ) );
+   scene->attachNode( visible );
+   scene->attachNode( test::createSphere( translation( 0, 0, 10 ) ) );
+   scene->attachNode( test::createSphere( translation( -50, 0, -10 ) ) );
+   auto camera = crimild::alloc< Camera >( 90, 1, 1, 100 );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   camera->computeCullingPlanes();
+
+   std::vector< SceneIndex::Index > results;
+   index.queryFrustum( crimild::get_ptr( camera ), results );
+   ASSERT_EQ( 1, results.size() );
+   EXPECT_EQ( crimild::get_ptr( visible ), index.getItem( results[ 0 ] ) );
+
+   results.clear();
+   camera->setCullingEnabled( false );
+   index.queryFrustum( crimild::get_ptr( camera ), results );
+   EXPECT_EQ( 3, results.size() );
+}
+
+TEST( SceneIndex, refit_after_transformations )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   auto node = index.getItem( 0 );
+   node->setLocal( translation( 100, 0, 0 ) );
+   scene->perform( UpdateWorldState() );
+   index.update();
+
+   EXPECT_EQ( 1, index.getStats().refits );
+
+   std::vector< SceneIndex::Index > results;
+   index.querySphere( Sphere { Point3 { 100, 0, 0 }, 1 }, results );
+   ASSERT_EQ( 1, results.size() );
+   EXPECT_EQ( node, index.getItem( results[ 0 ] ) );
+
+   results.clear();
+   index.querySphere( Sphere { Point3 { 0, 0, 0 }, 1 }, results );
+   EXPECT_TRUE( results.empty() );
+}
+
+TEST( SceneIndex, rebuild_when_cost_grows )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   // Scatter everything, which makes refitted nodes overlap a lot
+   Random::Generator rnd( 1982 );
+   for ( SceneIndex::Index i = 0; i < index.getItemCount(); ++i ) {
+      index.getItem( i )->setLocal( translation( rnd.generate( -100, 100 ), rnd.generate( -100, 100 ), rnd.generate( -100, 100 ) ) );
+   }
+   scene->perform( UpdateWorldState() );
+   index.update();
+
+   EXPECT_EQ( 2, index.getStats().builds );
+}
+
+TEST( SceneIndex, rebuild_after_interval )
+{
+   auto scene = test::createGrid( 4 );
+
+   SceneIndex index;
+   index.setRebuildInterval( 3 );
+   index.build( crimild::get_ptr( scene ) );
+
+   index.update();
+   index.update();
+   EXPECT_EQ( 1, index.getStats().builds );
+
+   index.update();
+   EXPECT_EQ( 2, index.getStats().builds );
+}
+
+TEST( SceneIndex, rebuild_when_hierarchy_changes )
+{
+   auto scene = test::createGrid( 4 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   scene->attachNode( test::createSphere( translation( 0, 10, 0 ) ) );
+   EXPECT_FALSE( index.isCurrent() );
+
+   scene->perform( UpdateWorldState() );
+   index.update();
+
+   EXPECT_TRUE( index.isCurrent() );
+   EXPECT_EQ( 17, index.getItemCount() );
+   EXPECT_EQ( 2, index.getStats().builds );
+
+   scene->getNodeAt( 0 )->setEnabled( false );
+   index.update();
+   EXPECT_EQ( 13, index.getItemCount() );
+}
+
+TEST( SceneIndex, ignores_changes_in_other_hierarchies )
+{
+   auto scene = test::createGrid( 4 );
+   auto other = test::createGrid( 2 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   other->attachNode( test::createSphere( translation( 0, 10, 0 ) ) );
+   other->getNodeAt( 0 )->setEnabled( false );
+   EXPECT_TRUE( index.isCurrent() );
+
+   // Moving nodes between hierarchies changes both of them
+   auto row = crimild::retain( other->getNodeAt( 1 ) );
+   row->detachFromParent();
+   EXPECT_TRUE( index.isCurrent() );
+   scene->attachNode( row );
+   EXPECT_FALSE( index.isCurrent() );
+
+   index.build( crimild::get_ptr( scene ) );
+   row->detachFromParent();
+   EXPECT_FALSE( index.isCurrent() );
+
+   // Attaching the indexed scene to another hierarchy changes its root
+   index.build( crimild::get_ptr( scene ) );
+   other->attachNode( scene );
+   EXPECT_FALSE( index.isCurrent() );
+}
+
+TEST( SceneIndex, unbounded_items )
+{
+   auto scene = test::createGrid( 4 );
+
+   auto plane = crimild::alloc< Geometry >();
+   plane->attachPrimitive( crimild::alloc< Primitive >( Primitive::Type::PLANE ) );
+   scene->attachNode( plane );
+   scene->perform( UpdateWorldState() );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   std::vector< SceneIndex::Index > results;
+   index.queryRay( Ray3 { Point3 { 0, 100, 100 }, Vector3 { 0, 1, 0 } }, numbers::POSITIVE_INFINITY, results );
+   ASSERT_EQ( 1, results.size() );
+   EXPECT_EQ( crimild::get_ptr( plane ), index.getItem( results[ 0 ] ) );
+}
+
+TEST( SceneIndex, rebuild_when_items_become_unbounded )
+{
+   auto scene = test::createGrid( 4 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   const auto R = Ray3 { Point3 { 0, 100, 100 }, Vector3 { 0, 1, 0 } };
+   std::vector< SceneIndex::Index > results;
+
+   auto sphere = scene->getNodeAt< Group >( 0 )->getNodeAt( 0 );
+   sphere->setLayer( Node::Layer::SKYBOX );
+   EXPECT_FALSE( index.isCurrent() );
+   index.update();
+   index.queryRay( R, numbers::POSITIVE_INFINITY, results );
+   EXPECT_EQ( 1, results.size() );
+
+   sphere->setLayer( Node::Layer::DEFAULT );
+   sphere->setCullMode( Node::CullMode::NEVER );
+   EXPECT_FALSE( index.isCurrent() );
+   index.update();
+   results.clear();
+   index.queryRay( R, numbers::POSITIVE_INFINITY, results );
+   EXPECT_EQ( 1, results.size() );
+
+   sphere->setCullMode( Node::CullMode::DEFAULT );
+   index.update();
+   results.clear();
+   index.queryRay( R, numbers::POSITIVE_INFINITY, results );
+   EXPECT_TRUE( results.empty() );
+
+   // Planes are unbounded too
+   static_cast< Geometry * >( sphere )->attachPrimitive( crimild::alloc< Primitive >( Primitive::Type::PLANE ) );
+   EXPECT_FALSE( index.isCurrent() );
+}
+
+TEST( SceneIndex, intersect_world )
+{
+   auto scene = crimild::alloc< Group >();
+   Random::Generator rnd( 1982 );
+   for ( int i = 0; i < 200; ++i ) {
+      const auto local = translation( rnd.generate( -20, 20 ), rnd.generate( -20, 20 ), rnd.generate( -20, 20 ) )( rotationY( rnd.generate( 0, numbers::TWO_PI ) ) );
+      scene->attachNode( test::createSphere( local ) );
+   }
+   scene->perform( UpdateWorldState() );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   for ( int i = 0; i < 100; ++i ) {
+      const auto R = Ray3 {
+         Point3 { 0, 0, 50 },
+         normalize( Vector3 { Real( rnd.generate( -0.5, 0.5 ) ), Real( rnd.generate( -0.5, 0.5 ) ), -1 } ),
+      };
+
+      IntersectWorld::Results expected;
+      scene->perform( IntersectWorld( R, expected ) );
+
+      IntersectWorld::Results actual;
+      scene->perform( IntersectWorld( R, actual, &index ) );
+
+      ASSERT_EQ( expected.size(), actual.size() );
+      for ( size_t j = 0; j < expected.size(); ++j ) {
+         EXPECT_EQ( expected[ j ].geometry, actual[ j ].geometry );
+         EXPECT_EQ( expected[ j ].t, actual[ j ].t );
+      }
+   }
+}
+
+TEST( SceneIndex, picking )
+{
+   auto scene = test::createGrid( 10 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   const auto R = Ray3 { Point3 { 8, 10, -8 }, Vector3 { 0, -1, 0 } };
+
+   Picking::Results results;
+   scene->perform( Picking( R, results, []( Node *node ) { return dynamic_cast< Geometry * >( node ) != nullptr; }, &index ) );
+
+   ASSERT_TRUE( results.hasResults() );
+   EXPECT_EQ( ( Point3f { 8, 0, -8 } ), results.getBestCandidate()->getWorldBound()->getCenter() );
+}
+
+TEST( SceneIndex, picking_without_filter_includes_groups )
+{
+   auto scene = test::createGrid( 4 );
+
+   SceneIndex index;
+   index.build( crimild::get_ptr( scene ) );
+
+   const auto R = Ray3 { Point3 { 8, 10, -8 }, Vector3 { 0, -1, 0 } };
+
+   // Groups are not indexed, so the index cannot be used
+   Picking::Results expected;
+   scene->perform( Picking( R, expected ) );
+   Picking::Results actual;
+   scene->perform( Picking( R, actual, nullptr, &index ) );
+
+   std::vector< Node * > expectedNodes;
+   expected.foreachCandidate( [ & ]( Node *node ) { expectedNodes.push_back( node ); } );
+   std::vector< Node * > actualNodes;
+   actual.foreachCandidate( [ & ]( Node *node ) { actualNodes.push_back( node ); } );
+   EXPECT_EQ( expectedNodes, actualNodes );
+   EXPECT_NE( expectedNodes.end(), std::find( expectedNodes.begin(), expectedNodes.end(), crimild::get_ptr( scene ) ) );
+}
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Visitors/RTBVH.hpp"
+
+#include "Components/MaterialComponent.hpp"
+#include "Primitives/Primitive.hpp"
+#include "Primitives/SpherePrimitive.hpp"
+#include "Rendering/Materials/PrincipledBSDFMaterial.hpp"
+#include "SceneGraph/Geometry.hpp"
+#include "SceneGraph/Group.hpp"
+#include "Visitors/BinTreeScene.hpp"
+
+#include <algorithm>
+#include <crimild/math/Random.hpp>
+#include <crimild/math/intersect.hpp>
+#include <crimild/math/normalize.hpp>
+#include <crimild/math/scale.hpp>
+#include <crimild/math/translation.hpp>
+#include <gtest/gtest.h>
+#include <numeric>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static std::vector< Bounds3 > createBoxes( size_t count, UInt32 seed )
+   {
+      auto rnd = Random::Generator( seed );
+      std::vector< Bounds3 > boxes;
+      for ( size_t i = 0; i < count; ++i ) {
+         const auto P = Point3 {
+            Real( rnd.generate( -50, 50 ) ),
+            Real( rnd.generate( -50, 50 ) ),
+            Real( rnd.generate( -50, 50 ) ),
+         };
+         const auto S = Vector3 {
+            Real( rnd.generate( 0.1, 2 ) ),
+            Real( rnd.generate( 0.1, 2 ) ),
+            Real( rnd.generate( 0.1, 2 ) ),
+         };
+         boxes.push_back( Bounds3 { P - S, P + S } );
+      }
+      return boxes;
+   }
+
+   static std::vector< Ray3 > createRays( size_t count, UInt32 seed )
+   {
+      auto rnd = Random::Generator( seed );
+      std::vector< Ray3 > rays;
+      for ( size_t i = 0; i < count; ++i ) {
+         rays.push_back(
+            Ray3 {
+               Point3 { Real( rnd.generate( -5, 5 ) ), Real( rnd.generate( -5, 5 ) ), 80 },
+               normalize( Vector3 { Real( rnd.generate( -0.6, 0.6 ) ), Real( rnd.generate( -0.6, 0.6 ) ), -1 } ),
+            }
+         );
+      }
+      return rays;
+   }
+
+   static Bool intersectBounds( const Ray3 &R, const Bounds3 &B, Real &t ) noexcept
+   {
+      auto t0 = Real( 0 );
+      auto t1 = numbers::POSITIVE_INFINITY;
+      for ( auto a = 0; a < 3; ++a ) {
+         const auto invD = Real( 1 ) / direction( R )[ a ];
+         auto tNear = ( B.min[ a ] - origin( R )[ a ] ) * invD;
+         auto tFar = ( B.max[ a ] - origin( R )[ a ] ) * invD;
+         if ( tNear > tFar ) {
+            std::swap( tNear, tFar );
+         }
+         t0 = std::max( t0, tNear );
+         t1 = std::min( t1, tFar );
+         if ( t0 > t1 ) {
+            return false;
+         }
+      }
+      t = t0;
+      return true;
+   }
+
+   static SharedPointer< Material > createMaterial( void )
+   {
+      return crimild::alloc< materials::PrincipledBSDF >();
+   }
+
+   static SharedPointer< Geometry > createGeometry( SharedPointer< Primitive > const &primitive, const Transformation &local )
+   {
+      auto geometry = crimild::alloc< Geometry >();
+      geometry->attachPrimitive( primitive );
+      geometry->attachComponent< MaterialComponent >( createMaterial() );
+      geometry->setLocal( local );
+      return geometry;
+   }
+
+}
+
+TEST( RTBVH4, build_empty )
+{
+   RTBVH4 bvh;
+   bvh.build( {} );
+
+   EXPECT_TRUE( bvh.empty() );
+
+   auto visited = 0;
+   auto tMax = numbers::POSITIVE_INFINITY;
+   bvh.intersect( Ray3 { Point3 { 0, 0, 0 }, Vector3 { 0, 0, -1 } }, tMax, [ & ]( UInt32, Real & ) { ++visited; } );
+   EXPECT_EQ( 0, visited );
+}
+
+TEST( RTBVH4, build )
+{
+   const auto boxes = test::createBoxes( 1000, 1982 );
+
+   RTBVH4 bvh;
+   bvh.build( boxes );
+
+   ASSERT_FALSE( bvh.empty() );
+
+   // Items are a permutation of the input
+   auto items = bvh.getItems();
+   std::sort( items.begin(), items.end() );
+   std::vector< UInt32 > expected( boxes.size() );
+   std::iota( expected.begin(), expected.end(), UInt32( 0 ) );
+   EXPECT_EQ( expected, items );
+
+   // Every item is referenced by exactly one leaf, whose bounds contain it
+   size_t count = 0;
+   for ( const auto &node : bvh.getNodes() ) {
+      for ( auto i = 0; i < 4; ++i ) {
+         if ( node.isEmpty( i ) ) {
+            continue;
+         }
+         if ( !node.isLeaf( i ) ) {
+            EXPECT_LT( 0, node.children[ i ] );
+            EXPECT_LT( size_t( node.children[ i ] ), bvh.getNodes().size() );
+            continue;
+         }
+         EXPECT_LE( node.counts[ i ], 4 * RTBVH4::MAX_LEAF_SIZE );
+         for ( UInt32 j = 0; j < node.counts[ i ]; ++j ) {
+            const auto &B = boxes[ bvh.getItems()[ node.children[ i ] + j ] ];
+            EXPECT_LE( node.minX[ i ], B.min.x );
+            EXPECT_LE( node.minY[ i ], B.min.y );
+            EXPECT_LE( node.minZ[ i ], B.min.z );
+            EXPECT_GE( node.maxX[ i ], B.max.x );
+            EXPECT_GE( node.maxY[ i ], B.max.y );
+            EXPECT_GE( node.maxZ[ i ], B.max.z );
+            ++count;
+         }
+      }
+   }
+   EXPECT_EQ( boxes.size(), count );
+}
+
+TEST( RTBVH4, intersect_matches_brute_force )
+{
+   const auto boxes = test::createBoxes( 2000, 1982 );
+
+   RTBVH4 bvh;
+   bvh.build( boxes );
+
+   for ( const auto &R : test::createRays( 500, 42 ) ) {
+      auto expected = numbers::POSITIVE_INFINITY;
+      for ( const auto &B : boxes ) {
+         Real t;
+         if ( test::intersectBounds( R, B, t ) && t < expected ) {
+            expected = t;
+         }
+      }
+
+      auto actual = numbers::POSITIVE_INFINITY;
+      bvh.intersect(
+         R,
+         actual,
+         [ & ]( UInt32 i, Real &tMax ) {
+            Real t;
+            if ( test::intersectBounds( R, boxes[ bvh.getItems()[ i ] ], t ) && t < tMax ) {
+               tMax = t;
+            }
+         }
+      );
+
+      EXPECT_EQ( expected, actual );
+   }
+}
+
+TEST( RTSceneBVH, matches_tree_traversal )
+{
+   auto scene = crimild::alloc< Group >();
+   auto sphere = crimild::alloc< Primitive >( Primitive::Type::SPHERE );
+   auto box = crimild::alloc< Primitive >( Primitive::Type::BOX );
+   auto rnd = Random::Generator( 1982 );
+   for ( auto i = 0; i < 300; ++i ) {
+      const auto T = translation( Real( rnd.generate( -40, 40 ) ), Real( rnd.generate( -40, 40 ) ), Real( rnd.generate( -40, 40 ) ) );
+      scene->attachNode( test::createGeometry( i % 2 == 0 ? sphere : box, T ) );
+   }
+
+   const auto accelerated = scene->perform< BinTreeScene >( BinTreeScene::SplitStrategy::X_AXIS )->perform< RTAcceleration >();
+
+   RTSceneBVH bvh( accelerated );
+   EXPECT_EQ( 300, bvh.getInstances().size() );
+   EXPECT_TRUE( bvh.getMeshes().empty() );
+
+   auto hits = 0;
+   for ( const auto &R : test::createRays( 500, 42 ) ) {
+      RTIntersection expected;
+      const auto expectedHit = intersectRTTree( R, accelerated, expected );
+
+      RTIntersection actual;
+      const auto actualHit = bvh.intersect( R, actual );
+
+      ASSERT_EQ( expectedHit, actualHit );
+      if ( expectedHit ) {
+         EXPECT_EQ( expected.t, actual.t );
+         EXPECT_EQ( expected.point, actual.point );
+         EXPECT_EQ( expected.materialId, actual.materialId );
+         ++hits;
+      }
+   }
+
+   EXPECT_LT( 0, hits );
+}
+
+TEST( RTSceneBVH, triangle_meshes )
+{
+   auto mesh = crimild::alloc< SpherePrimitive >(
+      SpherePrimitive::Params {
+         .divisions = Vector2i { 16, 16 },
+      }
+   );
+
+   auto scene = crimild::alloc< Group >();
+   scene->attachNode( test::createGeometry( mesh, translation( -3, 0, 0 ) ) );
+   scene->attachNode( test::createGeometry( mesh, translation( 3, 0, 0 )( scale( 2 ) ) ) );
+   scene->attachNode( test::createGeometry( crimild::alloc< Primitive >( Primitive::Type::SPHERE ), translation( 0, 0, -10 ) ) );
+
+   const auto accelerated = scene->perform< BinTreeScene >( BinTreeScene::SplitStrategy::X_AXIS )->perform< RTAcceleration >( false );
+
+   RTSceneBVH bvh( accelerated );
+   ASSERT_EQ( 3, bvh.getInstances().size() );
+
+   // Both geometries share the same mesh
+   ASSERT_EQ( 1, bvh.getMeshes().size() );
+   EXPECT_EQ( 16 * 16 * 2, bvh.getMeshes()[ 0 ].triangles.size() );
+
+   {
+      RTIntersection result;
+      ASSERT_TRUE( bvh.intersect( Ray3 { Point3 { -2.9, 0.1, 10 }, Vector3 { 0, 0, -1 } }, result ) );
+      EXPECT_LT( 9.0, result.t );
+      EXPECT_GT( 9.2, result.t );
+      EXPECT_TRUE( result.frontFace );
+   }
+
+   {
+      RTIntersection result;
+      ASSERT_TRUE( bvh.intersect( Ray3 { Point3 { 3.2, 0.2, 10 }, Vector3 { 0, 0, -1 } }, result ) );
+      EXPECT_LT( 8.0, result.t );
+      EXPECT_GT( 8.2, result.t );
+   }
+
+   {
+      // Misses both meshes and hits the unit sphere behind them
+      RTIntersection result;
+      ASSERT_TRUE( bvh.intersect( Ray3 { Point3 { 0, 0, 10 }, Vector3 { 0, 0, -1 } }, result ) );
+      EXPECT_FLOAT_EQ( 19, result.t );
+   }
+
+   {
+      RTIntersection result;
+      EXPECT_FALSE( bvh.intersect( Ray3 { Point3 { 0, 10, 10 }, Vector3 { 0, 0, -1 } }, result ) );
+   }
+}
+
+TEST( RTBVH4, intersect_packets_matches_single_rays )
+{
+   const auto boxes = test::createBoxes( 2000, 1982 );
+
+   RTBVH4 bvh;
+   bvh.build( boxes );
+
+   const auto rays = test::createRays( 500, 42 );
+   for ( size_t begin = 0; begin < rays.size(); begin += RTRayPacket::SIZE ) {
+      RTRayPacket packet;
+      for ( auto i = begin; i < std::min( rays.size(), begin + RTRayPacket::SIZE ); ++i ) {
+         packet.add( rays[ i ] );
+      }
+
+      bvh.intersect(
+         packet,
+         packet.getActiveMask(),
+         [ & ]( UInt32 i, UInt32 mask ) {
+            for ( UInt32 l = 0; l < RTRayPacket::SIZE; ++l ) {
+               Real t;
+               if ( ( mask & ( 1u << l ) ) && test::intersectBounds( packet.getRay( l ), boxes[ bvh.getItems()[ i ] ], t ) && t < packet.t[ l ] ) {
+                  packet.t[ l ] = t;
+               }
+            }
+         }
+      );
+
+      for ( UInt32 l = 0; l < packet.getCount(); ++l ) {
+         auto expected = numbers::POSITIVE_INFINITY;
+         bvh.intersect(
+            rays[ begin + l ],
+            expected,
+            [ & ]( UInt32 i, Real &tMax ) {
+               Real t;
+               if ( test::intersectBounds( rays[ begin + l ], boxes[ bvh.getItems()[ i ] ], t ) && t < tMax ) {
+                  tMax = t;
+               }
+            }
+         );
+         EXPECT_EQ( expected, packet.t[ l ] );
+      }
+   }
+}
+
+TEST( RTSceneBVH, packets_match_single_rays )
+{
+   auto mesh = crimild::alloc< SpherePrimitive >(
+      SpherePrimitive::Params {
+         .divisions = Vector2i { 16, 16 },
+      }
+   );
+
+   const std::vector< SharedPointer< Primitive > > primitives = {
+      crimild::alloc< Primitive >( Primitive::Type::SPHERE ),
+      crimild::alloc< Primitive >( Primitive::Type::BOX ),
+      crimild::alloc< Primitive >( Primitive::Type::CYLINDER ),
+      mesh,
+   };
+
+   auto scene = crimild::alloc< Group >();
+   auto rnd = Random::Generator( 1982 );
+   for ( auto i = 0; i < 200; ++i ) {
+      const auto T = translation( Real( rnd.generate( -40, 40 ) ), Real( rnd.generate( -40, 40 ) ), Real( rnd.generate( -40, 40 ) ) );
+      scene->attachNode( test::createGeometry( primitives[ i % primitives.size() ], T( scale( Real( rnd.generate( 0.5, 3 ) ) ) ) ) );
+   }
+
+   const auto accelerated = scene->perform< BinTreeScene >( BinTreeScene::SplitStrategy::X_AXIS )->perform< RTAcceleration >( false );
+
+   RTSceneBVH bvh( accelerated );
+   ASSERT_EQ( 200, bvh.getInstances().size() );
+
+   // The last packet is only partially filled
+   const auto rays = test::createRays( 501, 42 );
+
+   auto hits = 0;
+   for ( size_t begin = 0; begin < rays.size(); begin += RTRayPacket::SIZE ) {
+      RTRayPacket packet;
+      for ( auto i = begin; i < std::min( rays.size(), begin + RTRayPacket::SIZE ); ++i ) {
+         packet.add( rays[ i ] );
+      }
+
+      bvh.intersect( packet );
+
+      for ( UInt32 l = 0; l < packet.getCount(); ++l ) {
+         RTIntersection expected;
+         const auto expectedHit = bvh.intersect( rays[ begin + l ], expected );
+
+         RTIntersection actual;
+         const auto actualHit = bvh.resolve( packet, l, actual );
+
+         ASSERT_EQ( expectedHit, actualHit );
+         if ( expectedHit ) {
+            EXPECT_NEAR( expected.t, actual.t, 1e-3 * expected.t );
+            EXPECT_EQ( expected.materialId, actual.materialId );
+            EXPECT_EQ( expected.frontFace, actual.frontFace );
+            ++hits;
+         }
+      }
+   }
+
+   EXPECT_LT( 0, hits );
+}
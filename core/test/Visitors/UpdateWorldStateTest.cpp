@@ -27,6 +27,7 @@
 
 #include "Visitors/UpdateWorldState.hpp"
 
+#include "Concurrency/TaskSystem.hpp"
 #include "Primitives/Primitive.hpp"
 #include "Rendering/Vertex.hpp"
 #include "SceneGraph/CSGNode.hpp"
@@ -198,3 +199,125 @@ TEST( UpateWorldStateTest, with_csg )
    EXPECT_EQ( ( Point3f { 1, 0, 0 } ), origin( n1->getWorld() ) );
    EXPECT_EQ( ( Point3f { 1, 0, 0 } ), origin( csg->getWorld() ) );
 }
+
+TEST( UpdateWorldStateTest, invalidation )
+{
+   auto root = crimild::alloc< Group >();
+   auto group = crimild::alloc< Group >();
+   auto moving = crimild::alloc< Geometry >();
+   auto still = crimild::alloc< Geometry >();
+
+   root->attachNode( group );
+   group->attachNode( moving );
+   group->attachNode( still );
+
+   root->perform( UpdateWorldState() );
+
+   EXPECT_FALSE( root->isWorldStateDirty() );
+   EXPECT_FALSE( root->hasDirtyDescendants() );
+   EXPECT_FALSE( group->hasDirtyDescendants() );
+   EXPECT_FALSE( moving->isWorldStateDirty() );
+
+   moving->setLocal( translation( 0, 0, -5 ) );
+
+   EXPECT_TRUE( moving->isWorldStateDirty() );
+   EXPECT_TRUE( group->hasDirtyDescendants() );
+   EXPECT_TRUE( root->hasDirtyDescendants() );
+   EXPECT_FALSE( group->isWorldStateDirty() );
+   EXPECT_FALSE( root->isWorldStateDirty() );
+   EXPECT_FALSE( still->isWorldStateDirty() );
+
+   root->perform( UpdateWorldState() );
+
+   EXPECT_EQ( ( Point3f { 0, 0, -5 } ), origin( moving->getWorld() ) );
+   EXPECT_FALSE( moving->isWorldStateDirty() );
+   EXPECT_FALSE( group->hasDirtyDescendants() );
+   EXPECT_FALSE( root->hasDirtyDescendants() );
+}
+
+TEST( UpdateWorldStateTest, parent_moves_children )
+{
+   auto root = crimild::alloc< Group >();
+   auto child = crimild::alloc< Geometry >();
+   root->attachNode( child );
+
+   root->perform( UpdateWorldState() );
+   EXPECT_FALSE( child->isWorldStateDirty() );
+
+   // Only the parent is flagged, but children must be updated too
+   root->setLocal( translation( 1, 2, 3 ) );
+   root->perform( UpdateWorldState() );
+
+   EXPECT_EQ( ( Point3f { 1, 2, 3 } ), origin( child->getWorld() ) );
+}
+
+TEST( UpdateWorldStateTest, detaching_updates_parent_bound )
+{
+   auto root = crimild::alloc< Group >();
+   auto a = crimild::alloc< Group >();
+   auto b = crimild::alloc< Group >();
+   a->setLocal( translation( -10, 0, 0 ) );
+   b->setLocal( translation( 10, 0, 0 ) );
+   root->attachNode( a );
+   root->attachNode( b );
+
+   root->perform( UpdateWorldState() );
+   EXPECT_EQ( ( Point3f { 0, 0, 0 } ), root->getWorldBound()->getCenter() );
+
+   root->detachNode( b );
+   EXPECT_TRUE( root->hasDirtyDescendants() );
+
+   root->perform( UpdateWorldState() );
+   EXPECT_EQ( ( Point3f { -10, 0, 0 } ), root->getWorldBound()->getCenter() );
+}
+
+TEST( UpdateWorldStateTest, parallel_matches_serial )
+{
+   auto build = [] {
+      auto root = crimild::alloc< Group >();
+      for ( int i = 0; i < 32; ++i ) {
+         auto group = crimild::alloc< Group >();
+         group->setLocal( translation( Real( i ), 0, 0 ) );
+         for ( int j = 0; j < 32; ++j ) {
+            auto node = crimild::alloc< Geometry >();
+            node->setLocal( translation( 0, Real( j ), Real( i * j ) ) );
+            group->attachNode( node );
+         }
+         root->attachNode( group );
+      }
+      return root;
+   };
+
+   auto serial = build();
+   serial->perform( UpdateWorldState() );
+
+   concurrency::TaskSystem tasks;
+   tasks.configure( 4 );
+   tasks.start();
+
+   auto parallel = build();
+   parallel->perform( UpdateWorldState() );
+
+   // Move a few nodes and update again
+   for ( auto scene : { serial, parallel } ) {
+      for ( int i = 0; i < 32; i += 3 ) {
+         scene->getNodeAt< Group >( i )->getNodeAt( i )->setLocal( translation( 0, 0, Real( 100 + i ) ) );
+      }
+   }
+   serial->perform( UpdateWorldState() );
+   parallel->perform( UpdateWorldState() );
+
+   tasks.stop();
+
+   for ( int i = 0; i < 32; ++i ) {
+      auto s = serial->getNodeAt< Group >( i );
+      auto p = parallel->getNodeAt< Group >( i );
+      EXPECT_EQ( s->getWorldBound()->getCenter(), p->getWorldBound()->getCenter() );
+      for ( int j = 0; j < 32; ++j ) {
+         EXPECT_EQ( s->getNodeAt( j )->getWorld(), p->getNodeAt( j )->getWorld() );
+      }
+   }
+   EXPECT_EQ( serial->getWorldBound()->getCenter(), parallel->getWorldBound()->getCenter() );
+   EXPECT_EQ( serial->getWorldBound()->getRadius(), parallel->getWorldBound()->getRadius() );
+   EXPECT_FALSE( parallel->hasDirtyDescendants() );
+}
@@ -15,10 +15,10 @@ SharedPointer< Geometry > createSphere( const Vector3f &center, float radius )
 int main( int argc, char **argv )
 {
     for ( int i = 0; i < 10; i++ ) {
-        crimild::concurrency::JobScheduler jobScheduler;
+        crimild::concurrency::TaskSystem taskSystem;
 
-        jobScheduler.configure();
-        jobScheduler.start();
+        taskSystem.configure();
+        taskSystem.start();
 
         auto parent = crimild::concurrency::async();
 
@@ -37,7 +37,7 @@ int main( int argc, char **argv )
 
         crimild::concurrency::wait( parent );
         
-        jobScheduler.stop();
+        taskSystem.stop();
 
         std::cout << "Counter: " << counter << std::endl;
     }
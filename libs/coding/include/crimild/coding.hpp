@@ -28,6 +28,8 @@
 #ifndef CRIMILD_CODING_
 #define CRIMILD_CODING_
 
+#include "BinaryDecoder.hpp"
+#include "BinaryEncoder.hpp"
 #include "Codable.hpp"
 #include "Decoder.hpp"
 #include "EncodedData.hpp"
@@ -37,6 +39,8 @@
 #include "FileEncoder.hpp"
 #include "MemoryDecoder.hpp"
 #include "MemoryEncoder.hpp"
+#include "StreamingFileDecoder.hpp"
+#include "StreamingFileEncoder.hpp"
 #include "Tags.hpp"
 
 namespace crimild::coding {
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CODING_BINARY_DECODER_
+#define CRIMILD_CORE_CODING_BINARY_DECODER_
+
+#include "Decoder.hpp"
+
+#include <crimild/math/Transformation.hpp>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crimild {
+
+   namespace coding {
+
+      namespace binary {
+
+         struct Header;
+         struct String;
+         struct Object;
+         struct Field;
+
+      }
+
+      /**
+         \brief Decodes objects encoded with BinaryEncoder
+
+         Files are memory-mapped and decoded in place. Tables are validated once
+         when loading, objects are built using one builder lookup per class, and
+         the string table is hashed so each key requested by a codable is turned
+         into a string id once. Fields are then matched by comparing ids while
+         walking each object's fields in the order they were encoded.
+
+         Large payloads can be referenced in place with decodeInPlace() (i.e. the
+         contents of buffers), keeping the mapping alive for as long as they are
+         in use. The file is mapped copy-on-write, so such payloads can be
+         modified without affecting the file.
+
+         \see BinaryEncoder
+       */
+      class BinaryDecoder : public Decoder {
+      public:
+         BinaryDecoder( void ) = default;
+         virtual ~BinaryDecoder( void ) = default;
+
+         /**
+            \brief Maps a file and decodes its objects
+          */
+         Bool read( const std::filesystem::path &path ) noexcept;
+
+         /**
+            \brief Decodes objects from a copy of the given bytes
+          */
+         Bool fromBytes( const ByteArray &bytes ) noexcept;
+
+      public:
+         virtual crimild::Bool decode( std::string key, SharedPointer< coding::Codable > &codable ) override;
+
+         virtual crimild::Bool decode( std::string key, std::string &value ) override;
+
+         virtual crimild::Bool decode( std::string key, crimild::Size &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt8 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt16 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Int16 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Int32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Bool &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Real32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Real64 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::ColorRGB &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::ColorRGBA &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Point2f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Point3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector2f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector4f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Matrix3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Matrix4f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Quaternion &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, Transformation &value ) override { return decodeValue( key, value ); }
+
+         virtual bool decode( std::string_view key, std::vector< std::byte > &value ) override;
+
+         virtual crimild::Bool decode( std::string key, ByteArray &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< crimild::Real32 > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Vector3f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Vector4f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Matrix3f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Matrix4f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Quaternion > &value ) override { return decodeArray( key, value ); }
+
+         virtual Bool decodeInPlace( std::string_view key, Byte *&data, Size &size, std::shared_ptr< const void > &owner ) noexcept override;
+
+      protected:
+         virtual crimild::Size beginDecodingArray( std::string key ) override;
+         virtual std::string beginDecodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endDecodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endDecodingArray( std::string key ) override;
+
+      private:
+         template< typename T >
+         crimild::Bool decodeValue( std::string_view key, T &value )
+         {
+            Byte *data = nullptr;
+            Size size = 0;
+            if ( !findData( key, data, size ) ) {
+               value = T();
+               return false;
+            }
+
+            value = T();
+            memcpy( ( void * ) &value, data, std::min( size, sizeof( T ) ) );
+            return true;
+         }
+
+         template< typename T >
+         crimild::Bool decodeArray( std::string_view key, Array< T > &value )
+         {
+            Byte *data = nullptr;
+            Size size = 0;
+            if ( !findData( key, data, size ) ) {
+               return false;
+            }
+
+            const auto N = size / sizeof( T );
+            value.resize( N );
+            if ( N > 0 ) {
+               memcpy( ( void * ) &value[ 0 ], data, N * sizeof( T ) );
+            }
+            return true;
+         }
+
+         /**
+            \brief Validates tables and builds all objects
+          */
+         Bool load( Byte *data, Size size, std::shared_ptr< const void > owner ) noexcept;
+
+         void decodeObject( UInt32 id ) noexcept;
+
+         /**
+            \brief Finds a field of the object being decoded
+
+            Fields are usually decoded in the same order they were encoded, so
+            the search starts right after the last field found.
+          */
+         const binary::Field *findField( std::string_view key ) noexcept;
+         const binary::Field *findField( UInt32 keyId ) noexcept;
+
+         Bool findData( std::string_view key, Byte *&data, Size &size ) noexcept;
+
+         std::string_view getString( UInt32 id ) const noexcept;
+
+         /**
+            \brief Returns the id of a string in the string table
+
+            Strings are interned by BinaryEncoder, so there is at most one id per
+            string. Returns false if the string is not in the table.
+          */
+         Bool findStringId( std::string_view str, UInt32 &id ) const noexcept;
+
+      private:
+         std::shared_ptr< const void > m_owner;
+
+         const binary::Header *m_header = nullptr;
+         const binary::String *m_strings = nullptr;
+         const char *m_chars = nullptr;
+         const binary::Object *m_objectTable = nullptr;
+         const binary::Field *m_fields = nullptr;
+         Byte *m_data = nullptr;
+
+         /**
+            \brief Maps strings to their ids
+
+            Views point into the mapped file, which is kept alive by m_owner.
+          */
+         std::unordered_map< std::string_view, UInt32 > m_stringIds;
+
+         std::vector< SharedPointer< Codable > > m_objects;
+         std::vector< Bool > m_decoded;
+
+         UInt32 m_current = ~UInt32( 0 );
+         UInt32 m_cursor = 0;
+      };
+
+   }
+
+}
+
+#endif
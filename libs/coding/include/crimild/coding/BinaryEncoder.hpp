@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CODING_BINARY_ENCODER_
+#define CRIMILD_CORE_CODING_BINARY_ENCODER_
+
+#include "Codable.hpp"
+#include "Encoder.hpp"
+
+#include <crimild/math/Transformation.hpp>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crimild {
+
+   namespace coding {
+
+      namespace binary {
+
+         struct Field;
+
+      }
+
+      /**
+         \brief Encodes objects using a flat, memory-mappable layout
+
+         Unlike MemoryEncoder, which tags every object, link and value, data is
+         laid out in tables of strings, classes, objects and fields, followed by
+         an aligned data section. Keys and class names are stored only once and
+         referenced by id, and large payloads (arrays, byte buffers) are aligned
+         so decoders can use them in place.
+
+         \see BinaryDecoder
+       */
+      class BinaryEncoder : public Encoder {
+      public:
+         BinaryEncoder( void );
+         virtual ~BinaryEncoder( void );
+
+      public:
+         virtual crimild::Bool encode( SharedPointer< Codable > const &obj ) override;
+         virtual crimild::Bool encode( std::string key, SharedPointer< Codable > const &obj ) override;
+
+         virtual crimild::Bool encode( std::string key, std::string value ) override;
+
+         virtual crimild::Bool encode( std::string key, const Transformation &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Size value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt8 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt16 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Int16 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Int32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Real32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Real64 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const ColorRGB &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const ColorRGBA &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Point2f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Point3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector2f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector4f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Matrix3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Matrix4f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Quaternion &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Bool value ) override { return encodeValue( key, value ); }
+
+         virtual bool encode( std::string_view key, std::vector< std::byte > &value ) override { return encodeBulk( key, value.data(), value.size() ); }
+
+         virtual crimild::Bool encode( std::string key, ByteArray &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< crimild::Real32 > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Vector3f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Vector4f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Matrix3f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Matrix4f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Quaternion > &value ) override { return encodeArray( key, value ); }
+
+         /**
+            \brief Lays out all encoded objects in memory
+          */
+         ByteArray getBytes( void ) const;
+
+         /**
+            \brief Writes all encoded objects to a file
+
+            Sections are written one after the other, without laying out the
+            whole file in memory first.
+          */
+         Bool write( const std::filesystem::path &path ) const noexcept;
+
+      protected:
+         virtual void encodeArrayBegin( std::string key, crimild::Size count ) override;
+         virtual std::string beginEncodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endEncodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void encodeArrayEnd( std::string key ) override;
+
+      private:
+         template< typename T >
+         crimild::Bool encodeValue( std::string_view key, const T &value )
+         {
+            return encodeData( key, &value, sizeof( T ), alignof( T ) );
+         }
+
+         template< typename T >
+         crimild::Bool encodeArray( std::string_view key, const Array< T > &value )
+         {
+            return encodeBulk( key, value.getData(), value.size() * sizeof( T ) );
+         }
+
+         crimild::Bool encodeBulk( std::string_view key, const void *data, crimild::Size size );
+         crimild::Bool encodeData( std::string_view key, const void *data, crimild::Size size, crimild::Size alignment );
+
+         /**
+            \brief Appends a field to the object being encoded
+          */
+         crimild::Bool addField( std::string_view key, const binary::Field &field );
+
+         /**
+            \brief Returns the id of a string, adding it to the table if needed
+          */
+         UInt32 intern( std::string_view str );
+
+         /**
+            \brief Writes the file contents in order, one section at a time
+          */
+         void emit( const std::function< void( const void *, crimild::Size ) > &out ) const;
+
+      private:
+         struct ObjectRecord {
+            UInt32 classId;
+            std::vector< binary::Field > fields;
+         };
+
+         std::vector< std::string_view > m_strings;
+         std::unordered_map< std::string, UInt32 > m_stringIds;
+         crimild::Size m_charsSize = 0;
+
+         std::vector< UInt32 > m_classes;
+         std::unordered_map< UInt32, UInt32 > m_classIds;
+
+         std::vector< ObjectRecord > m_objects;
+         std::unordered_map< const Codable *, UInt32 > m_objectIds;
+         std::vector< UInt32 > m_roots;
+
+         std::vector< crimild::Byte > m_data;
+
+         /**
+            \brief Id of the object being encoded
+          */
+         UInt32 m_current;
+      };
+
+   }
+
+}
+
+#endif
@@ -124,6 +124,20 @@ namespace crimild {
 
          virtual bool decode( std::string_view key, std::vector< std::byte > & ) = 0;
 
+         /**
+            \brief Gets encoded bytes without copying them
+
+            Only supported by decoders reading from memory that outlives them (i.e.
+            a mapped file). On success, `data` points to `size` bytes that remain
+            valid for as long as `owner` is alive.
+
+            \returns false if not supported or if there is no data for the given key
+          */
+         virtual Bool decodeInPlace( std::string_view key, Byte *&data, Size &size, std::shared_ptr< const void > &owner ) noexcept
+         {
+            return false;
+         }
+
          virtual crimild::Bool decode( std::string key, ByteArray &value ) = 0;
          virtual crimild::Bool decode( std::string key, Array< crimild::Real32 > &value ) = 0;
          virtual crimild::Bool decode( std::string key, Array< Vector3f > &value ) = 0;
@@ -32,16 +32,34 @@
 #include "crimild/coding/EncodedData.hpp"
 
 #include <crimild/math/Transformation.hpp>
+#include <functional>
 
 namespace crimild {
 
    namespace coding {
 
       class MemoryDecoder : public Decoder {
+      public:
+         /**
+            \brief Invokes fn( begin, end ) for chunks covering [0, count)
+
+            Chunks may be processed in parallel, but the function must return
+            only after all of them are done.
+          */
+         using ParallelFor = std::function< void( crimild::Size count, const std::function< void( crimild::Size begin, crimild::Size end ) > &fn ) >;
+
       public:
          MemoryDecoder( void );
          virtual ~MemoryDecoder( void );
 
+      private:
+         /**
+            \brief Creates a decoder that reads values and links from another one
+
+            Used to decode objects in parallel, each worker with its own current object.
+          */
+         explicit MemoryDecoder( const MemoryDecoder *source );
+
       public:
          virtual crimild::Bool decode( std::string key, SharedPointer< coding::Codable > &codable ) override;
 
@@ -73,7 +91,7 @@ namespace crimild {
 
          virtual bool decode( std::string_view key, std::vector< std::byte > &value ) override
          {
-            auto obj = crimild::cast_ptr< EncodedData >( _links[ _currentObj->getUniqueID() ][ std::string( key ) ] );
+            auto obj = crimild::cast_ptr< EncodedData >( getLink( std::string( key ) ) );
             if ( obj == nullptr ) {
                return false;
             }
@@ -96,11 +114,26 @@ namespace crimild {
 
          crimild::Bool fromBytes( const ByteArray &bytes );
 
+         /**
+            \brief Decodes objects in parallel
+
+            Once all objects have been built, they are sorted by their distance to
+            the objects they link to (leaves first) and each group is decoded in
+            parallel using the given function. Since linked objects are always
+            decoded before the ones referencing them, links are resolved by just
+            returning the already decoded object, producing the same object graph
+            as sequential decoding. Shared objects are decoded only once.
+
+            Objects must only modify themselves and the objects they link to when
+            being decoded.
+          */
+         inline void setParallelFor( ParallelFor parallelFor ) noexcept { _parallelFor = std::move( parallelFor ); }
+
       private:
          template< typename T >
          crimild::Bool decodeData( std::string key, T &value )
          {
-            auto obj = crimild::cast_ptr< EncodedData >( _links[ _currentObj->getUniqueID() ][ key ] );
+            auto obj = crimild::cast_ptr< EncodedData >( getLink( key ) );
             if ( obj == nullptr ) {
                value = T();
                return false;
@@ -114,7 +147,7 @@ namespace crimild {
          template< typename T >
          crimild::Bool decodeDataArray( std::string key, Array< T > &value )
          {
-            auto obj = crimild::cast_ptr< EncodedData >( _links[ _currentObj->getUniqueID() ][ key ] );
+            auto obj = crimild::cast_ptr< EncodedData >( getLink( key ) );
             if ( obj == nullptr ) {
                return false;
             }
@@ -135,6 +168,13 @@ namespace crimild {
          virtual void endDecodingArray( std::string key ) override;
 
       private:
+         /**
+            \brief Returns the object linked to the current one with the given key, if any
+          */
+         SharedPointer< Codable > getLink( const std::string &key ) const noexcept;
+
+         void decodeInParallel( void );
+
          static crimild::Size read( const ByteArray &bytes, crimild::Int8 &value, crimild::Size offset );
          static crimild::Size read( const ByteArray &bytes, Codable::UniqueID &value, crimild::Size offset );
          static crimild::Size read( const ByteArray &bytes, std::string &value, crimild::Size offset );
@@ -145,6 +185,14 @@ namespace crimild {
          Map< Codable::UniqueID, Map< std::string, SharedPointer< Codable > > > _links;
          Map< Codable::UniqueID, SharedPointer< Codable > > _objects;
          SharedPointer< Codable > _currentObj;
+
+         /**
+            \brief Decoder owning links and objects
+
+            It's this decoder unless decoding in parallel.
+          */
+         const MemoryDecoder *_source = this;
+         ParallelFor _parallelFor;
       };
 
    }
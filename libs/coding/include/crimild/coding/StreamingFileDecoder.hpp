@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CODING_STREAMING_FILE_DECODER_
+#define CRIMILD_CORE_CODING_STREAMING_FILE_DECODER_
+
+#include "crimild/coding/Codable.hpp"
+#include "crimild/coding/Decoder.hpp"
+
+#include <algorithm>
+#include <crimild/math/Transformation.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace crimild {
+
+   namespace coding {
+
+      /**
+         \brief Decodes objects from a file without loading it in memory
+
+         Reads files in the tag-based format written by FileEncoder and
+         StreamingFileEncoder. A first pass over the file builds objects and
+         records links, but only the location of each value is kept. Values
+         are read from the file when decoded, directly into their destination
+         through a fixed-size buffer. Memory usage depends on the number of
+         objects and links, not on the amount of data.
+
+         \see StreamingFileEncoder
+       */
+      class StreamingFileDecoder : public Decoder {
+      public:
+         static constexpr crimild::Size BUFFER_SIZE = 64 * 1024;
+
+      public:
+         StreamingFileDecoder( void );
+         virtual ~StreamingFileDecoder( void );
+
+         Bool read( const std::filesystem::path &path ) noexcept;
+
+      public:
+         virtual crimild::Bool decode( std::string key, SharedPointer< coding::Codable > &codable ) override;
+
+         virtual crimild::Bool decode( std::string key, std::string &value ) override;
+
+         virtual crimild::Bool decode( std::string key, crimild::Size &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt8 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt16 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Int16 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Int32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::UInt32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Bool &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Real32 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Real64 &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::ColorRGB &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::ColorRGBA &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Point2f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Point3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector2f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Vector4f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Matrix3f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Matrix4f &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, crimild::Quaternion &value ) override { return decodeValue( key, value ); }
+         virtual crimild::Bool decode( std::string key, Transformation &value ) override { return decodeValue( key, value ); }
+
+         virtual bool decode( std::string_view key, std::vector< std::byte > &value ) override;
+
+         virtual crimild::Bool decode( std::string key, ByteArray &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< crimild::Real32 > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Vector3f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Vector4f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Matrix3f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Matrix4f > &value ) override { return decodeArray( key, value ); }
+         virtual crimild::Bool decode( std::string key, Array< Quaternion > &value ) override { return decodeArray( key, value ); }
+
+      protected:
+         virtual crimild::Size beginDecodingArray( std::string key ) override;
+         virtual std::string beginDecodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endDecodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endDecodingArray( std::string key ) override;
+
+      private:
+         /**
+            \brief Location of an encoded value in the file
+          */
+         struct Payload {
+            crimild::Size offset = 0;
+            crimild::Size size = 0;
+         };
+
+         template< typename T >
+         crimild::Bool decodeValue( std::string_view key, T &value )
+         {
+            value = T();
+            auto payload = findPayload( key );
+            if ( payload == nullptr ) {
+               return false;
+            }
+            return readAt( payload->offset, &value, std::min( payload->size, crimild::Size( sizeof( T ) ) ) );
+         }
+
+         template< typename T >
+         crimild::Bool decodeArray( std::string_view key, Array< T > &value )
+         {
+            auto payload = findPayload( key );
+            if ( payload == nullptr ) {
+               return false;
+            }
+
+            const auto N = payload->size / sizeof( T );
+            value.resize( N );
+            return N == 0 || readAt( payload->offset, value.getData(), N * sizeof( T ) );
+         }
+
+         const Payload *findPayload( std::string_view key ) const noexcept;
+
+         /**
+            \brief Decodes an object the first time it's referenced
+          */
+         void decodeObject( Codable::UniqueID id, const SharedPointer< Codable > &obj );
+
+         /**
+            \brief Builds objects and records links and value locations
+          */
+         crimild::Bool scan( void );
+
+         crimild::Bool read( crimild::Int8 &tag );
+         crimild::Bool read( Codable::UniqueID &id );
+         crimild::Bool read( std::string &str );
+         crimild::Bool readRawBytes( void *data, crimild::Size size );
+         crimild::Bool readAt( crimild::Size offset, void *data, crimild::Size size );
+         crimild::Bool skip( crimild::Size size );
+         crimild::Bool seek( crimild::Size offset );
+
+      private:
+         std::vector< char > m_buffer;
+         std::ifstream m_in;
+
+         /**
+            \brief Current read position, used to avoid unnecessary seeks
+          */
+         crimild::Size m_position = 0;
+         crimild::Size m_end = 0;
+
+         /**
+            \note Ids are the ones in the file, which are different from the ones
+            of decoded objects.
+          */
+         //@{
+         std::unordered_map< Codable::UniqueID, SharedPointer< Codable > > m_objects;
+         std::unordered_map< Codable::UniqueID, Payload > m_payloads;
+         std::unordered_map< Codable::UniqueID, std::unordered_map< std::string, Codable::UniqueID > > m_links;
+         std::unordered_set< Codable::UniqueID > m_decoded;
+         std::vector< Codable::UniqueID > m_roots;
+         Codable::UniqueID m_current = 0;
+         //@}
+      };
+
+   }
+
+}
+
+#endif
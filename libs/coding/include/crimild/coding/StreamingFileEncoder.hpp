@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CODING_STREAMING_FILE_ENCODER_
+#define CRIMILD_CORE_CODING_STREAMING_FILE_ENCODER_
+
+#include "Codable.hpp"
+#include "Encoder.hpp"
+
+#include <crimild/math/Transformation.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace crimild {
+
+   namespace coding {
+
+      /**
+         \brief Encodes objects directly into a file, as they are visited
+
+         Produces the same tag-based format as FileEncoder, so files can be read
+         by both FileDecoder and StreamingFileDecoder. But instead of keeping
+         every object and value in memory until the end, each one is written
+         through a fixed-size buffer as soon as it is encoded. Memory usage
+         depends on the number of objects, not on the amount of data.
+
+         The file must be opened before encoding objects and closed afterwards:
+
+         \code
+         StreamingFileEncoder encoder;
+         encoder.open( path );
+         encoder.encode( scene );
+         encoder.close();
+         \endcode
+
+         \see StreamingFileDecoder
+       */
+      class StreamingFileEncoder : public Encoder {
+      public:
+         static constexpr crimild::Size BUFFER_SIZE = 64 * 1024;
+
+      public:
+         StreamingFileEncoder( void );
+         virtual ~StreamingFileEncoder( void );
+
+         /**
+            \brief Opens a file and writes the header
+
+            Set the version before opening the file, since it's written as part
+            of the header.
+          */
+         Bool open( const std::filesystem::path &path ) noexcept;
+
+         inline Bool isOpen( void ) const noexcept { return m_out.is_open(); }
+
+         /**
+            \brief Writes root objects and completes the file
+          */
+         Bool close( void ) noexcept;
+
+      public:
+         virtual crimild::Bool encode( SharedPointer< Codable > const &obj ) override;
+         virtual crimild::Bool encode( std::string key, SharedPointer< Codable > const &obj ) override;
+
+         virtual crimild::Bool encode( std::string key, std::string value ) override;
+
+         virtual crimild::Bool encode( std::string key, const Transformation &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Size value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt8 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt16 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Int16 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Int32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::UInt32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Real32 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Real64 value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const ColorRGB &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const ColorRGBA &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Point2f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Point3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector2f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Vector4f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Matrix3f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Matrix4f &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, const Quaternion &value ) override { return encodeValue( key, value ); }
+         virtual crimild::Bool encode( std::string key, crimild::Bool value ) override { return encodeValue( key, value ); }
+
+         virtual bool encode( std::string_view key, std::vector< std::byte > &value ) override { return encodeData( key, value.data(), value.size() ); }
+
+         virtual crimild::Bool encode( std::string key, ByteArray &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< crimild::Real32 > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Vector3f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Vector4f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Matrix3f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Matrix4f > &value ) override { return encodeArray( key, value ); }
+         virtual crimild::Bool encode( std::string key, Array< Quaternion > &value ) override { return encodeArray( key, value ); }
+
+      protected:
+         virtual void encodeArrayBegin( std::string key, crimild::Size count ) override;
+         virtual std::string beginEncodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void endEncodingArrayElement( std::string key, crimild::Size index ) override;
+         virtual void encodeArrayEnd( std::string key ) override;
+
+      private:
+         template< typename T >
+         crimild::Bool encodeValue( std::string_view key, const T &value )
+         {
+            return encodeData( key, &value, sizeof( T ) );
+         }
+
+         template< typename T >
+         crimild::Bool encodeArray( std::string_view key, const Array< T > &value )
+         {
+            return encodeData( key, value.getData(), value.size() * sizeof( T ) );
+         }
+
+         /**
+            \brief Writes a value as an EncodedData object linked to the current one
+          */
+         crimild::Bool encodeData( std::string_view key, const void *data, crimild::Size size );
+
+         void writeObject( Codable::UniqueID id, std::string_view className, const void *data, crimild::Size size, crimild::Bool hasData );
+         void writeLink( Codable::UniqueID parent, std::string_view key, Codable::UniqueID child );
+
+         void write( crimild::Int8 tag );
+         void write( Codable::UniqueID id );
+         void write( std::string_view str );
+         void write( const void *data, crimild::Size size );
+         void writeRawBytes( const void *data, crimild::Size size );
+
+      private:
+         std::vector< char > m_buffer;
+         std::ofstream m_out;
+
+         /**
+            \brief Number of bytes written after the size prefix
+          */
+         crimild::Size m_size = 0;
+
+         std::unordered_set< Codable::UniqueID > m_written;
+         std::vector< Codable::UniqueID > m_roots;
+         Codable *m_parent = nullptr;
+
+         /**
+            \brief Values are not objects, so they get ids that no object can have
+          */
+         Codable::UniqueID m_nextDataID = 1;
+      };
+
+   }
+
+}
+
+#endif
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/BinaryDecoder.hpp"
+
+#include "BinaryFormat.hpp"
+
+#include <crimild/foundation.hpp>
+#include <crimild/foundation/filesystem/MappedFile.hpp>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+Bool BinaryDecoder::read( const std::filesystem::path &path ) noexcept
+{
+   auto file = crimild::alloc< MappedFile >( path.string(), MappedFile::Access::COPY_ON_WRITE );
+   if ( !file->isOpen() ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot open file ", path.string() );
+      return false;
+   }
+
+   return load( file->getWritableData(), file->getSize(), file );
+}
+
+Bool BinaryDecoder::fromBytes( const ByteArray &bytes ) noexcept
+{
+   // Copy into 8-byte words so tables are properly aligned
+   auto storage = std::make_shared< std::vector< UInt64 > >( ( bytes.size() + sizeof( UInt64 ) - 1 ) / sizeof( UInt64 ) );
+   if ( !bytes.empty() ) {
+      memcpy( storage->data(), bytes.getData(), bytes.size() );
+   }
+
+   return load( reinterpret_cast< Byte * >( storage->data() ), bytes.size(), storage );
+}
+
+Bool BinaryDecoder::load( Byte *bytes, Size size, std::shared_ptr< const void > owner ) noexcept
+{
+   using namespace binary;
+
+   if ( bytes == nullptr || size < sizeof( Header ) ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format" );
+      return false;
+   }
+
+   const auto header = reinterpret_cast< const Header * >( bytes );
+   if ( header->magic != MAGIC || header->formatVersion != FORMAT_VERSION ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unknown magic number or format version" );
+      return false;
+   }
+
+   // Validate every table once, so decoding does not need to check bounds
+   const auto isValidSection = [ & ]( UInt64 offset, UInt64 count, Size stride ) {
+      return offset % SECTION_ALIGNMENT == 0
+             && offset <= size
+             && count <= ( size - offset ) / stride;
+   };
+   if ( !isValidSection( header->stringsOffset, header->stringCount, sizeof( String ) )
+        || !isValidSection( header->charsOffset, header->charsSize, 1 )
+        || !isValidSection( header->classesOffset, header->classCount, sizeof( UInt32 ) )
+        || !isValidSection( header->objectsOffset, header->objectCount, sizeof( Object ) )
+        || !isValidSection( header->fieldsOffset, header->fieldCount, sizeof( Field ) )
+        || !isValidSection( header->rootsOffset, header->rootCount, sizeof( UInt32 ) )
+        || !isValidSection( header->dataOffset, header->dataSize, 1 ) ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Sections out of bounds" );
+      return false;
+   }
+
+   const auto strings = reinterpret_cast< const String * >( bytes + header->stringsOffset );
+   for ( UInt32 i = 0; i < header->stringCount; ++i ) {
+      // Strings must be null-terminated
+      if ( strings[ i ].offset >= header->charsSize || strings[ i ].length >= header->charsSize - strings[ i ].offset || bytes[ header->charsOffset + strings[ i ].offset + strings[ i ].length ] != '\0' ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. String ", i, " out of bounds" );
+         return false;
+      }
+   }
+
+   const auto classes = reinterpret_cast< const UInt32 * >( bytes + header->classesOffset );
+   for ( UInt32 i = 0; i < header->classCount; ++i ) {
+      if ( classes[ i ] >= header->stringCount ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unknown class name" );
+         return false;
+      }
+   }
+
+   const auto objects = reinterpret_cast< const Object * >( bytes + header->objectsOffset );
+   for ( UInt32 i = 0; i < header->objectCount; ++i ) {
+      if ( objects[ i ].classId >= header->classCount || objects[ i ].firstField > header->fieldCount || objects[ i ].fieldCount > header->fieldCount - objects[ i ].firstField ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Object ", i, " out of bounds" );
+         return false;
+      }
+   }
+
+   const auto fields = reinterpret_cast< const Field * >( bytes + header->fieldsOffset );
+   for ( UInt32 i = 0; i < header->fieldCount; ++i ) {
+      const auto &field = fields[ i ];
+      const auto valid = field.key < header->stringCount && [ & ] {
+         switch ( field.type ) {
+            case FieldType::DATA:
+               return field.offset <= header->dataSize && field.size <= header->dataSize - field.offset;
+            case FieldType::STRING:
+               return field.offset < header->stringCount;
+            case FieldType::OBJECT:
+               return field.offset < header->objectCount;
+            default:
+               return false;
+         }
+      }();
+      if ( !valid ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Field ", i, " out of bounds" );
+         return false;
+      }
+   }
+
+   const auto roots = reinterpret_cast< const UInt32 * >( bytes + header->rootsOffset );
+   for ( UInt32 i = 0; i < header->rootCount; ++i ) {
+      if ( roots[ i ] >= header->objectCount ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Cannot find object with id ", roots[ i ] );
+         return false;
+      }
+   }
+
+   m_owner = std::move( owner );
+   m_header = header;
+   m_strings = strings;
+   m_chars = reinterpret_cast< const char * >( bytes + header->charsOffset );
+   m_objectTable = objects;
+   m_fields = fields;
+   m_data = bytes + header->dataOffset;
+
+   m_stringIds.clear();
+   m_stringIds.reserve( header->stringCount );
+   for ( UInt32 i = 0; i < header->stringCount; ++i ) {
+      m_stringIds.try_emplace( getString( i ), i );
+   }
+
+   if ( header->version < header->stringCount ) {
+      setVersion( Version( std::string( getString( header->version ) ) ) );
+   }
+
+   // Resolve builders once per class
+   std::vector< ObjectFactory::Builder > builders( header->classCount );
+   for ( UInt32 i = 0; i < header->classCount; ++i ) {
+      const auto className = std::string( getString( classes[ i ] ) );
+      builders[ i ] = ObjectFactory::getInstance()->getBuilder( className );
+      if ( builders[ i ] == nullptr ) {
+         Log::warning( CRIMILD_CURRENT_CLASS_NAME, "Cannot build object of type ", className );
+      }
+   }
+
+   m_objects.resize( header->objectCount );
+   m_decoded.assign( header->objectCount, false );
+   for ( UInt32 i = 0; i < header->objectCount; ++i ) {
+      if ( const auto &builder = builders[ objects[ i ].classId ] ) {
+         m_objects[ i ] = crimild::dynamic_cast_ptr< Codable >( builder() );
+      }
+   }
+
+   for ( UInt32 i = 0; i < header->rootCount; ++i ) {
+      if ( auto obj = m_objects[ roots[ i ] ] ) {
+         addRootObject( crimild::dynamic_cast_ptr< SharedObject >( obj ) );
+      }
+   }
+
+   for ( UInt32 i = 0; i < header->rootCount; ++i ) {
+      decodeObject( roots[ i ] );
+   }
+
+   return true;
+}
+
+void BinaryDecoder::decodeObject( UInt32 id ) noexcept
+{
+   auto obj = m_objects[ id ];
+   if ( obj == nullptr || m_decoded[ id ] ) {
+      return;
+   }
+
+   // Mark object before decoding it, in case of cycles
+   m_decoded[ id ] = true;
+
+   const auto current = m_current;
+   const auto cursor = m_cursor;
+   m_current = id;
+   m_cursor = 0;
+
+   obj->decode( *this );
+
+   m_current = current;
+   m_cursor = cursor;
+}
+
+const binary::Field *BinaryDecoder::findField( std::string_view key ) noexcept
+{
+   UInt32 keyId;
+   if ( !findStringId( key, keyId ) ) {
+      // No field in the file uses this key
+      return nullptr;
+   }
+
+   return findField( keyId );
+}
+
+const binary::Field *BinaryDecoder::findField( UInt32 keyId ) noexcept
+{
+   if ( m_header == nullptr || m_current >= m_header->objectCount ) {
+      return nullptr;
+   }
+
+   const auto &obj = m_objectTable[ m_current ];
+   const auto fields = m_fields + obj.firstField;
+   for ( UInt32 n = 0, i = m_cursor; n < obj.fieldCount; ++n, ++i ) {
+      if ( i >= obj.fieldCount ) {
+         i = 0;
+      }
+      if ( fields[ i ].key == keyId ) {
+         m_cursor = i + 1;
+         return &fields[ i ];
+      }
+   }
+
+   return nullptr;
+}
+
+Bool BinaryDecoder::findData( std::string_view key, Byte *&data, Size &size ) noexcept
+{
+   const auto field = findField( key );
+   if ( field == nullptr || field->type != binary::FieldType::DATA ) {
+      return false;
+   }
+
+   data = m_data + field->offset;
+   size = field->size;
+   return true;
+}
+
+std::string_view BinaryDecoder::getString( UInt32 id ) const noexcept
+{
+   const auto &str = m_strings[ id ];
+   return std::string_view( m_chars + str.offset, str.length );
+}
+
+Bool BinaryDecoder::findStringId( std::string_view str, UInt32 &id ) const noexcept
+{
+   const auto it = m_stringIds.find( str );
+   if ( it == m_stringIds.end() ) {
+      return false;
+   }
+
+   id = it->second;
+   return true;
+}
+
+crimild::Bool BinaryDecoder::decode( std::string key, SharedPointer< coding::Codable > &codable )
+{
+   const auto field = findField( key );
+   if ( field == nullptr || field->type != binary::FieldType::OBJECT ) {
+      codable = nullptr;
+      return false;
+   }
+
+   const auto id = UInt32( field->offset );
+   codable = m_objects[ id ];
+   if ( codable == nullptr ) {
+      return false;
+   }
+
+   decodeObject( id );
+
+   return true;
+}
+
+crimild::Bool BinaryDecoder::decode( std::string key, std::string &value )
+{
+   const auto field = findField( key );
+   if ( field == nullptr || field->type != binary::FieldType::STRING ) {
+      return false;
+   }
+
+   value = std::string( getString( UInt32( field->offset ) ) );
+   return true;
+}
+
+bool BinaryDecoder::decode( std::string_view key, std::vector< std::byte > &value )
+{
+   Byte *data = nullptr;
+   Size size = 0;
+   if ( !findData( key, data, size ) ) {
+      return false;
+   }
+
+   value.resize( size );
+   if ( size > 0 ) {
+      memcpy( value.data(), data, size );
+   }
+   return true;
+}
+
+Bool BinaryDecoder::decodeInPlace( std::string_view key, Byte *&data, Size &size, std::shared_ptr< const void > &owner ) noexcept
+{
+   if ( !findData( key, data, size ) ) {
+      return false;
+   }
+
+   owner = m_owner;
+   return true;
+}
+
+crimild::Size BinaryDecoder::beginDecodingArray( std::string key )
+{
+   crimild::Size count = 0;
+   decode( key + "_size", count );
+   return count;
+}
+
+std::string BinaryDecoder::beginDecodingArrayElement( std::string key, crimild::Size index )
+{
+   return key + "_" + std::to_string( index );
+}
+
+void BinaryDecoder::endDecodingArrayElement( std::string key, crimild::Size index )
+{
+   // no-op
+}
+
+void BinaryDecoder::endDecodingArray( std::string key )
+{
+   // no-op
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/BinaryEncoder.hpp"
+
+#include "BinaryFormat.hpp"
+
+#include <crimild/foundation.hpp>
+#include <cstdio>
+#include <cstring>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+BinaryEncoder::BinaryEncoder( void )
+   : m_current( binary::INVALID_ID )
+{
+}
+
+BinaryEncoder::~BinaryEncoder( void )
+{
+}
+
+crimild::Bool BinaryEncoder::encode( SharedPointer< Codable > const &obj )
+{
+   if ( obj == nullptr ) {
+      return false;
+   }
+
+   if ( m_objectIds.contains( crimild::get_ptr( obj ) ) ) {
+      // Already encoded
+      return true;
+   }
+
+   const auto className = obj->getClassName();
+   if ( !ObjectFactory::getInstance()->hasBuilder( className ) ) {
+      CRIMILD_LOG_WARNING( "Ignoring object with unkown type: ", className );
+      return false;
+   }
+
+   const auto classNameId = intern( className );
+   auto it = m_classIds.find( classNameId );
+   if ( it == m_classIds.end() ) {
+      it = m_classIds.insert( { classNameId, UInt32( m_classes.size() ) } ).first;
+      m_classes.push_back( classNameId );
+   }
+
+   const auto id = UInt32( m_objects.size() );
+   m_objects.push_back( ObjectRecord { it->second } );
+   m_objectIds[ crimild::get_ptr( obj ) ] = id;
+
+   if ( m_current == binary::INVALID_ID ) {
+      m_roots.push_back( id );
+   }
+
+   const auto parent = m_current;
+   m_current = id;
+
+   obj->encode( *this );
+
+   m_current = parent;
+
+   return true;
+}
+
+crimild::Bool BinaryEncoder::encode( std::string key, SharedPointer< Codable > const &obj )
+{
+   if ( obj == nullptr || m_current == binary::INVALID_ID ) {
+      return false;
+   }
+
+   if ( !encode( obj ) ) {
+      return false;
+   }
+
+   return addField(
+      key,
+      binary::Field {
+         .type = binary::FieldType::OBJECT,
+         .offset = m_objectIds[ crimild::get_ptr( obj ) ],
+      }
+   );
+}
+
+crimild::Bool BinaryEncoder::encode( std::string key, std::string value )
+{
+   return addField(
+      key,
+      binary::Field {
+         .type = binary::FieldType::STRING,
+         .offset = intern( value ),
+      }
+   );
+}
+
+void BinaryEncoder::encodeArrayBegin( std::string key, crimild::Size count )
+{
+   encode( key + "_size", count );
+}
+
+std::string BinaryEncoder::beginEncodingArrayElement( std::string key, crimild::Size index )
+{
+   return key + "_" + std::to_string( index );
+}
+
+void BinaryEncoder::endEncodingArrayElement( std::string key, crimild::Size index )
+{
+   // no-op
+}
+
+void BinaryEncoder::encodeArrayEnd( std::string key )
+{
+   // no-op
+}
+
+crimild::Bool BinaryEncoder::encodeBulk( std::string_view key, const void *data, crimild::Size size )
+{
+   return encodeData( key, data, size, binary::BULK_ALIGNMENT );
+}
+
+crimild::Bool BinaryEncoder::encodeData( std::string_view key, const void *data, crimild::Size size, crimild::Size alignment )
+{
+   if ( m_current == binary::INVALID_ID ) {
+      return false;
+   }
+
+   const auto offset = binary::align( m_data.size(), std::max( alignment, binary::VALUE_ALIGNMENT ) );
+   m_data.resize( offset + size );
+   if ( size > 0 ) {
+      memcpy( m_data.data() + offset, data, size );
+   }
+
+   return addField(
+      key,
+      binary::Field {
+         .type = binary::FieldType::DATA,
+         .offset = offset,
+         .size = size,
+      }
+   );
+}
+
+crimild::Bool BinaryEncoder::addField( std::string_view key, const binary::Field &field )
+{
+   if ( m_current == binary::INVALID_ID ) {
+      return false;
+   }
+
+   auto f = field;
+   f.key = intern( key );
+   m_objects[ m_current ].fields.push_back( f );
+   return true;
+}
+
+UInt32 BinaryEncoder::intern( std::string_view str )
+{
+   auto it = m_stringIds.find( std::string( str ) );
+   if ( it != m_stringIds.end() ) {
+      return it->second;
+   }
+
+   const auto id = UInt32( m_strings.size() );
+   it = m_stringIds.insert( { std::string( str ), id } ).first;
+
+   // Keys in unordered maps are never moved, so views remain valid
+   m_strings.push_back( it->first );
+   m_charsSize += str.length() + 1;
+
+   return id;
+}
+
+void BinaryEncoder::emit( const std::function< void( const void *, crimild::Size ) > &out ) const
+{
+   using namespace binary;
+
+   Size fieldCount = 0;
+   for ( const auto &obj : m_objects ) {
+      fieldCount += obj.fields.size();
+   }
+
+   // Version is stored as a string, so it must be interned before computing the layout
+   const auto version = getVersion().getDescription();
+   auto versionId = INVALID_ID;
+   if ( auto it = m_stringIds.find( version ); it != m_stringIds.end() ) {
+      versionId = it->second;
+   }
+   const auto stringCount = m_strings.size() + ( versionId == INVALID_ID ? 1 : 0 );
+   const auto charsSize = m_charsSize + ( versionId == INVALID_ID ? version.length() + 1 : 0 );
+   if ( versionId == INVALID_ID ) {
+      versionId = UInt32( m_strings.size() );
+   }
+
+   Header header;
+   memset( &header, 0, sizeof( Header ) );
+   header.magic = MAGIC;
+   header.formatVersion = FORMAT_VERSION;
+   header.version = versionId;
+   header.stringCount = UInt32( stringCount );
+   header.classCount = UInt32( m_classes.size() );
+   header.objectCount = UInt32( m_objects.size() );
+   header.fieldCount = UInt32( fieldCount );
+   header.rootCount = UInt32( m_roots.size() );
+
+   Size offset = align( sizeof( Header ), SECTION_ALIGNMENT );
+   const auto section = [ & ]( Size size ) {
+      const auto ret = offset;
+      offset = align( offset + size, SECTION_ALIGNMENT );
+      return UInt64( ret );
+   };
+   header.stringsOffset = section( stringCount * sizeof( String ) );
+   header.charsOffset = section( charsSize );
+   header.charsSize = charsSize;
+   header.classesOffset = section( m_classes.size() * sizeof( UInt32 ) );
+   header.objectsOffset = section( m_objects.size() * sizeof( Object ) );
+   header.fieldsOffset = section( fieldCount * sizeof( Field ) );
+   header.rootsOffset = section( m_roots.size() * sizeof( UInt32 ) );
+   header.dataOffset = section( m_data.size() );
+   header.dataSize = m_data.size();
+
+   Size written = 0;
+   const auto write = [ & ]( const void *data, Size size ) {
+      if ( size > 0 ) {
+         out( data, size );
+         written += size;
+      }
+   };
+   const Byte padding[ SECTION_ALIGNMENT ] = { 0 };
+   const auto pad = [ & ] {
+      write( padding, align( written, SECTION_ALIGNMENT ) - written );
+   };
+
+   write( &header, sizeof( Header ) );
+   pad();
+
+   // Strings
+   {
+      Size charsOffset = 0;
+      const auto writeString = [ & ]( std::string_view str ) {
+         const auto entry = String { charsOffset, str.length() };
+         write( &entry, sizeof( String ) );
+         charsOffset += str.length() + 1;
+      };
+      for ( const auto &str : m_strings ) {
+         writeString( str );
+      }
+      if ( stringCount > m_strings.size() ) {
+         writeString( version );
+      }
+      pad();
+
+      const char terminator = '\0';
+      const auto writeChars = [ & ]( std::string_view str ) {
+         write( str.data(), str.length() );
+         write( &terminator, 1 );
+      };
+      for ( const auto &str : m_strings ) {
+         writeChars( str );
+      }
+      if ( stringCount > m_strings.size() ) {
+         writeChars( version );
+      }
+      pad();
+   }
+
+   write( m_classes.data(), m_classes.size() * sizeof( UInt32 ) );
+   pad();
+
+   // Objects
+   {
+      UInt32 firstField = 0;
+      for ( const auto &obj : m_objects ) {
+         const auto entry = Object {
+            .classId = obj.classId,
+            .firstField = firstField,
+            .fieldCount = UInt32( obj.fields.size() ),
+            .reserved = 0,
+         };
+         write( &entry, sizeof( Object ) );
+         firstField += entry.fieldCount;
+      }
+      pad();
+
+      for ( const auto &obj : m_objects ) {
+         write( obj.fields.data(), obj.fields.size() * sizeof( Field ) );
+      }
+      pad();
+   }
+
+   write( m_roots.data(), m_roots.size() * sizeof( UInt32 ) );
+   pad();
+
+   write( m_data.data(), m_data.size() );
+   pad();
+}
+
+ByteArray BinaryEncoder::getBytes( void ) const
+{
+   std::vector< Byte > bytes;
+   emit(
+      [ & ]( const void *data, Size size ) {
+         const auto src = static_cast< const Byte * >( data );
+         bytes.insert( bytes.end(), src, src + size );
+      }
+   );
+   return ByteArray( bytes.size(), bytes.data() );
+}
+
+Bool BinaryEncoder::write( const std::filesystem::path &path ) const noexcept
+{
+   FILE *file = fopen( path.string().c_str(), "wb" );
+   if ( file == nullptr ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot open file ", path.string() );
+      return false;
+   }
+
+   Bool success = true;
+   emit(
+      [ & ]( const void *data, Size size ) {
+         success = success && fwrite( data, 1, size, file ) == size;
+      }
+   );
+
+   fclose( file );
+
+   if ( !success ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot write file ", path.string() );
+   }
+
+   return success;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_CORE_CODING_BINARY_FORMAT_
+#define CRIMILD_CORE_CODING_BINARY_FORMAT_
+
+#include <crimild/foundation/common/Types.hpp>
+
+namespace crimild {
+
+   namespace coding {
+
+      /**
+         \brief Layout of files written by BinaryEncoder
+
+         A file is a header followed by flat tables, each one starting at an
+         aligned offset:
+         - strings: offsets into a blob of null-terminated characters. Keys,
+           class names and string values are stored only once.
+         - classes: string ids of class names, so builders are resolved once
+           per class instead of once per object.
+         - objects: class id and range of fields for each object.
+         - fields: key (string id), type and payload for each encoded value.
+           Fields are stored in the order they were encoded.
+         - roots: object ids of root objects.
+         - data: payloads of value fields, aligned so they can be used in place.
+
+         Section offsets are relative to the beginning of the file. String and
+         field offsets are relative to the characters and data sections. Values
+         are stored in native byte order.
+       */
+      namespace binary {
+
+         // 'CRBN'
+         static constexpr UInt32 MAGIC = 0x4e425243;
+
+         static constexpr UInt32 FORMAT_VERSION = 1;
+
+         static constexpr Size SECTION_ALIGNMENT = 16;
+
+         /**
+            \brief Alignment for large payloads, like arrays and byte buffers
+          */
+         static constexpr Size BULK_ALIGNMENT = 16;
+
+         /**
+            \brief Alignment for single values
+          */
+         static constexpr Size VALUE_ALIGNMENT = 8;
+
+         static constexpr UInt32 INVALID_ID = ~UInt32( 0 );
+
+         struct Header {
+            UInt32 magic;
+            UInt32 formatVersion;
+            UInt32 version;
+            UInt32 stringCount;
+            UInt32 classCount;
+            UInt32 objectCount;
+            UInt32 fieldCount;
+            UInt32 rootCount;
+            UInt64 stringsOffset;
+            UInt64 charsOffset;
+            UInt64 charsSize;
+            UInt64 classesOffset;
+            UInt64 objectsOffset;
+            UInt64 fieldsOffset;
+            UInt64 rootsOffset;
+            UInt64 dataOffset;
+            UInt64 dataSize;
+         };
+
+         struct String {
+            UInt64 offset;
+            UInt64 length;
+         };
+
+         struct Object {
+            UInt32 classId;
+            UInt32 firstField;
+            UInt32 fieldCount;
+            UInt32 reserved;
+         };
+
+         enum class FieldType : UInt32 {
+            /**
+               \brief Payload is stored in the data section
+             */
+            DATA,
+
+            /**
+               \brief Payload is a string id
+             */
+            STRING,
+
+            /**
+               \brief Payload is an object id
+             */
+            OBJECT,
+         };
+
+         struct Field {
+            UInt32 key;
+            FieldType type;
+            UInt64 offset;
+            UInt64 size;
+         };
+
+         inline constexpr Size align( Size value, Size alignment ) noexcept
+         {
+            return ( value + alignment - 1 ) & ~( alignment - 1 );
+         }
+
+      }
+
+   }
+
+}
+
+#endif
@@ -30,8 +30,11 @@
 #include "Tags.hpp"
 #include "crimild/coding/EncodedData.hpp"
 
+#include <algorithm>
 #include <crimild/foundation.hpp>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 using namespace crimild;
 using namespace crimild::coding;
@@ -40,17 +43,28 @@ MemoryDecoder::MemoryDecoder( void )
 {
 }
 
+MemoryDecoder::MemoryDecoder( const MemoryDecoder *source )
+   : _source( source )
+{
+   setVersion( source->getVersion() );
+}
+
 MemoryDecoder::~MemoryDecoder( void )
 {
 }
 
 crimild::Bool MemoryDecoder::decode( std::string key, SharedPointer< coding::Codable > &codable )
 {
-   codable = _links[ _currentObj->getUniqueID() ][ key ];
+   codable = getLink( key );
    if ( codable == nullptr ) {
       return false;
    }
 
+   if ( _source != this ) {
+      // Decoding in parallel. Linked objects have been decoded already
+      return true;
+   }
+
    auto temp = _currentObj;
    _currentObj = codable;
 
@@ -70,7 +84,10 @@ crimild::Bool MemoryDecoder::decode( std::string key, std::string &value )
    }
 
    if ( l > 0 ) {
-      auto obj = crimild::cast_ptr< EncodedData >( _links[ _currentObj->getUniqueID() ][ key ] );
+      auto obj = crimild::cast_ptr< EncodedData >( getLink( key ) );
+      if ( obj == nullptr ) {
+         return false;
+      }
 
       ByteArray data( l + 1 );
       memcpy( &data[ 0 ], obj->getBytes().getData(), l );
@@ -206,6 +223,11 @@ crimild::Bool MemoryDecoder::fromBytes( const ByteArray &bytes )
       }
    }
 
+   if ( _parallelFor != nullptr ) {
+      decodeInParallel();
+      return true;
+   }
+
    auto rootCount = getObjectCount();
    for ( crimild::Size i = 0; i < rootCount; i++ ) {
       auto obj = crimild::dynamic_cast_ptr< Codable >( getObjectAt< SharedObject >( i ) );
@@ -217,6 +239,87 @@ crimild::Bool MemoryDecoder::fromBytes( const ByteArray &bytes )
    return true;
 }
 
+SharedPointer< Codable > MemoryDecoder::getLink( const std::string &key ) const noexcept
+{
+   if ( _currentObj == nullptr ) {
+      return nullptr;
+   }
+
+   // Lookups must not modify the maps, since they might be shared by several threads
+   const auto &links = _source->_links;
+   const auto id = _currentObj->getUniqueID();
+   if ( !links.contains( id ) ) {
+      return nullptr;
+   }
+
+   const auto &objLinks = links[ id ];
+   return objLinks.contains( key ) ? objLinks[ key ] : nullptr;
+}
+
+void MemoryDecoder::decodeInParallel( void )
+{
+   // Group objects by their distance to leaves (objects with no links), so
+   // each object is decoded after all the objects it references.
+   constexpr auto VISITING = crimild::Size( -1 );
+   std::unordered_map< const Codable *, crimild::Size > levels;
+   std::vector< std::vector< SharedPointer< Codable > > > groups;
+
+   std::function< crimild::Size( const SharedPointer< Codable > & ) > visit = [ & ]( const SharedPointer< Codable > &obj ) -> crimild::Size {
+      auto it = levels.find( crimild::get_ptr( obj ) );
+      if ( it != levels.end() ) {
+         return it->second;
+      }
+
+      levels[ crimild::get_ptr( obj ) ] = VISITING;
+
+      crimild::Size level = 0;
+      const auto id = obj->getUniqueID();
+      if ( _links.contains( id ) ) {
+         _links[ id ].eachValue( [ & ]( const SharedPointer< Codable > &child ) {
+            if ( child == nullptr || crimild::dynamic_cast_ptr< EncodedData >( child ) != nullptr ) {
+               // Values are not decoded on their own
+               return;
+            }
+
+            const auto childLevel = visit( child );
+            if ( childLevel != VISITING ) {
+               // Cycles are ignored
+               level = std::max( level, childLevel + 1 );
+            }
+         } );
+      }
+
+      levels[ crimild::get_ptr( obj ) ] = level;
+      if ( groups.size() <= level ) {
+         groups.resize( level + 1 );
+      }
+      groups[ level ].push_back( obj );
+
+      return level;
+   };
+
+   const auto rootCount = getObjectCount();
+   for ( crimild::Size i = 0; i < rootCount; i++ ) {
+      if ( auto obj = crimild::dynamic_cast_ptr< Codable >( getObjectAt< SharedObject >( i ) ) ) {
+         visit( obj );
+      }
+   }
+
+   for ( const auto &group : groups ) {
+      _parallelFor(
+         group.size(),
+         [ this, &group ]( crimild::Size begin, crimild::Size end ) {
+            MemoryDecoder decoder( this );
+            for ( auto i = begin; i < end; ++i ) {
+               decoder._currentObj = group[ i ];
+               group[ i ]->decode( decoder );
+            }
+            decoder._currentObj = nullptr;
+         }
+      );
+   }
+}
+
 crimild::Size MemoryDecoder::read( const ByteArray &bytes, Codable::UniqueID &value, crimild::Size offset )
 {
    return readRawBytes( bytes, &value, sizeof( Codable::UniqueID ), offset );
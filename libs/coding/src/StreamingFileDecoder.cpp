@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/StreamingFileDecoder.hpp"
+
+#include "Tags.hpp"
+#include "crimild/coding/EncodedData.hpp"
+
+#include <crimild/foundation.hpp>
+#include <cstring>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+StreamingFileDecoder::StreamingFileDecoder( void )
+   : m_buffer( BUFFER_SIZE )
+{
+}
+
+StreamingFileDecoder::~StreamingFileDecoder( void )
+{
+}
+
+Bool StreamingFileDecoder::read( const std::filesystem::path &path ) noexcept
+{
+   std::error_code ec;
+   const auto fileSize = std::filesystem::file_size( path, ec );
+   if ( ec ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot open file ", path.string() );
+      return false;
+   }
+
+   // Buffer must be set before opening the file
+   m_in.rdbuf()->pubsetbuf( m_buffer.data(), m_buffer.size() );
+   m_in.open( path, std::ios::binary );
+   if ( !m_in.is_open() ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot open file ", path.string() );
+      return false;
+   }
+
+   m_position = 0;
+   m_end = fileSize;
+
+   auto ret = scan();
+   if ( ret ) {
+      for ( const auto id : m_roots ) {
+         auto it = m_objects.find( id );
+         if ( it == m_objects.end() || it->second == nullptr ) {
+            Log::warning( CRIMILD_CURRENT_CLASS_NAME, "Cannot find root object with id ", id );
+            continue;
+         }
+         addRootObject( crimild::dynamic_cast_ptr< SharedObject >( it->second ) );
+      }
+
+      for ( const auto id : m_roots ) {
+         auto it = m_objects.find( id );
+         if ( it != m_objects.end() && it->second != nullptr ) {
+            decodeObject( id, it->second );
+         }
+      }
+   }
+
+   m_in.close();
+
+   // Objects are owned by their parents (or the root list) from now on
+   m_objects.clear();
+   m_payloads.clear();
+   m_links.clear();
+   m_decoded.clear();
+   m_roots.clear();
+
+   return ret;
+}
+
+crimild::Bool StreamingFileDecoder::scan( void )
+{
+   crimild::Size size = 0;
+   if ( !readRawBytes( &size, sizeof( crimild::Size ) ) || size > m_end - m_position ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format" );
+      return false;
+   }
+   m_end = m_position + size;
+
+   crimild::Int8 flag;
+   if ( !read( flag ) || flag != Tags::TAG_DATA_START ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format" );
+      return false;
+   }
+
+   std::string versionStr;
+   if ( !read( flag ) || flag != Tags::TAG_DATA_VERSION || !read( versionStr ) ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. FLAG_VERSION expected" );
+      return false;
+   }
+   setVersion( Version( versionStr ) );
+
+   std::string className;
+   std::string linkName;
+
+   while ( true ) {
+      if ( !read( flag ) ) {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unexpected end of file" );
+         return false;
+      }
+
+      if ( flag == Tags::TAG_DATA_END ) {
+         break;
+      }
+
+      if ( flag == Tags::TAG_OBJECT_BEGIN ) {
+         Codable::UniqueID objID;
+         if ( !read( objID ) || !read( className ) ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unexpected end of file" );
+            return false;
+         }
+
+         if ( className == EncodedData::__CLASS_NAME ) {
+            // Only remember where values are. They're read when decoded
+            crimild::Size count = 0;
+            if ( !readRawBytes( &count, sizeof( crimild::Size ) ) || !skip( count ) ) {
+               Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unexpected end of file" );
+               return false;
+            }
+            m_payloads[ objID ] = Payload { m_position - count, count };
+         } else if ( auto obj = crimild::dynamic_cast_ptr< Codable >( ObjectFactory::getInstance()->build( className ) ) ) {
+            m_objects[ objID ] = obj;
+         } else {
+            Log::warning( CRIMILD_CURRENT_CLASS_NAME, "Cannot build object of type ", className );
+         }
+
+         if ( !read( flag ) || flag != Tags::TAG_OBJECT_END ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Expected ", Tags::TAG_OBJECT_END );
+            return false;
+         }
+      } else if ( flag == Tags::TAG_LINK_BEGIN ) {
+         Codable::UniqueID parentObjID;
+         Codable::UniqueID objID;
+         if ( !read( parentObjID ) || !read( linkName ) || !read( objID ) ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unexpected end of file" );
+            return false;
+         }
+
+         // Objects might not have been read yet, so links are resolved when decoding
+         m_links[ parentObjID ][ linkName ] = objID;
+
+         if ( !read( flag ) || flag != Tags::TAG_LINK_END ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Expected ", Tags::TAG_LINK_END );
+            return false;
+         }
+      } else if ( flag == Tags::TAG_ROOT_OBJECT_BEGIN ) {
+         Codable::UniqueID objID;
+         if ( !read( objID ) ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Unexpected end of file" );
+            return false;
+         }
+
+         m_roots.push_back( objID );
+
+         if ( !read( flag ) || flag != Tags::TAG_ROOT_OBJECT_END ) {
+            Log::error( CRIMILD_CURRENT_CLASS_NAME, "Invalid data format. Expected ", Tags::TAG_ROOT_OBJECT_END );
+            return false;
+         }
+      } else {
+         Log::error( CRIMILD_CURRENT_CLASS_NAME, "Unknown flag ", flag );
+         return false;
+      }
+   }
+
+   return true;
+}
+
+void StreamingFileDecoder::decodeObject( Codable::UniqueID id, const SharedPointer< Codable > &obj )
+{
+   if ( !m_decoded.insert( id ).second ) {
+      // Shared objects are decoded only once
+      return;
+   }
+
+   const auto temp = m_current;
+   m_current = id;
+
+   obj->decode( *this );
+
+   m_current = temp;
+}
+
+crimild::Bool StreamingFileDecoder::decode( std::string key, SharedPointer< coding::Codable > &codable )
+{
+   codable = nullptr;
+
+   auto links = m_links.find( m_current );
+   if ( links == m_links.end() ) {
+      return false;
+   }
+
+   auto link = links->second.find( key );
+   if ( link == links->second.end() ) {
+      return false;
+   }
+
+   auto it = m_objects.find( link->second );
+   if ( it == m_objects.end() || it->second == nullptr ) {
+      return false;
+   }
+
+   codable = it->second;
+   decodeObject( link->second, codable );
+
+   return true;
+}
+
+crimild::Bool StreamingFileDecoder::decode( std::string key, std::string &value )
+{
+   crimild::Size l = 0;
+   if ( !decode( key + "_length", l ) ) {
+      return false;
+   }
+
+   if ( l > 0 ) {
+      auto payload = findPayload( key );
+      if ( payload == nullptr ) {
+         return false;
+      }
+
+      value.resize( std::min( l, payload->size ) );
+      if ( !readAt( payload->offset, value.data(), value.size() ) ) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool StreamingFileDecoder::decode( std::string_view key, std::vector< std::byte > &value )
+{
+   auto payload = findPayload( key );
+   if ( payload == nullptr ) {
+      return false;
+   }
+
+   value.resize( payload->size );
+   return value.empty() || readAt( payload->offset, value.data(), value.size() );
+}
+
+crimild::Size StreamingFileDecoder::beginDecodingArray( std::string key )
+{
+   crimild::Size count = 0;
+   decode( key + "_size", count );
+   return count;
+}
+
+std::string StreamingFileDecoder::beginDecodingArrayElement( std::string key, crimild::Size index )
+{
+   return key + "_" + std::to_string( index );
+}
+
+void StreamingFileDecoder::endDecodingArrayElement( std::string key, crimild::Size index )
+{
+   // no-op
+}
+
+void StreamingFileDecoder::endDecodingArray( std::string key )
+{
+   // no-op
+}
+
+const StreamingFileDecoder::Payload *StreamingFileDecoder::findPayload( std::string_view key ) const noexcept
+{
+   auto links = m_links.find( m_current );
+   if ( links == m_links.end() ) {
+      return nullptr;
+   }
+
+   auto link = links->second.find( std::string( key ) );
+   if ( link == links->second.end() ) {
+      return nullptr;
+   }
+
+   auto it = m_payloads.find( link->second );
+   return it != m_payloads.end() ? &it->second : nullptr;
+}
+
+crimild::Bool StreamingFileDecoder::read( crimild::Int8 &tag )
+{
+   return readRawBytes( &tag, sizeof( crimild::Int8 ) );
+}
+
+crimild::Bool StreamingFileDecoder::read( Codable::UniqueID &id )
+{
+   return readRawBytes( &id, sizeof( Codable::UniqueID ) );
+}
+
+crimild::Bool StreamingFileDecoder::read( std::string &str )
+{
+   // Strings are stored as byte arrays, including the null-terminator
+   crimild::Size count = 0;
+   if ( !readRawBytes( &count, sizeof( crimild::Size ) ) || count > m_end - m_position ) {
+      return false;
+   }
+
+   str.resize( count );
+   if ( !readRawBytes( str.data(), count ) ) {
+      return false;
+   }
+
+   str.resize( std::strlen( str.c_str() ) );
+   return true;
+}
+
+crimild::Bool StreamingFileDecoder::readRawBytes( void *data, crimild::Size size )
+{
+   if ( size > m_end - m_position ) {
+      return false;
+   }
+
+   m_in.read( static_cast< char * >( data ), std::streamsize( size ) );
+   if ( !m_in ) {
+      return false;
+   }
+
+   m_position += size;
+   return true;
+}
+
+crimild::Bool StreamingFileDecoder::readAt( crimild::Size offset, void *data, crimild::Size size )
+{
+   return seek( offset ) && readRawBytes( data, size );
+}
+
+crimild::Bool StreamingFileDecoder::skip( crimild::Size size )
+{
+   if ( size > m_end - m_position ) {
+      return false;
+   }
+
+   return seek( m_position + size );
+}
+
+crimild::Bool StreamingFileDecoder::seek( crimild::Size offset )
+{
+   if ( offset == m_position ) {
+      return true;
+   }
+
+   if ( offset > m_position && offset - m_position <= BUFFER_SIZE ) {
+      // Values are usually decoded in the same order they were written, with
+      // only a few tags in between. Skipping them keeps reading from the buffer,
+      // while seeking would discard it.
+      m_in.ignore( std::streamsize( offset - m_position ) );
+   } else {
+      m_in.seekg( std::streamoff( offset ) );
+   }
+
+   m_position = offset;
+   return bool( m_in );
+}
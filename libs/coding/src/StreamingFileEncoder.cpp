@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/StreamingFileEncoder.hpp"
+
+#include "Tags.hpp"
+#include "crimild/coding/EncodedData.hpp"
+
+#include <crimild/foundation.hpp>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+StreamingFileEncoder::StreamingFileEncoder( void )
+   : m_buffer( BUFFER_SIZE )
+{
+}
+
+StreamingFileEncoder::~StreamingFileEncoder( void )
+{
+   if ( isOpen() ) {
+      close();
+   }
+}
+
+Bool StreamingFileEncoder::open( const std::filesystem::path &path ) noexcept
+{
+   if ( isOpen() ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "File already open" );
+      return false;
+   }
+
+   // Buffer must be set before opening the file
+   m_out.rdbuf()->pubsetbuf( m_buffer.data(), m_buffer.size() );
+   m_out.open( path, std::ios::binary | std::ios::trunc );
+   if ( !m_out.is_open() ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot open file ", path.string() );
+      return false;
+   }
+
+   m_size = 0;
+   m_written.clear();
+   m_roots.clear();
+   m_parent = nullptr;
+   m_nextDataID = 1;
+
+   // Total size is not known yet. It's updated when closing the file
+   m_out.write( reinterpret_cast< const char * >( &m_size ), sizeof( crimild::Size ) );
+
+   write( Tags::TAG_DATA_START );
+   write( Tags::TAG_DATA_VERSION );
+   write( getVersion().getDescription() );
+
+   return m_out.good();
+}
+
+Bool StreamingFileEncoder::close( void ) noexcept
+{
+   if ( !isOpen() ) {
+      return false;
+   }
+
+   for ( const auto id : m_roots ) {
+      write( Tags::TAG_ROOT_OBJECT_BEGIN );
+      write( id );
+      write( Tags::TAG_ROOT_OBJECT_END );
+   }
+
+   write( Tags::TAG_DATA_END );
+
+   m_out.seekp( 0 );
+   m_out.write( reinterpret_cast< const char * >( &m_size ), sizeof( crimild::Size ) );
+   m_out.flush();
+
+   const auto ret = m_out.good();
+   if ( !ret ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Failed to write file" );
+   }
+
+   m_out.close();
+   m_written.clear();
+   m_roots.clear();
+
+   return ret;
+}
+
+crimild::Bool StreamingFileEncoder::encode( SharedPointer< Codable > const &obj )
+{
+   if ( !isOpen() ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "File must be opened before encoding objects" );
+      return false;
+   }
+
+   if ( obj == nullptr ) {
+      return false;
+   }
+
+   if ( !ObjectFactory::getInstance()->hasBuilder( obj->getClassName() ) ) {
+      CRIMILD_LOG_WARNING( "Ignoring object with unknown type: ", obj->getClassName() );
+      return false;
+   }
+
+   const auto id = obj->getUniqueID();
+   if ( !m_written.insert( id ).second ) {
+      // Already written. Only a link is needed
+      return true;
+   }
+
+   if ( m_parent == nullptr ) {
+      m_roots.push_back( id );
+   }
+
+   if ( auto data = crimild::dynamic_cast_ptr< EncodedData >( obj ) ) {
+      writeObject( id, obj->getClassName(), data->getBytes().getData(), data->getBytes().size(), true );
+      return true;
+   }
+
+   writeObject( id, obj->getClassName(), nullptr, 0, false );
+
+   auto temp = m_parent;
+   m_parent = crimild::get_ptr( obj );
+
+   obj->encode( *this );
+
+   m_parent = temp;
+
+   return true;
+}
+
+crimild::Bool StreamingFileEncoder::encode( std::string key, SharedPointer< Codable > const &obj )
+{
+   if ( obj == nullptr ) {
+      return false;
+   }
+
+   if ( !ObjectFactory::getInstance()->hasBuilder( obj->getClassName() ) ) {
+      CRIMILD_LOG_WARNING( "Ignoring object with unknown type: ", obj->getClassName(), " (", key, ")" );
+      return false;
+   }
+
+   if ( m_parent == nullptr ) {
+      Log::error( CRIMILD_CURRENT_CLASS_NAME, "Cannot encode ", key, " without a parent object" );
+      return false;
+   }
+
+   const auto parentID = m_parent->getUniqueID();
+   if ( !encode( obj ) ) {
+      return false;
+   }
+
+   // Links are written after both objects, as expected by decoders
+   writeLink( parentID, key, obj->getUniqueID() );
+   return true;
+}
+
+crimild::Bool StreamingFileEncoder::encode( std::string key, std::string value )
+{
+   crimild::Size L = value.length();
+   encode( key + "_length", L );
+
+   // Include null-terminator, like EncodedData does
+   return encodeData( key, value.c_str(), value.length() + 1 );
+}
+
+void StreamingFileEncoder::encodeArrayBegin( std::string key, crimild::Size count )
+{
+   encode( key + "_size", count );
+}
+
+std::string StreamingFileEncoder::beginEncodingArrayElement( std::string key, crimild::Size index )
+{
+   return key + "_" + std::to_string( index );
+}
+
+void StreamingFileEncoder::endEncodingArrayElement( std::string key, crimild::Size index )
+{
+   // no-op
+}
+
+void StreamingFileEncoder::encodeArrayEnd( std::string key )
+{
+   // no-op
+}
+
+crimild::Bool StreamingFileEncoder::encodeData( std::string_view key, const void *data, crimild::Size size )
+{
+   if ( !isOpen() || m_parent == nullptr ) {
+      return false;
+   }
+
+   // Objects are aligned in memory, so their ids are always even
+   const auto id = m_nextDataID;
+   m_nextDataID += 2;
+
+   writeObject( id, EncodedData::__CLASS_NAME, data, size, true );
+   writeLink( m_parent->getUniqueID(), key, id );
+
+   return true;
+}
+
+void StreamingFileEncoder::writeObject( Codable::UniqueID id, std::string_view className, const void *data, crimild::Size size, crimild::Bool hasData )
+{
+   write( Tags::TAG_OBJECT_BEGIN );
+   write( id );
+   write( className );
+   if ( hasData ) {
+      write( data, size );
+   }
+   write( Tags::TAG_OBJECT_END );
+}
+
+void StreamingFileEncoder::writeLink( Codable::UniqueID parent, std::string_view key, Codable::UniqueID child )
+{
+   write( Tags::TAG_LINK_BEGIN );
+   write( parent );
+   write( key );
+   write( child );
+   write( Tags::TAG_LINK_END );
+}
+
+void StreamingFileEncoder::write( crimild::Int8 tag )
+{
+   writeRawBytes( &tag, sizeof( crimild::Int8 ) );
+}
+
+void StreamingFileEncoder::write( Codable::UniqueID id )
+{
+   writeRawBytes( &id, sizeof( Codable::UniqueID ) );
+}
+
+void StreamingFileEncoder::write( std::string_view str )
+{
+   // Strings are stored as byte arrays, including the null-terminator
+   const crimild::Size count = str.length() + 1;
+   const char terminator = '\0';
+   writeRawBytes( &count, sizeof( crimild::Size ) );
+   writeRawBytes( str.data(), str.length() );
+   writeRawBytes( &terminator, 1 );
+}
+
+void StreamingFileEncoder::write( const void *data, crimild::Size size )
+{
+   writeRawBytes( &size, sizeof( crimild::Size ) );
+   writeRawBytes( data, size );
+}
+
+void StreamingFileEncoder::writeRawBytes( const void *data, crimild::Size size )
+{
+   if ( size == 0 ) {
+      return;
+   }
+   m_out.write( static_cast< const char * >( data ), std::streamsize( size ) );
+   m_size += size;
+}
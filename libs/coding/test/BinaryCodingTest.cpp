@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/BinaryDecoder.hpp"
+#include "crimild/coding/BinaryEncoder.hpp"
+
+#include "BinaryFormat.hpp"
+
+#include <crimild/math/translation.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+namespace crimild::coding::test {
+
+   class BinaryTestObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::BinaryTestObject )
+
+   public:
+      std::string name;
+      Int32 value = 0;
+      Transformation local;
+      Array< UInt32 > values;
+      Array< Vector3f > positions;
+      ByteArray bytes;
+      Array< SharedPointer< BinaryTestObject > > children;
+      SharedPointer< BinaryTestObject > other;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         Codable::encode( encoder );
+
+         encoder.encode( "name", name );
+         encoder.encode( "value", value );
+         encoder.encode( "local", local );
+         encoder.encode( "values", values );
+         encoder.encode( "positions", positions );
+         encoder.encode( "bytes", bytes );
+         encoder.encode( "children", children );
+         encoder.encode( "other", other );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         Codable::decode( decoder );
+
+         decoder.decode( "name", name );
+         decoder.decode( "value", value );
+         decoder.decode( "local", local );
+         decoder.decode( "values", values );
+         decoder.decode( "positions", positions );
+         decoder.decode( "bytes", bytes );
+         decoder.decode( "children", children );
+         decoder.decode( "other", other );
+      }
+   };
+
+   /**
+      \brief Decodes fields in a different order than they were encoded
+    */
+   class ReversedTestObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::ReversedTestObject )
+
+   public:
+      Int32 a = 0;
+      Real32 b = 0;
+      std::string c;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         encoder.encode( "a", a );
+         encoder.encode( "b", b );
+         encoder.encode( "c", c );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         decoder.decode( "c", c );
+         decoder.decode( "b", b );
+         decoder.decode( "a", a );
+      }
+   };
+
+   /**
+      \brief Decodes keys that are not fields of the object
+    */
+   class MissingFieldsTestObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::MissingFieldsTestObject )
+
+   public:
+      std::string a;
+      Bool foundValueAsKey = true;
+      Bool foundUnknownKey = true;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         encoder.encode( "a", a );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         // "b" is encoded as the value of "a", so it's in the string table, but it's not a key
+         std::string str;
+         foundValueAsKey = decoder.decode( "b", str );
+         foundUnknownKey = decoder.decode( "z", str );
+         decoder.decode( "a", a );
+      }
+   };
+
+   /**
+      \brief References encoded bytes in place, like render buffers do
+    */
+   class InPlaceTestObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::InPlaceTestObject )
+
+   public:
+      ByteArray bytes;
+      Byte *data = nullptr;
+      Size size = 0;
+      std::shared_ptr< const void > owner;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         encoder.encode( "data", bytes );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         decoder.decodeInPlace( "data", data, size, owner );
+      }
+   };
+
+   static void registerBuilders( void )
+   {
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::BinaryTestObject )
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::ReversedTestObject )
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::InPlaceTestObject )
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::MissingFieldsTestObject )
+   }
+
+   static SharedPointer< BinaryTestObject > createScene( void )
+   {
+      auto root = crimild::alloc< BinaryTestObject >();
+      root->name = "a scene";
+      root->value = 42;
+      root->local = translation( 10, 20, 30 );
+      root->values = { 1, 2, 3, 4, 5 };
+      root->positions = { Vector3f { 1, 2, 3 }, Vector3f { 4, 5, 6 } };
+      root->bytes = { 0xca, 0xfe };
+
+      for ( auto i = 0; i < 3; ++i ) {
+         auto child = crimild::alloc< BinaryTestObject >();
+         child->name = "child " + std::to_string( i );
+         child->value = i;
+         root->children.add( child );
+      }
+
+      // Shared reference
+      root->other = root->children[ 1 ];
+
+      return root;
+   }
+
+   static void expectEqual( const SharedPointer< BinaryTestObject > &expected, const SharedPointer< BinaryTestObject > &decoded )
+   {
+      ASSERT_NE( nullptr, decoded );
+      EXPECT_EQ( expected->name, decoded->name );
+      EXPECT_EQ( expected->value, decoded->value );
+      EXPECT_EQ( expected->local, decoded->local );
+      EXPECT_EQ( expected->values, decoded->values );
+      EXPECT_EQ( expected->positions, decoded->positions );
+      EXPECT_EQ( expected->bytes, decoded->bytes );
+
+      ASSERT_EQ( expected->children.size(), decoded->children.size() );
+      for ( Size i = 0; i < expected->children.size(); ++i ) {
+         EXPECT_EQ( expected->children[ i ]->name, decoded->children[ i ]->name );
+         EXPECT_EQ( expected->children[ i ]->value, decoded->children[ i ]->value );
+      }
+   }
+
+}
+
+TEST( BinaryCoding, empty )
+{
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   const auto bytes = encoder->getBytes();
+   ASSERT_FALSE( bytes.empty() );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   EXPECT_TRUE( decoder->fromBytes( bytes ) );
+   EXPECT_EQ( 0, decoder->getObjectCount() );
+   EXPECT_EQ( encoder->getVersion().getDescription(), decoder->getVersion().getDescription() );
+}
+
+TEST( BinaryCoding, fromBytes )
+{
+   test::registerBuilders();
+
+   auto scene = test::createScene();
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( scene ) );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   ASSERT_TRUE( decoder->fromBytes( encoder->getBytes() ) );
+   ASSERT_EQ( 1, decoder->getObjectCount() );
+
+   test::expectEqual( scene, decoder->getObjectAt< test::BinaryTestObject >( 0 ) );
+}
+
+TEST( BinaryCoding, readFile )
+{
+   test::registerBuilders();
+
+   const auto path = std::filesystem::temp_directory_path() / "crimild_binary_coding_test.crimild";
+
+   auto scene = test::createScene();
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( scene ) );
+   ASSERT_TRUE( encoder->write( path ) );
+   EXPECT_EQ( encoder->getBytes().size(), std::filesystem::file_size( path ) );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   ASSERT_TRUE( decoder->read( path ) );
+   ASSERT_EQ( 1, decoder->getObjectCount() );
+
+   test::expectEqual( scene, decoder->getObjectAt< test::BinaryTestObject >( 0 ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( BinaryCoding, sharedObjectsAreDecodedOnce )
+{
+   test::registerBuilders();
+
+   auto scene = test::createScene();
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( scene ) );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   ASSERT_TRUE( decoder->fromBytes( encoder->getBytes() ) );
+
+   auto decoded = decoder->getObjectAt< test::BinaryTestObject >( 0 );
+   ASSERT_NE( nullptr, decoded );
+   ASSERT_NE( nullptr, decoded->other );
+   EXPECT_EQ( decoded->children[ 1 ], decoded->other );
+}
+
+TEST( BinaryCoding, fieldsInAnyOrder )
+{
+   test::registerBuilders();
+
+   auto obj = crimild::alloc< test::ReversedTestObject >();
+   obj->a = 1;
+   obj->b = 2.5f;
+   obj->c = "three";
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( obj ) );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   ASSERT_TRUE( decoder->fromBytes( encoder->getBytes() ) );
+
+   auto decoded = decoder->getObjectAt< test::ReversedTestObject >( 0 );
+   ASSERT_NE( nullptr, decoded );
+   EXPECT_EQ( 1, decoded->a );
+   EXPECT_EQ( 2.5f, decoded->b );
+   EXPECT_EQ( "three", decoded->c );
+}
+
+TEST( BinaryCoding, missingFields )
+{
+   test::registerBuilders();
+
+   auto obj = crimild::alloc< test::MissingFieldsTestObject >();
+   obj->a = "b";
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( obj ) );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   ASSERT_TRUE( decoder->fromBytes( encoder->getBytes() ) );
+
+   auto decoded = decoder->getObjectAt< test::MissingFieldsTestObject >( 0 );
+   ASSERT_NE( nullptr, decoded );
+   EXPECT_FALSE( decoded->foundValueAsKey );
+   EXPECT_FALSE( decoded->foundUnknownKey );
+   EXPECT_EQ( "b", decoded->a );
+}
+
+TEST( BinaryCoding, decodeInPlace )
+{
+   test::registerBuilders();
+
+   const auto path = std::filesystem::temp_directory_path() / "crimild_binary_coding_in_place.crimild";
+
+   auto obj = crimild::alloc< test::InPlaceTestObject >();
+   obj->bytes = ByteArray( 1000 );
+   for ( Size i = 0; i < obj->bytes.size(); ++i ) {
+      obj->bytes[ i ] = Byte( i );
+   }
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( obj ) );
+   ASSERT_TRUE( encoder->write( path ) );
+
+   SharedPointer< test::InPlaceTestObject > decoded;
+   {
+      auto decoder = crimild::alloc< BinaryDecoder >();
+      ASSERT_TRUE( decoder->read( path ) );
+      decoded = decoder->getObjectAt< test::InPlaceTestObject >( 0 );
+   }
+
+   // Mapping is still alive after the decoder is destroyed
+   ASSERT_NE( nullptr, decoded );
+   ASSERT_NE( nullptr, decoded->owner );
+   ASSERT_EQ( 1000, decoded->size );
+   EXPECT_EQ( 0, reinterpret_cast< uintptr_t >( decoded->data ) % binary::BULK_ALIGNMENT );
+   EXPECT_EQ( 0, memcmp( obj->bytes.getData(), decoded->data, decoded->size ) );
+
+   // Mapped file is copy-on-write
+   decoded->data[ 0 ] = 0xff;
+   EXPECT_EQ( 0xff, decoded->data[ 0 ] );
+
+   std::filesystem::remove( path );
+}
+
+TEST( BinaryCoding, invalidData )
+{
+   test::registerBuilders();
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( test::createScene() ) );
+   const auto bytes = encoder->getBytes();
+
+   EXPECT_FALSE( crimild::alloc< BinaryDecoder >()->fromBytes( ByteArray() ) );
+
+   // Truncated
+   EXPECT_FALSE( crimild::alloc< BinaryDecoder >()->fromBytes( ByteArray( bytes.size() / 2, const_cast< Byte * >( bytes.getData() ) ) ) );
+
+   // Tag-based data
+   auto garbage = bytes;
+   garbage[ 0 ] = 0;
+   EXPECT_FALSE( crimild::alloc< BinaryDecoder >()->fromBytes( garbage ) );
+
+   EXPECT_FALSE( crimild::alloc< BinaryDecoder >()->read( "this/file/does/not/exist.crimild" ) );
+}
+
+TEST( BinaryCoding, unknownTypes )
+{
+   test::registerBuilders();
+
+   auto encoder = crimild::alloc< BinaryEncoder >();
+   ASSERT_TRUE( encoder->encode( test::createScene() ) );
+   const auto bytes = encoder->getBytes();
+
+   ObjectFactory::getInstance()->unregisterBuilder( test::BinaryTestObject::__CLASS_NAME );
+
+   auto decoder = crimild::alloc< BinaryDecoder >();
+   EXPECT_TRUE( decoder->fromBytes( bytes ) );
+   EXPECT_EQ( 0, decoder->getObjectCount() );
+
+   test::registerBuilders();
+}
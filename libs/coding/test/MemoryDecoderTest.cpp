@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/MemoryDecoder.hpp"
+#include "crimild/coding/MemoryEncoder.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+namespace crimild::coding::test {
+
+   class MeshObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::MeshObject )
+
+   public:
+      Array< Vector3f > positions;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         Codable::encode( encoder );
+         encoder.encode( "positions", positions );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         Codable::decode( decoder );
+         decoder.decode( "positions", positions );
+      }
+   };
+
+   /**
+      \brief Uses the state of linked objects while decoding, like geometries computing bounds
+    */
+   class NodeObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::NodeObject )
+
+   public:
+      std::string name;
+      SharedPointer< MeshObject > mesh;
+      Array< SharedPointer< NodeObject > > children;
+      SharedPointer< NodeObject > other;
+
+      // Computed when decoding
+      crimild::Size vertexCount = 0;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         Codable::encode( encoder );
+         encoder.encode( "name", name );
+         encoder.encode( "mesh", mesh );
+         encoder.encode( "children", children );
+         encoder.encode( "other", other );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         Codable::decode( decoder );
+         decoder.decode( "name", name );
+         decoder.decode( "mesh", mesh );
+         decoder.decode( "children", children );
+         decoder.decode( "other", other );
+
+         vertexCount = mesh != nullptr ? mesh->positions.size() : 0;
+         children.each( [ this ]( auto &child ) {
+            vertexCount += child->vertexCount;
+         } );
+      }
+   };
+
+   static void registerBuilders( void )
+   {
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::MeshObject )
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::NodeObject )
+   }
+
+   static MemoryDecoder::ParallelFor createThreadedParallelFor( crimild::Size numThreads )
+   {
+      return [ numThreads ]( crimild::Size count, const std::function< void( crimild::Size, crimild::Size ) > &fn ) {
+         const auto chunk = ( count + numThreads - 1 ) / numThreads;
+         std::vector< std::thread > threads;
+         for ( crimild::Size begin = 0; begin < count; begin += chunk ) {
+            threads.emplace_back( fn, begin, std::min( count, begin + chunk ) );
+         }
+         for ( auto &t : threads ) {
+            t.join();
+         }
+      };
+   }
+
+   static SharedPointer< NodeObject > createScene( void )
+   {
+      auto shared = crimild::alloc< MeshObject >();
+      shared->positions = { Vector3f { 1, 2, 3 }, Vector3f { 4, 5, 6 } };
+
+      auto root = crimild::alloc< NodeObject >();
+      root->name = "root";
+      for ( auto i = 0; i < 4; ++i ) {
+         auto group = crimild::alloc< NodeObject >();
+         group->name = "group " + std::to_string( i );
+         for ( auto j = 0; j < 8; ++j ) {
+            auto leaf = crimild::alloc< NodeObject >();
+            leaf->name = "leaf " + std::to_string( i ) + "." + std::to_string( j );
+            if ( j % 2 == 0 ) {
+               leaf->mesh = shared;
+            } else {
+               leaf->mesh = crimild::alloc< MeshObject >();
+               leaf->mesh->positions.resize( 10 * j + i );
+               for ( crimild::Size k = 0; k < leaf->mesh->positions.size(); ++k ) {
+                  leaf->mesh->positions[ k ] = Vector3f { Real32( k ), Real32( i ), Real32( j ) };
+               }
+            }
+            group->children.add( leaf );
+         }
+         root->children.add( group );
+      }
+
+      return root;
+   }
+
+   static SharedPointer< NodeObject > decode( const ByteArray &bytes, MemoryDecoder::ParallelFor parallelFor )
+   {
+      MemoryDecoder decoder;
+      decoder.setParallelFor( parallelFor );
+      if ( !decoder.fromBytes( bytes ) ) {
+         return nullptr;
+      }
+      return decoder.getObjectAt< NodeObject >( 0 );
+   }
+
+   static void expectEqual( const SharedPointer< NodeObject > &expected, const SharedPointer< NodeObject > &decoded )
+   {
+      ASSERT_NE( nullptr, decoded );
+      EXPECT_EQ( expected->name, decoded->name );
+      EXPECT_EQ( expected->vertexCount, decoded->vertexCount );
+      EXPECT_EQ( expected->mesh == nullptr, decoded->mesh == nullptr );
+      if ( expected->mesh != nullptr && decoded->mesh != nullptr ) {
+         EXPECT_EQ( expected->mesh->positions, decoded->mesh->positions );
+      }
+      ASSERT_EQ( expected->children.size(), decoded->children.size() );
+      for ( crimild::Size i = 0; i < expected->children.size(); ++i ) {
+         expectEqual( expected->children[ i ], decoded->children[ i ] );
+      }
+   }
+
+}
+
+TEST( MemoryDecoder, parallel )
+{
+   test::registerBuilders();
+
+   MemoryEncoder encoder;
+   ASSERT_TRUE( encoder.encode( test::createScene() ) );
+   const auto bytes = encoder.getBytes();
+
+   auto sequential = test::decode( bytes, nullptr );
+   auto parallel = test::decode( bytes, test::createThreadedParallelFor( 4 ) );
+
+   ASSERT_NE( nullptr, sequential );
+   ASSERT_NE( nullptr, parallel );
+
+   // Linked objects were decoded before the ones referencing them
+   EXPECT_LT( 0, parallel->vertexCount );
+
+   test::expectEqual( sequential, parallel );
+}
+
+TEST( MemoryDecoder, parallelSharedObjects )
+{
+   test::registerBuilders();
+
+   MemoryEncoder encoder;
+   ASSERT_TRUE( encoder.encode( test::createScene() ) );
+
+   auto decoded = test::decode( encoder.getBytes(), test::createThreadedParallelFor( 4 ) );
+   ASSERT_NE( nullptr, decoded );
+
+   // Same instance for all references
+   auto shared = decoded->children[ 0 ]->children[ 0 ]->mesh;
+   ASSERT_NE( nullptr, shared );
+   decoded->children.each( [ & ]( auto &group ) {
+      for ( crimild::Size j = 0; j < group->children.size(); j += 2 ) {
+         EXPECT_EQ( shared, group->children[ j ]->mesh );
+      }
+   } );
+}
+
+TEST( MemoryDecoder, parallelWithCycles )
+{
+   test::registerBuilders();
+
+   auto a = crimild::alloc< test::NodeObject >();
+   a->name = "a";
+   auto b = crimild::alloc< test::NodeObject >();
+   b->name = "b";
+   a->other = b;
+   b->other = a;
+
+   MemoryEncoder encoder;
+   ASSERT_TRUE( encoder.encode( a ) );
+
+   auto decoded = test::decode( encoder.getBytes(), test::createThreadedParallelFor( 2 ) );
+
+   // Break the cycle so objects can be released
+   a->other = nullptr;
+   b->other = nullptr;
+
+   ASSERT_NE( nullptr, decoded );
+   ASSERT_NE( nullptr, decoded->other );
+   EXPECT_EQ( "b", decoded->other->name );
+   EXPECT_EQ( decoded, decoded->other->other );
+
+   decoded->other->other = nullptr;
+}
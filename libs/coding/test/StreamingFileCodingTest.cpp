@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/coding/FileDecoder.hpp"
+#include "crimild/coding/FileEncoder.hpp"
+#include "crimild/coding/StreamingFileDecoder.hpp"
+#include "crimild/coding/StreamingFileEncoder.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <crimild/math/translation.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <new>
+
+using namespace crimild;
+using namespace crimild::coding;
+
+namespace crimild::coding::test {
+
+   /**
+      \brief Tracks the amount of memory allocated with new/delete
+
+      Global allocation functions are replaced below so peak memory can be
+      measured while encoding or decoding, regardless of who allocates it.
+    */
+   namespace allocations {
+
+      static std::atomic< crimild::Size > current = 0;
+      static std::atomic< crimild::Size > peak = 0;
+
+      // Keeps pointers aligned for any fundamental type
+      static constexpr crimild::Size HEADER_SIZE = alignof( std::max_align_t );
+
+      static void *allocate( crimild::Size size ) noexcept
+      {
+         auto ptr = static_cast< crimild::Byte * >( std::malloc( size + HEADER_SIZE ) );
+         if ( ptr == nullptr ) {
+            return nullptr;
+         }
+         *reinterpret_cast< crimild::Size * >( ptr ) = size;
+
+         const auto total = current.fetch_add( size ) + size;
+         auto max = peak.load();
+         while ( total > max && !peak.compare_exchange_weak( max, total ) ) {
+            // retry
+         }
+
+         return ptr + HEADER_SIZE;
+      }
+
+      static void deallocate( void *ptr ) noexcept
+      {
+         if ( ptr == nullptr ) {
+            return;
+         }
+         auto base = static_cast< crimild::Byte * >( ptr ) - HEADER_SIZE;
+         current.fetch_sub( *reinterpret_cast< crimild::Size * >( base ) );
+         std::free( base );
+      }
+
+      /**
+         \brief Starts measuring, returning the current amount of allocated memory
+       */
+      static crimild::Size reset( void ) noexcept
+      {
+         const auto ret = current.load();
+         peak = ret;
+         return ret;
+      }
+
+   }
+
+}
+
+void *operator new( std::size_t size )
+{
+   if ( auto ptr = crimild::coding::test::allocations::allocate( size ) ) {
+      return ptr;
+   }
+   throw std::bad_alloc();
+}
+
+void *operator new[]( std::size_t size )
+{
+   return operator new( size );
+}
+
+void *operator new( std::size_t size, const std::nothrow_t & ) noexcept
+{
+   return crimild::coding::test::allocations::allocate( size );
+}
+
+void *operator new[]( std::size_t size, const std::nothrow_t & ) noexcept
+{
+   return crimild::coding::test::allocations::allocate( size );
+}
+
+void operator delete( void *ptr ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+void operator delete[]( void *ptr ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+void operator delete( void *ptr, std::size_t ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+void operator delete[]( void *ptr, std::size_t ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+void operator delete( void *ptr, const std::nothrow_t & ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+void operator delete[]( void *ptr, const std::nothrow_t & ) noexcept
+{
+   crimild::coding::test::allocations::deallocate( ptr );
+}
+
+namespace crimild::coding::test {
+
+   class StreamingTestObject : public Codable {
+      CRIMILD_IMPLEMENT_RTTI( crimild::coding::test::StreamingTestObject )
+
+   public:
+      std::string name;
+      Int32 value = 0;
+      Transformation local;
+      Array< UInt32 > values;
+      ByteArray bytes;
+      Array< SharedPointer< StreamingTestObject > > children;
+      SharedPointer< StreamingTestObject > other;
+
+      virtual void encode( Encoder &encoder ) override
+      {
+         Codable::encode( encoder );
+
+         encoder.encode( "name", name );
+         encoder.encode( "value", value );
+         encoder.encode( "local", local );
+         encoder.encode( "values", values );
+         encoder.encode( "bytes", bytes );
+         encoder.encode( "children", children );
+         encoder.encode( "other", other );
+      }
+
+      virtual void decode( Decoder &decoder ) override
+      {
+         Codable::decode( decoder );
+
+         decoder.decode( "name", name );
+         decoder.decode( "value", value );
+         decoder.decode( "local", local );
+         decoder.decode( "values", values );
+         decoder.decode( "bytes", bytes );
+         decoder.decode( "children", children );
+         decoder.decode( "other", other );
+      }
+   };
+
+   static void registerBuilders( void )
+   {
+      CRIMILD_REGISTER_OBJECT_BUILDER( crimild::coding::test::StreamingTestObject )
+   }
+
+   static SharedPointer< StreamingTestObject > createScene( crimild::Size children = 3, crimild::Size bytesPerChild = 16 )
+   {
+      auto root = crimild::alloc< StreamingTestObject >();
+      root->name = "a scene";
+      root->value = 42;
+      root->local = translation( 10, 20, 30 );
+      root->values = { 1, 2, 3, 4, 5 };
+      root->bytes = { 0xca, 0xfe };
+
+      for ( crimild::Size i = 0; i < children; ++i ) {
+         auto child = crimild::alloc< StreamingTestObject >();
+         child->name = "child " + std::to_string( i );
+         child->value = Int32( i );
+         child->bytes = ByteArray( bytesPerChild );
+         for ( crimild::Size j = 0; j < bytesPerChild; ++j ) {
+            child->bytes[ j ] = crimild::Byte( i + j );
+         }
+         root->children.add( child );
+      }
+
+      // Shared reference
+      root->other = root->children[ children / 2 ];
+
+      return root;
+   }
+
+   static void expectEqual( const SharedPointer< StreamingTestObject > &expected, const SharedPointer< StreamingTestObject > &decoded )
+   {
+      ASSERT_NE( nullptr, decoded );
+      EXPECT_EQ( expected->name, decoded->name );
+      EXPECT_EQ( expected->value, decoded->value );
+      EXPECT_EQ( expected->local, decoded->local );
+      EXPECT_EQ( expected->values, decoded->values );
+      EXPECT_EQ( expected->bytes, decoded->bytes );
+
+      ASSERT_EQ( expected->children.size(), decoded->children.size() );
+      for ( crimild::Size i = 0; i < expected->children.size(); ++i ) {
+         EXPECT_EQ( expected->children[ i ]->name, decoded->children[ i ]->name );
+         EXPECT_EQ( expected->children[ i ]->value, decoded->children[ i ]->value );
+         EXPECT_EQ( expected->children[ i ]->bytes, decoded->children[ i ]->bytes );
+      }
+   }
+
+   static std::filesystem::path getPath( std::string name )
+   {
+      return std::filesystem::temp_directory_path() / ( "crimild_streaming_file_coding_" + name + ".crimild" );
+   }
+
+}
+
+TEST( StreamingFileCoding, roundtrip )
+{
+   test::registerBuilders();
+
+   const auto path = test::getPath( "roundtrip" );
+   auto scene = test::createScene();
+
+   {
+      StreamingFileEncoder encoder;
+      ASSERT_TRUE( encoder.open( path ) );
+      ASSERT_TRUE( encoder.encode( scene ) );
+      ASSERT_TRUE( encoder.close() );
+   }
+
+   StreamingFileDecoder decoder;
+   ASSERT_TRUE( decoder.read( path ) );
+   ASSERT_EQ( 1, decoder.getObjectCount() );
+
+   auto decoded = decoder.getObjectAt< test::StreamingTestObject >( 0 );
+   test::expectEqual( scene, decoded );
+
+   // Shared objects are decoded only once
+   EXPECT_EQ( decoded->children[ 1 ], decoded->other );
+
+   std::filesystem::remove( path );
+}
+
+TEST( StreamingFileCoding, readWithFileDecoder )
+{
+   test::registerBuilders();
+
+   const auto path = test::getPath( "file_decoder" );
+   auto scene = test::createScene();
+
+   {
+      StreamingFileEncoder encoder;
+      ASSERT_TRUE( encoder.open( path ) );
+      ASSERT_TRUE( encoder.encode( scene ) );
+      ASSERT_TRUE( encoder.close() );
+   }
+
+   FileDecoder decoder;
+   ASSERT_TRUE( decoder.read( path ) );
+   ASSERT_EQ( 1, decoder.getObjectCount() );
+
+   test::expectEqual( scene, decoder.getObjectAt< test::StreamingTestObject >( 0 ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( StreamingFileCoding, readFromFileEncoder )
+{
+   test::registerBuilders();
+
+   const auto path = test::getPath( "file_encoder" );
+   auto scene = test::createScene();
+
+   FileEncoder encoder;
+   ASSERT_TRUE( encoder.encode( scene ) );
+   ASSERT_TRUE( encoder.write( path ) );
+
+   StreamingFileDecoder decoder;
+   ASSERT_TRUE( decoder.read( path ) );
+   ASSERT_EQ( 1, decoder.getObjectCount() );
+
+   test::expectEqual( scene, decoder.getObjectAt< test::StreamingTestObject >( 0 ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( StreamingFileCoding, encodeWithoutOpening )
+{
+   test::registerBuilders();
+
+   StreamingFileEncoder encoder;
+   EXPECT_FALSE( encoder.isOpen() );
+   EXPECT_FALSE( encoder.encode( test::createScene() ) );
+   EXPECT_FALSE( encoder.close() );
+}
+
+TEST( StreamingFileCoding, invalidFiles )
+{
+   test::registerBuilders();
+
+   const auto path = test::getPath( "invalid" );
+
+   {
+      StreamingFileEncoder encoder;
+      ASSERT_TRUE( encoder.open( path ) );
+      ASSERT_TRUE( encoder.encode( test::createScene() ) );
+      ASSERT_TRUE( encoder.close() );
+   }
+
+   // Truncated
+   std::filesystem::resize_file( path, std::filesystem::file_size( path ) / 2 );
+   EXPECT_FALSE( StreamingFileDecoder().read( path ) );
+
+   // Garbage
+   {
+      std::ofstream out( path, std::ios::binary | std::ios::trunc );
+      out << "this is not a scene";
+   }
+   EXPECT_FALSE( StreamingFileDecoder().read( path ) );
+
+   EXPECT_FALSE( StreamingFileDecoder().read( "this/file/does/not/exist.crimild" ) );
+
+   std::filesystem::remove( path );
+}
+
+TEST( StreamingFileCoding, peakMemory )
+{
+   test::registerBuilders();
+
+   constexpr crimild::Size CHILDREN = 16;
+   constexpr crimild::Size BYTES_PER_CHILD = 1024 * 1024;
+   constexpr crimild::Size SCENE_SIZE = CHILDREN * BYTES_PER_CHILD;
+
+   const auto path = test::getPath( "peak_memory" );
+   auto scene = test::createScene( CHILDREN, BYTES_PER_CHILD );
+
+   // Encoding never copies values, so only a small fraction of the scene
+   // size is needed at any given time
+   {
+      const auto baseline = test::allocations::reset();
+
+      StreamingFileEncoder encoder;
+      ASSERT_TRUE( encoder.open( path ) );
+      ASSERT_TRUE( encoder.encode( scene ) );
+      ASSERT_TRUE( encoder.close() );
+
+      EXPECT_LT( test::allocations::peak - baseline, SCENE_SIZE / 8 );
+   }
+
+   ASSERT_LT( SCENE_SIZE, std::filesystem::file_size( path ) );
+
+   // Decoding needs memory for the decoded scene, but values are read in place
+   // so there's no other copy of them
+   {
+      const auto baseline = test::allocations::reset();
+
+      StreamingFileDecoder decoder;
+      ASSERT_TRUE( decoder.read( path ) );
+
+      EXPECT_LT( test::allocations::peak - baseline, SCENE_SIZE + SCENE_SIZE / 8 );
+
+      test::expectEqual( scene, decoder.getObjectAt< test::StreamingTestObject >( 0 ) );
+   }
+
+   std::filesystem::remove( path );
+}
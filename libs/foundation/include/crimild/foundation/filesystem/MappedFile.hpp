@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRIMILD_FOUNDATION_FILESYSTEM_MAPPED_FILE_
+#define CRIMILD_FOUNDATION_FILESYSTEM_MAPPED_FILE_
+
+#include "crimild/foundation/common/Macros.hpp"
+#include "crimild/foundation/common/Types.hpp"
+
+#include <string>
+
+namespace crimild {
+
+   /**
+      \brief A read-only view of a file's contents mapped into memory
+
+      Pages are loaded by the OS on demand, so large files can be parsed
+      without reading them into intermediate buffers first. Contents are
+      available until the file is closed or the object is destroyed.
+    */
+   class MappedFile {
+   public:
+      enum class Access {
+         READ_ONLY,
+
+         /**
+            \brief Mapped pages can be written
+
+            Pages are copied the first time they are written to, so changes
+            are private to this process and never reach the file.
+          */
+         COPY_ON_WRITE,
+      };
+
+   public:
+      MappedFile( void ) noexcept = default;
+
+      /**
+         \brief Maps a file. Use isOpen() to check for errors.
+       */
+      explicit MappedFile( const std::string &path, Access access = Access::READ_ONLY ) noexcept;
+
+      MappedFile( const MappedFile & ) = delete;
+      MappedFile( MappedFile &&other ) noexcept;
+
+      ~MappedFile( void ) noexcept;
+
+      MappedFile &operator=( const MappedFile & ) = delete;
+      MappedFile &operator=( MappedFile &&other ) noexcept;
+
+      /**
+         \brief Maps a file, closing any file previously mapped
+
+         \returns false if the file cannot be opened or mapped
+       */
+      Bool open( const std::string &path, Access access = Access::READ_ONLY ) noexcept;
+
+      void close( void ) noexcept;
+
+      inline Bool isOpen( void ) const noexcept { return m_open; }
+
+      /**
+         \brief Contents of the file
+
+         \remarks Might be null for empty files
+       */
+      inline const Byte *getData( void ) const noexcept { return m_data; }
+
+      /**
+         \brief Writable contents of the file
+
+         \remarks Null unless the file was mapped with COPY_ON_WRITE access
+       */
+      inline Byte *getWritableData( void ) const noexcept { return m_writable ? const_cast< Byte * >( m_data ) : nullptr; }
+
+      /**
+         \brief Size of the file, in bytes
+       */
+      inline Size getSize( void ) const noexcept { return m_size; }
+
+   private:
+      const Byte *m_data = nullptr;
+      Size m_size = 0;
+      Bool m_open = false;
+      Bool m_writable = false;
+
+#if defined( CRIMILD_PLATFORM_WIN32 )
+      void *m_file = nullptr;
+      void *m_mapping = nullptr;
+#endif
+   };
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/foundation/filesystem/MappedFile.hpp"
+
+#if defined( CRIMILD_PLATFORM_WIN32 )
+   #define WIN32_LEAN_AND_MEAN
+   #include <windows.h>
+#else
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
+#include <utility>
+
+using namespace crimild;
+
+MappedFile::MappedFile( const std::string &path, Access access ) noexcept
+{
+   open( path, access );
+}
+
+MappedFile::MappedFile( MappedFile &&other ) noexcept
+{
+   *this = std::move( other );
+}
+
+MappedFile::~MappedFile( void ) noexcept
+{
+   close();
+}
+
+MappedFile &MappedFile::operator=( MappedFile &&other ) noexcept
+{
+   if ( this != &other ) {
+      close();
+      m_data = std::exchange( other.m_data, nullptr );
+      m_size = std::exchange( other.m_size, 0 );
+      m_open = std::exchange( other.m_open, false );
+      m_writable = std::exchange( other.m_writable, false );
+#if defined( CRIMILD_PLATFORM_WIN32 )
+      m_file = std::exchange( other.m_file, nullptr );
+      m_mapping = std::exchange( other.m_mapping, nullptr );
+#endif
+   }
+   return *this;
+}
+
+#if defined( CRIMILD_PLATFORM_WIN32 )
+
+Bool MappedFile::open( const std::string &path, Access access ) noexcept
+{
+   close();
+
+   auto file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+   if ( file == INVALID_HANDLE_VALUE ) {
+      return false;
+   }
+
+   LARGE_INTEGER size;
+   if ( !GetFileSizeEx( file, &size ) ) {
+      CloseHandle( file );
+      return false;
+   }
+
+   m_file = file;
+   m_size = Size( size.QuadPart );
+   m_open = true;
+
+   if ( m_size == 0 ) {
+      // Empty files cannot be mapped
+      return true;
+   }
+
+   const auto copyOnWrite = access == Access::COPY_ON_WRITE;
+
+   m_mapping = CreateFileMappingA( file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr );
+   if ( m_mapping == nullptr ) {
+      close();
+      return false;
+   }
+
+   m_data = static_cast< const Byte * >( MapViewOfFile( m_mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0 ) );
+   if ( m_data == nullptr ) {
+      close();
+      return false;
+   }
+
+   m_writable = copyOnWrite;
+
+   return true;
+}
+
+void MappedFile::close( void ) noexcept
+{
+   if ( m_data != nullptr ) {
+      UnmapViewOfFile( m_data );
+   }
+   if ( m_mapping != nullptr ) {
+      CloseHandle( m_mapping );
+   }
+   if ( m_file != nullptr ) {
+      CloseHandle( m_file );
+   }
+
+   m_data = nullptr;
+   m_size = 0;
+   m_open = false;
+   m_writable = false;
+   m_file = nullptr;
+   m_mapping = nullptr;
+}
+
+#else
+
+Bool MappedFile::open( const std::string &path, Access access ) noexcept
+{
+   close();
+
+   const auto fd = ::open( path.c_str(), O_RDONLY );
+   if ( fd < 0 ) {
+      return false;
+   }
+
+   struct stat info;
+   if ( fstat( fd, &info ) != 0 ) {
+      ::close( fd );
+      return false;
+   }
+
+   const auto size = Size( info.st_size );
+   if ( size > 0 ) {
+      // Private mappings are copy-on-write when pages are writable
+      const auto prot = access == Access::COPY_ON_WRITE ? PROT_READ | PROT_WRITE : PROT_READ;
+      auto data = mmap( nullptr, size, prot, MAP_PRIVATE, fd, 0 );
+      if ( data == MAP_FAILED ) {
+         ::close( fd );
+         return false;
+      }
+
+   #if defined( POSIX_MADV_SEQUENTIAL )
+      // Files are usually parsed from beginning to end
+      posix_madvise( data, size, POSIX_MADV_SEQUENTIAL );
+   #endif
+
+      m_data = static_cast< const Byte * >( data );
+      m_writable = access == Access::COPY_ON_WRITE;
+   }
+
+   // The mapping remains valid after closing the descriptor
+   ::close( fd );
+
+   m_size = size;
+   m_open = true;
+   return true;
+}
+
+void MappedFile::close( void ) noexcept
+{
+   if ( m_data != nullptr ) {
+      munmap( const_cast< Byte * >( m_data ), m_size );
+   }
+
+   m_data = nullptr;
+   m_size = 0;
+   m_open = false;
+   m_writable = false;
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crimild/foundation/filesystem/MappedFile.hpp"
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace crimild;
+
+namespace crimild::test {
+
+   static std::string writeTempFile( const char *name, const std::string &contents )
+   {
+      const auto path = ( std::filesystem::temp_directory_path() / name ).string();
+      std::ofstream out( path, std::ios::binary );
+      out << contents;
+      return path;
+   }
+
+}
+
+TEST( MappedFile, open )
+{
+   const auto path = test::writeTempFile( "crimild_mapped_file.txt", "Hello, World!" );
+
+   MappedFile file( path );
+
+   ASSERT_TRUE( file.isOpen() );
+   ASSERT_EQ( 13, file.getSize() );
+   EXPECT_EQ( 0, memcmp( "Hello, World!", file.getData(), file.getSize() ) );
+
+   file.close();
+   EXPECT_FALSE( file.isOpen() );
+   EXPECT_EQ( nullptr, file.getData() );
+   EXPECT_EQ( 0, file.getSize() );
+
+   std::filesystem::remove( path );
+}
+
+TEST( MappedFile, empty_file )
+{
+   const auto path = test::writeTempFile( "crimild_mapped_file_empty.txt", "" );
+
+   MappedFile file( path );
+
+   EXPECT_TRUE( file.isOpen() );
+   EXPECT_EQ( 0, file.getSize() );
+
+   file.close();
+   std::filesystem::remove( path );
+}
+
+TEST( MappedFile, copy_on_write )
+{
+   const auto path = test::writeTempFile( "crimild_mapped_file_cow.txt", "Hello, World!" );
+
+   {
+      MappedFile readOnly( path );
+      EXPECT_EQ( nullptr, readOnly.getWritableData() );
+
+      MappedFile file( path, MappedFile::Access::COPY_ON_WRITE );
+      ASSERT_TRUE( file.isOpen() );
+      ASSERT_NE( nullptr, file.getWritableData() );
+
+      memcpy( file.getWritableData(), "Hola", 4 );
+      EXPECT_EQ( 0, memcmp( "Holao, World!", file.getData(), file.getSize() ) );
+
+      // Changes are not visible to other mappings
+      EXPECT_EQ( 0, memcmp( "Hello, World!", readOnly.getData(), readOnly.getSize() ) );
+   }
+
+   // Nor written back to the file
+   MappedFile file( path );
+   EXPECT_EQ( 0, memcmp( "Hello, World!", file.getData(), file.getSize() ) );
+
+   file.close();
+   std::filesystem::remove( path );
+}
+
+TEST( MappedFile, missing_file )
+{
+   MappedFile file;
+
+   EXPECT_FALSE( file.open( "this/file/does/not/exist.txt" ) );
+   EXPECT_FALSE( file.isOpen() );
+}
+
+TEST( MappedFile, move )
+{
+   const auto path = test::writeTempFile( "crimild_mapped_file_move.txt", "abc" );
+
+   MappedFile file( path );
+   const auto data = file.getData();
+
+   MappedFile other( std::move( file ) );
+   EXPECT_FALSE( file.isOpen() );
+   ASSERT_TRUE( other.isOpen() );
+   EXPECT_EQ( data, other.getData() );
+   EXPECT_EQ( 3, other.getSize() );
+
+   other.close();
+   std::filesystem::remove( path );
+}
@@ -69,7 +69,8 @@ namespace crimild {
     {
         const auto &C = origin( S );
         const auto R = radius( S );
-        const auto d = distance( P, C );
+        // Signed distance, so spheres behind the plane can be detected
+        const auto d = distance2( P, C );
         if ( d < -R ) {
             return -1; // behind
         } else if ( d > R ) {
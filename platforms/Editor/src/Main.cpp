@@ -355,12 +355,12 @@ inline void setupImGuiStyles( bool dark, float alpha )
 
 bool beginFrame(
    GLFWwindow *window,
-   crimild::concurrency::JobScheduler &jobScheduler,
+   crimild::concurrency::TaskSystem &taskSystem,
    std::unique_ptr< crimild::Simulation > &simulation
 ) noexcept
 {
    // This also dispatch any sync_frame calls
-   jobScheduler.executeDelayedJobs();
+   taskSystem.beginFrame();
 
    // Dispatch deferred messages
    crimild::MessageQueue::getInstance()->dispatchDeferredMessages();
@@ -418,7 +418,7 @@ bool renderFrame(
    GLFWwindow *window,
    ImGuiIO &io,
    ImGui_ImplVulkanH_Window *wd,
-   crimild::concurrency::JobScheduler &jobScheduler,
+   crimild::concurrency::TaskSystem &taskSystem,
    std::unique_ptr< crimild::Simulation > &simulation,
    VulkanObjects &vulkanObjects,
    std::unique_ptr< crimild::editor::LayoutManager > &layoutManager
@@ -431,7 +431,7 @@ bool renderFrame(
    // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
    glfwPollEvents();
 
-   if ( !beginFrame( window, jobScheduler, simulation ) ) {
+   if ( !beginFrame( window, taskSystem, simulation ) ) {
       return false;
    }
 
@@ -557,11 +557,9 @@ int main( int argc, char **argv )
    crimild::Settings settings;
    settings.parseCommandLine( argc, argv );
 
-   // This should not be needed anymore.
-   // TODO: Deprecate JobScheduler?
-   crimild::concurrency::JobScheduler jobScheduler;
-   jobScheduler.configure( 0 );
-   jobScheduler.start();
+   crimild::concurrency::TaskSystem taskSystem;
+   taskSystem.configure( 0 );
+   taskSystem.start();
 
    // TODO: Move AssetManager here
    // TODO: Move AudioManager here
@@ -707,7 +705,7 @@ int main( int argc, char **argv )
          glfwSetWindowTitle( window, "Crimild (NO PROJECT)" );
       }
 
-      if ( !renderFrame( window, io, wd, jobScheduler, simulation, vulkanObjects, layoutManager ) ) {
+      if ( !renderFrame( window, io, wd, taskSystem, simulation, vulkanObjects, layoutManager ) ) {
          break;
       }
 
@@ -722,10 +720,10 @@ int main( int argc, char **argv )
 
    crimild::PrefabNode::cleanup();
 
-   jobScheduler.executeDelayedJobs();
+   taskSystem.beginFrame();
    crimild::MessageQueue::getInstance()->dispatchDeferredMessages();
 
-   jobScheduler.stop();
+   taskSystem.stop();
    crimild::MessageQueue::getInstance()->clear();
 
    // Destroy the layout manager
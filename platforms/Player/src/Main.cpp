@@ -50,11 +50,9 @@ int main( int argc, char **argv )
     crimild::Settings settings;
     settings.parseCommandLine( argc, argv );
 
-    // This should not be needed anymore.
-    // TODO: Deprecate JobScheduler?
-    crimild::concurrency::JobScheduler jobScheduler;
-    jobScheduler.configure( 0 );
-    jobScheduler.start();
+    crimild::concurrency::TaskSystem taskSystem;
+    taskSystem.configure( 0 );
+    taskSystem.start();
 
     if ( !glfwInit() ) {
         CRIMILD_LOG_FATAL( "Cannot start GLFW: glfwInit failed" );
@@ -127,7 +125,7 @@ int main( int argc, char **argv )
         glfwPollEvents();
 
         // This also dispatch any sync_frame calls
-        jobScheduler.executeDelayedJobs();
+        taskSystem.beginFrame();
 
         // Dispatch deferred messages
         crimild::MessageQueue::getInstance()->dispatchDeferredMessages();
@@ -142,7 +140,7 @@ int main( int argc, char **argv )
         }
     }
 
-    jobScheduler.stop();
+    taskSystem.stop();
     crimild::MessageQueue::getInstance()->clear();
 
     window = nullptr;
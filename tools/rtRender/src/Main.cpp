@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2002 - present, H. Hernan Saez
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the copyright holder nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Crimild.hpp>
+#include <chrono>
+#include <crimild/coding/FileDecoder.hpp>
+#include <crimild/math/lookAt.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace crimild;
+
+/**
+   \brief Renders a scene offline using the soft ray tracer
+
+   No window or GPU is required. The scene is either an encoded scene file or
+   an OBJ model. Rendering stops once all pixels converged (see the rt.samples.*
+   and rt.adaptive.threshold settings) or when the time budget is exhausted,
+   whichever happens first. The result is written in linear HDR, either as EXR
+   or PFM depending on the output extension.
+
+   Any rt.* setting can be passed in the command line.
+ */
+
+static void printUsage( void )
+{
+   std::printf(
+      "\nUsage:"
+      "\n\trtRender input=<SCENE_FILE|OBJ_FILE> [output=<OUTPUT_FILE>] [options]"
+      "\n\nOptions:"
+      "\n\toutput=<path>           Either .exr or .pfm (default: render.exr)"
+      "\n\tvideo.width=<pixels>    Image width (default: 640)"
+      "\n\tvideo.height=<pixels>   Image height (default: 480)"
+      "\n\tsamples=<count>         Maximum samples per pixel (default: rt.samples.max)"
+      "\n\ttime=<seconds>          Time budget. Zero means no limit (default: 0)"
+      "\n\trt.workers=<count>      Number of threads (default: all cores)"
+      "\n\tstats=<path>            Also write stats to a JSON file"
+      "\n\n"
+   );
+}
+
+static SharedPointer< Node > loadScene( const std::filesystem::path &path ) noexcept
+{
+   if ( !std::filesystem::exists( path ) ) {
+      CRIMILD_LOG_ERROR( path.string(), " does not exists" );
+      return nullptr;
+   }
+
+   auto extension = path.extension().string();
+   std::transform( extension.begin(), extension.end(), extension.begin(), []( auto c ) { return std::tolower( c ); } );
+   if ( extension == ".obj" ) {
+      OBJLoader loader( path.string() );
+      return loader.load();
+   }
+
+   coding::FileDecoder decoder;
+   if ( !decoder.read( path ) || decoder.getObjectCount() == 0 ) {
+      return nullptr;
+   }
+   return decoder.getObjectAt< Node >( 0 );
+}
+
+/**
+   \brief Makes sure there is a camera with the right aspect ratio
+
+   OBJ models (and some encoded scenes) don't have cameras, so one is created
+   looking at the scene from a corner of its bounding volume.
+ */
+static void setupCamera( Group *scene, Real aspectRatio ) noexcept
+{
+   scene->perform( UpdateWorldState() );
+
+   FetchCameras fetchCameras;
+   scene->perform( fetchCameras );
+   if ( fetchCameras.hasCameras() ) {
+      fetchCameras.forEachCamera( [ & ]( auto camera ) { camera->setAspectRatio( aspectRatio ); } );
+      return;
+   }
+
+   const auto bound = scene->getWorldBound();
+   const auto center = bound->getCenter();
+   const auto radius = std::max( bound->getRadius(), Real( 1 ) );
+
+   CRIMILD_LOG_INFO( "No cameras found in scene. Using a default one" );
+
+   auto camera = std::make_shared< Camera >( 45.0f, aspectRatio, 0.01f * radius, 100.0f * radius );
+   camera->setLocal(
+      lookAt(
+         center + Vector3 { 1, 1, 1 } * ( 1.5f * radius ),
+         center,
+         Vector3 { 0, 1, 0 }
+      )
+   );
+   scene->attachNode( camera );
+   scene->perform( UpdateWorldState() );
+}
+
+static void writeStats( const std::filesystem::path &path, Settings *settings, Real elapsed ) noexcept
+{
+   std::ofstream out( path );
+   if ( !out.is_open() ) {
+      CRIMILD_LOG_ERROR( "Cannot write stats to ", path.string() );
+      return;
+   }
+
+   out << "{\n"
+       << "   \"width\": " << settings->get< Int32 >( "video.width", 0 ) << ",\n"
+       << "   \"height\": " << settings->get< Int32 >( "video.height", 0 ) << ",\n"
+       << "   \"workers\": " << settings->get< Int32 >( "rt.workers", 0 ) << ",\n"
+       << "   \"seconds\": " << elapsed << ",\n"
+       << "   \"samples_per_pixel\": " << settings->get< UInt32 >( "rt.samples.count", 0 ) << ",\n"
+       << "   \"samples\": " << settings->get< UInt64 >( "rt.stats.samples", 0 ) << ",\n"
+       << "   \"rays\": " << settings->get< UInt64 >( "rt.stats.rays", 0 ) << ",\n"
+       << "   \"rays_per_second\": " << settings->get< Real >( "rt.stats.rays_per_second", 0 ) << ",\n"
+       << "   \"samples_per_second\": " << settings->get< Real >( "rt.stats.samples_per_second", 0 ) << ",\n"
+       << "   \"converged\": " << settings->get< Real >( "rt.stats.converged", 0 ) << "\n"
+       << "}\n";
+}
+
+int main( int argc, char **argv )
+{
+   crimild::init();
+
+   Log::setOutputHandlers(
+      {
+         std::make_shared< ConsoleOutputHandler >( Log::LOG_LEVEL_INFO ),
+      }
+   );
+
+   auto settings = std::make_shared< Settings >();
+   settings->parseCommandLine( argc, argv );
+
+   const auto inputPath = std::filesystem::path( settings->get< std::string >( "input", "" ) );
+   if ( inputPath.empty() ) {
+      printUsage();
+      return -1;
+   }
+
+   const auto outputPath = std::filesystem::path( settings->get< std::string >( "output", "render.exr" ) );
+   const auto timeBudget = settings->get< Real >( "time", 0 );
+
+   // Any quality other than the default one uses the video resolution and all cores
+   if ( !settings->hasKey( "rt.quality" ) ) {
+      settings->set( "rt.quality", "offline" );
+   }
+   settings->set( "video.width", std::max( 1, settings->get< Int32 >( "video.width", 640 ) ) );
+   settings->set( "video.height", std::max( 1, settings->get< Int32 >( "video.height", 480 ) ) );
+   settings->set( "rt.workers", std::max( 1, settings->get< Int32 >( "rt.workers", std::thread::hardware_concurrency() ) ) );
+   if ( settings->hasKey( "samples" ) ) {
+      const auto samples = std::max( 1, settings->get< Int32 >( "samples", 1 ) );
+      settings->set( "rt.samples.max", samples );
+      settings->set( "rt.samples.min", std::min( samples, settings->get< Int32 >( "rt.samples.min", 16 ) ) );
+   }
+
+   // The ray tracer gets both the scene and settings from the simulation, but
+   // nothing else is needed from it. In particular, it is never started.
+   Simulation simulation;
+   simulation.setSettings( settings );
+
+   CRIMILD_LOG_INFO( "Loading scene from ", inputPath.string() );
+   auto model = loadScene( inputPath );
+   if ( model == nullptr ) {
+      CRIMILD_LOG_ERROR( "Cannot load scene from ", inputPath.string() );
+      return -1;
+   }
+
+   const auto width = settings->get< Int32 >( "video.width", 640 );
+   const auto height = settings->get< Int32 >( "video.height", 480 );
+
+   auto scene = std::make_shared< Group >();
+   scene->attachNode( model );
+   setupCamera( crimild::get_ptr( scene ), Real( width ) / Real( height ) );
+   simulation.setScene( scene );
+
+   CRIMILD_LOG_INFO( "Rendering ", width, "x", height, " pixels using ", settings->get< Int32 >( "rt.workers", 1 ), " workers" );
+
+   auto renderer = framegraph::softRT();
+   auto image = crimild::cast_ptr< Image >( renderer->getMainProduct() );
+
+   const auto startTime = std::chrono::steady_clock::now();
+   const auto getElapsed = [ & ] {
+      return std::chrono::duration< Real >( std::chrono::steady_clock::now() - startTime ).count();
+   };
+
+   // The first call builds acceleration structures and starts all workers.
+   // Later calls only update stats, which is why we poll.
+   renderer->apply( 0, false );
+   while ( true ) {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+      renderer->apply( 0, false );
+
+      std::printf(
+         "\r%u spp, %.1f%% converged, %.2f Mrays/s",
+         settings->get< UInt32 >( "rt.samples.count", 0 ),
+         100.0f * settings->get< Real >( "rt.stats.converged", 0 ),
+         1e-6f * settings->get< Real >( "rt.stats.rays_per_second", 0 )
+      );
+      std::fflush( stdout );
+
+      if ( settings->get< Bool >( "rt.stats.done", false ) ) {
+         break;
+      }
+
+      if ( timeBudget > 0 && getElapsed() >= timeBudget ) {
+         settings->set( "rt.cancel", true );
+         renderer->apply( 0, false );
+         break;
+      }
+   }
+
+   // Waits for workers to finish
+   renderer = nullptr;
+   const auto elapsed = getElapsed();
+   std::printf( "\n" );
+
+   if ( !utils::writeHDR( crimild::get_ptr( image ), outputPath ) ) {
+      CRIMILD_LOG_ERROR( "Cannot write image to ", outputPath.string() );
+      return -1;
+   }
+
+   std::printf( "Output:            %s\n", outputPath.string().c_str() );
+   std::printf( "Time:              %.3f s\n", elapsed );
+   std::printf( "Samples per pixel: %u\n", settings->get< UInt32 >( "rt.samples.count", 0 ) );
+   std::printf( "Converged:         %.2f%%\n", 100.0f * settings->get< Real >( "rt.stats.converged", 0 ) );
+   std::printf( "Rays:              %llu\n", ( unsigned long long ) settings->get< UInt64 >( "rt.stats.rays", 0 ) );
+   std::printf( "Rays per second:   %.3f M\n", 1e-6f * settings->get< Real >( "rt.stats.rays_per_second", 0 ) );
+
+   if ( settings->hasKey( "stats" ) ) {
+      writeStats( settings->get< std::string >( "stats", "" ), crimild::get_ptr( settings ), elapsed );
+   }
+
+   return 0;
+}
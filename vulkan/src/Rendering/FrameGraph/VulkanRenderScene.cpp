@@ -123,10 +123,18 @@ void RenderScene::execute( void ) noexcept
       return;
    }
 
-   const auto renderState =
-      scene != nullptr
-         ? scene->perform< FetchSceneRenderState >()
-         : FetchSceneRenderState::Result {};
+   const auto renderState = [ & ] {
+      auto pipeline = Simulation::getInstance()->getFramePipeline();
+      if ( pipeline->isEnabled() ) {
+         // Scene might be updating in the background. Use the last snapshot instead
+         FetchSceneRenderState fetch;
+         if ( auto snapshot = pipeline->getPublishedSnapshot() ) {
+            fetch.fetch( *snapshot );
+         }
+         return fetch.getResult();
+      }
+      return scene->perform< FetchSceneRenderState >();
+   }();
 
    if ( m_camera == nullptr ) {
       m_camera = retain( Simulation::getInstance()->getMainCamera() );
@@ -843,11 +843,13 @@ VkBuffer RenderDevice::bind( const VertexBuffer *vertexBuffer ) noexcept
 {
     const auto id = vertexBuffer->getUniqueID();
     if ( m_buffers.contains( id ) ) {
-        if ( vertexBuffer->getBufferView()->getUsage() == BufferView::Usage::DYNAMIC ) {
+        const auto bufferView = vertexBuffer->getBufferView();
+        if ( bufferView->getUsage() == BufferView::Usage::DYNAMIC && bufferView->getLength() > 0 ) {
+            // Only the current length is uploaded (i.e. alive particles)
             copyToBuffer(
                 m_memories[ id ][ getCurrentFrameIndex() ],
-                vertexBuffer->getBufferView()->getData(),
-                vertexBuffer->getBufferView()->getLength()
+                bufferView->getData(),
+                bufferView->getLength()
             );
         }
 
@@ -857,7 +859,9 @@ VkBuffer RenderDevice::bind( const VertexBuffer *vertexBuffer ) noexcept
     CRIMILD_LOG_TRACE();
 
     auto bufferView = vertexBuffer->getBufferView();
-    auto bufferSize = bufferView->getLength();
+
+    // Dynamic views might grow up to the end of their buffers later on
+    auto bufferSize = bufferView->getUsage() == BufferView::Usage::DYNAMIC ? bufferView->getCapacity() : bufferView->getLength();
 
     VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 
@@ -875,11 +879,11 @@ VkBuffer RenderDevice::bind( const VertexBuffer *vertexBuffer ) noexcept
             bufferMemory
         );
 
-        if ( bufferView->getData() != nullptr ) {
+        if ( bufferView->getData() != nullptr && bufferView->getLength() > 0 ) {
             copyToBuffer(
                 bufferMemory,
                 bufferView->getData(),
-                bufferSize
+                bufferView->getLength()
             );
         }
 
@@ -921,11 +925,13 @@ VkBuffer RenderDevice::bind( const IndexBuffer *indexBuffer ) noexcept
 {
     const auto id = indexBuffer->getUniqueID();
     if ( m_buffers.contains( id ) ) {
-        if ( indexBuffer->getBufferView()->getUsage() == BufferView::Usage::DYNAMIC ) {
+        const auto bufferView = indexBuffer->getBufferView();
+        if ( bufferView->getUsage() == BufferView::Usage::DYNAMIC && bufferView->getLength() > 0 ) {
+            // Only the current length is uploaded (i.e. alive particles)
             copyToBuffer(
                 m_memories[ id ][ getCurrentFrameIndex() ],
-                indexBuffer->getBufferView()->getData(),
-                indexBuffer->getBufferView()->getLength()
+                bufferView->getData(),
+                bufferView->getLength()
             );
         }
         return m_buffers[ id ][ getCurrentFrameIndex() ];
@@ -934,7 +940,9 @@ VkBuffer RenderDevice::bind( const IndexBuffer *indexBuffer ) noexcept
     CRIMILD_LOG_TRACE();
 
     auto bufferView = indexBuffer->getBufferView();
-    auto bufferSize = bufferView->getLength();
+
+    // Dynamic views might grow up to the end of their buffers later on
+    auto bufferSize = bufferView->getUsage() == BufferView::Usage::DYNAMIC ? bufferView->getCapacity() : bufferView->getLength();
 
     VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
 
@@ -952,11 +960,11 @@ VkBuffer RenderDevice::bind( const IndexBuffer *indexBuffer ) noexcept
             bufferMemory
         );
 
-        if ( bufferView->getData() != nullptr ) {
+        if ( bufferView->getData() != nullptr && bufferView->getLength() > 0 ) {
             copyToBuffer(
                 bufferMemory,
                 bufferView->getData(),
-                bufferSize
+                bufferView->getLength()
             );
         }
 
@@ -63,23 +63,57 @@ void FetchSceneRenderState::visitGeometry( Geometry *geometry ) noexcept
         return;
     }
 
-    if ( geometry->getLayer() == Node::Layer::SKYBOX ) {
+    addRenderable( material, primitive, geometry->getLayer(), geometry->getWorld() );
+}
+
+void FetchSceneRenderState::visitLight( Light *light ) noexcept
+{
+    m_result.lights[ light->getType() ].insert( crimild::retain( light ) );
+}
+
+FetchSceneRenderState::Result &FetchSceneRenderState::fetch( const FrameSnapshot &snapshot ) noexcept
+{
+    m_result = Result {};
+
+    for ( const auto &renderable : snapshot.renderables ) {
+        if ( renderable.material == nullptr ) {
+            continue;
+        }
+
+        auto primitive = crimild::retain( renderable.geometry->anyPrimitive() );
+        if ( primitive == nullptr ) {
+            continue;
+        }
+
+        addRenderable( renderable.material, primitive, renderable.layer, renderable.world );
+    }
+
+    for ( const auto &light : snapshot.lights ) {
+        m_result.lights[ light->getType() ].insert( light );
+    }
+
+    return m_result;
+}
+
+void FetchSceneRenderState::addRenderable(
+    std::shared_ptr< Material > const &material,
+    std::shared_ptr< Primitive > const &primitive,
+    Node::Layer::Impl layer,
+    const Transformation &world
+) noexcept
+{
+    if ( layer == Node::Layer::SKYBOX ) {
         if ( auto m = std::dynamic_pointer_cast< UnlitMaterial >( material ) ) {
-            m_result.envRenderables[ m ][ primitive ].push_back( { Matrix4( geometry->getWorld() ) } );
+            m_result.envRenderables[ m ][ primitive ].push_back( { Matrix4( world ) } );
         }
         return;
     }
 
     // TODO: replace dynamic casts with render mode for materials
     if ( auto m = std::dynamic_pointer_cast< materials::PrincipledBSDF >( material ) ) {
-        m_result.litRenderables[ m ][ primitive ].push_back( { Matrix4( geometry->getWorld() ) } );
-        m_result.shadowCasters[ primitive ].push_back( { Matrix4( geometry->getWorld() ) } );
+        m_result.litRenderables[ m ][ primitive ].push_back( { Matrix4( world ) } );
+        m_result.shadowCasters[ primitive ].push_back( { Matrix4( world ) } );
     } else if ( auto m = std::dynamic_pointer_cast< UnlitMaterial >( material ) ) {
-        m_result.unlitRenderables[ m ][ primitive ].push_back( { Matrix4( geometry->getWorld() ) } );
+        m_result.unlitRenderables[ m ][ primitive ].push_back( { Matrix4( world ) } );
     }
 }
-
-void FetchSceneRenderState::visitLight( Light *light ) noexcept
-{
-    m_result.lights[ light->getType() ].insert( crimild::retain( light ) );
-}
@@ -29,6 +29,7 @@
 #define CRIMILD_VULKAN_VISITORS_FETCH_SCENE_RENDER_STATE_
 
 #include "Rendering/VulkanSceneRenderState.hpp"
+#include "Simulation/FramePipeline.hpp"
 
 namespace crimild {
 
@@ -52,6 +53,22 @@ namespace crimild {
             void visitGeometry( Geometry *geometry ) noexcept override;
             void visitLight( Light *light ) noexcept override;
 
+            /**
+             * \brief Fetches renderable objects from a frame snapshot instead of the scene
+             *
+             * Used when the frame pipeline is enabled, since the scene might be updated
+             * while commands are being recorded.
+             */
+            Result &fetch( const FrameSnapshot &snapshot ) noexcept;
+
+        private:
+            void addRenderable(
+                std::shared_ptr< Material > const &material,
+                std::shared_ptr< Primitive > const &primitive,
+                Node::Layer::Impl layer,
+                const Transformation &world
+            ) noexcept;
+
         private:
             Result m_result;
         };